@@ -179,6 +179,18 @@ typedef enum {
 #define SENSOR_BMP280_SDA_PIN   39
 #define SENSOR_BMP280_SCL_PIN   40
 
+// 板级传感器表（sensor_hub按表注册）：I2C传感器 pin=SDA、pin2=SCL、param=地址（中断引脚用
+// SENSOR_HUB_I2C_PARAM 编入）；模拟传感器 pin=ADC1引脚；超声波 pin=TRIG、pin2=ECHO。
+// 驱动未注册的项在启动时告警并跳过
+#define BOARD_SENSOR_TABLE { \
+    { .driver = "DHT22",   .id = SAMPLE_SENSOR_DHT22,   .pin = (gpio_num_t)SENSOR_DHT22_PIN,        .pin2 = GPIO_NUM_NC }, \
+    { .driver = "BH1750",  .id = SAMPLE_SENSOR_BH1750,  .pin = (gpio_num_t)SENSOR_BH1750_SDA_PIN,   .pin2 = (gpio_num_t)SENSOR_BH1750_SCL_PIN,   .param = 0x23 }, \
+    { .driver = "BMP280",  .id = SAMPLE_SENSOR_BMP280,  .pin = (gpio_num_t)SENSOR_BMP280_SDA_PIN,   .pin2 = (gpio_num_t)SENSOR_BMP280_SCL_PIN,   .param = 0x76 }, \
+    { .driver = "MPU6050", .id = SAMPLE_SENSOR_MPU6050, .pin = (gpio_num_t)SENSOR_MPU6050_SDA_PIN,  .pin2 = (gpio_num_t)SENSOR_MPU6050_SCL_PIN,  .param = SENSOR_HUB_I2C_PARAM(0x68, SENSOR_MPU6050_INT_PIN) }, \
+    { .driver = "MQ2",     .id = SAMPLE_SENSOR_MQ2,     .pin = (gpio_num_t)SENSOR_MQ2_ANALOG_PIN,   .pin2 = GPIO_NUM_NC }, \
+    { .driver = "HCSR04",  .id = SAMPLE_SENSOR_HCSR04,  .pin = (gpio_num_t)SENSOR_HCSR04_TRIG_PIN,  .pin2 = (gpio_num_t)SENSOR_HCSR04_ECHO_PIN }, \
+}
+
 // ================================
 // 按键配置 (多功能按键)
 // ================================
@@ -143,6 +143,11 @@ extern "C" {
 #define DHT11_GPIO_PIN      GPIO_NUM_35
 #define DHT11_SENSOR_TYPE   0  // 温度传感器
 
+// 板级传感器表（sensor_hub按表注册：驱动名、上报ID、引脚），新增传感器只需加一行
+#define BOARD_SENSOR_TABLE { \
+    { .driver = "DHT11", .id = SAMPLE_SENSOR_DHT11, .pin = DHT11_GPIO_PIN, .pin2 = GPIO_NUM_NC }, \
+}
+
 // ==================== 按键配置 ====================
 #define BUTTON_COUNT        2
 
@@ -10,9 +10,7 @@
 #include "board_config.h"
 #include "../../main/bsp/bsp_interface.h"
 // #include "../../main/bluetooth/bt_provision.h"  // 临时禁用
-#include "../../drivers/sensors/dht11.h"      // DHT11传感器驱动
-// Lite板子不使用DS18B20，GPIO39用于雨水传感器
-// #include "../../drivers/sensors/ds18b20.h"    // DS18B20传感器驱动（已禁用）
+#include "../../main/sensor/sensor_hub.h"   // 传感器框架（板级传感器表）
 #include <stdio.h>
 #include <string.h>
 
@@ -156,14 +154,8 @@ static hal_system_config_t s_system_config = {
     .watchdog_timeout = WATCHDOG_TIMEOUT_S
 };
 
-// 传感器显示信息列表 - 用于LCD动态UI（Lite板子只有DHT11）
-static const bsp_sensor_display_info_t s_sensor_display_list[] = {
-    {
-        .name = "DHT11",
-        .unit = "C / %",
-        .gpio_pin = DHT11_GPIO_PIN
-    }
-};
+// 板级传感器表 - 显示、上报、bsp_sensor_read()都按此表生成
+static const sensor_hub_board_entry_t s_sensor_table[] = BOARD_SENSOR_TABLE;
 
 // 板级信息
 static const bsp_board_info_t s_board_info = {
@@ -174,9 +166,7 @@ static const bsp_board_info_t s_board_info = {
     .flash_size_mb = FLASH_SIZE_MB,
     .psram_size_mb = PSRAM_SIZE_MB,
     .has_wifi = HAS_WIFI,
-    .has_ethernet = HAS_ETHERNET,
-    .sensor_display_list = s_sensor_display_list,
-    .sensor_display_count = sizeof(s_sensor_display_list) / sizeof(s_sensor_display_list[0])
+    .has_ethernet = HAS_ETHERNET
 };
 
 // 硬件配置 (使用函数返回，避免静态初始化问题)
@@ -254,45 +244,23 @@ static const bsp_hardware_config_t* esp32_s3_devkit_lite_get_hardware_config(voi
 // 传感器控制函数
 static hal_err_t esp32_s3_devkit_lite_sensor_init(void)
 {
-    printf("BSP: Initializing sensors (DHT11 for Lite board)...\n");
-    
-    hal_err_t result = HAL_OK;
-    bool dht11_ok = false;
-    
-    // 初始化DHT11传感器
-    dht11_config_t dht11_config = {
-        .data_pin = DHT11_GPIO_PIN
-    };
-    
-    esp_err_t dht11_ret = dht11_init_adapter(&dht11_config);
-    if (dht11_ret == ESP_OK) {
-        printf("BSP: ✅ DHT11 initialized successfully on GPIO%d\n", DHT11_GPIO_PIN);
-        dht11_ok = true;
-    } else {
-        printf("BSP: ⚠️ DHT11 initialization failed (error: %d) - 将继续运行，DHT11数据不可用\n", dht11_ret);
-        // 不设置result = HAL_ERROR，允许其他传感器继续工作
-    }
-    
-    // Lite板子只有DHT11传感器
-    printf("BSP: ℹ️ Lite板子：仅支持DHT11传感器\n");
+    printf("BSP: Initializing sensors from board sensor table...\n");
     
-    // 只要DHT11成功，就返回HAL_OK
-    if (dht11_ok) {
-        printf("BSP: ✅ Sensor initialization completed - DHT11: OK\n");
-        result = HAL_OK;
-    } else {
-        printf("BSP: ⚠️ DHT11 failed to initialize - 系统将继续运行\n");
-        // 即使DHT11失败，也返回HAL_OK，不阻塞系统启动
-        result = HAL_OK;
+    sensor_hub_reset();
+    if (sensor_hub_register_builtin_drivers() != ESP_OK) {
+        printf("BSP: Failed to register sensor drivers\n");
+        return HAL_ERROR;
     }
     
-    return result;
+    // 单个传感器初始化失败只告警，不阻塞系统启动
+    sensor_hub_add_board(s_sensor_table, sizeof(s_sensor_table) / sizeof(s_sensor_table[0]));
+    return HAL_OK;
 }
 
 static hal_err_t esp32_s3_devkit_lite_sensor_deinit(void)
 {
     printf("BSP: Deinitializing sensors...\n");
-    // 传感器去初始化逻辑（如果需要）
+    sensor_hub_reset();
     return HAL_OK;
 }
 
@@ -302,9 +270,12 @@ static hal_err_t esp32_s3_devkit_lite_sensor_read(uint8_t sensor_id, float* valu
         return HAL_ERROR_INVALID_PARAM;
     }
     
-    // 这是一个占位函数，实际的传感器读取在main.c中通过DHT11/DS18B20驱动完成
-    // 这里返回HAL_OK表示传感器模块可用
-    return HAL_OK;
+    // sensor_id 为展开后的通道序号（板级传感器表顺序），返回最近一次采集的值
+    esp_err_t ret = sensor_hub_get_value(sensor_id, value);
+    if (ret == ESP_ERR_INVALID_ARG) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+    return ret == ESP_OK ? HAL_OK : HAL_ERROR_NOT_INITIALIZED;
 }
 
 // BSP接口结构体
@@ -163,6 +163,13 @@ extern "C" {
 // 雨水传感器配置 (S2 - G39, 数字传感器，使用原DS18B20管脚)
 #define RAIN_SENSOR_GPIO_PIN    GPIO_NUM_39  // 使用GPIO39（原DS18B20管脚）
 #define RAIN_SENSOR_TYPE        2  // 数字传感器
+#define RAIN_SENSOR_ANALOG_PIN  GPIO_NUM_NC  // 模拟输出AO，接ADC1引脚（GPIO1~10）后上报湿润程度
+
+// 板级传感器表（sensor_hub按表注册：驱动名、上报ID、引脚），新增传感器只需加一行
+#define BOARD_SENSOR_TABLE { \
+    { .driver = "DHT11", .id = SAMPLE_SENSOR_DHT11, .pin = DHT11_GPIO_PIN,       .pin2 = GPIO_NUM_NC }, \
+    { .driver = "RAIN",  .id = SAMPLE_SENSOR_RAIN,  .pin = RAIN_SENSOR_GPIO_PIN, .pin2 = RAIN_SENSOR_ANALOG_PIN, .label = "Rain" }, \
+}
 
 // ==================== 按键配置 ====================
 #define BUTTON_COUNT        2
@@ -46,6 +46,7 @@ hal_err_t bsp_esp32_s3_devkit_rain_relay2_control(bool state);
 hal_err_t bsp_esp32_s3_devkit_rain_servo_set_angle(uint8_t servo_index, uint16_t angle);
 hal_err_t bsp_esp32_s3_devkit_rain_servo1_set_angle(uint16_t angle);
 hal_err_t bsp_esp32_s3_devkit_rain_servo2_set_angle(uint16_t angle);
+hal_err_t bsp_esp32_s3_devkit_rain_servo_set_position(uint8_t servo_index, uint32_t centideg);  // 0.01度，运动控制使用
 
 #ifdef __cplusplus
 }
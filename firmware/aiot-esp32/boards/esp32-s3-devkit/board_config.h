@@ -150,6 +150,12 @@ extern "C" {
 #define DS18B20_GPIO_PIN    GPIO_NUM_39
 #define DS18B20_SENSOR_TYPE 1  // 温度传感器
 
+// 板级传感器表（sensor_hub按表注册：驱动名、上报ID、引脚），新增传感器只需加一行
+#define BOARD_SENSOR_TABLE { \
+    { .driver = "DHT11",   .id = SAMPLE_SENSOR_DHT11,   .pin = DHT11_GPIO_PIN,   .pin2 = GPIO_NUM_NC }, \
+    { .driver = "DS18B20", .id = SAMPLE_SENSOR_DS18B20, .pin = DS18B20_GPIO_PIN, .pin2 = GPIO_NUM_NC }, \
+}
+
 // ==================== 按键配置 ====================
 #define BUTTON_COUNT        2
 
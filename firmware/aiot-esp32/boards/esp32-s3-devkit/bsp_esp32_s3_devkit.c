@@ -10,8 +10,7 @@
 #include "board_config.h"
 #include "../../main/bsp/bsp_interface.h"
 // #include "../../main/bluetooth/bt_provision.h"  // 临时禁用
-#include "../../drivers/sensors/dht11.h"      // DHT11传感器驱动
-#include "../../drivers/sensors/ds18b20.h"    // DS18B20传感器驱动
+#include "../../main/sensor/sensor_hub.h"   // 传感器框架（板级传感器表）
 #include <stdio.h>
 #include <string.h>
 
@@ -21,6 +20,7 @@
 #include "esp_err.h"
 #include "driver/gpio.h"
 #include "driver/ledc.h"
+#include "pwm_output.h"
 #else
 // 模拟定义，用于非ESP-IDF环境编译
 typedef int esp_err_t;
@@ -48,6 +48,7 @@ static hal_err_t esp32_s3_devkit_led_control(uint8_t led_index, bool state);
 static hal_err_t esp32_s3_devkit_led_set_brightness(uint8_t led_index, uint8_t brightness);
 static hal_err_t esp32_s3_devkit_relay_control(uint8_t relay_index, bool state);
 static hal_err_t esp32_s3_devkit_servo_set_angle(uint8_t servo_index, uint16_t angle);
+static uint32_t esp32_s3_devkit_servo_duty(const hal_servo_config_t *config, uint32_t pulse_width_us);
 
 // 蓝牙配网功能函数声明 - 临时禁用
 /*
@@ -123,6 +124,11 @@ static hal_servo_config_t s_servo_configs[SERVO_COUNT] = {
     }
 };
 
+// 舵机角度->占空比查找表（init_servos 按 s_servo_configs 生成）
+#ifdef ESP_PLATFORM
+static pwm_servo_table_t s_servo_tables[SERVO_COUNT];
+#endif
+
 // 传感器类型数组
 static hal_sensor_type_t s_sensor_types[SENSOR_COUNT] = {
     HAL_SENSOR_TYPE_TEMPERATURE,  // DHT11温度
@@ -168,19 +174,8 @@ static hal_system_config_t s_system_config = {
     .watchdog_timeout = WATCHDOG_TIMEOUT_S
 };
 
-// 传感器显示信息列表 - 用于LCD动态UI
-static const bsp_sensor_display_info_t s_sensor_display_list[] = {
-    {
-        .name = "DHT11",
-        .unit = "C / %",
-        .gpio_pin = DHT11_GPIO_PIN
-    },
-    {
-        .name = "DS18B20",
-        .unit = "C",
-        .gpio_pin = DS18B20_GPIO_PIN
-    }
-};
+// 板级传感器表 - 显示、上报、bsp_sensor_read()都按此表生成
+static const sensor_hub_board_entry_t s_sensor_table[] = BOARD_SENSOR_TABLE;
 
 // 板级信息
 static const bsp_board_info_t s_board_info = {
@@ -191,9 +186,7 @@ static const bsp_board_info_t s_board_info = {
     .flash_size_mb = FLASH_SIZE_MB,
     .psram_size_mb = PSRAM_SIZE_MB,
     .has_wifi = HAS_WIFI,
-    .has_ethernet = HAS_ETHERNET,
-    .sensor_display_list = s_sensor_display_list,
-    .sensor_display_count = sizeof(s_sensor_display_list) / sizeof(s_sensor_display_list[0])
+    .has_ethernet = HAS_ETHERNET
 };
 
 // 硬件配置 (使用函数返回，避免静态初始化问题)
@@ -275,58 +268,23 @@ static const bsp_hardware_config_t* esp32_s3_devkit_get_hardware_config(void)
 // 传感器控制函数
 static hal_err_t esp32_s3_devkit_sensor_init(void)
 {
-    printf("BSP: Initializing sensors (DHT11 and DS18B20)...\n");
-    
-    hal_err_t result = HAL_OK;
-    bool dht11_ok = false;
-    bool ds18b20_ok = false;
-    
-    // 初始化DHT11传感器
-    dht11_config_t dht11_config = {
-        .data_pin = DHT11_GPIO_PIN
-    };
-    
-    esp_err_t dht11_ret = dht11_init_adapter(&dht11_config);
-    if (dht11_ret == ESP_OK) {
-        printf("BSP: ✅ DHT11 initialized successfully on GPIO%d\n", DHT11_GPIO_PIN);
-        dht11_ok = true;
-    } else {
-        printf("BSP: ⚠️ DHT11 initialization failed (error: %d) - 将继续运行，DHT11数据不可用\n", dht11_ret);
-        // 不设置result = HAL_ERROR，允许其他传感器继续工作
-    }
-    
-    // 初始化DS18B20传感器（独立初始化，不受DHT11影响）
-    ds18b20_config_t ds18b20_config = {
-        .data_pin = DS18B20_GPIO_PIN
-    };
-    
-    esp_err_t ds18b20_ret = ds18b20_init(&ds18b20_config);
-    if (ds18b20_ret == ESP_OK) {
-        printf("BSP: ✅ DS18B20 initialized successfully on GPIO%d\n", DS18B20_GPIO_PIN);
-        ds18b20_ok = true;
-    } else {
-        printf("BSP: ⚠️ DS18B20 initialization failed (error: %d) - 将继续运行，DS18B20数据不可用\n", ds18b20_ret);
-        // 不设置result = HAL_ERROR，允许其他传感器继续工作
-    }
+    printf("BSP: Initializing sensors from board sensor table...\n");
     
-    // 只要至少有一个传感器成功，就返回HAL_OK
-    if (dht11_ok || ds18b20_ok) {
-        printf("BSP: ✅ Sensor initialization completed - DHT11: %s, DS18B20: %s\n", 
-               dht11_ok ? "OK" : "Failed", ds18b20_ok ? "OK" : "Failed");
-        result = HAL_OK;
-    } else {
-        printf("BSP: ⚠️ All sensors failed to initialize - 系统将继续运行\n");
-        // 即使所有传感器都失败，也返回HAL_OK，不阻塞系统启动
-        result = HAL_OK;
+    sensor_hub_reset();
+    if (sensor_hub_register_builtin_drivers() != ESP_OK) {
+        printf("BSP: Failed to register sensor drivers\n");
+        return HAL_ERROR;
     }
     
-    return result;
+    // 单个传感器初始化失败只告警，不阻塞系统启动
+    sensor_hub_add_board(s_sensor_table, sizeof(s_sensor_table) / sizeof(s_sensor_table[0]));
+    return HAL_OK;
 }
 
 static hal_err_t esp32_s3_devkit_sensor_deinit(void)
 {
     printf("BSP: Deinitializing sensors...\n");
-    // 传感器去初始化逻辑（如果需要）
+    sensor_hub_reset();
     return HAL_OK;
 }
 
@@ -336,9 +294,12 @@ static hal_err_t esp32_s3_devkit_sensor_read(uint8_t sensor_id, float* value)
         return HAL_ERROR_INVALID_PARAM;
     }
     
-    // 这是一个占位函数，实际的传感器读取在main.c中通过DHT11/DS18B20驱动完成
-    // 这里返回HAL_OK表示传感器模块可用
-    return HAL_OK;
+    // sensor_id 为展开后的通道序号（板级传感器表顺序），返回最近一次采集的值
+    esp_err_t ret = sensor_hub_get_value(sensor_id, value);
+    if (ret == ESP_ERR_INVALID_ARG) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+    return ret == ESP_OK ? HAL_OK : HAL_ERROR_NOT_INITIALIZED;
 }
 
 // BSP接口结构体
@@ -969,6 +930,14 @@ static hal_err_t esp32_s3_devkit_init_servos(void)
             return HAL_ERROR;
         }
         
+        // 预先生成角度->占空比查找表，运动控制每帧只查表
+        ret = pwm_servo_table_init(&s_servo_tables[i], config->min_pulse_us, config->max_pulse_us,
+                                   config->max_angle, config->frequency, LEDC_TIMER_13_BIT);
+        if (ret != ESP_OK) {
+            ESP_LOGE("BSP", "Failed to build servo%d duty table: %s", i + 1, esp_err_to_name(ret));
+            return HAL_ERROR;
+        }
+        
         // 设置初始状态为停止（对于360度连续旋转舵机，1500us为停止位置）
         // 对于180度定位舵机，也是中间位置（90度）
         // 计算中间脉宽：(min + max) / 2
@@ -976,7 +945,7 @@ static hal_err_t esp32_s3_devkit_init_servos(void)
         // 如果配置的脉宽范围是500-2500us，中间值是1500us（360度舵机停止位置）
         // 如果配置的脉宽范围是1000-2000us，中间值是1500us（360度舵机停止位置）
         uint32_t pulse_width_us = neutral_pulse_us;
-        uint32_t duty = (uint32_t)((float)pulse_width_us / (1000000.0f / config->frequency) * ((1 << 13) - 1));
+        uint32_t duty = esp32_s3_devkit_servo_duty(config, pulse_width_us);
         
         ret = ledc_set_duty(LEDC_LOW_SPEED_MODE, (ledc_channel_t)(LEDC_CHANNEL_0 + i), duty);
         if (ret != ESP_OK) {
@@ -1002,6 +971,47 @@ static hal_err_t esp32_s3_devkit_init_servos(void)
     return HAL_OK;
 }
 
+/**
+ * @brief 脉宽转换为13位占空比（整数运算，四舍五入）
+ */
+static uint32_t esp32_s3_devkit_servo_duty(const hal_servo_config_t *config, uint32_t pulse_width_us)
+{
+    uint32_t period_us = 1000000 / config->frequency;  // 20ms (50Hz)
+    return (pulse_width_us * ((1 << 13) - 1) + period_us / 2) / period_us;
+}
+
+/**
+ * @brief 按0.01度写舵机占空比（运动控制每帧调用，不打印日志）
+ *
+ * 查表得到占空比（超出最大角度按最大角度），经PWM输出层写入：调用方打开了帧时与同帧的其他通道一起锁存。
+ */
+static hal_err_t esp32_s3_devkit_servo_write(uint8_t servo_index, uint32_t centideg, uint32_t *duty_out)
+{
+    if (servo_index >= SERVO_COUNT) {
+        return HAL_ERROR_INVALID_PARAM;
+    }
+    
+#ifdef ESP_PLATFORM
+    uint32_t duty = pwm_servo_table_duty(&s_servo_tables[servo_index], centideg);
+    if (duty_out) {
+        *duty_out = duty;
+    }
+    
+    esp_err_t ret = pwm_output_write(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0 + servo_index, duty);
+    if (ret != ESP_OK) {
+        ESP_LOGE("BSP", "Failed to write servo%d duty: %s", servo_index + 1, esp_err_to_name(ret));
+        return HAL_ERROR;
+    }
+#else
+    (void)centideg;
+    if (duty_out) {
+        *duty_out = 0;
+    }
+#endif
+    
+    return HAL_OK;
+}
+
 /**
  * @brief 设置舵机角度
  */
@@ -1019,31 +1029,18 @@ static hal_err_t esp32_s3_devkit_servo_set_angle(uint8_t servo_index, uint16_t a
         angle = config->max_angle;
     }
     
-    // 计算脉宽（微秒）
-    // 角度0度对应min_pulse_us，角度max_angle度对应max_pulse_us
-    uint32_t pulse_width_us = config->min_pulse_us + 
-                               (uint32_t)((float)angle / config->max_angle * 
-                                         (config->max_pulse_us - config->min_pulse_us));
-    
-#ifdef ESP_PLATFORM
-    // 计算占空比（13位分辨率）
-    uint32_t period_us = 1000000 / config->frequency;  // 20ms (50Hz)
-    uint32_t duty = (uint32_t)((float)pulse_width_us / period_us * ((1 << 13) - 1));
-    
-    ledc_channel_t channel = (ledc_channel_t)(LEDC_CHANNEL_0 + servo_index);
-    
-    esp_err_t ret = ledc_set_duty(LEDC_LOW_SPEED_MODE, channel, duty);
-    if (ret != ESP_OK) {
-        ESP_LOGE("BSP", "Failed to set servo%d duty: %s", servo_index + 1, esp_err_to_name(ret));
-        return HAL_ERROR;
+    uint32_t duty = 0;
+    hal_err_t ret = esp32_s3_devkit_servo_write(servo_index, (uint32_t)angle * 100, &duty);
+    if (ret != HAL_OK) {
+        return ret;
     }
     
-    ret = ledc_update_duty(LEDC_LOW_SPEED_MODE, channel);
-    if (ret != ESP_OK) {
-        ESP_LOGE("BSP", "Failed to update servo%d duty: %s", servo_index + 1, esp_err_to_name(ret));
-        return HAL_ERROR;
-    }
+    // 脉宽只用于日志：角度0度对应min_pulse_us，角度max_angle度对应max_pulse_us
+    uint32_t pulse_width_us = config->min_pulse_us +
+                              (angle * (config->max_pulse_us - config->min_pulse_us) + config->max_angle / 2) /
+                              config->max_angle;
     
+#ifdef ESP_PLATFORM
     ESP_LOGI("BSP", "Servo%d angle set to %d degrees (pulse: %lu us, duty: %lu)", 
              servo_index + 1, angle, pulse_width_us, duty);
 #else
@@ -1078,6 +1075,14 @@ hal_err_t bsp_esp32_s3_devkit_servo_set_angle(uint8_t servo_index, uint16_t angl
     return esp32_s3_devkit_servo_set_angle(servo_index, angle);
 }
 
+/**
+ * @brief 按0.01度设置舵机位置（运动控制每帧调用）
+ */
+hal_err_t bsp_esp32_s3_devkit_servo_set_position(uint8_t servo_index, uint32_t centideg)
+{
+    return esp32_s3_devkit_servo_write(servo_index, centideg, NULL);
+}
+
 // ==================== 蓝牙配网功能实现 - 临时禁用 ====================
 
 /*
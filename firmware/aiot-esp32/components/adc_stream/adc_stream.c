@@ -0,0 +1,58 @@
+/**
+ * @file adc_stream.c
+ * @brief 模拟量过采样归约与分段线性标定（纯计算，不访问硬件）
+ */
+
+#include "adc_stream.h"
+#include <string.h>
+
+float adc_stream_curve_eval(const adc_stream_curve_t *curve, float mv)
+{
+    if (!curve || curve->count == 0) {
+        return mv;
+    }
+    const adc_stream_point_t *p = curve->points;
+    if (curve->count == 1 || mv <= p[0].mv) {
+        return p[0].value;
+    }
+    for (uint8_t i = 1; i < curve->count; i++) {
+        if (mv <= p[i].mv) {
+            float span = p[i].mv - p[i - 1].mv;
+            if (span <= 0.0f) {
+                return p[i].value;
+            }
+            return p[i - 1].value + (p[i].value - p[i - 1].value) * (mv - p[i - 1].mv) / span;
+        }
+    }
+    return p[curve->count - 1].value;
+}
+
+esp_err_t adc_stream_reducer_init(adc_stream_reducer_t *r, uint8_t bits)
+{
+    // 12位样本累加 4^6 个不超过 2^24，sum 不会溢出
+    if (!r || bits > 6) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(r, 0, sizeof(*r));
+    memset(r->map, 0xFF, sizeof(r->map));
+    r->bits = bits;
+    r->block = 1u << (2 * bits);
+    return ESP_OK;
+}
+
+int adc_stream_reducer_add(adc_stream_reducer_t *r, uint8_t unit, uint8_t channel)
+{
+    if (!r || unit > 1 || channel > 0x0F) {
+        return -1;
+    }
+    uint8_t key = (uint8_t)((unit << 4) | channel);
+    if (r->map[key] < r->count) {
+        return r->map[key];
+    }
+    if (r->count >= CONFIG_ADC_STREAM_MAX_CHANNELS) {
+        return -1;
+    }
+    memset(&r->acc[r->count], 0, sizeof(r->acc[0]));
+    r->map[key] = r->count;
+    return r->count++;
+}
@@ -0,0 +1,236 @@
+/**
+ * @file adc_stream.h
+ * @brief 模拟量连续采样：ADC连续模式(DMA) -> 按帧过采样平均 -> 每通道标定曲线
+ *
+ * 雨水传感器原来只读数字电平，MQ2的模拟引脚在板级配置里声明了但没有ADC通路。本组件：
+ *
+ * - ADC以固定总采样率轮流转换所有通道，结果由DMA写入帧缓冲区，任务每帧唤醒一次
+ *   （每秒 CONFIG_ADC_STREAM_FRAMES_PER_S 次，与采样率无关），不逐个样本中断；
+ * - 每个通道累加 4^k 个样本后右移k位，输出 12+k 位的平均值（过采样），
+ *   同时是长度 4^k 的矩形窗平均，抑制工频和开关噪声；
+ * - 平均值先经ADC标定（eFuse曲线拟合）换算成mV，再按通道的分段线性曲线换算成
+ *   工程量（MQ2的ppm、雨水传感器的湿润度%）。
+ *
+ * 归约和标定曲线（adc_stream_reducer_* / adc_stream_curve_eval）是纯计算，可在主机上测试；
+ * ADC驱动、帧任务和读数接口在 adc_stream_continuous.c 中。
+ */
+
+#ifndef ADC_STREAM_H
+#define ADC_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_ADC_STREAM_MAX_CHANNELS
+#define CONFIG_ADC_STREAM_MAX_CHANNELS      4
+#endif
+
+#ifndef CONFIG_ADC_STREAM_SAMPLE_RATE_HZ
+#define CONFIG_ADC_STREAM_SAMPLE_RATE_HZ    20000   ///< 所有通道合计的转换速率
+#endif
+
+#ifndef CONFIG_ADC_STREAM_FRAMES_PER_S
+#define CONFIG_ADC_STREAM_FRAMES_PER_S      20      ///< DMA帧（任务唤醒）频率
+#endif
+
+#ifndef CONFIG_ADC_STREAM_OVERSAMPLE_BITS
+#define CONFIG_ADC_STREAM_OVERSAMPLE_BITS   4       ///< 每个输出平均 4^k 个样本，增加k位分辨率
+#endif
+
+#ifndef CONFIG_ADC_STREAM_TASK_PRIORITY
+#define CONFIG_ADC_STREAM_TASK_PRIORITY     4
+#endif
+
+#define ADC_STREAM_RAW_BITS         12
+#define ADC_STREAM_CURVE_MAX_POINTS 8
+#define ADC_STREAM_KEY_COUNT        32      ///< (unit << 4) | channel
+
+/* ==================== 标定曲线 ==================== */
+
+/**
+ * @brief 标定点（mV -> 工程量）
+ */
+typedef struct {
+    float mv;
+    float value;
+} adc_stream_point_t;
+
+/**
+ * @brief 分段线性标定曲线，点按mV升序；超出范围时取端点值
+ */
+typedef struct {
+    uint8_t count;                  ///< 0表示不换算（工程量即mV）
+    adc_stream_point_t points[ADC_STREAM_CURVE_MAX_POINTS];
+} adc_stream_curve_t;
+
+/**
+ * @brief 按曲线换算
+ */
+float adc_stream_curve_eval(const adc_stream_curve_t *curve, float mv);
+
+/* ==================== 过采样归约 ==================== */
+
+/**
+ * @brief 单通道累加器
+ */
+typedef struct {
+    uint32_t sum;
+    uint32_t n;
+    uint32_t value;                 ///< 最近一次输出（12+k 位）
+    uint32_t outputs;               ///< 输出个数
+} adc_stream_acc_t;
+
+/**
+ * @brief 多通道归约器：DMA帧中的样本按 (unit, channel) 分到各自的累加器
+ */
+typedef struct {
+    adc_stream_acc_t acc[CONFIG_ADC_STREAM_MAX_CHANNELS];
+    uint8_t map[ADC_STREAM_KEY_COUNT];      ///< (unit << 4) | channel -> 累加器下标，0xFF未使用
+    uint8_t count;
+    uint8_t bits;
+    uint32_t block;                 ///< 每个输出的样本数 4^bits
+    uint32_t unknown;               ///< 不属于任何已登记通道的样本数
+} adc_stream_reducer_t;
+
+/**
+ * @brief 初始化归约器
+ *
+ * @param bits 过采样位数（0~6）
+ */
+esp_err_t adc_stream_reducer_init(adc_stream_reducer_t *r, uint8_t bits);
+
+/**
+ * @brief 登记通道
+ *
+ * @return 累加器下标，失败返回-1（已满或参数超范围）；重复登记返回原下标
+ */
+int adc_stream_reducer_add(adc_stream_reducer_t *r, uint8_t unit, uint8_t channel);
+
+/**
+ * @brief 输入一个样本（DMA帧解析循环中逐个调用，只做查表和加法）
+ */
+static inline void adc_stream_reducer_put(adc_stream_reducer_t *r, uint8_t unit, uint8_t channel, uint16_t raw)
+{
+    uint8_t index = r->map[((unit & 0x01) << 4) | (channel & 0x0F)];
+    if (index >= r->count) {
+        r->unknown++;
+        return;
+    }
+    adc_stream_acc_t *a = &r->acc[index];
+    a->sum += raw;
+    if (++a->n == r->block) {
+        a->value = a->sum >> r->bits;
+        a->sum = 0;
+        a->n = 0;
+        a->outputs++;
+    }
+}
+
+/**
+ * @brief 把 12+k 位的平均值换回12位原始刻度（带小数）
+ */
+static inline float adc_stream_reducer_raw(const adc_stream_reducer_t *r, uint8_t index)
+{
+    return (float)r->acc[index].value / (float)(1u << r->bits);
+}
+
+/* ==================== 运行时 ==================== */
+
+/**
+ * @brief 全局配置（可选，在第一次 adc_stream_add_channel 之前调用）
+ */
+typedef struct {
+    bool manual_service;            ///< 不创建任务，由调用者 adc_stream_service()（主机测试用）
+} adc_stream_config_t;
+
+/**
+ * @brief 通道配置
+ */
+typedef struct {
+    gpio_num_t gpio;                ///< ADC1引脚
+    uint8_t atten_db;               ///< 衰减：0/2/6/12（dB），0以外的无效值按12
+    const adc_stream_curve_t *curve;    ///< 标定曲线，NULL表示工程量即mV；指针需一直有效
+    const char *name;               ///< 日志中显示的名称
+} adc_stream_channel_config_t;
+
+/**
+ * @brief 通道读数
+ */
+typedef struct {
+    float raw;                      ///< 平均后的原始值（12位刻度，带小数）
+    float mv;                       ///< 标定后的电压
+    float value;                    ///< 按曲线换算的工程量
+    uint32_t outputs;               ///< 启动以来的平均值个数
+    int64_t updated_us;             ///< 最近一次更新的时间
+} adc_stream_value_t;
+
+/**
+ * @brief 运行统计
+ */
+typedef struct {
+    uint32_t frames;                ///< 处理的DMA帧数
+    uint32_t samples;               ///< 处理的样本数
+    uint32_t overflows;             ///< DMA缓冲池溢出次数（任务来不及处理）
+    uint32_t unknown;               ///< 不属于已登记通道的样本数
+    uint32_t frame_us_max;          ///< 单帧处理最长耗时
+} adc_stream_stats_t;
+
+/**
+ * @brief 设置全局配置
+ *
+ * @return ESP_OK 或 ESP_ERR_INVALID_STATE（已有通道在运行）
+ */
+esp_err_t adc_stream_init(const adc_stream_config_t *config);
+
+/**
+ * @brief 添加通道并（重新）启动连续采样
+ *
+ * 连续模式的转换序列在启动时固定，添加通道时停止、按全部通道重新配置后再启动，
+ * 已有通道的累加状态会清零。
+ *
+ * @param index 输出：通道下标（adc_stream_read 使用）
+ * @return esp_err_t
+ *   - ESP_OK: 成功（同一引脚已添加时返回原下标）
+ *   - ESP_ERR_INVALID_ARG: 参数错误
+ *   - ESP_ERR_NOT_SUPPORTED: 引脚不是ADC1通道
+ *   - ESP_ERR_NO_MEM: 通道数已达 CONFIG_ADC_STREAM_MAX_CHANNELS
+ *   - 其他: ADC驱动错误
+ */
+esp_err_t adc_stream_add_channel(const adc_stream_channel_config_t *config, int *index);
+
+/**
+ * @brief 读取通道最近的平均值
+ *
+ * @return ESP_OK，ESP_ERR_INVALID_ARG（下标无效），ESP_ERR_INVALID_STATE（还没有完整的平均值）
+ */
+esp_err_t adc_stream_read(int index, adc_stream_value_t *out);
+
+/**
+ * @brief 处理所有已完成的DMA帧（manual_service 时由调用者调用）
+ *
+ * @return 处理的帧数
+ */
+size_t adc_stream_service(void);
+
+/**
+ * @brief 获取运行统计
+ */
+esp_err_t adc_stream_get_stats(adc_stream_stats_t *stats);
+
+/**
+ * @brief 停止采样并删除所有通道
+ */
+void adc_stream_deinit(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ADC_STREAM_H
@@ -0,0 +1,502 @@
+/**
+ * @file adc_stream_continuous.c
+ * @brief 模拟量连续采样运行时：ADC连续模式驱动、DMA帧处理任务、标定与读数发布
+ *
+ * 所有通道编入同一个转换序列（只用ADC1，ADC2在部分芯片上与WiFi共用），
+ * ADC按 CONFIG_ADC_STREAM_SAMPLE_RATE_HZ 轮流转换，DMA每攒满一帧
+ * （采样率 / CONFIG_ADC_STREAM_FRAMES_PER_S 个样本）触发一次 on_conv_done 通知任务。
+ * 任务取出帧后逐个样本查表累加（adc_stream_reducer_put），帧末只对产生了新平均值的通道
+ * 做标定换算。采样率提高时每个样本的开销不变，任务唤醒次数也不变。
+ *
+ * 驱动内部缓冲池可存 POOL_FRAMES 帧，任务来不及处理时丢弃最旧的帧（flush_pool），
+ * 在 on_pool_ovf 中计数。
+ */
+
+#include "adc_stream.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "esp_adc/adc_continuous.h"
+#include "esp_adc/adc_cali.h"
+#include "esp_adc/adc_cali_scheme.h"
+#include "soc/soc_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "metrics.h"
+
+static const char *TAG = "adc_stream";
+
+#define LOCK()      xSemaphoreTake(s_mutex, portMAX_DELAY)
+#define UNLOCK()    xSemaphoreGive(s_mutex)
+
+#define FRAME_SAMPLES       (CONFIG_ADC_STREAM_SAMPLE_RATE_HZ / CONFIG_ADC_STREAM_FRAMES_PER_S)
+#define FRAME_BYTES         ((FRAME_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES) / SOC_ADC_DIGI_DATA_BYTES_PER_CONV * \
+                             SOC_ADC_DIGI_DATA_BYTES_PER_CONV)
+#define POOL_FRAMES         3
+#define RAW_MAX             ((1 << ADC_STREAM_RAW_BITS) - 1)
+
+// 输出格式：ESP32/ESP32-S2 为TYPE1（无unit字段），其余芯片为TYPE2
+#if CONFIG_IDF_TARGET_ESP32 || CONFIG_IDF_TARGET_ESP32S2
+#define OUTPUT_FORMAT       ADC_DIGI_OUTPUT_FORMAT_TYPE1
+#define SAMPLE_UNIT(p)      0
+#define SAMPLE_CHANNEL(p)   ((p)->type1.channel)
+#define SAMPLE_DATA(p)      ((p)->type1.data)
+#else
+#define OUTPUT_FORMAT       ADC_DIGI_OUTPUT_FORMAT_TYPE2
+#define SAMPLE_UNIT(p)      ((p)->type2.unit)
+#define SAMPLE_CHANNEL(p)   ((p)->type2.channel)
+#define SAMPLE_DATA(p)      ((p)->type2.data)
+#endif
+
+typedef struct {
+    adc_stream_channel_config_t config;
+    adc_channel_t channel;
+    adc_atten_t atten;
+    adc_cali_handle_t cali;             ///< NULL时按衰减档的典型满量程线性换算
+    adc_stream_value_t value;           ///< 已发布的读数
+} channel_t;
+
+static SemaphoreHandle_t s_mutex = NULL;
+
+static struct {
+    adc_stream_config_t config;
+    bool running;
+    adc_continuous_handle_t handle;
+    TaskHandle_t task;
+    channel_t channels[CONFIG_ADC_STREAM_MAX_CHANNELS];
+    uint8_t count;
+    adc_stream_reducer_t reducer;
+    volatile uint32_t pool_ovf;         ///< on_pool_ovf 中累加
+    adc_stream_stats_t stats;
+} s_adc;
+
+static uint8_t s_frame[FRAME_BYTES];
+
+METRIC_HISTOGRAM_DEFINE(s_m_frame_us, "adc_frame_us", 20, 50, 100, 200, 500, 1000);
+METRIC_COUNTER_DEFINE(s_m_overflows, "adc_pool_ovf");
+
+/* ==================== 标定 ==================== */
+
+static adc_atten_t atten_from_db(uint8_t db)
+{
+    switch (db) {
+    case 0:  return ADC_ATTEN_DB_0;
+    case 2:  return ADC_ATTEN_DB_2_5;
+    case 6:  return ADC_ATTEN_DB_6;
+    default: return ADC_ATTEN_DB_12;
+    }
+}
+
+/**
+ * @brief 没有eFuse标定数据时各衰减档的典型满量程（mV）
+ */
+static float full_scale_mv(adc_atten_t atten)
+{
+    switch (atten) {
+    case ADC_ATTEN_DB_0:   return 950.0f;
+    case ADC_ATTEN_DB_2_5: return 1250.0f;
+    case ADC_ATTEN_DB_6:   return 1750.0f;
+    default:               return 3100.0f;
+    }
+}
+
+static adc_cali_handle_t create_cali(adc_channel_t channel, adc_atten_t atten)
+{
+    adc_cali_handle_t handle = NULL;
+    esp_err_t ret = ESP_ERR_NOT_SUPPORTED;
+#if ADC_CALI_SCHEME_CURVE_FITTING_SUPPORTED
+    adc_cali_curve_fitting_config_t cali_config = {
+        .unit_id = ADC_UNIT_1,
+        .chan = channel,
+        .atten = atten,
+        .bitwidth = ADC_BITWIDTH_12,
+    };
+    ret = adc_cali_create_scheme_curve_fitting(&cali_config, &handle);
+#elif ADC_CALI_SCHEME_LINE_FITTING_SUPPORTED
+    adc_cali_line_fitting_config_t cali_config = {
+        .unit_id = ADC_UNIT_1,
+        .atten = atten,
+        .bitwidth = ADC_BITWIDTH_12,
+    };
+    ret = adc_cali_create_scheme_line_fitting(&cali_config, &handle);
+#endif
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ ADC1_CH%d 无标定数据，按典型满量程换算: %s", channel, esp_err_to_name(ret));
+        return NULL;
+    }
+    return handle;
+}
+
+static void delete_cali(adc_cali_handle_t handle)
+{
+    if (!handle) {
+        return;
+    }
+#if ADC_CALI_SCHEME_CURVE_FITTING_SUPPORTED
+    adc_cali_delete_scheme_curve_fitting(handle);
+#elif ADC_CALI_SCHEME_LINE_FITTING_SUPPORTED
+    adc_cali_delete_scheme_line_fitting(handle);
+#endif
+}
+
+/**
+ * @brief 平均值（带小数的12位刻度）换算成mV
+ *
+ * 标定接口只接受整数原始值，在相邻两个整数的标定结果之间线性插值，保留过采样得到的小数位。
+ */
+static float raw_to_mv(const channel_t *ch, float raw)
+{
+    if (ch->cali) {
+        int lo = (int)raw;
+        if (lo >= RAW_MAX) {
+            lo = RAW_MAX - 1;
+        }
+        int mv_lo = 0;
+        int mv_hi = 0;
+        if (adc_cali_raw_to_voltage(ch->cali, lo, &mv_lo) == ESP_OK &&
+            adc_cali_raw_to_voltage(ch->cali, lo + 1, &mv_hi) == ESP_OK) {
+            return (float)mv_lo + (raw - (float)lo) * (float)(mv_hi - mv_lo);
+        }
+    }
+    return raw * full_scale_mv(ch->atten) / (float)RAW_MAX;
+}
+
+/* ==================== 帧处理 ==================== */
+
+static void reduce_frame(const uint8_t *buf, uint32_t len)
+{
+    adc_stream_reducer_t *r = &s_adc.reducer;
+    for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= len; i += SOC_ADC_DIGI_RESULT_BYTES) {
+        const adc_digi_output_data_t *p = (const adc_digi_output_data_t *)&buf[i];
+        adc_stream_reducer_put(r, SAMPLE_UNIT(p), SAMPLE_CHANNEL(p), SAMPLE_DATA(p));
+    }
+}
+
+/**
+ * @brief 只换算本帧产生了新平均值的通道
+ */
+static void publish_locked(int64_t now_us)
+{
+    for (uint8_t i = 0; i < s_adc.count; i++) {
+        channel_t *ch = &s_adc.channels[i];
+        const adc_stream_acc_t *acc = &s_adc.reducer.acc[i];
+        if (acc->outputs == ch->value.outputs) {
+            continue;
+        }
+        ch->value.raw = adc_stream_reducer_raw(&s_adc.reducer, i);
+        ch->value.mv = raw_to_mv(ch, ch->value.raw);
+        ch->value.value = adc_stream_curve_eval(ch->config.curve, ch->value.mv);
+        ch->value.outputs = acc->outputs;
+        ch->value.updated_us = now_us;
+    }
+}
+
+/**
+ * @brief 取出驱动缓冲池中的全部完整帧
+ *
+ * @return 处理的帧数
+ */
+static size_t drain_frames(void)
+{
+    size_t frames = 0;
+    LOCK();
+    while (s_adc.handle) {
+        uint32_t len = 0;
+        if (adc_continuous_read(s_adc.handle, s_frame, sizeof(s_frame), &len, 0) != ESP_OK || len == 0) {
+            break;
+        }
+        int64_t start_us = esp_timer_get_time();
+        reduce_frame(s_frame, len);
+        publish_locked(start_us);
+        uint32_t elapsed_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+        metric_observe(&s_m_frame_us, elapsed_us);
+        s_adc.stats.frames++;
+        s_adc.stats.samples += len / SOC_ADC_DIGI_RESULT_BYTES;
+        if (elapsed_us > s_adc.stats.frame_us_max) {
+            s_adc.stats.frame_us_max = elapsed_us;
+        }
+        frames++;
+    }
+    uint32_t overflows = s_adc.pool_ovf;
+    if (overflows != s_adc.stats.overflows) {
+        metric_add(&s_m_overflows, overflows - s_adc.stats.overflows);
+        s_adc.stats.overflows = overflows;
+    }
+    UNLOCK();
+    return frames;
+}
+
+/* ==================== 驱动 ==================== */
+
+static bool IRAM_ATTR on_conv_done(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata,
+                                   void *user_data)
+{
+    (void)handle;
+    (void)edata;
+    (void)user_data;
+    BaseType_t woken = pdFALSE;
+    if (s_adc.task) {
+        vTaskNotifyGiveFromISR(s_adc.task, &woken);
+    }
+    return woken == pdTRUE;
+}
+
+static bool IRAM_ATTR on_pool_ovf(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata,
+                                  void *user_data)
+{
+    (void)handle;
+    (void)edata;
+    (void)user_data;
+    s_adc.pool_ovf++;
+    return false;
+}
+
+static void stop_locked(void)
+{
+    if (!s_adc.handle) {
+        return;
+    }
+    adc_continuous_stop(s_adc.handle);
+    adc_continuous_deinit(s_adc.handle);
+    s_adc.handle = NULL;
+}
+
+/**
+ * @brief 按当前全部通道重建转换序列并启动
+ */
+static esp_err_t restart_locked(void)
+{
+    stop_locked();
+    if (s_adc.count == 0) {
+        return ESP_OK;
+    }
+
+    adc_stream_reducer_init(&s_adc.reducer, CONFIG_ADC_STREAM_OVERSAMPLE_BITS);
+    adc_digi_pattern_config_t pattern[CONFIG_ADC_STREAM_MAX_CHANNELS];
+    for (uint8_t i = 0; i < s_adc.count; i++) {
+        channel_t *ch = &s_adc.channels[i];
+        pattern[i] = (adc_digi_pattern_config_t) {
+            .atten = ch->atten,
+            .channel = ch->channel,
+            .unit = ADC_UNIT_1,
+            .bit_width = SOC_ADC_DIGI_MAX_BITWIDTH,
+        };
+        adc_stream_reducer_add(&s_adc.reducer, ADC_UNIT_1, ch->channel);
+        memset(&ch->value, 0, sizeof(ch->value));
+    }
+
+    adc_continuous_handle_cfg_t handle_config = {
+        .max_store_buf_size = FRAME_BYTES * POOL_FRAMES,
+        .conv_frame_size = FRAME_BYTES,
+        .flags.flush_pool = 1,
+    };
+    esp_err_t ret = adc_continuous_new_handle(&handle_config, &s_adc.handle);
+    if (ret != ESP_OK) {
+        s_adc.handle = NULL;
+        return ret;
+    }
+
+    adc_continuous_config_t adc_config = {
+        .pattern_num = s_adc.count,
+        .adc_pattern = pattern,
+        .sample_freq_hz = CONFIG_ADC_STREAM_SAMPLE_RATE_HZ,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = OUTPUT_FORMAT,
+    };
+    adc_continuous_evt_cbs_t cbs = {
+        .on_conv_done = on_conv_done,
+        .on_pool_ovf = on_pool_ovf,
+    };
+    ret = adc_continuous_config(s_adc.handle, &adc_config);
+    if (ret == ESP_OK) {
+        ret = adc_continuous_register_event_callbacks(s_adc.handle, &cbs, NULL);
+    }
+    if (ret == ESP_OK) {
+        ret = adc_continuous_start(s_adc.handle);
+    }
+    if (ret != ESP_OK) {
+        adc_continuous_deinit(s_adc.handle);
+        s_adc.handle = NULL;
+    }
+    return ret;
+}
+
+/* ==================== 任务 ==================== */
+
+static void frame_task(void *arg)
+{
+    (void)arg;
+    while (s_adc.running) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        drain_frames();
+    }
+    s_adc.task = NULL;
+    vTaskDelete(NULL);
+}
+
+/* ==================== 接口 ==================== */
+
+static esp_err_t ensure_mutex(void)
+{
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t adc_stream_init(const adc_stream_config_t *config)
+{
+    if (!config) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = ensure_mutex();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    LOCK();
+    if (s_adc.count > 0) {
+        UNLOCK();
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_adc.config = *config;
+    UNLOCK();
+    return ESP_OK;
+}
+
+esp_err_t adc_stream_add_channel(const adc_stream_channel_config_t *config, int *index)
+{
+    if (!config || !index || config->gpio == GPIO_NUM_NC) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config->curve && config->curve->count > ADC_STREAM_CURVE_MAX_POINTS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = ensure_mutex();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    adc_unit_t unit;
+    adc_channel_t channel;
+    if (adc_continuous_io_to_channel(config->gpio, &unit, &channel) != ESP_OK || unit != ADC_UNIT_1) {
+        ESP_LOGE(TAG, "❌ GPIO%d 不是ADC1通道", config->gpio);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    LOCK();
+    for (uint8_t i = 0; i < s_adc.count; i++) {
+        if (s_adc.channels[i].config.gpio == config->gpio) {
+            *index = i;
+            UNLOCK();
+            return ESP_OK;
+        }
+    }
+    if (s_adc.count >= CONFIG_ADC_STREAM_MAX_CHANNELS) {
+        UNLOCK();
+        return ESP_ERR_NO_MEM;
+    }
+
+    channel_t *ch = &s_adc.channels[s_adc.count];
+    memset(ch, 0, sizeof(*ch));
+    ch->config = *config;
+    ch->channel = channel;
+    ch->atten = atten_from_db(config->atten_db);
+    ch->cali = create_cali(channel, ch->atten);
+    s_adc.count++;
+
+    ret = restart_locked();
+    if (ret != ESP_OK) {
+        // 撤销本通道，其余通道按原配置恢复
+        s_adc.count--;
+        delete_cali(ch->cali);
+        if (restart_locked() != ESP_OK) {
+            ESP_LOGE(TAG, "❌ ADC连续采样恢复失败");
+        }
+        UNLOCK();
+        ESP_LOGE(TAG, "❌ ADC连续采样启动失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    *index = s_adc.count - 1;
+    uint8_t count = s_adc.count;
+    UNLOCK();
+
+    if (!s_adc.running) {
+        s_adc.running = true;
+        if (!s_adc.config.manual_service &&
+            xTaskCreate(frame_task, "adc_stream", 3072, NULL, CONFIG_ADC_STREAM_TASK_PRIORITY, &s_adc.task) != pdPASS) {
+            s_adc.running = false;
+            adc_stream_deinit();
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    ESP_LOGI(TAG, "✅ %s: GPIO%d -> ADC1_CH%d, %d通道共 %d Hz, 每%d个样本平均一次",
+             config->name ? config->name : "ADC", config->gpio, channel, count,
+             CONFIG_ADC_STREAM_SAMPLE_RATE_HZ, 1 << (2 * CONFIG_ADC_STREAM_OVERSAMPLE_BITS));
+    return ESP_OK;
+}
+
+esp_err_t adc_stream_read(int index, adc_stream_value_t *out)
+{
+    if (!out || !s_mutex) {
+        return out ? ESP_ERR_INVALID_STATE : ESP_ERR_INVALID_ARG;
+    }
+    LOCK();
+    if (index < 0 || index >= s_adc.count) {
+        UNLOCK();
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out = s_adc.channels[index].value;
+    UNLOCK();
+    return out->outputs > 0 ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+size_t adc_stream_service(void)
+{
+    if (!s_adc.running || !s_adc.config.manual_service) {
+        return 0;
+    }
+    return drain_frames();
+}
+
+esp_err_t adc_stream_get_stats(adc_stream_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mutex) {
+        memset(stats, 0, sizeof(*stats));
+        return ESP_OK;
+    }
+    LOCK();
+    *stats = s_adc.stats;
+    stats->unknown = s_adc.reducer.unknown;
+    UNLOCK();
+    return ESP_OK;
+}
+
+void adc_stream_deinit(void)
+{
+    if (!s_mutex) {
+        return;
+    }
+    LOCK();
+    stop_locked();
+    for (uint8_t i = 0; i < s_adc.count; i++) {
+        delete_cali(s_adc.channels[i].cali);
+    }
+    s_adc.count = 0;
+    s_adc.running = false;
+    s_adc.pool_ovf = 0;
+    memset(&s_adc.stats, 0, sizeof(s_adc.stats));
+    UNLOCK();
+    if (s_adc.task) {
+        xTaskNotifyGive(s_adc.task);
+    }
+}
@@ -0,0 +1,373 @@
+/**
+ * @file alarm.c
+ * @brief 设备端告警规则引擎实现
+ *
+ * 规则和状态放在同一个定长数组中，alarm_feed 线性查找（规则数很少）。
+ * 判断在锁内完成，产生的事件先暂存，释放锁后再回调，回调中可以发布MQTT。
+ */
+
+#include "alarm.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+#include "json_writer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "ALARM";
+
+/**
+ * @brief 单个告警类型的去抖状态
+ */
+typedef struct {
+    bool active;                   ///< 当前是否处于告警
+    uint8_t count;                 ///< 与当前状态相反的条件已连续成立的次数
+} kind_state_t;
+
+/**
+ * @brief 规则及其运行状态
+ */
+typedef struct {
+    alarm_rule_t rule;
+    kind_state_t kinds[ALARM_KIND_COUNT];
+    bool has_last;                 ///< 是否已有上一次采样
+    float last_value;
+    uint32_t last_ms;
+    float stuck_ref;               ///< 卡死判定的参考值
+    uint32_t stuck_since_ms;       ///< 数值保持在参考值附近的起始时间
+} rule_slot_t;
+
+static rule_slot_t s_slots[ALARM_MAX_RULES];
+static size_t s_slot_count = 0;
+static alarm_event_cb_t s_cb = NULL;
+static void *s_cb_ctx = NULL;
+static SemaphoreHandle_t s_mutex = NULL;
+
+#define LOCK()      do { if (s_mutex) xSemaphoreTake(s_mutex, portMAX_DELAY); } while (0)
+#define UNLOCK()    do { if (s_mutex) xSemaphoreGive(s_mutex); } while (0)
+
+static const char *s_kind_names[ALARM_KIND_COUNT] = { "low", "high", "rate", "stuck" };
+
+const char *alarm_kind_name(alarm_kind_t kind)
+{
+    return kind < ALARM_KIND_COUNT ? s_kind_names[kind] : "unknown";
+}
+
+esp_err_t alarm_init(alarm_event_cb_t cb, void *ctx)
+{
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    LOCK();
+    s_cb = cb;
+    s_cb_ctx = ctx;
+    UNLOCK();
+    return ESP_OK;
+}
+
+esp_err_t alarm_rule_validate(const alarm_rule_t *rule)
+{
+    if (!rule || !(rule->checks & (ALARM_CHECK_MIN | ALARM_CHECK_MAX | ALARM_CHECK_RATE | ALARM_CHECK_STUCK))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if ((rule->checks & ALARM_CHECK_MIN) && !isfinite(rule->min)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if ((rule->checks & ALARM_CHECK_MAX) && !isfinite(rule->max)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if ((rule->checks & ALARM_CHECK_MIN) && (rule->checks & ALARM_CHECK_MAX) && rule->min > rule->max) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if ((rule->checks & (ALARM_CHECK_MIN | ALARM_CHECK_MAX)) &&
+        !(rule->hysteresis >= 0.0f && isfinite(rule->hysteresis))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if ((rule->checks & ALARM_CHECK_RATE) && !(rule->rate > 0.0f && isfinite(rule->rate))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if ((rule->checks & ALARM_CHECK_STUCK) &&
+        (rule->stuck_sec == 0 || !(rule->stuck_epsilon >= 0.0f && isfinite(rule->stuck_epsilon)))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+static rule_slot_t *find_slot(uint8_t sensor, uint8_t channel)
+{
+    for (size_t i = 0; i < s_slot_count; i++) {
+        if (s_slots[i].rule.sensor == sensor && s_slots[i].rule.channel == channel) {
+            return &s_slots[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t alarm_set_rule(const alarm_rule_t *rule)
+{
+    esp_err_t err = alarm_rule_validate(rule);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    LOCK();
+    rule_slot_t *slot = find_slot(rule->sensor, rule->channel);
+    if (!slot && s_slot_count < ALARM_MAX_RULES) {
+        slot = &s_slots[s_slot_count++];
+    }
+    if (slot) {
+        memset(slot, 0, sizeof(*slot));
+        slot->rule = *rule;
+    }
+    UNLOCK();
+
+    if (!slot) {
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "🔔 告警规则已设置: 传感器%u 通道%u 判断0x%02x",
+             rule->sensor, rule->channel, rule->checks);
+    return ESP_OK;
+}
+
+esp_err_t alarm_remove_rule(uint8_t sensor, uint8_t channel)
+{
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+
+    LOCK();
+    rule_slot_t *slot = find_slot(sensor, channel);
+    if (slot) {
+        size_t idx = slot - s_slots;
+        memmove(&s_slots[idx], &s_slots[idx + 1], (s_slot_count - idx - 1) * sizeof(rule_slot_t));
+        s_slot_count--;
+        err = ESP_OK;
+    }
+    UNLOCK();
+    return err;
+}
+
+size_t alarm_load_rules(const alarm_rule_t *rules, size_t count)
+{
+    size_t loaded = 0;
+
+    LOCK();
+    s_slot_count = 0;
+    for (size_t i = 0; rules && i < count && s_slot_count < ALARM_MAX_RULES; i++) {
+        if (alarm_rule_validate(&rules[i]) != ESP_OK ||
+            find_slot(rules[i].sensor, rules[i].channel)) {
+            ESP_LOGW(TAG, "⚠️ 跳过无效或重复的告警规则: 传感器%u 通道%u", rules[i].sensor, rules[i].channel);
+            continue;
+        }
+        rule_slot_t *slot = &s_slots[s_slot_count++];
+        memset(slot, 0, sizeof(*slot));
+        slot->rule = rules[i];
+        loaded++;
+    }
+    UNLOCK();
+    return loaded;
+}
+
+size_t alarm_get_rules(alarm_rule_t *out)
+{
+    size_t count;
+
+    LOCK();
+    count = s_slot_count;
+    for (size_t i = 0; out && i < count; i++) {
+        out[i] = s_slots[i].rule;
+    }
+    UNLOCK();
+    return count;
+}
+
+/**
+ * @brief 去抖：条件成立（raise）或解除（clear）连续debounce次后切换状态
+ *
+ * @return true 状态发生切换
+ */
+static bool debounce(kind_state_t *ks, bool raise, bool clear, uint8_t n)
+{
+    bool toward = ks->active ? clear : raise;
+    if (!toward) {
+        ks->count = 0;
+        return false;
+    }
+    if (++ks->count < (n ? n : 1)) {
+        return false;
+    }
+    ks->active = !ks->active;
+    ks->count = 0;
+    return true;
+}
+
+void alarm_feed(uint8_t sensor, uint8_t channel, float value, uint32_t time_ms)
+{
+    alarm_event_t events[ALARM_KIND_COUNT];
+    size_t event_count = 0;
+    alarm_event_cb_t cb;
+    void *cb_ctx;
+
+    if (!isfinite(value)) {
+        return;
+    }
+
+    LOCK();
+    rule_slot_t *slot = find_slot(sensor, channel);
+    if (!slot) {
+        UNLOCK();
+        return;
+    }
+
+    const alarm_rule_t *r = &slot->rule;
+    bool changed[ALARM_KIND_COUNT] = { false };
+    float observed[ALARM_KIND_COUNT] = { value, value, 0.0f, value };
+    float threshold[ALARM_KIND_COUNT] = { r->min, r->max, r->rate, (float)r->stuck_sec };
+
+    if (r->checks & ALARM_CHECK_MIN) {
+        changed[ALARM_KIND_LOW] = debounce(&slot->kinds[ALARM_KIND_LOW],
+                                           value < r->min, value > r->min + r->hysteresis, r->debounce);
+    }
+    if (r->checks & ALARM_CHECK_MAX) {
+        changed[ALARM_KIND_HIGH] = debounce(&slot->kinds[ALARM_KIND_HIGH],
+                                            value > r->max, value < r->max - r->hysteresis, r->debounce);
+    }
+    if ((r->checks & ALARM_CHECK_RATE) && slot->has_last && time_ms != slot->last_ms) {
+        float per_min = fabsf(value - slot->last_value) * 60000.0f / (float)(time_ms - slot->last_ms);
+        observed[ALARM_KIND_RATE] = per_min;
+        changed[ALARM_KIND_RATE] = debounce(&slot->kinds[ALARM_KIND_RATE],
+                                            per_min > r->rate, per_min <= r->rate, r->debounce);
+    }
+    if (r->checks & ALARM_CHECK_STUCK) {
+        if (!slot->has_last || fabsf(value - slot->stuck_ref) > r->stuck_epsilon) {
+            slot->stuck_ref = value;
+            slot->stuck_since_ms = time_ms;
+        }
+        bool stuck = (time_ms - slot->stuck_since_ms) >= r->stuck_sec * 1000U;
+        // 数值一旦变化立即解除，不需要去抖
+        kind_state_t *ks = &slot->kinds[ALARM_KIND_STUCK];
+        if (ks->active && !stuck) {
+            ks->active = false;
+            ks->count = 0;
+            changed[ALARM_KIND_STUCK] = true;
+        } else if (!ks->active && stuck) {
+            ks->active = true;
+            changed[ALARM_KIND_STUCK] = true;
+        }
+    }
+
+    slot->has_last = true;
+    slot->last_value = value;
+    slot->last_ms = time_ms;
+
+    for (int k = 0; k < ALARM_KIND_COUNT; k++) {
+        if (!changed[k]) {
+            continue;
+        }
+        events[event_count++] = (alarm_event_t){
+            .sensor = sensor,
+            .channel = channel,
+            .kind = (alarm_kind_t)k,
+            .active = slot->kinds[k].active,
+            .value = observed[k],
+            .threshold = threshold[k],
+            .time_ms = time_ms,
+        };
+    }
+    cb = s_cb;
+    cb_ctx = s_cb_ctx;
+    UNLOCK();
+
+    for (size_t i = 0; i < event_count; i++) {
+        ESP_LOGW(TAG, "%s 传感器%u 通道%u %s告警: 数值%.2f 阈值%.2f",
+                 events[i].active ? "🚨" : "✅", sensor, channel,
+                 alarm_kind_name(events[i].kind), events[i].value, events[i].threshold);
+        if (cb) {
+            cb(&events[i], cb_ctx);
+        }
+    }
+}
+
+size_t alarm_active_count(void)
+{
+    size_t n = 0;
+
+    LOCK();
+    for (size_t i = 0; i < s_slot_count; i++) {
+        for (int k = 0; k < ALARM_KIND_COUNT; k++) {
+            n += s_slots[i].kinds[k].active ? 1 : 0;
+        }
+    }
+    UNLOCK();
+    return n;
+}
+
+/* ==================== JSON ==================== */
+
+esp_err_t alarm_status_json(char *buf, size_t buf_size, size_t *out_len)
+{
+    if (!buf || buf_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    json_writer_t w;
+    json_writer_init(&w, buf, buf_size);
+
+    LOCK();
+    json_writer_printf(&w, "{\"rules\":[");
+    for (size_t i = 0; i < s_slot_count; i++) {
+        const rule_slot_t *s = &s_slots[i];
+        const alarm_rule_t *r = &s->rule;
+        json_writer_printf(&w, "%s{\"sensor\":%u,\"channel\":%u,\"debounce\":%u",
+                  i ? "," : "", r->sensor, r->channel, r->debounce ? r->debounce : 1);
+        if (r->checks & ALARM_CHECK_MIN) {
+            json_writer_printf(&w, ",\"min\":%g", (double)r->min);
+        }
+        if (r->checks & ALARM_CHECK_MAX) {
+            json_writer_printf(&w, ",\"max\":%g", (double)r->max);
+        }
+        if (r->checks & (ALARM_CHECK_MIN | ALARM_CHECK_MAX)) {
+            json_writer_printf(&w, ",\"hysteresis\":%g", (double)r->hysteresis);
+        }
+        if (r->checks & ALARM_CHECK_RATE) {
+            json_writer_printf(&w, ",\"rate\":%g", (double)r->rate);
+        }
+        if (r->checks & ALARM_CHECK_STUCK) {
+            json_writer_printf(&w, ",\"stuck_sec\":%lu,\"stuck_epsilon\":%g",
+                      (unsigned long)r->stuck_sec, (double)r->stuck_epsilon);
+        }
+        json_writer_printf(&w, ",\"active\":[");
+        bool first = true;
+        for (int k = 0; k < ALARM_KIND_COUNT; k++) {
+            if (s->kinds[k].active) {
+                json_writer_printf(&w, "%s\"%s\"", first ? "" : ",", s_kind_names[k]);
+                first = false;
+            }
+        }
+        json_writer_printf(&w, "]}");
+    }
+    json_writer_printf(&w, "]}");
+    UNLOCK();
+
+    return json_writer_finish(&w, out_len);
+}
+
+size_t alarm_event_json(const alarm_event_t *event, char *buf, size_t buf_size)
+{
+    if (!event || !buf || buf_size == 0) {
+        return 0;
+    }
+
+    int n = snprintf(buf, buf_size,
+                     "{\"sensor\":%u,\"channel\":%u,\"alarm\":\"%s\",\"state\":\"%s\","
+                     "\"value\":%.2f,\"threshold\":%g,\"time\":%lu}",
+                     event->sensor, event->channel, alarm_kind_name(event->kind),
+                     event->active ? "active" : "cleared", (double)event->value,
+                     (double)event->threshold, (unsigned long)event->time_ms);
+    if (n < 0 || (size_t)n >= buf_size) {
+        return 0;
+    }
+    return (size_t)n;
+}
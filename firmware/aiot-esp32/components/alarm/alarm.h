@@ -0,0 +1,194 @@
+/**
+ * @file alarm.h
+ * @brief 设备端告警规则引擎
+ *
+ * 每个传感器通道可配置一条规则，每次采样后调用 alarm_feed() 就地判断：
+ * - 上下限：超过max / 低于min时告警，回到 max-hysteresis / min+hysteresis 以内才解除
+ * - 变化率：相邻两次采样的变化速度（每分钟）超过rate时告警
+ * - 卡死：数值在stuck_sec秒内变化不超过stuck_epsilon时告警（传感器失效或线路断开）
+ * 条件需连续debounce次采样成立才告警，连续debounce次不成立才解除，
+ * 避免在阈值附近抖动时反复上报。
+ *
+ * 告警产生和解除时通过回调上报（设备上以QoS1发布到 devices/<uuid>/alarm），
+ * 服务端不需要逐条分析遥测数据即可及时收到告警，遥测上报频率可以降低。
+ *
+ * 传感器ID与 sample_store 的 sample_sensor_id_t 一致，本组件不依赖具体传感器。
+ */
+
+#ifndef ALARM_H
+#define ALARM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_ALARM_MAX_RULES
+#define CONFIG_ALARM_MAX_RULES          8
+#endif
+
+#define ALARM_MAX_RULES                 CONFIG_ALARM_MAX_RULES
+
+/**
+ * @brief 规则中启用的判断（按位或）
+ */
+#define ALARM_CHECK_MIN                 0x01    ///< 下限
+#define ALARM_CHECK_MAX                 0x02    ///< 上限
+#define ALARM_CHECK_RATE                0x04    ///< 变化率
+#define ALARM_CHECK_STUCK               0x08    ///< 卡死
+
+/**
+ * @brief 告警类型
+ */
+typedef enum {
+    ALARM_KIND_LOW = 0,            ///< 低于下限
+    ALARM_KIND_HIGH,               ///< 高于上限
+    ALARM_KIND_RATE,               ///< 变化过快
+    ALARM_KIND_STUCK,              ///< 数值卡死
+    ALARM_KIND_COUNT,
+} alarm_kind_t;
+
+/**
+ * @brief 告警规则（按传感器+通道唯一）
+ *
+ * 结构体会原样保存到NVS，修改字段时需要同时修改配置缓存的格式版本。
+ */
+typedef struct {
+    uint8_t sensor;                ///< 传感器ID（sample_sensor_id_t）
+    uint8_t channel;               ///< 通道
+    uint8_t checks;                ///< 启用的判断（ALARM_CHECK_*）
+    uint8_t debounce;              ///< 连续多少次采样成立才告警/解除（0按1处理）
+    float min;                     ///< 下限
+    float max;                     ///< 上限
+    float hysteresis;              ///< 上下限的解除回差（>=0）
+    float rate;                    ///< 变化率上限（单位/分钟，>0）
+    float stuck_epsilon;           ///< 变化不超过该值视为未变化（>=0）
+    uint32_t stuck_sec;            ///< 卡死判定时间（秒，>0）
+} alarm_rule_t;
+
+/**
+ * @brief 告警事件
+ */
+typedef struct {
+    uint8_t sensor;                ///< 传感器ID
+    uint8_t channel;               ///< 通道
+    alarm_kind_t kind;             ///< 告警类型
+    bool active;                   ///< true=产生，false=解除
+    float value;                   ///< 触发时的数值（变化率告警为每分钟变化量）
+    float threshold;               ///< 对应的阈值（卡死告警为stuck_sec）
+    uint32_t time_ms;              ///< 触发时间（alarm_feed传入的时间）
+} alarm_event_t;
+
+/**
+ * @brief 告警事件回调（在调用alarm_feed的任务中执行，不持有内部锁）
+ */
+typedef void (*alarm_event_cb_t)(const alarm_event_t *event, void *ctx);
+
+/**
+ * @brief 初始化告警引擎
+ *
+ * @param cb 事件回调（可为NULL，只记录状态）
+ * @param ctx 回调参数
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_NO_MEM: 创建锁失败
+ */
+esp_err_t alarm_init(alarm_event_cb_t cb, void *ctx);
+
+/**
+ * @brief 检查规则参数
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 有效
+ *   - ESP_ERR_INVALID_ARG: 未启用任何判断、min>max、负的回差或非正的变化率/卡死时间
+ */
+esp_err_t alarm_rule_validate(const alarm_rule_t *rule);
+
+/**
+ * @brief 设置规则（同一传感器+通道的规则被替换，告警状态清零）
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 规则无效
+ *   - ESP_ERR_NO_MEM: 规则已满
+ */
+esp_err_t alarm_set_rule(const alarm_rule_t *rule);
+
+/**
+ * @brief 删除规则（已产生的告警不再上报解除）
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_NOT_FOUND: 没有该规则
+ */
+esp_err_t alarm_remove_rule(uint8_t sensor, uint8_t channel);
+
+/**
+ * @brief 用一组规则替换全部规则（开机从配置加载时使用）
+ *
+ * 无效的规则被跳过。
+ *
+ * @return 实际加载的规则数
+ */
+size_t alarm_load_rules(const alarm_rule_t *rules, size_t count);
+
+/**
+ * @brief 读取当前全部规则
+ *
+ * @param out 输出数组（至少ALARM_MAX_RULES个）
+ * @return 规则数
+ */
+size_t alarm_get_rules(alarm_rule_t *out);
+
+/**
+ * @brief 输入一次采样并判断告警
+ *
+ * 没有对应规则时只做一次查找就返回。
+ *
+ * @param sensor 传感器ID
+ * @param channel 通道
+ * @param value 数值
+ * @param time_ms 采样时间（毫秒，单调递增）
+ */
+void alarm_feed(uint8_t sensor, uint8_t channel, float value, uint32_t time_ms);
+
+/**
+ * @brief 当前处于告警状态的数量
+ */
+size_t alarm_active_count(void);
+
+/**
+ * @brief 生成规则和告警状态JSON
+ *
+ * 格式：{"rules":[{"sensor":1,"channel":0,"min":..,"max":..,...,"active":["high"]}]}
+ * 未启用的判断不输出对应字段。
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_SIZE: 缓冲区不足
+ */
+esp_err_t alarm_status_json(char *buf, size_t buf_size, size_t *out_len);
+
+/**
+ * @brief 把告警事件格式化为JSON
+ *
+ * 格式：{"sensor":1,"channel":0,"alarm":"high","state":"active","value":31.2,"threshold":30,"time":12345}
+ *
+ * @return 写入的长度，缓冲区不足时返回0
+ */
+size_t alarm_event_json(const alarm_event_t *event, char *buf, size_t buf_size);
+
+/**
+ * @brief 告警类型名（"low"/"high"/"rate"/"stuck"）
+ */
+const char *alarm_kind_name(alarm_kind_t kind);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ALARM_H
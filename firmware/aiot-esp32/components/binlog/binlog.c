@@ -0,0 +1,562 @@
+/**
+ * @file binlog.c
+ * @brief 二进制延迟日志实现
+ *
+ * 写入路径：屏蔽本核中断 -> 拷贝若干32位字到本核环形缓冲区 -> 发布head，
+ * 不格式化、不加锁、不访问Flash，可在中断中调用。
+ *
+ * 写出路径：低优先级任务定期取出各核记录，按扇区追加到logs分区
+ * （扇区头带序号，写满后循环覆盖最旧扇区），并可选格式化输出到串口。
+ */
+
+#include "binlog.h"
+#include <stdio.h>
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "esp_partition.h"
+#include "esp_app_desc.h"
+#include "esp_memory_utils.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "BINLOG";
+
+#define RING_WORDS          (CONFIG_BINLOG_RING_SIZE / sizeof(uint32_t))
+#define RING_MASK           (RING_WORDS - 1)
+#define RECORD_MAX_WORDS    (BINLOG_RECORD_HEADER_WORDS + BINLOG_MAX_ARGS)
+#define SECTOR_MAGIC        0x474F4C42  // "BLOG"
+#define SECTOR_VERSION      1
+#define STAGING_SIZE        512         // 每次Flash写入的最大字节数
+#define FORMAT_BUF_SIZE     256
+
+_Static_assert((RING_WORDS & RING_MASK) == 0, "CONFIG_BINLOG_RING_SIZE must be a power of two");
+
+// 每核一个环形缓冲区：生产者只在本核（屏蔽中断）写head，消费者只写tail
+typedef struct {
+    uint32_t words[RING_WORDS];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t written;
+    uint32_t dropped;
+} binlog_ring_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t seq_inv;              // ~seq，用于识别写断的扇区头
+    uint16_t version;
+    uint16_t reserved;
+    uint8_t elf_id[8];
+    uint8_t reserved2[8];
+} sector_header_t;
+
+_Static_assert(sizeof(sector_header_t) == BINLOG_SECTOR_HEADER_SIZE, "sector header size");
+
+esp_log_level_t binlog_level = (esp_log_level_t)CONFIG_BINLOG_DEFAULT_LEVEL;
+
+static binlog_ring_t s_rings[portNUM_PROCESSORS];
+
+static struct {
+    const esp_partition_t *partition;
+    uint32_t sector_count;
+    uint32_t head;                 // 写入扇区（物理序号）
+    uint32_t head_seq;
+    uint32_t used;                 // 日志扇区数
+    uint32_t write_off;            // 写入扇区中已写入Flash的位置
+    uint8_t staging[STAGING_SIZE]; // 待写入 write_off 处的数据
+    uint32_t staging_len;
+    uint32_t flushed;
+    uint8_t elf_id[8];
+    bool uart_echo;
+    SemaphoreHandle_t mutex;
+    TaskHandle_t task;
+} s_log;
+
+/* ==================== 写入路径 ==================== */
+
+void IRAM_ATTR binlog_write(esp_log_level_t level, const char *tag, const char *fmt,
+                            const uint32_t *args, size_t nargs)
+{
+    if (nargs > BINLOG_MAX_ARGS) {
+        nargs = BINLOG_MAX_ARGS;
+    }
+    uint32_t words = BINLOG_RECORD_HEADER_WORDS + nargs;
+    uint32_t timestamp = (uint32_t)(esp_timer_get_time() / 1000);
+
+    UBaseType_t irq_state = portSET_INTERRUPT_MASK_FROM_ISR();
+    uint32_t core = xPortGetCoreID();
+    binlog_ring_t *ring = &s_rings[core];
+    uint32_t head = ring->head;
+
+    if (RING_WORDS - (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE)) < words) {
+        ring->dropped++;
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(irq_state);
+        return;
+    }
+
+    ring->words[head++ & RING_MASK] = BINLOG_RECORD_MAGIC |
+                                      (((uint32_t)level & 0x0F) | (core << 4)) << 8 |
+                                      (uint32_t)nargs << 16;
+    ring->words[head++ & RING_MASK] = timestamp;
+    ring->words[head++ & RING_MASK] = (uint32_t)(uintptr_t)fmt;
+    ring->words[head++ & RING_MASK] = (uint32_t)(uintptr_t)tag;
+    for (size_t i = 0; i < nargs; i++) {
+        ring->words[head++ & RING_MASK] = args[i];
+    }
+    __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+    ring->written++;
+
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(irq_state);
+}
+
+// 取出一条记录，返回字数（0表示为空）
+static uint32_t ring_pop(binlog_ring_t *ring, uint32_t *record)
+{
+    uint32_t tail = ring->tail;
+    if (tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+
+    uint32_t words = BINLOG_RECORD_HEADER_WORDS + ((ring->words[tail & RING_MASK] >> 16) & 0xFF);
+    for (uint32_t i = 0; i < words; i++) {
+        record[i] = ring->words[(tail + i) & RING_MASK];
+    }
+    __atomic_store_n(&ring->tail, tail + words, __ATOMIC_RELEASE);
+    return words;
+}
+
+/* ==================== 文本格式化 ==================== */
+
+// 指针指向Flash常量区（.rodata）时才解引用。DRAM里的字符串可能在任务栈或堆上，
+// 写出任务处理记录时原缓冲区早已释放或复用，只输出地址
+static bool const_string(uint32_t addr)
+{
+    const void *p = (const void *)(uintptr_t)addr;
+    return p != NULL && esp_ptr_in_drom(p);
+}
+
+static void format_record(char *out, size_t size, const char *fmt, const uint32_t *args, uint32_t nargs)
+{
+    size_t len = 0;
+    uint32_t arg = 0;
+    char spec[16];
+
+    out[0] = '\0';
+    while (*fmt && len + 1 < size) {
+        if (*fmt != '%') {
+            out[len++] = *fmt++;
+            out[len] = '\0';
+            continue;
+        }
+
+        // 复制转换说明（标志/宽度/精度），去掉长度修饰符
+        size_t spec_len = 0;
+        spec[spec_len++] = *fmt++;
+        while (*fmt && strchr("-+ #0123456789.", *fmt) && spec_len < sizeof(spec) - 2) {
+            spec[spec_len++] = *fmt++;
+        }
+        while (*fmt && strchr("hlzjt", *fmt)) {
+            fmt++;
+        }
+        char conv = *fmt ? *fmt++ : '\0';
+        spec[spec_len++] = conv;
+        spec[spec_len] = '\0';
+
+        if (conv == '%') {
+            out[len++] = '%';
+            out[len] = '\0';
+            continue;
+        }
+        if (conv == '\0' || arg >= nargs) {
+            break;
+        }
+
+        uint32_t value = args[arg++];
+        int n;
+        switch (conv) {
+            case 'd':
+            case 'i':
+                n = snprintf(out + len, size - len, spec, (int)value);
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': {
+                float f;
+                memcpy(&f, &value, sizeof(f));
+                n = snprintf(out + len, size - len, spec, (double)f);
+                break;
+            }
+            case 's':
+                if (const_string(value)) {
+                    n = snprintf(out + len, size - len, spec, (const char *)(uintptr_t)value);
+                } else {
+                    n = snprintf(out + len, size - len, "<str@0x%08lx>", (unsigned long)value);
+                }
+                break;
+            case 'p':
+                n = snprintf(out + len, size - len, "0x%08lx", (unsigned long)value);
+                break;
+            default:
+                n = snprintf(out + len, size - len, spec, (unsigned int)value);
+                break;
+        }
+        if (n < 0) {
+            break;
+        }
+        len += (size_t)n < size - len ? (size_t)n : size - len - 1;
+    }
+}
+
+static void echo_record(const uint32_t *record)
+{
+    static const char level_chars[] = "NEWIDV";
+    static char text[FORMAT_BUF_SIZE];
+    uint32_t level = (record[0] >> 8) & 0x0F;
+    uint32_t nargs = (record[0] >> 16) & 0xFF;
+    const char *tag = const_string(record[3]) ? (const char *)(uintptr_t)record[3] : "?";
+
+    if (const_string(record[2])) {
+        format_record(text, sizeof(text), (const char *)(uintptr_t)record[2],
+                      &record[BINLOG_RECORD_HEADER_WORDS], nargs);
+    } else {
+        snprintf(text, sizeof(text), "<fmt@0x%08lx>", (unsigned long)record[2]);
+    }
+    printf("%c (%lu) %s: %s\n", level < sizeof(level_chars) - 1 ? level_chars[level] : '?',
+           (unsigned long)record[1], tag, text);
+}
+
+/* ==================== Flash写出 ==================== */
+
+static inline uint32_t sector_addr(uint32_t sector)
+{
+    return sector * BINLOG_SECTOR_SIZE;
+}
+
+static bool record_header_valid(uint32_t word0)
+{
+    return (word0 & 0xFF) == BINLOG_RECORD_MAGIC && ((word0 >> 16) & 0xFF) <= BINLOG_MAX_ARGS;
+}
+
+static uint32_t record_bytes(uint32_t word0)
+{
+    return (BINLOG_RECORD_HEADER_WORDS + ((word0 >> 16) & 0xFF)) * sizeof(uint32_t);
+}
+
+static esp_err_t flush_staging(void)
+{
+    if (s_log.staging_len == 0) {
+        return ESP_OK;
+    }
+    esp_err_t ret = esp_partition_write(s_log.partition, sector_addr(s_log.head) + s_log.write_off,
+                                        s_log.staging, s_log.staging_len);
+    // 写失败时同样跳过这段空间，避免在未擦除的位置重复写入
+    s_log.write_off += s_log.staging_len;
+    s_log.staging_len = 0;
+    return ret;
+}
+
+static esp_err_t open_next_sector(void)
+{
+    uint32_t next = s_log.used == 0 ? s_log.head : (s_log.head + 1) % s_log.sector_count;
+    if (s_log.used == s_log.sector_count) {
+        s_log.used--;  // 覆盖最旧扇区
+    }
+
+    esp_err_t ret = esp_partition_erase_range(s_log.partition, sector_addr(next), BINLOG_SECTOR_SIZE);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    sector_header_t hdr;
+    memset(&hdr, 0xFF, sizeof(hdr));
+    hdr.magic = SECTOR_MAGIC;
+    hdr.seq = s_log.head_seq + 1;
+    hdr.seq_inv = ~hdr.seq;
+    hdr.version = SECTOR_VERSION;
+    memcpy(hdr.elf_id, s_log.elf_id, sizeof(hdr.elf_id));
+    ret = esp_partition_write(s_log.partition, sector_addr(next), &hdr, sizeof(hdr));
+
+    s_log.head = next;
+    s_log.head_seq++;
+    s_log.used++;
+    s_log.write_off = BINLOG_SECTOR_HEADER_SIZE;
+    return ret;
+}
+
+static void stage_record(const uint32_t *record)
+{
+    uint32_t bytes = record_bytes(record[0]);
+
+    if (s_log.used == 0 || s_log.write_off + s_log.staging_len + bytes > BINLOG_SECTOR_SIZE) {
+        flush_staging();
+        if (open_next_sector() != ESP_OK) {
+            return;
+        }
+    } else if (s_log.staging_len + bytes > STAGING_SIZE) {
+        flush_staging();
+    }
+
+    memcpy(s_log.staging + s_log.staging_len, record, bytes);
+    s_log.staging_len += bytes;
+    s_log.flushed++;
+}
+
+static void drain_rings(void)
+{
+    uint32_t record[RECORD_MAX_WORDS];
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        while (ring_pop(&s_rings[core], record) > 0) {
+            if (s_log.partition) {
+                stage_record(record);
+            }
+            if (s_log.uart_echo) {
+                echo_record(record);
+            }
+        }
+    }
+    if (s_log.partition) {
+        flush_staging();
+    }
+}
+
+static void binlog_task(void *arg)
+{
+    (void)arg;
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CONFIG_BINLOG_FLUSH_INTERVAL_MS));
+        xSemaphoreTake(s_log.mutex, portMAX_DELAY);
+        drain_rings();
+        xSemaphoreGive(s_log.mutex);
+    }
+}
+
+/* ==================== 挂载 ==================== */
+
+static bool sector_header_valid(const sector_header_t *hdr)
+{
+    return hdr->magic == SECTOR_MAGIC && hdr->seq_inv == ~hdr->seq && hdr->version == SECTOR_VERSION;
+}
+
+// 解析写入扇区中的记录，恢复写位置
+static uint32_t find_write_offset(uint32_t sector)
+{
+    uint32_t off = BINLOG_SECTOR_HEADER_SIZE;
+    uint32_t word0;
+
+    while (off + sizeof(word0) <= BINLOG_SECTOR_SIZE) {
+        if (esp_partition_read(s_log.partition, sector_addr(sector) + off, &word0, sizeof(word0)) != ESP_OK) {
+            return BINLOG_SECTOR_SIZE;
+        }
+        if (word0 == 0xFFFFFFFF) {
+            return off;
+        }
+        if (!record_header_valid(word0) || off + record_bytes(word0) > BINLOG_SECTOR_SIZE) {
+            // 记录损坏：放弃本扇区剩余空间，下次写入换新扇区
+            return BINLOG_SECTOR_SIZE;
+        }
+        off += record_bytes(word0);
+    }
+    return off;
+}
+
+static esp_err_t mount_partition(void)
+{
+    sector_header_t hdr;
+    uint32_t head = 0;
+    uint32_t head_seq = 0;
+
+    s_log.sector_count = s_log.partition->size / BINLOG_SECTOR_SIZE;
+    if (s_log.sector_count < 2) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    for (uint32_t i = 0; i < s_log.sector_count; i++) {
+        esp_err_t ret = esp_partition_read(s_log.partition, sector_addr(i), &hdr, sizeof(hdr));
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        if (sector_header_valid(&hdr) && hdr.seq > head_seq) {
+            head_seq = hdr.seq;
+            head = i;
+        }
+    }
+
+    s_log.head = head;
+    s_log.head_seq = head_seq;
+    s_log.used = 0;
+    if (head_seq == 0) {
+        return ESP_OK;
+    }
+
+    // 从写入扇区往回，序号连续的扇区组成日志
+    s_log.used = 1;
+    while (s_log.used < s_log.sector_count) {
+        uint32_t prev = (head + s_log.sector_count - s_log.used) % s_log.sector_count;
+        if (esp_partition_read(s_log.partition, sector_addr(prev), &hdr, sizeof(hdr)) != ESP_OK ||
+            !sector_header_valid(&hdr) || hdr.seq != head_seq - s_log.used) {
+            break;
+        }
+        s_log.used++;
+    }
+    s_log.write_off = find_write_offset(head);
+    return ESP_OK;
+}
+
+esp_err_t binlog_init(void)
+{
+    if (s_log.mutex) {
+        return ESP_OK;
+    }
+
+    s_log.mutex = xSemaphoreCreateMutex();
+    if (s_log.mutex == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+#ifdef CONFIG_BINLOG_UART_ECHO
+    s_log.uart_echo = true;
+#endif
+    memcpy(s_log.elf_id, esp_app_get_description()->app_elf_sha256, sizeof(s_log.elf_id));
+
+    s_log.partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, BINLOG_PARTITION_SUBTYPE,
+                                               BINLOG_PARTITION_LABEL);
+    if (s_log.partition == NULL) {
+        ESP_LOGW(TAG, "⚠️ 未找到 %s 分区，二进制日志只输出到串口", BINLOG_PARTITION_LABEL);
+    } else {
+        esp_err_t ret = mount_partition();
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "❌ 挂载 %s 分区失败: %s", BINLOG_PARTITION_LABEL, esp_err_to_name(ret));
+            s_log.partition = NULL;
+        } else {
+            ESP_LOGI(TAG, "✅ 二进制日志: %s 分区 %lu KB, 日志 %lu 扇区, 当前序号 %lu",
+                     BINLOG_PARTITION_LABEL, (unsigned long)(s_log.partition->size / 1024),
+                     (unsigned long)s_log.used, (unsigned long)s_log.head_seq);
+        }
+    }
+
+    if (xTaskCreate(binlog_task, "binlog", 3072, NULL, CONFIG_BINLOG_TASK_PRIORITY, &s_log.task) != pdPASS) {
+        ESP_LOGE(TAG, "❌ 创建二进制日志任务失败");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+/* ==================== 查询与控制 ==================== */
+
+void binlog_set_level(esp_log_level_t level)
+{
+    binlog_level = level;
+}
+
+void binlog_set_uart_echo(bool enable)
+{
+    s_log.uart_echo = enable;
+}
+
+esp_err_t binlog_flush(void)
+{
+    if (s_log.mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(s_log.mutex, portMAX_DELAY);
+    drain_rings();
+    xSemaphoreGive(s_log.mutex);
+    return ESP_OK;
+}
+
+esp_err_t binlog_read(uint64_t cursor, uint8_t *buf, size_t buf_size,
+                      size_t *out_len, uint64_t *next_cursor)
+{
+    if (buf == NULL || out_len == NULL || next_cursor == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_log.partition == NULL || s_log.mutex == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_log.mutex, portMAX_DELAY);
+
+    esp_err_t ret = ESP_OK;
+    *out_len = 0;
+    *next_cursor = cursor;
+    if (s_log.used == 0) {
+        xSemaphoreGive(s_log.mutex);
+        return ESP_OK;
+    }
+
+    uint32_t oldest_seq = s_log.head_seq - s_log.used + 1;
+    uint64_t cursor_seq = cursor / BINLOG_SECTOR_SIZE;
+    uint32_t seq = (uint32_t)cursor_seq;
+    uint32_t off = (uint32_t)(cursor % BINLOG_SECTOR_SIZE);
+    if (cursor_seq > s_log.head_seq) {
+        // 游标超前（如日志分区被擦除后沿用旧游标），没有可读的记录
+        xSemaphoreGive(s_log.mutex);
+        return ESP_OK;
+    }
+    if (seq < oldest_seq) {
+        seq = oldest_seq;
+        off = 0;
+    }
+    if (off < BINLOG_SECTOR_HEADER_SIZE) {
+        off = BINLOG_SECTOR_HEADER_SIZE;
+    }
+
+    while (seq <= s_log.head_seq) {
+        uint32_t sector = (s_log.head + s_log.sector_count - (s_log.head_seq - seq)) % s_log.sector_count;
+        uint32_t limit = seq == s_log.head_seq ? s_log.write_off : BINLOG_SECTOR_SIZE;
+        uint32_t word0 = 0xFFFFFFFF;
+
+        if (off + sizeof(word0) <= limit) {
+            ret = esp_partition_read(s_log.partition, sector_addr(sector) + off, &word0, sizeof(word0));
+            if (ret != ESP_OK) {
+                break;
+            }
+        }
+        if (!record_header_valid(word0) || off + record_bytes(word0) > limit) {
+            // 本扇区读完
+            if (seq == s_log.head_seq) {
+                break;
+            }
+            seq++;
+            off = BINLOG_SECTOR_HEADER_SIZE;
+            continue;
+        }
+
+        uint32_t bytes = record_bytes(word0);
+        if (*out_len + bytes > buf_size) {
+            break;
+        }
+        ret = esp_partition_read(s_log.partition, sector_addr(sector) + off, buf + *out_len, bytes);
+        if (ret != ESP_OK) {
+            break;
+        }
+        *out_len += bytes;
+        off += bytes;
+    }
+    *next_cursor = (uint64_t)seq * BINLOG_SECTOR_SIZE + off;
+
+    xSemaphoreGive(s_log.mutex);
+    return ret;
+}
+
+void binlog_get_elf_id(uint8_t out[8])
+{
+    memcpy(out, esp_app_get_description()->app_elf_sha256, 8);
+}
+
+esp_err_t binlog_get_stats(binlog_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(stats, 0, sizeof(*stats));
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        stats->records_written += s_rings[core].written;
+        stats->records_dropped += s_rings[core].dropped;
+    }
+    stats->records_flushed = s_log.flushed;
+    stats->flash_bytes = s_log.partition ? s_log.partition->size : 0;
+    stats->head_seq = s_log.head_seq;
+    stats->flash_ready = s_log.partition != NULL;
+    return ESP_OK;
+}
@@ -0,0 +1,212 @@
+/**
+ * @file binlog.h
+ * @brief 二进制延迟日志（热路径日志）
+ *
+ * 调用处只记录"格式字符串地址 + 原始参数"到当前核的无锁环形缓冲区，
+ * 不做任何字符串格式化；低优先级任务定期把记录写入logs分区（data, 0x43），
+ * 并可选地格式化输出到串口。
+ *
+ * 使用限制：
+ * - 参数最多 BINLOG_MAX_ARGS 个，每个按32位记录（float/double记为float）
+ * - 不支持64位整数（%lld/%llu）
+ * - %s 只应传常量字符串（位于Flash），运行时字符串在输出时可能已失效，
+ *   只会显示为指针地址
+ *
+ * 离线解码：tools/binlog_decode.py 结合固件ELF把记录还原为文本。
+ */
+
+#ifndef BINLOG_H
+#define BINLOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_BINLOG_RING_SIZE
+#define CONFIG_BINLOG_RING_SIZE         2048
+#endif
+
+#ifndef CONFIG_BINLOG_DEFAULT_LEVEL
+#define CONFIG_BINLOG_DEFAULT_LEVEL     ESP_LOG_INFO
+#endif
+
+#ifndef CONFIG_BINLOG_FLUSH_INTERVAL_MS
+#define CONFIG_BINLOG_FLUSH_INTERVAL_MS 500
+#endif
+
+#ifndef CONFIG_BINLOG_TASK_PRIORITY
+#define CONFIG_BINLOG_TASK_PRIORITY     1
+#endif
+
+// logs分区（partitions.csv: logs, data, 0x43）
+#define BINLOG_PARTITION_LABEL          "logs"
+#define BINLOG_PARTITION_SUBTYPE        0x43
+
+#define BINLOG_MAX_ARGS                 8
+#define BINLOG_SECTOR_SIZE              4096
+#define BINLOG_SECTOR_HEADER_SIZE       32
+#define BINLOG_RECORD_MAGIC             0xB1
+
+/*
+ * 记录格式（小端，全部按32位字对齐，环形缓冲区与Flash中格式相同）：
+ *   word0: magic(8) | level(4) core(4) | nargs(8) | reserved(8)
+ *   word1: 时间戳（毫秒，开机起）
+ *   word2: 格式字符串地址
+ *   word3: TAG地址
+ *   word4..: 参数
+ *
+ * Flash扇区头（32字节）：
+ *   magic "BLOG", seq, ~seq, version(16), reserved(16), elf_sha256前8字节, 保留8字节
+ */
+#define BINLOG_RECORD_HEADER_WORDS      4
+
+/**
+ * @brief 二进制日志统计
+ */
+typedef struct {
+    uint32_t records_written;      ///< 写入环形缓冲区的记录数
+    uint32_t records_dropped;      ///< 缓冲区满丢弃的记录数
+    uint32_t records_flushed;      ///< 已写入Flash的记录数
+    uint32_t flash_bytes;          ///< logs分区大小
+    uint32_t head_seq;             ///< 当前写入扇区序号
+    bool flash_ready;              ///< logs分区是否可用
+} binlog_stats_t;
+
+/* ==================== 参数打包 ==================== */
+
+static inline uint32_t binlog_arg_u32(uint32_t v)
+{
+    return v;
+}
+
+static inline uint32_t binlog_arg_float(double v)
+{
+    float f = (float)v;
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static inline uint32_t binlog_arg_ptr(const void *p)
+{
+    return (uint32_t)(uintptr_t)p;
+}
+
+#define BINLOG_ARG(x) _Generic((x), \
+    float: binlog_arg_float, double: binlog_arg_float, \
+    char *: binlog_arg_ptr, const char *: binlog_arg_ptr, \
+    void *: binlog_arg_ptr, const void *: binlog_arg_ptr, \
+    default: binlog_arg_u32)(x)
+
+#define _BINLOG_A0()
+#define _BINLOG_A1(a) , BINLOG_ARG(a)
+#define _BINLOG_A2(a, ...) , BINLOG_ARG(a) _BINLOG_A1(__VA_ARGS__)
+#define _BINLOG_A3(a, ...) , BINLOG_ARG(a) _BINLOG_A2(__VA_ARGS__)
+#define _BINLOG_A4(a, ...) , BINLOG_ARG(a) _BINLOG_A3(__VA_ARGS__)
+#define _BINLOG_A5(a, ...) , BINLOG_ARG(a) _BINLOG_A4(__VA_ARGS__)
+#define _BINLOG_A6(a, ...) , BINLOG_ARG(a) _BINLOG_A5(__VA_ARGS__)
+#define _BINLOG_A7(a, ...) , BINLOG_ARG(a) _BINLOG_A6(__VA_ARGS__)
+#define _BINLOG_A8(a, ...) , BINLOG_ARG(a) _BINLOG_A7(__VA_ARGS__)
+#define _BINLOG_SEL(_0, _1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+#define _BINLOG_ARGS(...) _BINLOG_SEL(_0, ##__VA_ARGS__, _BINLOG_A8, _BINLOG_A7, _BINLOG_A6, \
+    _BINLOG_A5, _BINLOG_A4, _BINLOG_A3, _BINLOG_A2, _BINLOG_A1, _BINLOG_A0)(__VA_ARGS__)
+
+extern esp_log_level_t binlog_level;
+
+/**
+ * @brief 记录一条二进制日志（用法同ESP_LOGx）
+ */
+#define BINLOG(level, tag, fmt, ...) do { \
+        if ((level) <= binlog_level) { \
+            const uint32_t _binlog_args[] = { 0 _BINLOG_ARGS(__VA_ARGS__) }; \
+            binlog_write((level), (tag), (fmt), _binlog_args + 1, \
+                         sizeof(_binlog_args) / sizeof(uint32_t) - 1); \
+        } \
+    } while (0)
+
+#define BINLOG_E(tag, fmt, ...) BINLOG(ESP_LOG_ERROR, tag, fmt, ##__VA_ARGS__)
+#define BINLOG_W(tag, fmt, ...) BINLOG(ESP_LOG_WARN, tag, fmt, ##__VA_ARGS__)
+#define BINLOG_I(tag, fmt, ...) BINLOG(ESP_LOG_INFO, tag, fmt, ##__VA_ARGS__)
+#define BINLOG_D(tag, fmt, ...) BINLOG(ESP_LOG_DEBUG, tag, fmt, ##__VA_ARGS__)
+
+/**
+ * @brief 写入一条记录（一般通过BINLOG_x宏调用）
+ *
+ * 可在任务和中断中调用；只在当前核上短暂屏蔽中断，不使用锁。
+ *
+ * @param level 日志级别
+ * @param tag TAG（常量字符串）
+ * @param fmt 格式字符串（常量字符串）
+ * @param args 参数（已按32位打包）
+ * @param nargs 参数个数
+ */
+void binlog_write(esp_log_level_t level, const char *tag, const char *fmt,
+                  const uint32_t *args, size_t nargs);
+
+/**
+ * @brief 初始化二进制日志：挂载logs分区并启动写出任务
+ *
+ * 初始化前写入的记录会暂存在环形缓冲区中。logs分区不存在时只输出到串口。
+ *
+ * @return esp_err_t
+ */
+esp_err_t binlog_init(void);
+
+/**
+ * @brief 设置运行时日志级别
+ */
+void binlog_set_level(esp_log_level_t level);
+
+/**
+ * @brief 设置是否输出到串口
+ */
+void binlog_set_uart_echo(bool enable);
+
+/**
+ * @brief 立即把环形缓冲区中的记录写入Flash
+ *
+ * @return esp_err_t
+ */
+esp_err_t binlog_flush(void);
+
+/**
+ * @brief 从logs分区读取原始记录（按时间顺序）
+ *
+ * 游标由 扇区序号*4096 + 扇区内偏移 组成；传0表示从最旧记录开始。
+ * 扇区序号是32位，游标用64位，序号超过2^20后游标不会回绕。
+ * 只返回完整记录，*out_len为0表示已读完。
+ *
+ * @param cursor 起始游标
+ * @param buf 输出缓冲区
+ * @param buf_size 缓冲区大小
+ * @param out_len 实际读取字节数
+ * @param next_cursor 下一次读取的游标
+ * @return esp_err_t
+ */
+esp_err_t binlog_read(uint64_t cursor, uint8_t *buf, size_t buf_size,
+                      size_t *out_len, uint64_t *next_cursor);
+
+/**
+ * @brief 获取当前固件ELF SHA256前8字节（解码时用于匹配ELF文件）
+ *
+ * @param out 输出缓冲区（至少8字节）
+ */
+void binlog_get_elf_id(uint8_t out[8]);
+
+/**
+ * @brief 获取统计信息
+ */
+esp_err_t binlog_get_stats(binlog_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BINLOG_H
@@ -0,0 +1,202 @@
+/**
+ * @file ble_frag.c
+ * @brief BLE分片与重组（纯函数，不依赖蓝牙协议栈）
+ */
+
+#include "ble_frag.h"
+#include <string.h>
+
+#define LEN_PREFIX      BLE_FRAG_LEN_PREFIX
+#define HDR_FIRST_LEN   3       ///< 首片：头 + 总长
+#define HDR_NEXT_LEN    1       ///< 后续分片：头
+
+static inline size_t get_le16(const uint8_t *p)
+{
+    return (size_t)p[0] | ((size_t)p[1] << 8);
+}
+
+static inline void put_le16(uint8_t *p, size_t v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
+
+/* ==================== 发送 ==================== */
+
+void ble_frag_tx_init(ble_frag_tx_t *tx, uint8_t *buf, size_t size)
+{
+    memset(tx, 0, sizeof(*tx));
+    tx->buf = buf;
+    tx->size = size;
+}
+
+void ble_frag_tx_reset(ble_frag_tx_t *tx)
+{
+    tx->head = 0;
+    tx->tail = 0;
+    tx->offset = 0;
+    tx->seq = 0;
+}
+
+esp_err_t ble_frag_tx_push(ble_frag_tx_t *tx, const uint8_t *data, size_t len)
+{
+    if (!tx || !tx->buf || !data || len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t need = LEN_PREFIX + len;
+    if (len > BLE_FRAG_MAX_MSG || len > 0xFFFF || need > tx->size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (tx->tail + need > tx->size && tx->head > 0) {
+        // 已发完的消息在缓冲区前部，整体前移腾出尾部空间
+        memmove(tx->buf, tx->buf + tx->head, tx->tail - tx->head);
+        tx->tail -= tx->head;
+        tx->head = 0;
+    }
+    if (tx->tail + need > tx->size) {
+        return ESP_ERR_NO_MEM;
+    }
+    put_le16(tx->buf + tx->tail, len);
+    memcpy(tx->buf + tx->tail + LEN_PREFIX, data, len);
+    tx->tail += need;
+    return ESP_OK;
+}
+
+void ble_frag_tx_set_raw(ble_frag_tx_t *tx, bool raw)
+{
+    ble_frag_tx_reset(tx);
+    tx->raw = raw;
+}
+
+bool ble_frag_tx_pending(const ble_frag_tx_t *tx)
+{
+    return tx->head < tx->tail;
+}
+
+size_t ble_frag_tx_peek(const ble_frag_tx_t *tx, size_t frame_max, uint8_t *out)
+{
+    if (!ble_frag_tx_pending(tx) || frame_max <= (tx->raw ? 0 : HDR_FIRST_LEN)) {
+        return 0;
+    }
+    size_t msg_len = get_le16(tx->buf + tx->head);
+    const uint8_t *data = tx->buf + tx->head + LEN_PREFIX;
+    bool first = tx->offset == 0;
+    size_t hdr_len = tx->raw ? 0 : first ? HDR_FIRST_LEN : HDR_NEXT_LEN;
+    size_t remaining = msg_len - tx->offset;
+    size_t chunk = frame_max - hdr_len;
+    if (chunk > remaining) {
+        chunk = remaining;
+    }
+
+    if (tx->raw) {
+        memcpy(out, data + tx->offset, chunk);
+        return chunk;
+    }
+    out[0] = (uint8_t)((first ? BLE_FRAG_HDR_FIRST : 0) |
+                       (chunk == remaining ? BLE_FRAG_HDR_LAST : 0) |
+                       (tx->seq & BLE_FRAG_SEQ_MASK));
+    if (first) {
+        put_le16(out + 1, msg_len);
+    }
+    memcpy(out + hdr_len, data + tx->offset, chunk);
+    return hdr_len + chunk;
+}
+
+void ble_frag_tx_commit(ble_frag_tx_t *tx, size_t frame_len)
+{
+    if (!ble_frag_tx_pending(tx)) {
+        return;
+    }
+    size_t hdr_len = tx->raw ? 0 : tx->offset == 0 ? HDR_FIRST_LEN : HDR_NEXT_LEN;
+    size_t msg_len = get_le16(tx->buf + tx->head);
+    tx->offset += frame_len > hdr_len ? frame_len - hdr_len : 0;
+    tx->seq = (uint8_t)((tx->seq + 1) & BLE_FRAG_SEQ_MASK);
+
+    if (tx->offset >= msg_len) {
+        tx->head += LEN_PREFIX + msg_len;
+        tx->offset = 0;
+        tx->seq = 0;
+        if (tx->head == tx->tail) {
+            tx->head = 0;
+            tx->tail = 0;
+        }
+    }
+}
+
+/* ==================== 接收 ==================== */
+
+void ble_frag_rx_init(ble_frag_rx_t *rx, uint8_t *buf, size_t size)
+{
+    memset(rx, 0, sizeof(*rx));
+    rx->buf = buf;
+    rx->size = size;
+}
+
+void ble_frag_rx_reset(ble_frag_rx_t *rx)
+{
+    rx->active = false;
+    rx->total = 0;
+    rx->len = 0;
+    rx->seq = 0;
+}
+
+static esp_err_t rx_fail(ble_frag_rx_t *rx, esp_err_t err)
+{
+    ble_frag_rx_reset(rx);
+    return err;
+}
+
+esp_err_t ble_frag_rx_feed(ble_frag_rx_t *rx, const uint8_t *frame, size_t len,
+                           const uint8_t **msg, size_t *msg_len)
+{
+    if (!rx || !frame || len < HDR_NEXT_LEN || !msg || !msg_len) {
+        return rx ? rx_fail(rx, ESP_ERR_INVALID_ARG) : ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t hdr = frame[0];
+    const uint8_t *payload;
+    size_t n;
+
+    if (hdr & BLE_FRAG_HDR_FIRST) {
+        if (len < HDR_FIRST_LEN) {
+            return rx_fail(rx, ESP_ERR_INVALID_ARG);
+        }
+        size_t total = get_le16(frame + 1);
+        if (total == 0 || total > rx->size) {
+            return rx_fail(rx, ESP_ERR_INVALID_SIZE);
+        }
+        // 新的首片：未完成的消息直接丢弃（客户端重发）
+        ble_frag_rx_reset(rx);
+        rx->active = true;
+        rx->total = total;
+        payload = frame + HDR_FIRST_LEN;
+        n = len - HDR_FIRST_LEN;
+    } else {
+        if (!rx->active) {
+            return rx_fail(rx, ESP_ERR_INVALID_STATE);
+        }
+        payload = frame + HDR_NEXT_LEN;
+        n = len - HDR_NEXT_LEN;
+    }
+
+    if ((hdr & BLE_FRAG_SEQ_MASK) != rx->seq) {
+        return rx_fail(rx, ESP_ERR_INVALID_STATE);
+    }
+    if (rx->len + n > rx->total) {
+        return rx_fail(rx, ESP_ERR_INVALID_SIZE);
+    }
+    memcpy(rx->buf + rx->len, payload, n);
+    rx->len += n;
+    rx->seq = (uint8_t)((rx->seq + 1) & BLE_FRAG_SEQ_MASK);
+
+    if (!(hdr & BLE_FRAG_HDR_LAST)) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+    if (rx->len != rx->total) {
+        return rx_fail(rx, ESP_ERR_INVALID_SIZE);
+    }
+    rx->active = false;
+    *msg = rx->buf;
+    *msg_len = rx->total;
+    return ESP_OK;
+}
@@ -0,0 +1,211 @@
+/**
+ * @file ble_frag.h
+ * @brief BLE GATT分片传输：按MTU拆分通知、重组写入，配网和微信小程序服务共用
+ *
+ * 一次ATT写/通知最多携带 MTU-3 字节（默认MTU 23时只有20字节），
+ * 带证书的配网JSON有几KB，原来一次 esp_ble_gatts_send_indicate() 发不出去，
+ * 写入也要求整包一次到达。本组件在特征值之上加一层很薄的分片协议：
+ *
+ * 分片格式（两个方向相同）：
+ * @code
+ *   [头 1B][消息总长 2B 小端，仅首片][数据]
+ *   头: bit7 = 首片, bit6 = 末片, bit0-5 = 片序号（每条消息从0开始，模64递增）
+ * @endcode
+ * 一条不超过 MTU-6 字节的消息只有一个分片（头 0xC0）。
+ *
+ * 兼容模式：分片格式是在原有特征值上新加的，老版本的客户端不认识。每个连接默认处于兼容模式
+ * （CONFIG_BLE_FRAG_FRAMED_DEFAULT 未开启时）：每次写入（或执行的长写）就是一条完整消息，
+ * 发送时按 MTU-3 切成不带头的通知。支持分片的客户端读取版本特征值（BLE_FRAG_PROTO_VERSION），
+ * 再把版本号写回，本连接随后切换到分片格式；写0回到兼容模式。
+ *
+ * - 发送：消息先进入发送队列，按当前MTU切片，同时在途的通知不超过
+ *   CONFIG_BLE_FRAG_TX_WINDOW 个，收到 ESP_GATTS_CONF_EVT 后继续发送；
+ *   链路拥塞（ESP_GATTS_CONGEST_EVT）时暂停。发送不阻塞，可在GATT回调中调用。
+ * - 接收：普通写入和长写（Prepare Write + Execute Write）的值都作为一个分片送入重组器，
+ *   收齐后整条消息交给回调。片序号不连续、长度不符时丢弃整条消息。
+ * - MTU：注册GATT应用时设置本地MTU（CONFIG_BLE_FRAG_LOCAL_MTU），
+ *   由客户端发起交换（小程序 wx.setBLEMTU / Android requestMtu），结果在 ESP_GATTS_MTU_EVT 中生效。
+ *
+ * 分片和重组（ble_frag_tx_* / ble_frag_rx_*）是纯函数，可在主机上单独测试；
+ * GATT 部分（ble_frag_open 等）在 ble_frag_gatts.h 中，只在启用 Bluedroid 时编译。
+ */
+
+#ifndef BLE_FRAG_H
+#define BLE_FRAG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_BLE_FRAG_LOCAL_MTU
+#define CONFIG_BLE_FRAG_LOCAL_MTU       517
+#endif
+
+#ifndef CONFIG_BLE_FRAG_MAX_MSG
+#define CONFIG_BLE_FRAG_MAX_MSG         4096
+#endif
+
+#ifndef CONFIG_BLE_FRAG_TX_BUF_SIZE
+#define CONFIG_BLE_FRAG_TX_BUF_SIZE     0
+#endif
+
+#ifndef CONFIG_BLE_FRAG_TX_WINDOW
+#define CONFIG_BLE_FRAG_TX_WINDOW       4
+#endif
+
+#ifndef CONFIG_BLE_FRAG_MAX_CHANNELS
+#define CONFIG_BLE_FRAG_MAX_CHANNELS    2
+#endif
+
+#ifndef CONFIG_BLE_FRAG_FRAMED_DEFAULT
+#define CONFIG_BLE_FRAG_FRAMED_DEFAULT  0
+#endif
+
+#define BLE_FRAG_DEFAULT_MTU    23          ///< 未交换MTU时的ATT_MTU
+#define BLE_FRAG_ATTR_MAX       512         ///< 特征值（含长写）最大长度
+#define BLE_FRAG_MAX_MSG        CONFIG_BLE_FRAG_MAX_MSG
+#define BLE_FRAG_LEN_PREFIX     2           ///< 发送队列中每条消息前的长度字段
+#define BLE_FRAG_PROTO_VERSION  1           ///< 版本特征值的值（0 = 兼容模式，不分片）
+
+// 发送队列至少能放下一条最大的消息
+#if CONFIG_BLE_FRAG_TX_BUF_SIZE == 0
+#define BLE_FRAG_TX_BUF_SIZE    (BLE_FRAG_MAX_MSG + BLE_FRAG_LEN_PREFIX)
+#elif CONFIG_BLE_FRAG_TX_BUF_SIZE < CONFIG_BLE_FRAG_MAX_MSG + 2
+#error "CONFIG_BLE_FRAG_TX_BUF_SIZE must be 0 or at least CONFIG_BLE_FRAG_MAX_MSG + 2"
+#else
+#define BLE_FRAG_TX_BUF_SIZE    CONFIG_BLE_FRAG_TX_BUF_SIZE
+#endif
+
+#define BLE_FRAG_HDR_FIRST      0x80
+#define BLE_FRAG_HDR_LAST       0x40
+#define BLE_FRAG_SEQ_MASK       0x3F
+
+/**
+ * @brief 分片发送队列（消息依次存放在调用方提供的缓冲区中，每条前置2字节长度）
+ */
+typedef struct {
+    uint8_t *buf;                  ///< 队列缓冲区
+    size_t size;                   ///< 缓冲区大小
+    size_t head;                   ///< 当前消息在缓冲区中的位置
+    size_t tail;                   ///< 队尾（下一条消息写入位置）
+    size_t offset;                 ///< 当前消息已发送的字节数
+    uint8_t seq;                   ///< 下一片的序号
+    bool raw;                      ///< 兼容模式：分片不带头
+} ble_frag_tx_t;
+
+/**
+ * @brief 分片重组器
+ */
+typedef struct {
+    uint8_t *buf;                  ///< 重组缓冲区
+    size_t size;                   ///< 缓冲区大小（可接收的最大消息）
+    size_t total;                  ///< 当前消息总长
+    size_t len;                    ///< 已收到的字节数
+    uint8_t seq;                   ///< 期望的下一片序号
+    bool active;                   ///< 正在接收一条消息
+} ble_frag_rx_t;
+
+/**
+ * @brief 统计信息
+ */
+typedef struct {
+    uint32_t tx_msgs;              ///< 已入队的消息数
+    uint32_t tx_frags;             ///< 已发出的通知数
+    uint32_t tx_dropped;           ///< 队列满或未连接被拒绝的消息数
+    uint32_t tx_congested;         ///< 链路拥塞次数
+    uint32_t rx_msgs;              ///< 重组完成的消息数
+    uint32_t rx_frags;             ///< 收到的分片数（含长写）
+    uint32_t rx_errors;            ///< 序号/长度错误丢弃的消息数
+    uint16_t mtu;                  ///< 当前（最近一次连接的）MTU
+} ble_frag_stats_t;
+
+/**
+ * @brief 初始化发送队列
+ */
+void ble_frag_tx_init(ble_frag_tx_t *tx, uint8_t *buf, size_t size);
+
+/**
+ * @brief 清空发送队列
+ */
+void ble_frag_tx_reset(ble_frag_tx_t *tx);
+
+/**
+ * @brief 切换分片格式（清空发送队列）
+ *
+ * @param raw true=兼容模式，按frame_max切片、不加分片头；false=分片格式（初始化后的默认值）
+ */
+void ble_frag_tx_set_raw(ble_frag_tx_t *tx, bool raw);
+
+/**
+ * @brief 消息入队
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 参数错误或长度为0
+ *   - ESP_ERR_INVALID_SIZE: 超过BLE_FRAG_MAX_MSG或超过队列容量
+ *   - ESP_ERR_NO_MEM: 队列剩余空间不足（稍后重试）
+ */
+esp_err_t ble_frag_tx_push(ble_frag_tx_t *tx, const uint8_t *data, size_t len);
+
+/**
+ * @brief 是否还有待发送的分片
+ */
+bool ble_frag_tx_pending(const ble_frag_tx_t *tx);
+
+/**
+ * @brief 生成下一个分片（不出队，发送成功后调用 ble_frag_tx_commit()）
+ *
+ * @param tx 发送队列
+ * @param frame_max 单个分片最大长度（MTU-3，分片格式至少4）
+ * @param out 输出缓冲区（至少frame_max字节）
+ * @return 分片长度；队列为空或frame_max太小时返回0
+ */
+size_t ble_frag_tx_peek(const ble_frag_tx_t *tx, size_t frame_max, uint8_t *out);
+
+/**
+ * @brief 确认 ble_frag_tx_peek() 生成的分片已发出
+ *
+ * @param frame_len ble_frag_tx_peek() 的返回值
+ */
+void ble_frag_tx_commit(ble_frag_tx_t *tx, size_t frame_len);
+
+/**
+ * @brief 初始化重组器
+ */
+void ble_frag_rx_init(ble_frag_rx_t *rx, uint8_t *buf, size_t size);
+
+/**
+ * @brief 丢弃正在重组的消息
+ */
+void ble_frag_rx_reset(ble_frag_rx_t *rx);
+
+/**
+ * @brief 送入一个分片
+ *
+ * 收到新的首片时丢弃未完成的消息。出错后重组器复位，等待下一个首片。
+ *
+ * @param rx 重组器
+ * @param frame 分片
+ * @param len 分片长度
+ * @param msg 完成时输出消息指针（指向重组缓冲区，下次送入分片前有效）
+ * @param msg_len 完成时输出消息长度
+ * @return esp_err_t
+ *   - ESP_OK: 消息完成
+ *   - ESP_ERR_NOT_FINISHED: 等待后续分片
+ *   - ESP_ERR_INVALID_ARG: 分片过短
+ *   - ESP_ERR_INVALID_STATE: 没有首片或序号不连续
+ *   - ESP_ERR_INVALID_SIZE: 消息超过缓冲区，或数据与总长不符
+ */
+esp_err_t ble_frag_rx_feed(ble_frag_rx_t *rx, const uint8_t *frame, size_t len,
+                           const uint8_t **msg, size_t *msg_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BLE_FRAG_H
@@ -0,0 +1,467 @@
+/**
+ * @file ble_frag_gatts.c
+ * @brief BLE分片传输的Bluedroid GATT服务端部分
+ *
+ * GATT事件都在BTC任务中回调，接收（重组、长写缓冲）只在BTC任务中访问，不加锁；
+ * 发送队列可能同时被业务任务和BTC任务访问，由锁保护。
+ * 发送由 ble_frag_send() 启动，之后由通知确认（CONF_EVT）和拥塞解除（CONGEST_EVT）驱动，
+ * 不需要单独的任务，也不会在BTC任务中等待自己的事件。
+ * 分片格式按连接切换：连接时恢复默认（CONFIG_BLE_FRAG_FRAMED_DEFAULT），客户端写版本特征值后生效。
+ */
+
+#include "ble_frag_gatts.h"
+#include "esp_log.h"
+#include "esp_gatt_common_api.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "BLE_FRAG";
+
+struct ble_frag_chan {
+    bool used;
+    const char *name;
+    ble_frag_msg_cb_t on_message;
+    void *ctx;
+
+    esp_gatt_if_t gatts_if;
+    uint16_t rx_handle;
+    uint16_t tx_handle;
+    uint16_t version_handle;
+
+    bool connected;
+    bool framed;                           ///< 本连接使用分片格式（否则为兼容模式）
+    uint16_t conn_id;
+    uint16_t mtu;
+    bool congested;
+    uint8_t in_flight;                     ///< 已发出、未收到CONF_EVT的通知数
+
+    ble_frag_tx_t tx;
+    ble_frag_rx_t rx;
+    uint8_t *tx_buf;
+    uint8_t *rx_buf;
+
+    uint8_t prep[BLE_FRAG_ATTR_MAX];       ///< 长写缓冲
+    size_t prep_len;
+    bool prep_active;                      ///< 收到过Prepare Write，等待Execute Write
+    bool prep_failed;                      ///< 本次长写有分段被拒绝，执行时丢弃
+
+    uint8_t frame[BLE_FRAG_ATTR_MAX];      ///< 待发送的分片
+    ble_frag_stats_t stats;
+};
+
+static struct ble_frag_chan s_chans[CONFIG_BLE_FRAG_MAX_CHANNELS];
+static SemaphoreHandle_t s_mutex = NULL;
+
+#define LOCK()      do { if (s_mutex) xSemaphoreTake(s_mutex, portMAX_DELAY); } while (0)
+#define UNLOCK()    do { if (s_mutex) xSemaphoreGive(s_mutex); } while (0)
+
+esp_err_t ble_frag_set_local_mtu(void)
+{
+    esp_err_t ret = esp_ble_gatt_set_local_mtu(CONFIG_BLE_FRAG_LOCAL_MTU);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "❌ 设置本地MTU失败: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+/**
+ * @brief 切换本连接的分片格式（调用方已加锁）
+ */
+static void set_framed(struct ble_frag_chan *ch, bool framed)
+{
+    ch->framed = framed;
+    ble_frag_tx_set_raw(&ch->tx, !framed);
+    ble_frag_rx_reset(&ch->rx);
+}
+
+esp_err_t ble_frag_open(const ble_frag_config_t *config, ble_frag_handle_t *out)
+{
+    if (!config || !out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t max_msg = config->max_msg ? config->max_msg : CONFIG_BLE_FRAG_MAX_MSG;
+    size_t tx_size = config->tx_buf_size ? config->tx_buf_size : BLE_FRAG_TX_BUF_SIZE;
+    if (max_msg > BLE_FRAG_MAX_MSG || tx_size < max_msg + BLE_FRAG_LEN_PREFIX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    LOCK();
+    struct ble_frag_chan *ch = NULL;
+    for (int i = 0; i < CONFIG_BLE_FRAG_MAX_CHANNELS; i++) {
+        if (!s_chans[i].used) {
+            ch = &s_chans[i];
+            break;
+        }
+    }
+    if (!ch) {
+        UNLOCK();
+        return ESP_ERR_NO_MEM;
+    }
+    memset(ch, 0, sizeof(*ch));
+    ch->tx_buf = malloc(tx_size);
+    ch->rx_buf = malloc(max_msg);
+    if (!ch->tx_buf || !ch->rx_buf) {
+        free(ch->tx_buf);
+        free(ch->rx_buf);
+        ch->tx_buf = NULL;
+        ch->rx_buf = NULL;
+        UNLOCK();
+        return ESP_ERR_NO_MEM;
+    }
+    ble_frag_tx_init(&ch->tx, ch->tx_buf, tx_size);
+    ble_frag_rx_init(&ch->rx, ch->rx_buf, max_msg);
+    ch->used = true;
+    ch->name = config->name ? config->name : "ble";
+    ch->on_message = config->on_message;
+    ch->ctx = config->ctx;
+    ch->gatts_if = ESP_GATT_IF_NONE;
+    ch->mtu = BLE_FRAG_DEFAULT_MTU;
+    set_framed(ch, CONFIG_BLE_FRAG_FRAMED_DEFAULT);
+    ch->stats.mtu = ch->mtu;
+    UNLOCK();
+
+    *out = ch;
+    return ESP_OK;
+}
+
+void ble_frag_close(ble_frag_handle_t ch)
+{
+    if (!ch) {
+        return;
+    }
+    LOCK();
+    free(ch->tx_buf);
+    free(ch->rx_buf);
+    memset(ch, 0, sizeof(*ch));
+    UNLOCK();
+}
+
+void ble_frag_bind(ble_frag_handle_t ch, esp_gatt_if_t gatts_if, uint16_t rx_handle, uint16_t tx_handle)
+{
+    if (!ch) {
+        return;
+    }
+    LOCK();
+    ch->gatts_if = gatts_if;
+    ch->rx_handle = rx_handle;
+    ch->tx_handle = tx_handle;
+    UNLOCK();
+}
+
+void ble_frag_bind_version(ble_frag_handle_t ch, uint16_t version_handle)
+{
+    if (!ch) {
+        return;
+    }
+    LOCK();
+    ch->version_handle = version_handle;
+    UNLOCK();
+}
+
+/**
+ * @brief 清空连接相关状态（调用方已加锁）
+ */
+static void reset_link(struct ble_frag_chan *ch)
+{
+    ch->congested = false;
+    ch->in_flight = 0;
+    ch->mtu = BLE_FRAG_DEFAULT_MTU;
+    set_framed(ch, CONFIG_BLE_FRAG_FRAMED_DEFAULT);
+    ch->prep_len = 0;
+    ch->prep_active = false;
+    ch->prep_failed = false;
+}
+
+/**
+ * @brief 在窗口允许的范围内发送分片（调用方已加锁）
+ */
+static void pump(struct ble_frag_chan *ch)
+{
+    size_t frame_max = (size_t)ch->mtu - 3;
+    if (frame_max > sizeof(ch->frame)) {
+        frame_max = sizeof(ch->frame);
+    }
+
+    while (ch->connected && !ch->congested && ch->in_flight < CONFIG_BLE_FRAG_TX_WINDOW) {
+        size_t n = ble_frag_tx_peek(&ch->tx, frame_max, ch->frame);
+        if (n == 0) {
+            break;
+        }
+        esp_err_t ret = esp_ble_gatts_send_indicate(ch->gatts_if, ch->conn_id, ch->tx_handle,
+                                                    (uint16_t)n, ch->frame, false);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "⚠️ [%s] 发送通知失败: %s", ch->name, esp_err_to_name(ret));
+            if (ch->in_flight == 0) {
+                // 没有在途通知，不会再有CONF_EVT驱动重试，丢弃队列
+                ble_frag_tx_reset(&ch->tx);
+                ch->stats.tx_dropped++;
+            }
+            break;
+        }
+        ble_frag_tx_commit(&ch->tx, n);
+        ch->in_flight++;
+        ch->stats.tx_frags++;
+    }
+}
+
+esp_err_t ble_frag_send(ble_frag_handle_t ch, const uint8_t *data, size_t len)
+{
+    if (!ch || !data || len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    LOCK();
+    if (!ch->connected || ch->tx_handle == 0) {
+        ch->stats.tx_dropped++;
+        UNLOCK();
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = ble_frag_tx_push(&ch->tx, data, len);
+    if (ret != ESP_OK) {
+        ch->stats.tx_dropped++;
+        UNLOCK();
+        ESP_LOGW(TAG, "⚠️ [%s] 消息入队失败(%u字节): %s", ch->name, (unsigned)len, esp_err_to_name(ret));
+        return ret;
+    }
+    ch->stats.tx_msgs++;
+    pump(ch);
+    UNLOCK();
+    return ESP_OK;
+}
+
+/**
+ * @brief 送入一个分片，消息完成时回调
+ */
+static void deliver(struct ble_frag_chan *ch, const uint8_t *frame, size_t len)
+{
+    const uint8_t *msg = NULL;
+    size_t msg_len = 0;
+
+    ch->stats.rx_frags++;
+    if (!ch->framed) {
+        // 兼容模式：一次写入就是一条完整消息
+        ch->stats.rx_msgs++;
+        if (ch->on_message) {
+            ch->on_message(frame, len, ch->ctx);
+        }
+        return;
+    }
+    esp_err_t ret = ble_frag_rx_feed(&ch->rx, frame, len, &msg, &msg_len);
+    if (ret == ESP_ERR_NOT_FINISHED) {
+        return;
+    }
+    if (ret != ESP_OK) {
+        ch->stats.rx_errors++;
+        ESP_LOGW(TAG, "⚠️ [%s] 分片错误，丢弃消息: %s", ch->name, esp_err_to_name(ret));
+        return;
+    }
+    ch->stats.rx_msgs++;
+    ESP_LOGD(TAG, "[%s] 收到消息 %u 字节", ch->name, (unsigned)msg_len);
+    if (ch->on_message) {
+        ch->on_message(msg, msg_len, ch->ctx);
+    }
+}
+
+/**
+ * @brief Prepare Write：按偏移顺序写入长写缓冲并原样回显
+ */
+static void handle_prepare_write(struct ble_frag_chan *ch, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param)
+{
+    esp_gatt_status_t status = ESP_GATT_OK;
+    if (param->write.offset != ch->prep_len) {
+        status = ESP_GATT_INVALID_OFFSET;
+    } else if ((size_t)param->write.offset + param->write.len > sizeof(ch->prep)) {
+        status = ESP_GATT_INVALID_ATTR_LEN;
+    }
+
+    ch->prep_active = true;
+    if (status == ESP_GATT_OK) {
+        memcpy(ch->prep + ch->prep_len, param->write.value, param->write.len);
+        ch->prep_len += param->write.len;
+    } else {
+        ch->prep_failed = true;
+    }
+
+    if (!param->write.need_rsp) {
+        return;
+    }
+    esp_gatt_rsp_t *rsp = calloc(1, sizeof(esp_gatt_rsp_t));
+    if (!rsp) {
+        esp_ble_gatts_send_response(gatts_if, param->write.conn_id, param->write.trans_id, ESP_GATT_NO_RESOURCES, NULL);
+        return;
+    }
+    rsp->attr_value.handle = param->write.handle;
+    rsp->attr_value.offset = param->write.offset;
+    rsp->attr_value.len = param->write.len;
+    rsp->attr_value.auth_req = ESP_GATT_AUTH_REQ_NONE;
+    memcpy(rsp->attr_value.value, param->write.value, param->write.len);
+    esp_ble_gatts_send_response(gatts_if, param->write.conn_id, param->write.trans_id, status, rsp);
+    free(rsp);
+}
+
+/**
+ * @brief 版本特征值：读返回协议版本，写入切换分片格式
+ */
+static void handle_version(struct ble_frag_chan *ch, esp_gatts_cb_event_t event,
+                           esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param)
+{
+    if (event == ESP_GATTS_READ_EVT) {
+        esp_gatt_rsp_t rsp;
+        memset(&rsp, 0, sizeof(rsp));
+        rsp.attr_value.handle = param->read.handle;
+        rsp.attr_value.len = 1;
+        rsp.attr_value.value[0] = BLE_FRAG_PROTO_VERSION;
+        esp_ble_gatts_send_response(gatts_if, param->read.conn_id, param->read.trans_id, ESP_GATT_OK, &rsp);
+        return;
+    }
+
+    esp_gatt_status_t status = ESP_GATT_OK;
+    if (param->write.is_prep || param->write.len != 1) {
+        status = ESP_GATT_INVALID_ATTR_LEN;
+    } else if (param->write.value[0] > BLE_FRAG_PROTO_VERSION) {
+        status = ESP_GATT_REQ_NOT_SUPPORTED;
+    } else {
+        LOCK();
+        set_framed(ch, param->write.value[0] != 0);
+        UNLOCK();
+        ESP_LOGI(TAG, "🔀 [%s] %s", ch->name, ch->framed ? "客户端开启分片格式" : "客户端切换到兼容模式");
+    }
+    if (param->write.need_rsp) {
+        esp_ble_gatts_send_response(gatts_if, param->write.conn_id, param->write.trans_id, status, NULL);
+    }
+}
+
+bool ble_frag_gatts_event(ble_frag_handle_t ch, esp_gatts_cb_event_t event,
+                          esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param)
+{
+    if (!ch || !ch->used || gatts_if != ch->gatts_if) {
+        return false;
+    }
+
+    switch (event) {
+        case ESP_GATTS_CONNECT_EVT:
+            LOCK();
+            reset_link(ch);
+            ch->connected = true;
+            ch->conn_id = param->connect.conn_id;
+            ch->stats.mtu = ch->mtu;
+            UNLOCK();
+            return false;
+
+        case ESP_GATTS_DISCONNECT_EVT:
+            LOCK();
+            if (ch->connected && param->disconnect.conn_id == ch->conn_id) {
+                ch->connected = false;
+                reset_link(ch);
+            }
+            UNLOCK();
+            return false;
+
+        case ESP_GATTS_MTU_EVT:
+            LOCK();
+            if (param->mtu.conn_id == ch->conn_id) {
+                ch->mtu = param->mtu.mtu;
+                ch->stats.mtu = ch->mtu;
+                pump(ch);
+            }
+            UNLOCK();
+            ESP_LOGI(TAG, "📏 [%s] MTU %u，每个通知最多 %u 字节", ch->name,
+                     (unsigned)param->mtu.mtu, (unsigned)(param->mtu.mtu - 3));
+            return false;
+
+        case ESP_GATTS_CONF_EVT:
+            if (param->conf.handle != ch->tx_handle) {
+                return false;
+            }
+            LOCK();
+            if (ch->in_flight > 0) {
+                ch->in_flight--;
+            }
+            if (param->conf.status != ESP_GATT_OK) {
+                ESP_LOGW(TAG, "⚠️ [%s] 通知发送状态 %d", ch->name, param->conf.status);
+            }
+            pump(ch);
+            UNLOCK();
+            return true;
+
+        case ESP_GATTS_CONGEST_EVT:
+            LOCK();
+            ch->congested = param->congest.congested;
+            if (ch->congested) {
+                ch->stats.tx_congested++;
+            } else {
+                pump(ch);
+            }
+            UNLOCK();
+            return true;
+
+        case ESP_GATTS_READ_EVT:
+            if (ch->version_handle == 0 || param->read.handle != ch->version_handle) {
+                return false;
+            }
+            handle_version(ch, event, gatts_if, param);
+            return true;
+
+        case ESP_GATTS_WRITE_EVT:
+            if (ch->version_handle != 0 && param->write.handle == ch->version_handle) {
+                handle_version(ch, event, gatts_if, param);
+                return true;
+            }
+            if (param->write.handle != ch->rx_handle) {
+                return false;
+            }
+            if (param->write.is_prep) {
+                handle_prepare_write(ch, gatts_if, param);
+                return true;
+            }
+            if (param->write.need_rsp) {
+                esp_ble_gatts_send_response(gatts_if, param->write.conn_id, param->write.trans_id, ESP_GATT_OK, NULL);
+            }
+            deliver(ch, param->write.value, param->write.len);
+            return true;
+
+        case ESP_GATTS_EXEC_WRITE_EVT:
+            if (!ch->prep_active) {
+                return false;
+            }
+            esp_ble_gatts_send_response(gatts_if, param->exec_write.conn_id, param->exec_write.trans_id, ESP_GATT_OK, NULL);
+            if (param->exec_write.exec_write_flag == ESP_GATT_PREP_WRITE_EXEC && !ch->prep_failed && ch->prep_len > 0) {
+                deliver(ch, ch->prep, ch->prep_len);
+            }
+            ch->prep_len = 0;
+            ch->prep_active = false;
+            ch->prep_failed = false;
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+bool ble_frag_is_framed(ble_frag_handle_t ch)
+{
+    return ch ? ch->framed : false;
+}
+
+uint16_t ble_frag_get_mtu(ble_frag_handle_t ch)
+{
+    return ch ? ch->mtu : BLE_FRAG_DEFAULT_MTU;
+}
+
+void ble_frag_get_stats(ble_frag_handle_t ch, ble_frag_stats_t *stats)
+{
+    if (!ch || !stats) {
+        return;
+    }
+    LOCK();
+    *stats = ch->stats;
+    UNLOCK();
+}
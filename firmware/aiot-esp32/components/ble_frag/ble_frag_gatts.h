@@ -0,0 +1,125 @@
+/**
+ * @file ble_frag_gatts.h
+ * @brief BLE分片传输的GATT服务端接口（Bluedroid）
+ *
+ * 每个GATT服务打开一个通道，在服务的GATT回调开头调用 ble_frag_gatts_event()，
+ * 属性表创建后用 ble_frag_bind() 绑定写入和通知的特征值。
+ * 写入的特征值需设为 ESP_GATT_RSP_BY_APP，由本模块应答普通写入和长写。
+ * 每个服务另加一个版本特征值（读/写，ESP_GATT_RSP_BY_APP），用 ble_frag_bind_version() 绑定，
+ * 客户端通过它发现并开启分片格式（见 ble_frag.h 的兼容模式说明）。
+ */
+
+#ifndef BLE_FRAG_GATTS_H
+#define BLE_FRAG_GATTS_H
+
+#include "ble_frag.h"
+#include "esp_gatts_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 收到完整消息的回调（在BTC任务中调用，可直接调用 ble_frag_send()）
+ */
+typedef void (*ble_frag_msg_cb_t)(const uint8_t *msg, size_t len, void *ctx);
+
+/**
+ * @brief 通道句柄（一个GATT服务一个）
+ */
+typedef struct ble_frag_chan *ble_frag_handle_t;
+
+/**
+ * @brief 通道配置
+ */
+typedef struct {
+    const char *name;              ///< 日志名
+    ble_frag_msg_cb_t on_message;  ///< 消息回调
+    void *ctx;                     ///< 回调参数
+    size_t max_msg;                ///< 最大接收消息（0使用CONFIG_BLE_FRAG_MAX_MSG）
+    size_t tx_buf_size;            ///< 发送队列大小（0使用BLE_FRAG_TX_BUF_SIZE，至少max_msg+2）
+} ble_frag_config_t;
+
+#define BLE_FRAG_DEFAULT_CONFIG() {                 \
+    .name = "ble",                                  \
+    .on_message = NULL,                             \
+    .ctx = NULL,                                    \
+    .max_msg = CONFIG_BLE_FRAG_MAX_MSG,             \
+    .tx_buf_size = BLE_FRAG_TX_BUF_SIZE,            \
+}
+
+/**
+ * @brief 设置本地MTU（在 ESP_GATTS_REG_EVT 中调用）
+ */
+esp_err_t ble_frag_set_local_mtu(void);
+
+/**
+ * @brief 创建通道（缓冲区从堆分配）
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 参数错误（max_msg超过BLE_FRAG_MAX_MSG，或发送队列放不下一条max_msg的消息）
+ *   - ESP_ERR_NO_MEM: 通道已满或内存不足
+ */
+esp_err_t ble_frag_open(const ble_frag_config_t *config, ble_frag_handle_t *out);
+
+/**
+ * @brief 关闭通道并释放缓冲区
+ */
+void ble_frag_close(ble_frag_handle_t handle);
+
+/**
+ * @brief 绑定特征值（创建属性表后调用）
+ *
+ * @param rx_handle 客户端写入的特征值句柄
+ * @param tx_handle 发送通知的特征值句柄（可与rx_handle相同）
+ */
+void ble_frag_bind(ble_frag_handle_t handle, esp_gatt_if_t gatts_if, uint16_t rx_handle, uint16_t tx_handle);
+
+/**
+ * @brief 绑定版本特征值（创建属性表后调用）
+ *
+ * 读取返回 BLE_FRAG_PROTO_VERSION；写入非0开启本连接的分片格式，写入0回到兼容模式。
+ */
+void ble_frag_bind_version(ble_frag_handle_t handle, uint16_t version_handle);
+
+/**
+ * @brief 处理GATT事件（在服务的GATT回调开头调用）
+ *
+ * 跟踪连接、MTU、通知确认和拥塞；rx_handle上的写入和Execute Write、版本特征值的读写由本函数应答。
+ *
+ * @return true 事件已处理（调用方不要再应答）；false 调用方照常处理
+ */
+bool ble_frag_gatts_event(ble_frag_handle_t handle, esp_gatts_cb_event_t event,
+                          esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param);
+
+/**
+ * @brief 发送一条消息（入队后立即开始发送，不等待完成）
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 已入队
+ *   - ESP_ERR_INVALID_STATE: 未连接或未绑定
+ *   - ESP_ERR_INVALID_SIZE / ESP_ERR_NO_MEM: 见 ble_frag_tx_push()
+ */
+esp_err_t ble_frag_send(ble_frag_handle_t handle, const uint8_t *data, size_t len);
+
+/**
+ * @brief 当前连接是否使用分片格式（false为兼容模式）
+ */
+bool ble_frag_is_framed(ble_frag_handle_t handle);
+
+/**
+ * @brief 当前连接的MTU
+ */
+uint16_t ble_frag_get_mtu(ble_frag_handle_t handle);
+
+/**
+ * @brief 获取统计信息
+ */
+void ble_frag_get_stats(ble_frag_handle_t handle, ble_frag_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BLE_FRAG_GATTS_H
@@ -0,0 +1,196 @@
+/**
+ * @file button_input.c
+ * @brief 按键状态机和启动窗口判定（只依赖时间戳，不依赖GPIO/FreeRTOS）
+ *
+ * 时间用毫秒计数的 uint32_t，比较一律用差值的符号判断，计数回绕（约49天）不影响判定。
+ */
+
+#include "button_input.h"
+#include <string.h>
+
+/** now 是否已到达 t */
+static inline bool reached(uint32_t now, uint32_t t)
+{
+    return (int32_t)(now - t) >= 0;
+}
+
+/** a 是否早于 b */
+static inline bool before(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
+
+static inline void emit(button_input_event_t event, button_input_event_t *events, size_t max, size_t *n)
+{
+    if (*n < max) {
+        events[(*n)++] = event;
+    }
+}
+
+/**
+ * @brief 处理到 until 为止到期的长按、连发和双击间隔（按键状态不变）
+ */
+static void run_timers(button_input_fsm_t *fsm, const button_input_timing_t *timing, uint32_t until,
+                       button_input_event_t *events, size_t max, size_t *n)
+{
+    if (fsm->pressed) {
+        if (!fsm->long_fired && reached(until, fsm->down_ms + timing->long_press_ms)) {
+            // 上一次单击还在等双击时又按住不放：先确认那一次单击
+            if (fsm->clicks > 0) {
+                emit(BUTTON_INPUT_CLICK, events, max, n);
+                fsm->clicks = 0;
+            }
+            emit(BUTTON_INPUT_LONG_PRESS, events, max, n);
+            fsm->long_fired = true;
+            fsm->repeating = timing->repeat_ms > 0;
+            fsm->next_repeat_ms = fsm->down_ms + timing->long_press_ms + timing->repeat_ms;
+        }
+        // 事件数组满了就停在这里，截止时间仍已到期，下一次更新继续补发
+        while (fsm->repeating && *n < max && reached(until, fsm->next_repeat_ms)) {
+            emit(BUTTON_INPUT_HOLD_REPEAT, events, max, n);
+            fsm->next_repeat_ms += timing->repeat_ms;
+        }
+    } else if (fsm->clicks > 0 && reached(until, fsm->up_ms + timing->double_click_ms)) {
+        emit(BUTTON_INPUT_CLICK, events, max, n);
+        fsm->clicks = 0;
+    }
+}
+
+void button_input_fsm_init(button_input_fsm_t *fsm, bool double_click, bool pressed, uint32_t now_ms)
+{
+    memset(fsm, 0, sizeof(*fsm));
+    fsm->double_click = double_click;
+    fsm->raw = pressed;
+    fsm->pressed = pressed;
+    fsm->long_fired = pressed;
+    fsm->edge_ms = now_ms;
+    fsm->down_ms = now_ms;
+    fsm->up_ms = now_ms;
+}
+
+size_t button_input_fsm_update(button_input_fsm_t *fsm, const button_input_timing_t *timing,
+                               uint32_t now_ms, button_input_event_t *events, size_t max)
+{
+    size_t n = 0;
+
+    if (fsm->raw != fsm->pressed) {
+        if (!reached(now_ms, fsm->edge_ms + timing->debounce_ms)) {
+            // 电平还没稳定：计时只处理到边沿为止，边沿之后的状态还不确定
+            run_timers(fsm, timing, fsm->edge_ms, events, max, &n);
+            return n;
+        }
+
+        // 电平已稳定：状态切换发生在边沿时刻，先处理边沿之前到期的计时
+        run_timers(fsm, timing, fsm->edge_ms, events, max, &n);
+        fsm->pressed = fsm->raw;
+        fsm->repeating = false;
+        if (fsm->pressed) {
+            fsm->down_ms = fsm->edge_ms;
+            fsm->long_fired = false;
+        } else {
+            fsm->up_ms = fsm->edge_ms;
+            if (!fsm->long_fired) {
+                if (!fsm->double_click) {
+                    emit(BUTTON_INPUT_CLICK, events, max, &n);
+                } else if (++fsm->clicks >= 2) {
+                    emit(BUTTON_INPUT_DOUBLE_CLICK, events, max, &n);
+                    fsm->clicks = 0;
+                }
+            }
+        }
+    }
+
+    run_timers(fsm, timing, now_ms, events, max, &n);
+    return n;
+}
+
+size_t button_input_fsm_edge(button_input_fsm_t *fsm, const button_input_timing_t *timing,
+                             bool pressed, uint32_t t_ms,
+                             button_input_event_t *events, size_t max)
+{
+    size_t n = button_input_fsm_update(fsm, timing, t_ms, events, max);
+    if (pressed != fsm->raw) {
+        fsm->raw = pressed;
+        fsm->edge_ms = t_ms;
+    }
+    return n;
+}
+
+uint32_t button_input_fsm_deadline(const button_input_fsm_t *fsm, const button_input_timing_t *timing)
+{
+    if (fsm->raw != fsm->pressed) {
+        return fsm->edge_ms + timing->debounce_ms;
+    }
+    if (fsm->pressed) {
+        if (!fsm->long_fired) {
+            return fsm->down_ms + timing->long_press_ms;
+        }
+        if (fsm->repeating) {
+            return fsm->next_repeat_ms;
+        }
+    } else if (fsm->clicks > 0) {
+        return fsm->up_ms + timing->double_click_ms;
+    }
+    return BUTTON_INPUT_NO_DEADLINE;
+}
+
+void button_input_fsm_consume(button_input_fsm_t *fsm)
+{
+    fsm->long_fired = true;
+    fsm->repeating = false;
+    fsm->clicks = 0;
+}
+
+void button_input_boot_init(button_input_boot_t *boot, uint32_t now_ms, uint32_t window_ms, uint32_t hold_ms)
+{
+    boot->window_end_ms = now_ms + window_ms;
+    boot->hold_ms = hold_ms;
+    boot->state = BUTTON_INPUT_BOOT_PENDING;
+}
+
+button_input_boot_state_t button_input_boot_update(button_input_boot_t *boot, const button_input_fsm_t *fsm,
+                                                   uint32_t now_ms)
+{
+    if (boot->state != BUTTON_INPUT_BOOT_PENDING) {
+        return boot->state;
+    }
+
+    if (fsm->pressed && before(fsm->down_ms, boot->window_end_ms)) {
+        // 窗口内开始的按下：按够时长即判定，窗口结束后也继续等这一次按下的结果
+        if (reached(now_ms, fsm->down_ms + boot->hold_ms)) {
+            boot->state = BUTTON_INPUT_BOOT_HELD;
+        }
+        return boot->state;
+    }
+    if (fsm->raw && !fsm->pressed && before(fsm->edge_ms, boot->window_end_ms)) {
+        // 窗口内的按下还在消抖
+        return boot->state;
+    }
+    if (reached(now_ms, boot->window_end_ms)) {
+        boot->state = BUTTON_INPUT_BOOT_RELEASED;
+    }
+    return boot->state;
+}
+
+uint32_t button_input_boot_deadline(const button_input_boot_t *boot, const button_input_fsm_t *fsm)
+{
+    if (boot->state != BUTTON_INPUT_BOOT_PENDING) {
+        return BUTTON_INPUT_NO_DEADLINE;
+    }
+    if (fsm->pressed && before(fsm->down_ms, boot->window_end_ms)) {
+        return fsm->down_ms + boot->hold_ms;
+    }
+    // 消抖中的按下由按键状态机的截止时间唤醒
+    return boot->window_end_ms;
+}
+
+const char *button_input_event_name(button_input_event_t event)
+{
+    switch (event) {
+        case BUTTON_INPUT_CLICK:        return "click";
+        case BUTTON_INPUT_DOUBLE_CLICK: return "double_click";
+        case BUTTON_INPUT_LONG_PRESS:   return "long_press";
+        case BUTTON_INPUT_HOLD_REPEAT:  return "hold_repeat";
+        default:                        return "unknown";
+    }
+}
@@ -0,0 +1,276 @@
+/**
+ * @file button_input.h
+ * @brief 中断驱动的多按键输入：边沿时间戳队列 + 按键状态机（单击/双击/长按/按住连发）
+ *
+ * 原来的Boot按键有两套检测：app_main() 启动时每100ms轮询一次、阻塞3秒；
+ * button_handler.c 用 ISR -> 任务通知 -> 软件定时器 只处理一个按键。
+ * 本组件统一处理板子上的N个按键：
+ *
+ * - ISR 只记录 {按键序号, 电平, 时间戳} 放入队列，不做任何判断；
+ * - 输入任务按时间戳把边沿送入每个按键的状态机，没有边沿时按状态机给出的
+ *   下一个截止时间醒来（长按、连发、双击间隔），不需要软件定时器；
+ * - 启动窗口：初始化后一段时间内按住Boot键超过设定时长即判定"启动时按住"，
+ *   button_input_boot_held() 随时非阻塞查询，启动窗口与其余初始化并行进行。
+ *
+ * 状态机（button_input_fsm_* / button_input_boot_*）只依赖传入的毫秒时间戳，
+ * 可在主机上用合成的边沿时间线测试；GPIO/队列/任务部分在 button_input_gpio.c 中。
+ */
+
+#ifndef BUTTON_INPUT_H
+#define BUTTON_INPUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_BUTTON_INPUT_DEBOUNCE_MS
+#define CONFIG_BUTTON_INPUT_DEBOUNCE_MS         50
+#endif
+
+#ifndef CONFIG_BUTTON_INPUT_DOUBLE_CLICK_MS
+#define CONFIG_BUTTON_INPUT_DOUBLE_CLICK_MS     300
+#endif
+
+#ifndef CONFIG_BUTTON_INPUT_LONG_PRESS_MS
+#define CONFIG_BUTTON_INPUT_LONG_PRESS_MS       3000
+#endif
+
+#ifndef CONFIG_BUTTON_INPUT_REPEAT_MS
+#define CONFIG_BUTTON_INPUT_REPEAT_MS           500
+#endif
+
+#ifndef CONFIG_BUTTON_INPUT_BOOT_WINDOW_MS
+#define CONFIG_BUTTON_INPUT_BOOT_WINDOW_MS      3000
+#endif
+
+#ifndef CONFIG_BUTTON_INPUT_BOOT_HOLD_MS
+#define CONFIG_BUTTON_INPUT_BOOT_HOLD_MS        300
+#endif
+
+#ifndef CONFIG_BUTTON_INPUT_QUEUE_LEN
+#define CONFIG_BUTTON_INPUT_QUEUE_LEN           16
+#endif
+
+#ifndef CONFIG_BUTTON_INPUT_TASK_STACK
+#define CONFIG_BUTTON_INPUT_TASK_STACK          3072
+#endif
+
+#define BUTTON_INPUT_MAX_BUTTONS    4
+#define BUTTON_INPUT_MAX_EVENTS     4       ///< 一次状态机更新最多产生的事件数
+#define BUTTON_INPUT_NO_DEADLINE    UINT32_MAX
+
+/**
+ * @brief 按键事件
+ */
+typedef enum {
+    BUTTON_INPUT_CLICK = 0,         ///< 单击（开启双击时在双击间隔结束后才确认）
+    BUTTON_INPUT_DOUBLE_CLICK,      ///< 双击
+    BUTTON_INPUT_LONG_PRESS,        ///< 长按（按住达到长按时间，只触发一次）
+    BUTTON_INPUT_HOLD_REPEAT,       ///< 长按后继续按住，每个连发间隔触发一次
+} button_input_event_t;
+
+/**
+ * @brief 时间参数（毫秒）
+ */
+typedef struct {
+    uint16_t debounce_ms;           ///< 电平稳定多久才算有效
+    uint16_t double_click_ms;       ///< 松开后多久内再次按下算双击
+    uint16_t long_press_ms;         ///< 长按时间
+    uint16_t repeat_ms;             ///< 连发间隔（0不连发）
+} button_input_timing_t;
+
+#define BUTTON_INPUT_DEFAULT_TIMING() {                         \
+    .debounce_ms = CONFIG_BUTTON_INPUT_DEBOUNCE_MS,             \
+    .double_click_ms = CONFIG_BUTTON_INPUT_DOUBLE_CLICK_MS,     \
+    .long_press_ms = CONFIG_BUTTON_INPUT_LONG_PRESS_MS,         \
+    .repeat_ms = CONFIG_BUTTON_INPUT_REPEAT_MS,                 \
+}
+
+/**
+ * @brief 单个按键的状态机
+ */
+typedef struct {
+    bool raw;                       ///< 最近一次边沿后的电平（true=按下）
+    bool pressed;                   ///< 消抖后的状态
+    bool double_click;              ///< 是否识别双击（关闭时松开立即报单击）
+    bool long_fired;                ///< 本次按下已报长按（或被启动窗口占用），松开不再报单击
+    bool repeating;                 ///< 长按后正在连发
+    uint8_t clicks;                 ///< 等待双击确认的单击数
+    uint32_t edge_ms;               ///< 最近一次原始边沿的时间
+    uint32_t down_ms;               ///< 本次按下的时间
+    uint32_t up_ms;                 ///< 上次松开的时间
+    uint32_t next_repeat_ms;        ///< 下一次连发的时间
+} button_input_fsm_t;
+
+/**
+ * @brief 启动窗口判定
+ */
+typedef enum {
+    BUTTON_INPUT_BOOT_PENDING = 0,  ///< 窗口未结束（或窗口内开始的按下还没到时长）
+    BUTTON_INPUT_BOOT_HELD,         ///< 启动时按住
+    BUTTON_INPUT_BOOT_RELEASED,     ///< 窗口结束，未按住
+} button_input_boot_state_t;
+
+typedef struct {
+    uint32_t window_end_ms;         ///< 窗口结束时间（在此之前开始的按下才算）
+    uint32_t hold_ms;               ///< 需要按住的时长
+    button_input_boot_state_t state;
+} button_input_boot_t;
+
+/**
+ * @brief 初始化状态机
+ *
+ * @param pressed 初始化时的按键状态；上电时已按下的这一次按下只用于启动窗口，不报单击/长按
+ * @param now_ms 当前时间
+ */
+void button_input_fsm_init(button_input_fsm_t *fsm, bool double_click, bool pressed, uint32_t now_ms);
+
+/**
+ * @brief 送入一个原始边沿（按时间顺序）
+ *
+ * 先处理该时间点之前到期的消抖/长按/连发/双击，再记录边沿。
+ *
+ * @return 产生的事件数（写入events，最多max个）
+ */
+size_t button_input_fsm_edge(button_input_fsm_t *fsm, const button_input_timing_t *timing,
+                             bool pressed, uint32_t t_ms,
+                             button_input_event_t *events, size_t max);
+
+/**
+ * @brief 处理到 now_ms 为止到期的消抖和计时
+ *
+ * @return 产生的事件数
+ */
+size_t button_input_fsm_update(button_input_fsm_t *fsm, const button_input_timing_t *timing,
+                               uint32_t now_ms, button_input_event_t *events, size_t max);
+
+/**
+ * @brief 下一个需要调用 button_input_fsm_update() 的时间
+ *
+ * @return 绝对时间（毫秒）；没有待定的计时返回 BUTTON_INPUT_NO_DEADLINE
+ */
+uint32_t button_input_fsm_deadline(const button_input_fsm_t *fsm, const button_input_timing_t *timing);
+
+/**
+ * @brief 本次按下不再产生单击/长按（启动窗口已判定按住时调用）
+ */
+void button_input_fsm_consume(button_input_fsm_t *fsm);
+
+/**
+ * @brief 开始启动窗口
+ */
+void button_input_boot_init(button_input_boot_t *boot, uint32_t now_ms, uint32_t window_ms, uint32_t hold_ms);
+
+/**
+ * @brief 根据按键状态更新启动窗口判定（每次状态机更新后调用）
+ *
+ * @return 当前判定
+ */
+button_input_boot_state_t button_input_boot_update(button_input_boot_t *boot, const button_input_fsm_t *fsm,
+                                                   uint32_t now_ms);
+
+/**
+ * @brief 启动窗口的下一个判定时间（已判定时返回 BUTTON_INPUT_NO_DEADLINE）
+ */
+uint32_t button_input_boot_deadline(const button_input_boot_t *boot, const button_input_fsm_t *fsm);
+
+/**
+ * @brief 事件名称（日志用）
+ */
+const char *button_input_event_name(button_input_event_t event);
+
+/* ==================== GPIO输入任务 ==================== */
+
+/**
+ * @brief 按键配置（来自板子的 board_config.h）
+ */
+typedef struct {
+    int gpio;
+    bool active_low;                ///< 低电平为按下（内部上拉）
+    bool double_click;              ///< 识别双击（会让单击延后 double_click_ms 确认）
+    const char *name;
+} button_input_button_t;
+
+/**
+ * @brief 事件回调（在输入任务中调用）
+ *
+ * @param button 按键序号（button_input_init 中的下标）
+ */
+typedef void (*button_input_cb_t)(uint8_t button, button_input_event_t event, void *ctx);
+
+/**
+ * @brief 初始化按键输入并开始启动窗口（第0个按键为Boot键）
+ *
+ * @param buttons 按键表（内部复制）
+ * @param count 按键数（不超过 BUTTON_INPUT_MAX_BUTTONS）
+ * @param cb 事件回调（可为NULL，之后用 button_input_set_callback 设置）
+ * @param ctx 回调参数
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 参数错误
+ *   - ESP_ERR_INVALID_STATE: 已初始化
+ *   - ESP_ERR_NO_MEM: 创建队列/任务失败
+ */
+esp_err_t button_input_init(const button_input_button_t *buttons, size_t count,
+                            button_input_cb_t cb, void *ctx);
+
+/**
+ * @brief 更换事件回调
+ */
+void button_input_set_callback(button_input_cb_t cb, void *ctx);
+
+/**
+ * @brief 是否已初始化
+ */
+bool button_input_is_running(void);
+
+/**
+ * @brief 重新配置GPIO并注册中断（WiFi初始化后GPIO中断可能失效）
+ */
+esp_err_t button_input_rearm(void);
+
+/**
+ * @brief 停止按键输入（移除中断、删除任务和队列）
+ */
+esp_err_t button_input_deinit(void);
+
+/**
+ * @brief 查询启动窗口结果（不阻塞）
+ *
+ * @param held 输出：启动时是否按住Boot键
+ * @return esp_err_t
+ *   - ESP_OK: 已判定
+ *   - ESP_ERR_NOT_FINISHED: 窗口还未结束
+ *   - ESP_ERR_INVALID_STATE: 未初始化
+ */
+esp_err_t button_input_boot_held(bool *held);
+
+/**
+ * @brief 等待启动窗口结果（最多 timeout_ms）
+ *
+ * @return 同 button_input_boot_held()，超时返回 ESP_ERR_NOT_FINISHED
+ */
+esp_err_t button_input_wait_boot(bool *held, uint32_t timeout_ms);
+
+/**
+ * @brief 启动窗口距离判定还剩多少毫秒（用于倒计时提示；已判定或未初始化返回0）
+ *
+ * 窗口内按下后返回到按住时长满足为止的时间。
+ */
+uint32_t button_input_boot_remaining_ms(void);
+
+/**
+ * @brief 按键当前是否按下（消抖后）
+ */
+bool button_input_is_pressed(uint8_t button);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BUTTON_INPUT_H
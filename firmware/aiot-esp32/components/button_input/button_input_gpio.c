@@ -0,0 +1,378 @@
+/**
+ * @file button_input_gpio.c
+ * @brief 按键GPIO中断、边沿队列和输入任务
+ *
+ * ISR 只读电平、取时间戳、入队；输入任务按时间戳驱动状态机，
+ * 空闲时按最近的截止时间（消抖/长按/连发/双击/启动窗口）阻塞在队列上。
+ */
+
+#include "button_input.h"
+#include <string.h>
+#include "driver/gpio.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+
+static const char *TAG = "button_input";
+
+#define BUTTON_INPUT_TASK_PRIORITY  5
+#define BOOT_DONE_BIT               BIT0
+
+#define LOCK()      xSemaphoreTake(s_mutex, portMAX_DELAY)
+#define UNLOCK()    xSemaphoreGive(s_mutex)
+
+/** ISR放入队列的边沿 */
+typedef struct {
+    uint8_t button;
+    uint8_t pressed;
+    uint32_t t_ms;
+} button_edge_t;
+
+static button_input_button_t s_buttons[BUTTON_INPUT_MAX_BUTTONS];
+static button_input_fsm_t s_fsm[BUTTON_INPUT_MAX_BUTTONS];
+static size_t s_count = 0;
+static const button_input_timing_t s_timing = BUTTON_INPUT_DEFAULT_TIMING();
+static button_input_boot_t s_boot;
+static bool s_boot_held = false;
+
+static button_input_cb_t s_cb = NULL;
+static void *s_cb_ctx = NULL;
+
+static QueueHandle_t s_queue = NULL;
+static TaskHandle_t s_task = NULL;
+static SemaphoreHandle_t s_mutex = NULL;
+static EventGroupHandle_t s_boot_events = NULL;
+static volatile bool s_resync = false;     ///< 队列满丢了边沿，任务按实际电平重新同步
+
+static inline uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static inline bool read_pressed(const button_input_button_t *btn)
+{
+    int level = gpio_get_level(btn->gpio);
+    return btn->active_low ? (level == 0) : (level != 0);
+}
+
+static void IRAM_ATTR button_isr_handler(void *arg)
+{
+    uint8_t index = (uint8_t)(uintptr_t)arg;
+    button_edge_t edge = {
+        .button = index,
+        .pressed = read_pressed(&s_buttons[index]),
+        .t_ms = (uint32_t)(esp_timer_get_time() / 1000),
+    };
+    BaseType_t woken = pdFALSE;
+    if (xQueueSendFromISR(s_queue, &edge, &woken) != pdTRUE) {
+        s_resync = true;
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief 分发事件并更新启动窗口（持锁调用，回调在锁外执行）
+ */
+static void dispatch(uint8_t index, const button_input_event_t *events, size_t n, uint32_t now)
+{
+    if (index == 0 && s_boot.state == BUTTON_INPUT_BOOT_PENDING) {
+        button_input_boot_state_t state = button_input_boot_update(&s_boot, &s_fsm[0], now);
+        if (state == BUTTON_INPUT_BOOT_HELD) {
+            // 这一次按下已用于启动判定，不再报长按，避免再触发一次运行中配网
+            button_input_fsm_consume(&s_fsm[0]);
+            s_boot_held = true;
+            ESP_LOGW(TAG, "🔘 启动时按住%s", s_buttons[0].name);
+        }
+        if (state != BUTTON_INPUT_BOOT_PENDING) {
+            xEventGroupSetBits(s_boot_events, BOOT_DONE_BIT);
+        }
+    }
+
+    button_input_cb_t cb = s_cb;
+    void *ctx = s_cb_ctx;
+    UNLOCK();
+    for (size_t i = 0; i < n; i++) {
+        ESP_LOGI(TAG, "🔘 %s: %s", s_buttons[index].name, button_input_event_name(events[i]));
+        if (cb) {
+            cb(index, events[i], ctx);
+        }
+    }
+    LOCK();
+}
+
+static void feed_edge(uint8_t index, bool pressed, uint32_t t)
+{
+    button_input_event_t events[BUTTON_INPUT_MAX_EVENTS];
+    size_t n = button_input_fsm_edge(&s_fsm[index], &s_timing, pressed, t, events, BUTTON_INPUT_MAX_EVENTS);
+    dispatch(index, events, n, t);
+}
+
+static void update_all(uint32_t now)
+{
+    button_input_event_t events[BUTTON_INPUT_MAX_EVENTS];
+    for (size_t i = 0; i < s_count; i++) {
+        size_t n = button_input_fsm_update(&s_fsm[i], &s_timing, now, events, BUTTON_INPUT_MAX_EVENTS);
+        dispatch(i, events, n, now);
+    }
+}
+
+/**
+ * @brief 距最近截止时间的tick数（没有截止时间时永久等待）
+ */
+static TickType_t next_wait(uint32_t now)
+{
+    int32_t wait_ms = INT32_MAX;
+    for (size_t i = 0; i <= s_count; i++) {
+        uint32_t deadline = (i < s_count) ? button_input_fsm_deadline(&s_fsm[i], &s_timing)
+                                          : button_input_boot_deadline(&s_boot, &s_fsm[0]);
+        if (deadline == BUTTON_INPUT_NO_DEADLINE) {
+            continue;
+        }
+        int32_t d = (int32_t)(deadline - now);
+        if (d < wait_ms) {
+            wait_ms = d;
+        }
+    }
+    if (wait_ms == INT32_MAX) {
+        return portMAX_DELAY;
+    }
+    // 向上取整一个tick，醒来时截止时间一定已到
+    return wait_ms <= 0 ? 0 : pdMS_TO_TICKS(wait_ms) + 1;
+}
+
+static void button_input_task(void *arg)
+{
+    ESP_LOGI(TAG, "按键输入任务启动 (%u个按键)", (unsigned)s_count);
+
+    for (;;) {
+        LOCK();
+        TickType_t wait = next_wait(now_ms());
+        UNLOCK();
+
+        button_edge_t edge;
+        bool got = xQueueReceive(s_queue, &edge, wait) == pdTRUE;
+
+        LOCK();
+        if (got && edge.button < s_count) {
+            feed_edge(edge.button, edge.pressed, edge.t_ms);
+        }
+        if (s_resync) {
+            s_resync = false;
+            ESP_LOGW(TAG, "⚠️ 边沿队列已满，按当前电平重新同步");
+            uint32_t t = now_ms();
+            for (size_t i = 0; i < s_count; i++) {
+                feed_edge(i, read_pressed(&s_buttons[i]), t);
+            }
+        }
+        update_all(now_ms());
+        UNLOCK();
+    }
+}
+
+static esp_err_t arm_button(uint8_t index)
+{
+    const button_input_button_t *btn = &s_buttons[index];
+    gpio_isr_handler_remove(btn->gpio);
+
+    gpio_config_t io_conf = {
+        .intr_type = GPIO_INTR_ANYEDGE,
+        .mode = GPIO_MODE_INPUT,
+        .pin_bit_mask = (1ULL << btn->gpio),
+        .pull_down_en = btn->active_low ? GPIO_PULLDOWN_DISABLE : GPIO_PULLDOWN_ENABLE,
+        .pull_up_en = btn->active_low ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE,
+    };
+    esp_err_t ret = gpio_config(&io_conf);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "配置%s GPIO%d失败: %s", btn->name, btn->gpio, esp_err_to_name(ret));
+        return ret;
+    }
+
+    ret = gpio_isr_handler_add(btn->gpio, button_isr_handler, (void *)(uintptr_t)index);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "注册%s中断失败: %s", btn->name, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+static esp_err_t arm_all(void)
+{
+    esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "安装GPIO中断服务失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    for (size_t i = 0; i < s_count; i++) {
+        ret = arm_button(i);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+static void release_resources(void)
+{
+    for (size_t i = 0; i < s_count; i++) {
+        gpio_isr_handler_remove(s_buttons[i].gpio);
+    }
+    if (s_task) {
+        vTaskDelete(s_task);
+        s_task = NULL;
+    }
+    if (s_queue) {
+        vQueueDelete(s_queue);
+        s_queue = NULL;
+    }
+    if (s_boot_events) {
+        vEventGroupDelete(s_boot_events);
+        s_boot_events = NULL;
+    }
+    if (s_mutex) {
+        vSemaphoreDelete(s_mutex);
+        s_mutex = NULL;
+    }
+    s_count = 0;
+}
+
+esp_err_t button_input_init(const button_input_button_t *buttons, size_t count,
+                            button_input_cb_t cb, void *ctx)
+{
+    if (!buttons || count == 0 || count > BUTTON_INPUT_MAX_BUTTONS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_mutex = xSemaphoreCreateMutex();
+    s_queue = xQueueCreate(CONFIG_BUTTON_INPUT_QUEUE_LEN, sizeof(button_edge_t));
+    s_boot_events = xEventGroupCreate();
+    if (!s_mutex || !s_queue || !s_boot_events) {
+        release_resources();
+        return ESP_ERR_NO_MEM;
+    }
+
+    memcpy(s_buttons, buttons, count * sizeof(*buttons));
+    s_count = count;
+    s_cb = cb;
+    s_cb_ctx = ctx;
+    s_boot_held = false;
+    s_resync = false;
+
+    esp_err_t ret = arm_all();
+    if (ret != ESP_OK) {
+        release_resources();
+        return ret;
+    }
+
+    // 中断已注册后再读初始电平：之后的变化都会进队列，状态机按时间顺序处理
+    uint32_t now = now_ms();
+    for (size_t i = 0; i < count; i++) {
+        button_input_fsm_init(&s_fsm[i], s_buttons[i].double_click, read_pressed(&s_buttons[i]), now);
+    }
+    button_input_boot_init(&s_boot, now, CONFIG_BUTTON_INPUT_BOOT_WINDOW_MS, CONFIG_BUTTON_INPUT_BOOT_HOLD_MS);
+
+    if (xTaskCreate(button_input_task, "button_input", CONFIG_BUTTON_INPUT_TASK_STACK, NULL,
+                    BUTTON_INPUT_TASK_PRIORITY, &s_task) != pdPASS) {
+        release_resources();
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        ESP_LOGI(TAG, "   %s: GPIO%d %s%s", s_buttons[i].name, s_buttons[i].gpio,
+                 s_fsm[i].pressed ? "按下" : "释放", s_buttons[i].double_click ? " (双击)" : "");
+    }
+    ESP_LOGI(TAG, "✅ 按键输入初始化完成，启动窗口 %d ms（按住 %d ms）",
+             CONFIG_BUTTON_INPUT_BOOT_WINDOW_MS, CONFIG_BUTTON_INPUT_BOOT_HOLD_MS);
+    return ESP_OK;
+}
+
+void button_input_set_callback(button_input_cb_t cb, void *ctx)
+{
+    if (!s_mutex) {
+        return;
+    }
+    LOCK();
+    s_cb = cb;
+    s_cb_ctx = ctx;
+    UNLOCK();
+}
+
+bool button_input_is_running(void)
+{
+    return s_task != NULL;
+}
+
+esp_err_t button_input_rearm(void)
+{
+    if (!s_task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = arm_all();
+    // 重新注册期间的边沿可能丢失，按当前电平补一次
+    s_resync = true;
+    button_edge_t wake = { .button = UINT8_MAX };
+    xQueueSend(s_queue, &wake, 0);
+    return ret;
+}
+
+esp_err_t button_input_deinit(void)
+{
+    if (!s_task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // 持锁删除任务，保证任务不在更新状态机的中途被删
+    LOCK();
+    vTaskDelete(s_task);
+    s_task = NULL;
+    UNLOCK();
+    release_resources();
+    return ESP_OK;
+}
+
+esp_err_t button_input_boot_held(bool *held)
+{
+    return button_input_wait_boot(held, 0);
+}
+
+esp_err_t button_input_wait_boot(bool *held, uint32_t timeout_ms)
+{
+    if (!held) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_boot_events) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    EventBits_t bits = xEventGroupWaitBits(s_boot_events, BOOT_DONE_BIT, pdFALSE, pdTRUE,
+                                           pdMS_TO_TICKS(timeout_ms));
+    if (!(bits & BOOT_DONE_BIT)) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+    *held = s_boot_held;
+    return ESP_OK;
+}
+
+uint32_t button_input_boot_remaining_ms(void)
+{
+    if (!s_mutex) {
+        return 0;
+    }
+    LOCK();
+    uint32_t deadline = button_input_boot_deadline(&s_boot, &s_fsm[0]);
+    UNLOCK();
+    if (deadline == BUTTON_INPUT_NO_DEADLINE) {
+        return 0;
+    }
+    int32_t left = (int32_t)(deadline - now_ms());
+    return left > 0 ? (uint32_t)left : 0;
+}
+
+bool button_input_is_pressed(uint8_t button)
+{
+    return button < s_count && s_fsm[button].pressed;
+}
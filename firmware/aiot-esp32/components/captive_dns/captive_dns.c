@@ -0,0 +1,410 @@
+/**
+ * @file captive_dns.c
+ * @brief 强制门户DNS服务器实现
+ *
+ * 一个任务、一个UDP socket：select()等待查询（超时只用于检查停止标志），
+ * 收到后限速、生成应答、立即发送。日志只在启动/停止时输出，单个查询用DEBUG级别。
+ * socket由任务在退出时关闭；任务确认退出之前不会再次启动。
+ */
+
+#include "captive_dns.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lwip/sockets.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "CAPTIVE_DNS";
+
+#define DNS_HEADER_LEN      12
+#define DNS_FLAG_QR         0x8000
+#define DNS_FLAG_OPCODE     0x7800
+#define DNS_FLAG_AA         0x0400
+#define DNS_FLAG_TC         0x0200
+#define DNS_FLAG_RD         0x0100
+#define DNS_FLAG_RA         0x0080
+#define DNS_TYPE_A          1
+#define DNS_TYPE_ANY        255
+#define DNS_CLASS_IN        1
+#define DNS_CLASS_ANY       255
+#define DNS_ANSWER_LEN      (2 + sizeof(((captive_dns_template_t *)0)->rr))
+
+static int s_socket = -1;
+static volatile bool s_running = false;
+static uint16_t s_port = 0;
+static captive_dns_template_t s_template;
+static captive_dns_limiter_t s_limiter;
+static captive_dns_stats_t s_stats;
+static SemaphoreHandle_t s_mutex = NULL;
+static SemaphoreHandle_t s_exit_sem = NULL;
+static volatile bool s_task_alive = false;     ///< 任务已创建且尚未退出
+
+#define LOCK()      do { if (s_mutex) xSemaphoreTake(s_mutex, portMAX_DELAY); } while (0)
+#define UNLOCK()    do { if (s_mutex) xSemaphoreGive(s_mutex); } while (0)
+
+static uint16_t rd16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static void wr16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+void captive_dns_template_init(captive_dns_template_t *tmpl, uint32_t answer_ip, uint32_t ttl_s)
+{
+    uint8_t *p = tmpl->rr;
+    wr16(p, DNS_TYPE_A);
+    wr16(p + 2, DNS_CLASS_IN);
+    wr16(p + 4, (uint16_t)(ttl_s >> 16));
+    wr16(p + 6, (uint16_t)ttl_s);
+    wr16(p + 8, 4);
+    p[10] = (uint8_t)(answer_ip >> 24);
+    p[11] = (uint8_t)(answer_ip >> 16);
+    p[12] = (uint8_t)(answer_ip >> 8);
+    p[13] = (uint8_t)answer_ip;
+}
+
+/**
+ * @brief 跳过问题区中的一个域名（查询中不允许压缩指针）
+ *
+ * @return 域名之后的偏移；0表示格式错误
+ */
+static size_t skip_name(const uint8_t *msg, size_t len, size_t pos)
+{
+    size_t name_len = 0;
+    while (pos < len) {
+        uint8_t label = msg[pos++];
+        if (label == 0) {
+            return pos;
+        }
+        if (label > 63) {
+            return 0;
+        }
+        name_len += label + 1;
+        if (name_len > 255 || pos + label > len) {
+            return 0;
+        }
+        pos += label;
+    }
+    return 0;
+}
+
+size_t captive_dns_answer(const captive_dns_template_t *tmpl, const uint8_t *query, size_t len,
+                          uint8_t *out, size_t out_size)
+{
+    if (len < DNS_HEADER_LEN || len > CAPTIVE_DNS_MAX_PACKET) {
+        return 0;
+    }
+    uint16_t flags = rd16(query + 2);
+    uint16_t qdcount = rd16(query + 4);
+    // 只应答标准查询（QR=0、OPCODE=0、未截断）
+    if ((flags & (DNS_FLAG_QR | DNS_FLAG_OPCODE | DNS_FLAG_TC)) != 0 ||
+        qdcount == 0 || qdcount > CAPTIVE_DNS_MAX_QUESTIONS) {
+        return 0;
+    }
+
+    // 先校验全部问题，记下每个问题名的偏移和是否需要A记录
+    uint16_t name_offset[CAPTIVE_DNS_MAX_QUESTIONS];
+    bool want_a[CAPTIVE_DNS_MAX_QUESTIONS];
+    size_t pos = DNS_HEADER_LEN;
+    uint16_t answers = 0;
+    for (uint16_t i = 0; i < qdcount; i++) {
+        name_offset[i] = (uint16_t)pos;
+        pos = skip_name(query, len, pos);
+        if (pos == 0 || pos + 4 > len) {
+            return 0;
+        }
+        uint16_t qtype = rd16(query + pos);
+        uint16_t qclass = rd16(query + pos + 2);
+        pos += 4;
+        want_a[i] = (qtype == DNS_TYPE_A || qtype == DNS_TYPE_ANY) &&
+                    (qclass == DNS_CLASS_IN || qclass == DNS_CLASS_ANY);
+        answers += want_a[i];
+    }
+
+    // 问题区之后的附加记录（如EDNS OPT）不回传
+    size_t question_end = pos;
+    size_t total = question_end + answers * DNS_ANSWER_LEN;
+    if (total > out_size) {
+        return 0;
+    }
+
+    memcpy(out, query, question_end);
+    wr16(out + 2, DNS_FLAG_QR | DNS_FLAG_AA | DNS_FLAG_RA | (flags & DNS_FLAG_RD));
+    wr16(out + 6, answers);
+    wr16(out + 8, 0);
+    wr16(out + 10, 0);
+
+    uint8_t *p = out + question_end;
+    for (uint16_t i = 0; i < qdcount; i++) {
+        if (!want_a[i]) {
+            continue;
+        }
+        wr16(p, (uint16_t)(0xC000 | name_offset[i]));
+        memcpy(p + 2, tmpl->rr, sizeof(tmpl->rr));
+        p += DNS_ANSWER_LEN;
+    }
+    return total;
+}
+
+void captive_dns_limiter_init(captive_dns_limiter_t *lim, uint16_t rate_per_s, uint16_t burst)
+{
+    memset(lim, 0, sizeof(*lim));
+    lim->rate_per_s = rate_per_s;
+    lim->burst = burst ? burst : 1;
+}
+
+bool captive_dns_limiter_allow(captive_dns_limiter_t *lim, uint32_t addr, int64_t now_us)
+{
+    if (lim->rate_per_s == 0) {
+        return true;
+    }
+
+    captive_dns_bucket_t *bucket = NULL;
+    captive_dns_bucket_t *oldest = &lim->clients[0];
+    for (size_t i = 0; i < CAPTIVE_DNS_MAX_CLIENTS; i++) {
+        captive_dns_bucket_t *b = &lim->clients[i];
+        if (b->addr == addr && addr != 0) {
+            bucket = b;
+            break;
+        }
+        if (b->addr == 0 || (oldest->addr != 0 && b->last_us < oldest->last_us)) {
+            oldest = b;
+        }
+    }
+
+    int32_t capacity = (int32_t)lim->burst * 1000;
+    if (!bucket) {
+        // 新客户端（或替换最久未出现的客户端）从满桶开始
+        bucket = oldest;
+        bucket->addr = addr;
+        bucket->tokens_milli = capacity;
+    } else {
+        int64_t elapsed = now_us - bucket->last_us;
+        if (elapsed > 0) {
+            int64_t refill = elapsed * lim->rate_per_s / 1000;
+            int64_t tokens = bucket->tokens_milli + refill;
+            bucket->tokens_milli = tokens > capacity ? capacity : (int32_t)tokens;
+        }
+    }
+    bucket->last_us = now_us;
+
+    if (bucket->tokens_milli < 1000) {
+        return false;
+    }
+    bucket->tokens_milli -= 1000;
+    return true;
+}
+
+/**
+ * @brief 向本机DNS端口发一个空报文，让任务的select()立即返回（失败时等轮询超时）
+ */
+static void wake_task(void)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        return;
+    }
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(s_port),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    sendto(sock, "", 0, 0, (struct sockaddr *)&addr, sizeof(addr));
+    close(sock);
+}
+
+static void dns_task(void *arg)
+{
+    (void)arg;
+    uint8_t rx[CAPTIVE_DNS_MAX_PACKET];
+    uint8_t tx[CAPTIVE_DNS_MAX_PACKET];
+
+    while (s_running) {
+        fd_set readfds;
+        FD_ZERO(&readfds);
+        FD_SET(s_socket, &readfds);
+        struct timeval tv = {
+            .tv_sec = CONFIG_CAPTIVE_DNS_POLL_MS / 1000,
+            .tv_usec = (CONFIG_CAPTIVE_DNS_POLL_MS % 1000) * 1000,
+        };
+        int ready = select(s_socket + 1, &readfds, NULL, NULL, &tv);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ESP_LOGE(TAG, "❌ select失败: errno %d", errno);
+            break;
+        }
+        if (ready == 0 || !s_running) {
+            continue;
+        }
+
+        struct sockaddr_in client;
+        socklen_t client_len = sizeof(client);
+        int len = recvfrom(s_socket, rx, sizeof(rx), 0, (struct sockaddr *)&client, &client_len);
+        if (len <= 0) {
+            continue;
+        }
+        int64_t start = esp_timer_get_time();
+
+        LOCK();
+        s_stats.queries++;
+        bool allowed = captive_dns_limiter_allow(&s_limiter, ntohl(client.sin_addr.s_addr), start);
+        if (!allowed) {
+            s_stats.rate_limited++;
+        }
+        UNLOCK();
+        if (!allowed) {
+            continue;
+        }
+
+        size_t out_len = captive_dns_answer(&s_template, rx, (size_t)len, tx, sizeof(tx));
+        if (out_len == 0) {
+            LOCK();
+            s_stats.malformed++;
+            UNLOCK();
+            continue;
+        }
+
+        int sent = sendto(s_socket, tx, out_len, 0, (struct sockaddr *)&client, client_len);
+        uint32_t latency = (uint32_t)(esp_timer_get_time() - start);
+        ESP_LOGD(TAG, "查询%d字节 -> 应答%d字节（%lu us）", len, sent, (unsigned long)latency);
+
+        LOCK();
+        if (sent < 0) {
+            s_stats.send_errors++;
+        } else {
+            s_stats.answered++;
+            s_stats.latency_total_us += latency;
+            if (latency > s_stats.latency_max_us) {
+                s_stats.latency_max_us = latency;
+            }
+        }
+        UNLOCK();
+    }
+
+    close(s_socket);
+    s_socket = -1;
+    s_task_alive = false;
+    xSemaphoreGive(s_exit_sem);
+    vTaskDelete(NULL);
+}
+
+esp_err_t captive_dns_start(const captive_dns_config_t *config)
+{
+    if (s_running) {
+        return ESP_OK;
+    }
+    if (s_task_alive) {
+        // 上次停止超时，旧任务还在使用socket和限速表
+        ESP_LOGW(TAG, "⚠️ 上一个DNS任务尚未退出");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    captive_dns_config_t cfg = CAPTIVE_DNS_DEFAULT_CONFIG();
+    if (config) {
+        cfg = *config;
+    }
+
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        s_exit_sem = xSemaphoreCreateBinary();
+        if (!s_mutex || !s_exit_sem) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    s_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s_socket < 0) {
+        ESP_LOGE(TAG, "❌ 创建socket失败: errno %d", errno);
+        return ESP_FAIL;
+    }
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(cfg.port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    socklen_t addr_len = sizeof(addr);
+    if (bind(s_socket, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        getsockname(s_socket, (struct sockaddr *)&addr, &addr_len) < 0) {
+        ESP_LOGE(TAG, "❌ 绑定端口%u失败: errno %d", cfg.port, errno);
+        close(s_socket);
+        s_socket = -1;
+        return ESP_FAIL;
+    }
+    s_port = ntohs(addr.sin_port);
+
+    captive_dns_template_init(&s_template, cfg.answer_ip, cfg.ttl_s);
+    xSemaphoreTake(s_exit_sem, 0);     // 上次停止超时后任务才退出时留下的信号
+    LOCK();
+    captive_dns_limiter_init(&s_limiter, cfg.rate_per_s, cfg.burst);
+    memset(&s_stats, 0, sizeof(s_stats));
+    UNLOCK();
+
+    s_running = true;
+    s_task_alive = true;
+    if (xTaskCreate(dns_task, "captive_dns", 4096, NULL, 5, NULL) != pdPASS) {
+        s_running = false;
+        s_task_alive = false;
+        close(s_socket);
+        s_socket = -1;
+        ESP_LOGE(TAG, "❌ 创建DNS任务失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "✅ DNS服务器启动，端口%u -> %lu.%lu.%lu.%lu（限速%u次/秒，突发%u）", s_port,
+             (unsigned long)(cfg.answer_ip >> 24), (unsigned long)((cfg.answer_ip >> 16) & 0xFF),
+             (unsigned long)((cfg.answer_ip >> 8) & 0xFF), (unsigned long)(cfg.answer_ip & 0xFF),
+             cfg.rate_per_s, cfg.burst);
+    return ESP_OK;
+}
+
+esp_err_t captive_dns_stop(void)
+{
+    if (!s_running && !s_task_alive) {
+        return ESP_OK;
+    }
+    s_running = false;
+    wake_task();
+    // 任务退出时自己关闭socket，这里只等它确认；超时则保持现状，稍后可再次调用
+    if (xSemaphoreTake(s_exit_sem, pdMS_TO_TICKS(CONFIG_CAPTIVE_DNS_POLL_MS * 2 + 100)) != pdTRUE) {
+        ESP_LOGW(TAG, "⚠️ DNS任务未按时退出");
+        return ESP_ERR_TIMEOUT;
+    }
+
+    captive_dns_stats_t stats;
+    captive_dns_get_stats(&stats);
+    ESP_LOGI(TAG, "🛑 DNS服务器已停止: 查询%lu，应答%lu，限速丢弃%lu，格式错误%lu，平均%lu us，最大%lu us",
+             (unsigned long)stats.queries, (unsigned long)stats.answered,
+             (unsigned long)stats.rate_limited, (unsigned long)stats.malformed,
+             (unsigned long)(stats.answered ? stats.latency_total_us / stats.answered : 0),
+             (unsigned long)stats.latency_max_us);
+    return ESP_OK;
+}
+
+bool captive_dns_is_running(void)
+{
+    return s_running;
+}
+
+uint16_t captive_dns_get_port(void)
+{
+    return s_port;
+}
+
+void captive_dns_get_stats(captive_dns_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    LOCK();
+    *stats = s_stats;
+    UNLOCK();
+}
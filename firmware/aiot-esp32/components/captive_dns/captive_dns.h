@@ -0,0 +1,190 @@
+/**
+ * @file captive_dns.h
+ * @brief 强制门户DNS服务器：所有A查询都解析到配网AP地址
+ *
+ * 任务阻塞在select()上，有查询时才唤醒（不轮询），超时只用于检查停止标志。
+ * 应答的资源记录（类型、TTL、地址）在启动时预先生成，处理查询只需校验问题区、
+ * 复制问题并为每个A问题追加一条指向问题名的记录：
+ * - 支持一个报文中的多个问题（最多CAPTIVE_DNS_MAX_QUESTIONS个）
+ * - A/ANY查询返回AP地址；AAAA及其他类型返回无记录（NOERROR），客户端立即回落到IPv4
+ * - 按客户端地址令牌桶限速，超出的查询直接丢弃
+ *
+ * 报文处理和限速是纯函数（captive_dns_answer / captive_dns_limiter_allow），
+ * 可在主机上单独测试。
+ */
+
+#ifndef CAPTIVE_DNS_H
+#define CAPTIVE_DNS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_CAPTIVE_DNS_TTL_SEC
+#define CONFIG_CAPTIVE_DNS_TTL_SEC          60
+#endif
+
+#ifndef CONFIG_CAPTIVE_DNS_RATE_PER_SEC
+#define CONFIG_CAPTIVE_DNS_RATE_PER_SEC     20
+#endif
+
+#ifndef CONFIG_CAPTIVE_DNS_RATE_BURST
+#define CONFIG_CAPTIVE_DNS_RATE_BURST       40
+#endif
+
+#ifndef CONFIG_CAPTIVE_DNS_MAX_CLIENTS
+#define CONFIG_CAPTIVE_DNS_MAX_CLIENTS      8
+#endif
+
+#ifndef CONFIG_CAPTIVE_DNS_POLL_MS
+#define CONFIG_CAPTIVE_DNS_POLL_MS          500
+#endif
+
+#define CAPTIVE_DNS_PORT            53
+#define CAPTIVE_DNS_MAX_PACKET      512     ///< 经典UDP DNS报文上限
+#define CAPTIVE_DNS_MAX_QUESTIONS   4
+#define CAPTIVE_DNS_MAX_CLIENTS     CONFIG_CAPTIVE_DNS_MAX_CLIENTS
+
+/**
+ * @brief 预先生成的应答记录（名称指针之后的部分：类型、类、TTL、长度、地址）
+ */
+typedef struct {
+    uint8_t rr[14];
+} captive_dns_template_t;
+
+/**
+ * @brief 单个客户端的令牌桶
+ */
+typedef struct {
+    uint32_t addr;                 ///< 客户端IPv4地址（0为空位）
+    int32_t tokens_milli;          ///< 剩余令牌（千分之一）
+    int64_t last_us;               ///< 上次查询时间
+} captive_dns_bucket_t;
+
+/**
+ * @brief 按客户端限速
+ */
+typedef struct {
+    uint16_t rate_per_s;           ///< 每秒补充令牌数，0为不限速
+    uint16_t burst;                ///< 桶容量
+    captive_dns_bucket_t clients[CAPTIVE_DNS_MAX_CLIENTS];
+} captive_dns_limiter_t;
+
+/**
+ * @brief 服务器配置
+ */
+typedef struct {
+    uint32_t answer_ip;            ///< 应答地址（主机字节序，如0xC0A80401为192.168.4.1）
+    uint16_t port;                 ///< 监听端口（0由系统分配，用于主机测试）
+    uint32_t ttl_s;                ///< 应答TTL
+    uint16_t rate_per_s;           ///< 每客户端限速，0为不限速
+    uint16_t burst;                ///< 每客户端突发查询数
+} captive_dns_config_t;
+
+#define CAPTIVE_DNS_DEFAULT_CONFIG() {                  \
+    .answer_ip = 0xC0A80401,                            \
+    .port = CAPTIVE_DNS_PORT,                           \
+    .ttl_s = CONFIG_CAPTIVE_DNS_TTL_SEC,                \
+    .rate_per_s = CONFIG_CAPTIVE_DNS_RATE_PER_SEC,      \
+    .burst = CONFIG_CAPTIVE_DNS_RATE_BURST,             \
+}
+
+/**
+ * @brief 统计信息
+ */
+typedef struct {
+    uint32_t queries;              ///< 收到的报文数
+    uint32_t answered;             ///< 已应答
+    uint32_t rate_limited;         ///< 因限速丢弃
+    uint32_t malformed;            ///< 格式错误或非标准查询，丢弃
+    uint32_t send_errors;          ///< 发送失败
+    uint32_t latency_max_us;       ///< 收到查询到发出应答的最大耗时
+    uint64_t latency_total_us;     ///< 累计耗时（除以answered得平均值）
+} captive_dns_stats_t;
+
+/**
+ * @brief 生成应答记录模板
+ *
+ * @param tmpl 输出模板
+ * @param answer_ip 应答地址（主机字节序）
+ * @param ttl_s TTL
+ */
+void captive_dns_template_init(captive_dns_template_t *tmpl, uint32_t answer_ip, uint32_t ttl_s);
+
+/**
+ * @brief 为一个查询报文生成应答
+ *
+ * @param tmpl 应答记录模板
+ * @param query 查询报文
+ * @param len 查询长度
+ * @param out 应答缓冲区
+ * @param out_size 应答缓冲区大小
+ * @return 应答长度；0表示不应答（不是标准查询、格式错误、问题数为0或超过上限、缓冲区不足）
+ */
+size_t captive_dns_answer(const captive_dns_template_t *tmpl, const uint8_t *query, size_t len,
+                          uint8_t *out, size_t out_size);
+
+/**
+ * @brief 初始化限速器
+ */
+void captive_dns_limiter_init(captive_dns_limiter_t *lim, uint16_t rate_per_s, uint16_t burst);
+
+/**
+ * @brief 客户端的一次查询是否放行（消耗一个令牌）
+ *
+ * @param lim 限速器
+ * @param addr 客户端地址
+ * @param now_us 当前时间（微秒）
+ * @return true 放行；false 超过限速
+ */
+bool captive_dns_limiter_allow(captive_dns_limiter_t *lim, uint32_t addr, int64_t now_us);
+
+/**
+ * @brief 启动DNS服务器（已在运行时直接返回ESP_OK）
+ *
+ * @param config 配置（NULL使用CAPTIVE_DNS_DEFAULT_CONFIG）
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_FAIL: 创建或绑定socket失败
+ *   - ESP_ERR_NO_MEM: 创建任务失败
+ *   - ESP_ERR_INVALID_STATE: 上次停止超时，旧任务还未退出
+ */
+esp_err_t captive_dns_start(const captive_dns_config_t *config);
+
+/**
+ * @brief 停止DNS服务器并等待任务确认退出
+ *
+ * 向本机DNS端口发空报文唤醒任务，通常立即退出；唤醒失败时等轮询超时，
+ * 最长约2*CONFIG_CAPTIVE_DNS_POLL_MS。socket由任务退出时关闭。
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 已停止（或本来就没有运行）
+ *   - ESP_ERR_TIMEOUT: 任务未按时退出，稍后可再次调用
+ */
+esp_err_t captive_dns_stop(void);
+
+/**
+ * @brief 是否在运行
+ */
+bool captive_dns_is_running(void);
+
+/**
+ * @brief 实际监听的端口（port为0时由系统分配）
+ */
+uint16_t captive_dns_get_port(void);
+
+/**
+ * @brief 获取统计信息（停止后保留到下次启动）
+ */
+void captive_dns_get_stats(captive_dns_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CAPTIVE_DNS_H
@@ -10,6 +10,8 @@
 
 #include "lvgl_display.h"
 #include "esp_log.h"
+#include "binlog.h"
+#include "metrics.h"
 #include "esp_heap_caps.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -25,6 +27,9 @@ static TaskHandle_t lvgl_timer_task_handle = NULL;
 static bool lvgl_timer_running = false;
 
 #ifdef ESP_PLATFORM
+/* Runtime metrics: time spent pushing one flush area to the LCD */
+METRIC_HISTOGRAM_DEFINE(s_m_flush_us, "display_flush_us", 500, 1000, 2000, 5000, 10000, 20000, 50000);
+
 /**
  * @brief LVGL flush callback function
  * Called by LVGL when it needs to flush the display buffer
@@ -43,14 +48,16 @@ static void lvgl_flush_cb(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_col
     uint16_t width = area->x2 - area->x1 + 1;
     uint16_t height = area->y2 - area->y1 + 1;
     
-    ESP_LOGI(TAG, "Flush area: (%d,%d) to (%d,%d), size: %dx%d", 
+    BINLOG_D(TAG, "Flush area: (%d,%d) to (%d,%d), size: %dx%d", 
              area->x1, area->y1, area->x2, area->y2, width, height);
 
     // Draw bitmap to LCD
+    int64_t flush_start = metrics_now_us();
     esp_err_t ret = lcd_draw_bitmap(lvgl_handle->lcd_handle, 
                                    area->x1, area->y1, 
                                    width, height, 
                                    (uint16_t*)color_p);
+    metric_observe_since_us(&s_m_flush_us, flush_start);
     
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to draw bitmap: %s", esp_err_to_name(ret));
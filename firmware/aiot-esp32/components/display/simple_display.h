@@ -16,7 +16,7 @@ extern "C" {
 
 /**
  * @brief 传感器显示信息结构体 - 用于LCD动态UI显示
- * 注意：这是bsp_sensor_display_info_t的兼容副本，避免循环依赖
+ * 由main.c按传感器注册表（sensor_hub）生成
  */
 typedef struct {
     const char *name;             ///< 传感器名称，如"DHT11"
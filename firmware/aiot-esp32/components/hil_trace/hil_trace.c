@@ -0,0 +1,368 @@
+/**
+ * @file hil_trace.c
+ * @brief 硬件在环（HIL）采集实现
+ *
+ * 记录路径：互斥锁内追加到线性缓冲区，写满即停止采集（保证回放从开头起完整）。
+ * 边沿路径：GPIO中断把(时间戳<<1 | 电平)写入静态数组，end时在任务中
+ * 转换为各段持续时间，作为一条EDGES记录追加。
+ */
+
+#include "hil_trace.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "HIL_TRACE";
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t start_ms;
+    uint32_t reserved;
+} file_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t type;
+    uint8_t arg;
+    uint16_t len;
+    uint32_t dt_us;
+} record_header_t;
+
+_Static_assert(sizeof(file_header_t) == HIL_TRACE_FILE_HEADER_SIZE, "file header size");
+_Static_assert(sizeof(record_header_t) == HIL_TRACE_RECORD_HEADER_SIZE, "record header size");
+
+static struct {
+    uint8_t *buf;
+    uint32_t used;
+    uint32_t records;
+    int64_t last_us;
+    volatile bool active;
+    bool truncated;
+    SemaphoreHandle_t mutex;
+} s_trace;
+
+static struct {
+    uint32_t samples[CONFIG_HIL_TRACE_MAX_EDGES];  // (时间戳us << 1) | 电平
+    volatile uint32_t count;
+    volatile uint32_t dropped;
+    int pin;
+    uint8_t initial_level;
+    uint32_t start_us;
+} s_edges = { .pin = GPIO_NUM_NC };
+
+/* ==================== 采集控制 ==================== */
+
+esp_err_t hil_trace_start(void)
+{
+    if (!s_trace.mutex) {
+        s_trace.mutex = xSemaphoreCreateMutex();
+        if (!s_trace.mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (!s_trace.buf) {
+        // 64KB在内部RAM中偏大，有PSRAM时放到PSRAM
+        s_trace.buf = heap_caps_malloc(CONFIG_HIL_TRACE_BUF_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!s_trace.buf) {
+            s_trace.buf = heap_caps_malloc(CONFIG_HIL_TRACE_BUF_SIZE, MALLOC_CAP_8BIT);
+        }
+        if (!s_trace.buf) {
+            ESP_LOGE(TAG, "❌ 无法分配 %d 字节采集缓冲区", CONFIG_HIL_TRACE_BUF_SIZE);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    xSemaphoreTake(s_trace.mutex, portMAX_DELAY);
+    int64_t now = esp_timer_get_time();
+    file_header_t header = {
+        .magic = HIL_TRACE_MAGIC,
+        .version = HIL_TRACE_VERSION,
+        .header_size = HIL_TRACE_FILE_HEADER_SIZE,
+        .start_ms = (uint32_t)(now / 1000),
+    };
+    memcpy(s_trace.buf, &header, sizeof(header));
+    s_trace.used = sizeof(header);
+    s_trace.records = 0;
+    s_trace.last_us = now;
+    s_trace.truncated = false;
+    s_edges.dropped = 0;
+    s_trace.active = true;
+    xSemaphoreGive(s_trace.mutex);
+
+    ESP_LOGI(TAG, "⏺️ 开始采集，缓冲区 %d 字节", CONFIG_HIL_TRACE_BUF_SIZE);
+    return ESP_OK;
+}
+
+void hil_trace_stop(void)
+{
+    if (s_trace.active) {
+        s_trace.active = false;
+        ESP_LOGI(TAG, "⏹️ 停止采集: %lu 条记录, %lu 字节",
+                 (unsigned long)s_trace.records, (unsigned long)s_trace.used);
+    }
+}
+
+bool hil_trace_active(void)
+{
+    return s_trace.active;
+}
+
+void hil_trace_get_stats(hil_trace_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    stats->active = s_trace.active;
+    stats->truncated = s_trace.truncated;
+    stats->records = s_trace.records;
+    stats->bytes = s_trace.used;
+    stats->capacity = CONFIG_HIL_TRACE_BUF_SIZE;
+    stats->edges_dropped = s_edges.dropped;
+}
+
+esp_err_t hil_trace_read(uint32_t cursor, uint8_t *buf, size_t buf_size,
+                         size_t *out_len, uint32_t *next)
+{
+    if (!buf || !out_len || !next) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_trace.buf || s_trace.used == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_trace.mutex, portMAX_DELAY);
+    size_t n = 0;
+    if (cursor < s_trace.used) {
+        n = s_trace.used - cursor;
+        if (n > buf_size) {
+            n = buf_size;
+        }
+        memcpy(buf, s_trace.buf + cursor, n);
+    }
+    xSemaphoreGive(s_trace.mutex);
+
+    *out_len = n;
+    *next = cursor + n;
+    return ESP_OK;
+}
+
+/* ==================== 记录 ==================== */
+
+// 追加一条记录（负载分两段，避免调用方先拼接）；缓冲区满时停止采集
+static void append_record(hil_trace_type_t type, uint8_t arg,
+                          const void *p1, size_t len1, const void *p2, size_t len2)
+{
+    size_t len = len1 + len2;
+    if (len > UINT16_MAX) {
+        len2 = UINT16_MAX - len1;
+        len = UINT16_MAX;
+    }
+
+    xSemaphoreTake(s_trace.mutex, portMAX_DELAY);
+    if (!s_trace.active) {
+        xSemaphoreGive(s_trace.mutex);
+        return;
+    }
+    if (s_trace.used + HIL_TRACE_RECORD_HEADER_SIZE + len > CONFIG_HIL_TRACE_BUF_SIZE) {
+        s_trace.active = false;
+        s_trace.truncated = true;
+        xSemaphoreGive(s_trace.mutex);
+        ESP_LOGW(TAG, "⚠️ 采集缓冲区已满，自动停止（%lu 条记录）", (unsigned long)s_trace.records);
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    int64_t dt = now - s_trace.last_us;
+    record_header_t header = {
+        .type = (uint8_t)type,
+        .arg = arg,
+        .len = (uint16_t)len,
+        .dt_us = dt > UINT32_MAX ? UINT32_MAX : (uint32_t)dt,
+    };
+    s_trace.last_us = now;
+
+    uint8_t *p = s_trace.buf + s_trace.used;
+    memcpy(p, &header, sizeof(header));
+    p += sizeof(header);
+    if (len1) {
+        memcpy(p, p1, len1);
+    }
+    if (len2) {
+        memcpy(p + len1, p2, len2);
+    }
+    s_trace.used += sizeof(header) + len;
+    s_trace.records++;
+    xSemaphoreGive(s_trace.mutex);
+}
+
+void hil_trace_sensor(uint8_t sensor_id, esp_err_t err, const float *values, uint8_t count)
+{
+    if (!s_trace.active) {
+        return;
+    }
+    if (!values || err != ESP_OK) {
+        count = 0;
+    }
+    if (count > HIL_TRACE_MAX_SENSOR_VALUES) {
+        count = HIL_TRACE_MAX_SENSOR_VALUES;
+    }
+    int16_t err16 = err == ESP_OK ? 0 : (int16_t)(err & 0x7FFF);
+    uint8_t head[4];
+    memcpy(head, &err16, sizeof(err16));
+    head[2] = count;
+    head[3] = 0;
+    append_record(HIL_TRACE_SENSOR, sensor_id, head, sizeof(head), values, count * sizeof(float));
+}
+
+void hil_trace_mqtt(hil_trace_type_t type, const char *topic, size_t topic_len,
+                    const void *data, size_t data_len, int qos)
+{
+    if (!s_trace.active || !topic) {
+        return;
+    }
+    uint8_t head[1 + UINT8_MAX];
+    if (topic_len > UINT8_MAX) {
+        topic_len = UINT8_MAX;
+    }
+    head[0] = (uint8_t)topic_len;
+    memcpy(head + 1, topic, topic_len);
+    append_record(type, (uint8_t)qos, head, 1 + topic_len, data, data ? data_len : 0);
+}
+
+void hil_trace_mark(const char *text)
+{
+    if (!s_trace.active || !text) {
+        return;
+    }
+    append_record(HIL_TRACE_MARK, 0, text, strlen(text), NULL, 0);
+}
+
+/* ==================== 边沿采集 ==================== */
+
+static void IRAM_ATTR edge_isr(void *arg)
+{
+    uint32_t n = s_edges.count;
+    if (n >= CONFIG_HIL_TRACE_MAX_EDGES) {
+        s_edges.dropped++;
+        return;
+    }
+    uint32_t t = (uint32_t)esp_timer_get_time();
+    s_edges.samples[n] = (t << 1) | (uint32_t)gpio_get_level((gpio_num_t)(intptr_t)arg);
+    s_edges.count = n + 1;
+}
+
+esp_err_t hil_trace_edges_begin(gpio_num_t pin)
+{
+    if (!s_trace.active) {
+        return ESP_OK;
+    }
+    if (s_edges.pin != GPIO_NUM_NC) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 按键模块可能已安装ISR服务
+    esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        return ret;
+    }
+
+    s_edges.count = 0;
+    s_edges.pin = pin;
+    s_edges.initial_level = (uint8_t)gpio_get_level(pin);
+    s_edges.start_us = (uint32_t)esp_timer_get_time();
+    gpio_set_intr_type(pin, GPIO_INTR_ANYEDGE);
+    ret = gpio_isr_handler_add(pin, edge_isr, (void *)(intptr_t)pin);
+    if (ret != ESP_OK) {
+        gpio_set_intr_type(pin, GPIO_INTR_DISABLE);
+        s_edges.pin = GPIO_NUM_NC;
+        return ret;
+    }
+    gpio_intr_enable(pin);
+    return ESP_OK;
+}
+
+void hil_trace_edges_end(gpio_num_t pin)
+{
+    if (s_edges.pin != pin) {
+        return;
+    }
+    gpio_intr_disable(pin);
+    gpio_isr_handler_remove(pin);
+    gpio_set_intr_type(pin, GPIO_INTR_DISABLE);
+    uint32_t end_us = (uint32_t)esp_timer_get_time();
+    s_edges.pin = GPIO_NUM_NC;
+
+    // 时间戳转换为各段持续时间；中断读到的电平与上一段相同（毛刺被合并）时不分段
+    uint16_t durations[CONFIG_HIL_TRACE_MAX_EDGES + 1];
+    uint16_t count = 0;
+    uint32_t seg_start = s_edges.start_us;
+    uint8_t level = s_edges.initial_level;
+    uint32_t n = s_edges.count;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t t = s_edges.samples[i] >> 1;
+        uint8_t new_level = s_edges.samples[i] & 1;
+        if (new_level == level) {
+            continue;
+        }
+        // 时间戳只保留31位，用差值计算，跨越回绕也正确
+        uint32_t d = (t - seg_start) & 0x7FFFFFFF;
+        durations[count++] = d > UINT16_MAX ? UINT16_MAX : (uint16_t)d;
+        seg_start = t;
+        level = new_level;
+    }
+    uint32_t d = (end_us - seg_start) & 0x7FFFFFFF;
+    durations[count++] = d > UINT16_MAX ? UINT16_MAX : (uint16_t)d;
+
+    uint8_t head[4] = {
+        s_edges.initial_level,
+        n >= CONFIG_HIL_TRACE_MAX_EDGES ? HIL_TRACE_EDGE_OVERFLOW : 0,
+        (uint8_t)(count & 0xFF),
+        (uint8_t)(count >> 8),
+    };
+    append_record(HIL_TRACE_EDGES, (uint8_t)pin, head, sizeof(head), durations, count * sizeof(uint16_t));
+}
+
+/* ==================== 解析 ==================== */
+
+esp_err_t hil_trace_parse_header(const uint8_t *data, size_t len, uint32_t *start_ms)
+{
+    if (!data || len < HIL_TRACE_FILE_HEADER_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    file_header_t header;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != HIL_TRACE_MAGIC) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (header.version != HIL_TRACE_VERSION || header.header_size != HIL_TRACE_FILE_HEADER_SIZE) {
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (start_ms) {
+        *start_ms = header.start_ms;
+    }
+    return ESP_OK;
+}
+
+bool hil_trace_parse_next(const uint8_t *data, size_t len, size_t *offset, hil_trace_record_t *record)
+{
+    if (!data || !offset || !record || *offset + HIL_TRACE_RECORD_HEADER_SIZE > len) {
+        return false;
+    }
+    record_header_t header;
+    memcpy(&header, data + *offset, sizeof(header));
+    if (*offset + HIL_TRACE_RECORD_HEADER_SIZE + header.len > len) {
+        return false;
+    }
+    record->type = (hil_trace_type_t)header.type;
+    record->arg = header.arg;
+    record->time_us += header.dt_us;
+    record->payload = data + *offset + HIL_TRACE_RECORD_HEADER_SIZE;
+    record->len = header.len;
+    *offset += HIL_TRACE_RECORD_HEADER_SIZE + header.len;
+    return true;
+}
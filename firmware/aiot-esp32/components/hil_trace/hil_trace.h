@@ -0,0 +1,214 @@
+/**
+ * @file hil_trace.h
+ * @brief 硬件在环（HIL）采集：传感器读数、单总线波形、MQTT收发
+ *
+ * 现场设备上用MQTT命令开启采集，记录带时间戳的：
+ * - 传感器读数（驱动返回值 + 数值）
+ * - DHT11 / DS18B20 数据线的电平跳变（GPIO任意沿中断打时间戳）
+ * - MQTT收到和发出的消息（主题 + 负载）
+ * 记录写入RAM缓冲区（有PSRAM时优先使用），写满自动停止，
+ * 用 get_trace 命令分块读出后由 tools/hil_trace_dump.py 拼成.hilt文件，
+ * 再用主机工具 tools/host/hil_replay.c 按时间顺序确定性回放。
+ *
+ * 采集未开启时各记录函数只读一次标志位就返回，可以常驻在热路径中。
+ */
+
+#ifndef HIL_TRACE_H
+#define HIL_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_HIL_TRACE_BUF_SIZE
+#define CONFIG_HIL_TRACE_BUF_SIZE       (64 * 1024)
+#endif
+
+#ifndef CONFIG_HIL_TRACE_MAX_EDGES
+#define CONFIG_HIL_TRACE_MAX_EDGES      256
+#endif
+
+/*
+ * 文件格式（小端）：
+ *   文件头16字节：magic "HILT", version(16), header_size(16), start_ms(32), reserved(32)
+ *   记录：type(8) arg(8) len(16) dt_us(32) + len字节负载
+ *     dt_us为距上一条记录的微秒数（第一条记录距采集开始）
+ *
+ * 负载：
+ *   SENSOR  arg=传感器ID（sample_sensor_id_t）  err(i16) count(u8) pad(u8) float[count]
+ *   EDGES   arg=GPIO号  initial_level(u8) flags(u8) count(u16) u16[count]
+ *           每段电平持续的微秒数，电平从initial_level开始交替；
+ *           flags bit0=边沿缓冲区溢出，后面的边沿已丢失
+ *   MQTT_RX / MQTT_TX  arg=QoS  topic_len(u8) topic data
+ *   MARK    arg=0  文本
+ */
+#define HIL_TRACE_MAGIC                 0x544C4948  // "HILT"
+#define HIL_TRACE_VERSION               1
+#define HIL_TRACE_FILE_HEADER_SIZE      16
+#define HIL_TRACE_RECORD_HEADER_SIZE    8
+#define HIL_TRACE_MAX_SENSOR_VALUES     4
+#define HIL_TRACE_EDGE_OVERFLOW         0x01
+
+/**
+ * @brief 记录类型
+ */
+typedef enum {
+    HIL_TRACE_SENSOR = 1,          ///< 传感器读数
+    HIL_TRACE_EDGES = 2,           ///< GPIO电平跳变序列
+    HIL_TRACE_MQTT_RX = 3,         ///< 收到的MQTT消息
+    HIL_TRACE_MQTT_TX = 4,         ///< 发出的MQTT消息
+    HIL_TRACE_MARK = 5,            ///< 文本标记
+} hil_trace_type_t;
+
+/**
+ * @brief 解析后的一条记录（指针指向原始缓冲区，不拷贝）
+ */
+typedef struct {
+    hil_trace_type_t type;
+    uint8_t arg;
+    uint64_t time_us;              ///< 距采集开始的微秒数（已累加dt_us）
+    const uint8_t *payload;
+    uint16_t len;
+} hil_trace_record_t;
+
+/**
+ * @brief 采集统计
+ */
+typedef struct {
+    bool active;                   ///< 是否正在采集
+    bool truncated;                ///< 是否因缓冲区写满而停止
+    uint32_t records;              ///< 记录条数
+    uint32_t bytes;                ///< 已用字节（含文件头）
+    uint32_t capacity;             ///< 缓冲区大小
+    uint32_t edges_dropped;        ///< 溢出丢弃的边沿数
+} hil_trace_stats_t;
+
+/* ==================== 采集控制 ==================== */
+
+/**
+ * @brief 开始采集（丢弃上一次的数据）
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_NO_MEM: 缓冲区分配失败
+ */
+esp_err_t hil_trace_start(void);
+
+/**
+ * @brief 停止采集，数据保留到下一次start
+ */
+void hil_trace_stop(void);
+
+/**
+ * @brief 是否正在采集
+ */
+bool hil_trace_active(void);
+
+/**
+ * @brief 获取采集统计
+ */
+void hil_trace_get_stats(hil_trace_stats_t *stats);
+
+/**
+ * @brief 读取已采集的数据（从文件头开始的字节流）
+ *
+ * @param cursor 起始偏移
+ * @param buf 输出缓冲区
+ * @param buf_size 缓冲区大小
+ * @param out_len 实际读出的字节数，0表示已读完
+ * @param next 下一次读取的偏移
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_STATE: 没有数据
+ */
+esp_err_t hil_trace_read(uint32_t cursor, uint8_t *buf, size_t buf_size,
+                         size_t *out_len, uint32_t *next);
+
+/* ==================== 记录（任务上下文） ==================== */
+
+/**
+ * @brief 记录一次传感器读取
+ *
+ * @param sensor_id 传感器ID（sample_sensor_id_t）
+ * @param err 驱动返回值
+ * @param values 数值（err非ESP_OK时可为NULL）
+ * @param count 数值个数，最多 HIL_TRACE_MAX_SENSOR_VALUES
+ */
+void hil_trace_sensor(uint8_t sensor_id, esp_err_t err, const float *values, uint8_t count);
+
+/**
+ * @brief 记录一条MQTT消息
+ *
+ * @param type HIL_TRACE_MQTT_RX 或 HIL_TRACE_MQTT_TX
+ * @param topic 主题（不要求'\0'结尾）
+ * @param topic_len 主题长度（超过255截断）
+ * @param data 负载
+ * @param data_len 负载长度
+ * @param qos QoS
+ */
+void hil_trace_mqtt(hil_trace_type_t type, const char *topic, size_t topic_len,
+                    const void *data, size_t data_len, int qos);
+
+/**
+ * @brief 记录文本标记
+ */
+void hil_trace_mark(const char *text);
+
+/**
+ * @brief 开始记录引脚的电平跳变
+ *
+ * 在传感器驱动读取前调用：挂接GPIO任意沿中断，中断中只保存时间戳和电平。
+ * 中断响应约2~3us，相对DHT11的26/70us位宽和1-Wire的15us采样点可以接受。
+ * 同一时间只能记录一个引脚。
+ *
+ * @param pin 数据线引脚
+ * @return esp_err_t
+ *   - ESP_OK: 成功（未在采集时也返回ESP_OK，不做任何事）
+ *   - ESP_ERR_INVALID_STATE: 已有引脚在记录
+ */
+esp_err_t hil_trace_edges_begin(gpio_num_t pin);
+
+/**
+ * @brief 停止记录并把跳变序列写成一条EDGES记录
+ *
+ * @param pin 与begin相同的引脚
+ */
+void hil_trace_edges_end(gpio_num_t pin);
+
+/* ==================== 解析（主机工具与固件共用） ==================== */
+
+/**
+ * @brief 检查文件头
+ *
+ * @param data 数据（从文件头开始）
+ * @param len 数据长度
+ * @param start_ms 输出采集开始时设备的开机时间（毫秒，可为NULL）
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_VERSION: 版本不符
+ *   - ESP_ERR_INVALID_ARG: 不是trace文件
+ */
+esp_err_t hil_trace_parse_header(const uint8_t *data, size_t len, uint32_t *start_ms);
+
+/**
+ * @brief 解析下一条记录
+ *
+ * @param data 数据（从文件头开始）
+ * @param len 数据长度
+ * @param offset 输入当前偏移（首次传HIL_TRACE_FILE_HEADER_SIZE），输出下一条的偏移
+ * @param record 输出记录，record->time_us 需在首次调用前置0
+ * @return true 解析成功；false 已到末尾或数据截断
+ */
+bool hil_trace_parse_next(const uint8_t *data, size_t len, size_t *offset, hil_trace_record_t *record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HIL_TRACE_H
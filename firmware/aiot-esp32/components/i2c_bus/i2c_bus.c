@@ -0,0 +1,139 @@
+/**
+ * @file i2c_bus.c
+ * @brief I2C事务队列：按设备保序的优先级调度和寄存器连续读合并（纯逻辑，不访问硬件）
+ */
+
+#include "i2c_bus.h"
+#include <string.h>
+
+void i2c_bus_queue_init(i2c_bus_queue_t *q)
+{
+    memset(q, 0, sizeof(*q));
+}
+
+esp_err_t i2c_bus_queue_push(i2c_bus_queue_t *q, i2c_bus_item_t *item, int64_t now_us)
+{
+    if (q->count >= CONFIG_I2C_BUS_QUEUE_LEN) {
+        return ESP_ERR_NO_MEM;
+    }
+    item->seq = q->next_seq++;
+    item->enqueue_us = now_us;
+    q->items[q->count++] = *item;
+    return ESP_OK;
+}
+
+static void queue_remove(i2c_bus_queue_t *q, uint8_t index)
+{
+    memmove(&q->items[index], &q->items[index + 1], (q->count - index - 1) * sizeof(q->items[0]));
+    q->count--;
+}
+
+// 设备的第一个排队请求才能被调度（同一设备的请求保持提交顺序）
+static bool is_device_head(const i2c_bus_queue_t *q, uint8_t index)
+{
+    for (uint8_t i = 0; i < index; i++) {
+        if (q->items[i].dev == q->items[index].dev) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool can_burst(const i2c_bus_item_t *item)
+{
+    return item->burst && !item->txn.fifo && item->txn.type == I2C_BUS_TXN_READ_REG &&
+           item->txn.rlen <= CONFIG_I2C_BUS_BURST_MAX;
+}
+
+bool i2c_bus_queue_pop(i2c_bus_queue_t *q, int64_t now_us, i2c_bus_batch_t *batch)
+{
+    if (q->count == 0) {
+        return false;
+    }
+
+    // 数组按提交顺序排列，遇到严格更高的优先级才替换，同优先级先提交的优先
+    int best = -1;
+    uint8_t best_prio = 0;
+    for (uint8_t i = 0; i < q->count; i++) {
+        if (!is_device_head(q, i)) {
+            continue;
+        }
+        uint8_t prio = q->items[i].prio;
+        if (now_us - q->items[i].enqueue_us >= (int64_t)CONFIG_I2C_BUS_AGING_MS * 1000) {
+            prio = I2C_BUS_PRIO_SENSOR;
+        }
+        if (best < 0 || prio < best_prio) {
+            best = i;
+            best_prio = prio;
+        }
+    }
+
+    const i2c_bus_item_t *head = &q->items[best];
+    batch->dev = head->dev;
+    batch->type = head->txn.type;
+    batch->reg = head->txn.reg;
+    batch->len = head->txn.type == I2C_BUS_TXN_WRITE ? head->txn.wlen : head->txn.rlen;
+    batch->count = 1;
+    batch->items[0] = *head;
+    queue_remove(q, best);
+
+    if (!can_burst(&batch->items[0])) {
+        return true;
+    }
+
+    // 合并同一设备紧随其后的寄存器读；遇到不能合并的请求就停止，不越过它改变顺序
+    int lo = batch->reg;
+    int hi = batch->reg + (int)batch->len;
+    uint8_t i = best;
+    while (i < q->count && batch->count < I2C_BUS_BATCH_MAX) {
+        const i2c_bus_item_t *item = &q->items[i];
+        if (item->dev != batch->dev) {
+            i++;
+            continue;
+        }
+        if (!can_burst(item)) {
+            break;
+        }
+        int item_lo = item->txn.reg;
+        int item_hi = item->txn.reg + (int)item->txn.rlen;
+        int new_lo = item_lo < lo ? item_lo : lo;
+        int new_hi = item_hi > hi ? item_hi : hi;
+        if (item_lo > hi + CONFIG_I2C_BUS_MERGE_GAP || item_hi + CONFIG_I2C_BUS_MERGE_GAP < lo ||
+            new_hi - new_lo > CONFIG_I2C_BUS_BURST_MAX || new_hi > 256) {
+            break;
+        }
+        lo = new_lo;
+        hi = new_hi;
+        batch->items[batch->count++] = *item;
+        queue_remove(q, i);
+    }
+    batch->reg = (uint8_t)lo;
+    batch->len = (size_t)(hi - lo);
+    return true;
+}
+
+void i2c_bus_batch_scatter(const i2c_bus_batch_t *batch, const uint8_t *data)
+{
+    for (uint8_t i = 0; i < batch->count; i++) {
+        const i2c_bus_txn_t *txn = &batch->items[i].txn;
+        memcpy(txn->rbuf, data + (txn->reg - batch->reg), txn->rlen);
+    }
+}
+
+uint32_t i2c_bus_xfer_time_us(const i2c_bus_batch_t *batch, uint32_t scl_hz)
+{
+    if (scl_hz == 0) {
+        return 0;
+    }
+    // 起始 + 地址字节 + 停止；每字节8位数据 + 1位应答
+    uint64_t bits = 1 + 9 + 1;
+    switch (batch->type) {
+    case I2C_BUS_TXN_READ_REG:
+        bits += 9 + 1 + 9 + 9 * (uint64_t)batch->len;   // 寄存器地址 + 重复起始 + 地址字节 + 数据
+        break;
+    default:
+        bits += 9 * (uint64_t)batch->len;
+        break;
+    }
+    return (uint32_t)((bits * 1000000 + scl_hz - 1) / scl_hz);
+}
@@ -0,0 +1,314 @@
+/**
+ * @file i2c_bus.h
+ * @brief I2C总线管理：每条总线一个事务队列，按优先级调度、合并寄存器连续读、异步完成回调
+ *
+ * P4板的BH1750、BMP280、MPU6050挂在同一条I2C总线上，OLED显示屏也走I2C。各驱动各自调用
+ * i2c_master_* 时，显示刷新的大块写入会把传感器读数挡在后面，并发访问还要靠驱动自己加锁。本组件：
+ *
+ * - 总线按 SDA/SCL 引脚共享：第一个 i2c_bus_open() 创建总线，之后相同引脚返回同一条；
+ * - 设备的事务进入总线队列，由总线工作任务依次执行。调度按设备保持先后顺序，
+ *   设备之间按优先级（传感器读取 > 普通 > 显示刷新）和提交顺序选择，
+ *   低优先级排队超过 CONFIG_I2C_BUS_AGING_MS 后按最高优先级处理，不会一直等下去；
+ * - 支持寄存器地址自动递增的设备（burst_read），队首连续的几个寄存器读请求
+ *   地址相邻或重叠时合并成一次突发读，读完再分给各请求；
+ * - 异步提交在工作任务中调用完成回调；同步接口等待完成后返回；
+ * - 统计总线占用率、每个设备的排队+传输延迟，并登记到 metrics。
+ *
+ * 队列、调度和合并（i2c_bus_queue_* / i2c_bus_batch_*）只依赖传入的微秒时间，可在主机上测试；
+ * ESP-IDF i2c_master 驱动之上的运行时在 i2c_bus_master.c 中。
+ */
+
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_I2C_BUS_MAX_BUSES
+#define CONFIG_I2C_BUS_MAX_BUSES        2
+#endif
+
+#ifndef CONFIG_I2C_BUS_MAX_DEVICES
+#define CONFIG_I2C_BUS_MAX_DEVICES      8       ///< 每条总线
+#endif
+
+#ifndef CONFIG_I2C_BUS_QUEUE_LEN
+#define CONFIG_I2C_BUS_QUEUE_LEN        16      ///< 每条总线
+#endif
+
+#ifndef CONFIG_I2C_BUS_BURST_MAX
+#define CONFIG_I2C_BUS_BURST_MAX        32      ///< 合并后单次突发读最大字节数
+#endif
+
+#ifndef CONFIG_I2C_BUS_MERGE_GAP
+#define CONFIG_I2C_BUS_MERGE_GAP        4       ///< 合并时允许多读的间隙字节数
+#endif
+
+#ifndef CONFIG_I2C_BUS_AGING_MS
+#define CONFIG_I2C_BUS_AGING_MS         100
+#endif
+
+#ifndef CONFIG_I2C_BUS_TIMEOUT_MS
+#define CONFIG_I2C_BUS_TIMEOUT_MS       50      ///< 单次传输超时
+#endif
+
+#ifndef CONFIG_I2C_BUS_TASK_PRIORITY
+#define CONFIG_I2C_BUS_TASK_PRIORITY    6
+#endif
+
+#define I2C_BUS_BATCH_MAX           8       ///< 一次突发读最多合并的请求数
+
+/**
+ * @brief 事务优先级（数值小的先执行）
+ */
+typedef enum {
+    I2C_BUS_PRIO_SENSOR = 0,        ///< 传感器读取
+    I2C_BUS_PRIO_NORMAL,            ///< 配置写入等
+    I2C_BUS_PRIO_DISPLAY,           ///< 显示刷新
+    I2C_BUS_PRIO_COUNT,
+} i2c_bus_prio_t;
+
+/**
+ * @brief 事务类型
+ */
+typedef enum {
+    I2C_BUS_TXN_WRITE = 0,          ///< 写 wbuf
+    I2C_BUS_TXN_READ_REG,           ///< 写寄存器地址 reg，重复起始后读 rlen 字节
+    I2C_BUS_TXN_READ,               ///< 直接读 rlen 字节
+} i2c_bus_txn_type_t;
+
+/**
+ * @brief 事务（缓冲区在完成前必须保持有效）
+ */
+typedef struct {
+    i2c_bus_txn_type_t type;
+    uint8_t reg;
+    const uint8_t *wbuf;
+    size_t wlen;
+    uint8_t *rbuf;
+    size_t rlen;
+    bool fifo;                      ///< reg 是FIFO端口（读取有副作用、地址不递增），不参与合并
+} i2c_bus_txn_t;
+
+typedef struct i2c_bus *i2c_bus_handle_t;
+typedef struct i2c_bus_device *i2c_bus_device_handle_t;
+
+/**
+ * @brief 完成回调（在总线工作任务中调用，不要在回调里调用同步接口）
+ *
+ * @param err 传输结果
+ * @param arg 提交时的参数
+ */
+typedef void (*i2c_bus_done_cb_t)(esp_err_t err, void *arg);
+
+/* ==================== 队列与合并 ==================== */
+
+/**
+ * @brief 队列项
+ */
+typedef struct {
+    i2c_bus_device_handle_t dev;
+    i2c_bus_txn_t txn;
+    uint8_t prio;
+    bool burst;                     ///< 设备支持寄存器地址自动递增
+    uint32_t seq;                   ///< 提交序号
+    int64_t enqueue_us;
+    i2c_bus_done_cb_t cb;
+    void *arg;
+} i2c_bus_item_t;
+
+typedef struct {
+    i2c_bus_item_t items[CONFIG_I2C_BUS_QUEUE_LEN];     ///< 按提交顺序
+    uint8_t count;
+    uint32_t next_seq;
+} i2c_bus_queue_t;
+
+/**
+ * @brief 一次总线传输：单个事务，或合并后的一次突发读
+ */
+typedef struct {
+    i2c_bus_device_handle_t dev;
+    i2c_bus_txn_type_t type;
+    uint8_t reg;                    ///< 突发读起始寄存器
+    size_t len;                     ///< 突发读长度
+    uint8_t count;                  ///< 包含的请求数（>1 表示合并）
+    i2c_bus_item_t items[I2C_BUS_BATCH_MAX];
+} i2c_bus_batch_t;
+
+void i2c_bus_queue_init(i2c_bus_queue_t *q);
+
+/**
+ * @brief 入队（填写 seq 和 enqueue_us）
+ *
+ * @return ESP_OK 或 ESP_ERR_NO_MEM（队列满）
+ */
+esp_err_t i2c_bus_queue_push(i2c_bus_queue_t *q, i2c_bus_item_t *item, int64_t now_us);
+
+/**
+ * @brief 取出下一次传输
+ *
+ * 只考虑每个设备最早提交的请求；其中排队超过 CONFIG_I2C_BUS_AGING_MS 的视为最高优先级，
+ * 同优先级按提交顺序。选中的是支持突发读的寄存器读时，继续合并同一设备紧随其后的寄存器读，
+ * 条件是合并后的范围不超过 CONFIG_I2C_BUS_BURST_MAX、与已有范围的间隙不超过 CONFIG_I2C_BUS_MERGE_GAP。
+ *
+ * @return 队列为空时返回false
+ */
+bool i2c_bus_queue_pop(i2c_bus_queue_t *q, int64_t now_us, i2c_bus_batch_t *batch);
+
+/**
+ * @brief 把突发读结果分给批次中的各请求
+ *
+ * @param data 从 batch->reg 开始的 batch->len 字节
+ */
+void i2c_bus_batch_scatter(const i2c_bus_batch_t *batch, const uint8_t *data);
+
+/**
+ * @brief 估算一次传输占用总线的时间（起始/停止条件 + 每字节9位，含地址字节）
+ */
+uint32_t i2c_bus_xfer_time_us(const i2c_bus_batch_t *batch, uint32_t scl_hz);
+
+/* ==================== 总线运行时 ==================== */
+
+/**
+ * @brief 总线配置
+ */
+typedef struct {
+    int port;                       ///< I2C端口，-1自动分配
+    gpio_num_t sda;
+    gpio_num_t scl;
+    bool internal_pullup;           ///< 板上没有外部上拉时启用
+    bool manual_service;            ///< 不创建工作任务，由调用者 i2c_bus_service()（主机测试用）
+} i2c_bus_config_t;
+
+/**
+ * @brief 设备配置
+ */
+typedef struct {
+    uint16_t addr;                  ///< 7位地址
+    uint32_t scl_hz;                ///< 时钟频率
+    const char *name;               ///< 统计和日志中显示的名称
+    bool burst_read;                ///< 支持寄存器地址自动递增（允许合并连续读）
+} i2c_bus_device_config_t;
+
+/**
+ * @brief 总线统计
+ */
+typedef struct {
+    uint32_t requests;              ///< 提交的请求数
+    uint32_t transfers;             ///< 实际发起的总线传输数
+    uint32_t merged;                ///< 合并进其他请求突发读的请求数
+    uint32_t errors;
+    uint32_t rejected;              ///< 队列满被拒绝的请求数
+    uint8_t queue_max;              ///< 队列长度高水位
+    uint64_t busy_us;               ///< 统计窗口内的传输时间
+    uint64_t window_us;             ///< 统计窗口长度
+    uint8_t utilization_pct;        ///< busy_us / window_us
+} i2c_bus_stats_t;
+
+/**
+ * @brief 设备统计（延迟 = 排队 + 传输）
+ */
+typedef struct {
+    uint16_t addr;
+    const char *name;
+    uint32_t requests;
+    uint32_t errors;
+    uint32_t latency_avg_us;
+    uint32_t latency_max_us;
+    uint32_t xfer_avg_us;           ///< 平均传输时间（合并读按总时长计入每个请求）
+} i2c_bus_device_stats_t;
+
+/**
+ * @brief 打开总线（相同SDA/SCL的总线已存在时直接返回）
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 引脚无效
+ *   - ESP_ERR_NO_MEM: 总线数已达 CONFIG_I2C_BUS_MAX_BUSES 或资源不足
+ *   - 其他: i2c_new_master_bus 返回的错误
+ */
+esp_err_t i2c_bus_open(const i2c_bus_config_t *config, i2c_bus_handle_t *out);
+
+/**
+ * @brief 在总线上添加设备（同一地址已添加时直接返回）
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 参数错误
+ *   - ESP_ERR_NO_MEM: 设备数已达 CONFIG_I2C_BUS_MAX_DEVICES
+ */
+esp_err_t i2c_bus_add_device(i2c_bus_handle_t bus, const i2c_bus_device_config_t *config,
+                             i2c_bus_device_handle_t *out);
+
+/**
+ * @brief 异步提交事务
+ *
+ * @param cb 完成回调，可为NULL
+ * @return esp_err_t
+ *   - ESP_OK: 已入队
+ *   - ESP_ERR_INVALID_ARG: 参数错误
+ *   - ESP_ERR_NO_MEM: 队列满
+ */
+esp_err_t i2c_bus_submit(i2c_bus_device_handle_t dev, const i2c_bus_txn_t *txn, i2c_bus_prio_t prio,
+                         i2c_bus_done_cb_t cb, void *arg);
+
+/**
+ * @brief 同步读寄存器（等待完成）
+ *
+ * @return esp_err_t 传输结果；在工作任务中调用返回 ESP_ERR_INVALID_STATE
+ */
+esp_err_t i2c_bus_read_reg(i2c_bus_device_handle_t dev, uint8_t reg, uint8_t *buf, size_t len,
+                           i2c_bus_prio_t prio);
+
+/**
+ * @brief 同步读FIFO端口（连续读同一寄存器，不与其他请求合并）
+ */
+esp_err_t i2c_bus_read_fifo(i2c_bus_device_handle_t dev, uint8_t reg, uint8_t *buf, size_t len,
+                            i2c_bus_prio_t prio);
+
+/**
+ * @brief 同步写（等待完成）
+ */
+esp_err_t i2c_bus_write(i2c_bus_device_handle_t dev, const uint8_t *data, size_t len, i2c_bus_prio_t prio);
+
+/**
+ * @brief 同步写一个寄存器
+ */
+esp_err_t i2c_bus_write_reg(i2c_bus_device_handle_t dev, uint8_t reg, uint8_t value, i2c_bus_prio_t prio);
+
+/**
+ * @brief 在调用者上下文中执行队列中的所有事务（manual_service 的总线）
+ *
+ * @return 执行的总线传输数
+ */
+size_t i2c_bus_service(i2c_bus_handle_t bus);
+
+/**
+ * @brief 获取总线统计
+ *
+ * @param reset 读取后开始新的统计窗口（busy_us/window_us 和占用率）
+ */
+esp_err_t i2c_bus_get_stats(i2c_bus_handle_t bus, i2c_bus_stats_t *stats, bool reset);
+
+/**
+ * @brief 获取设备统计
+ */
+esp_err_t i2c_bus_get_device_stats(i2c_bus_device_handle_t dev, i2c_bus_device_stats_t *stats);
+
+/**
+ * @brief 关闭所有总线并删除设备（主机测试用；调用前队列应为空）
+ */
+void i2c_bus_close_all(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // I2C_BUS_H
@@ -0,0 +1,531 @@
+/**
+ * @file i2c_bus_master.c
+ * @brief I2C总线管理运行时：ESP-IDF i2c_master 驱动 + 每条总线一个工作任务
+ *
+ * 提交只在锁内入队并通知工作任务；工作任务每次取出一个批次（单个事务或合并的突发读），
+ * 在锁外完成传输，再更新统计、分发数据、调用回调。同步接口从总线的信号量池取一个信号量，
+ * 以内部回调释放它。manual_service 的总线没有工作任务，同步接口在调用者上下文中执行队列。
+ */
+
+#include "i2c_bus.h"
+#include <string.h>
+#include "driver/i2c_master.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "metrics.h"
+
+static const char *TAG = "i2c_bus";
+
+#define LOCK()      xSemaphoreTake(s_mutex, portMAX_DELAY)
+#define UNLOCK()    xSemaphoreGive(s_mutex)
+
+struct i2c_bus_device {
+    struct i2c_bus *bus;
+    i2c_master_dev_handle_t handle;
+    i2c_bus_device_config_t config;
+    uint32_t requests;
+    uint32_t errors;
+    uint64_t latency_sum_us;
+    uint32_t latency_max_us;
+    uint64_t xfer_sum_us;
+};
+
+struct i2c_bus {
+    bool used;
+    int port;
+    i2c_bus_config_t config;
+    i2c_master_bus_handle_t handle;
+    TaskHandle_t worker;
+    bool servicing;                                 ///< 有任务正在执行队列（manual_service）
+    i2c_bus_queue_t queue;
+    i2c_bus_batch_t batch;                          ///< 只由执行队列的任务使用
+    uint8_t burst[CONFIG_I2C_BUS_BURST_MAX];
+    struct i2c_bus_device devices[CONFIG_I2C_BUS_MAX_DEVICES];
+    uint8_t device_count;
+    SemaphoreHandle_t waiters[CONFIG_I2C_BUS_QUEUE_LEN];   ///< 同步接口用的信号量池
+    uint32_t waiters_free;
+    i2c_bus_stats_t stats;
+    int64_t window_start_us;
+};
+
+typedef struct {
+    SemaphoreHandle_t sem;
+    esp_err_t err;
+} sync_wait_t;
+
+static struct i2c_bus s_buses[CONFIG_I2C_BUS_MAX_BUSES];
+static SemaphoreHandle_t s_mutex = NULL;
+
+METRIC_HISTOGRAM_DEFINE(s_m_latency_us, "i2c_latency_us", 200, 500, 1000, 2000, 5000, 10000, 50000);
+METRIC_COUNTER_DEFINE(s_m_merged, "i2c_merged");
+METRIC_COUNTER_DEFINE(s_m_errors, "i2c_errors");
+METRIC_GAUGE_DEFINE(s_m_util, "i2c_bus_util_pct");
+
+/* ==================== 执行 ==================== */
+
+static esp_err_t execute(struct i2c_bus *bus, i2c_bus_batch_t *batch)
+{
+    i2c_master_dev_handle_t handle = batch->dev->handle;
+    const i2c_bus_txn_t *txn = &batch->items[0].txn;
+
+    switch (batch->type) {
+    case I2C_BUS_TXN_WRITE:
+        return i2c_master_transmit(handle, txn->wbuf, txn->wlen, CONFIG_I2C_BUS_TIMEOUT_MS);
+    case I2C_BUS_TXN_READ:
+        return i2c_master_receive(handle, txn->rbuf, txn->rlen, CONFIG_I2C_BUS_TIMEOUT_MS);
+    case I2C_BUS_TXN_READ_REG: {
+        uint8_t reg = batch->reg;
+        if (batch->count == 1) {
+            return i2c_master_transmit_receive(handle, &reg, 1, txn->rbuf, txn->rlen, CONFIG_I2C_BUS_TIMEOUT_MS);
+        }
+        esp_err_t ret = i2c_master_transmit_receive(handle, &reg, 1, bus->burst, batch->len,
+                                                    CONFIG_I2C_BUS_TIMEOUT_MS);
+        if (ret == ESP_OK) {
+            i2c_bus_batch_scatter(batch, bus->burst);
+        }
+        return ret;
+    }
+    default:
+        return ESP_ERR_INVALID_ARG;
+    }
+}
+
+// 执行一个批次，队列为空时返回false
+static bool service_once(struct i2c_bus *bus)
+{
+    i2c_bus_batch_t *batch = &bus->batch;
+
+    LOCK();
+    bool have = i2c_bus_queue_pop(&bus->queue, esp_timer_get_time(), batch);
+    UNLOCK();
+    if (!have) {
+        return false;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t err = execute(bus, batch);
+    int64_t end_us = esp_timer_get_time();
+    uint32_t xfer_us = (uint32_t)(end_us - start_us);
+
+    struct i2c_bus_device *dev = batch->dev;
+    LOCK();
+    bus->stats.transfers++;
+    bus->stats.merged += batch->count - 1;
+    bus->stats.busy_us += xfer_us;
+    dev->requests += batch->count;
+    dev->xfer_sum_us += (uint64_t)xfer_us * batch->count;
+    if (err != ESP_OK) {
+        bus->stats.errors++;
+        dev->errors += batch->count;
+    }
+    for (uint8_t i = 0; i < batch->count; i++) {
+        uint32_t latency_us = (uint32_t)(end_us - batch->items[i].enqueue_us);
+        dev->latency_sum_us += latency_us;
+        if (latency_us > dev->latency_max_us) {
+            dev->latency_max_us = latency_us;
+        }
+        metric_observe(&s_m_latency_us, latency_us);
+    }
+    int64_t window_us = end_us - bus->window_start_us;
+    if (window_us > 0) {
+        metric_set(&s_m_util, (int32_t)(bus->stats.busy_us * 100 / window_us));
+    }
+    UNLOCK();
+
+    if (batch->count > 1) {
+        metric_add(&s_m_merged, batch->count - 1);
+    }
+    if (err != ESP_OK) {
+        metric_inc(&s_m_errors);
+        ESP_LOGW(TAG, "⚠️ I2C传输失败: %s(0x%02x) %s", dev->config.name ? dev->config.name : "-",
+                 dev->config.addr, esp_err_to_name(err));
+    }
+
+    for (uint8_t i = 0; i < batch->count; i++) {
+        if (batch->items[i].cb) {
+            batch->items[i].cb(err, batch->items[i].arg);
+        }
+    }
+    return true;
+}
+
+static void bus_task(void *arg)
+{
+    struct i2c_bus *bus = arg;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (service_once(bus)) {
+        }
+    }
+}
+
+/* ==================== 总线和设备 ==================== */
+
+static void release_bus(struct i2c_bus *bus)
+{
+    for (uint8_t i = 0; i < bus->device_count; i++) {
+        if (bus->devices[i].handle) {
+            i2c_master_bus_rm_device(bus->devices[i].handle);
+        }
+    }
+    for (int i = 0; i < CONFIG_I2C_BUS_QUEUE_LEN; i++) {
+        if (bus->waiters[i]) {
+            vSemaphoreDelete(bus->waiters[i]);
+        }
+    }
+    if (bus->handle) {
+        i2c_del_master_bus(bus->handle);
+    }
+    memset(bus, 0, sizeof(*bus));
+}
+
+esp_err_t i2c_bus_open(const i2c_bus_config_t *config, i2c_bus_handle_t *out)
+{
+    if (!config || !out || config->sda < 0 || config->scl < 0 || config->sda == config->scl) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    LOCK();
+    struct i2c_bus *bus = NULL;
+    uint32_t ports_used = 0;
+    for (int i = 0; i < CONFIG_I2C_BUS_MAX_BUSES; i++) {
+        if (!s_buses[i].used) {
+            if (!bus) {
+                bus = &s_buses[i];
+            }
+            continue;
+        }
+        if (s_buses[i].config.sda == config->sda && s_buses[i].config.scl == config->scl) {
+            *out = &s_buses[i];
+            UNLOCK();
+            return ESP_OK;
+        }
+        ports_used |= 1u << s_buses[i].port;
+    }
+    if (!bus) {
+        UNLOCK();
+        ESP_LOGE(TAG, "❌ I2C总线数已达上限 %d", CONFIG_I2C_BUS_MAX_BUSES);
+        return ESP_ERR_NO_MEM;
+    }
+
+    int port = config->port;
+    if (port < 0) {
+        port = 0;
+        while (ports_used & (1u << port)) {
+            port++;
+        }
+    }
+
+    memset(bus, 0, sizeof(*bus));
+    bus->used = true;
+    bus->port = port;
+    bus->config = *config;
+    i2c_bus_queue_init(&bus->queue);
+
+    i2c_master_bus_config_t bus_config = {
+        .i2c_port = port,
+        .sda_io_num = config->sda,
+        .scl_io_num = config->scl,
+        .clk_source = I2C_CLK_SRC_DEFAULT,
+        .glitch_ignore_cnt = 7,
+        .flags.enable_internal_pullup = config->internal_pullup,
+    };
+    esp_err_t ret = i2c_new_master_bus(&bus_config, &bus->handle);
+    for (int i = 0; ret == ESP_OK && i < CONFIG_I2C_BUS_QUEUE_LEN; i++) {
+        bus->waiters[i] = xSemaphoreCreateBinary();
+        if (!bus->waiters[i]) {
+            ret = ESP_ERR_NO_MEM;
+        }
+    }
+    bus->waiters_free = CONFIG_I2C_BUS_QUEUE_LEN >= 32 ? UINT32_MAX : (1u << CONFIG_I2C_BUS_QUEUE_LEN) - 1;
+    if (ret == ESP_OK && !config->manual_service &&
+        xTaskCreate(bus_task, "i2c_bus", 3072, bus, CONFIG_I2C_BUS_TASK_PRIORITY, &bus->worker) != pdPASS) {
+        ret = ESP_ERR_NO_MEM;
+    }
+    if (ret != ESP_OK) {
+        release_bus(bus);
+        UNLOCK();
+        ESP_LOGE(TAG, "❌ I2C总线初始化失败: SDA=GPIO%d SCL=GPIO%d %s", config->sda, config->scl, esp_err_to_name(ret));
+        return ret;
+    }
+    bus->window_start_us = esp_timer_get_time();
+    *out = bus;
+    UNLOCK();
+
+    ESP_LOGI(TAG, "✅ I2C总线%d初始化: SDA=GPIO%d SCL=GPIO%d", port, config->sda, config->scl);
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_add_device(i2c_bus_handle_t bus, const i2c_bus_device_config_t *config,
+                             i2c_bus_device_handle_t *out)
+{
+    if (!bus || !config || !out || config->addr > 0x7F || config->scl_hz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    LOCK();
+    for (uint8_t i = 0; i < bus->device_count; i++) {
+        if (bus->devices[i].config.addr == config->addr) {
+            *out = &bus->devices[i];
+            UNLOCK();
+            return ESP_OK;
+        }
+    }
+    if (bus->device_count >= CONFIG_I2C_BUS_MAX_DEVICES) {
+        UNLOCK();
+        return ESP_ERR_NO_MEM;
+    }
+
+    struct i2c_bus_device *dev = &bus->devices[bus->device_count];
+    memset(dev, 0, sizeof(*dev));
+    i2c_device_config_t dev_config = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = config->addr,
+        .scl_speed_hz = config->scl_hz,
+    };
+    esp_err_t ret = i2c_master_bus_add_device(bus->handle, &dev_config, &dev->handle);
+    if (ret == ESP_OK) {
+        dev->bus = bus;
+        dev->config = *config;
+        bus->device_count++;
+        *out = dev;
+    }
+    UNLOCK();
+
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "✅ I2C设备 %s(0x%02x) 已添加到总线%d, %lu Hz", config->name ? config->name : "-",
+                 config->addr, bus->port, (unsigned long)config->scl_hz);
+    } else {
+        ESP_LOGE(TAG, "❌ I2C设备 0x%02x 添加失败: %s", config->addr, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+/* ==================== 提交 ==================== */
+
+// 入队；claim 非NULL时，manual_service 总线上没有其他任务在执行则返回true，由调用者执行队列
+static esp_err_t enqueue(struct i2c_bus_device *dev, const i2c_bus_txn_t *txn, i2c_bus_prio_t prio,
+                         i2c_bus_done_cb_t cb, void *arg, bool *claim)
+{
+    struct i2c_bus *bus = dev->bus;
+    i2c_bus_item_t item = {
+        .dev = dev,
+        .txn = *txn,
+        .prio = prio,
+        .burst = dev->config.burst_read,
+        .cb = cb,
+        .arg = arg,
+    };
+
+    LOCK();
+    bus->stats.requests++;
+    esp_err_t ret = i2c_bus_queue_push(&bus->queue, &item, esp_timer_get_time());
+    if (ret != ESP_OK) {
+        bus->stats.rejected++;
+    } else if (bus->queue.count > bus->stats.queue_max) {
+        bus->stats.queue_max = bus->queue.count;
+    }
+    if (claim) {
+        *claim = ret == ESP_OK && !bus->worker && !bus->servicing;
+        if (*claim) {
+            bus->servicing = true;
+        }
+    }
+    UNLOCK();
+
+    if (ret == ESP_OK && bus->worker) {
+        xTaskNotifyGive(bus->worker);
+    }
+    return ret;
+}
+
+static size_t service_claimed(struct i2c_bus *bus)
+{
+    size_t transfers = 0;
+    for (;;) {
+        while (service_once(bus)) {
+            transfers++;
+        }
+        // 检查和释放在同一个锁内，释放之后入队的请求由入队者自己执行
+        LOCK();
+        if (bus->queue.count == 0) {
+            bus->servicing = false;
+            UNLOCK();
+            return transfers;
+        }
+        UNLOCK();
+    }
+}
+
+static bool txn_valid(const i2c_bus_txn_t *txn)
+{
+    switch (txn->type) {
+    case I2C_BUS_TXN_WRITE:
+        return txn->wbuf && txn->wlen > 0;
+    case I2C_BUS_TXN_READ_REG:
+    case I2C_BUS_TXN_READ:
+        return txn->rbuf && txn->rlen > 0;
+    default:
+        return false;
+    }
+}
+
+esp_err_t i2c_bus_submit(i2c_bus_device_handle_t dev, const i2c_bus_txn_t *txn, i2c_bus_prio_t prio,
+                         i2c_bus_done_cb_t cb, void *arg)
+{
+    if (!dev || !txn || !txn_valid(txn) || prio >= I2C_BUS_PRIO_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // manual_service 总线上的异步请求留给 i2c_bus_service() 或下一个同步请求执行
+    return enqueue(dev, txn, prio, cb, arg, NULL);
+}
+
+static void sync_done(esp_err_t err, void *arg)
+{
+    sync_wait_t *wait = arg;
+    wait->err = err;
+    xSemaphoreGive(wait->sem);
+}
+
+static esp_err_t transfer_sync(struct i2c_bus_device *dev, const i2c_bus_txn_t *txn, i2c_bus_prio_t prio)
+{
+    if (!dev || !txn_valid(txn) || prio >= I2C_BUS_PRIO_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct i2c_bus *bus = dev->bus;
+    if (bus->worker && xTaskGetCurrentTaskHandle() == bus->worker) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    sync_wait_t wait = { .sem = NULL, .err = ESP_FAIL };
+    int slot = -1;
+    LOCK();
+    for (int i = 0; i < CONFIG_I2C_BUS_QUEUE_LEN; i++) {
+        if (bus->waiters_free & (1u << i)) {
+            bus->waiters_free &= ~(1u << i);
+            slot = i;
+            break;
+        }
+    }
+    UNLOCK();
+    if (slot < 0) {
+        return ESP_ERR_NO_MEM;
+    }
+    wait.sem = bus->waiters[slot];
+
+    bool claim;
+    esp_err_t ret = enqueue(dev, txn, prio, sync_done, &wait, &claim);
+    if (ret == ESP_OK) {
+        if (claim) {
+            service_claimed(bus);
+        }
+        xSemaphoreTake(wait.sem, portMAX_DELAY);
+        ret = wait.err;
+    }
+
+    LOCK();
+    bus->waiters_free |= 1u << slot;
+    UNLOCK();
+    return ret;
+}
+
+esp_err_t i2c_bus_read_reg(i2c_bus_device_handle_t dev, uint8_t reg, uint8_t *buf, size_t len,
+                           i2c_bus_prio_t prio)
+{
+    i2c_bus_txn_t txn = { .type = I2C_BUS_TXN_READ_REG, .reg = reg, .rbuf = buf, .rlen = len };
+    return transfer_sync(dev, &txn, prio);
+}
+
+esp_err_t i2c_bus_read_fifo(i2c_bus_device_handle_t dev, uint8_t reg, uint8_t *buf, size_t len,
+                            i2c_bus_prio_t prio)
+{
+    i2c_bus_txn_t txn = { .type = I2C_BUS_TXN_READ_REG, .reg = reg, .rbuf = buf, .rlen = len, .fifo = true };
+    return transfer_sync(dev, &txn, prio);
+}
+
+esp_err_t i2c_bus_write(i2c_bus_device_handle_t dev, const uint8_t *data, size_t len, i2c_bus_prio_t prio)
+{
+    i2c_bus_txn_t txn = { .type = I2C_BUS_TXN_WRITE, .wbuf = data, .wlen = len };
+    return transfer_sync(dev, &txn, prio);
+}
+
+esp_err_t i2c_bus_write_reg(i2c_bus_device_handle_t dev, uint8_t reg, uint8_t value, i2c_bus_prio_t prio)
+{
+    const uint8_t data[2] = { reg, value };
+    return i2c_bus_write(dev, data, sizeof(data), prio);
+}
+
+size_t i2c_bus_service(i2c_bus_handle_t bus)
+{
+    if (!bus || bus->worker) {
+        return 0;
+    }
+    LOCK();
+    bool claim = !bus->servicing;
+    bus->servicing = true;
+    UNLOCK();
+    return claim ? service_claimed(bus) : 0;
+}
+
+/* ==================== 统计 ==================== */
+
+esp_err_t i2c_bus_get_stats(i2c_bus_handle_t bus, i2c_bus_stats_t *stats, bool reset)
+{
+    if (!bus || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int64_t now_us = esp_timer_get_time();
+    LOCK();
+    *stats = bus->stats;
+    stats->window_us = (uint64_t)(now_us - bus->window_start_us);
+    stats->utilization_pct = stats->window_us ? (uint8_t)(stats->busy_us * 100 / stats->window_us) : 0;
+    if (reset) {
+        bus->stats.busy_us = 0;
+        bus->window_start_us = now_us;
+    }
+    UNLOCK();
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_get_device_stats(i2c_bus_device_handle_t dev, i2c_bus_device_stats_t *stats)
+{
+    if (!dev || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    LOCK();
+    stats->addr = dev->config.addr;
+    stats->name = dev->config.name;
+    stats->requests = dev->requests;
+    stats->errors = dev->errors;
+    stats->latency_avg_us = dev->requests ? (uint32_t)(dev->latency_sum_us / dev->requests) : 0;
+    stats->latency_max_us = dev->latency_max_us;
+    stats->xfer_avg_us = dev->requests ? (uint32_t)(dev->xfer_sum_us / dev->requests) : 0;
+    UNLOCK();
+    return ESP_OK;
+}
+
+void i2c_bus_close_all(void)
+{
+    if (!s_mutex) {
+        return;
+    }
+    LOCK();
+    for (int i = 0; i < CONFIG_I2C_BUS_MAX_BUSES; i++) {
+        if (s_buses[i].used) {
+            if (s_buses[i].worker) {
+                vTaskDelete(s_buses[i].worker);
+            }
+            release_bus(&s_buses[i]);
+        }
+    }
+    UNLOCK();
+}
@@ -0,0 +1,282 @@
+/**
+ * @file imu_stream.c
+ * @brief 加速度计处理：无锁环形缓冲、CIC/FIR抽取、基2 FFT和窗口特征（纯计算，不访问硬件）
+ */
+
+#include "imu_stream.h"
+#include <math.h>
+#include <string.h>
+
+#define IMU_PI      3.14159265358979f
+
+/* ==================== 无锁环形缓冲 ==================== */
+
+#define RING_MASK   (CONFIG_IMU_STREAM_RING_SAMPLES - 1)
+
+_Static_assert((CONFIG_IMU_STREAM_RING_SAMPLES & RING_MASK) == 0, "IMU ring size must be a power of two");
+
+void imu_ring_init(imu_ring_t *ring)
+{
+    memset(ring, 0, sizeof(*ring));
+}
+
+// head/tail是自由递增的计数，差值即样本数；对方的索引用acquire读取，自己的索引用release发布
+size_t imu_ring_push(imu_ring_t *ring, const imu_sample_t *samples, size_t count)
+{
+    uint32_t head = ring->head;
+    uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    size_t space = CONFIG_IMU_STREAM_RING_SAMPLES - (head - tail);
+    size_t n = count < space ? count : space;
+    for (size_t i = 0; i < n; i++) {
+        ring->buf[(head + i) & RING_MASK] = samples[i];
+    }
+    __atomic_store_n(&ring->head, head + (uint32_t)n, __ATOMIC_RELEASE);
+    ring->dropped += (uint32_t)(count - n);
+    return n;
+}
+
+size_t imu_ring_pop(imu_ring_t *ring, imu_sample_t *samples, size_t max)
+{
+    uint32_t tail = ring->tail;
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    size_t avail = head - tail;
+    size_t n = max < avail ? max : avail;
+    for (size_t i = 0; i < n; i++) {
+        samples[i] = ring->buf[(tail + i) & RING_MASK];
+    }
+    __atomic_store_n(&ring->tail, tail + (uint32_t)n, __ATOMIC_RELEASE);
+    return n;
+}
+
+size_t imu_ring_count(const imu_ring_t *ring)
+{
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+/* ==================== CIC + FIR 抽取 ==================== */
+
+float imu_cic_gain(uint8_t decimation, float f_norm)
+{
+    float x = IMU_PI * f_norm;
+    if (decimation <= 1 || x == 0.0f) {
+        return 1.0f;
+    }
+    float g = sinf(x * decimation) / (decimation * sinf(x));
+    return fabsf(g * g * g);
+}
+
+esp_err_t imu_decimator_init(imu_decimator_t *dec, uint8_t decimation, float lsb_per_g)
+{
+    if (!dec || decimation == 0 || decimation > 16 || lsb_per_g <= 0.0f) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(dec, 0, sizeof(*dec));
+    dec->decimation = decimation;
+    dec->scale = 1.0f / (lsb_per_g * decimation * decimation * decimation);
+    // 补偿后在输出频率1/4处增益为1：(1 + 2a) * G = 1
+    dec->fir_a = decimation > 1 ? (1.0f / imu_cic_gain(decimation, 0.25f / decimation) - 1.0f) / 2.0f : 0.0f;
+    // 积分器从零开始，前几个输出是阶跃过渡（重力轴从0升到1g），丢弃
+    dec->settle = decimation > 1 ? IMU_CIC_ORDER + 2 : 0;
+    return ESP_OK;
+}
+
+bool imu_decimator_push(imu_decimator_t *dec, const imu_sample_t *sample, float out[IMU_AXES])
+{
+    // 积分器按模2^32运算，梳状级相减后溢出抵消，结果不超过 32768 * R^3
+    for (int a = 0; a < IMU_AXES; a++) {
+        uint32_t v = (uint32_t)(int32_t)sample->v[a];
+        for (int k = 0; k < IMU_CIC_ORDER; k++) {
+            v += (uint32_t)dec->integ[a][k];
+            dec->integ[a][k] = (int32_t)v;
+        }
+    }
+    if (++dec->phase < dec->decimation) {
+        return false;
+    }
+    dec->phase = 0;
+
+    float a_coef = dec->fir_a;
+    for (int a = 0; a < IMU_AXES; a++) {
+        uint32_t v = (uint32_t)dec->integ[a][IMU_CIC_ORDER - 1];
+        for (int k = 0; k < IMU_CIC_ORDER; k++) {
+            uint32_t prev = (uint32_t)dec->comb[a][k];
+            dec->comb[a][k] = (int32_t)v;
+            v -= prev;
+        }
+        float x = (float)(int32_t)v * dec->scale;
+        out[a] = (1.0f + 2.0f * a_coef) * dec->hist[a][0] - a_coef * (x + dec->hist[a][1]);
+        dec->hist[a][1] = dec->hist[a][0];
+        dec->hist[a][0] = x;
+    }
+    if (dec->settle > 0) {
+        dec->settle--;
+        return false;
+    }
+    return true;
+}
+
+/* ==================== FFT ==================== */
+
+esp_err_t imu_fft_init(imu_fft_plan_t *plan, uint16_t n)
+{
+    if (!plan || n < 8 || n > CONFIG_IMU_STREAM_FFT_SIZE || (n & (n - 1)) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(plan, 0, sizeof(*plan));
+    plan->n = n;
+    while ((1u << plan->log2n) < n) {
+        plan->log2n++;
+    }
+    for (uint16_t i = 0; i < n; i++) {
+        uint16_t r = 0;
+        for (uint8_t b = 0; b < plan->log2n; b++) {
+            r |= ((i >> b) & 1u) << (plan->log2n - 1 - b);
+        }
+        plan->bitrev[i] = r;
+    }
+    for (uint16_t k = 0; k < n / 2; k++) {
+        plan->cos_tab[k] = cosf(2.0f * IMU_PI * k / n);
+        plan->sin_tab[k] = -sinf(2.0f * IMU_PI * k / n);
+    }
+    plan->window_power = 0.0f;
+    for (uint16_t i = 0; i < n; i++) {
+        plan->window[i] = 0.5f - 0.5f * cosf(2.0f * IMU_PI * i / n);
+        plan->window_power += plan->window[i] * plan->window[i];
+    }
+    return ESP_OK;
+}
+
+void imu_fft_run(const imu_fft_plan_t *plan, float *re, float *im)
+{
+    const uint16_t n = plan->n;
+    for (uint16_t i = 0; i < n; i++) {
+        uint16_t j = plan->bitrev[i];
+        if (i < j) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+    // 每级的蝶形按旋转因子分组，同一因子的蝶形间隔为size，内层循环只做乘加
+    for (uint16_t size = 2, step = n / 2; size <= n; size <<= 1, step >>= 1) {
+        const uint16_t half = size / 2;
+        for (uint16_t k = 0; k < half; k++) {
+            const float wr = plan->cos_tab[k * step];
+            const float wi = plan->sin_tab[k * step];
+            for (uint16_t i = k; i < n; i += size) {
+                const uint16_t j = i + half;
+                const float tr = wr * re[j] - wi * im[j];
+                const float ti = wr * im[j] + wi * re[j];
+                re[j] = re[i] - tr;
+                im[j] = im[i] - ti;
+                re[i] += tr;
+                im[i] += ti;
+            }
+        }
+    }
+}
+
+/* ==================== 窗口特征 ==================== */
+
+void imu_features_axis(const imu_fft_plan_t *plan, const float *x, float rate_hz,
+                       imu_axis_features_t *out, float *re, float *im)
+{
+    const uint16_t n = plan->n;
+    memset(out, 0, sizeof(*out));
+
+    float sum = 0.0f;
+    for (uint16_t i = 0; i < n; i++) {
+        sum += x[i];
+    }
+    out->mean = sum / n;
+
+    float sq = 0.0f;
+    for (uint16_t i = 0; i < n; i++) {
+        float d = x[i] - out->mean;
+        float ad = fabsf(d);
+        sq += d * d;
+        if (ad > out->peak) {
+            out->peak = ad;
+        }
+        re[i] = d * plan->window[i];
+        im[i] = 0.0f;
+    }
+    out->rms = sqrtf(sq / n);
+    out->crest = out->rms > 0.0f ? out->peak / out->rms : 0.0f;
+
+    imu_fft_run(plan, re, im);
+
+    // 单边功率谱按 Parseval 归一化：各频点之和约等于去均值后的方差（窗函数能量已扣除）
+    const float norm = 1.0f / ((float)n * plan->window_power);
+    const uint16_t half = n / 2;
+    float best = -1.0f;
+    for (uint16_t k = 0; k <= half; k++) {
+        float p = (re[k] * re[k] + im[k] * im[k]) * norm;
+        if (k != 0 && k != half) {
+            p *= 2.0f;
+        }
+        uint32_t band = (uint32_t)k * CONFIG_IMU_STREAM_BANDS / half;
+        if (band >= CONFIG_IMU_STREAM_BANDS) {
+            band = CONFIG_IMU_STREAM_BANDS - 1;
+        }
+        out->bands[band] += p;
+        if (k > 0 && p > best) {
+            best = p;
+            out->dominant_hz = (float)k * rate_hz / n;
+        }
+    }
+}
+
+/* ==================== 处理流水线 ==================== */
+
+esp_err_t imu_pipeline_init(imu_pipeline_t *p, uint32_t input_rate_hz, uint8_t decimation,
+                            uint16_t fft_size, float lsb_per_g)
+{
+    if (!p || input_rate_hz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(p, 0, sizeof(*p));
+    esp_err_t ret = imu_decimator_init(&p->dec, decimation, lsb_per_g);
+    if (ret == ESP_OK) {
+        ret = imu_fft_init(&p->plan, fft_size);
+    }
+    p->rate_hz = (float)input_rate_hz / decimation;
+    return ret;
+}
+
+bool imu_pipeline_push(imu_pipeline_t *p, const imu_sample_t *sample, imu_features_t *out)
+{
+    float v[IMU_AXES];
+    if (!imu_decimator_push(&p->dec, sample, v)) {
+        return false;
+    }
+    for (int a = 0; a < IMU_AXES; a++) {
+        p->window[a][p->fill] = v[a];
+    }
+    if (++p->fill < p->plan.n) {
+        return false;
+    }
+    p->fill = 0;
+
+    memset(out, 0, sizeof(*out));
+    float sq = 0.0f;
+    float best_rms = -1.0f;
+    for (int a = 0; a < IMU_AXES; a++) {
+        imu_axis_features_t *f = &out->axis[a];
+        imu_features_axis(&p->plan, p->window[a], p->rate_hz, f, p->re, p->im);
+        sq += f->rms * f->rms;
+        if (f->peak > out->vector_peak) {
+            out->vector_peak = f->peak;
+        }
+        if (f->rms > best_rms) {
+            best_rms = f->rms;
+            out->dominant_hz = f->dominant_hz;
+        }
+    }
+    out->vector_rms = sqrtf(sq);
+    out->crest = out->vector_rms > 0.0f ? out->vector_peak / out->vector_rms : 0.0f;
+    out->rate_hz = p->rate_hz;
+    out->band_hz = p->rate_hz / 2.0f / CONFIG_IMU_STREAM_BANDS;
+    out->samples = p->plan.n;
+    out->seq = p->windows++;
+    return true;
+}
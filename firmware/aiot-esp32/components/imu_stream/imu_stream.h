@@ -0,0 +1,322 @@
+/**
+ * @file imu_stream.h
+ * @brief 加速度计高速采集：FIFO批量读取 -> 无锁环形缓冲 -> CIC/FIR抽取 -> 窗口特征（RMS/峰值/峰值因子/频带能量）
+ *
+ * 原有数据通路每10秒处理一个标量，振动监测需要1kHz的加速度数据。本组件：
+ *
+ * - MPU6050以1kHz采样写入片内FIFO（1024字节，约170个样本），按水位（默认50个样本）
+ *   通过I2C总线管理批量读出，放进单生产者/单消费者的无锁环形缓冲；
+ * - 处理任务从环形缓冲取样本，3阶CIC抽取（默认4倍，1kHz -> 250Hz），
+ *   再用3抽头FIR补偿CIC在通带内的下垂；
+ * - 每个窗口（默认256个抽取后样本，约1秒）加Hann窗做基2 FFT，
+ *   计算每轴的均值、RMS、峰值、峰值因子、等宽频带能量和主频；
+ * - 只上报特征，不上报原始样本。
+ *
+ * 环形缓冲、抽取、FFT和特征计算（imu_ring_* / imu_decimator_* / imu_fft_* / imu_pipeline_*）
+ * 是纯计算，可在主机上测试；MPU6050配置、FIFO读取和任务在 imu_stream_mpu6050.c 中。
+ */
+
+#ifndef IMU_STREAM_H
+#define IMU_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_IMU_STREAM_RATE_HZ
+#define CONFIG_IMU_STREAM_RATE_HZ           1000
+#endif
+
+#ifndef CONFIG_IMU_STREAM_DECIMATION
+#define CONFIG_IMU_STREAM_DECIMATION        4
+#endif
+
+#ifndef CONFIG_IMU_STREAM_FFT_SIZE
+#define CONFIG_IMU_STREAM_FFT_SIZE          256     ///< 窗口长度（抽取后样本数，2的幂）
+#endif
+
+#ifndef CONFIG_IMU_STREAM_BANDS
+#define CONFIG_IMU_STREAM_BANDS             8
+#endif
+
+#ifndef CONFIG_IMU_STREAM_RING_SAMPLES
+#define CONFIG_IMU_STREAM_RING_SAMPLES      512     ///< 2的幂
+#endif
+
+#ifndef CONFIG_IMU_STREAM_WATERMARK
+#define CONFIG_IMU_STREAM_WATERMARK         50      ///< 每次读取FIFO的目标样本数
+#endif
+
+#ifndef CONFIG_IMU_STREAM_DRAIN_CHUNK
+#define CONFIG_IMU_STREAM_DRAIN_CHUNK       16      ///< 单次I2C读取的样本数（限制占用总线的时长）
+#endif
+
+#ifndef CONFIG_IMU_STREAM_ACCEL_RANGE_G
+#define CONFIG_IMU_STREAM_ACCEL_RANGE_G     4
+#endif
+
+#ifndef CONFIG_IMU_STREAM_TASK_PRIORITY
+#define CONFIG_IMU_STREAM_TASK_PRIORITY     7       ///< FIFO读取任务；处理任务低一级
+#endif
+
+#define IMU_AXES                3
+#define IMU_CIC_ORDER           3
+
+/**
+ * @brief 原始样本（传感器LSB）
+ */
+typedef struct {
+    int16_t v[IMU_AXES];
+} imu_sample_t;
+
+/* ==================== 无锁环形缓冲 ==================== */
+
+/**
+ * @brief 单生产者/单消费者环形缓冲（生产者只写head，消费者只写tail）
+ */
+typedef struct {
+    imu_sample_t buf[CONFIG_IMU_STREAM_RING_SAMPLES];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t dropped;               ///< 缓冲满时丢弃的样本数（生产者计数）
+} imu_ring_t;
+
+void imu_ring_init(imu_ring_t *ring);
+
+/**
+ * @brief 写入样本（生产者调用），缓冲满时丢弃多出的样本
+ *
+ * @return 写入的样本数
+ */
+size_t imu_ring_push(imu_ring_t *ring, const imu_sample_t *samples, size_t count);
+
+/**
+ * @brief 取出样本（消费者调用）
+ *
+ * @return 取出的样本数
+ */
+size_t imu_ring_pop(imu_ring_t *ring, imu_sample_t *samples, size_t max);
+
+/**
+ * @brief 缓冲中的样本数
+ */
+size_t imu_ring_count(const imu_ring_t *ring);
+
+/* ==================== CIC + FIR 抽取 ==================== */
+
+/**
+ * @brief 三轴抽取器：3阶CIC（整数运算）+ 3抽头下垂补偿FIR
+ */
+typedef struct {
+    int32_t integ[IMU_AXES][IMU_CIC_ORDER];
+    int32_t comb[IMU_AXES][IMU_CIC_ORDER];
+    float hist[IMU_AXES][2];
+    uint8_t decimation;
+    uint8_t phase;
+    uint8_t settle;                 ///< 启动过渡期内丢弃的输出数
+    float scale;                    ///< LSB * R^N -> g
+    float fir_a;                    ///< FIR系数 [-a, 1+2a, -a]
+} imu_decimator_t;
+
+/**
+ * @brief 初始化抽取器
+ *
+ * FIR系数按CIC在输出频率1/4处的幅度响应计算，使该频点增益恢复为1；
+ * 默认4倍抽取时 0~fs_out/4 内总增益在1±3%以内，更高频率逐渐衰减。
+ *
+ * @param decimation 抽取倍数（1~16，1表示不抽取、不补偿）
+ * @param lsb_per_g 加速度计灵敏度
+ */
+esp_err_t imu_decimator_init(imu_decimator_t *dec, uint8_t decimation, float lsb_per_g);
+
+/**
+ * @brief 输入一个原始样本
+ *
+ * @param out 输出（g），每 decimation 个输入产生一个
+ * @return 产生输出时返回true
+ */
+bool imu_decimator_push(imu_decimator_t *dec, const imu_sample_t *sample, float out[IMU_AXES]);
+
+/**
+ * @brief CIC在频率 f（相对输入采样率）处的幅度响应
+ */
+float imu_cic_gain(uint8_t decimation, float f_norm);
+
+/* ==================== FFT ==================== */
+
+/**
+ * @brief 基2 FFT计划：位反转表、旋转因子表、Hann窗
+ *
+ * 实部和虚部分开存放（SoA），蝶形运算的内层循环连续访问、没有分支，
+ * 编译器可以向量化；旋转因子预先算好，运行时不调用三角函数。
+ */
+typedef struct {
+    uint16_t n;
+    uint8_t log2n;
+    uint16_t bitrev[CONFIG_IMU_STREAM_FFT_SIZE];
+    float cos_tab[CONFIG_IMU_STREAM_FFT_SIZE / 2];
+    float sin_tab[CONFIG_IMU_STREAM_FFT_SIZE / 2];
+    float window[CONFIG_IMU_STREAM_FFT_SIZE];
+    float window_power;             ///< sum(w^2)
+} imu_fft_plan_t;
+
+/**
+ * @brief 生成FFT计划
+ *
+ * @return ESP_OK 或 ESP_ERR_INVALID_ARG（n不是2的幂、小于8或超过 CONFIG_IMU_STREAM_FFT_SIZE）
+ */
+esp_err_t imu_fft_init(imu_fft_plan_t *plan, uint16_t n);
+
+/**
+ * @brief 原位复数FFT（按时间抽取）
+ */
+void imu_fft_run(const imu_fft_plan_t *plan, float *re, float *im);
+
+/* ==================== 窗口特征 ==================== */
+
+/**
+ * @brief 单轴特征
+ */
+typedef struct {
+    float mean;                     ///< 均值（g，重力分量）
+    float rms;                      ///< 去均值后的RMS（g）
+    float peak;                     ///< 去均值后的最大绝对值（g）
+    float crest;                    ///< 峰值因子 peak/rms
+    float dominant_hz;              ///< 能量最大的频点
+    float bands[CONFIG_IMU_STREAM_BANDS];   ///< 等宽频带能量（g²，各频带之和约等于rms²）
+} imu_axis_features_t;
+
+/**
+ * @brief 一个窗口的特征
+ */
+typedef struct {
+    imu_axis_features_t axis[IMU_AXES];
+    float vector_rms;               ///< 三轴RMS合成 sqrt(rx²+ry²+rz²)
+    float vector_peak;              ///< 三轴中最大的峰值
+    float crest;                    ///< vector_peak / vector_rms
+    float dominant_hz;              ///< 能量最大的轴的主频
+    float rate_hz;                  ///< 抽取后采样率
+    float band_hz;                  ///< 每个频带的宽度
+    uint16_t samples;               ///< 窗口样本数
+    uint32_t seq;                   ///< 窗口序号
+} imu_features_t;
+
+/**
+ * @brief 计算单轴特征
+ *
+ * @param x 窗口样本（plan->n 个）
+ * @param re/im 工作区（plan->n 个）
+ */
+void imu_features_axis(const imu_fft_plan_t *plan, const float *x, float rate_hz,
+                       imu_axis_features_t *out, float *re, float *im);
+
+/* ==================== 处理流水线 ==================== */
+
+/**
+ * @brief 抽取 + 窗口 + 特征
+ */
+typedef struct {
+    imu_decimator_t dec;
+    imu_fft_plan_t plan;
+    float window[IMU_AXES][CONFIG_IMU_STREAM_FFT_SIZE];
+    float re[CONFIG_IMU_STREAM_FFT_SIZE];
+    float im[CONFIG_IMU_STREAM_FFT_SIZE];
+    uint16_t fill;
+    float rate_hz;                  ///< 抽取后采样率
+    uint32_t windows;
+} imu_pipeline_t;
+
+/**
+ * @brief 初始化流水线
+ *
+ * @param input_rate_hz 原始采样率
+ * @param decimation 抽取倍数
+ * @param fft_size 窗口长度
+ * @param lsb_per_g 加速度计灵敏度
+ */
+esp_err_t imu_pipeline_init(imu_pipeline_t *p, uint32_t input_rate_hz, uint8_t decimation,
+                            uint16_t fft_size, float lsb_per_g);
+
+/**
+ * @brief 输入一个原始样本，窗口满时计算特征
+ *
+ * @return 本样本完成一个窗口时返回true（out已填写）
+ */
+bool imu_pipeline_push(imu_pipeline_t *p, const imu_sample_t *sample, imu_features_t *out);
+
+/* ==================== MPU6050运行时 ==================== */
+
+/**
+ * @brief 运行配置
+ */
+typedef struct {
+    gpio_num_t sda;
+    gpio_num_t scl;
+    gpio_num_t int_pin;             ///< FIFO溢出中断，GPIO_NUM_NC不使用
+    uint16_t addr;                  ///< I2C地址（0x68/0x69）
+    bool manual_service;            ///< 不创建任务，由调用者 imu_stream_service()（主机测试用）
+    /** 可选：每个窗口的特征（在处理任务中调用） */
+    void (*on_features)(const imu_features_t *features, void *arg);
+    void *arg;
+} imu_stream_config_t;
+
+/**
+ * @brief 运行统计
+ */
+typedef struct {
+    uint32_t drains;                ///< FIFO读取次数
+    uint32_t samples;               ///< 读出的样本数
+    uint32_t fifo_overflows;        ///< FIFO溢出（复位FIFO）次数
+    uint32_t ring_dropped;          ///< 环形缓冲满丢弃的样本数
+    uint32_t windows;               ///< 完成的窗口数
+    uint32_t window_us_max;         ///< 单个窗口特征计算的最长耗时
+    uint32_t i2c_errors;
+} imu_stream_stats_t;
+
+/**
+ * @brief 配置MPU6050（1kHz、加速度FIFO、溢出中断）并启动读取和处理任务
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_STATE: 已经启动
+ *   - ESP_ERR_NOT_FOUND: WHO_AM_I 不匹配
+ *   - 其他: I2C错误
+ */
+esp_err_t imu_stream_start(const imu_stream_config_t *config);
+
+/**
+ * @brief 停止（主机测试用；任务模式下任务在下一轮退出）
+ */
+void imu_stream_stop(void);
+
+/**
+ * @brief 读取一次FIFO并处理环形缓冲中的样本（manual_service 时由调用者调用）
+ *
+ * @return 本次完成的窗口数
+ */
+size_t imu_stream_service(void);
+
+/**
+ * @brief 获取上次调用以来振动最强的窗口（vector_rms最大）
+ *
+ * @param reset 读取后清空，下一个周期重新比较
+ * @return ESP_OK，或 ESP_ERR_INVALID_STATE（期间没有完成的窗口）
+ */
+esp_err_t imu_stream_take_summary(imu_features_t *out, bool reset);
+
+/**
+ * @brief 获取运行统计
+ */
+esp_err_t imu_stream_get_stats(imu_stream_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IMU_STREAM_H
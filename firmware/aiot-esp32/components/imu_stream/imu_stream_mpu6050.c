@@ -0,0 +1,437 @@
+/**
+ * @file imu_stream_mpu6050.c
+ * @brief 加速度计采集运行时：MPU6050 FIFO配置、批量读取任务、特征处理任务
+ *
+ * MPU6050没有可编程的FIFO水位中断（INT只有 DATA_RDY / FIFO_OFLOW 等），
+ * 因此读取任务按水位周期（水位样本数 / 采样率）定时唤醒，INT引脚配置为FIFO溢出中断，
+ * 溢出时立即唤醒读取任务。每次先读 FIFO_COUNT，再按 CONFIG_IMU_STREAM_DRAIN_CHUNK
+ * 分段读 FIFO_R_W，分段之间其他设备的请求可以插入，总线不会被一次长读占住。
+ *
+ * 读取任务是环形缓冲唯一的生产者，处理任务是唯一的消费者，两者之间不加锁；
+ * 处理任务每完成一个窗口，更新振动最强窗口的快照（加锁）并调用 on_features。
+ */
+
+#include "imu_stream.h"
+#include <string.h>
+#include "i2c_bus.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "metrics.h"
+
+static const char *TAG = "imu_stream";
+
+#define LOCK()      xSemaphoreTake(s_mutex, portMAX_DELAY)
+#define UNLOCK()    xSemaphoreGive(s_mutex)
+
+#define MPU6050_REG_SMPLRT_DIV      0x19
+#define MPU6050_REG_CONFIG          0x1A
+#define MPU6050_REG_ACCEL_CONFIG    0x1C
+#define MPU6050_REG_FIFO_EN         0x23
+#define MPU6050_REG_INT_PIN_CFG     0x37
+#define MPU6050_REG_INT_ENABLE      0x38
+#define MPU6050_REG_USER_CTRL       0x6A
+#define MPU6050_REG_PWR_MGMT_1      0x6B
+#define MPU6050_REG_FIFO_COUNT_H    0x72
+#define MPU6050_REG_FIFO_R_W        0x74
+#define MPU6050_REG_WHO_AM_I        0x75
+
+#define MPU6050_WHO_AM_I            0x68
+#define MPU6050_FIFO_SIZE           1024
+#define MPU6050_FIFO_ACCEL          0x08        ///< FIFO_EN: 加速度计三轴
+#define MPU6050_USER_FIFO_EN        0x40
+#define MPU6050_USER_FIFO_RESET     0x04
+#define MPU6050_INT_FIFO_OFLOW      0x10
+#define MPU6050_DLPF_184HZ          1           ///< 加速度计带宽184Hz，内部采样1kHz
+#define MPU6050_SCL_HZ              400000
+
+#define SAMPLE_BYTES                (IMU_AXES * 2)
+#define PROCESS_BATCH               64
+
+static SemaphoreHandle_t s_mutex = NULL;
+
+static struct {
+    bool running;
+    imu_stream_config_t config;
+    i2c_bus_device_handle_t dev;
+    TaskHandle_t drain_task;
+    TaskHandle_t dsp_task;
+    imu_ring_t ring;                                ///< 读取任务写，处理任务读
+    imu_pipeline_t pipeline;                        ///< 只由处理任务使用
+    uint8_t fifo_buf[CONFIG_IMU_STREAM_DRAIN_CHUNK * SAMPLE_BYTES];
+    imu_sample_t chunk[CONFIG_IMU_STREAM_DRAIN_CHUNK];
+    imu_sample_t batch[PROCESS_BATCH];
+    imu_features_t summary;                         ///< 本周期振动最强的窗口
+    bool has_summary;
+    imu_stream_stats_t stats;
+} s_imu;
+
+METRIC_HISTOGRAM_DEFINE(s_m_window_us, "imu_window_us", 500, 1000, 2000, 5000, 10000, 20000);
+METRIC_COUNTER_DEFINE(s_m_overflows, "imu_fifo_overflows");
+METRIC_COUNTER_DEFINE(s_m_dropped, "imu_ring_dropped");
+
+static float lsb_per_g(void)
+{
+    return 32768.0f / CONFIG_IMU_STREAM_ACCEL_RANGE_G;
+}
+
+static uint8_t accel_fs_sel(void)
+{
+    switch (CONFIG_IMU_STREAM_ACCEL_RANGE_G) {
+    case 2:  return 0;
+    case 4:  return 1;
+    case 8:  return 2;
+    default: return 3;
+    }
+}
+
+/* ==================== FIFO读取 ==================== */
+
+static esp_err_t reset_fifo(void)
+{
+    return i2c_bus_write_reg(s_imu.dev, MPU6050_REG_USER_CTRL, MPU6050_USER_FIFO_EN | MPU6050_USER_FIFO_RESET,
+                             I2C_BUS_PRIO_SENSOR);
+}
+
+static void count_error(void)
+{
+    LOCK();
+    s_imu.stats.i2c_errors++;
+    UNLOCK();
+}
+
+/**
+ * @brief 读出FIFO中的全部完整样本放入环形缓冲
+ *
+ * @return 读出的样本数
+ */
+static size_t drain_fifo(void)
+{
+    uint8_t count_buf[2];
+    esp_err_t ret = i2c_bus_read_reg(s_imu.dev, MPU6050_REG_FIFO_COUNT_H, count_buf, sizeof(count_buf),
+                                     I2C_BUS_PRIO_SENSOR);
+    if (ret != ESP_OK) {
+        count_error();
+        return 0;
+    }
+    size_t bytes = ((size_t)count_buf[0] << 8) | count_buf[1];
+    if (bytes >= MPU6050_FIFO_SIZE) {
+        // 溢出后FIFO丢弃最旧的字节，样本边界已经错位，只能复位
+        if (reset_fifo() != ESP_OK) {
+            count_error();
+        }
+        metric_inc(&s_m_overflows);
+        LOCK();
+        s_imu.stats.fifo_overflows++;
+        UNLOCK();
+        ESP_LOGW(TAG, "⚠️ MPU6050 FIFO溢出，已复位");
+        return 0;
+    }
+
+    size_t total = bytes / SAMPLE_BYTES;
+    size_t done = 0;
+    uint32_t dropped = 0;
+    while (done < total) {
+        size_t n = total - done;
+        if (n > CONFIG_IMU_STREAM_DRAIN_CHUNK) {
+            n = CONFIG_IMU_STREAM_DRAIN_CHUNK;
+        }
+        ret = i2c_bus_read_fifo(s_imu.dev, MPU6050_REG_FIFO_R_W, s_imu.fifo_buf, n * SAMPLE_BYTES,
+                                I2C_BUS_PRIO_SENSOR);
+        if (ret != ESP_OK) {
+            count_error();
+            break;
+        }
+        for (size_t i = 0; i < n; i++) {
+            const uint8_t *p = &s_imu.fifo_buf[i * SAMPLE_BYTES];
+            for (int a = 0; a < IMU_AXES; a++) {
+                s_imu.chunk[i].v[a] = (int16_t)(((uint16_t)p[2 * a] << 8) | p[2 * a + 1]);
+            }
+        }
+        dropped += (uint32_t)(n - imu_ring_push(&s_imu.ring, s_imu.chunk, n));
+        done += n;
+    }
+
+    if (dropped > 0) {
+        metric_add(&s_m_dropped, dropped);
+    }
+    LOCK();
+    s_imu.stats.drains++;
+    s_imu.stats.samples += (uint32_t)done;
+    s_imu.stats.ring_dropped += dropped;
+    UNLOCK();
+    return done;
+}
+
+/* ==================== 处理 ==================== */
+
+static void publish(const imu_features_t *features, uint32_t elapsed_us)
+{
+    metric_observe(&s_m_window_us, elapsed_us);
+    LOCK();
+    s_imu.stats.windows++;
+    if (elapsed_us > s_imu.stats.window_us_max) {
+        s_imu.stats.window_us_max = elapsed_us;
+    }
+    if (!s_imu.has_summary || features->vector_rms >= s_imu.summary.vector_rms) {
+        s_imu.summary = *features;
+        s_imu.has_summary = true;
+    }
+    UNLOCK();
+
+    if (s_imu.config.on_features) {
+        s_imu.config.on_features(features, s_imu.config.arg);
+    }
+}
+
+/**
+ * @brief 处理环形缓冲中的全部样本
+ *
+ * @return 完成的窗口数
+ */
+static size_t process_ring(void)
+{
+    size_t windows = 0;
+    size_t n;
+    imu_features_t features;
+    while ((n = imu_ring_pop(&s_imu.ring, s_imu.batch, PROCESS_BATCH)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            int64_t start_us = esp_timer_get_time();
+            if (imu_pipeline_push(&s_imu.pipeline, &s_imu.batch[i], &features)) {
+                publish(&features, (uint32_t)(esp_timer_get_time() - start_us));
+                windows++;
+            }
+        }
+    }
+    return windows;
+}
+
+/* ==================== 任务 ==================== */
+
+static void IRAM_ATTR int_isr(void *arg)
+{
+    (void)arg;
+    BaseType_t woken = pdFALSE;
+    if (s_imu.drain_task) {
+        vTaskNotifyGiveFromISR(s_imu.drain_task, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+static void drain_task(void *arg)
+{
+    (void)arg;
+    const TickType_t period = pdMS_TO_TICKS(CONFIG_IMU_STREAM_WATERMARK * 1000 / CONFIG_IMU_STREAM_RATE_HZ);
+    while (s_imu.running) {
+        ulTaskNotifyTake(pdTRUE, period > 0 ? period : 1);
+        if (drain_fifo() > 0) {
+            xTaskNotifyGive(s_imu.dsp_task);
+        }
+    }
+    s_imu.drain_task = NULL;
+    vTaskDelete(NULL);
+}
+
+static void dsp_task(void *arg)
+{
+    (void)arg;
+    while (s_imu.running) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        process_ring();
+    }
+    s_imu.dsp_task = NULL;
+    vTaskDelete(NULL);
+}
+
+/* ==================== 启动 ==================== */
+
+static esp_err_t configure_sensor(void)
+{
+    uint8_t who = 0;
+    esp_err_t ret = i2c_bus_read_reg(s_imu.dev, MPU6050_REG_WHO_AM_I, &who, 1, I2C_BUS_PRIO_NORMAL);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (who != MPU6050_WHO_AM_I) {
+        ESP_LOGE(TAG, "❌ WHO_AM_I=0x%02X，不是MPU6050", who);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    const uint8_t writes[][2] = {
+        { MPU6050_REG_PWR_MGMT_1, 0x01 },                                   // 退出睡眠，时钟取陀螺仪X轴PLL
+        { MPU6050_REG_CONFIG, MPU6050_DLPF_184HZ },
+        { MPU6050_REG_SMPLRT_DIV, (uint8_t)(1000 / CONFIG_IMU_STREAM_RATE_HZ - 1) },
+        { MPU6050_REG_ACCEL_CONFIG, (uint8_t)(accel_fs_sel() << 3) },
+        { MPU6050_REG_FIFO_EN, MPU6050_FIFO_ACCEL },
+        { MPU6050_REG_INT_PIN_CFG, 0x00 },                                  // 高电平脉冲
+        { MPU6050_REG_INT_ENABLE, MPU6050_INT_FIFO_OFLOW },
+        { MPU6050_REG_USER_CTRL, MPU6050_USER_FIFO_EN | MPU6050_USER_FIFO_RESET },
+    };
+    for (size_t i = 0; i < sizeof(writes) / sizeof(writes[0]); i++) {
+        ret = i2c_bus_write_reg(s_imu.dev, writes[i][0], writes[i][1], I2C_BUS_PRIO_NORMAL);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t attach_int_pin(gpio_num_t pin)
+{
+    gpio_config_t io_conf = {
+        .intr_type = GPIO_INTR_POSEDGE,
+        .mode = GPIO_MODE_INPUT,
+        .pin_bit_mask = (1ULL << pin),
+        .pull_down_en = GPIO_PULLDOWN_ENABLE,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+    };
+    esp_err_t ret = gpio_config(&io_conf);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        return ret;
+    }
+    return gpio_isr_handler_add(pin, int_isr, NULL);
+}
+
+esp_err_t imu_stream_start(const imu_stream_config_t *config)
+{
+    if (!config || config->addr > 0x7F || CONFIG_IMU_STREAM_RATE_HZ > 1000 || CONFIG_IMU_STREAM_RATE_HZ == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (s_imu.running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memset(&s_imu, 0, sizeof(s_imu));
+    s_imu.config = *config;
+    imu_ring_init(&s_imu.ring);
+    esp_err_t ret = imu_pipeline_init(&s_imu.pipeline, CONFIG_IMU_STREAM_RATE_HZ, CONFIG_IMU_STREAM_DECIMATION,
+                                      CONFIG_IMU_STREAM_FFT_SIZE, lsb_per_g());
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    i2c_bus_config_t bus_config = {
+        .port = -1,
+        .sda = config->sda,
+        .scl = config->scl,
+        .internal_pullup = false,
+        .manual_service = config->manual_service,
+    };
+    i2c_bus_handle_t bus;
+    ret = i2c_bus_open(&bus_config, &bus);
+    if (ret == ESP_OK) {
+        i2c_bus_device_config_t dev_config = {
+            .addr = config->addr,
+            .scl_hz = MPU6050_SCL_HZ,
+            .name = "MPU6050",
+            .burst_read = true,
+        };
+        ret = i2c_bus_add_device(bus, &dev_config, &s_imu.dev);
+    }
+    if (ret == ESP_OK) {
+        ret = configure_sensor();
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "❌ MPU6050初始化失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    s_imu.running = true;
+    if (!config->manual_service) {
+        if (xTaskCreate(dsp_task, "imu_dsp", 4096, NULL, CONFIG_IMU_STREAM_TASK_PRIORITY - 1,
+                        &s_imu.dsp_task) != pdPASS ||
+            xTaskCreate(drain_task, "imu_drain", 3072, NULL, CONFIG_IMU_STREAM_TASK_PRIORITY,
+                        &s_imu.drain_task) != pdPASS) {
+            s_imu.running = false;
+            if (s_imu.dsp_task) {
+                xTaskNotifyGive(s_imu.dsp_task);
+            }
+            return ESP_ERR_NO_MEM;
+        }
+        if (config->int_pin != GPIO_NUM_NC) {
+            ret = attach_int_pin(config->int_pin);
+            if (ret != ESP_OK) {
+                ESP_LOGW(TAG, "⚠️ INT引脚GPIO%d配置失败，仅按周期读取: %s", config->int_pin, esp_err_to_name(ret));
+            }
+        }
+    }
+
+    ESP_LOGI(TAG, "✅ MPU6050 FIFO采集: %d Hz, ±%dg, 抽取%d, 窗口%d点 (%.2f s)",
+             CONFIG_IMU_STREAM_RATE_HZ, CONFIG_IMU_STREAM_ACCEL_RANGE_G, CONFIG_IMU_STREAM_DECIMATION,
+             CONFIG_IMU_STREAM_FFT_SIZE, CONFIG_IMU_STREAM_FFT_SIZE / s_imu.pipeline.rate_hz);
+    return ESP_OK;
+}
+
+void imu_stream_stop(void)
+{
+    if (!s_imu.running) {
+        return;
+    }
+    s_imu.running = false;
+    if (s_imu.config.int_pin != GPIO_NUM_NC && !s_imu.config.manual_service) {
+        gpio_isr_handler_remove(s_imu.config.int_pin);
+    }
+    if (s_imu.dsp_task) {
+        xTaskNotifyGive(s_imu.dsp_task);
+    }
+    if (s_imu.drain_task) {
+        xTaskNotifyGive(s_imu.drain_task);
+    }
+}
+
+size_t imu_stream_service(void)
+{
+    if (!s_imu.running || !s_imu.config.manual_service) {
+        return 0;
+    }
+    drain_fifo();
+    return process_ring();
+}
+
+esp_err_t imu_stream_take_summary(imu_features_t *out, bool reset)
+{
+    if (!out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    LOCK();
+    bool has = s_imu.has_summary;
+    if (has) {
+        *out = s_imu.summary;
+        if (reset) {
+            s_imu.has_summary = false;
+        }
+    }
+    UNLOCK();
+    return has ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t imu_stream_get_stats(imu_stream_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mutex) {
+        memset(stats, 0, sizeof(*stats));
+        return ESP_OK;
+    }
+    LOCK();
+    *stats = s_imu.stats;
+    UNLOCK();
+    return ESP_OK;
+}
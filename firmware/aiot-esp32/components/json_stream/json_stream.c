@@ -0,0 +1,473 @@
+/**
+ * @file json_stream.c
+ * @brief 增量JSON解析实现
+ *
+ * 逐字节状态机，跨块的状态（字符串、转义、数字中间）都保存在json_stream_t中。
+ * 路径按层记录长度：进入容器时记下当前路径长度，读到新键时截回该长度再追加，
+ * 数组元素统一使用"[]"后缀，不记录下标。
+ */
+
+#include "json_stream.h"
+#include <stdlib.h>
+#include <string.h>
+
+enum {
+    ST_VALUE = 0,                  ///< 等待值（数组中刚读到'['时也接受']'）
+    ST_KEY,                        ///< 等待键（刚读到'{'时也接受'}'）
+    ST_COLON,                      ///< 等待':'
+    ST_COMMA,                      ///< 等待','或容器结束
+    ST_STRING,                     ///< 字符串中
+    ST_ESCAPE,                     ///< '\'之后
+    ST_UNICODE,                    ///< \uXXXX 中
+    ST_LITERAL,                    ///< 数字/true/false/null中
+    ST_DONE,                       ///< 顶层值已结束，只允许空白
+    ST_ERROR,                      ///< 语法错误
+    ST_TOO_DEEP,                   ///< 嵌套过深
+};
+
+void json_stream_init(json_stream_t *js, json_stream_cb_t cb, void *ctx)
+{
+    memset(js, 0, sizeof(*js));
+    js->cb = cb;
+    js->ctx = ctx;
+    js->state = ST_VALUE;
+}
+
+uint32_t json_stream_error_offset(const json_stream_t *js)
+{
+    return js->offset;
+}
+
+bool json_stream_truncated(const json_stream_t *js)
+{
+    return js->truncated;
+}
+
+static void value_put(json_stream_t *js, char c)
+{
+    if (js->value_len < JSON_STREAM_MAX_VALUE - 1) {
+        js->value[js->value_len++] = c;
+    } else {
+        js->truncated = true;
+    }
+}
+
+static void value_put_utf8(json_stream_t *js, uint32_t cp)
+{
+    if (cp == 0) {
+        value_put(js, '?');
+    } else if (cp < 0x80) {
+        value_put(js, (char)cp);
+    } else if (cp < 0x800) {
+        value_put(js, (char)(0xC0 | (cp >> 6)));
+        value_put(js, (char)(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        value_put(js, (char)(0xE0 | (cp >> 12)));
+        value_put(js, (char)(0x80 | ((cp >> 6) & 0x3F)));
+        value_put(js, (char)(0x80 | (cp & 0x3F)));
+    } else {
+        value_put(js, (char)(0xF0 | (cp >> 18)));
+        value_put(js, (char)(0x80 | ((cp >> 12) & 0x3F)));
+        value_put(js, (char)(0x80 | ((cp >> 6) & 0x3F)));
+        value_put(js, (char)(0x80 | (cp & 0x3F)));
+    }
+}
+
+/**
+ * @brief 未配对的高位代理输出为'?'
+ */
+static void flush_surrogate(json_stream_t *js)
+{
+    if (js->u_high) {
+        value_put(js, '?');
+        js->u_high = 0;
+    }
+}
+
+static void path_append(json_stream_t *js, const char *s)
+{
+    size_t len = strlen(js->path);
+    size_t n = strlen(s);
+    if (len + n >= JSON_STREAM_MAX_PATH) {
+        n = JSON_STREAM_MAX_PATH - 1 - len;
+        js->truncated = true;
+    }
+    memcpy(js->path + len, s, n);
+    js->path[len + n] = '\0';
+}
+
+static void emit(json_stream_t *js, json_stream_type_t type, const char *value)
+{
+    // 数组元素的路径是数组路径本身（含"[]"）
+    if (js->depth > 0 && js->is_array[js->depth]) {
+        js->path[js->base[js->depth]] = '\0';
+    }
+    if (js->cb) {
+        js->cb(js->ctx, js->path, type, value);
+    }
+}
+
+static void after_value(json_stream_t *js)
+{
+    js->after_open = false;
+    js->state = js->depth == 0 ? ST_DONE : ST_COMMA;
+}
+
+static void open_container(json_stream_t *js, bool array)
+{
+    emit(js, array ? JSON_STREAM_ARRAY : JSON_STREAM_OBJECT, NULL);
+    if (js->depth >= JSON_STREAM_MAX_DEPTH) {
+        js->state = ST_TOO_DEEP;
+        return;
+    }
+    js->depth++;
+    if (array) {
+        path_append(js, "[]");
+    }
+    js->base[js->depth] = (uint16_t)strlen(js->path);
+    js->is_array[js->depth] = array;
+    js->after_open = true;
+    js->state = array ? ST_VALUE : ST_KEY;
+}
+
+static void close_container(json_stream_t *js)
+{
+    js->depth--;
+    after_value(js);
+}
+
+static void end_string(json_stream_t *js)
+{
+    flush_surrogate(js);
+    js->value[js->value_len] = '\0';
+    if (js->in_key) {
+        js->path[js->base[js->depth]] = '\0';
+        if (js->base[js->depth] > 0) {
+            path_append(js, ".");
+        }
+        path_append(js, js->value);
+        js->state = ST_COLON;
+    } else {
+        emit(js, JSON_STREAM_STRING, js->value);
+        after_value(js);
+    }
+}
+
+static bool end_literal(json_stream_t *js)
+{
+    js->value[js->value_len] = '\0';
+    const char *v = js->value;
+    json_stream_type_t type;
+
+    if (strcmp(v, "true") == 0 || strcmp(v, "false") == 0) {
+        type = JSON_STREAM_BOOL;
+    } else if (strcmp(v, "null") == 0) {
+        type = JSON_STREAM_NULL;
+    } else {
+        // strtod还接受inf/nan/十六进制，先按JSON数字的首字符和字符集排除
+        char *end = NULL;
+        if (!(v[0] == '-' || (v[0] >= '0' && v[0] <= '9')) || strpbrk(v, "xXiInN")) {
+            return false;
+        }
+        strtod(v, &end);
+        if (!end || *end != '\0') {
+            return false;
+        }
+        type = JSON_STREAM_NUMBER;
+    }
+    emit(js, type, v);
+    after_value(js);
+    return true;
+}
+
+static bool is_literal_char(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           c == '.' || c == '+' || c == '-';
+}
+
+static bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static void start_string(json_stream_t *js, bool key)
+{
+    js->in_key = key;
+    js->value_len = 0;
+    js->u_high = 0;
+    js->state = ST_STRING;
+}
+
+/**
+ * @brief 处理一个字符
+ *
+ * @return true 字符已消费；false 需要在新状态下重新处理（数字结束于非数字字符）
+ */
+static bool step(json_stream_t *js, char c)
+{
+    switch (js->state) {
+    case ST_VALUE:
+        if (is_space(c)) {
+            return true;
+        }
+        if (c == '{' || c == '[') {
+            open_container(js, c == '[');
+        } else if (c == '"') {
+            start_string(js, false);
+        } else if (c == ']' && js->after_open && js->is_array[js->depth]) {
+            close_container(js);
+        } else if (c == '-' || (c >= '0' && c <= '9') || c == 't' || c == 'f' || c == 'n') {
+            js->value_len = 0;
+            value_put(js, c);
+            js->state = ST_LITERAL;
+        } else {
+            js->state = ST_ERROR;
+        }
+        return true;
+
+    case ST_KEY:
+        if (is_space(c)) {
+            return true;
+        }
+        if (c == '"') {
+            start_string(js, true);
+        } else if (c == '}' && js->after_open) {
+            close_container(js);
+        } else {
+            js->state = ST_ERROR;
+        }
+        return true;
+
+    case ST_COLON:
+        if (is_space(c)) {
+            return true;
+        }
+        js->state = c == ':' ? ST_VALUE : ST_ERROR;
+        js->after_open = false;
+        return true;
+
+    case ST_COMMA:
+        if (is_space(c)) {
+            return true;
+        }
+        if (c == ',') {
+            js->state = js->is_array[js->depth] ? ST_VALUE : ST_KEY;
+        } else if (c == (js->is_array[js->depth] ? ']' : '}')) {
+            close_container(js);
+        } else {
+            js->state = ST_ERROR;
+        }
+        return true;
+
+    case ST_STRING:
+        if (c == '"') {
+            end_string(js);
+        } else if (c == '\\') {
+            js->state = ST_ESCAPE;
+        } else if ((unsigned char)c < 0x20) {
+            js->state = ST_ERROR;
+        } else {
+            flush_surrogate(js);
+            value_put(js, c);
+        }
+        return true;
+
+    case ST_ESCAPE: {
+        static const char from[] = "\"\\/bfnrt";
+        static const char to[] = "\"\\/\b\f\n\r\t";
+        const char *p = c ? strchr(from, c) : NULL;
+        if (c == 'u') {
+            js->u_count = 0;
+            js->u_value = 0;
+            js->state = ST_UNICODE;
+        } else if (p) {
+            flush_surrogate(js);
+            value_put(js, to[p - from]);
+            js->state = ST_STRING;
+        } else {
+            js->state = ST_ERROR;
+        }
+        return true;
+    }
+
+    case ST_UNICODE: {
+        int h = hex_value(c);
+        if (h < 0) {
+            js->state = ST_ERROR;
+            return true;
+        }
+        js->u_value = (uint16_t)((js->u_value << 4) | h);
+        if (++js->u_count < 4) {
+            return true;
+        }
+        uint16_t u = js->u_value;
+        if (u >= 0xD800 && u <= 0xDBFF) {
+            flush_surrogate(js);
+            js->u_high = u;
+        } else if (u >= 0xDC00 && u <= 0xDFFF) {
+            if (js->u_high) {
+                value_put_utf8(js, 0x10000 + (((uint32_t)js->u_high - 0xD800) << 10) + (u - 0xDC00));
+                js->u_high = 0;
+            } else {
+                value_put(js, '?');
+            }
+        } else {
+            flush_surrogate(js);
+            value_put_utf8(js, u);
+        }
+        js->state = ST_STRING;
+        return true;
+    }
+
+    case ST_LITERAL:
+        if (is_literal_char(c)) {
+            value_put(js, c);
+            return true;
+        }
+        if (!end_literal(js)) {
+            js->state = ST_ERROR;
+            return true;
+        }
+        return false;
+
+    case ST_DONE:
+        if (!is_space(c)) {
+            js->state = ST_ERROR;
+        }
+        return true;
+
+    default:
+        return true;
+    }
+}
+
+static esp_err_t state_error(const json_stream_t *js)
+{
+    if (js->state == ST_ERROR) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    if (js->state == ST_TOO_DEEP) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    return ESP_OK;
+}
+
+esp_err_t json_stream_feed(json_stream_t *js, const char *data, size_t len)
+{
+    if (!js || (!data && len)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (state_error(js) != ESP_OK) {
+            return state_error(js);
+        }
+        if (!step(js, data[i])) {
+            step(js, data[i]);
+        }
+        if (state_error(js) != ESP_OK) {
+            return state_error(js);
+        }
+        js->offset++;
+    }
+    return ESP_OK;
+}
+
+esp_err_t json_stream_finish(json_stream_t *js)
+{
+    if (!js) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // 顶层为数字时没有后续字符来结束它
+    if (js->state == ST_LITERAL && js->depth == 0 && !end_literal(js)) {
+        js->state = ST_ERROR;
+    }
+    esp_err_t err = state_error(js);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return js->state == ST_DONE ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+/* ==================== 字段表绑定 ==================== */
+
+void json_stream_init_bind(json_stream_t *js, json_stream_bind_t *bind,
+                           const json_field_t *fields, size_t count, void *out)
+{
+    bind->fields = fields;
+    bind->count = count;
+    bind->out = out;
+    bind->matched = 0;
+    json_stream_init(js, json_stream_bind_cb, bind);
+}
+
+void json_stream_bind_cb(void *ctx, const char *path, json_stream_type_t type, const char *value)
+{
+    json_stream_bind_t *bind = (json_stream_bind_t *)ctx;
+
+    for (size_t i = 0; i < bind->count; i++) {
+        const json_field_t *f = &bind->fields[i];
+        if (strcmp(f->path, path) != 0) {
+            continue;
+        }
+
+        uint8_t *dst = (uint8_t *)bind->out + f->offset;
+        bool ok = false;
+        switch (f->type) {
+        case JSON_FIELD_STRING:
+            if (type == JSON_STREAM_STRING && f->size > 0) {
+                size_t n = strlen(value);
+                if (n >= f->size) {
+                    n = f->size - 1;
+                }
+                memcpy(dst, value, n);
+                dst[n] = '\0';
+                ok = true;
+            }
+            break;
+        case JSON_FIELD_INT:
+            if (type == JSON_STREAM_NUMBER && f->size == sizeof(int)) {
+                double d = strtod(value, NULL);
+                int v = d > 2147483647.0 ? 2147483647 : d < -2147483648.0 ? (-2147483647 - 1) : (int)d;
+                memcpy(dst, &v, sizeof(v));
+                ok = true;
+            }
+            break;
+        case JSON_FIELD_UINT32:
+            if (type == JSON_STREAM_NUMBER && f->size == sizeof(uint32_t) && value[0] != '-') {
+                double d = strtod(value, NULL);
+                uint32_t v = d > 4294967295.0 ? UINT32_MAX : (uint32_t)d;
+                memcpy(dst, &v, sizeof(v));
+                ok = true;
+            }
+            break;
+        case JSON_FIELD_BOOL:
+            if (type == JSON_STREAM_BOOL && f->size == sizeof(bool)) {
+                bool v = value[0] == 't';
+                memcpy(dst, &v, sizeof(v));
+                ok = true;
+            }
+            break;
+        case JSON_FIELD_PRESENT:
+            if (type == JSON_STREAM_OBJECT && f->size == sizeof(bool)) {
+                bool v = true;
+                memcpy(dst, &v, sizeof(v));
+                ok = true;
+            }
+            break;
+        default:
+            break;
+        }
+        if (ok && i < 32) {
+            bind->matched |= 1UL << i;
+        }
+    }
+}
@@ -0,0 +1,177 @@
+/**
+ * @file json_stream.h
+ * @brief 增量（SAX式）JSON解析：逐块输入HTTP响应体，直接填充结构体
+ *
+ * 不构建DOM、不缓存整个响应：解析器只保存当前路径、当前标量值和嵌套栈，
+ * 占用内存固定（sizeof(json_stream_t)，默认约700字节），与响应大小无关，
+ * 数据可以在任意字节处分块（包括字符串、转义序列、数字中间）。
+ *
+ * 每解析出一个标量值（字符串/数字/true/false/null）或容器开始，回调一次：
+ *   path 为从根开始用'.'连接的键名，数组元素用"[]"表示，如
+ *   {"mqtt_config":{"topics":{"data":"x"}},"list":[1,2]}
+ *   依次得到 mqtt_config(对象)、mqtt_config.topics(对象)、mqtt_config.topics.data="x"、
+ *   list(数组)、list[]=1、list[]=2
+ *
+ * 常用方式是字段表绑定（json_stream_bind_t）：按路径把值写入结构体成员，
+ * 超长字符串截断到成员大小，类型不符的值忽略。
+ */
+
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_JSON_STREAM_MAX_DEPTH
+#define CONFIG_JSON_STREAM_MAX_DEPTH    8
+#endif
+
+#ifndef CONFIG_JSON_STREAM_MAX_PATH
+#define CONFIG_JSON_STREAM_MAX_PATH     96
+#endif
+
+#ifndef CONFIG_JSON_STREAM_MAX_VALUE
+#define CONFIG_JSON_STREAM_MAX_VALUE    520
+#endif
+
+#define JSON_STREAM_MAX_DEPTH   CONFIG_JSON_STREAM_MAX_DEPTH    ///< 最大嵌套层数
+#define JSON_STREAM_MAX_PATH    CONFIG_JSON_STREAM_MAX_PATH     ///< 路径缓冲区（含'\0'）
+#define JSON_STREAM_MAX_VALUE   CONFIG_JSON_STREAM_MAX_VALUE    ///< 单个值缓冲区（含'\0'），超出截断
+
+/**
+ * @brief 值类型
+ */
+typedef enum {
+    JSON_STREAM_STRING = 0,
+    JSON_STREAM_NUMBER,            ///< value为数字原文
+    JSON_STREAM_BOOL,              ///< value为"true"/"false"
+    JSON_STREAM_NULL,
+    JSON_STREAM_OBJECT,            ///< 对象开始，value为NULL
+    JSON_STREAM_ARRAY,             ///< 数组开始，value为NULL
+} json_stream_type_t;
+
+/**
+ * @brief 值回调
+ *
+ * @param ctx 用户参数
+ * @param path 值的路径（回调返回后失效）
+ * @param type 值类型
+ * @param value 值文本（字符串已去掉转义，回调返回后失效）
+ */
+typedef void (*json_stream_cb_t)(void *ctx, const char *path, json_stream_type_t type, const char *value);
+
+/**
+ * @brief 解析器状态（调用方分配，成员不要直接访问）
+ */
+typedef struct {
+    json_stream_cb_t cb;
+    void *ctx;
+    uint8_t state;
+    uint8_t depth;
+    uint8_t u_count;               ///< \uXXXX 已读的十六进制位数
+    bool in_key;                   ///< 当前字符串是键
+    bool after_open;               ///< 刚读到'{'或'['（允许空容器）
+    bool truncated;                ///< 有值或路径被截断
+    uint16_t u_value;              ///< \uXXXX 的值
+    uint16_t u_high;               ///< 待配对的高位代理
+    uint16_t value_len;
+    uint16_t base[JSON_STREAM_MAX_DEPTH + 1];  ///< 各层容器路径长度
+    uint8_t is_array[JSON_STREAM_MAX_DEPTH + 1];
+    uint32_t offset;               ///< 已处理字节数（出错位置）
+    char path[JSON_STREAM_MAX_PATH];
+    char value[JSON_STREAM_MAX_VALUE];
+} json_stream_t;
+
+/**
+ * @brief 初始化（可用于复位已有的解析器）
+ */
+void json_stream_init(json_stream_t *js, json_stream_cb_t cb, void *ctx);
+
+/**
+ * @brief 输入一块数据
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功（文档可能尚未结束）
+ *   - ESP_ERR_INVALID_RESPONSE: 语法错误（位置见 json_stream_error_offset()），之后的输入都返回该错误
+ *   - ESP_ERR_INVALID_SIZE: 嵌套超过JSON_STREAM_MAX_DEPTH
+ */
+esp_err_t json_stream_feed(json_stream_t *js, const char *data, size_t len);
+
+/**
+ * @brief 输入结束
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 已解析出一个完整的JSON值
+ *   - ESP_ERR_INVALID_STATE: 文档不完整（如响应被截断）
+ *   - ESP_ERR_INVALID_RESPONSE / ESP_ERR_INVALID_SIZE: 此前发生的错误
+ */
+esp_err_t json_stream_finish(json_stream_t *js);
+
+/**
+ * @brief 出错时已处理的字节数
+ */
+uint32_t json_stream_error_offset(const json_stream_t *js);
+
+/**
+ * @brief 是否有值或路径因超过缓冲区被截断
+ */
+bool json_stream_truncated(const json_stream_t *js);
+
+/* ==================== 字段表绑定 ==================== */
+
+/**
+ * @brief 字段类型
+ */
+typedef enum {
+    JSON_FIELD_STRING = 0,         ///< char[]，超长截断，始终以'\0'结尾
+    JSON_FIELD_INT,                ///< int
+    JSON_FIELD_UINT32,             ///< uint32_t（负数忽略）
+    JSON_FIELD_BOOL,               ///< bool（只接受true/false）
+    JSON_FIELD_PRESENT,            ///< bool，路径上出现对象时置true
+} json_field_type_t;
+
+/**
+ * @brief 字段描述（用JSON_FIELD宏定义）
+ */
+typedef struct {
+    const char *path;
+    uint8_t type;                  ///< json_field_type_t
+    uint16_t offset;               ///< 成员偏移
+    uint16_t size;                 ///< 成员大小
+} json_field_t;
+
+#define JSON_FIELD(type_, path_, struct_, member_) \
+    { (path_), (type_), offsetof(struct_, member_), sizeof(((struct_ *)0)->member_) }
+
+/**
+ * @brief 字段表绑定
+ */
+typedef struct {
+    const json_field_t *fields;
+    size_t count;                  ///< 字段数（不超过32）
+    void *out;                     ///< 目标结构体
+    uint32_t matched;              ///< 已填充的字段位图（第i位对应fields[i]）
+} json_stream_bind_t;
+
+/**
+ * @brief 用字段表初始化解析器（回调为 json_stream_bind_cb，matched清零，不清空目标结构体）
+ */
+void json_stream_init_bind(json_stream_t *js, json_stream_bind_t *bind,
+                           const json_field_t *fields, size_t count, void *out);
+
+/**
+ * @brief 字段表回调（ctx为json_stream_bind_t*），可在自定义回调中转调
+ */
+void json_stream_bind_cb(void *ctx, const char *path, json_stream_type_t type, const char *value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_STREAM_H
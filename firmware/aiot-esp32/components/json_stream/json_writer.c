@@ -0,0 +1,140 @@
+/**
+ * @file json_writer.c
+ * @brief 有界JSON输出实现
+ */
+
+#include "json_writer.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+void json_writer_init(json_writer_t *w, char *buf, size_t size)
+{
+    w->buf = buf;
+    w->size = size;
+    w->len = 0;
+    w->overflow = size == 0;
+    if (size) {
+        buf[0] = '\0';
+    }
+}
+
+bool json_writer_commit(json_writer_t *w, int n)
+{
+    if (w->overflow) {
+        return false;
+    }
+    if (n < 0 || (size_t)n >= w->size - w->len) {
+        w->overflow = true;
+        w->buf[w->len] = '\0';
+        return false;
+    }
+    w->len += (size_t)n;
+    return true;
+}
+
+bool json_writer_printf(json_writer_t *w, const char *fmt, ...)
+{
+    if (w->overflow) {
+        return false;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(w->buf + w->len, w->size - w->len, fmt, ap);
+    va_end(ap);
+    return json_writer_commit(w, n);
+}
+
+/**
+ * @brief 原样追加 n 个字节
+ */
+static bool put(json_writer_t *w, const char *s, size_t n)
+{
+    if (w->overflow) {
+        return false;
+    }
+    if (n >= w->size - w->len) {
+        w->overflow = true;
+        return false;
+    }
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+    w->buf[w->len] = '\0';
+    return true;
+}
+
+bool json_writer_string(json_writer_t *w, const char *str)
+{
+    size_t mark = w->len;
+    const char *p = str ? str : "";
+    bool ok = put(w, "\"", 1);
+    while (ok && *p) {
+        // 不需要转义的一段整体拷贝
+        size_t run = 0;
+        while (p[run] && p[run] != '"' && p[run] != '\\' && (unsigned char)p[run] >= 0x20) {
+            run++;
+        }
+        ok = put(w, p, run);
+        p += run;
+        if (!ok || !*p) {
+            break;
+        }
+        unsigned char c = (unsigned char)*p++;
+        switch (c) {
+            case '"':  ok = put(w, "\\\"", 2); break;
+            case '\\': ok = put(w, "\\\\", 2); break;
+            case '\n': ok = put(w, "\\n", 2); break;
+            case '\r': ok = put(w, "\\r", 2); break;
+            case '\t': ok = put(w, "\\t", 2); break;
+            default:   ok = json_writer_printf(w, "\\u%04x", c); break;
+        }
+    }
+    ok = ok && put(w, "\"", 1);
+    if (!ok) {
+        json_writer_rewind(w, mark);
+    }
+    return ok;
+}
+
+void json_writer_rewind(json_writer_t *w, size_t mark)
+{
+    if (mark < w->len) {
+        w->len = mark;
+        w->buf[mark] = '\0';
+    }
+}
+
+esp_err_t json_writer_splice_object(json_writer_t *w, json_writer_object_fn_t fn)
+{
+    if (w->overflow) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    size_t obj_len = 0;
+    esp_err_t ret = fn(w->buf + w->len, w->size - w->len, &obj_len);
+    if (ret != ESP_OK || obj_len < 2 || w->buf[w->len] != '{') {
+        w->buf[w->len] = '\0';
+        return ret != ESP_OK ? ret : ESP_ERR_INVALID_RESPONSE;
+    }
+
+    char *obj = w->buf + w->len;
+    if (obj_len == 2 && w->len > 0 && obj[-1] == ',') {
+        // 空对象：去掉前面的','，只保留'}'
+        obj[-1] = '}';
+        obj[0] = '\0';
+        return ESP_OK;
+    }
+    memmove(obj, obj + 1, obj_len);         // 连同'\0'前移一个字节
+    w->len += obj_len - 1;
+    return ESP_OK;
+}
+
+esp_err_t json_writer_finish(const json_writer_t *w, size_t *out_len)
+{
+    if (w->overflow) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (out_len) {
+        *out_len = w->len;
+    }
+    return ESP_OK;
+}
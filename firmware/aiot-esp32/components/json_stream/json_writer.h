@@ -0,0 +1,93 @@
+/**
+ * @file json_writer.h
+ * @brief 有界JSON输出：按printf格式追加到调用方缓冲区，空间不足时整体判为溢出
+ *
+ * 指标快照、任务分析、告警/上报策略/滤波状态、传感器上报都是"固定缓冲区里拼一段JSON"，
+ * 统一用本写入器：任何一次追加放不下就置溢出标志，之后的追加全部忽略，
+ * 最后由 json_writer_finish() 返回 ESP_ERR_INVALID_SIZE，调用方不必逐次检查。
+ * 缓冲区始终以'\0'结尾。
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 写入器状态（成员可读，不要直接修改）
+ */
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;                    ///< 已写入长度（不含'\0'）
+    bool overflow;                 ///< 有追加因空间不足被丢弃
+} json_writer_t;
+
+/**
+ * @brief 生成一个JSON对象的状态函数（如 alarm_status_json）
+ */
+typedef esp_err_t (*json_writer_object_fn_t)(char *buf, size_t buf_size, size_t *out_len);
+
+/**
+ * @brief 初始化写入器（size为0时直接处于溢出状态）
+ */
+void json_writer_init(json_writer_t *w, char *buf, size_t size);
+
+/**
+ * @brief 按格式追加
+ *
+ * @return true=已追加，false=空间不足或之前已溢出（缓冲区内容保持不变）
+ */
+bool json_writer_printf(json_writer_t *w, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief 追加一个带引号的JSON字符串（转义引号、反斜杠和控制字符）
+ *
+ * @param str 以'\0'结尾的字符串，NULL按空串处理
+ * @return true=已追加，false=空间不足或之前已溢出（不会留下半个字符串）
+ */
+bool json_writer_string(json_writer_t *w, const char *str);
+
+/**
+ * @brief 确认调用方直接写入 buf + len 的 n 个字节（如驱动的格式化回调）
+ *
+ * @param n 写入的长度（snprintf返回值语义：<0 或放不下时判为溢出）
+ */
+bool json_writer_commit(json_writer_t *w, int n);
+
+/**
+ * @brief 截断到之前记录的长度 mark（溢出标志保持不变，用于丢弃写了一半的条目）
+ */
+void json_writer_rewind(json_writer_t *w, size_t mark);
+
+/**
+ * @brief 把状态函数输出的对象的成员接在已写入的内容后面
+ *
+ * 先写入 "{...}" 再去掉开头的'{'，用于 {"type":..,"result":..,<状态对象的成员>} 这类响应；
+ * 状态对象为空时同时去掉前面多余的','。
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - 其他: 状态函数的错误（写入器内容不变，可改写回退字段）
+ */
+esp_err_t json_writer_splice_object(json_writer_t *w, json_writer_object_fn_t fn);
+
+/**
+ * @brief 结束写入
+ *
+ * @param out_len 输出长度（可为NULL）
+ * @return ESP_OK，或 ESP_ERR_INVALID_SIZE（溢出）
+ */
+esp_err_t json_writer_finish(const json_writer_t *w, size_t *out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JSON_WRITER_H
@@ -0,0 +1,180 @@
+/**
+ * @file led_effects.c
+ * @brief 灯光效果编排：把渐变/呼吸拆成硬件渐变能执行的线性段（只做计算，不访问LEDC）
+ *
+ * 感知亮度 level 取 0 ~ LED_EFFECTS_LEVEL_MAX，每256一个查表点。开启gamma时渐变在感知亮度上匀速：
+ * 每段从当前查表点走到下一个查表点，段末时刻按感知亮度的比例分配，
+ * 所以硬件的直线渐变连起来正好是gamma查找表的分段线性插值。
+ */
+
+#include "led_effects.h"
+
+#define PHASE_RISE          0
+#define PHASE_HOLD_HIGH     1
+#define PHASE_FALL          2
+#define PHASE_HOLD_LOW      3
+
+/**
+ * @brief gamma 2.2 查找表：round(65535 * (k/16)^2.2)，分段线性插值与真实曲线的最大偏差约为满量程的0.13%
+ */
+static const uint16_t s_gamma_lut[LED_EFFECTS_GAMMA_KNOTS + 1] = {
+    0, 147, 676, 1648, 3104, 5072, 7574, 10632, 14263,
+    18482, 23303, 28739, 34802, 41503, 48853, 56860, 65535,
+};
+
+static inline uint32_t permille_to_duty(uint16_t permille, uint32_t max_duty)
+{
+    if (permille > LED_EFFECTS_SCALE) {
+        permille = LED_EFFECTS_SCALE;
+    }
+    return (permille * max_duty + LED_EFFECTS_SCALE / 2) / LED_EFFECTS_SCALE;
+}
+
+uint32_t led_effects_level_to_duty(int32_t level, uint32_t max_duty)
+{
+    if (level <= 0) {
+        return 0;
+    }
+    if (level >= LED_EFFECTS_LEVEL_MAX) {
+        return max_duty;
+    }
+    uint32_t k = (uint32_t)level >> 8;
+    uint32_t frac = (uint32_t)level & 0xFF;
+    uint32_t q = s_gamma_lut[k] + ((s_gamma_lut[k + 1] - s_gamma_lut[k]) * frac + 128) / 256;
+    return (q * max_duty + 32767) / 65535;
+}
+
+int32_t led_effects_duty_to_level(uint32_t duty, uint32_t max_duty)
+{
+    if (max_duty == 0 || duty == 0) {
+        return 0;
+    }
+    if (duty >= max_duty) {
+        return LED_EFFECTS_LEVEL_MAX;
+    }
+    uint32_t q = (duty * 65535 + max_duty / 2) / max_duty;
+    uint32_t k = 0;
+    while (k < LED_EFFECTS_GAMMA_KNOTS - 1 && q >= s_gamma_lut[k + 1]) {
+        k++;
+    }
+    uint32_t span = s_gamma_lut[k + 1] - s_gamma_lut[k];
+    uint32_t frac = ((q - s_gamma_lut[k]) * 256 + span / 2) / span;
+    return (int32_t)(k * 256 + (frac > 256 ? 256 : frac));
+}
+
+void led_effect_begin(led_effect_state_t *state, const led_effect_t *effect, uint32_t max_duty)
+{
+    *state = (led_effect_state_t){
+        .effect = *effect,
+        .max_duty = max_duty,
+        .duty = permille_to_duty(effect->from, max_duty),
+        .phase = PHASE_RISE,
+    };
+}
+
+/**
+ * @brief 当前阶段进入/结束后切到下一阶段
+ */
+static void next_phase(led_effect_state_t *state)
+{
+    state->in_ramp = false;
+    if (state->effect.type == LED_EFFECT_FADE) {
+        state->done = true;
+        return;
+    }
+    state->phase = (state->phase + 1) % 4;
+    if (state->phase == PHASE_RISE) {
+        state->cycle++;
+        if (state->effect.cycles != 0 && state->cycle >= state->effect.cycles) {
+            state->done = true;
+        }
+    }
+}
+
+/**
+ * @brief 当前渐变的下一段
+ *
+ * @return 渐变已走完返回false
+ */
+static bool ramp_step(led_effect_state_t *state, led_fade_segment_t *seg)
+{
+    if (state->elapsed_ms >= state->ramp_ms && state->duty == state->ramp_duty) {
+        return false;
+    }
+
+    int32_t from = state->ramp_from_level;
+    int32_t to = state->ramp_to_level;
+    while (state->effect.gamma && from != to) {
+        bool rising = to > from;
+        int32_t knot = rising ? ((state->level >> 8) + 1) << 8 : ((state->level - 1) >> 8) << 8;
+        if (rising ? knot >= to : knot <= to) {
+            break;
+        }
+        // 段末时刻按感知亮度比例分配（向下取整，总小于渐变时长）
+        uint32_t t_end = (uint32_t)((int64_t)state->ramp_ms * (knot - from) / (to - from));
+        state->level = knot;
+        if (t_end <= state->elapsed_ms) {
+            continue;   // 渐变太短，这个查表点落在同一毫秒内，直接走向下一个
+        }
+        seg->duty = led_effects_level_to_duty(knot, state->max_duty);
+        seg->time_ms = t_end - state->elapsed_ms;
+        state->elapsed_ms = t_end;
+        state->duty = seg->duty;
+        return true;
+    }
+
+    // 最后一段精确走到终点占空比
+    seg->duty = state->ramp_duty;
+    seg->time_ms = state->ramp_ms - state->elapsed_ms;
+    state->elapsed_ms = state->ramp_ms;
+    state->level = to;
+    state->duty = state->ramp_duty;
+    return true;
+}
+
+bool led_effect_next(led_effect_state_t *state, led_fade_segment_t *seg)
+{
+    const led_effect_t *fx = &state->effect;
+
+    // 每轮要么返回一段要么切换一个阶段；全零参数的无限呼吸在一个周期内没有任何段，按结束处理
+    for (int guard = 0; guard < 5 && !state->done; guard++) {
+        switch (state->phase) {
+            case PHASE_RISE:
+            case PHASE_FALL:
+                if (!state->in_ramp) {
+                    bool rise = state->phase == PHASE_RISE;
+                    state->ramp_duty = permille_to_duty(rise ? fx->to : fx->from, state->max_duty);
+                    state->ramp_ms = rise ? fx->rise_ms : fx->fall_ms;
+                    state->ramp_from_level = led_effects_duty_to_level(state->duty, state->max_duty);
+                    state->ramp_to_level = led_effects_duty_to_level(state->ramp_duty, state->max_duty);
+                    state->level = state->ramp_from_level;
+                    state->elapsed_ms = 0;
+                    state->in_ramp = true;
+                }
+                if (ramp_step(state, seg)) {
+                    return true;
+                }
+                next_phase(state);
+                break;
+
+            case PHASE_HOLD_HIGH:
+            case PHASE_HOLD_LOW: {
+                bool last = fx->cycles != 0 && state->cycle + 1 >= fx->cycles;
+                uint16_t hold = state->phase == PHASE_HOLD_HIGH ? fx->hold_high_ms : (last ? 0 : fx->hold_low_ms);
+                next_phase(state);
+                if (hold > 0) {
+                    seg->duty = state->duty;
+                    seg->time_ms = hold;
+                    return true;
+                }
+                break;
+            }
+
+            default:
+                state->done = true;
+                break;
+        }
+    }
+    state->done = true;
+    return false;
+}
@@ -0,0 +1,177 @@
+/**
+ * @file led_effects.h
+ * @brief 灯光效果引擎：渐变/呼吸曲线交给LEDC硬件渐变执行，按gamma查表分段，段与段之间由渐变结束中断衔接
+ *
+ * 原来的渐变/呼吸预设每个步进调用一次 pwm_control_set()（校验、两行日志、ledc_set_duty +
+ * ledc_update_duty），2秒的呼吸按50ms步进就是几十次驱动调用，而且整个过程占住执行预设的任务。
+ * 本组件：
+ *
+ * - 效果（渐变、呼吸）先编排成若干"线性段"（目标占空比 + 时长），每段交给
+ *   ledc_set_fade_with_time() 由硬件逐周期推进，CPU不参与；
+ * - 人眼对亮度是非线性的，开启gamma时按感知亮度匀速变化：gamma 2.2 曲线用17点查找表表示，
+ *   硬件渐变只能走直线，所以每段正好走到下一个查表点，整条曲线就是查找表的分段线性插值；
+ * - 渐变结束中断（ledc_cb_register）只启动一个0延时的 esp_timer，在定时器任务里启动下一段；
+ *   保持段用同一个定时器计时。段与段之间没有任务在运行或轮询；
+ * - 每个输出独立运行，最多 CONFIG_LED_EFFECTS_MAX_OUTPUTS 路同时进行。
+ *
+ * 效果编排（led_effect_begin / led_effect_next）是纯计算，可在主机上和解析式比较；
+ * LEDC运行时在 led_effects_ledc.c 中。
+ */
+
+#ifndef LED_EFFECTS_H
+#define LED_EFFECTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_LED_EFFECTS_MAX_OUTPUTS
+#define CONFIG_LED_EFFECTS_MAX_OUTPUTS      4
+#endif
+
+#define LED_EFFECTS_GAMMA_KNOTS     16      ///< gamma查找表分段数（表长17）
+#define LED_EFFECTS_LEVEL_MAX       (LED_EFFECTS_GAMMA_KNOTS * 256)     ///< 感知亮度满量程
+#define LED_EFFECTS_SCALE           1000    ///< 效果参数的占空比单位：千分比
+
+/**
+ * @brief 效果类型
+ */
+typedef enum {
+    LED_EFFECT_FADE = 0,            ///< from -> to 单次渐变，停在to
+    LED_EFFECT_BREATHE,             ///< from -> to -> from 循环，停在from
+} led_effect_type_t;
+
+/**
+ * @brief 效果参数（占空比为满量程的千分比）
+ */
+typedef struct {
+    led_effect_type_t type;
+    uint16_t from;                  ///< 起始占空比（0-1000）
+    uint16_t to;                    ///< 目标/峰值占空比（0-1000）
+    uint16_t rise_ms;               ///< from -> to 时长
+    uint16_t fall_ms;               ///< to -> from 时长（呼吸）
+    uint16_t hold_high_ms;          ///< 到达to后保持（呼吸）
+    uint16_t hold_low_ms;           ///< 回到from后保持（呼吸，最后一次不保持）
+    uint16_t cycles;                ///< 呼吸次数（0为一直循环）
+    bool gamma;                     ///< true按感知亮度匀速变化，false占空比线性变化
+} led_effect_t;
+
+/**
+ * @brief 一段硬件渐变（或保持：duty与上一段相同）
+ */
+typedef struct {
+    uint32_t duty;                  ///< 段末占空比（硬件单位）
+    uint32_t time_ms;               ///< 段时长
+} led_fade_segment_t;
+
+/**
+ * @brief 效果编排状态
+ */
+typedef struct {
+    led_effect_t effect;
+    uint32_t max_duty;              ///< 硬件满量程占空比
+    uint32_t duty;                  ///< 当前（上一段末）占空比
+    uint8_t phase;                  ///< 呼吸周期内的阶段：渐亮、保持、渐暗、保持
+    uint16_t cycle;                 ///< 已完成的周期数
+    bool in_ramp;                   ///< 当前阶段的渐变已开始
+    uint32_t ramp_duty;             ///< 渐变终点占空比
+    uint16_t ramp_ms;               ///< 渐变时长
+    int32_t ramp_from_level;        ///< 渐变起点感知亮度
+    int32_t ramp_to_level;          ///< 渐变终点感知亮度
+    int32_t level;                  ///< 当前感知亮度
+    uint32_t elapsed_ms;            ///< 渐变已用时间
+    bool done;
+} led_effect_state_t;
+
+/**
+ * @brief 感知亮度（0-LED_EFFECTS_LEVEL_MAX）转换为占空比（gamma 2.2 查表插值）
+ */
+uint32_t led_effects_level_to_duty(int32_t level, uint32_t max_duty);
+
+/**
+ * @brief 占空比转换为感知亮度（level_to_duty 的反函数）
+ */
+int32_t led_effects_duty_to_level(uint32_t duty, uint32_t max_duty);
+
+/**
+ * @brief 开始编排效果，state->duty 为效果起点占空比（运行时先直接写入）
+ *
+ * @param max_duty 硬件满量程占空比（13位分辨率为8191）
+ */
+void led_effect_begin(led_effect_state_t *state, const led_effect_t *effect, uint32_t max_duty);
+
+/**
+ * @brief 取下一段
+ *
+ * @return 还有段时返回true；效果结束返回false
+ */
+bool led_effect_next(led_effect_state_t *state, led_fade_segment_t *seg);
+
+/* ==================== LEDC运行时 ==================== */
+
+/**
+ * @brief 运行统计
+ */
+typedef struct {
+    uint32_t fades;                 ///< 启动的硬件渐变段数
+    uint32_t holds;                 ///< 保持段数
+    uint32_t effects;               ///< 启动的效果数
+} led_effects_stats_t;
+
+/**
+ * @brief 把LEDC通道登记为效果输出（通道和定时器由调用方配置好）
+ *
+ * 首次调用时安装LEDC渐变服务。
+ *
+ * @param output 输出序号（0 ~ CONFIG_LED_EFFECTS_MAX_OUTPUTS-1）
+ * @param speed_mode LEDC速度模式（ledc_mode_t）
+ * @param channel LEDC通道（ledc_channel_t）
+ * @param duty_resolution 占空比位数
+ * @return esp_err_t
+ *   - ESP_OK: 成功（重复登记同一通道也返回ESP_OK）
+ *   - ESP_ERR_INVALID_ARG: 参数错误
+ *   - ESP_ERR_NO_MEM: 创建锁或定时器失败
+ */
+esp_err_t led_effects_attach(uint8_t output, uint8_t speed_mode, uint8_t channel, uint8_t duty_resolution);
+
+/**
+ * @brief 启动效果（立即返回；同一输出上正在运行的效果被替换）
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 已启动
+ *   - ESP_ERR_INVALID_ARG: 参数错误
+ *   - ESP_ERR_INVALID_STATE: 输出未登记
+ */
+esp_err_t led_effects_start(uint8_t output, const led_effect_t *effect);
+
+/**
+ * @brief 停止效果，占空比停在当前值（未运行时什么也不做）
+ */
+esp_err_t led_effects_stop(uint8_t output);
+
+/**
+ * @brief 输出上是否有效果在运行
+ */
+bool led_effects_is_running(uint8_t output);
+
+/**
+ * @brief 等待效果结束
+ *
+ * @return ESP_OK 或 ESP_ERR_TIMEOUT
+ */
+esp_err_t led_effects_wait_idle(uint8_t output, uint32_t timeout_ms);
+
+/**
+ * @brief 获取输出的运行统计
+ */
+esp_err_t led_effects_get_stats(uint8_t output, led_effects_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LED_EFFECTS_H
@@ -0,0 +1,266 @@
+/**
+ * @file led_effects_ledc.c
+ * @brief 灯光效果运行时：LEDC硬件渐变执行每一段，渐变结束中断经 esp_timer 衔接下一段
+ *
+ * LEDC的渐变接口内部要拿锁，不能在渐变结束中断里直接调用，所以中断只启动一个0延时的
+ * esp_timer（可在中断中调用），下一段在定时器任务里启动；保持段也用这个定时器计时。
+ * 一段渐变进行期间没有任何任务在运行或轮询。
+ */
+
+#include "led_effects.h"
+#include "driver/ledc.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "led_effects";
+
+#define LOCK()      xSemaphoreTake(s_mutex, portMAX_DELAY)
+#define UNLOCK()    xSemaphoreGive(s_mutex)
+
+typedef struct {
+    bool attached;
+    bool running;
+    ledc_mode_t mode;
+    ledc_channel_t channel;
+    uint32_t max_duty;
+    esp_timer_handle_t step_timer;
+    int64_t seg_start_us;           ///< 当前段开始时刻（识别效果被替换前遗留的定时器回调）
+    int64_t seg_time_us;
+    led_effect_state_t state;
+    led_effects_stats_t stats;
+} effect_output_t;
+
+static effect_output_t s_outputs[CONFIG_LED_EFFECTS_MAX_OUTPUTS];
+static SemaphoreHandle_t s_mutex = NULL;
+static bool s_fade_installed = false;
+
+/**
+ * @brief 渐变结束中断：只启动定时器，下一段在定时器任务里启动
+ */
+static bool IRAM_ATTR fade_end_isr(const ledc_cb_param_t *param, void *arg)
+{
+    effect_output_t *out = (effect_output_t *)arg;
+    if (param->event == LEDC_FADE_END_EVT) {
+        esp_timer_start_once(out->step_timer, 0);
+    }
+    return false;
+}
+
+/**
+ * @brief 启动下一段（持锁调用），效果结束或出错时停止
+ */
+static void run_next(effect_output_t *out)
+{
+    led_fade_segment_t seg;
+    uint32_t prev = out->state.duty;
+
+    while (led_effect_next(&out->state, &seg)) {
+        out->seg_start_us = esp_timer_get_time();
+        out->seg_time_us = (int64_t)seg.time_ms * 1000;
+
+        if (seg.duty == prev) {
+            // 保持段：占空比不变，只计时
+            if (seg.time_ms == 0) {
+                continue;
+            }
+            out->stats.holds++;
+            esp_timer_start_once(out->step_timer, (uint64_t)seg.time_ms * 1000);
+            return;
+        }
+
+        prev = seg.duty;
+        if (seg.time_ms == 0) {
+            // 时长为0的段（渐变时间为0）直接跳到目标占空比
+            ledc_set_duty(out->mode, out->channel, seg.duty);
+            ledc_update_duty(out->mode, out->channel);
+            continue;
+        }
+
+        esp_err_t ret = ledc_set_fade_with_time(out->mode, out->channel, seg.duty, seg.time_ms);
+        if (ret == ESP_OK) {
+            ret = ledc_fade_start(out->mode, out->channel, LEDC_FADE_NO_WAIT);
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "⚠️ 通道%d 启动渐变失败: %s，效果停止", out->channel, esp_err_to_name(ret));
+            break;
+        }
+        out->stats.fades++;
+        return;
+    }
+    out->running = false;
+}
+
+/**
+ * @brief 渐变结束/保持结束后的定时器回调（esp_timer任务）
+ */
+static void step_timer_cb(void *arg)
+{
+    effect_output_t *out = (effect_output_t *)arg;
+    LOCK();
+    // 效果刚被替换时，旧效果遗留的回调可能已经在等锁：新段才开始不久，忽略
+    int64_t elapsed = esp_timer_get_time() - out->seg_start_us;
+    if (out->running && elapsed >= out->seg_time_us / 2) {
+        run_next(out);
+    }
+    UNLOCK();
+}
+
+/**
+ * @brief 停止当前效果（持锁调用）
+ */
+static void halt(effect_output_t *out)
+{
+    if (out->running) {
+        ledc_fade_stop(out->mode, out->channel);
+        esp_timer_stop(out->step_timer);
+        out->running = false;
+    }
+}
+
+esp_err_t led_effects_attach(uint8_t output, uint8_t speed_mode, uint8_t channel, uint8_t duty_resolution)
+{
+    if (output >= CONFIG_LED_EFFECTS_MAX_OUTPUTS || speed_mode >= LEDC_SPEED_MODE_MAX ||
+        channel >= LEDC_CHANNEL_MAX || duty_resolution == 0 || duty_resolution > 20) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    LOCK();
+    effect_output_t *out = &s_outputs[output];
+    if (out->attached) {
+        bool same = out->mode == (ledc_mode_t)speed_mode && out->channel == (ledc_channel_t)channel;
+        UNLOCK();
+        return same ? ESP_OK : ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = ESP_OK;
+    if (!s_fade_installed) {
+        // 其他模块已安装时返回ESP_ERR_INVALID_STATE，同样可用
+        ret = ledc_fade_func_install(0);
+        if (ret == ESP_OK || ret == ESP_ERR_INVALID_STATE) {
+            s_fade_installed = true;
+            ret = ESP_OK;
+        }
+    }
+
+    if (ret == ESP_OK && !out->step_timer) {
+        const esp_timer_create_args_t args = {
+            .callback = step_timer_cb,
+            .arg = out,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "led_fx",
+        };
+        ret = esp_timer_create(&args, &out->step_timer);
+    }
+
+    if (ret == ESP_OK) {
+        ledc_cbs_t cbs = {
+            .fade_cb = fade_end_isr,
+        };
+        ret = ledc_cb_register((ledc_mode_t)speed_mode, (ledc_channel_t)channel, &cbs, out);
+    }
+
+    if (ret == ESP_OK) {
+        out->mode = (ledc_mode_t)speed_mode;
+        out->channel = (ledc_channel_t)channel;
+        out->max_duty = (1u << duty_resolution) - 1;
+        out->attached = true;
+        ESP_LOGI(TAG, "✅ 效果输出%u: LEDC通道%u, %u位", (unsigned)output, (unsigned)channel,
+                 (unsigned)duty_resolution);
+    } else {
+        ESP_LOGE(TAG, "❌ 效果输出%u 登记失败: %s", (unsigned)output, esp_err_to_name(ret));
+    }
+    UNLOCK();
+    return ret;
+}
+
+esp_err_t led_effects_start(uint8_t output, const led_effect_t *effect)
+{
+    if (output >= CONFIG_LED_EFFECTS_MAX_OUTPUTS || !effect ||
+        effect->from > LED_EFFECTS_SCALE || effect->to > LED_EFFECTS_SCALE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (effect->type == LED_EFFECT_BREATHE && effect->cycles == 0 &&
+        effect->rise_ms + effect->fall_ms + effect->hold_high_ms + effect->hold_low_ms == 0) {
+        return ESP_ERR_INVALID_ARG;     // 无限循环但一个周期时长为0
+    }
+    if (!s_mutex || !s_outputs[output].attached) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    LOCK();
+    effect_output_t *out = &s_outputs[output];
+    halt(out);
+    led_effect_begin(&out->state, effect, out->max_duty);
+
+    // 起点直接写入，之后每段只有一次渐变调用
+    ledc_set_duty(out->mode, out->channel, out->state.duty);
+    ledc_update_duty(out->mode, out->channel);
+
+    out->running = true;
+    out->stats.effects++;
+    run_next(out);
+    UNLOCK();
+    return ESP_OK;
+}
+
+esp_err_t led_effects_stop(uint8_t output)
+{
+    if (output >= CONFIG_LED_EFFECTS_MAX_OUTPUTS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mutex) {
+        return ESP_OK;
+    }
+    LOCK();
+    halt(&s_outputs[output]);
+    UNLOCK();
+    return ESP_OK;
+}
+
+bool led_effects_is_running(uint8_t output)
+{
+    if (output >= CONFIG_LED_EFFECTS_MAX_OUTPUTS || !s_mutex) {
+        return false;
+    }
+    LOCK();
+    bool running = s_outputs[output].running;
+    UNLOCK();
+    return running;
+}
+
+esp_err_t led_effects_wait_idle(uint8_t output, uint32_t timeout_ms)
+{
+    TickType_t start = xTaskGetTickCount();
+    while (led_effects_is_running(output)) {
+        if ((xTaskGetTickCount() - start) >= pdMS_TO_TICKS(timeout_ms)) {
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return ESP_OK;
+}
+
+esp_err_t led_effects_get_stats(uint8_t output, led_effects_stats_t *stats)
+{
+    if (output >= CONFIG_LED_EFFECTS_MAX_OUTPUTS || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    LOCK();
+    *stats = s_outputs[output].stats;
+    UNLOCK();
+    return ESP_OK;
+}
@@ -0,0 +1,158 @@
+/**
+ * @file live_provision.c
+ * @brief 配网辅助函数：服务器地址解析、TCP探测、状态JSON（不依赖WiFi驱动）
+ */
+
+#include "live_provision.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lwip/sockets.h"
+#include "lwip/netdb.h"
+#include "json_writer.h"
+
+esp_err_t live_provision_parse_host(const char *server_address, char *host, size_t size)
+{
+    if (!server_address || !host || size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const char *p = server_address;
+    while (*p == ' ') {
+        p++;
+    }
+    const char *scheme = strstr(p, "://");
+    if (scheme) {
+        p = scheme + 3;
+    }
+    size_t len = strcspn(p, ":/?# ");
+    if (len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len >= size) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(host, p, len);
+    host[len] = '\0';
+    return ESP_OK;
+}
+
+uint16_t live_provision_parse_port(const char *server_address)
+{
+    if (!server_address) {
+        return 0;
+    }
+    const char *p = server_address;
+    while (*p == ' ') {
+        p++;
+    }
+    uint16_t port = strncmp(p, "https://", 8) == 0 ? 443 : 80;
+    const char *scheme = strstr(p, "://");
+    if (scheme) {
+        p = scheme + 3;
+    }
+    p += strcspn(p, ":/?# ");
+    if (*p != ':') {
+        return port;
+    }
+    char *end = NULL;
+    unsigned long v = strtoul(p + 1, &end, 10);
+    if (end == p + 1 || v == 0 || v > 65535 || (*end != '\0' && !strchr("/?# ", *end))) {
+        return 0;
+    }
+    return (uint16_t)v;
+}
+
+esp_err_t live_provision_probe_tcp(const char *host, uint16_t port, uint32_t timeout_ms)
+{
+    if (!host || host[0] == '\0' || port == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    struct addrinfo hints = {
+        .ai_family = AF_INET,
+        .ai_socktype = SOCK_STREAM,
+    };
+    struct addrinfo *res = NULL;
+    char port_str[8];
+    snprintf(port_str, sizeof(port_str), "%u", (unsigned)port);
+    if (getaddrinfo(host, port_str, &hints, &res) != 0 || !res) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    int sock = socket(res->ai_family, res->ai_socktype, 0);
+    if (sock < 0) {
+        freeaddrinfo(res);
+        return ESP_FAIL;
+    }
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+
+    esp_err_t ret = ESP_OK;
+    if (connect(sock, res->ai_addr, res->ai_addrlen) != 0) {
+        if (errno != EINPROGRESS) {
+            ret = ESP_FAIL;
+        } else {
+            fd_set wfds;
+            FD_ZERO(&wfds);
+            FD_SET(sock, &wfds);
+            struct timeval tv = {
+                .tv_sec = timeout_ms / 1000,
+                .tv_usec = (timeout_ms % 1000) * 1000,
+            };
+            int n = select(sock + 1, NULL, &wfds, NULL, &tv);
+            if (n == 0) {
+                ret = ESP_ERR_TIMEOUT;
+            } else if (n < 0) {
+                ret = ESP_FAIL;
+            } else {
+                int err = 0;
+                socklen_t len = sizeof(err);
+                if (getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &len) != 0 || err != 0) {
+                    ret = ESP_FAIL;
+                }
+            }
+        }
+    }
+
+    close(sock);
+    freeaddrinfo(res);
+    return ret;
+}
+
+const char *live_provision_stage_name(live_provision_stage_t stage)
+{
+    switch (stage) {
+        case LIVE_PROVISION_IDLE:       return "idle";
+        case LIVE_PROVISION_CONNECTING: return "connecting";
+        case LIVE_PROVISION_VERIFYING:  return "verifying";
+        case LIVE_PROVISION_HANDOFF:    return "handoff";
+        case LIVE_PROVISION_ONLINE:     return "online";
+        case LIVE_PROVISION_DEGRADED:   return "degraded";
+        case LIVE_PROVISION_FAILED:     return "failed";
+        default:                        return "unknown";
+    }
+}
+
+size_t live_provision_format_status(const live_provision_status_t *status, char *buf, size_t size)
+{
+    if (!status || !buf || size == 0) {
+        return 0;
+    }
+
+    json_writer_t w;
+    json_writer_init(&w, buf, size);
+    json_writer_printf(&w, "{\"stage\":\"%s\",\"message\":", live_provision_stage_name(status->stage));
+    json_writer_string(&w, status->message);
+    json_writer_printf(&w, ",\"attempts\":%u,\"wifi_ms\":%lu,\"server_ms\":%lu,\"broker_ms\":%lu,"
+                       "\"mqtt_ms\":%lu,\"telemetry_ms\":%lu}",
+                       (unsigned)status->wifi_attempts,
+                       (unsigned long)status->wifi_ms, (unsigned long)status->server_ms,
+                       (unsigned long)status->broker_ms,
+                       (unsigned long)status->mqtt_ms, (unsigned long)status->telemetry_ms);
+
+    size_t len = 0;
+    if (json_writer_finish(&w, &len) != ESP_OK) {
+        buf[0] = '\0';
+        return 0;
+    }
+    return len;
+}
@@ -0,0 +1,237 @@
+/**
+ * @file live_provision.h
+ * @brief 不重启的配网：新凭据直接在STA上连接验证，通过后交给运行中的MQTT客户端
+ *
+ * 原流程是保存配置后重启（长按Boot进入配网也要重启一次），从提交密码到设备上线
+ * 要经过一整套启动流程；密码错误只能在重启后才发现，此时配网热点已经关了。
+ * 本组件在配网模式下（AP网页或BLE保持在线）完成：
+ *
+ * 1. 连接：AP模式切换为AP+STA（热点和BLE不断开，共存模式），用新凭据连接，
+ *    有限次重试，等待获取IP；
+ * 2. 验证：先TCP连接配置服务器（server_address 的主机和端口），再由 resolve_broker 钩子
+ *    向配置服务器获取设备的MQTT broker地址和端口（/device/info 的 mqtt_config），
+ *    最后TCP连接该broker，确认设备上线要用到的两台服务器都可达；
+ * 3. 保存：前两步都成功才调用 persist 钩子写入配置（失败时什么都不保存，手机可直接重填）；
+ * 4. 交接：调用 handoff 钩子继续启动流程（获取设备配置、初始化/重连MQTT客户端），
+ *    等待MQTT连接和第一条遥测数据（由应用调用 live_provision_mark()）；
+ * 5. 收尾：上报最终耗时后调用 finish 钩子关闭配网热点。MQTT在超时内没有连上时
+ *    上报 DEGRADED（配置已保存、WiFi可用，MQTT客户端在后台继续重连），而不是 ONLINE。
+ *
+ * 每个阶段相对"收到凭据"的耗时记录在 live_provision_status_t 中，
+ * 每次阶段变化都通过回调上报（BLE通知手机），网页通过状态接口轮询。
+ *
+ * 地址解析、TCP探测和状态JSON（live_provision_parse_host / live_provision_parse_port /
+ * live_provision_probe_tcp / live_provision_format_status）不依赖WiFi驱动，可在主机上单独测试；
+ * 配网任务在 live_provision_sta.c 中。
+ */
+
+#ifndef LIVE_PROVISION_H
+#define LIVE_PROVISION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_LIVE_PROVISION_WIFI_TIMEOUT_MS
+#define CONFIG_LIVE_PROVISION_WIFI_TIMEOUT_MS       15000
+#endif
+
+#ifndef CONFIG_LIVE_PROVISION_WIFI_RETRY
+#define CONFIG_LIVE_PROVISION_WIFI_RETRY            3
+#endif
+
+#ifndef CONFIG_LIVE_PROVISION_PROBE_TIMEOUT_MS
+#define CONFIG_LIVE_PROVISION_PROBE_TIMEOUT_MS      3000
+#endif
+
+#ifndef CONFIG_LIVE_PROVISION_MQTT_TIMEOUT_MS
+#define CONFIG_LIVE_PROVISION_MQTT_TIMEOUT_MS       15000
+#endif
+
+#ifndef CONFIG_LIVE_PROVISION_TELEMETRY_TIMEOUT_MS
+#define CONFIG_LIVE_PROVISION_TELEMETRY_TIMEOUT_MS  30000
+#endif
+
+#ifndef CONFIG_LIVE_PROVISION_AP_LINGER_MS
+#define CONFIG_LIVE_PROVISION_AP_LINGER_MS          5000
+#endif
+
+#ifndef CONFIG_LIVE_PROVISION_TASK_STACK
+#define CONFIG_LIVE_PROVISION_TASK_STACK            8192
+#endif
+
+#define LIVE_PROVISION_DEFAULT_MQTT_PORT    1883
+#define LIVE_PROVISION_HOST_MAX             64
+
+/**
+ * @brief 配网阶段
+ */
+typedef enum {
+    LIVE_PROVISION_IDLE = 0,        ///< 未开始
+    LIVE_PROVISION_CONNECTING,      ///< 连接WiFi
+    LIVE_PROVISION_VERIFYING,       ///< 探测配置服务器和MQTT broker
+    LIVE_PROVISION_HANDOFF,         ///< 配置已保存，启动MQTT客户端
+    LIVE_PROVISION_ONLINE,          ///< 已上线（MQTT已连接，遥测已发出或等待超时）
+    LIVE_PROVISION_DEGRADED,        ///< 配置已保存、WiFi可用，但MQTT在超时内未连上
+    LIVE_PROVISION_FAILED,          ///< 失败（连接/验证阶段失败时未保存任何配置）
+} live_provision_stage_t;
+
+/**
+ * @brief 配网请求（服务器地址应已规范化，如"http://192.168.1.10"）
+ */
+typedef struct {
+    char ssid[32];
+    char password[64];
+    char server_address[64];
+    uint16_t mqtt_port;             ///< 未注册resolve_broker钩子时探测的端口（0使用LIVE_PROVISION_DEFAULT_MQTT_PORT）
+} live_provision_request_t;
+
+/**
+ * @brief 状态和各阶段耗时（相对收到凭据，毫秒；0表示未到达）
+ */
+typedef struct {
+    live_provision_stage_t stage;
+    esp_err_t error;                ///< FAILED时的错误码
+    char message[48];               ///< 当前阶段说明/失败原因
+    uint8_t wifi_attempts;          ///< WiFi连接尝试次数
+    uint32_t wifi_ms;               ///< 获取到IP
+    uint32_t server_ms;             ///< 配置服务器TCP可达
+    uint32_t broker_ms;             ///< broker TCP可达
+    uint32_t mqtt_ms;               ///< MQTT已连接
+    uint32_t telemetry_ms;          ///< 第一条遥测已发出（即凭据到上线的总耗时）
+} live_provision_status_t;
+
+/**
+ * @brief 应用钩子（在配网任务中调用，可以阻塞）
+ */
+typedef struct {
+    /**
+     * 获取设备的MQTT broker（可为NULL，此时探测服务器主机上的 req->mqtt_port）
+     * 返回错误时配网失败；ESP_ERR_NOT_FOUND 表示设备未注册
+     */
+    esp_err_t (*resolve_broker)(const live_provision_request_t *req, char *host, size_t host_size,
+                                uint16_t *port, void *ctx);
+    /** 验证通过后保存配置；返回错误时配网失败 */
+    esp_err_t (*persist)(const live_provision_request_t *req, void *ctx);
+    /** 继续启动流程并启动MQTT客户端；返回后等待 live_provision_mark(MQTT) */
+    esp_err_t (*handoff)(void *ctx);
+    /** 上线并上报后调用，用于关闭配网热点（可为NULL） */
+    void (*finish)(void *ctx);
+    void *ctx;
+} live_provision_hooks_t;
+
+/**
+ * @brief 阶段/状态上报回调（在配网任务中调用）
+ */
+typedef void (*live_provision_report_cb_t)(const live_provision_status_t *status, void *ctx);
+
+/**
+ * @brief 应用标记的里程碑
+ */
+typedef enum {
+    LIVE_PROVISION_MARK_MQTT = 0,   ///< MQTT连接成功
+    LIVE_PROVISION_MARK_TELEMETRY,  ///< 遥测数据发布成功
+} live_provision_mark_t;
+
+/**
+ * @brief 从服务器地址中取出主机名（去掉协议、端口、路径）
+ *
+ * @param server_address 如"http://example.com:8000/api"
+ * @param host 输出主机名
+ * @param size 输出缓冲区大小
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 参数为空或主机名为空
+ *   - ESP_ERR_INVALID_SIZE: 主机名过长
+ */
+esp_err_t live_provision_parse_host(const char *server_address, char *host, size_t size);
+
+/**
+ * @brief 服务器地址中的端口（未写端口时按协议取默认值：https为443，其他为80）
+ *
+ * @param server_address 如"http://example.com:8000/api"
+ * @return 端口；地址为空或端口无效时返回0
+ */
+uint16_t live_provision_parse_port(const char *server_address);
+
+/**
+ * @brief 探测TCP端口是否可达（解析域名 + 非阻塞connect，连上立即关闭）
+ *
+ * @param host 主机名或IPv4地址
+ * @param port 端口
+ * @param timeout_ms 连接超时
+ * @return esp_err_t
+ *   - ESP_OK: 可达
+ *   - ESP_ERR_NOT_FOUND: 域名解析失败
+ *   - ESP_ERR_TIMEOUT: 连接超时
+ *   - ESP_FAIL: 连接被拒绝或socket错误
+ */
+esp_err_t live_provision_probe_tcp(const char *host, uint16_t port, uint32_t timeout_ms);
+
+/**
+ * @brief 阶段名称（"connecting"等，用于JSON和日志）
+ */
+const char *live_provision_stage_name(live_provision_stage_t stage);
+
+/**
+ * @brief 状态序列化为JSON
+ *
+ * @code
+ * {"stage":"online","message":"...","attempts":1,"wifi_ms":2140,"server_ms":2180,
+ *  "broker_ms":2950,"mqtt_ms":3890,"telemetry_ms":9020}
+ * @endcode
+ *
+ * @return JSON长度；缓冲区不足时返回0
+ */
+size_t live_provision_format_status(const live_provision_status_t *status, char *buf, size_t size);
+
+/**
+ * @brief 注册应用钩子（启动时调用一次）
+ */
+void live_provision_set_hooks(const live_provision_hooks_t *hooks);
+
+/**
+ * @brief 是否已注册钩子（未注册时调用方应回退到保存后重启）
+ */
+bool live_provision_is_ready(void);
+
+/**
+ * @brief 开始配网（立即返回，结果通过回调和 live_provision_get_status() 获取）
+ *
+ * @param req 配网请求（内部复制）
+ * @param report 阶段上报回调（可为NULL）
+ * @param ctx 回调参数
+ * @return esp_err_t
+ *   - ESP_OK: 已开始
+ *   - ESP_ERR_INVALID_ARG: SSID为空或服务器地址无效
+ *   - ESP_ERR_INVALID_STATE: 未注册钩子，或上一次配网还在进行
+ *   - ESP_ERR_NO_MEM: 创建任务失败
+ */
+esp_err_t live_provision_start(const live_provision_request_t *req,
+                               live_provision_report_cb_t report, void *ctx);
+
+/**
+ * @brief 是否正在配网
+ */
+bool live_provision_is_active(void);
+
+/**
+ * @brief 获取当前（或最近一次）配网状态
+ */
+void live_provision_get_status(live_provision_status_t *status);
+
+/**
+ * @brief 应用标记里程碑（未在配网中时直接返回，可在任意任务的热路径调用）
+ */
+void live_provision_mark(live_provision_mark_t mark);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LIVE_PROVISION_H
@@ -0,0 +1,445 @@
+/**
+ * @file live_provision_sta.c
+ * @brief 不重启配网任务：AP+STA连接、服务器和broker探测、保存、交接MQTT并计时
+ *
+ * 一次配网一个任务，结束后任务退出。WiFi/IP事件只置事件位，所有等待和
+ * 重试都在任务中完成；应用通过 live_provision_mark() 报告MQTT连接和首条遥测。
+ */
+
+#include "live_provision.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+
+static const char *TAG = "LIVE_PROV";
+
+#define EVT_GOT_IP          BIT0
+#define EVT_DISCONNECTED    BIT1
+#define EVT_MQTT            BIT2
+#define EVT_TELEMETRY       BIT3
+
+static live_provision_hooks_t s_hooks;
+static bool s_hooks_set = false;
+static live_provision_request_t s_req;
+static live_provision_status_t s_status;
+static live_provision_report_cb_t s_report = NULL;
+static void *s_report_ctx = NULL;
+static volatile bool s_active = false;
+static int64_t s_t0_us = 0;
+static volatile uint8_t s_disconnect_reason = 0;
+static EventGroupHandle_t s_events = NULL;
+static SemaphoreHandle_t s_mutex = NULL;
+
+#define LOCK()      do { if (s_mutex) xSemaphoreTake(s_mutex, portMAX_DELAY); } while (0)
+#define UNLOCK()    do { if (s_mutex) xSemaphoreGive(s_mutex); } while (0)
+
+/**
+ * @brief 距收到凭据的毫秒数（至少为1，0表示未到达）
+ */
+static uint32_t elapsed_ms(void)
+{
+    uint32_t ms = (uint32_t)((esp_timer_get_time() - s_t0_us) / 1000);
+    return ms ? ms : 1;
+}
+
+static void set_stage(live_provision_stage_t stage, esp_err_t error, const char *message)
+{
+    live_provision_status_t snapshot;
+
+    LOCK();
+    s_status.stage = stage;
+    s_status.error = error;
+    strncpy(s_status.message, message, sizeof(s_status.message) - 1);
+    s_status.message[sizeof(s_status.message) - 1] = '\0';
+    snapshot = s_status;
+    UNLOCK();
+
+    if (stage == LIVE_PROVISION_FAILED || stage == LIVE_PROVISION_DEGRADED) {
+        ESP_LOGW(TAG, "❌ [%s] %s (%s)", live_provision_stage_name(stage), message, esp_err_to_name(error));
+    } else {
+        ESP_LOGI(TAG, "🔄 [%s] %s", live_provision_stage_name(stage), message);
+    }
+    if (s_report) {
+        s_report(&snapshot, s_report_ctx);
+    }
+}
+
+static void sta_event_handler(void *arg, esp_event_base_t event_base, int32_t event_id, void *event_data)
+{
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        wifi_event_sta_disconnected_t *ev = (wifi_event_sta_disconnected_t *)event_data;
+        s_disconnect_reason = ev ? ev->reason : 0;
+        xEventGroupSetBits(s_events, EVT_DISCONNECTED);
+    } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
+        xEventGroupSetBits(s_events, EVT_GOT_IP);
+    }
+}
+
+/**
+ * @brief 按断开原因判断是否值得重试（密码错误、找不到AP直接失败）
+ */
+static esp_err_t classify_disconnect(uint8_t reason)
+{
+    switch (reason) {
+        case WIFI_REASON_AUTH_FAIL:
+        case WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT:
+        case WIFI_REASON_HANDSHAKE_TIMEOUT:
+        case WIFI_REASON_MIC_FAILURE:
+            return ESP_ERR_WIFI_PASSWORD;
+        case WIFI_REASON_NO_AP_FOUND:
+            return ESP_ERR_WIFI_SSID;
+        default:
+            return ESP_OK;
+    }
+}
+
+/**
+ * @brief 用新凭据连接STA，热点保持（AP→AP+STA）
+ *
+ * 注意：STA连上的路由器与配网热点不在同一信道时，热点会跟随切换信道，
+ * 手机可能短暂掉线重连；BLE不受影响。
+ */
+static esp_err_t connect_sta(bool *ap_extended)
+{
+    // 配网模式（wifi_config_start）会销毁原STA接口
+    if (!esp_netif_get_handle_from_ifkey("WIFI_STA_DEF")) {
+        esp_netif_create_default_wifi_sta();
+    }
+
+    wifi_mode_t mode = WIFI_MODE_NULL;
+    esp_wifi_get_mode(&mode);
+    esp_err_t ret = ESP_OK;
+    if (mode == WIFI_MODE_AP) {
+        ret = esp_wifi_set_mode(WIFI_MODE_APSTA);
+        *ap_extended = true;
+    } else if (mode == WIFI_MODE_NULL) {
+        ret = esp_wifi_set_mode(WIFI_MODE_STA);
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    wifi_config_t wifi_config = {
+        .sta = {
+            .threshold.authmode = WIFI_AUTH_OPEN,   // 与启动流程一致：OPEN~WPA3自适应
+            .pmf_cfg = {
+                .capable = true,
+                .required = false
+            },
+            .scan_method = WIFI_ALL_CHANNEL_SCAN,
+        },
+    };
+    strncpy((char *)wifi_config.sta.ssid, s_req.ssid, sizeof(wifi_config.sta.ssid) - 1);
+    strncpy((char *)wifi_config.sta.password, s_req.password, sizeof(wifi_config.sta.password) - 1);
+
+    esp_wifi_disconnect();  // 重新配网时可能还连着旧网络
+    ret = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+    if (ret == ESP_OK) {
+        ret = esp_wifi_start();     // 已启动时直接返回ESP_OK
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    const int64_t deadline_us = esp_timer_get_time() + (int64_t)CONFIG_LIVE_PROVISION_WIFI_TIMEOUT_MS * 1000;
+    esp_err_t last = ESP_ERR_TIMEOUT;
+    for (int attempt = 1; attempt <= CONFIG_LIVE_PROVISION_WIFI_RETRY; attempt++) {
+        int64_t remaining_us = deadline_us - esp_timer_get_time();
+        if (remaining_us <= 0) {
+            break;
+        }
+        LOCK();
+        s_status.wifi_attempts = (uint8_t)attempt;
+        UNLOCK();
+
+        xEventGroupClearBits(s_events, EVT_GOT_IP | EVT_DISCONNECTED);
+        esp_wifi_connect();
+        EventBits_t bits = xEventGroupWaitBits(s_events, EVT_GOT_IP | EVT_DISCONNECTED, pdTRUE, pdFALSE,
+                                               pdMS_TO_TICKS(remaining_us / 1000));
+        if (bits & EVT_GOT_IP) {
+            return ESP_OK;
+        }
+        if (!(bits & EVT_DISCONNECTED)) {
+            return ESP_ERR_TIMEOUT;
+        }
+        ESP_LOGW(TAG, "⚠️ 连接断开（原因%u），第%d/%d次", s_disconnect_reason,
+                 attempt, CONFIG_LIVE_PROVISION_WIFI_RETRY);
+        last = classify_disconnect(s_disconnect_reason);
+        if (last != ESP_OK) {
+            return last;
+        }
+        last = ESP_FAIL;
+    }
+    return last;
+}
+
+static void rollback_sta(bool ap_extended)
+{
+    esp_wifi_disconnect();
+    if (ap_extended) {
+        esp_wifi_set_mode(WIFI_MODE_AP);
+    }
+}
+
+static const char *wifi_error_message(esp_err_t err)
+{
+    switch (err) {
+        case ESP_ERR_WIFI_PASSWORD: return "Wrong WiFi password";
+        case ESP_ERR_WIFI_SSID:     return "WiFi network not found";
+        case ESP_ERR_TIMEOUT:       return "WiFi connect timeout";
+        default:                    return "WiFi connect failed";
+    }
+}
+
+static const char *probe_error_message(esp_err_t err, const char *unreachable)
+{
+    return err == ESP_ERR_NOT_FOUND ? "Server name not resolved" : unreachable;
+}
+
+/**
+ * @brief 验证：配置服务器可达 -> 获取broker -> broker可达
+ */
+static esp_err_t verify_servers(const char **message)
+{
+    char host[LIVE_PROVISION_HOST_MAX];
+    uint16_t port = live_provision_parse_port(s_req.server_address);
+
+    set_stage(LIVE_PROVISION_VERIFYING, ESP_OK, "Checking config server");
+    esp_err_t ret = live_provision_parse_host(s_req.server_address, host, sizeof(host));
+    if (ret == ESP_OK) {
+        ret = port ? live_provision_probe_tcp(host, port, CONFIG_LIVE_PROVISION_PROBE_TIMEOUT_MS)
+                   : ESP_ERR_INVALID_ARG;
+    }
+    if (ret != ESP_OK) {
+        *message = probe_error_message(ret, "Config server unreachable");
+        return ret;
+    }
+    LOCK();
+    s_status.server_ms = elapsed_ms();
+    UNLOCK();
+
+    // broker以配置服务器下发的为准（MQTT客户端实际连接的地址），没有钩子时退回服务器主机
+    port = s_req.mqtt_port;
+    if (s_hooks.resolve_broker) {
+        set_stage(LIVE_PROVISION_VERIFYING, ESP_OK, "Fetching device config");
+        ret = s_hooks.resolve_broker(&s_req, host, sizeof(host), &port, s_hooks.ctx);
+        if (ret != ESP_OK) {
+            *message = ret == ESP_ERR_NOT_FOUND ? "Device not registered" : "Device config fetch failed";
+            return ret;
+        }
+    }
+
+    set_stage(LIVE_PROVISION_VERIFYING, ESP_OK, "Checking MQTT broker");
+    ret = live_provision_probe_tcp(host, port, CONFIG_LIVE_PROVISION_PROBE_TIMEOUT_MS);
+    if (ret != ESP_OK) {
+        *message = probe_error_message(ret, "MQTT broker unreachable");
+        return ret;
+    }
+    LOCK();
+    s_status.broker_ms = elapsed_ms();
+    UNLOCK();
+    return ESP_OK;
+}
+
+static void provision_task(void *arg)
+{
+    bool ap_extended = false;
+    esp_event_handler_instance_t wifi_handler = NULL;
+    esp_event_handler_instance_t ip_handler = NULL;
+    const char *message = NULL;
+
+    esp_event_handler_instance_register(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED,
+                                        &sta_event_handler, NULL, &wifi_handler);
+    esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
+                                        &sta_event_handler, NULL, &ip_handler);
+
+    // 1. 连接WiFi（热点/BLE保持在线）
+    set_stage(LIVE_PROVISION_CONNECTING, ESP_OK, "Connecting WiFi");
+    esp_err_t ret = connect_sta(&ap_extended);
+    if (ret != ESP_OK) {
+        rollback_sta(ap_extended);
+        set_stage(LIVE_PROVISION_FAILED, ret, wifi_error_message(ret));
+        goto done;
+    }
+    LOCK();
+    s_status.wifi_ms = elapsed_ms();
+    UNLOCK();
+
+    // 2. 探测配置服务器和MQTT broker
+    ret = verify_servers(&message);
+    if (ret != ESP_OK) {
+        rollback_sta(ap_extended);
+        set_stage(LIVE_PROVISION_FAILED, ret, message);
+        goto done;
+    }
+
+    // 3. 保存（验证通过后才写入）
+    ret = s_hooks.persist(&s_req, s_hooks.ctx);
+    if (ret != ESP_OK) {
+        rollback_sta(ap_extended);
+        set_stage(LIVE_PROVISION_FAILED, ret, "Save config failed");
+        goto done;
+    }
+
+    // 4. 交接：继续启动流程并启动MQTT客户端
+    set_stage(LIVE_PROVISION_HANDOFF, ESP_OK, "Starting MQTT");
+    ret = s_hooks.handoff(s_hooks.ctx);
+    if (ret != ESP_OK) {
+        // 配置已验证并保存，重启后按正常流程启动
+        set_stage(LIVE_PROVISION_FAILED, ret, "Startup failed after save");
+        goto done;
+    }
+
+    EventBits_t bits = xEventGroupWaitBits(s_events, EVT_MQTT, pdFALSE, pdFALSE,
+                                           pdMS_TO_TICKS(CONFIG_LIVE_PROVISION_MQTT_TIMEOUT_MS));
+    if (bits & EVT_MQTT) {
+        set_stage(LIVE_PROVISION_HANDOFF, ESP_OK, "MQTT connected");
+        bits = xEventGroupWaitBits(s_events, EVT_TELEMETRY, pdFALSE, pdFALSE,
+                                   pdMS_TO_TICKS(CONFIG_LIVE_PROVISION_TELEMETRY_TIMEOUT_MS));
+    }
+    if (bits & EVT_MQTT) {
+        set_stage(LIVE_PROVISION_ONLINE, ESP_OK,
+                  (bits & EVT_TELEMETRY) ? "Online" : "Online, telemetry pending");
+    } else {
+        // broker探测时可达，但MQTT没有连上（认证/TLS等），配置已保存，客户端继续重连
+        set_stage(LIVE_PROVISION_DEGRADED, ESP_ERR_TIMEOUT, "Saved, MQTT not connected");
+    }
+
+    LOCK();
+    live_provision_status_t st = s_status;
+    UNLOCK();
+    ESP_LOGI(TAG, "%s 配网结束: IP %lums, 服务器 %lums, broker %lums, MQTT %lums, 首条遥测 %lums (WiFi尝试%u次)",
+             st.stage == LIVE_PROVISION_ONLINE ? "✅" : "⚠️",
+             (unsigned long)st.wifi_ms, (unsigned long)st.server_ms, (unsigned long)st.broker_ms,
+             (unsigned long)st.mqtt_ms, (unsigned long)st.telemetry_ms, st.wifi_attempts);
+
+    // 5. 给手机留时间读取最终结果，再关闭配网热点
+    vTaskDelay(pdMS_TO_TICKS(CONFIG_LIVE_PROVISION_AP_LINGER_MS));
+    if (s_hooks.finish) {
+        s_hooks.finish(s_hooks.ctx);
+    }
+
+done:
+    esp_event_handler_instance_unregister(WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, wifi_handler);
+    esp_event_handler_instance_unregister(IP_EVENT, IP_EVENT_STA_GOT_IP, ip_handler);
+    s_active = false;
+    vTaskDelete(NULL);
+}
+
+void live_provision_set_hooks(const live_provision_hooks_t *hooks)
+{
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+    }
+    if (!s_events) {
+        s_events = xEventGroupCreate();
+    }
+    LOCK();
+    if (hooks && hooks->persist && hooks->handoff) {
+        s_hooks = *hooks;
+        s_hooks_set = true;
+    } else {
+        memset(&s_hooks, 0, sizeof(s_hooks));
+        s_hooks_set = false;
+    }
+    UNLOCK();
+}
+
+bool live_provision_is_ready(void)
+{
+    return s_hooks_set && s_mutex && s_events;
+}
+
+esp_err_t live_provision_start(const live_provision_request_t *req,
+                               live_provision_report_cb_t report, void *ctx)
+{
+    char host[LIVE_PROVISION_HOST_MAX];
+    if (!req || req->ssid[0] == '\0' ||
+        live_provision_parse_host(req->server_address, host, sizeof(host)) != ESP_OK ||
+        live_provision_parse_port(req->server_address) == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!live_provision_is_ready()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    LOCK();
+    if (s_active) {
+        UNLOCK();
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_active = true;
+    s_req = *req;
+    s_req.ssid[sizeof(s_req.ssid) - 1] = '\0';
+    s_req.password[sizeof(s_req.password) - 1] = '\0';
+    s_req.server_address[sizeof(s_req.server_address) - 1] = '\0';
+    if (s_req.mqtt_port == 0) {
+        s_req.mqtt_port = LIVE_PROVISION_DEFAULT_MQTT_PORT;
+    }
+    s_report = report;
+    s_report_ctx = ctx;
+    memset(&s_status, 0, sizeof(s_status));
+    s_t0_us = esp_timer_get_time();
+    UNLOCK();
+
+    xEventGroupClearBits(s_events, EVT_GOT_IP | EVT_DISCONNECTED | EVT_MQTT | EVT_TELEMETRY);
+
+    ESP_LOGI(TAG, "📡 开始配网: SSID=%s, 服务器=%s", s_req.ssid, s_req.server_address);
+    if (xTaskCreate(provision_task, "live_prov", CONFIG_LIVE_PROVISION_TASK_STACK,
+                    NULL, 5, NULL) != pdPASS) {
+        s_active = false;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+bool live_provision_is_active(void)
+{
+    return s_active;
+}
+
+void live_provision_get_status(live_provision_status_t *status)
+{
+    if (!status) {
+        return;
+    }
+    if (!s_mutex) {
+        memset(status, 0, sizeof(*status));
+        return;
+    }
+    LOCK();
+    *status = s_status;
+    UNLOCK();
+}
+
+void live_provision_mark(live_provision_mark_t mark)
+{
+    if (!s_active || !s_events) {
+        return;
+    }
+
+    EventBits_t bit = 0;
+    LOCK();
+    if (s_status.stage == LIVE_PROVISION_HANDOFF) {
+        if (mark == LIVE_PROVISION_MARK_MQTT && s_status.mqtt_ms == 0) {
+            s_status.mqtt_ms = elapsed_ms();
+            bit = EVT_MQTT;
+        } else if (mark == LIVE_PROVISION_MARK_TELEMETRY && s_status.mqtt_ms != 0 &&
+                   s_status.telemetry_ms == 0) {
+            s_status.telemetry_ms = elapsed_ms();
+            bit = EVT_TELEMETRY;
+        }
+    }
+    UNLOCK();
+
+    if (bit) {
+        xEventGroupSetBits(s_events, bit);
+    }
+}
@@ -0,0 +1,180 @@
+/**
+ * @file metrics.c
+ * @brief 运行时指标实现
+ *
+ * 指标登记在单向链表中（只插入不删除），更新全部是原子操作，
+ * 生成快照时只读取数值，不需要暂停更新方。
+ */
+
+#include "metrics.h"
+#include <stdio.h>
+#include <string.h>
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "json_writer.h"
+
+static const char *TAG = "METRICS";
+
+static metric_t *s_metrics = NULL;
+static int64_t s_last_snapshot_us = 0;
+
+void metrics_register(metric_t *metric)
+{
+    if (!metric || !metric->name) {
+        return;
+    }
+
+    for (metric_t *m = __atomic_load_n(&s_metrics, __ATOMIC_ACQUIRE); m; m = m->next) {
+        if (m == metric) {
+            return;
+        }
+    }
+
+    metric_t *head = __atomic_load_n(&s_metrics, __ATOMIC_ACQUIRE);
+    do {
+        metric->next = head;
+    } while (!__atomic_compare_exchange_n(&s_metrics, &head, metric, true,
+                                          __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+}
+
+void IRAM_ATTR metric_observe(metric_t *m, uint32_t v)
+{
+    uint8_t i = 0;
+    while (i < m->bucket_count && v > m->bounds[i]) {
+        i++;
+    }
+    __atomic_fetch_add(&m->buckets[i], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&m->sum, v, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&m->value, 1, __ATOMIC_RELAXED);
+
+    uint32_t cur = __atomic_load_n(&m->max, __ATOMIC_RELAXED);
+    while (v > cur &&
+           !__atomic_compare_exchange_n(&m->max, &cur, v, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+int64_t IRAM_ATTR metrics_now_us(void)
+{
+    return esp_timer_get_time();
+}
+
+metric_t *metrics_find(const char *name)
+{
+    if (!name) {
+        return NULL;
+    }
+    for (metric_t *m = __atomic_load_n(&s_metrics, __ATOMIC_ACQUIRE); m; m = m->next) {
+        if (strcmp(m->name, name) == 0) {
+            return m;
+        }
+    }
+    return NULL;
+}
+
+size_t metrics_count(void)
+{
+    size_t n = 0;
+    for (metric_t *m = __atomic_load_n(&s_metrics, __ATOMIC_ACQUIRE); m; m = m->next) {
+        n++;
+    }
+    return n;
+}
+
+/* ==================== 快照 ==================== */
+
+// 输出同一类型的标量指标（计数器或仪表）
+static void write_scalar_section(json_writer_t *w, const char *key, metric_type_t type)
+{
+    bool first = true;
+    json_writer_printf(w, ",\"%s\":{", key);
+    for (metric_t *m = __atomic_load_n(&s_metrics, __ATOMIC_ACQUIRE); m; m = m->next) {
+        if (m->type != type) {
+            continue;
+        }
+        json_writer_printf(w, "%s\"%s\":%ld", first ? "" : ",", m->name,
+                  (long)__atomic_load_n(&m->value, __ATOMIC_RELAXED));
+        first = false;
+    }
+    json_writer_printf(w, "}");
+}
+
+// 输出一个直方图；写入成功后从窗口中扣除已上报的样本（期间新增的样本保留）
+static void write_histogram(json_writer_t *w, metric_t *m, bool first)
+{
+    uint32_t buckets[METRICS_MAX_BUCKETS + 1];
+    uint32_t n = (uint32_t)__atomic_load_n(&m->value, __ATOMIC_RELAXED);
+    uint32_t sum = __atomic_load_n(&m->sum, __ATOMIC_RELAXED);
+    uint32_t max = __atomic_load_n(&m->max, __ATOMIC_RELAXED);
+    for (uint8_t i = 0; i <= m->bucket_count; i++) {
+        buckets[i] = __atomic_load_n(&m->buckets[i], __ATOMIC_RELAXED);
+    }
+
+    size_t mark = w->len;
+    json_writer_printf(w, "%s\"%s\":{\"n\":%lu,\"sum\":%lu,\"max\":%lu,\"le\":[", first ? "" : ",",
+              m->name, (unsigned long)n, (unsigned long)sum, (unsigned long)max);
+    for (uint8_t i = 0; i < m->bucket_count; i++) {
+        json_writer_printf(w, "%s%lu", i ? "," : "", (unsigned long)m->bounds[i]);
+    }
+    json_writer_printf(w, "],\"b\":[");
+    for (uint8_t i = 0; i <= m->bucket_count; i++) {
+        json_writer_printf(w, "%s%lu", i ? "," : "", (unsigned long)buckets[i]);
+    }
+    json_writer_printf(w, "]}");
+
+    if (w->overflow) {
+        json_writer_rewind(w, mark);
+        return;
+    }
+
+    __atomic_fetch_sub(&m->value, (int32_t)n, __ATOMIC_RELAXED);
+    __atomic_fetch_sub(&m->sum, sum, __ATOMIC_RELAXED);
+    for (uint8_t i = 0; i <= m->bucket_count; i++) {
+        __atomic_fetch_sub(&m->buckets[i], buckets[i], __ATOMIC_RELAXED);
+    }
+    // 最大值无法扣除，窗口结束时直接清零（期间的并发样本可能丢失最大值）
+    __atomic_store_n(&m->max, 0, __ATOMIC_RELAXED);
+}
+
+esp_err_t metrics_snapshot_json(char *buf, size_t buf_size, size_t *out_len)
+{
+    if (!buf || buf_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    json_writer_t w;
+    json_writer_init(&w, buf, buf_size);
+    int64_t now_us = esp_timer_get_time();
+    uint32_t window = (uint32_t)((now_us - s_last_snapshot_us) / 1000000);
+
+    json_writer_printf(&w, "{\"uptime\":%lu,\"window\":%lu",
+              (unsigned long)(now_us / 1000000), (unsigned long)window);
+    write_scalar_section(&w, "c", METRIC_TYPE_COUNTER);
+    write_scalar_section(&w, "g", METRIC_TYPE_GAUGE);
+
+    json_writer_printf(&w, ",\"h\":{");
+    bool first = true;
+    for (metric_t *m = __atomic_load_n(&s_metrics, __ATOMIC_ACQUIRE); m; m = m->next) {
+        if (m->type != METRIC_TYPE_HISTOGRAM) {
+            continue;
+        }
+        write_histogram(&w, m, first);
+        if (w.overflow) {
+            break;
+        }
+        first = false;
+    }
+    json_writer_printf(&w, "}}");
+
+    if (w.overflow) {
+        ESP_LOGW(TAG, "⚠️ 指标快照超出缓冲区(%u字节)，请增大 CONFIG_METRICS_SNAPSHOT_BUF_SIZE",
+                 (unsigned)buf_size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    s_last_snapshot_us = now_us;
+    if (out_len) {
+        *out_len = w.len;
+    }
+    return ESP_OK;
+}
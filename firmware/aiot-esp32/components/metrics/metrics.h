@@ -0,0 +1,204 @@
+/**
+ * @file metrics.h
+ * @brief 运行时指标（计数器、仪表、延迟直方图）
+ *
+ * 各模块用 METRIC_*_DEFINE 宏静态定义指标，启动时自动登记到全局链表，
+ * 不需要集中注册。更新操作只是一次原子加/写，可在任务和中断中调用。
+ *
+ * 快照语义：
+ * - 计数器：开机以来的累计值（服务端求差得到速率）
+ * - 仪表：最近一次设置的值
+ * - 直方图：上次快照以来的窗口统计，生成快照后清零
+ *
+ * 快照以紧凑JSON发布到 devices/<uuid>/metrics，格式：
+ *   {"uptime":123,"window":60,
+ *    "c":{"sensor_read_fail":3},
+ *    "g":{"wifi_rssi":-61},
+ *    "h":{"mqtt_puback_ms":{"n":12,"sum":340,"max":80,"le":[10,50,100],"b":[2,9,1,0]}}}
+ * 其中b比le多一个桶，最后一个桶为超过最大上界的样本数。
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_METRICS_PUBLISH_INTERVAL_SEC
+#define CONFIG_METRICS_PUBLISH_INTERVAL_SEC 60
+#endif
+
+#ifndef CONFIG_METRICS_SNAPSHOT_BUF_SIZE
+#define CONFIG_METRICS_SNAPSHOT_BUF_SIZE    1536
+#endif
+
+#define METRICS_MAX_BUCKETS                 12      ///< 直方图最多上界个数
+
+/**
+ * @brief 指标类型
+ */
+typedef enum {
+    METRIC_TYPE_COUNTER = 0,       ///< 单调递增计数器
+    METRIC_TYPE_GAUGE,             ///< 瞬时值
+    METRIC_TYPE_HISTOGRAM,         ///< 固定桶直方图
+} metric_type_t;
+
+/**
+ * @brief 指标（通过METRIC_*_DEFINE宏定义，不要直接初始化）
+ */
+typedef struct metric {
+    const char *name;              ///< 指标名（snake_case，带单位后缀，如 _ms/_us）
+    metric_type_t type;            ///< 类型
+    uint8_t bucket_count;          ///< 直方图上界个数
+    const uint32_t *bounds;        ///< 直方图桶上界（升序，含等于）
+    uint32_t *buckets;             ///< 直方图桶计数（bucket_count + 1个）
+    volatile int32_t value;        ///< 计数器/仪表值；直方图为样本数
+    volatile uint32_t sum;         ///< 直方图样本和
+    volatile uint32_t max;         ///< 直方图最大样本
+    struct metric *next;           ///< 登记链表
+} metric_t;
+
+/**
+ * @brief 登记指标（METRIC_*_DEFINE宏在启动时自动调用）
+ *
+ * 使用无锁链表插入，可在任何阶段调用；重复登记同一指标会被忽略。
+ *
+ * @param metric 指标，必须是静态存储
+ */
+void metrics_register(metric_t *metric);
+
+#define _METRIC_REGISTER(var) \
+    static void __attribute__((constructor)) _metric_register_##var(void) { metrics_register(&var); }
+
+/**
+ * @brief 定义计数器
+ *
+ * 示例：METRIC_COUNTER_DEFINE(s_read_fail, "sensor_read_fail");
+ */
+#define METRIC_COUNTER_DEFINE(var, metric_name) \
+    static metric_t var = { .name = (metric_name), .type = METRIC_TYPE_COUNTER }; \
+    _METRIC_REGISTER(var)
+
+/**
+ * @brief 定义仪表
+ */
+#define METRIC_GAUGE_DEFINE(var, metric_name) \
+    static metric_t var = { .name = (metric_name), .type = METRIC_TYPE_GAUGE }; \
+    _METRIC_REGISTER(var)
+
+/**
+ * @brief 定义直方图，变参为升序的桶上界
+ *
+ * 示例：METRIC_HISTOGRAM_DEFINE(s_flush_us, "display_flush_us", 500, 1000, 2000, 5000, 10000);
+ */
+#define METRIC_HISTOGRAM_DEFINE(var, metric_name, ...) \
+    static const uint32_t _metric_bounds_##var[] = { __VA_ARGS__ }; \
+    _Static_assert(sizeof(_metric_bounds_##var) / sizeof(uint32_t) <= METRICS_MAX_BUCKETS, \
+                   "too many histogram buckets"); \
+    static uint32_t _metric_buckets_##var[sizeof(_metric_bounds_##var) / sizeof(uint32_t) + 1]; \
+    static metric_t var = { \
+        .name = (metric_name), \
+        .type = METRIC_TYPE_HISTOGRAM, \
+        .bucket_count = sizeof(_metric_bounds_##var) / sizeof(uint32_t), \
+        .bounds = _metric_bounds_##var, \
+        .buckets = _metric_buckets_##var, \
+    }; \
+    _METRIC_REGISTER(var)
+
+/* ==================== 更新（可在中断中调用） ==================== */
+
+static inline void metric_add(metric_t *m, int32_t n)
+{
+    __atomic_fetch_add(&m->value, n, __ATOMIC_RELAXED);
+}
+
+static inline void metric_inc(metric_t *m)
+{
+    metric_add(m, 1);
+}
+
+static inline void metric_set(metric_t *m, int32_t v)
+{
+    __atomic_store_n(&m->value, v, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 仪表只在新值更大时更新（高水位）
+ */
+static inline void metric_set_max(metric_t *m, int32_t v)
+{
+    int32_t cur = __atomic_load_n(&m->value, __ATOMIC_RELAXED);
+    while (v > cur &&
+           !__atomic_compare_exchange_n(&m->value, &cur, v, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+/**
+ * @brief 记录一个直方图样本
+ *
+ * 函数位于IRAM，可在中断中调用。
+ *
+ * @param m 直方图指标
+ * @param v 样本值（单位与指标名后缀一致）
+ */
+void metric_observe(metric_t *m, uint32_t v);
+
+/**
+ * @brief 获取当前时间戳（微秒），配合 metric_observe_since_us() 计时
+ */
+int64_t metrics_now_us(void);
+
+/**
+ * @brief 记录从start_us到现在的耗时（微秒）
+ */
+static inline void metric_observe_since_us(metric_t *m, int64_t start_us)
+{
+    metric_observe(m, (uint32_t)(metrics_now_us() - start_us));
+}
+
+/**
+ * @brief 记录从start_us到现在的耗时（毫秒）
+ */
+static inline void metric_observe_since_ms(metric_t *m, int64_t start_us)
+{
+    metric_observe(m, (uint32_t)((metrics_now_us() - start_us) / 1000));
+}
+
+/* ==================== 快照 ==================== */
+
+/**
+ * @brief 生成紧凑JSON快照（格式见文件头），并清零直方图窗口
+ *
+ * @param buf 输出缓冲区
+ * @param buf_size 缓冲区大小
+ * @param out_len 输出JSON长度（可为NULL）
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_SIZE: 缓冲区不足（已写入快照的直方图照常清零，其余保留到下次）
+ */
+esp_err_t metrics_snapshot_json(char *buf, size_t buf_size, size_t *out_len);
+
+/**
+ * @brief 按名称查找指标
+ *
+ * @param name 指标名
+ * @return metric_t* 未找到返回NULL
+ */
+metric_t *metrics_find(const char *name);
+
+/**
+ * @brief 已登记的指标个数
+ */
+size_t metrics_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // METRICS_H
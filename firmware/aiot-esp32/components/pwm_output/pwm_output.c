@@ -0,0 +1,50 @@
+/**
+ * @file pwm_output.c
+ * @brief PWM输出层：定点占空比换算与舵机查找表（只做计算，不访问LEDC）
+ */
+
+#include "pwm_output.h"
+#include <stddef.h>
+
+uint32_t pwm_output_duty_permyriad(uint32_t permyriad, uint8_t resolution)
+{
+    uint32_t max_duty = (1u << resolution) - 1;
+    if (permyriad >= PWM_OUTPUT_PERMYRIAD_MAX) {
+        return max_duty;
+    }
+    return (permyriad * max_duty + PWM_OUTPUT_PERMYRIAD_MAX / 2) / PWM_OUTPUT_PERMYRIAD_MAX;
+}
+
+esp_err_t pwm_servo_table_init(pwm_servo_table_t *table, uint32_t min_pulse_us, uint32_t max_pulse_us,
+                               uint16_t max_angle, uint32_t frequency, uint8_t resolution)
+{
+    if (!table || max_angle == 0 || max_angle > CONFIG_PWM_OUTPUT_SERVO_MAX_ANGLE || frequency == 0 ||
+        resolution == 0 || resolution > PWM_SERVO_TABLE_MAX_RES || max_pulse_us < min_pulse_us ||
+        (uint64_t)max_pulse_us * frequency > 1000000) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // duty_q(d) = (min·A + (max-min)·d) · 满量程 · 8 · f / (A · 10^6)，A = max_angle
+    uint64_t scale = (uint64_t)((1u << resolution) - 1) * (1u << PWM_SERVO_TABLE_FRAC) * frequency;
+    uint64_t den = (uint64_t)max_angle * 1000000;
+    for (uint16_t d = 0; d <= max_angle; d++) {
+        uint64_t pulse_a = (uint64_t)min_pulse_us * max_angle + (uint64_t)(max_pulse_us - min_pulse_us) * d;
+        table->duty_q[d] = (uint16_t)((pulse_a * scale + den / 2) / den);
+    }
+    table->max_angle = max_angle;
+    return ESP_OK;
+}
+
+uint32_t pwm_servo_table_duty(const pwm_servo_table_t *table, uint32_t centideg)
+{
+    uint32_t deg = centideg / 100;
+    if (deg >= table->max_angle) {
+        return ((uint32_t)table->duty_q[table->max_angle] + (1u << (PWM_SERVO_TABLE_FRAC - 1))) >> PWM_SERVO_TABLE_FRAC;
+    }
+    // 相邻两项之间按0.01度线性插值，再去掉小数位（四舍五入）
+    uint32_t frac = centideg % 100;
+    uint32_t lo = table->duty_q[deg];
+    uint32_t hi = table->duty_q[deg + 1];
+    uint32_t q = lo * 100 + (hi - lo) * frac;
+    return (q + 50 * (1u << PWM_SERVO_TABLE_FRAC)) / (100 * (1u << PWM_SERVO_TABLE_FRAC));
+}
@@ -0,0 +1,143 @@
+/**
+ * @file pwm_output.h
+ * @brief PWM输出层：定点占空比换算、舵机角度->占空比查找表、多通道同帧锁存
+ *
+ * 原来每次写PWM都要做浮点/双精度换算（pwm_control 的 duty_cycle / 100.0，舵机的脉宽除法），
+ * 多个通道依次 ledc_set_duty + ledc_update_duty，中间还夹着日志，同一时刻要变化的几路输出
+ * 实际生效时间相差明显。本组件：
+ *
+ * - 占空比按万分比整数换算，四舍五入，不用浮点；
+ * - 每个舵机按 hal_servo_config_t 的参数预先生成"整度 -> 占空比"查找表（1/8 LSB定点），
+ *   运行时按0.01度在相邻两项之间插值，只有一次乘法和一次常数除法；
+ * - 帧：pwm_output_frame_begin() 之后本任务的 pwm_output_write() 只暂存，
+ *   pwm_output_frame_commit() 先把所有通道的占空比写入寄存器，再连续发出更新，
+ *   各通道在各自下一个PWM周期同时生效。其他任务的写入不受影响，立即生效。
+ *
+ * 换算和查找表是纯计算，可在主机上和双精度参考比较；LEDC运行时在 pwm_output_ledc.c 中。
+ */
+
+#ifndef PWM_OUTPUT_H
+#define PWM_OUTPUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_PWM_OUTPUT_FRAME_MAX
+#define CONFIG_PWM_OUTPUT_FRAME_MAX         8
+#endif
+
+#ifndef CONFIG_PWM_OUTPUT_SERVO_MAX_ANGLE
+#define CONFIG_PWM_OUTPUT_SERVO_MAX_ANGLE   180
+#endif
+
+#define PWM_OUTPUT_PERMYRIAD_MAX    10000   ///< 万分比满量程
+#define PWM_SERVO_TABLE_FRAC        3       ///< 查找表小数位（1/8 LSB）
+#define PWM_SERVO_TABLE_MAX_RES     13      ///< 查找表支持的最大分辨率（8191 << 3 仍在uint16内）
+
+/**
+ * @brief 舵机角度->占空比查找表（每整度一项）
+ */
+typedef struct {
+    uint16_t max_angle;                                         ///< 最大角度（度）
+    uint16_t duty_q[CONFIG_PWM_OUTPUT_SERVO_MAX_ANGLE + 1];     ///< 占空比 << PWM_SERVO_TABLE_FRAC
+} pwm_servo_table_t;
+
+/**
+ * @brief 万分比（0-10000）转换为占空比（四舍五入）
+ *
+ * @param permyriad 占空比万分比，超出按满量程
+ * @param resolution 占空比位数
+ */
+uint32_t pwm_output_duty_permyriad(uint32_t permyriad, uint8_t resolution);
+
+/**
+ * @brief 百分比占空比转换为万分比（API边界上唯一的一次浮点运算）
+ */
+static inline uint32_t pwm_output_percent_to_permyriad(float percent)
+{
+    if (percent <= 0.0f) {
+        return 0;
+    }
+    return percent >= 100.0f ? PWM_OUTPUT_PERMYRIAD_MAX : (uint32_t)(percent * 100.0f + 0.5f);
+}
+
+/**
+ * @brief 按舵机参数生成查找表
+ *
+ * 第d项 = round(脉宽(d) / 周期 * 满量程 * 8)，脉宽(d) = min + (max - min) * d / max_angle，
+ * 全程64位整数运算。
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 参数错误、max_angle超过 CONFIG_PWM_OUTPUT_SERVO_MAX_ANGLE
+ *     或分辨率超过 PWM_SERVO_TABLE_MAX_RES
+ */
+esp_err_t pwm_servo_table_init(pwm_servo_table_t *table, uint32_t min_pulse_us, uint32_t max_pulse_us,
+                               uint16_t max_angle, uint32_t frequency, uint8_t resolution);
+
+/**
+ * @brief 查表得到0.01度对应的占空比（超出最大角度按最大角度）
+ */
+uint32_t pwm_servo_table_duty(const pwm_servo_table_t *table, uint32_t centideg);
+
+/* ==================== LEDC运行时 ==================== */
+
+/**
+ * @brief 运行统计
+ */
+typedef struct {
+    uint32_t writes;                ///< 立即生效的写入次数
+    uint32_t staged;                ///< 暂存到帧里的写入次数（同一通道多次写入只保留最后一次）
+    uint32_t commits;               ///< 提交的帧数
+    uint32_t max_frame_channels;    ///< 单帧最多锁存的通道数
+} pwm_output_stats_t;
+
+/**
+ * @brief 初始化（创建锁）；未初始化时 pwm_output_write() 直接写入，不支持帧
+ *
+ * @return ESP_OK（重复调用也返回ESP_OK）或 ESP_ERR_NO_MEM
+ */
+esp_err_t pwm_output_init(void);
+
+/**
+ * @brief 写一个LEDC通道的占空比
+ *
+ * 本任务打开了帧时暂存到帧里，否则立即 ledc_set_duty + ledc_update_duty。
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_NO_MEM: 帧里的通道数已达 CONFIG_PWM_OUTPUT_FRAME_MAX
+ *   - 其他: LEDC驱动返回的错误
+ */
+esp_err_t pwm_output_write(uint8_t speed_mode, uint8_t channel, uint32_t duty);
+
+/**
+ * @brief 打开帧（可嵌套；其他任务已打开帧时等待其提交）
+ */
+esp_err_t pwm_output_frame_begin(void);
+
+/**
+ * @brief 提交帧：最外层提交时所有暂存通道一起锁存
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_STATE: 本任务没有打开帧
+ *   - 其他: LEDC驱动返回的第一个错误（其余通道仍会写入）
+ */
+esp_err_t pwm_output_frame_commit(void);
+
+/**
+ * @brief 获取运行统计
+ */
+esp_err_t pwm_output_get_stats(pwm_output_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PWM_OUTPUT_H
@@ -0,0 +1,183 @@
+/**
+ * @file pwm_output_ledc.c
+ * @brief PWM输出层运行时：立即写入或按帧暂存，提交时所有通道连续更新一起锁存
+ *
+ * LEDC的 ledc_set_duty 只写影子寄存器，ledc_update_duty 之后在通道下一个PWM周期开始时生效。
+ * 提交帧时先写完所有通道的影子寄存器，再连续发出更新，中间没有换算和日志，
+ * 同一定时器上的通道在同一个周期生效。
+ */
+
+#include "pwm_output.h"
+#include "driver/ledc.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "pwm_output";
+
+#define LOCK()      xSemaphoreTake(s_mutex, portMAX_DELAY)
+#define UNLOCK()    xSemaphoreGive(s_mutex)
+
+typedef struct {
+    uint8_t mode;
+    uint8_t channel;
+    uint32_t duty;
+} staged_duty_t;
+
+static SemaphoreHandle_t s_mutex = NULL;        ///< 保护帧内容和统计
+static SemaphoreHandle_t s_frame_mutex = NULL;  ///< 帧的所有权（同一时间只有一个任务打开帧）
+static TaskHandle_t s_frame_owner = NULL;
+static uint8_t s_frame_depth = 0;
+static staged_duty_t s_frame[CONFIG_PWM_OUTPUT_FRAME_MAX];
+static uint8_t s_frame_count = 0;
+static pwm_output_stats_t s_stats;
+
+static esp_err_t write_now(uint8_t mode, uint8_t channel, uint32_t duty)
+{
+    esp_err_t ret = ledc_set_duty((ledc_mode_t)mode, (ledc_channel_t)channel, duty);
+    if (ret == ESP_OK) {
+        ret = ledc_update_duty((ledc_mode_t)mode, (ledc_channel_t)channel);
+    }
+    return ret;
+}
+
+esp_err_t pwm_output_init(void)
+{
+    if (s_mutex) {
+        return ESP_OK;
+    }
+    s_mutex = xSemaphoreCreateMutex();
+    s_frame_mutex = xSemaphoreCreateMutex();
+    if (!s_mutex || !s_frame_mutex) {
+        if (s_mutex) {
+            vSemaphoreDelete(s_mutex);
+            s_mutex = NULL;
+        }
+        if (s_frame_mutex) {
+            vSemaphoreDelete(s_frame_mutex);
+            s_frame_mutex = NULL;
+        }
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "✅ PWM输出层初始化: 每帧最多 %d 个通道", CONFIG_PWM_OUTPUT_FRAME_MAX);
+    return ESP_OK;
+}
+
+esp_err_t pwm_output_write(uint8_t speed_mode, uint8_t channel, uint32_t duty)
+{
+    if (!s_mutex) {
+        // BSP初始化阶段（输出层尚未初始化）：直接写入
+        return write_now(speed_mode, channel, duty);
+    }
+
+    LOCK();
+    if (s_frame_owner != xTaskGetCurrentTaskHandle()) {
+        s_stats.writes++;
+        UNLOCK();
+        return write_now(speed_mode, channel, duty);
+    }
+
+    esp_err_t ret = ESP_OK;
+    uint8_t i = 0;
+    while (i < s_frame_count && (s_frame[i].mode != speed_mode || s_frame[i].channel != channel)) {
+        i++;
+    }
+    if (i < s_frame_count) {
+        s_frame[i].duty = duty;             // 同一通道在帧内多次写入，保留最后一次
+        s_stats.staged++;
+    } else if (s_frame_count < CONFIG_PWM_OUTPUT_FRAME_MAX) {
+        s_frame[s_frame_count++] = (staged_duty_t){ .mode = speed_mode, .channel = channel, .duty = duty };
+        s_stats.staged++;
+    } else {
+        ret = ESP_ERR_NO_MEM;
+    }
+    UNLOCK();
+    return ret;
+}
+
+esp_err_t pwm_output_frame_begin(void)
+{
+    if (!s_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    LOCK();
+    if (s_frame_owner == self) {
+        s_frame_depth++;
+        UNLOCK();
+        return ESP_OK;
+    }
+    UNLOCK();
+
+    // 其他任务的帧提交后才能打开
+    xSemaphoreTake(s_frame_mutex, portMAX_DELAY);
+    LOCK();
+    s_frame_owner = self;
+    s_frame_depth = 1;
+    s_frame_count = 0;
+    UNLOCK();
+    return ESP_OK;
+}
+
+esp_err_t pwm_output_frame_commit(void)
+{
+    if (!s_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    LOCK();
+    if (s_frame_owner != xTaskGetCurrentTaskHandle()) {
+        UNLOCK();
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (--s_frame_depth > 0) {
+        UNLOCK();
+        return ESP_OK;
+    }
+
+    // 先写完所有影子寄存器，再连续发出更新
+    esp_err_t ret = ESP_OK;
+    for (uint8_t i = 0; i < s_frame_count; i++) {
+        esp_err_t err = ledc_set_duty((ledc_mode_t)s_frame[i].mode, (ledc_channel_t)s_frame[i].channel,
+                                      s_frame[i].duty);
+        if (err != ESP_OK && ret == ESP_OK) {
+            ret = err;
+        }
+    }
+    for (uint8_t i = 0; i < s_frame_count; i++) {
+        esp_err_t err = ledc_update_duty((ledc_mode_t)s_frame[i].mode, (ledc_channel_t)s_frame[i].channel);
+        if (err != ESP_OK && ret == ESP_OK) {
+            ret = err;
+        }
+    }
+
+    s_stats.commits++;
+    if (s_frame_count > s_stats.max_frame_channels) {
+        s_stats.max_frame_channels = s_frame_count;
+    }
+    s_frame_count = 0;
+    s_frame_owner = NULL;
+    UNLOCK();
+    xSemaphoreGive(s_frame_mutex);
+
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ 帧提交时LEDC返回错误: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+esp_err_t pwm_output_get_stats(pwm_output_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    LOCK();
+    *stats = s_stats;
+    UNLOCK();
+    return ESP_OK;
+}
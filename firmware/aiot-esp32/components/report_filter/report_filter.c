@@ -0,0 +1,262 @@
+/**
+ * @file report_filter.c
+ * @brief 遥测按变化上报实现
+ *
+ * 策略和上次发布记录放在同一个定长数组中，线性查找（传感器数很少）。
+ */
+
+#include "report_filter.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+#include "json_writer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "REPORT_FILTER";
+
+/**
+ * @brief 策略及上次发布记录
+ */
+typedef struct {
+    report_policy_t policy;
+    bool has_last;                 ///< 是否已发布过
+    uint8_t last_count;            ///< 上次发布的通道数
+    float last_values[REPORT_FILTER_MAX_CHANNELS];
+    uint32_t last_ms;              ///< 上次发布时间
+} policy_slot_t;
+
+static policy_slot_t s_slots[REPORT_FILTER_MAX_POLICIES];
+static size_t s_slot_count = 0;
+static bool s_enabled = REPORT_FILTER_DEFAULT_ENABLED;
+static report_filter_stats_t s_stats;
+static SemaphoreHandle_t s_mutex = NULL;
+
+#define LOCK()      do { if (s_mutex) xSemaphoreTake(s_mutex, portMAX_DELAY); } while (0)
+#define UNLOCK()    do { if (s_mutex) xSemaphoreGive(s_mutex); } while (0)
+
+static const char *s_reason_names[] = { "skip", "first", "changed", "max_interval", "always" };
+
+const char *report_filter_reason_name(report_reason_t reason)
+{
+    return (size_t)reason < sizeof(s_reason_names) / sizeof(s_reason_names[0]) ? s_reason_names[reason] : "unknown";
+}
+
+esp_err_t report_filter_init(void)
+{
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+void report_filter_set_enabled(bool enabled)
+{
+    LOCK();
+    if (s_enabled != enabled) {
+        // 重新启用时从头开始，避免用很久以前的发布值做比较
+        for (size_t i = 0; i < s_slot_count; i++) {
+            s_slots[i].has_last = false;
+        }
+    }
+    s_enabled = enabled;
+    UNLOCK();
+    ESP_LOGI(TAG, "📉 按变化上报: %s", enabled ? "启用" : "关闭");
+}
+
+bool report_filter_is_enabled(void)
+{
+    return s_enabled;
+}
+
+esp_err_t report_filter_policy_validate(const report_policy_t *policy)
+{
+    if (!policy) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!(policy->deadband_abs >= 0.0f && isfinite(policy->deadband_abs)) ||
+        !(policy->deadband_pct >= 0.0f && isfinite(policy->deadband_pct))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (policy->max_interval_sec != 0 && policy->max_interval_sec < policy->min_interval_sec) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+static policy_slot_t *find_slot(uint8_t sensor)
+{
+    for (size_t i = 0; i < s_slot_count; i++) {
+        if (s_slots[i].policy.sensor == sensor) {
+            return &s_slots[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t report_filter_set_policy(const report_policy_t *policy)
+{
+    esp_err_t err = report_filter_policy_validate(policy);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    LOCK();
+    policy_slot_t *slot = find_slot(policy->sensor);
+    if (!slot && s_slot_count < REPORT_FILTER_MAX_POLICIES) {
+        slot = &s_slots[s_slot_count++];
+    }
+    if (slot) {
+        memset(slot, 0, sizeof(*slot));
+        slot->policy = *policy;
+        memset(slot->policy.reserved, 0, sizeof(slot->policy.reserved));
+    }
+    UNLOCK();
+
+    if (!slot) {
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "📉 上报策略已设置: 传感器%u 死区%.2f/%.1f%% 间隔%lu~%lus",
+             policy->sensor, policy->deadband_abs, policy->deadband_pct,
+             (unsigned long)policy->min_interval_sec, (unsigned long)policy->max_interval_sec);
+    return ESP_OK;
+}
+
+esp_err_t report_filter_get_policy(uint8_t sensor, report_policy_t *out)
+{
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+
+    LOCK();
+    policy_slot_t *slot = find_slot(sensor);
+    if (slot) {
+        if (out) {
+            *out = slot->policy;
+        }
+        err = ESP_OK;
+    }
+    UNLOCK();
+    return err;
+}
+
+size_t report_filter_get_policies(report_policy_t *out)
+{
+    size_t count;
+
+    LOCK();
+    count = s_slot_count;
+    for (size_t i = 0; out && i < count; i++) {
+        out[i] = s_slots[i].policy;
+    }
+    UNLOCK();
+    return count;
+}
+
+/**
+ * @brief 某个通道是否超出死区
+ */
+static bool outside_deadband(const report_policy_t *p, float last, float value)
+{
+    float delta = fabsf(value - last);
+    if (p->deadband_abs <= 0.0f && p->deadband_pct <= 0.0f) {
+        return delta > 0.0f;
+    }
+    if (p->deadband_abs > 0.0f && delta > p->deadband_abs) {
+        return true;
+    }
+    return p->deadband_pct > 0.0f && delta > fabsf(last) * p->deadband_pct / 100.0f;
+}
+
+report_reason_t report_filter_check(uint8_t sensor, const float *values, size_t count, uint32_t now_ms)
+{
+    report_reason_t reason = REPORT_SKIP;
+
+    if (count > REPORT_FILTER_MAX_CHANNELS) {
+        count = REPORT_FILTER_MAX_CHANNELS;
+    }
+
+    LOCK();
+    policy_slot_t *slot = s_enabled ? find_slot(sensor) : NULL;
+    if (!slot) {
+        reason = REPORT_ALWAYS;
+    } else if (!slot->has_last || slot->last_count != count) {
+        reason = REPORT_FIRST;
+    } else {
+        const report_policy_t *p = &slot->policy;
+        uint32_t elapsed_ms = now_ms - slot->last_ms;
+        bool changed = false;
+        for (size_t i = 0; i < count && !changed; i++) {
+            // NaN（读取失败的通道）与上次的有效值相比视为变化
+            changed = isfinite(values[i]) != isfinite(slot->last_values[i]) ||
+                      (isfinite(values[i]) && outside_deadband(p, slot->last_values[i], values[i]));
+        }
+        if (changed && elapsed_ms >= p->min_interval_sec * 1000U) {
+            reason = REPORT_CHANGED;
+        } else if (p->max_interval_sec != 0 && elapsed_ms >= p->max_interval_sec * 1000U) {
+            reason = REPORT_MAX_INTERVAL;
+        }
+    }
+    if (reason == REPORT_SKIP) {
+        s_stats.suppressed++;
+    } else if (reason == REPORT_MAX_INTERVAL) {
+        s_stats.heartbeats++;
+    }
+    UNLOCK();
+    return reason;
+}
+
+void report_filter_commit(uint8_t sensor, const float *values, size_t count, uint32_t now_ms)
+{
+    if (count > REPORT_FILTER_MAX_CHANNELS) {
+        count = REPORT_FILTER_MAX_CHANNELS;
+    }
+
+    LOCK();
+    s_stats.published++;
+    policy_slot_t *slot = find_slot(sensor);
+    if (slot) {
+        slot->has_last = true;
+        slot->last_count = (uint8_t)count;
+        memcpy(slot->last_values, values, count * sizeof(float));
+        slot->last_ms = now_ms;
+    }
+    UNLOCK();
+}
+
+void report_filter_get_stats(report_filter_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    LOCK();
+    *stats = s_stats;
+    UNLOCK();
+}
+
+esp_err_t report_filter_status_json(char *buf, size_t buf_size, size_t *out_len)
+{
+    if (!buf || buf_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    json_writer_t w;
+    json_writer_init(&w, buf, buf_size);
+
+    LOCK();
+    json_writer_printf(&w, "{\"enabled\":%s,\"policies\":[", s_enabled ? "true" : "false");
+    for (size_t i = 0; i < s_slot_count; i++) {
+        const report_policy_t *p = &s_slots[i].policy;
+        json_writer_printf(&w, "%s{\"sensor\":%u,\"deadband\":%g,\"deadband_pct\":%g,"
+                           "\"min_interval\":%lu,\"max_interval\":%lu}",
+                           i ? "," : "", p->sensor, (double)p->deadband_abs, (double)p->deadband_pct,
+                           (unsigned long)p->min_interval_sec, (unsigned long)p->max_interval_sec);
+    }
+    json_writer_printf(&w, "],\"published\":%lu,\"suppressed\":%lu}",
+                       (unsigned long)s_stats.published, (unsigned long)s_stats.suppressed);
+    UNLOCK();
+
+    return json_writer_finish(&w, out_len);
+}
@@ -0,0 +1,185 @@
+/**
+ * @file report_filter.h
+ * @brief 遥测按变化上报（report-by-exception）
+ *
+ * 传感器仍按固定周期采样（历史存储、告警判断不受影响），是否发布到MQTT由本模块决定：
+ * - 与上次发布的值相比超出死区（绝对值或百分比，任一通道超出即可），
+ *   且距上次发布已过最短间隔 min_interval_sec，发布
+ * - 距上次发布超过最长间隔 max_interval_sec，无论是否变化都发布一次（保活）
+ * - 其余情况跳过
+ *
+ * 发布成功后调用 report_filter_commit() 记录本次发布的值，发布失败（如MQTT断开）
+ * 不记录，下一次采样会继续尝试。关闭按变化上报时每次采样都发布（原有行为）。
+ *
+ * 传感器ID与 sample_store 的 sample_sensor_id_t 一致，每个传感器一条策略，
+ * 同一传感器的各通道（如DHT11温度/湿度）在同一条消息中一起发布。
+ */
+
+#ifndef REPORT_FILTER_H
+#define REPORT_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_REPORT_FILTER_MAX_POLICIES
+#define CONFIG_REPORT_FILTER_MAX_POLICIES       8
+#endif
+
+#ifndef CONFIG_REPORT_FILTER_DEFAULT_MIN_INTERVAL_SEC
+#define CONFIG_REPORT_FILTER_DEFAULT_MIN_INTERVAL_SEC   10
+#endif
+
+#ifndef CONFIG_REPORT_FILTER_DEFAULT_MAX_INTERVAL_SEC
+#define CONFIG_REPORT_FILTER_DEFAULT_MAX_INTERVAL_SEC   300
+#endif
+
+#ifdef CONFIG_REPORT_FILTER_DEFAULT_ENABLED
+#define REPORT_FILTER_DEFAULT_ENABLED   true
+#else
+#define REPORT_FILTER_DEFAULT_ENABLED   false
+#endif
+
+#define REPORT_FILTER_MAX_POLICIES      CONFIG_REPORT_FILTER_MAX_POLICIES
+#define REPORT_FILTER_MAX_CHANNELS      4       ///< 每个传感器最多通道数
+
+/**
+ * @brief 上报策略（按传感器唯一）
+ *
+ * 结构体会原样保存到NVS，修改字段时需要同时修改配置缓存的格式版本。
+ * 死区两项都为0时，数值有任何变化即视为超出死区。
+ */
+typedef struct {
+    uint8_t sensor;                ///< 传感器ID（sample_sensor_id_t）
+    uint8_t reserved[3];
+    float deadband_abs;            ///< 绝对死区（>=0，0不使用）
+    float deadband_pct;            ///< 相对死区，相对上次发布值的百分比（>=0，0不使用）
+    uint32_t min_interval_sec;     ///< 两次变化上报的最短间隔（秒，0不限制）
+    uint32_t max_interval_sec;     ///< 最长不上报时间（秒，>=min_interval_sec，0表示不保活）
+} report_policy_t;
+
+/**
+ * @brief 判断结果
+ */
+typedef enum {
+    REPORT_SKIP = 0,               ///< 不发布
+    REPORT_FIRST,                  ///< 首次发布
+    REPORT_CHANGED,                ///< 超出死区
+    REPORT_MAX_INTERVAL,           ///< 达到最长间隔
+    REPORT_ALWAYS,                 ///< 未启用按变化上报或没有对应策略
+} report_reason_t;
+
+/**
+ * @brief 统计信息
+ */
+typedef struct {
+    uint32_t published;            ///< 发布次数（report_filter_commit调用次数）
+    uint32_t suppressed;           ///< 跳过次数
+    uint32_t heartbeats;           ///< 因最长间隔发布的次数
+} report_filter_stats_t;
+
+/**
+ * @brief 初始化
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_NO_MEM: 创建锁失败
+ */
+esp_err_t report_filter_init(void);
+
+/**
+ * @brief 启用/关闭按变化上报（关闭时每次采样都发布）
+ */
+void report_filter_set_enabled(bool enabled);
+
+/**
+ * @brief 是否启用按变化上报
+ */
+bool report_filter_is_enabled(void);
+
+/**
+ * @brief 检查策略参数
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 有效
+ *   - ESP_ERR_INVALID_ARG: 负的死区或最长间隔小于最短间隔
+ */
+esp_err_t report_filter_policy_validate(const report_policy_t *policy);
+
+/**
+ * @brief 设置策略（同一传感器的策略被替换，上次发布记录清零）
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 策略无效
+ *   - ESP_ERR_NO_MEM: 策略已满
+ */
+esp_err_t report_filter_set_policy(const report_policy_t *policy);
+
+/**
+ * @brief 读取某个传感器的策略
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_NOT_FOUND: 没有该传感器的策略
+ */
+esp_err_t report_filter_get_policy(uint8_t sensor, report_policy_t *out);
+
+/**
+ * @brief 读取当前全部策略
+ *
+ * @param out 输出数组（至少REPORT_FILTER_MAX_POLICIES个）
+ * @return 策略数
+ */
+size_t report_filter_get_policies(report_policy_t *out);
+
+/**
+ * @brief 判断本次采样是否需要发布
+ *
+ * 不修改上次发布记录，发布成功后需调用 report_filter_commit()。
+ *
+ * @param sensor 传感器ID
+ * @param values 各通道数值
+ * @param count 通道数（超过REPORT_FILTER_MAX_CHANNELS的部分不参与判断）
+ * @param now_ms 当前时间（毫秒，单调递增）
+ * @return 判断结果，REPORT_SKIP表示不发布
+ */
+report_reason_t report_filter_check(uint8_t sensor, const float *values, size_t count, uint32_t now_ms);
+
+/**
+ * @brief 记录一次成功的发布
+ */
+void report_filter_commit(uint8_t sensor, const float *values, size_t count, uint32_t now_ms);
+
+/**
+ * @brief 生成策略JSON
+ *
+ * 格式：{"enabled":true,"policies":[{"sensor":1,"deadband":0.5,"deadband_pct":0,"min_interval":10,"max_interval":300}],
+ *       "published":12,"suppressed":240}
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_SIZE: 缓冲区不足
+ */
+esp_err_t report_filter_status_json(char *buf, size_t buf_size, size_t *out_len);
+
+/**
+ * @brief 获取统计信息
+ */
+void report_filter_get_stats(report_filter_stats_t *stats);
+
+/**
+ * @brief 判断结果名（"skip"/"first"/"changed"/"max_interval"/"always"）
+ */
+const char *report_filter_reason_name(report_reason_t reason);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // REPORT_FILTER_H
@@ -0,0 +1,327 @@
+/**
+ * @file sensor_filter.c
+ * @brief 传感器读数调理实现
+ *
+ * 每个通道一个定长槽位：配置 + 环形窗口（校准后的原始值）+ EMA状态。
+ * 中值和MAD在栈上的定长数组中插入排序（窗口很小），不分配内存。
+ */
+
+#include "sensor_filter.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "esp_log.h"
+#include "json_writer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "SENSOR_FILTER";
+
+/**
+ * @brief 通道配置及滤波状态
+ */
+typedef struct {
+    sensor_filter_config_t cfg;
+    int32_t window[SENSOR_FILTER_MAX_WINDOW];  ///< 校准后的原始值（千分之一单位）
+    uint8_t head;                  ///< 下一个写入位置
+    uint8_t count;                 ///< 窗口中的有效值个数
+    bool ema_valid;                ///< EMA是否已有初值
+    int64_t ema;                   ///< EMA状态（千分之一单位，再左移8位）
+    sensor_filter_stats_t stats;
+} filter_slot_t;
+
+static filter_slot_t s_slots[SENSOR_FILTER_MAX_CHANNELS];
+static size_t s_slot_count = 0;
+static SemaphoreHandle_t s_mutex = NULL;
+
+#define LOCK()      do { if (s_mutex) xSemaphoreTake(s_mutex, portMAX_DELAY); } while (0)
+#define UNLOCK()    do { if (s_mutex) xSemaphoreGive(s_mutex); } while (0)
+
+esp_err_t sensor_filter_init(void)
+{
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+size_t sensor_filter_channel_footprint(void)
+{
+    return sizeof(filter_slot_t);
+}
+
+int32_t sensor_filter_to_milli(float value)
+{
+    double v = (double)value * SENSOR_FILTER_MILLI;
+    if (v >= (double)INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (v <= (double)INT32_MIN) {
+        return INT32_MIN;
+    }
+    return (int32_t)lround(v);
+}
+
+static bool window_ok(uint8_t n)
+{
+    return n <= 1 || (n % 2 == 1 && n <= SENSOR_FILTER_MAX_WINDOW);
+}
+
+esp_err_t sensor_filter_config_validate(const sensor_filter_config_t *cfg)
+{
+    if (!cfg || !window_ok(cfg->median_n) || !window_ok(cfg->hampel_n) || cfg->hampel_n == 1) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (cfg->min > cfg->max || cfg->ema_alpha > SENSOR_FILTER_EMA_ONE ||
+        cfg->hampel_floor < 0 || cfg->scale < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
+
+static filter_slot_t *find_slot(uint8_t sensor, uint8_t channel)
+{
+    for (size_t i = 0; i < s_slot_count; i++) {
+        if (s_slots[i].cfg.sensor == sensor && s_slots[i].cfg.channel == channel) {
+            return &s_slots[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t sensor_filter_configure(const sensor_filter_config_t *cfg)
+{
+    esp_err_t err = sensor_filter_config_validate(cfg);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    LOCK();
+    filter_slot_t *slot = find_slot(cfg->sensor, cfg->channel);
+    if (!slot && s_slot_count < SENSOR_FILTER_MAX_CHANNELS) {
+        slot = &s_slots[s_slot_count++];
+    }
+    if (slot) {
+        memset(slot, 0, sizeof(*slot));
+        slot->cfg = *cfg;
+    }
+    UNLOCK();
+
+    if (!slot) {
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "🎚️ 传感器%u 通道%u: 校准%+ld/%ld 范围[%ld,%ld] 中值%u Hampel%u EMA%u/256",
+             cfg->sensor, cfg->channel, (long)cfg->offset, (long)cfg->scale,
+             (long)cfg->min, (long)cfg->max, cfg->median_n, cfg->hampel_n, cfg->ema_alpha);
+    return ESP_OK;
+}
+
+esp_err_t sensor_filter_get_config(uint8_t sensor, uint8_t channel, sensor_filter_config_t *out)
+{
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+
+    LOCK();
+    filter_slot_t *slot = find_slot(sensor, channel);
+    if (slot) {
+        if (out) {
+            *out = slot->cfg;
+        }
+        err = ESP_OK;
+    }
+    UNLOCK();
+    return err;
+}
+
+size_t sensor_filter_get_configs(sensor_filter_config_t *out)
+{
+    size_t count;
+
+    LOCK();
+    count = s_slot_count;
+    for (size_t i = 0; out && i < count; i++) {
+        out[i] = s_slots[i].cfg;
+    }
+    UNLOCK();
+    return count;
+}
+
+static void sort_int32(int32_t *v, size_t n)
+{
+    for (size_t i = 1; i < n; i++) {
+        int32_t x = v[i];
+        size_t j = i;
+        while (j > 0 && v[j - 1] > x) {
+            v[j] = v[j - 1];
+            j--;
+        }
+        v[j] = x;
+    }
+}
+
+/**
+ * @brief 把窗口中最近n个值复制到out（n不超过窗口中的有效值个数）
+ */
+static size_t window_latest(const filter_slot_t *slot, size_t n, int32_t *out)
+{
+    if (n > slot->count) {
+        n = slot->count;
+    }
+    size_t idx = slot->head;
+    for (size_t i = 0; i < n; i++) {
+        idx = (idx == 0 ? SENSOR_FILTER_MAX_WINDOW : idx) - 1;
+        out[i] = slot->window[idx];
+    }
+    return n;
+}
+
+static int32_t median_of(int32_t *v, size_t n)
+{
+    sort_int32(v, n);
+    return (n % 2) ? v[n / 2] : (int32_t)(((int64_t)v[n / 2 - 1] + v[n / 2]) / 2);
+}
+
+sensor_filter_result_t sensor_filter_apply(uint8_t sensor, uint8_t channel, float raw, float *out)
+{
+    int32_t buf[SENSOR_FILTER_MAX_WINDOW];
+    sensor_filter_result_t result = SENSOR_FILTER_OK;
+
+    LOCK();
+    filter_slot_t *slot = find_slot(sensor, channel);
+    if (!slot) {
+        UNLOCK();
+        if (!isfinite(raw)) {
+            return SENSOR_FILTER_REJECTED;
+        }
+        if (out) {
+            *out = raw;
+        }
+        return SENSOR_FILTER_OK;
+    }
+
+    const sensor_filter_config_t *cfg = &slot->cfg;
+    slot->stats.samples++;
+
+    // 校准：x = raw*scale + offset
+    int32_t scale = cfg->scale ? cfg->scale : SENSOR_FILTER_SCALE_ONE;
+    if (!isfinite(raw)) {
+        slot->stats.rejected++;
+        UNLOCK();
+        return SENSOR_FILTER_REJECTED;
+    }
+    int32_t x = sensor_filter_to_milli(raw);
+    int64_t calibrated = (((int64_t)x * scale) >> 16) + cfg->offset;
+    if (calibrated < cfg->min || calibrated > cfg->max) {
+        slot->stats.rejected++;
+        UNLOCK();
+        ESP_LOGW(TAG, "⚠️ 传感器%u 通道%u 读数%.2f超出合理范围，已丢弃", sensor, channel, raw);
+        return SENSOR_FILTER_REJECTED;
+    }
+    x = (int32_t)calibrated;
+
+    slot->window[slot->head] = x;
+    slot->head = (slot->head + 1) % SENSOR_FILTER_MAX_WINDOW;
+    if (slot->count < SENSOR_FILTER_MAX_WINDOW) {
+        slot->count++;
+    }
+
+    int32_t y = x;
+
+    // Hampel：窗口填满前（少于3个值）不判断
+    if (cfg->hampel_n > 1) {
+        size_t n = window_latest(slot, cfg->hampel_n, buf);
+        if (n >= 3) {
+            int32_t m = median_of(buf, n);
+            window_latest(slot, n, buf);
+            for (size_t i = 0; i < n; i++) {
+                buf[i] = buf[i] > m ? buf[i] - m : m - buf[i];
+            }
+            int64_t mad = median_of(buf, n);
+            // 1.4826*MAD 为正态分布下标准差的估计
+            int64_t limit = mad * cfg->hampel_k_x10 * 14826 / 100000;
+            if (limit < cfg->hampel_floor) {
+                limit = cfg->hampel_floor;
+            }
+            int64_t dev = (int64_t)x - m;
+            if (dev > limit || -dev > limit) {
+                y = m;
+                slot->stats.replaced++;
+                result = SENSOR_FILTER_REPLACED;
+            }
+        }
+    }
+
+    // 中值：离群值本身也在窗口中，由中值自然剔除
+    if (cfg->median_n > 1) {
+        size_t n = window_latest(slot, cfg->median_n, buf);
+        y = median_of(buf, n);
+    }
+
+    // EMA：状态多保留8位小数，避免小系数时截断误差累积
+    if (cfg->ema_alpha > 0 && cfg->ema_alpha < SENSOR_FILTER_EMA_ONE) {
+        int64_t target = (int64_t)y << 8;
+        if (!slot->ema_valid) {
+            slot->ema = target;
+            slot->ema_valid = true;
+        } else {
+            slot->ema += ((target - slot->ema) * cfg->ema_alpha) >> 8;
+        }
+        y = (int32_t)(slot->ema >> 8);
+    }
+    UNLOCK();
+
+    if (out) {
+        *out = (float)y / SENSOR_FILTER_MILLI;
+    }
+    return result;
+}
+
+esp_err_t sensor_filter_get_stats(uint8_t sensor, uint8_t channel, sensor_filter_stats_t *stats)
+{
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+
+    LOCK();
+    filter_slot_t *slot = find_slot(sensor, channel);
+    if (slot) {
+        if (stats) {
+            *stats = slot->stats;
+        }
+        err = ESP_OK;
+    }
+    UNLOCK();
+    return err;
+}
+
+esp_err_t sensor_filter_status_json(char *buf, size_t buf_size, size_t *out_len)
+{
+    if (!buf || buf_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    json_writer_t w;
+    json_writer_init(&w, buf, buf_size);
+
+    LOCK();
+    json_writer_printf(&w, "{\"channels\":[");
+    for (size_t i = 0; i < s_slot_count; i++) {
+        const sensor_filter_config_t *c = &s_slots[i].cfg;
+        const sensor_filter_stats_t *st = &s_slots[i].stats;
+        json_writer_printf(&w, "%s{\"sensor\":%u,\"channel\":%u,\"offset\":%g,\"scale\":%g,\"min\":%g,\"max\":%g,"
+                           "\"median\":%u,\"hampel\":%u,\"hampel_k\":%g,\"hampel_floor\":%g,\"ema_alpha\":%g,"
+                           "\"samples\":%lu,\"rejected\":%lu,\"replaced\":%lu}",
+                           i ? "," : "", c->sensor, c->channel,
+                           c->offset / (double)SENSOR_FILTER_MILLI,
+                           (c->scale ? c->scale : SENSOR_FILTER_SCALE_ONE) / (double)SENSOR_FILTER_SCALE_ONE,
+                           c->min / (double)SENSOR_FILTER_MILLI, c->max / (double)SENSOR_FILTER_MILLI,
+                           c->median_n, c->hampel_n, c->hampel_k_x10 / 10.0,
+                           c->hampel_floor / (double)SENSOR_FILTER_MILLI,
+                           (c->ema_alpha ? c->ema_alpha : SENSOR_FILTER_EMA_ONE) / (double)SENSOR_FILTER_EMA_ONE,
+                           (unsigned long)st->samples, (unsigned long)st->rejected, (unsigned long)st->replaced);
+    }
+    json_writer_printf(&w, "]}");
+    UNLOCK();
+
+    return json_writer_finish(&w, out_len);
+}
@@ -0,0 +1,179 @@
+/**
+ * @file sensor_filter.h
+ * @brief 传感器读数调理：校准、合理范围检查、Hampel离群值剔除、中值滤波、EMA平滑
+ *
+ * 位于传感器驱动（dht11_read_adapter / ds18b20_read / rain_sensor_read）和
+ * 历史存储、告警、MQTT发布之间，每个传感器通道独立配置，处理顺序：
+ *   原始值 -> 校准(offset/scale) -> 合理范围检查(超出则丢弃) -> Hampel -> 中值 -> EMA -> 输出
+ *
+ * - Hampel：窗口中值m、绝对中位差MAD，|x-m| > max(k*1.4826*MAD, floor) 时用m替换x
+ * - 中值：最近N个（校准后的原始）值的中值
+ * - EMA：y += alpha*(x-y)
+ *
+ * 内部全部使用定点数（千分之一单位的int32，EMA额外8位小数），不分配内存。
+ * 每个通道占用 配置28字节 + 窗口(SENSOR_FILTER_MAX_WINDOW*4字节) + 状态和统计约32字节，
+ * 默认窗口7时88字节/通道，8个通道共704字节（静态分配）；
+ * 主机基准测试 filter.* 项给出实际大小和每次处理耗时。
+ */
+
+#ifndef SENSOR_FILTER_H
+#define SENSOR_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_SENSOR_FILTER_MAX_CHANNELS
+#define CONFIG_SENSOR_FILTER_MAX_CHANNELS   8
+#endif
+
+#ifndef CONFIG_SENSOR_FILTER_MAX_WINDOW
+#define CONFIG_SENSOR_FILTER_MAX_WINDOW     7
+#endif
+
+#define SENSOR_FILTER_MAX_CHANNELS      CONFIG_SENSOR_FILTER_MAX_CHANNELS
+#define SENSOR_FILTER_MAX_WINDOW        CONFIG_SENSOR_FILTER_MAX_WINDOW
+
+#define SENSOR_FILTER_MILLI             1000    ///< 定点数：1.0 = 1000
+#define SENSOR_FILTER_SCALE_ONE         65536   ///< 校准比例：1.0 = 65536（Q16）
+#define SENSOR_FILTER_EMA_ONE           256     ///< EMA系数：1.0 = 256（不平滑）
+
+/**
+ * @brief 通道配置（按传感器+通道唯一）
+ *
+ * 数值字段均为千分之一单位（如25.5°C = 25500）。
+ * 结构体会原样保存到NVS，修改字段时需要同时修改配置缓存的格式版本。
+ */
+typedef struct {
+    uint8_t sensor;                ///< 传感器ID（sample_sensor_id_t）
+    uint8_t channel;               ///< 通道
+    uint8_t median_n;              ///< 中值滤波窗口（奇数，0/1不启用）
+    uint8_t hampel_n;              ///< Hampel窗口（奇数，0不启用）
+    uint16_t hampel_k_x10;         ///< Hampel阈值系数×10（30 = 3.0倍MAD）
+    uint16_t ema_alpha;            ///< EMA系数，1/256为单位（0或256不平滑）
+    int32_t hampel_floor;          ///< Hampel最小判定偏差（避免MAD为0时任何变化都被剔除）
+    int32_t min;                   ///< 合理范围下限（校准后）
+    int32_t max;                   ///< 合理范围上限（校准后）
+    int32_t offset;                ///< 校准偏移
+    int32_t scale;                 ///< 校准比例（Q16，0按1.0处理）
+} sensor_filter_config_t;
+
+/**
+ * @brief 处理结果
+ */
+typedef enum {
+    SENSOR_FILTER_OK = 0,          ///< 正常
+    SENSOR_FILTER_REPLACED,        ///< 被Hampel判为离群值，输出为窗口中值
+    SENSOR_FILTER_REJECTED,        ///< 超出合理范围或非数值，丢弃本次读数
+} sensor_filter_result_t;
+
+/**
+ * @brief 通道统计
+ */
+typedef struct {
+    uint32_t samples;              ///< 处理次数
+    uint32_t rejected;             ///< 丢弃次数
+    uint32_t replaced;             ///< 离群值替换次数
+} sensor_filter_stats_t;
+
+/**
+ * @brief 初始化
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_NO_MEM: 创建锁失败
+ */
+esp_err_t sensor_filter_init(void);
+
+/**
+ * @brief 检查配置参数
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 有效
+ *   - ESP_ERR_INVALID_ARG: 窗口为偶数或超过SENSOR_FILTER_MAX_WINDOW、min>max、
+ *     EMA系数超过256、负的floor或scale
+ */
+esp_err_t sensor_filter_config_validate(const sensor_filter_config_t *cfg);
+
+/**
+ * @brief 设置通道配置（替换同一通道的配置，滤波状态清零）
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 配置无效
+ *   - ESP_ERR_NO_MEM: 通道已满
+ */
+esp_err_t sensor_filter_configure(const sensor_filter_config_t *cfg);
+
+/**
+ * @brief 读取通道配置
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_NOT_FOUND: 该通道未配置
+ */
+esp_err_t sensor_filter_get_config(uint8_t sensor, uint8_t channel, sensor_filter_config_t *out);
+
+/**
+ * @brief 读取全部通道配置
+ *
+ * @param out 输出数组（至少SENSOR_FILTER_MAX_CHANNELS个）
+ * @return 通道数
+ */
+size_t sensor_filter_get_configs(sensor_filter_config_t *out);
+
+/**
+ * @brief 处理一次读数
+ *
+ * 未配置的通道原样输出。结果为SENSOR_FILTER_REJECTED时不更新滤波状态，*out不变。
+ *
+ * @param sensor 传感器ID
+ * @param channel 通道
+ * @param raw 驱动读出的原始值
+ * @param out 输出值
+ * @return 处理结果
+ */
+sensor_filter_result_t sensor_filter_apply(uint8_t sensor, uint8_t channel, float raw, float *out);
+
+/**
+ * @brief 读取通道统计
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_NOT_FOUND: 该通道未配置
+ */
+esp_err_t sensor_filter_get_stats(uint8_t sensor, uint8_t channel, sensor_filter_stats_t *stats);
+
+/**
+ * @brief 生成配置和统计JSON
+ *
+ * 格式：{"channels":[{"sensor":1,"channel":0,"offset":-0.5,"scale":1,"min":0,"max":50,
+ *        "median":0,"hampel":5,"hampel_k":3,"hampel_floor":2,"ema_alpha":1,
+ *        "samples":120,"rejected":1,"replaced":2}]}
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_SIZE: 缓冲区不足
+ */
+esp_err_t sensor_filter_status_json(char *buf, size_t buf_size, size_t *out_len);
+
+/**
+ * @brief 每个通道占用的静态内存（字节，含配置、窗口和状态）
+ */
+size_t sensor_filter_channel_footprint(void);
+
+/**
+ * @brief 浮点数转千分之一单位定点数（四舍五入，超出int32范围时饱和）
+ */
+int32_t sensor_filter_to_milli(float value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SENSOR_FILTER_H
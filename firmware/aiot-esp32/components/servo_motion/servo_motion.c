@@ -0,0 +1,405 @@
+/**
+ * @file servo_motion.c
+ * @brief 舵机轨迹规划、采样和多舵机路点规划器（只依赖传入的时间，不依赖定时器/LEDC）
+ *
+ * 每段运动的位置写成 p(t) = p0 + D·s(u)，u = (t - t0) / T，s 为归一化曲线：
+ * - 梯形：加速段 u<f 时 s = u²/(2f(1-f))，匀速段 s = (u - f/2)/(1-f)，减速段与加速段对称；
+ *   最大加速度 a = D/(T²·f(1-f))，由此根据给定时长反解出 f；
+ * - S曲线：s = 10u³ - 15u⁴ + 6u⁵，峰值速度 1.875·D/T，峰值加速度 5.7735·D/T²；
+ * - 线性：s = u。
+ */
+
+#include "servo_motion.h"
+#include <math.h>
+#include <string.h>
+
+#define SCURVE_PEAK_VEL     1.875f      ///< 15/8
+#define SCURVE_PEAK_ACC     5.7735027f  ///< 10/√3
+
+static inline bool reached(uint32_t now, uint32_t t)
+{
+    return (int32_t)(now - t) >= 0;
+}
+
+static inline uint32_t later(uint32_t a, uint32_t b)
+{
+    return (int32_t)(a - b) >= 0 ? a : b;
+}
+
+uint32_t servo_motion_min_duration_ms(float distance, servo_profile_t profile, float v_max, float a_max)
+{
+    float d = fabsf(distance);
+    if (d <= 0.0f || v_max <= 0.0f || a_max <= 0.0f) {
+        return 0;
+    }
+
+    float t;
+    switch (profile) {
+        case SERVO_PROFILE_LINEAR:
+            t = d / v_max;
+            break;
+        case SERVO_PROFILE_SCURVE: {
+            float t_v = SCURVE_PEAK_VEL * d / v_max;
+            float t_a = sqrtf(SCURVE_PEAK_ACC * d / a_max);
+            t = t_v > t_a ? t_v : t_a;
+            break;
+        }
+        case SERVO_PROFILE_TRAPEZOID:
+        default:
+            if (d <= v_max * v_max / a_max) {
+                // 达不到最大速度：三角形速度曲线
+                t = 2.0f * sqrtf(d / a_max);
+            } else {
+                t = d / v_max + v_max / a_max;
+            }
+            break;
+    }
+    return (uint32_t)ceilf(t * 1000.0f);
+}
+
+void servo_motion_plan(servo_segment_t *seg, float start, float end, uint32_t t0_ms, uint32_t duration_ms,
+                       servo_profile_t profile, float v_max, float a_max)
+{
+    float d = fabsf(end - start);
+    uint32_t t_min = servo_motion_min_duration_ms(d, profile, v_max, a_max);
+
+    seg->start = start;
+    seg->end = end;
+    seg->t0_ms = t0_ms;
+    seg->duration_ms = duration_ms > t_min ? duration_ms : t_min;
+    seg->profile = profile;
+    seg->accel_frac = 0.5f;
+
+    if (profile == SERVO_PROFILE_TRAPEZOID && d > 0.0f && seg->duration_ms > 0) {
+        // D = a·ta·(T - ta)  =>  ta = (T - √(T² - 4D/a)) / 2
+        float t = seg->duration_ms / 1000.0f;
+        float disc = t * t - 4.0f * d / a_max;
+        float ta = (t - sqrtf(disc > 0.0f ? disc : 0.0f)) / 2.0f;
+        float f = ta / t;
+        seg->accel_frac = f > 0.5f ? 0.5f : (f < 0.001f ? 0.001f : f);
+    }
+}
+
+float servo_motion_sample(const servo_segment_t *seg, uint32_t now_ms)
+{
+    if (seg->duration_ms == 0 || reached(now_ms, seg->t0_ms + seg->duration_ms)) {
+        return seg->end;
+    }
+    if (!reached(now_ms, seg->t0_ms)) {
+        return seg->start;
+    }
+
+    float u = (float)(now_ms - seg->t0_ms) / (float)seg->duration_ms;
+    float s;
+    switch (seg->profile) {
+        case SERVO_PROFILE_LINEAR:
+            s = u;
+            break;
+        case SERVO_PROFILE_SCURVE:
+            s = u * u * u * (10.0f + u * (-15.0f + 6.0f * u));
+            break;
+        case SERVO_PROFILE_TRAPEZOID:
+        default: {
+            float f = seg->accel_frac;
+            float k = 2.0f * f * (1.0f - f);
+            if (u < f) {
+                s = u * u / k;
+            } else if (u <= 1.0f - f) {
+                s = (u - f / 2.0f) / (1.0f - f);
+            } else {
+                s = 1.0f - (1.0f - u) * (1.0f - u) / k;
+            }
+            break;
+        }
+    }
+    return seg->start + (seg->end - seg->start) * s;
+}
+
+const char *servo_motion_profile_name(servo_profile_t profile)
+{
+    switch (profile) {
+        case SERVO_PROFILE_TRAPEZOID:   return "trapezoid";
+        case SERVO_PROFILE_SCURVE:      return "scurve";
+        case SERVO_PROFILE_LINEAR:      return "linear";
+        default:                        return "unknown";
+    }
+}
+
+esp_err_t servo_motion_parse_profile(const char *name, servo_profile_t *profile)
+{
+    if (!name || !profile) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (strcmp(name, "trapezoid") == 0) {
+        *profile = SERVO_PROFILE_TRAPEZOID;
+    } else if (strcmp(name, "scurve") == 0) {
+        *profile = SERVO_PROFILE_SCURVE;
+    } else if (strcmp(name, "linear") == 0) {
+        *profile = SERVO_PROFILE_LINEAR;
+    } else {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+/* ==================== 多舵机规划器 ==================== */
+
+static inline servo_waypoint_t *queue_head(servo_axis_t *ax)
+{
+    return &ax->queue[ax->head];
+}
+
+static void queue_pop(servo_axis_t *ax)
+{
+    ax->head = (ax->head + 1) % CONFIG_SERVO_MOTION_QUEUE_LEN;
+    ax->count--;
+}
+
+static void start_segment(servo_planner_t *p, servo_axis_t *ax, const servo_waypoint_t *wp,
+                          uint32_t t0, uint32_t duration_ms)
+{
+    servo_motion_plan(&ax->seg, ax->position, wp->angle, t0, duration_ms, wp->profile, p->v_max, p->a_max);
+    ax->dwell_ms = wp->dwell_ms;
+    ax->state = SERVO_AXIS_MOVING;
+}
+
+/**
+ * @brief 推进单个舵机到 now_ms（同步路点在队首时停在 SYNC_WAIT）
+ */
+static void advance(servo_planner_t *p, servo_axis_t *ax, uint32_t now_ms)
+{
+    // 每轮要么返回要么消耗一个状态/路点，上限只是防御
+    for (int guard = 0; guard < 3 * CONFIG_SERVO_MOTION_QUEUE_LEN + 3; guard++) {
+        switch (ax->state) {
+            case SERVO_AXIS_MOVING: {
+                uint32_t end_ms = ax->seg.t0_ms + ax->seg.duration_ms;
+                if (!reached(now_ms, end_ms)) {
+                    ax->position = servo_motion_sample(&ax->seg, now_ms);
+                    return;
+                }
+                ax->position = ax->seg.end;
+                ax->ready_ms = end_ms + ax->dwell_ms;
+                ax->state = SERVO_AXIS_DWELL;
+                break;
+            }
+            case SERVO_AXIS_DWELL:
+                if (!reached(now_ms, ax->ready_ms)) {
+                    return;
+                }
+                ax->state = SERVO_AXIS_IDLE;
+                break;
+            case SERVO_AXIS_IDLE: {
+                if (ax->count == 0) {
+                    return;
+                }
+                servo_waypoint_t *wp = queue_head(ax);
+                if (wp->sync_id != 0) {
+                    ax->state = SERVO_AXIS_SYNC_WAIT;
+                    return;
+                }
+                // 下一段从上一段结束（含停留）的时刻开始，不受采样时刻影响
+                start_segment(p, ax, wp, ax->ready_ms, wp->duration_ms);
+                queue_pop(ax);
+                break;
+            }
+            case SERVO_AXIS_SYNC_WAIT:
+            default:
+                return;
+        }
+    }
+}
+
+/**
+ * @brief 同步组的舵机都在等待时统一出发
+ *
+ * @return 有同步组出发时返回true（需要再推进一轮）
+ */
+static bool resolve_sync(servo_planner_t *p)
+{
+    bool started = false;
+
+    for (uint8_t i = 0; i < p->count; i++) {
+        servo_axis_t *ax = &p->axis[i];
+        if (ax->state != SERVO_AXIS_SYNC_WAIT) {
+            continue;
+        }
+        const servo_waypoint_t *wp = queue_head(ax);
+        uint16_t id = wp->sync_id;
+        uint8_t mask = wp->sync_mask;
+
+        bool all_ready = true;
+        uint32_t t0 = ax->ready_ms;
+        uint32_t duration = wp->duration_ms;
+        for (uint8_t j = 0; j < p->count; j++) {
+            if (!(mask & (1u << j))) {
+                continue;
+            }
+            servo_axis_t *other = &p->axis[j];
+            if (other->state != SERVO_AXIS_SYNC_WAIT || queue_head(other)->sync_id != id) {
+                all_ready = false;
+                break;
+            }
+            const servo_waypoint_t *owp = queue_head(other);
+            t0 = later(t0, other->ready_ms);
+            uint32_t t_min = servo_motion_min_duration_ms(owp->angle - other->position, owp->profile,
+                                                          p->v_max, p->a_max);
+            if (t_min > duration) {
+                duration = t_min;
+            }
+        }
+        if (!all_ready) {
+            continue;
+        }
+
+        // 最慢的舵机决定时长，其他舵机按同一时长规划（降低速度），同时出发、同时到达
+        for (uint8_t j = 0; j < p->count; j++) {
+            if (mask & (1u << j)) {
+                servo_axis_t *other = &p->axis[j];
+                start_segment(p, other, queue_head(other), t0, duration);
+                queue_pop(other);
+            }
+        }
+        started = true;
+    }
+    return started;
+}
+
+void servo_planner_init(servo_planner_t *p, uint8_t count, const float *initial, float v_max, float a_max)
+{
+    memset(p, 0, sizeof(*p));
+    p->count = count > SERVO_MOTION_MAX_SERVOS ? SERVO_MOTION_MAX_SERVOS : count;
+    p->v_max = v_max;
+    p->a_max = a_max;
+    for (uint8_t i = 0; i < p->count; i++) {
+        float pos = initial ? initial[i] : 0.0f;
+        p->axis[i].position = pos;
+        p->axis[i].seg.start = pos;
+        p->axis[i].seg.end = pos;
+    }
+}
+
+esp_err_t servo_planner_push(servo_planner_t *p, uint8_t servo, const servo_waypoint_t *wp, uint32_t now_ms)
+{
+    if (servo >= p->count || !wp) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    servo_axis_t *ax = &p->axis[servo];
+    if (ax->count >= CONFIG_SERVO_MOTION_QUEUE_LEN) {
+        return ESP_ERR_NO_MEM;
+    }
+    if (ax->state == SERVO_AXIS_IDLE && ax->count == 0) {
+        // 空闲舵机从现在开始，而不是从很久以前的上一段结束时刻
+        ax->ready_ms = now_ms;
+    }
+    ax->queue[(ax->head + ax->count) % CONFIG_SERVO_MOTION_QUEUE_LEN] = *wp;
+    ax->count++;
+    return ESP_OK;
+}
+
+esp_err_t servo_planner_push_sync(servo_planner_t *p, uint8_t mask, const float *angles,
+                                  uint16_t duration_ms, servo_profile_t profile, uint32_t now_ms)
+{
+    if (mask == 0 || !angles || (mask >> p->count) != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (uint8_t j = 0; j < p->count; j++) {
+        if ((mask & (1u << j)) && p->axis[j].count >= CONFIG_SERVO_MOTION_QUEUE_LEN) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    if (++p->sync_seq == 0) {
+        p->sync_seq = 1;
+    }
+    for (uint8_t j = 0; j < p->count; j++) {
+        if (mask & (1u << j)) {
+            servo_waypoint_t wp = {
+                .angle = angles[j],
+                .duration_ms = duration_ms,
+                .profile = profile,
+                .sync_id = p->sync_seq,
+                .sync_mask = mask,
+            };
+            servo_planner_push(p, j, &wp, now_ms);
+        }
+    }
+    return ESP_OK;
+}
+
+void servo_planner_stop(servo_planner_t *p, uint8_t servo, uint32_t now_ms)
+{
+    if (servo >= p->count) {
+        return;
+    }
+    servo_axis_t *ax = &p->axis[servo];
+    if (ax->state == SERVO_AXIS_MOVING) {
+        ax->position = servo_motion_sample(&ax->seg, now_ms);
+    }
+    ax->seg.start = ax->position;
+    ax->seg.end = ax->position;
+    ax->seg.duration_ms = 0;
+    ax->state = SERVO_AXIS_IDLE;
+    ax->head = 0;
+    ax->count = 0;
+    ax->ready_ms = now_ms;
+
+    // 其他舵机队列中和它同步的路点不再等它
+    for (uint8_t j = 0; j < p->count; j++) {
+        servo_axis_t *other = &p->axis[j];
+        for (uint8_t k = 0; k < other->count; k++) {
+            servo_waypoint_t *wp = &other->queue[(other->head + k) % CONFIG_SERVO_MOTION_QUEUE_LEN];
+            if (wp->sync_id != 0) {
+                wp->sync_mask &= (uint8_t)~(1u << servo);
+            }
+        }
+    }
+}
+
+void servo_planner_set_position(servo_planner_t *p, uint8_t servo, float angle, uint32_t now_ms)
+{
+    if (servo >= p->count) {
+        return;
+    }
+    servo_planner_stop(p, servo, now_ms);
+    servo_axis_t *ax = &p->axis[servo];
+    ax->position = angle;
+    ax->seg.start = angle;
+    ax->seg.end = angle;
+}
+
+bool servo_planner_tick(servo_planner_t *p, uint32_t now_ms)
+{
+    // 同步组出发后再推进一轮；每轮至少出发一组，轮数有上限
+    for (uint8_t round = 0; round <= p->count; round++) {
+        for (uint8_t i = 0; i < p->count; i++) {
+            advance(p, &p->axis[i], now_ms);
+        }
+        if (!resolve_sync(p)) {
+            break;
+        }
+    }
+
+    for (uint8_t i = 0; i < p->count; i++) {
+        if (!servo_planner_idle(p, i)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool servo_planner_idle(const servo_planner_t *p, uint8_t servo)
+{
+    if (servo >= p->count) {
+        return true;
+    }
+    const servo_axis_t *ax = &p->axis[servo];
+    return ax->state == SERVO_AXIS_IDLE && ax->count == 0;
+}
+
+size_t servo_planner_space(const servo_planner_t *p, uint8_t servo)
+{
+    if (servo >= p->count) {
+        return 0;
+    }
+    return CONFIG_SERVO_MOTION_QUEUE_LEN - p->axis[servo].count;
+}
@@ -0,0 +1,279 @@
+/**
+ * @file servo_motion.h
+ * @brief 舵机运动控制：梯形/S曲线轨迹规划 + 路点队列 + 多舵机同步，由定时器按舵机帧周期采样输出
+ *
+ * 原来舵机命令直接把占空比跳到目标角度，摆动/正反转预设用 vTaskDelay 一步一步模拟运动，
+ * 动作生硬，而且每个动作都占住调用它的任务。本组件：
+ *
+ * - 每段运动按速度/加速度上限规划时长，位置由解析式 p(t) = p0 + D·s(t/T) 给出：
+ *   梯形（匀加速-匀速-匀减速）、S曲线（五次最小加加速度曲线，起止速度和加速度都为0）、线性；
+ * - 每个舵机一个路点队列（目标角度、时长、停留时间），队列里的动作首尾相接，
+ *   下一段从上一段的结束时刻开始计时，不会因为采样时刻累积误差；
+ * - 同步运动：参与的舵机都到达同步路点后在同一时刻出发，统一使用其中最慢的时长，同时到达；
+ * - 运行时由 esp_timer 按舵机PWM帧周期（50Hz即20ms）采样轨迹并写LEDC占空比，
+ *   所有舵机空闲时定时器停止。
+ *
+ * 规划和采样（servo_motion_plan / servo_motion_sample / servo_planner_*）只依赖传入的毫秒时间，
+ * 可在主机上和解析式逐点比较；定时器运行时在 servo_motion_timer.c 中。
+ */
+
+#ifndef SERVO_MOTION_H
+#define SERVO_MOTION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_SERVO_MOTION_TICK_MS
+#define CONFIG_SERVO_MOTION_TICK_MS         20
+#endif
+
+#ifndef CONFIG_SERVO_MOTION_QUEUE_LEN
+#define CONFIG_SERVO_MOTION_QUEUE_LEN       16
+#endif
+
+#ifndef CONFIG_SERVO_MOTION_MAX_SPEED
+#define CONFIG_SERVO_MOTION_MAX_SPEED       360     ///< 度/秒
+#endif
+
+#ifndef CONFIG_SERVO_MOTION_MAX_ACCEL
+#define CONFIG_SERVO_MOTION_MAX_ACCEL       1800    ///< 度/秒²
+#endif
+
+#define SERVO_MOTION_MAX_SERVOS     4
+
+/**
+ * @brief 速度曲线
+ */
+typedef enum {
+    SERVO_PROFILE_TRAPEZOID = 0,    ///< 梯形速度（加速度阶跃）
+    SERVO_PROFILE_SCURVE,           ///< S曲线（五次多项式，加速度连续）
+    SERVO_PROFILE_LINEAR,           ///< 匀速（起止速度突变）
+} servo_profile_t;
+
+/**
+ * @brief 一段运动（由 servo_motion_plan 填写）
+ */
+typedef struct {
+    float start;                    ///< 起点角度
+    float end;                      ///< 终点角度
+    uint32_t t0_ms;                 ///< 开始时刻
+    uint32_t duration_ms;           ///< 时长
+    float accel_frac;               ///< 梯形：加速段占总时长的比例（0~0.5）
+    servo_profile_t profile;
+} servo_segment_t;
+
+/**
+ * @brief 路点
+ */
+typedef struct {
+    float angle;                    ///< 目标角度
+    uint16_t duration_ms;           ///< 运动时长（0按速度/加速度上限最快到达；小于最短时长时按最短时长）
+    uint16_t dwell_ms;              ///< 到达后停留时间
+    servo_profile_t profile;
+    uint16_t sync_id;               ///< 同步组（0不同步，由 servo_planner_push_sync 填写）
+    uint8_t sync_mask;              ///< 同步组包含的舵机
+} servo_waypoint_t;
+
+/**
+ * @brief 按速度/加速度上限计算一段运动的最短时长
+ *
+ * @param distance 角度差（取绝对值）
+ * @param v_max 最大速度（度/秒）
+ * @param a_max 最大加速度（度/秒²）
+ * @return 最短时长（毫秒，向上取整）
+ */
+uint32_t servo_motion_min_duration_ms(float distance, servo_profile_t profile, float v_max, float a_max);
+
+/**
+ * @brief 规划一段运动
+ *
+ * duration_ms 小于最短时长时按最短时长。梯形曲线在时长更长时保持最大加速度、缩短匀速段之前的加速段。
+ */
+void servo_motion_plan(servo_segment_t *seg, float start, float end, uint32_t t0_ms, uint32_t duration_ms,
+                       servo_profile_t profile, float v_max, float a_max);
+
+/**
+ * @brief 采样一段运动在 now_ms 时的位置（开始前为起点，结束后为终点）
+ */
+float servo_motion_sample(const servo_segment_t *seg, uint32_t now_ms);
+
+/**
+ * @brief 曲线名称（"trapezoid"/"scurve"/"linear"）
+ */
+const char *servo_motion_profile_name(servo_profile_t profile);
+
+/**
+ * @brief 按名称解析曲线（未知名称返回 ESP_ERR_NOT_FOUND）
+ */
+esp_err_t servo_motion_parse_profile(const char *name, servo_profile_t *profile);
+
+/* ==================== 多舵机规划器 ==================== */
+
+typedef enum {
+    SERVO_AXIS_IDLE = 0,            ///< 空闲（队列可能有待出发的路点）
+    SERVO_AXIS_MOVING,              ///< 运动中
+    SERVO_AXIS_DWELL,               ///< 到达后停留
+    SERVO_AXIS_SYNC_WAIT,           ///< 等待同步组的其他舵机
+} servo_axis_state_t;
+
+typedef struct {
+    servo_axis_state_t state;
+    servo_segment_t seg;            ///< 当前（或最近一段）运动
+    float position;                 ///< 最近一次采样的位置
+    uint32_t ready_ms;              ///< 可以开始下一段的时刻（上一段结束 + 停留）
+    uint16_t dwell_ms;              ///< 当前段到达后的停留时间
+    servo_waypoint_t queue[CONFIG_SERVO_MOTION_QUEUE_LEN];
+    uint8_t head;
+    uint8_t count;
+} servo_axis_t;
+
+typedef struct {
+    servo_axis_t axis[SERVO_MOTION_MAX_SERVOS];
+    uint8_t count;
+    float v_max;
+    float a_max;
+    uint16_t sync_seq;
+} servo_planner_t;
+
+/**
+ * @brief 初始化规划器
+ *
+ * @param initial 各舵机的初始角度（NULL时为0）
+ */
+void servo_planner_init(servo_planner_t *p, uint8_t count, const float *initial, float v_max, float a_max);
+
+/**
+ * @brief 追加路点
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 舵机序号无效
+ *   - ESP_ERR_NO_MEM: 队列已满
+ */
+esp_err_t servo_planner_push(servo_planner_t *p, uint8_t servo, const servo_waypoint_t *wp, uint32_t now_ms);
+
+/**
+ * @brief 追加同步运动：mask中的每个舵机追加一个路点，全部就绪后同时出发、同时到达
+ *
+ * @param angles 按舵机序号索引的目标角度（只读取mask中的舵机）
+ * @return 同 servo_planner_push()；任一舵机队列已满时不追加任何路点
+ */
+esp_err_t servo_planner_push_sync(servo_planner_t *p, uint8_t mask, const float *angles,
+                                  uint16_t duration_ms, servo_profile_t profile, uint32_t now_ms);
+
+/**
+ * @brief 停止舵机：清空队列，停在 now_ms 时的位置
+ */
+void servo_planner_stop(servo_planner_t *p, uint8_t servo, uint32_t now_ms);
+
+/**
+ * @brief 直接设置位置（清空队列，不经过轨迹）
+ */
+void servo_planner_set_position(servo_planner_t *p, uint8_t servo, float angle, uint32_t now_ms);
+
+/**
+ * @brief 推进到 now_ms，更新每个舵机的位置
+ *
+ * @return 仍有舵机在运动、停留、等待同步或队列非空时返回true（需要继续采样）
+ */
+bool servo_planner_tick(servo_planner_t *p, uint32_t now_ms);
+
+/**
+ * @brief 舵机是否空闲（不在运动且队列为空）
+ */
+bool servo_planner_idle(const servo_planner_t *p, uint8_t servo);
+
+/**
+ * @brief 队列剩余空间
+ */
+size_t servo_planner_space(const servo_planner_t *p, uint8_t servo);
+
+/* ==================== 定时器运行时 ==================== */
+
+/**
+ * @brief 位置输出回调（在 esp_timer 任务中每帧调用一次，位置单位0.01度）
+ *
+ * @param mask 本帧位置变化的舵机（bit i 对应序号 i），同一帧的舵机应一起锁存
+ * @param centideg 各舵机位置（按序号索引，只有mask中的项有意义）
+ */
+typedef void (*servo_motion_output_t)(uint32_t mask, const uint32_t *centideg, void *ctx);
+
+/**
+ * @brief 初始化运动控制
+ *
+ * @param count 舵机数量（不超过 SERVO_MOTION_MAX_SERVOS）
+ * @param initial 各舵机的当前角度（NULL时为0）
+ * @param max_angle 角度上限（路点超过时截断）
+ * @param output 位置输出回调
+ * @param ctx 回调参数
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 参数错误
+ *   - ESP_ERR_INVALID_STATE: 已初始化
+ *   - ESP_ERR_NO_MEM: 创建锁或定时器失败
+ */
+esp_err_t servo_motion_init(uint8_t count, const float *initial, uint16_t max_angle,
+                            servo_motion_output_t output, void *ctx);
+
+/**
+ * @brief 追加路点（队列满时最多等待 timeout_ms，让长动作序列边运行边追加）
+ *
+ * @param servo 舵机序号（从0开始）
+ * @return esp_err_t
+ *   - ESP_OK: 全部追加
+ *   - ESP_ERR_TIMEOUT: 等待队列空间超时（已追加的路点保留）
+ *   - ESP_ERR_INVALID_ARG / ESP_ERR_INVALID_STATE
+ */
+esp_err_t servo_motion_queue(uint8_t servo, const servo_waypoint_t *wps, size_t count, uint32_t timeout_ms);
+
+/**
+ * @brief 单段平滑运动（追加一个路点）
+ */
+esp_err_t servo_motion_move(uint8_t servo, float angle, uint16_t duration_ms, servo_profile_t profile);
+
+/**
+ * @brief 多舵机同步运动
+ *
+ * @param mask 参与的舵机（bit i 对应序号 i）
+ * @param angles 按舵机序号索引的目标角度
+ */
+esp_err_t servo_motion_move_sync(uint8_t mask, const float *angles, uint16_t duration_ms, servo_profile_t profile);
+
+/**
+ * @brief 停止舵机的运动并清空队列（停在当前位置）
+ */
+esp_err_t servo_motion_stop(uint8_t servo);
+
+/**
+ * @brief 舵机被直接设置角度后同步规划器位置（清空队列，不输出）
+ */
+esp_err_t servo_motion_set_position(uint8_t servo, float angle);
+
+/**
+ * @brief 获取舵机当前位置
+ */
+float servo_motion_get_position(uint8_t servo);
+
+/**
+ * @brief 舵机是否空闲
+ */
+bool servo_motion_is_idle(uint8_t servo);
+
+/**
+ * @brief 等待舵机完成所有路点
+ *
+ * @return ESP_OK 或 ESP_ERR_TIMEOUT
+ */
+esp_err_t servo_motion_wait_idle(uint8_t servo, uint32_t timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SERVO_MOTION_H
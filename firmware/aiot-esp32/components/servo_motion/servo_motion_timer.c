@@ -0,0 +1,253 @@
+/**
+ * @file servo_motion_timer.c
+ * @brief 舵机运动运行时：esp_timer 按舵机帧周期推进规划器并输出位置
+ *
+ * 舵机每个PWM周期（50Hz时20ms）只锁存一次脉宽，按帧周期采样就是舵机能执行的最细粒度；
+ * 定时器只在有舵机运动时运行，位置没变的舵机不重复写占空比。
+ */
+
+#include "servo_motion.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "servo_motion";
+
+#define LOCK()      xSemaphoreTake(s_mutex, portMAX_DELAY)
+#define UNLOCK()    xSemaphoreGive(s_mutex)
+
+static servo_planner_t s_planner;
+static uint32_t s_last_output[SERVO_MOTION_MAX_SERVOS];
+static uint16_t s_max_angle = 180;
+static servo_motion_output_t s_output = NULL;
+static void *s_output_ctx = NULL;
+static SemaphoreHandle_t s_mutex = NULL;
+static esp_timer_handle_t s_timer = NULL;
+
+static inline uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static inline uint32_t to_centideg(float angle)
+{
+    return angle <= 0.0f ? 0 : (uint32_t)(angle * 100.0f + 0.5f);
+}
+
+static float clamp_angle(float angle)
+{
+    if (angle < 0.0f) {
+        return 0.0f;
+    }
+    return angle > s_max_angle ? (float)s_max_angle : angle;
+}
+
+/**
+ * @brief 定时器回调：推进规划器，位置变化的舵机在同一次回调里输出，全部空闲后停止定时器
+ */
+static void servo_motion_tick(void *arg)
+{
+    (void)arg;
+    LOCK();
+    bool busy = servo_planner_tick(&s_planner, now_ms());
+    uint32_t mask = 0;
+    for (uint8_t i = 0; i < s_planner.count; i++) {
+        uint32_t cdeg = to_centideg(s_planner.axis[i].position);
+        if (cdeg != s_last_output[i]) {
+            s_last_output[i] = cdeg;
+            mask |= 1u << i;
+        }
+    }
+    if (mask) {
+        s_output(mask, s_last_output, s_output_ctx);
+    }
+    if (!busy) {
+        esp_timer_stop(s_timer);
+    }
+    UNLOCK();
+}
+
+/**
+ * @brief 有新路点时启动定时器（持锁调用）
+ */
+static void kick(void)
+{
+    if (!esp_timer_is_active(s_timer)) {
+        esp_timer_start_periodic(s_timer, CONFIG_SERVO_MOTION_TICK_MS * 1000);
+    }
+}
+
+esp_err_t servo_motion_init(uint8_t count, const float *initial, uint16_t max_angle,
+                            servo_motion_output_t output, void *ctx)
+{
+    if (count == 0 || count > SERVO_MOTION_MAX_SERVOS || !output || max_angle == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_mutex = xSemaphoreCreateMutex();
+    if (!s_mutex) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    const esp_timer_create_args_t args = {
+        .callback = servo_motion_tick,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "servo_motion",
+    };
+    esp_err_t ret = esp_timer_create(&args, &s_timer);
+    if (ret != ESP_OK) {
+        vSemaphoreDelete(s_mutex);
+        s_mutex = NULL;
+        return ret;
+    }
+
+    s_max_angle = max_angle;
+    s_output = output;
+    s_output_ctx = ctx;
+    servo_planner_init(&s_planner, count, initial, CONFIG_SERVO_MOTION_MAX_SPEED, CONFIG_SERVO_MOTION_MAX_ACCEL);
+    for (uint8_t i = 0; i < count; i++) {
+        s_last_output[i] = to_centideg(s_planner.axis[i].position);
+    }
+
+    ESP_LOGI(TAG, "✅ 舵机运动控制初始化: %u个舵机, 采样周期 %d ms, 最大速度 %d°/s, 最大加速度 %d°/s²",
+             (unsigned)count, CONFIG_SERVO_MOTION_TICK_MS, CONFIG_SERVO_MOTION_MAX_SPEED,
+             CONFIG_SERVO_MOTION_MAX_ACCEL);
+    return ESP_OK;
+}
+
+esp_err_t servo_motion_queue(uint8_t servo, const servo_waypoint_t *wps, size_t count, uint32_t timeout_ms)
+{
+    if (!s_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!wps || servo >= s_planner.count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    TickType_t start = xTaskGetTickCount();
+    size_t done = 0;
+    while (done < count) {
+        LOCK();
+        while (done < count && servo_planner_space(&s_planner, servo) > 0) {
+            servo_waypoint_t wp = wps[done];
+            wp.angle = clamp_angle(wp.angle);
+            wp.sync_id = 0;
+            servo_planner_push(&s_planner, servo, &wp, now_ms());
+            done++;
+        }
+        kick();
+        UNLOCK();
+
+        if (done < count) {
+            // 队列满：等前面的路点执行掉一些再追加
+            if ((xTaskGetTickCount() - start) >= pdMS_TO_TICKS(timeout_ms)) {
+                ESP_LOGW(TAG, "⚠️ 舵机%u路点队列已满，%u个路点未追加",
+                         (unsigned)(servo + 1), (unsigned)(count - done));
+                return ESP_ERR_TIMEOUT;
+            }
+            vTaskDelay(pdMS_TO_TICKS(CONFIG_SERVO_MOTION_TICK_MS));
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t servo_motion_move(uint8_t servo, float angle, uint16_t duration_ms, servo_profile_t profile)
+{
+    servo_waypoint_t wp = {
+        .angle = angle,
+        .duration_ms = duration_ms,
+        .profile = profile,
+    };
+    return servo_motion_queue(servo, &wp, 1, 0);
+}
+
+esp_err_t servo_motion_move_sync(uint8_t mask, const float *angles, uint16_t duration_ms, servo_profile_t profile)
+{
+    if (!s_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!angles) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    float clamped[SERVO_MOTION_MAX_SERVOS] = {0};
+    for (uint8_t i = 0; i < s_planner.count; i++) {
+        clamped[i] = clamp_angle(angles[i]);
+    }
+
+    LOCK();
+    esp_err_t ret = servo_planner_push_sync(&s_planner, mask, clamped, duration_ms, profile, now_ms());
+    if (ret == ESP_OK) {
+        kick();
+    }
+    UNLOCK();
+    return ret;
+}
+
+esp_err_t servo_motion_stop(uint8_t servo)
+{
+    if (!s_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (servo >= s_planner.count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    LOCK();
+    servo_planner_stop(&s_planner, servo, now_ms());
+    UNLOCK();
+    return ESP_OK;
+}
+
+esp_err_t servo_motion_set_position(uint8_t servo, float angle)
+{
+    if (!s_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (servo >= s_planner.count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    LOCK();
+    servo_planner_set_position(&s_planner, servo, clamp_angle(angle), now_ms());
+    s_last_output[servo] = to_centideg(s_planner.axis[servo].position);
+    UNLOCK();
+    return ESP_OK;
+}
+
+float servo_motion_get_position(uint8_t servo)
+{
+    if (!s_mutex || servo >= s_planner.count) {
+        return 0.0f;
+    }
+    LOCK();
+    float pos = s_planner.axis[servo].position;
+    UNLOCK();
+    return pos;
+}
+
+bool servo_motion_is_idle(uint8_t servo)
+{
+    if (!s_mutex) {
+        return true;
+    }
+    LOCK();
+    bool idle = servo_planner_idle(&s_planner, servo);
+    UNLOCK();
+    return idle;
+}
+
+esp_err_t servo_motion_wait_idle(uint8_t servo, uint32_t timeout_ms)
+{
+    TickType_t start = xTaskGetTickCount();
+    while (!servo_motion_is_idle(servo)) {
+        if ((xTaskGetTickCount() - start) >= pdMS_TO_TICKS(timeout_ms)) {
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_SERVO_MOTION_TICK_MS));
+    }
+    return ESP_OK;
+}
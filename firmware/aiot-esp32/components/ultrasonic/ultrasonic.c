@@ -0,0 +1,68 @@
+/**
+ * @file ultrasonic.c
+ * @brief 超声波测距的声速换算、回波环形缓冲与中值滤波（纯计算，不访问硬件）
+ */
+
+#include "ultrasonic.h"
+#include <math.h>
+
+float ultrasonic_sound_speed(float temp_c)
+{
+    return 331.3f * sqrtf(1.0f + temp_c / 273.15f);
+}
+
+// 单程距离 = 往返时间 × 声速 / 2；us × m/s = 1e-4 cm
+float ultrasonic_echo_to_cm(uint32_t echo_us, float temp_c)
+{
+    return (float)echo_us * ultrasonic_sound_speed(temp_c) / 20000.0f;
+}
+
+uint32_t ultrasonic_cm_to_echo(float cm, float temp_c)
+{
+    return (uint32_t)lroundf(cm * 20000.0f / ultrasonic_sound_speed(temp_c));
+}
+
+size_t ultrasonic_ring_latest(const ultrasonic_ring_t *ring, uint32_t *out, size_t max)
+{
+    uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    size_t n = head < max ? head : max;
+    if (n > ULTRASONIC_RING_SIZE) {
+        n = ULTRASONIC_RING_SIZE;
+    }
+    for (size_t i = 0; i < n; i++) {
+        out[i] = ring->echo_us[(head - 1 - i) & (ULTRASONIC_RING_SIZE - 1)];
+    }
+    return n;
+}
+
+bool ultrasonic_filter(const uint32_t *echoes, size_t count, uint32_t min_us, uint32_t max_us,
+                       ultrasonic_filter_result_t *result)
+{
+    // 窗口很小（<=16），插入排序即可
+    uint32_t sorted[ULTRASONIC_RING_SIZE];
+    size_t valid = 0;
+    if (count > ULTRASONIC_RING_SIZE) {
+        count = ULTRASONIC_RING_SIZE;
+    }
+    for (size_t i = 0; i < count; i++) {
+        uint32_t v = echoes[i];
+        if (v < min_us || v > max_us) {
+            continue;
+        }
+        size_t j = valid++;
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+
+    result->count = (uint8_t)count;
+    result->valid = (uint8_t)valid;
+    result->echo_us = 0;
+    if (valid == 0 || valid * 2 <= count) {
+        return false;
+    }
+    result->echo_us = (valid & 1) ? sorted[valid / 2] : (sorted[valid / 2 - 1] + sorted[valid / 2] + 1) / 2;
+    return true;
+}
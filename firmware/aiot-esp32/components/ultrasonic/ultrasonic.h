@@ -0,0 +1,192 @@
+/**
+ * @file ultrasonic.h
+ * @brief 超声波测距（HC-SR04）：MCPWM硬件触发 + 捕获回波 -> 中值滤波 -> 按气温补偿声速
+ *
+ * 软件方式测距要拉高TRIG 10us，再忙等ECHO的上升沿和下降沿，一次最长25ms以上，
+ * 与DHT11/DS18B20驱动一样会占住调用任务。本组件：
+ *
+ * - MCPWM定时器按 CONFIG_ULTRASONIC_RATE_HZ 周期运行，生成器在每个周期开始输出
+ *   ULTRASONIC_TRIGGER_US 的TRIG脉冲，不需要CPU参与；
+ * - ECHO接MCPWM捕获通道，双边沿捕获定时器计数，捕获中断里只做一次减法，
+ *   把回波宽度写入单生产者的环形缓冲；
+ * - 读取时取最近 CONFIG_ULTRASONIC_MEDIAN_WINDOW 个回波，剔除超出量程的，
+ *   取中值，再按当前气温的声速换算成距离。没有任务，读取不等待。
+ *
+ * 声速、回波换算、环形缓冲和中值滤波（ultrasonic_sound_speed / ultrasonic_echo_to_cm /
+ * ultrasonic_ring_* / ultrasonic_filter）是纯计算，可在主机上测试；
+ * MCPWM配置和读数接口在 ultrasonic_mcpwm.c 中。
+ */
+
+#ifndef ULTRASONIC_H
+#define ULTRASONIC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_ULTRASONIC_RATE_HZ
+#define CONFIG_ULTRASONIC_RATE_HZ           20      ///< 测距频率（16~40Hz）
+#endif
+
+#ifndef CONFIG_ULTRASONIC_MEDIAN_WINDOW
+#define CONFIG_ULTRASONIC_MEDIAN_WINDOW     5       ///< 中值滤波的回波个数
+#endif
+
+#ifndef CONFIG_ULTRASONIC_MAX_RANGE_CM
+#define CONFIG_ULTRASONIC_MAX_RANGE_CM      400
+#endif
+
+#ifndef CONFIG_ULTRASONIC_STALE_MS
+#define CONFIG_ULTRASONIC_STALE_MS          300     ///< 超过此时间没有回波视为传感器无响应
+#endif
+
+#define ULTRASONIC_MIN_RANGE_CM     2
+#define ULTRASONIC_TRIGGER_US       12              ///< 数据手册要求至少10us
+#define ULTRASONIC_RING_SIZE        16              ///< 2的幂，不小于滤波窗口
+#define ULTRASONIC_DEFAULT_TEMP_C   20.0f
+
+/* ==================== 声速与换算 ==================== */
+
+/**
+ * @brief 干燥空气中的声速（m/s）：331.3 × √(1 + T/273.15)
+ */
+float ultrasonic_sound_speed(float temp_c);
+
+/**
+ * @brief 回波宽度（往返时间）换算成单程距离（cm）
+ */
+float ultrasonic_echo_to_cm(uint32_t echo_us, float temp_c);
+
+/**
+ * @brief 距离换算成回波宽度（us）
+ */
+uint32_t ultrasonic_cm_to_echo(float cm, float temp_c);
+
+/* ==================== 回波环形缓冲 ==================== */
+
+/**
+ * @brief 回波宽度环形缓冲：捕获中断是唯一的写者，读者只取最近的若干项，不移动读指针
+ */
+typedef struct {
+    uint32_t echo_us[ULTRASONIC_RING_SIZE];
+    uint32_t head;                  ///< 写入总数（自由运行）
+} ultrasonic_ring_t;
+
+/**
+ * @brief 写入一个回波宽度（捕获中断调用）
+ */
+static inline void ultrasonic_ring_push(ultrasonic_ring_t *ring, uint32_t echo_us)
+{
+    uint32_t head = ring->head;
+    ring->echo_us[head & (ULTRASONIC_RING_SIZE - 1)] = echo_us;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief 复制最近的 max 个回波（新的在前）
+ *
+ * 窗口远小于环形缓冲，复制期间写者追上读者需要十几个测距周期，不会读到半写的项。
+ *
+ * @return 复制的个数（写入总数不足 max 时更少）
+ */
+size_t ultrasonic_ring_latest(const ultrasonic_ring_t *ring, uint32_t *out, size_t max);
+
+/* ==================== 中值滤波 ==================== */
+
+/**
+ * @brief 滤波结果
+ */
+typedef struct {
+    uint32_t echo_us;               ///< 有效回波的中值
+    uint8_t valid;                  ///< 窗口中有效回波数
+    uint8_t count;                  ///< 窗口中回波数
+} ultrasonic_filter_result_t;
+
+/**
+ * @brief 剔除 [min_us, max_us] 之外的回波后取中值（偶数个时取中间两个的平均）
+ *
+ * @return true=有效回波超过窗口的一半，false=多数回波超出量程（前方没有目标或被干扰）
+ */
+bool ultrasonic_filter(const uint32_t *echoes, size_t count, uint32_t min_us, uint32_t max_us,
+                       ultrasonic_filter_result_t *result);
+
+/* ==================== 运行时 ==================== */
+
+/**
+ * @brief 传感器配置
+ */
+typedef struct {
+    gpio_num_t trig;                ///< TRIG，MCPWM生成器输出
+    gpio_num_t echo;                ///< ECHO，MCPWM捕获输入（5V模块需分压到3.3V）
+} ultrasonic_config_t;
+
+/**
+ * @brief 测距读数
+ */
+typedef struct {
+    float distance_cm;
+    uint32_t echo_us;               ///< 滤波后的回波宽度
+    float temp_c;                   ///< 换算所用的气温
+    uint8_t valid;                  ///< 窗口中有效回波数
+    uint8_t window;                 ///< 窗口中回波数
+    uint32_t age_ms;                ///< 距最近一次回波的时间
+} ultrasonic_reading_t;
+
+/**
+ * @brief 运行统计
+ */
+typedef struct {
+    uint32_t echoes;                ///< 捕获的完整回波数
+    uint32_t reads;                 ///< 读取次数
+    uint32_t no_target;             ///< 多数回波超出量程的读取次数
+    uint32_t stale;                 ///< 传感器无响应的读取次数
+} ultrasonic_stats_t;
+
+/**
+ * @brief 配置MCPWM并开始连续测距
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 引脚无效
+ *   - ESP_ERR_INVALID_STATE: 已经在运行
+ *   - 其他: MCPWM驱动错误
+ */
+esp_err_t ultrasonic_start(const ultrasonic_config_t *config);
+
+/**
+ * @brief 停止测距并释放MCPWM资源
+ */
+void ultrasonic_stop(void);
+
+/**
+ * @brief 设置换算声速所用的气温（默认20°C）
+ */
+void ultrasonic_set_temperature(float temp_c);
+
+/**
+ * @brief 读取滤波后的距离（不等待回波）
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_STATE: 没有在运行
+ *   - ESP_ERR_TIMEOUT: CONFIG_ULTRASONIC_STALE_MS 内没有回波（接线或供电问题）
+ *   - ESP_ERR_NOT_FOUND: 量程内没有目标（out 中其余字段仍有效）
+ */
+esp_err_t ultrasonic_read(ultrasonic_reading_t *out);
+
+/**
+ * @brief 获取运行统计
+ */
+esp_err_t ultrasonic_get_stats(ultrasonic_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ULTRASONIC_H
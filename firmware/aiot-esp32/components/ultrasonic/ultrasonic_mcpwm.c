@@ -0,0 +1,347 @@
+/**
+ * @file ultrasonic_mcpwm.c
+ * @brief 超声波测距运行时：MCPWM生成TRIG脉冲、捕获ECHO脉宽、读数接口
+ *
+ * 触发：MCPWM定时器（1MHz计数，周期 1/CONFIG_ULTRASONIC_RATE_HZ）从0开始计数时生成器
+ * 输出高电平，计数到 ULTRASONIC_TRIGGER_US 时比较器事件拉低，TRIG脉冲完全由硬件产生。
+ * 16位周期寄存器在1MHz下最长65.5ms，因此测距频率下限为16Hz。
+ *
+ * 回波：捕获通道对ECHO双边沿锁存捕获定时器的计数，中断里上升沿记下计数，
+ * 下降沿算出脉宽写入环形缓冲并记录时间，不唤醒任何任务。
+ * 量程外没有目标时HC-SR04的回波约38ms，超过下一个周期，这一次触发被模块忽略，
+ * 读取时按量程剔除。
+ *
+ * 使用MCPWM组0；舵机和PWM输出走LEDC，不占用MCPWM。
+ */
+
+#include "ultrasonic.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "driver/mcpwm_prelude.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "metrics.h"
+
+static const char *TAG = "ultrasonic";
+
+#define LOCK()      xSemaphoreTake(s_mutex, portMAX_DELAY)
+#define UNLOCK()    xSemaphoreGive(s_mutex)
+
+#define MCPWM_GROUP             0
+#define TRIG_RESOLUTION_HZ      1000000
+#define TRIG_PERIOD_TICKS       (TRIG_RESOLUTION_HZ / CONFIG_ULTRASONIC_RATE_HZ)
+
+static SemaphoreHandle_t s_mutex = NULL;
+
+static struct {
+    bool running;
+    ultrasonic_config_t config;
+    mcpwm_timer_handle_t timer;
+    mcpwm_oper_handle_t oper;
+    mcpwm_cmpr_handle_t cmpr;
+    mcpwm_gen_handle_t gen;
+    bool timer_enabled;
+    mcpwm_cap_timer_handle_t cap_timer;
+    mcpwm_cap_channel_handle_t cap_chan;
+    bool cap_enabled;
+    uint32_t cap_resolution_hz;
+    uint32_t rise_tick;                 ///< 以下三项只由捕获中断写
+    bool rising;
+    volatile uint32_t echo_at_ms;
+    ultrasonic_ring_t ring;
+    float temp_c;
+    ultrasonic_stats_t stats;
+} s_us;
+
+METRIC_COUNTER_DEFINE(s_m_stale, "ultrasonic_stale");
+METRIC_COUNTER_DEFINE(s_m_no_target, "ultrasonic_no_target");
+
+/* ==================== 捕获中断 ==================== */
+
+static bool IRAM_ATTR on_capture(mcpwm_cap_channel_handle_t chan, const mcpwm_capture_event_data_t *edata,
+                                 void *user_data)
+{
+    (void)chan;
+    (void)user_data;
+    if (edata->cap_edge == MCPWM_CAP_EDGE_POS) {
+        s_us.rise_tick = edata->cap_value;
+        s_us.rising = true;
+    } else if (s_us.rising) {
+        // 捕获定时器32位自由计数，无符号减法跨越回绕也正确
+        uint32_t ticks = edata->cap_value - s_us.rise_tick;
+        ultrasonic_ring_push(&s_us.ring, (uint32_t)((uint64_t)ticks * 1000000u / s_us.cap_resolution_hz));
+        s_us.echo_at_ms = (uint32_t)(esp_timer_get_time() / 1000);
+        s_us.rising = false;
+    }
+    return false;
+}
+
+/* ==================== MCPWM ==================== */
+
+static void release_all(void)
+{
+    if (s_us.cap_enabled) {
+        mcpwm_capture_timer_stop(s_us.cap_timer);
+        mcpwm_capture_channel_disable(s_us.cap_chan);
+        mcpwm_capture_timer_disable(s_us.cap_timer);
+        s_us.cap_enabled = false;
+    }
+    if (s_us.cap_chan) {
+        mcpwm_del_capture_channel(s_us.cap_chan);
+        s_us.cap_chan = NULL;
+    }
+    if (s_us.cap_timer) {
+        mcpwm_del_capture_timer(s_us.cap_timer);
+        s_us.cap_timer = NULL;
+    }
+    if (s_us.timer_enabled) {
+        mcpwm_timer_start_stop(s_us.timer, MCPWM_TIMER_STOP_EMPTY);
+        mcpwm_timer_disable(s_us.timer);
+        s_us.timer_enabled = false;
+    }
+    if (s_us.gen) {
+        mcpwm_del_generator(s_us.gen);
+        s_us.gen = NULL;
+    }
+    if (s_us.cmpr) {
+        mcpwm_del_comparator(s_us.cmpr);
+        s_us.cmpr = NULL;
+    }
+    if (s_us.oper) {
+        mcpwm_del_operator(s_us.oper);
+        s_us.oper = NULL;
+    }
+    if (s_us.timer) {
+        mcpwm_del_timer(s_us.timer);
+        s_us.timer = NULL;
+    }
+}
+
+/**
+ * @brief ECHO捕获：双边沿，捕获定时器与触发定时器同组
+ */
+static esp_err_t setup_capture(gpio_num_t echo)
+{
+    mcpwm_capture_timer_config_t timer_config = {
+        .group_id = MCPWM_GROUP,
+        .clk_src = MCPWM_CAPTURE_CLK_SRC_DEFAULT,
+    };
+    esp_err_t ret = mcpwm_new_capture_timer(&timer_config, &s_us.cap_timer);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    mcpwm_capture_channel_config_t chan_config = {
+        .gpio_num = echo,
+        .prescale = 1,
+        .flags.pos_edge = true,
+        .flags.neg_edge = true,
+        .flags.pull_up = false,
+        .flags.pull_down = true,            // 模块未接时ECHO保持低电平
+    };
+    ret = mcpwm_new_capture_channel(s_us.cap_timer, &chan_config, &s_us.cap_chan);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    mcpwm_capture_event_callbacks_t cbs = {
+        .on_cap = on_capture,
+    };
+    ret = mcpwm_capture_channel_register_event_callbacks(s_us.cap_chan, &cbs, NULL);
+    if (ret == ESP_OK) {
+        ret = mcpwm_capture_timer_get_resolution(s_us.cap_timer, &s_us.cap_resolution_hz);
+    }
+    if (ret == ESP_OK) {
+        ret = mcpwm_capture_channel_enable(s_us.cap_chan);
+    }
+    if (ret == ESP_OK) {
+        ret = mcpwm_capture_timer_enable(s_us.cap_timer);
+    }
+    if (ret == ESP_OK) {
+        s_us.cap_enabled = true;
+        ret = mcpwm_capture_timer_start(s_us.cap_timer);
+    }
+    return ret;
+}
+
+/**
+ * @brief TRIG：计数器归零时拉高，计数到 ULTRASONIC_TRIGGER_US 时拉低
+ */
+static esp_err_t setup_trigger(gpio_num_t trig)
+{
+    mcpwm_timer_config_t timer_config = {
+        .group_id = MCPWM_GROUP,
+        .clk_src = MCPWM_TIMER_CLK_SRC_DEFAULT,
+        .resolution_hz = TRIG_RESOLUTION_HZ,
+        .count_mode = MCPWM_TIMER_COUNT_MODE_UP,
+        .period_ticks = TRIG_PERIOD_TICKS,
+    };
+    esp_err_t ret = mcpwm_new_timer(&timer_config, &s_us.timer);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    mcpwm_operator_config_t oper_config = {
+        .group_id = MCPWM_GROUP,
+    };
+    ret = mcpwm_new_operator(&oper_config, &s_us.oper);
+    if (ret == ESP_OK) {
+        ret = mcpwm_operator_connect_timer(s_us.oper, s_us.timer);
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    mcpwm_comparator_config_t cmpr_config = {
+        .flags.update_cmp_on_tez = true,
+    };
+    ret = mcpwm_new_comparator(s_us.oper, &cmpr_config, &s_us.cmpr);
+    if (ret == ESP_OK) {
+        ret = mcpwm_comparator_set_compare_value(s_us.cmpr, ULTRASONIC_TRIGGER_US * (TRIG_RESOLUTION_HZ / 1000000));
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    mcpwm_generator_config_t gen_config = {
+        .gen_gpio_num = trig,
+    };
+    ret = mcpwm_new_generator(s_us.oper, &gen_config, &s_us.gen);
+    if (ret == ESP_OK) {
+        ret = mcpwm_generator_set_action_on_timer_event(s_us.gen,
+                MCPWM_GEN_TIMER_EVENT_ACTION(MCPWM_TIMER_DIRECTION_UP, MCPWM_TIMER_EVENT_EMPTY, MCPWM_GEN_ACTION_HIGH));
+    }
+    if (ret == ESP_OK) {
+        ret = mcpwm_generator_set_action_on_compare_event(s_us.gen,
+                MCPWM_GEN_COMPARE_EVENT_ACTION(MCPWM_TIMER_DIRECTION_UP, s_us.cmpr, MCPWM_GEN_ACTION_LOW));
+    }
+    if (ret == ESP_OK) {
+        ret = mcpwm_timer_enable(s_us.timer);
+    }
+    if (ret == ESP_OK) {
+        s_us.timer_enabled = true;
+        ret = mcpwm_timer_start_stop(s_us.timer, MCPWM_TIMER_START_NO_STOP);
+    }
+    return ret;
+}
+
+/* ==================== 接口 ==================== */
+
+esp_err_t ultrasonic_start(const ultrasonic_config_t *config)
+{
+    if (!config || config->trig < 0 || config->echo < 0 || config->trig == config->echo ||
+        TRIG_PERIOD_TICKS > 0xFFFF) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    if (s_us.running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memset(&s_us, 0, sizeof(s_us));
+    s_us.config = *config;
+    s_us.temp_c = ULTRASONIC_DEFAULT_TEMP_C;
+
+    // 先开捕获再开触发，第一个回波不会漏掉上升沿
+    esp_err_t ret = setup_capture(config->echo);
+    if (ret == ESP_OK) {
+        ret = setup_trigger(config->trig);
+    }
+    if (ret != ESP_OK) {
+        release_all();
+        ESP_LOGE(TAG, "❌ HC-SR04 MCPWM配置失败 (TRIG GPIO%d, ECHO GPIO%d): %s",
+                 config->trig, config->echo, esp_err_to_name(ret));
+        return ret;
+    }
+    s_us.running = true;
+
+    ESP_LOGI(TAG, "✅ HC-SR04连续测距: TRIG GPIO%d, ECHO GPIO%d, %d Hz, 中值窗口%d",
+             config->trig, config->echo, CONFIG_ULTRASONIC_RATE_HZ, CONFIG_ULTRASONIC_MEDIAN_WINDOW);
+    return ESP_OK;
+}
+
+void ultrasonic_stop(void)
+{
+    if (!s_us.running) {
+        return;
+    }
+    s_us.running = false;
+    release_all();
+}
+
+void ultrasonic_set_temperature(float temp_c)
+{
+    // 超出DHT类传感器量程的读数视为错误，保留原值
+    if (!s_mutex || temp_c < -40.0f || temp_c > 85.0f) {
+        return;
+    }
+    LOCK();
+    s_us.temp_c = temp_c;
+    UNLOCK();
+}
+
+esp_err_t ultrasonic_read(ultrasonic_reading_t *out)
+{
+    if (!out) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mutex || !s_us.running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint32_t echoes[CONFIG_ULTRASONIC_MEDIAN_WINDOW];
+    size_t n = ultrasonic_ring_latest(&s_us.ring, echoes, CONFIG_ULTRASONIC_MEDIAN_WINDOW);
+    uint32_t age_ms = (uint32_t)(esp_timer_get_time() / 1000) - s_us.echo_at_ms;
+
+    LOCK();
+    float temp_c = s_us.temp_c;
+    s_us.stats.reads++;
+    UNLOCK();
+
+    memset(out, 0, sizeof(*out));
+    out->temp_c = temp_c;
+    out->age_ms = age_ms;
+    if (n == 0 || age_ms > CONFIG_ULTRASONIC_STALE_MS) {
+        metric_inc(&s_m_stale);
+        LOCK();
+        s_us.stats.stale++;
+        UNLOCK();
+        return ESP_ERR_TIMEOUT;
+    }
+
+    ultrasonic_filter_result_t result;
+    bool found = ultrasonic_filter(echoes, n, ultrasonic_cm_to_echo(ULTRASONIC_MIN_RANGE_CM, temp_c),
+                                   ultrasonic_cm_to_echo(CONFIG_ULTRASONIC_MAX_RANGE_CM, temp_c), &result);
+    out->echo_us = result.echo_us;
+    out->valid = result.valid;
+    out->window = result.count;
+    if (!found) {
+        metric_inc(&s_m_no_target);
+        LOCK();
+        s_us.stats.no_target++;
+        UNLOCK();
+        return ESP_ERR_NOT_FOUND;
+    }
+    out->distance_cm = ultrasonic_echo_to_cm(result.echo_us, temp_c);
+    return ESP_OK;
+}
+
+esp_err_t ultrasonic_get_stats(ultrasonic_stats_t *stats)
+{
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mutex) {
+        memset(stats, 0, sizeof(*stats));
+        return ESP_OK;
+    }
+    LOCK();
+    *stats = s_us.stats;
+    stats->echoes = __atomic_load_n(&s_us.ring.head, __ATOMIC_ACQUIRE);
+    UNLOCK();
+    return ESP_OK;
+}
@@ -430,7 +430,7 @@ static void lcd_check_gpio_status(void) {
         "MOSI/SDA", "CLK/SCL", "RST/RES", "DC", "CS", "BACKLIGHT/BLK"
     };
     
-    for (int i = 0; i < sizeof(lcd_pins)/sizeof(lcd_pins[0]); i++) {
+    for (size_t i = 0; i < sizeof(lcd_pins)/sizeof(lcd_pins[0]); i++) {
         gpio_num_t pin = lcd_pins[i];
         
         // 检查引脚是否有效
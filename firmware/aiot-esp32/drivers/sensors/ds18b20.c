@@ -50,7 +50,7 @@ static const char *TAG = "DS18B20";
 #define DS18B20_READ_RECOVERY_TIME  45
 
 // 转换时间
-#define DS18B20_CONVERSION_TIME_MS  750
+#define DS18B20_CONVERSION_TIME_MS  DS18B20_CONVERSION_MS
 
 // 全局变量
 static ds18b20_config_t g_ds18b20_config;
@@ -270,24 +270,14 @@ esp_err_t ds18b20_init(const ds18b20_config_t *config)
     return ESP_OK;
 }
 
-esp_err_t ds18b20_read(ds18b20_data_t *data)
+esp_err_t ds18b20_start_conversion(void)
 {
     if (!g_ds18b20_initialized) {
         ESP_LOGE(TAG, "DS18B20 not initialized");
         return ESP_ERR_INVALID_STATE;
     }
     
-    if (!data) {
-        ESP_LOGE(TAG, "Data pointer is NULL");
-        return ESP_ERR_INVALID_ARG;
-    }
-    
     gpio_num_t pin = g_ds18b20_config.data_pin;
-    uint8_t scratchpad[9];
-    
-    // 初始化数据
-    data->temperature = 0.0f;
-    data->valid = false;
     
     // 复位并检查传感器存在
     if (!ds18b20_reset(pin)) {
@@ -301,8 +291,27 @@ esp_err_t ds18b20_read(ds18b20_data_t *data)
     // 启动温度转换
     ds18b20_write_byte(pin, DS18B20_CMD_CONVERT_T);
     
-    // 等待转换完成
-    vTaskDelay(pdMS_TO_TICKS(DS18B20_CONVERSION_TIME_MS));
+    return ESP_OK;
+}
+
+esp_err_t ds18b20_read_converted(ds18b20_data_t *data)
+{
+    if (!g_ds18b20_initialized) {
+        ESP_LOGE(TAG, "DS18B20 not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (!data) {
+        ESP_LOGE(TAG, "Data pointer is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    gpio_num_t pin = g_ds18b20_config.data_pin;
+    uint8_t scratchpad[9];
+    
+    // 初始化数据
+    data->temperature = 0.0f;
+    data->valid = false;
     
     // 再次复位
     if (!ds18b20_reset(pin)) {
@@ -338,6 +347,27 @@ esp_err_t ds18b20_read(ds18b20_data_t *data)
     return ESP_OK;
 }
 
+esp_err_t ds18b20_read(ds18b20_data_t *data)
+{
+    if (!data) {
+        ESP_LOGE(TAG, "Data pointer is NULL");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    data->temperature = 0.0f;
+    data->valid = false;
+    
+    esp_err_t ret = ds18b20_start_conversion();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    // 等待转换完成
+    vTaskDelay(pdMS_TO_TICKS(DS18B20_CONVERSION_TIME_MS));
+    
+    return ds18b20_read_converted(data);
+}
+
 bool ds18b20_is_initialized(void)
 {
     return g_ds18b20_initialized;
@@ -10,6 +10,8 @@
 extern "C" {
 #endif
 
+#define DS18B20_CONVERSION_MS   750     ///< 12位分辨率最长转换时间
+
 /**
  * @brief DS18B20传感器配置结构体
  */
@@ -49,6 +51,31 @@ esp_err_t ds18b20_init(const ds18b20_config_t *config);
  */
 esp_err_t ds18b20_read(ds18b20_data_t *data);
 
+/**
+ * @brief 启动温度转换后立即返回（不等待）
+ * 
+ * 与 ds18b20_read_converted() 配合使用：两次调用之间至少间隔 DS18B20_CONVERSION_MS，
+ * 期间总线空闲，调用方可以去读其他传感器。
+ * 
+ * @return esp_err_t 
+ *         - ESP_OK: 已启动转换
+ *         - ESP_ERR_INVALID_STATE: 传感器未初始化
+ *         - ESP_ERR_TIMEOUT: 传感器无应答
+ */
+esp_err_t ds18b20_start_conversion(void);
+
+/**
+ * @brief 读取已完成转换的温度（不启动转换）
+ * 
+ * @param data 输出数据结构体
+ * @return esp_err_t 
+ *         - ESP_OK: 读取成功
+ *         - ESP_ERR_INVALID_STATE: 传感器未初始化
+ *         - ESP_ERR_TIMEOUT: 传感器无应答
+ *         - ESP_FAIL: CRC校验失败
+ */
+esp_err_t ds18b20_read_converted(ds18b20_data_t *data);
+
 /**
  * @brief 检查DS18B20传感器是否已初始化
  * 
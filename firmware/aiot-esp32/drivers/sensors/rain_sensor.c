@@ -11,21 +11,57 @@
  * - 高电平(1): 无雨水，传感器表面干燥
  * - 低电平(0): 有雨水，传感器表面湿润导致短路
  * - 需要上拉电阻确保高电平稳定
+ * - 模拟输出AO随湿润面积下降，由 adc_stream 连续采样并过采样平均，
+ *   按干燥/湿润两点标定换算成湿润程度
  **************************************************************************************************** 
  */ 
 
 #include "rain_sensor.h"
+#include "adc_stream.h"
 #include "esp_log.h"
+#include "esp_attr.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include <string.h>
 
 static const char *TAG = "RAIN_SENSOR";
 
+#define RAIN_SENSOR_DRY_MV_DEFAULT  3000
+#define RAIN_SENSOR_WET_MV_DEFAULT  500
+#define RAIN_SENSOR_WET_ON_PCT      40.0f   // 只有AO时：湿润程度达到此值判为下雨
+#define RAIN_SENSOR_WET_OFF_PCT     30.0f   // 低于此值判为无雨
+
 // 全局配置和状态
 static rain_sensor_config_t g_rain_sensor_config;
 static rain_sensor_data_t g_last_data = {0};
 static bool g_initialized = false;
+static TaskHandle_t g_notify_task = NULL;  // 电平变化时通知的任务
+static adc_stream_curve_t g_wet_curve;     // AO电压 -> 湿润程度
+static int g_analog_index = -1;            // adc_stream 通道下标，-1表示未启用
+
+/**
+ * @brief 启用AO连续采样（干燥电压高、湿润电压低）
+ */
+static esp_err_t rain_sensor_analog_init(const rain_sensor_config_t *config)
+{
+    uint16_t dry_mv = config->dry_mv ? config->dry_mv : RAIN_SENSOR_DRY_MV_DEFAULT;
+    uint16_t wet_mv = config->wet_mv ? config->wet_mv : RAIN_SENSOR_WET_MV_DEFAULT;
+    if (wet_mv >= dry_mv) {
+        ESP_LOGE(TAG, "Invalid analog calibration: wet %u mV >= dry %u mV", wet_mv, dry_mv);
+        return ESP_ERR_INVALID_ARG;
+    }
+    g_wet_curve.count = 2;
+    g_wet_curve.points[0] = (adc_stream_point_t) { .mv = wet_mv, .value = 100.0f };
+    g_wet_curve.points[1] = (adc_stream_point_t) { .mv = dry_mv, .value = 0.0f };
+
+    adc_stream_channel_config_t channel = {
+        .gpio = config->analog_pin,
+        .atten_db = 12,
+        .curve = &g_wet_curve,
+        .name = "RAIN_AO",
+    };
+    return adc_stream_add_channel(&channel, &g_analog_index);
+}
 
 /**
  * @brief 初始化雨水传感器
@@ -40,26 +76,43 @@ esp_err_t rain_sensor_init(const rain_sensor_config_t *config)
         return ESP_ERR_INVALID_ARG;
     }
     
-    if (config->data_pin < 0) {
+    // 只接AO时数字引脚可以不接
+    if (config->data_pin < 0 && !config->analog_enable) {
         ESP_LOGE(TAG, "Invalid data pin: %d", config->data_pin);
         return ESP_ERR_INVALID_ARG;
     }
     
     ESP_LOGI(TAG, "Initializing rain sensor on GPIO%d", config->data_pin);
     
-    // 配置GPIO为输入模式
-    gpio_config_t io_conf = {
-        .pin_bit_mask = (1ULL << config->data_pin),
-        .mode = GPIO_MODE_INPUT,
-        .pull_up_en = config->pull_up_enable ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE,
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .intr_type = GPIO_INTR_DISABLE
-    };
+    esp_err_t ret;
+    if (config->data_pin >= 0) {
+        // 配置GPIO为输入模式
+        gpio_config_t io_conf = {
+            .pin_bit_mask = (1ULL << config->data_pin),
+            .mode = GPIO_MODE_INPUT,
+            .pull_up_en = config->pull_up_enable ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE,
+            .pull_down_en = GPIO_PULLDOWN_DISABLE,
+            .intr_type = GPIO_INTR_DISABLE
+        };
+        
+        ret = gpio_config(&io_conf);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "GPIO configuration failed: %s", esp_err_to_name(ret));
+            return ret;
+        }
+    }
     
-    esp_err_t ret = gpio_config(&io_conf);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "GPIO configuration failed: %s", esp_err_to_name(ret));
-        return ret;
+    g_analog_index = -1;
+    if (config->analog_enable) {
+        ret = rain_sensor_analog_init(config);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Analog output on GPIO%d unavailable: %s", config->analog_pin, esp_err_to_name(ret));
+            if (config->data_pin < 0) {
+                return ret;
+            }
+        } else {
+            ESP_LOGI(TAG, "Analog wetness on GPIO%d", config->analog_pin);
+        }
     }
     
     // 保存配置
@@ -98,6 +151,31 @@ esp_err_t rain_sensor_read(rain_sensor_data_t *data)
         return ESP_ERR_INVALID_ARG;
     }
     
+    // 模拟输出：读取最近的平均值（不阻塞）
+    data->wetness = -1.0f;
+    data->analog_mv = 0;
+    if (g_analog_index >= 0) {
+        adc_stream_value_t value;
+        if (adc_stream_read(g_analog_index, &value) == ESP_OK) {
+            data->wetness = value.value;
+            data->analog_mv = (uint16_t)(value.mv + 0.5f);
+        }
+    }
+    
+    // 只接AO：按湿润程度带回差判断
+    if (g_rain_sensor_config.data_pin < 0) {
+        bool raining = g_last_data.valid && g_last_data.is_raining;
+        if (data->wetness >= 0.0f) {
+            raining = raining ? data->wetness >= RAIN_SENSOR_WET_OFF_PCT
+                              : data->wetness >= RAIN_SENSOR_WET_ON_PCT;
+        }
+        data->is_raining = raining;
+        data->level = raining ? 0 : 1;
+        data->valid = data->wetness >= 0.0f;
+        memcpy(&g_last_data, data, sizeof(rain_sensor_data_t));
+        return ESP_OK;
+    }
+    
     // 读取GPIO电平值
     int level = gpio_get_level(g_rain_sensor_config.data_pin);
     
@@ -163,6 +241,10 @@ uint8_t rain_sensor_get_level(void)
         return 1;  // 默认返回高电平（无雨）
     }
     
+    if (g_rain_sensor_config.data_pin < 0) {
+        return g_last_data.is_raining ? 0 : 1;
+    }
+    
     return (uint8_t)gpio_get_level(g_rain_sensor_config.data_pin);
 }
 
@@ -177,6 +259,66 @@ bool rain_sensor_is_ready(void)
     return g_initialized;
 }
 
+/**
+ * @brief 电平变化中断：只通知任务，去抖和读取在任务中完成
+ */
+static void IRAM_ATTR rain_sensor_edge_isr(void *arg)
+{
+    TaskHandle_t task = (TaskHandle_t)arg;
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    vTaskNotifyGiveFromISR(task, &higher_priority_task_woken);
+    if (higher_priority_task_woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+/**
+ * @brief 启用电平变化中断通知
+ * 
+ * @param task 接收通知的任务，NULL表示关闭中断
+ * @return esp_err_t ESP_OK表示成功
+ */
+esp_err_t rain_sensor_enable_edge_notify(TaskHandle_t task)
+{
+    if (!g_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    gpio_num_t pin = g_rain_sensor_config.data_pin;
+    if (pin < 0) {
+        return task ? ESP_ERR_NOT_SUPPORTED : ESP_OK;
+    }
+    if (g_notify_task) {
+        gpio_intr_disable(pin);
+        gpio_isr_handler_remove(pin);
+        gpio_set_intr_type(pin, GPIO_INTR_DISABLE);
+        g_notify_task = NULL;
+    }
+    if (!task) {
+        return ESP_OK;
+    }
+    
+    // 按键模块可能已安装ISR服务
+    esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "GPIO ISR service install failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    gpio_set_intr_type(pin, GPIO_INTR_ANYEDGE);
+    ret = gpio_isr_handler_add(pin, rain_sensor_edge_isr, (void *)task);
+    if (ret != ESP_OK) {
+        gpio_set_intr_type(pin, GPIO_INTR_DISABLE);
+        ESP_LOGE(TAG, "GPIO ISR handler add failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    g_notify_task = task;
+    gpio_intr_enable(pin);
+    
+    ESP_LOGI(TAG, "Rain sensor edge interrupt enabled on GPIO%d", pin);
+    return ESP_OK;
+}
+
 /**
  * @brief 去初始化雨水传感器
  * 
@@ -190,8 +332,15 @@ esp_err_t rain_sensor_deinit(void)
     
     ESP_LOGI(TAG, "Deinitializing rain sensor...");
     
+    rain_sensor_enable_edge_notify(NULL);
+    
     // 重置GPIO配置（可选）
-    gpio_reset_pin(g_rain_sensor_config.data_pin);
+    if (g_rain_sensor_config.data_pin >= 0) {
+        gpio_reset_pin(g_rain_sensor_config.data_pin);
+    }
+    
+    // adc_stream 通道保留，重新初始化时按引脚取回原下标
+    g_analog_index = -1;
     
     g_initialized = false;
     memset(&g_rain_sensor_config, 0, sizeof(rain_sensor_config_t));
@@ -9,6 +9,9 @@
  * 雨水传感器是一个数字传感器，通过GPIO读取高低电平来判断是否有雨水
  * - 高电平(1): 无雨水
  * - 低电平(0): 有雨水
+ * 
+ * 模块的模拟输出AO接到ADC1引脚时，还可以通过 adc_stream 连续采样得到湿润程度(0~100%)；
+ * 只接AO（data_pin 为 GPIO_NUM_NC）时按湿润程度带回差判断是否下雨。
  **************************************************************************************************** 
  */ 
 
@@ -19,6 +22,8 @@
 #include <stdbool.h>
 #include "driver/gpio.h"
 #include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -31,6 +36,8 @@ typedef struct {
     bool is_raining;     // 是否下雨 (true=有雨, false=无雨)
     uint8_t level;       // 电平值 (0=低电平/有雨, 1=高电平/无雨)
     bool valid;          // 数据是否有效
+    float wetness;       // 湿润程度 0~100% (未启用模拟输出或还没有平均值时为-1)
+    uint16_t analog_mv;  // AO电压(mV)
 } rain_sensor_data_t;
 
 /**
@@ -40,6 +47,10 @@ typedef struct {
     gpio_num_t data_pin;    // 数据引脚 (GPIO4)
     bool pull_up_enable;    // 是否启用上拉电阻 (默认true)
     uint32_t debounce_ms;   // 防抖时间(毫秒) (默认50ms)
+    bool analog_enable;     // 是否采集模拟输出AO
+    gpio_num_t analog_pin;  // AO引脚（ADC1通道）
+    uint16_t dry_mv;        // 完全干燥时的AO电压 (0=默认3000mV)
+    uint16_t wet_mv;        // 完全湿润时的AO电压 (0=默认500mV)
 } rain_sensor_config_t;
 
 /**
@@ -81,6 +92,17 @@ uint8_t rain_sensor_get_level(void);
  */
 bool rain_sensor_is_ready(void);
 
+/**
+ * @brief 启用电平变化中断通知
+ * 
+ * 传感器引脚任一边沿触发中断，中断中向指定任务发送通知（vTaskNotifyGiveFromISR），
+ * 任务被唤醒后调用 rain_sensor_read() 读取去抖后的电平，不需要再轮询。
+ * 
+ * @param task 接收通知的任务，NULL表示关闭中断
+ * @return esp_err_t ESP_OK表示成功，ESP_ERR_NOT_SUPPORTED表示没有数字引脚
+ */
+esp_err_t rain_sensor_enable_edge_notify(TaskHandle_t task);
+
 /**
  * @brief 去初始化雨水传感器
  * 
@@ -54,13 +54,6 @@ uint16_t g_char_handle_write = 0;
 uint16_t g_char_handle_read = 0;
 uint16_t g_char_handle_notify = 0;
 static esp_timer_handle_t g_provision_timer = NULL;
-EventGroupHandle_t g_wifi_event_group = NULL;
-static esp_event_handler_instance_t g_wifi_handler_instance = NULL;
-static esp_event_handler_instance_t g_ip_handler_instance = NULL;
-
-// WiFi事件位
-#define WIFI_CONNECTED_BIT BIT0
-#define WIFI_FAIL_BIT      BIT1
 #endif
 
 // ==================== 私有函数声明 ====================
@@ -77,7 +70,6 @@ static void bt_provision_timeout_callback(void* arg);
 #ifdef ESP_PLATFORM
 void bt_provision_gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param);
 void bt_provision_gatts_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t* param);
-void bt_provision_wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data);
 esp_err_t bt_provision_start_ble_advertising(void);
 esp_err_t bt_provision_stop_ble_advertising(void);
 #endif
@@ -110,23 +102,7 @@ bt_provision_err_t bt_provision_init(const bt_provision_config_t* config)
     }
     
 #ifdef ESP_PLATFORM
-    // 初始化WiFi事件组
-    g_wifi_event_group = xEventGroupCreate();
-    if (!g_wifi_event_group) {
-        return BT_PROVISION_ERR_BLE_FAILED;
-    }
-    
-    // 注册WiFi事件处理器
-    ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT,
-                                                        ESP_EVENT_ANY_ID,
-                                                        &bt_provision_wifi_event_handler,
-                                                        NULL,
-                                                        &g_wifi_handler_instance));
-    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT,
-                                                        IP_EVENT_STA_GOT_IP,
-                                                        &bt_provision_wifi_event_handler,
-                                                        NULL,
-                                                        &g_ip_handler_instance));
+    // WiFi连接由 live_provision 在AP+STA/BLE共存下完成，这里不再注册WiFi事件处理器
     
     // 初始化蓝牙
     esp_err_t esp_ret = esp_bt_controller_mem_release(ESP_BT_MODE_CLASSIC_BT);
@@ -209,22 +185,6 @@ bt_provision_err_t bt_provision_deinit(void)
         g_provision_timer = NULL;
     }
     
-    // 清理WiFi事件组
-    if (g_wifi_event_group) {
-        vEventGroupDelete(g_wifi_event_group);
-        g_wifi_event_group = NULL;
-    }
-    
-    // 注销事件处理器
-    if (g_wifi_handler_instance) {
-        esp_event_handler_instance_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, g_wifi_handler_instance);
-        g_wifi_handler_instance = NULL;
-    }
-    if (g_ip_handler_instance) {
-        esp_event_handler_instance_unregister(IP_EVENT, IP_EVENT_STA_GOT_IP, g_ip_handler_instance);
-        g_ip_handler_instance = NULL;
-    }
-    
     // 清理蓝牙
     esp_bluedroid_disable();
     esp_bluedroid_deinit();
@@ -307,9 +307,11 @@ bt_provision_err_t bt_provision_set_server_config(const bt_provision_server_conf
 bt_provision_err_t bt_provision_reset_config(bool reset_wifi, bool reset_server);
 
 /**
- * @brief 测试WiFi连接
+ * @brief 用已保存的配置开始配网（不重启，WiFi连接和broker验证在后台进行）
  * 
- * @return bt_provision_err_t 错误代码
+ * 结果通过 bt_provision 状态回调上报；详细阶段和耗时见 live_provision_get_status()
+ * 
+ * @return bt_provision_err_t 错误代码（只表示是否已开始）
  */
 bt_provision_err_t bt_provision_test_wifi(void);
 
@@ -2,7 +2,10 @@
  * @file bt_provision_ble.c
  * @brief 蓝牙配网功能的BLE GATT服务器实现
  * 
- * 实现BLE GATT服务器，处理配网命令和数据传输
+ * 实现BLE GATT服务器，处理配网命令和数据传输。
+ * 写特征值和通知特征值走 ble_frag 分片传输：大于一个MTU的配网JSON（含证书）
+ * 可以分片写入或长写，响应按协商的MTU分片通知。老版本客户端不写版本特征值（0x2A03），
+ * 连接保持兼容模式，收发格式与原来相同。
  * 
  * @author AIOT Team
  * @date 2024-01-01
@@ -22,6 +25,7 @@
 #include "esp_gatts_api.h"
 #include "esp_bt_defs.h"
 #include "esp_gatt_common_api.h"
+#include "ble_frag_gatts.h"
 
 // ==================== 私有常量 ====================
 
@@ -32,8 +36,9 @@ static const uint16_t GATTS_SERVICE_UUID_PROVISION = 0x1800;
 static const uint16_t GATTS_CHAR_UUID_WRITE = 0x2A00;
 static const uint16_t GATTS_CHAR_UUID_READ = 0x2A01;
 static const uint16_t GATTS_CHAR_UUID_NOTIFY = 0x2A02;
+static const uint16_t GATTS_CHAR_UUID_FRAG_VERSION = 0x2A03;
 
-#define GATTS_NUM_HANDLE_PROVISION 8
+#define GATTS_NUM_HANDLE_PROVISION 10
 #define GATTS_CHAR_VAL_LEN_MAX 512
 
 // 广播数据
@@ -45,6 +50,7 @@ static uint8_t adv_config_done = 0;
 
 static uint16_t provision_handle_table[GATTS_NUM_HANDLE_PROVISION];
 static uint8_t char_value[GATTS_CHAR_VAL_LEN_MAX] = {0};
+static ble_frag_handle_t s_frag = NULL;
 
 // 广播参数
 static esp_ble_adv_params_t adv_params = {
@@ -96,6 +102,7 @@ static const uint16_t character_client_config_uuid = ESP_GATT_UUID_CHAR_CLIENT_C
 static const uint8_t char_prop_read_write_notify = ESP_GATT_CHAR_PROP_BIT_READ | ESP_GATT_CHAR_PROP_BIT_WRITE | ESP_GATT_CHAR_PROP_BIT_NOTIFY;
 static const uint8_t char_prop_read = ESP_GATT_CHAR_PROP_BIT_READ;
 static const uint8_t char_prop_write = ESP_GATT_CHAR_PROP_BIT_WRITE;
+static const uint8_t char_prop_read_write = ESP_GATT_CHAR_PROP_BIT_READ | ESP_GATT_CHAR_PROP_BIT_WRITE;
 
 // 服务属性表
 static const esp_gatts_attr_db_t gatt_db[GATTS_NUM_HANDLE_PROVISION] = {
@@ -106,8 +113,8 @@ static const esp_gatts_attr_db_t gatt_db[GATTS_NUM_HANDLE_PROVISION] = {
     // Write Characteristic Declaration
     [1] = {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&character_declaration_uuid, ESP_GATT_PERM_READ,
             sizeof(uint8_t), sizeof(uint8_t), (uint8_t *)&char_prop_write}},
-    // Write Characteristic Value
-    [2] = {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&GATTS_CHAR_UUID_WRITE, ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE,
+    // Write Characteristic Value（由ble_frag应答，支持长写）
+    [2] = {{ESP_GATT_RSP_BY_APP}, {ESP_UUID_LEN_16, (uint8_t *)&GATTS_CHAR_UUID_WRITE, ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE,
             GATTS_CHAR_VAL_LEN_MAX, sizeof(char_value), (uint8_t *)char_value}},
 
     // Read Characteristic Declaration
@@ -126,6 +133,13 @@ static const esp_gatts_attr_db_t gatt_db[GATTS_NUM_HANDLE_PROVISION] = {
     // Client Characteristic Configuration Descriptor
     [7] = {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&character_client_config_uuid, ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE,
             sizeof(uint16_t), sizeof(uint16_t), NULL}},
+
+    // Fragmentation Version Characteristic Declaration
+    [8] = {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&character_declaration_uuid, ESP_GATT_PERM_READ,
+            sizeof(uint8_t), sizeof(uint8_t), (uint8_t *)&char_prop_read_write}},
+    // Fragmentation Version Characteristic Value（由ble_frag应答：读返回版本，写入开启分片格式）
+    [9] = {{ESP_GATT_RSP_BY_APP}, {ESP_UUID_LEN_16, (uint8_t *)&GATTS_CHAR_UUID_FRAG_VERSION, ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE,
+            sizeof(uint8_t), 0, NULL}},
 };
 
 // ==================== 外部变量声明 ====================
@@ -139,10 +153,9 @@ extern uint16_t g_char_handle_notify;
 
 // ==================== 私有函数声明 ====================
 
-static void bt_provision_prepare_write_event_env(esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param);
-static void bt_provision_exec_write_event_env(esp_ble_gatts_cb_param_t *param);
 bt_provision_err_t bt_provision_send_notification(const char* data);
-static bt_provision_err_t bt_provision_process_write_data(const uint8_t* data, uint16_t len);
+static bt_provision_err_t bt_provision_process_write_data(const uint8_t* data, size_t len);
+static void bt_provision_on_message(const uint8_t* data, size_t len, void* ctx);
 
 // ==================== 公共函数实现 ====================
 
@@ -239,8 +252,23 @@ void bt_provision_gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb
 
 void bt_provision_gatts_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param)
 {
+    // 写特征值上的写入/长写、通知确认和拥塞由分片传输处理
+    if (ble_frag_gatts_event(s_frag, event, gatts_if, param)) {
+        return;
+    }
+
     switch (event) {
     case ESP_GATTS_REG_EVT: {
+        ble_frag_set_local_mtu();
+        if (!s_frag) {
+            ble_frag_config_t frag_config = BLE_FRAG_DEFAULT_CONFIG();
+            frag_config.name = "provision";
+            frag_config.on_message = bt_provision_on_message;
+            if (ble_frag_open(&frag_config, &s_frag) != ESP_OK) {
+                ESP_LOGE(TAG, "create ble_frag channel failed");
+            }
+        }
+
         esp_err_t set_dev_name_ret = esp_ble_gap_set_device_name("AIOT-Device");
         if (set_dev_name_ret) {
             ESP_LOGE(TAG, "set device name failed, error code = %x", set_dev_name_ret);
@@ -256,28 +284,11 @@ void bt_provision_gatts_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t
         ESP_LOGI(TAG, "ESP_GATTS_READ_EVT");
         break;
     case ESP_GATTS_WRITE_EVT:
-        if (!param->write.is_prep) {
-            ESP_LOGI(TAG, "GATT_WRITE_EVT, handle = %d, value len = %d, value :", param->write.handle, param->write.len);
-            esp_log_buffer_hex(TAG, param->write.value, param->write.len);
-            
-            if (provision_handle_table[2] == param->write.handle && param->write.len > 0) {
-                // 处理写入的配网数据
-                bt_provision_process_write_data(param->write.value, param->write.len);
-            }
-            
-            if (param->write.need_rsp) {
-                esp_ble_gatts_send_response(gatts_if, param->write.conn_id, param->write.trans_id, ESP_GATT_OK, NULL);
-            }
-        } else {
-            bt_provision_prepare_write_event_env(gatts_if, param);
-        }
+        // 写特征值已由ble_frag处理，这里只剩自动应答的特征值和CCCD
+        ESP_LOGI(TAG, "GATT_WRITE_EVT, handle = %d, value len = %d", param->write.handle, param->write.len);
         break;
     case ESP_GATTS_EXEC_WRITE_EVT:
         ESP_LOGI(TAG, "ESP_GATTS_EXEC_WRITE_EVT");
-        bt_provision_exec_write_event_env(param);
-        break;
-    case ESP_GATTS_MTU_EVT:
-        ESP_LOGI(TAG, "ESP_GATTS_MTU_EVT, MTU %d", param->mtu.mtu);
         break;
     case ESP_GATTS_CONF_EVT:
         ESP_LOGI(TAG, "ESP_GATTS_CONF_EVT, status = %d, attr_handle %d", param->conf.status, param->conf.handle);
@@ -293,8 +304,9 @@ void bt_provision_gatts_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t
         esp_ble_conn_update_params_t conn_params = {0};
         memcpy(conn_params.bda, param->connect.remote_bda, sizeof(esp_bd_addr_t));
         conn_params.latency = 0;
-        conn_params.max_int = 0x20;
-        conn_params.min_int = 0x10;
+        // 配网期间用短连接间隔（7.5~15ms），多个分片在几个连接事件内发完
+        conn_params.max_int = 0x0C;
+        conn_params.min_int = 0x06;
         conn_params.timeout = 400;
         esp_ble_gap_update_conn_params(&conn_params);
         
@@ -327,6 +339,8 @@ void bt_provision_gatts_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t
             g_char_handle_write = provision_handle_table[2];
             g_char_handle_read = provision_handle_table[4];
             g_char_handle_notify = provision_handle_table[6];
+            ble_frag_bind(s_frag, gatts_if, g_char_handle_write, g_char_handle_notify);
+            ble_frag_bind_version(s_frag, provision_handle_table[9]);
             
             esp_ble_gatts_start_service(provision_handle_table[0]);
         }
@@ -339,55 +353,14 @@ void bt_provision_gatts_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t
 
 // ==================== 私有函数实现 ====================
 
-static void bt_provision_prepare_write_event_env(esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param)
-{
-    ESP_LOGI(TAG, "prepare write, handle = %d, value len = %d", param->write.handle, param->write.len);
-    esp_gatt_status_t status = ESP_GATT_OK;
-    if (param->write.offset > GATTS_CHAR_VAL_LEN_MAX) {
-        status = ESP_GATT_INVALID_OFFSET;
-    } else if ((param->write.offset + param->write.len) > GATTS_CHAR_VAL_LEN_MAX) {
-        status = ESP_GATT_INVALID_ATTR_LEN;
-    }
-    
-    esp_gatt_rsp_t *gatt_rsp = (esp_gatt_rsp_t *)malloc(sizeof(esp_gatt_rsp_t));
-    if (gatt_rsp) {
-        gatt_rsp->attr_value.len = param->write.len;
-        gatt_rsp->attr_value.handle = param->write.handle;
-        gatt_rsp->attr_value.offset = param->write.offset;
-        gatt_rsp->attr_value.auth_req = ESP_GATT_AUTH_REQ_NONE;
-        memcpy(gatt_rsp->attr_value.value, param->write.value, param->write.len);
-        esp_err_t response_err = esp_ble_gatts_send_response(gatts_if, param->write.conn_id, param->write.trans_id, status, gatt_rsp);
-        if (response_err != ESP_OK) {
-            ESP_LOGE(TAG, "Send response error");
-        }
-        free(gatt_rsp);
-    } else {
-        ESP_LOGE(TAG, "malloc failed");
-        esp_ble_gatts_send_response(gatts_if, param->write.conn_id, param->write.trans_id, ESP_GATT_NO_RESOURCES, NULL);
-    }
-}
-
-static void bt_provision_exec_write_event_env(esp_ble_gatts_cb_param_t *param)
-{
-    if (param->exec_write.exec_write_flag == ESP_GATT_PREP_WRITE_EXEC) {
-        esp_log_buffer_hex(TAG, char_value, GATTS_CHAR_VAL_LEN_MAX);
-    } else {
-        ESP_LOGI(TAG, "ESP_GATT_PREP_WRITE_CANCEL");
-    }
-}
-
 bt_provision_err_t bt_provision_send_notification(const char* data)
 {
     if (!data || g_gatts_if == ESP_GATT_IF_NONE) {
         return BT_PROVISION_ERR_INVALID_PARAM;
     }
     
-    uint16_t len = strlen(data);
-    if (len > GATTS_CHAR_VAL_LEN_MAX) {
-        len = GATTS_CHAR_VAL_LEN_MAX;
-    }
-    
-    esp_err_t ret = esp_ble_gatts_send_indicate(g_gatts_if, g_conn_id, g_char_handle_notify, len, (uint8_t*)data, false);
+    // 按协商的MTU分片通知，不再截断到一个特征值
+    esp_err_t ret = ble_frag_send(s_frag, (const uint8_t*)data, strlen(data));
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Send notification failed: %s", esp_err_to_name(ret));
         return BT_PROVISION_ERR_BLE_FAILED;
@@ -396,7 +369,13 @@ bt_provision_err_t bt_provision_send_notification(const char* data)
     return BT_PROVISION_ERR_OK;
 }
 
-static bt_provision_err_t bt_provision_process_write_data(const uint8_t* data, uint16_t len)
+static void bt_provision_on_message(const uint8_t* data, size_t len, void* ctx)
+{
+    (void)ctx;
+    bt_provision_process_write_data(data, len);
+}
+
+static bt_provision_err_t bt_provision_process_write_data(const uint8_t* data, size_t len)
 {
     if (!data || len == 0) {
         return BT_PROVISION_ERR_INVALID_PARAM;
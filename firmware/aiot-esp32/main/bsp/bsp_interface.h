@@ -21,15 +21,6 @@
 extern "C" {
 #endif
 
-/**
- * @brief 传感器显示信息结构体 - 用于LCD动态UI显示
- */
-typedef struct {
-    const char *name;             ///< 传感器名称，如"DHT11温湿度"
-    const char *unit;             ///< 单位，如"°C / %"
-    int gpio_pin;                 ///< GPIO引脚号
-} bsp_sensor_display_info_t;
-
 /**
  * @brief 板级信息结构体
  */
@@ -42,10 +33,6 @@ typedef struct {
     uint32_t psram_size_mb;       ///< PSRAM大小(MB)
     bool has_wifi;                ///< 是否支持WiFi
     bool has_ethernet;            ///< 是否支持以太网
-    
-    // 传感器显示信息
-    const bsp_sensor_display_info_t *sensor_display_list;  ///< 传感器显示列表
-    int sensor_display_count;     ///< 传感器显示数量
 } bsp_board_info_t;
 
 /**
@@ -376,10 +363,10 @@ hal_err_t bsp_sensor_init(void);
 hal_err_t bsp_sensor_deinit(void);
 
 /**
- * @brief 读取传感器数据
- * @param sensor_id 传感器ID
+ * @brief 读取传感器数据（最近一次采集的值，不触发采集）
+ * @param sensor_id 通道序号：按板级传感器表顺序展开，每个传感器占其通道数个序号
  * @param value 传感器数值
- * @return hal_err_t 错误码
+ * @return hal_err_t 错误码（HAL_ERROR_NOT_INITIALIZED: 该传感器还没有成功读数）
  */
 hal_err_t bsp_sensor_read(uint8_t sensor_id, float* value);
 
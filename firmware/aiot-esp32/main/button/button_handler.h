@@ -5,6 +5,10 @@
  * 提供Boot按键的检测和处理功能：
  * - 短按：普通功能（预留）
  * - 长按：进入WiFi配网模式
+ * - 启动时按住：强制进入配网模式（button_handler_boot_held）
+ *
+ * 按键检测由 components/button_input 完成（中断时间戳队列 + 状态机），
+ * 本模块按 board_config.h 注册板上的按键，把Boot键的事件转给应用回调。
  * 
  * @author AIOT Team
  * @date 2024
@@ -14,6 +18,7 @@
 #define BUTTON_HANDLER_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "esp_err.h"
 
 #ifdef __cplusplus
@@ -25,6 +30,7 @@ typedef enum {
     BUTTON_EVENT_CLICK = 0,     // 短按
     BUTTON_EVENT_LONG_PRESS,    // 长按
     BUTTON_EVENT_DOUBLE_CLICK,  // 双击（预留）
+    BUTTON_EVENT_HOLD_REPEAT,   // 长按后继续按住（每个连发间隔一次）
 } button_event_t;
 
 // 按键事件回调函数类型
@@ -33,6 +39,9 @@ typedef void (*button_event_cb_t)(button_event_t event);
 /**
  * @brief 初始化按键处理模块
  * 
+ * 同时开始启动窗口检测。已初始化时只更换回调，
+ * 因此可以在启动早期先调用一次，之后再由启动流程调用。
+ * 
  * @param event_cb 按键事件回调函数
  * @return esp_err_t 
  */
@@ -62,6 +71,29 @@ esp_err_t button_handler_reinit_after_wifi(void);
  */
 bool button_handler_get_boot_state(void);
 
+/**
+ * @brief 查询启动时是否按住Boot按键（不阻塞）
+ * 
+ * @param held 输出：是否按住
+ * @return esp_err_t 
+ *   - ESP_OK: 已判定
+ *   - ESP_ERR_NOT_FINISHED: 启动窗口还未结束
+ *   - ESP_ERR_INVALID_STATE: 未初始化
+ */
+esp_err_t button_handler_boot_held(bool *held);
+
+/**
+ * @brief 等待启动窗口判定结果（最多 timeout_ms）
+ * 
+ * @return esp_err_t 同 button_handler_boot_held()
+ */
+esp_err_t button_handler_wait_boot(bool *held, uint32_t timeout_ms);
+
+/**
+ * @brief 启动窗口剩余时间（毫秒，已判定返回0），用于LCD倒计时
+ */
+uint32_t button_handler_boot_remaining_ms(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -23,6 +23,8 @@
     #define BSP_RELAY2_CONTROL bsp_esp32_s3_devkit_rain_relay2_control
     #define BSP_SERVO1_SET_ANGLE bsp_esp32_s3_devkit_rain_servo1_set_angle
     #define BSP_SERVO2_SET_ANGLE bsp_esp32_s3_devkit_rain_servo2_set_angle
+    #define BSP_SERVO_SET_POSITION bsp_esp32_s3_devkit_rain_servo_set_position
+    #define DEVICE_CONTROL_SERVO_COUNT 2
 #elif defined(CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_LITE)
     #include "../boards/esp32-s3-devkit-lite/bsp_esp32_s3_devkit_lite.h"
     #define BSP_LED1_CONTROL bsp_esp32_s3_devkit_lite_led1_control
@@ -40,6 +42,7 @@
     static inline hal_err_t bsp_esp32_s3_devkit_lite_servo2_set_angle(uint16_t angle) { (void)angle; return HAL_ERROR_NOT_SUPPORTED; }
     #define BSP_SERVO1_SET_ANGLE bsp_esp32_s3_devkit_lite_servo1_set_angle
     #define BSP_SERVO2_SET_ANGLE bsp_esp32_s3_devkit_lite_servo2_set_angle
+    #define DEVICE_CONTROL_SERVO_COUNT 0
 #else
     #include "../boards/esp32-s3-devkit/bsp_esp32_s3_devkit.h"
     #define BSP_LED1_CONTROL bsp_esp32_s3_devkit_led1_control
@@ -54,7 +57,11 @@
     #define BSP_RELAY2_CONTROL bsp_esp32_s3_devkit_relay2_control
     #define BSP_SERVO1_SET_ANGLE bsp_esp32_s3_devkit_servo1_set_angle
     #define BSP_SERVO2_SET_ANGLE bsp_esp32_s3_devkit_servo2_set_angle
+    #define BSP_SERVO_SET_POSITION bsp_esp32_s3_devkit_servo_set_position
+    #define DEVICE_CONTROL_SERVO_COUNT 2
 #endif
+#include "servo_motion.h"
+#include "pwm_output.h"
 #include "esp_log.h"
 #include "cJSON.h"
 #include <string.h>
@@ -62,6 +69,23 @@
 static const char *TAG = "DEVICE_CONTROL";
 static bool s_initialized = false;
 
+#if DEVICE_CONTROL_SERVO_COUNT > 0
+/**
+ * @brief 舵机运动控制的位置输出（esp_timer任务中每帧调用），同一帧的舵机一起锁存
+ */
+static void servo_motion_output(uint32_t mask, const uint32_t *centideg, void *ctx)
+{
+    (void)ctx;
+    pwm_output_frame_begin();
+    for (uint8_t i = 0; i < DEVICE_CONTROL_SERVO_COUNT; i++) {
+        if (mask & (1u << i)) {
+            BSP_SERVO_SET_POSITION(i, centideg[i]);
+        }
+    }
+    pwm_output_frame_commit();
+}
+#endif
+
 /**
  * @brief 初始化设备控制模块
  */
@@ -81,11 +105,123 @@ esp_err_t device_control_init(void)
         return ESP_ERR_INVALID_STATE;
     }
 
+    // PWM输出层：舵机帧、序列预设的多通道写入一起锁存
+    esp_err_t ret = pwm_output_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "PWM output init failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+#if DEVICE_CONTROL_SERVO_COUNT > 0
+    // BSP初始化时舵机停在中位（90度），运动规划从这里开始
+    const float servo_initial[DEVICE_CONTROL_SERVO_COUNT] = {90.0f, 90.0f};
+    ret = servo_motion_init(DEVICE_CONTROL_SERVO_COUNT, servo_initial, 180, servo_motion_output, NULL);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "Servo motion init failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+#endif
+
     s_initialized = true;
     ESP_LOGI(TAG, "✅ Device control module initialized successfully");
     return ESP_OK;
 }
 
+/**
+ * @brief 解析可选的速度曲线字段（缺省为梯形）
+ */
+static esp_err_t parse_motion_profile(const cJSON *json, uint8_t *profile)
+{
+    servo_profile_t value = SERVO_PROFILE_TRAPEZOID;
+    cJSON *profile_item = cJSON_GetObjectItem(json, "profile");
+    if (profile_item) {
+        if (!cJSON_IsString(profile_item) ||
+            servo_motion_parse_profile(profile_item->valuestring, &value) != ESP_OK) {
+            ESP_LOGE(TAG, "Invalid 'profile' field (trapezoid/scurve/linear)");
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    *profile = (uint8_t)value;
+    return ESP_OK;
+}
+
+/**
+ * @brief 解析可选的毫秒字段（缺省为0，上限65535）
+ */
+static esp_err_t parse_optional_ms(const cJSON *json, const char *name, uint16_t *value)
+{
+    cJSON *item = cJSON_GetObjectItem(json, name);
+    *value = 0;
+    if (!item) {
+        return ESP_OK;
+    }
+    double ms = cJSON_GetNumberValue(item);
+    if (!cJSON_IsNumber(item) || ms < 0 || ms > 65535) {
+        ESP_LOGE(TAG, "Invalid '%s' field (0-65535)", name);
+        return ESP_ERR_INVALID_ARG;
+    }
+    *value = (uint16_t)ms;
+    return ESP_OK;
+}
+
+/**
+ * @brief 解析一个舵机路点（device_id缺省时使用default_id）
+ */
+static esp_err_t parse_waypoint(const cJSON *item, uint8_t default_id, device_control_waypoint_t *point)
+{
+    if (!cJSON_IsObject(item)) {
+        ESP_LOGE(TAG, "Waypoint must be an object");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    cJSON *device_id_item = cJSON_GetObjectItem(item, "device_id");
+    if (device_id_item && !cJSON_IsNumber(device_id_item)) {
+        ESP_LOGE(TAG, "Invalid waypoint 'device_id' field");
+        return ESP_ERR_INVALID_ARG;
+    }
+    point->servo_id = device_id_item ? (uint8_t)cJSON_GetNumberValue(device_id_item) : default_id;
+
+    cJSON *angle_item = cJSON_GetObjectItem(item, "angle");
+    if (!angle_item || !cJSON_IsNumber(angle_item)) {
+        ESP_LOGE(TAG, "Missing or invalid waypoint 'angle' field");
+        return ESP_ERR_INVALID_ARG;
+    }
+    double angle = cJSON_GetNumberValue(angle_item);
+    point->angle = angle < 0 ? 0 : (angle > 180 ? 180 : (uint16_t)angle);
+
+    esp_err_t ret = parse_optional_ms(item, "duration_ms", &point->duration_ms);
+    if (ret == ESP_OK) {
+        ret = parse_optional_ms(item, "dwell_ms", &point->dwell_ms);
+    }
+    return ret;
+}
+
+/**
+ * @brief 解析路点数组（servo_path的waypoints / servo_sync的targets）
+ */
+static esp_err_t parse_waypoint_array(const cJSON *json, const char *name, uint8_t default_id,
+                                      device_control_command_t *command)
+{
+    cJSON *array = cJSON_GetObjectItem(json, name);
+    int count = cJSON_GetArraySize(array);
+    if (!cJSON_IsArray(array) || count == 0 || count > DEVICE_CONTROL_MAX_WAYPOINTS) {
+        ESP_LOGE(TAG, "Missing or invalid '%s' field (1-%d entries)", name, DEVICE_CONTROL_MAX_WAYPOINTS);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t n = 0;
+    const cJSON *item = NULL;
+    cJSON_ArrayForEach(item, array) {
+        esp_err_t ret = parse_waypoint(item, default_id, &command->value.motion.points[n]);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        n++;
+    }
+    command->value.motion.count = n;
+    return ESP_OK;
+}
+
 /**
  * @brief 解析JSON控制命令
  */
@@ -216,6 +352,50 @@ esp_err_t device_control_parse_json_command(const char *json_str, device_control
             command->value.angle = 180;
         }
 
+        // 带duration_ms或profile时改为平滑运动（单路点路径），否则直接跳到目标角度
+        if (cJSON_GetObjectItem(json, "duration_ms") || cJSON_GetObjectItem(json, "profile")) {
+            uint16_t angle = command->value.angle;
+            command->cmd_type = DEVICE_CONTROL_CMD_SERVO_PATH;
+            command->value.motion.count = 1;
+            command->value.motion.points[0].servo_id = command->device_id;
+            command->value.motion.points[0].angle = angle;
+            if (parse_optional_ms(json, "duration_ms", &command->value.motion.points[0].duration_ms) != ESP_OK ||
+                parse_motion_profile(json, &command->value.motion.profile) != ESP_OK) {
+                cJSON_Delete(json);
+                return ESP_ERR_INVALID_ARG;
+            }
+        }
+
+    } else if (strcmp(cmd_str, "servo_path") == 0) {
+        command->cmd_type = DEVICE_CONTROL_CMD_SERVO_PATH;
+        command->action = DEVICE_CONTROL_ACTION_ANGLE;
+
+        // device_id为路点的缺省舵机，路点里也可以单独指定
+        cJSON *device_id_item = cJSON_GetObjectItem(json, "device_id");
+        if (device_id_item && !cJSON_IsNumber(device_id_item)) {
+            ESP_LOGE(TAG, "Invalid 'device_id' field");
+            cJSON_Delete(json);
+            return ESP_ERR_INVALID_ARG;
+        }
+        command->device_id = device_id_item ? (uint8_t)cJSON_GetNumberValue(device_id_item) : 1;
+
+        if (parse_motion_profile(json, &command->value.motion.profile) != ESP_OK ||
+            parse_waypoint_array(json, "waypoints", command->device_id, command) != ESP_OK) {
+            cJSON_Delete(json);
+            return ESP_ERR_INVALID_ARG;
+        }
+
+    } else if (strcmp(cmd_str, "servo_sync") == 0) {
+        command->cmd_type = DEVICE_CONTROL_CMD_SERVO_SYNC;
+        command->action = DEVICE_CONTROL_ACTION_ANGLE;
+
+        if (parse_motion_profile(json, &command->value.motion.profile) != ESP_OK ||
+            parse_optional_ms(json, "duration_ms", &command->value.motion.duration_ms) != ESP_OK ||
+            parse_waypoint_array(json, "targets", 0, command) != ESP_OK) {
+            cJSON_Delete(json);
+            return ESP_ERR_INVALID_ARG;
+        }
+
     } else if (strcmp(cmd_str, "pwm") == 0) {
         command->cmd_type = DEVICE_CONTROL_CMD_PWM;
         
@@ -319,6 +499,19 @@ esp_err_t device_control_execute(const device_control_command_t *command, device
                                     command->value.pwm.duty_cycle);
             break;
 
+        case DEVICE_CONTROL_CMD_SERVO_PATH:
+            ret = device_control_servo_path(command->value.motion.points,
+                                            command->value.motion.count,
+                                            command->value.motion.profile);
+            break;
+
+        case DEVICE_CONTROL_CMD_SERVO_SYNC:
+            ret = device_control_servo_sync(command->value.motion.points,
+                                            command->value.motion.count,
+                                            command->value.motion.duration_ms,
+                                            command->value.motion.profile);
+            break;
+
         default:
             result->success = false;
             result->error_msg = "Unknown command type";
@@ -462,6 +655,8 @@ esp_err_t device_control_servo(uint8_t servo_id, uint16_t angle)
     }
 
     if (ret == HAL_OK) {
+        // 直接设置角度会打断该舵机正在执行的平滑运动
+        servo_motion_set_position(servo_id - 1, angle);
         ESP_LOGI(TAG, "Servo%d angle set to %d degrees", servo_id, angle);
         return ESP_OK;
     } else {
@@ -470,6 +665,71 @@ esp_err_t device_control_servo(uint8_t servo_id, uint16_t angle)
     }
 }
 
+/**
+ * @brief 舵机路点运动
+ */
+esp_err_t device_control_servo_path(const device_control_waypoint_t *points, uint8_t count, uint8_t profile)
+{
+    if (!points || count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        if (points[i].servo_id < 1 || points[i].servo_id > DEVICE_CONTROL_SERVO_COUNT) {
+            ESP_LOGE(TAG, "Invalid servo ID: %d (supported: 1-%d)", points[i].servo_id, DEVICE_CONTROL_SERVO_COUNT);
+            return DEVICE_CONTROL_SERVO_COUNT > 0 ? ESP_ERR_INVALID_ARG : ESP_ERR_INVALID_STATE;
+        }
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+        servo_waypoint_t wp = {
+            .angle = points[i].angle,
+            .duration_ms = points[i].duration_ms,
+            .dwell_ms = points[i].dwell_ms,
+            .profile = (servo_profile_t)profile,
+        };
+        esp_err_t ret = servo_motion_queue(points[i].servo_id - 1, &wp, 1, 0);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Servo%d waypoint %d rejected: %s", points[i].servo_id, i, esp_err_to_name(ret));
+            return ret;
+        }
+    }
+
+    ESP_LOGI(TAG, "Servo path queued: %d waypoints (%s)", count, servo_motion_profile_name((servo_profile_t)profile));
+    return ESP_OK;
+}
+
+/**
+ * @brief 多舵机同步运动
+ */
+esp_err_t device_control_servo_sync(const device_control_waypoint_t *points, uint8_t count,
+                                    uint16_t duration_ms, uint8_t profile)
+{
+    if (!points || count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t mask = 0;
+    float angles[SERVO_MOTION_MAX_SERVOS] = {0};
+    for (uint8_t i = 0; i < count; i++) {
+        if (points[i].servo_id < 1 || points[i].servo_id > DEVICE_CONTROL_SERVO_COUNT) {
+            ESP_LOGE(TAG, "Invalid servo ID: %d (supported: 1-%d)", points[i].servo_id, DEVICE_CONTROL_SERVO_COUNT);
+            return DEVICE_CONTROL_SERVO_COUNT > 0 ? ESP_ERR_INVALID_ARG : ESP_ERR_INVALID_STATE;
+        }
+        mask |= 1 << (points[i].servo_id - 1);
+        angles[points[i].servo_id - 1] = points[i].angle;
+    }
+
+    esp_err_t ret = servo_motion_move_sync(mask, angles, duration_ms, (servo_profile_t)profile);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Servo sync move rejected: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Servo sync move queued: mask=0x%02x, %d ms (%s)", mask, duration_ms,
+             servo_motion_profile_name((servo_profile_t)profile));
+    return ESP_OK;
+}
+
 /**
  * @brief 控制PWM输出
  */
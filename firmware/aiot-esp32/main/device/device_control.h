@@ -25,6 +25,8 @@ typedef enum {
     DEVICE_CONTROL_CMD_RELAY,        ///< 继电器控制命令
     DEVICE_CONTROL_CMD_SERVO,        ///< 舵机控制命令
     DEVICE_CONTROL_CMD_PWM,          ///< PWM控制命令
+    DEVICE_CONTROL_CMD_SERVO_PATH,   ///< 舵机路点序列（平滑运动）
+    DEVICE_CONTROL_CMD_SERVO_SYNC,   ///< 多舵机同步运动
     DEVICE_CONTROL_CMD_UNKNOWN       ///< 未知命令
 } device_control_cmd_t;
 
@@ -39,6 +41,21 @@ typedef enum {
     DEVICE_CONTROL_ACTION_UNKNOWN     ///< 未知动作
 } device_control_action_t;
 
+/**
+ * @brief 单条命令最多携带的舵机路点数
+ */
+#define DEVICE_CONTROL_MAX_WAYPOINTS    8
+
+/**
+ * @brief 舵机路点
+ */
+typedef struct {
+    uint8_t servo_id;                 ///< 舵机ID（1-2）
+    uint16_t angle;                   ///< 目标角度（0-180）
+    uint16_t duration_ms;             ///< 运动时长（0=按速度/加速度上限最快到达）
+    uint16_t dwell_ms;                ///< 到达后停留时间
+} device_control_waypoint_t;
+
 /**
  * @brief 设备控制命令结构
  */
@@ -54,6 +71,12 @@ typedef struct {
             uint32_t frequency;       ///< PWM频率（Hz）
             float duty_cycle;         ///< PWM占空比（0.0-100.0）
         } pwm;                        ///< PWM参数
+        struct {
+            uint8_t count;            ///< 路点数量
+            uint8_t profile;          ///< 速度曲线（servo_profile_t）
+            uint16_t duration_ms;     ///< 同步运动时长（servo_sync）
+            device_control_waypoint_t points[DEVICE_CONTROL_MAX_WAYPOINTS];
+        } motion;                     ///< 舵机运动参数（servo_path / servo_sync）
     } value;                          ///< 控制值
 } device_control_command_t;
 
@@ -82,6 +105,13 @@ esp_err_t device_control_init(void);
  * - LED: {"cmd":"led","led_id":1,"action":"brightness","brightness":128}
  * - 继电器: {"cmd":"relay","relay_id":1,"action":"on"}
  * - 舵机: {"cmd":"servo","servo_id":1,"angle":90}
+ * - 舵机平滑运动: {"cmd":"servo","device_id":1,"angle":90,"duration_ms":800,"profile":"scurve"}
+ * - 舵机路点: {"cmd":"servo_path","device_id":1,"profile":"trapezoid",
+ *              "waypoints":[{"angle":30,"duration_ms":500,"dwell_ms":200},{"angle":150}]}
+ * - 多舵机同步: {"cmd":"servo_sync","duration_ms":1000,"profile":"scurve",
+ *                "targets":[{"device_id":1,"angle":0},{"device_id":2,"angle":180}]}
+ *
+ * profile 可选 "trapezoid"（默认）、"scurve"、"linear"。
  * 
  * @param json_str JSON字符串
  * @param command 输出参数，解析后的控制命令
@@ -141,6 +171,32 @@ esp_err_t device_control_relay(uint8_t relay_id, bool state);
  */
 esp_err_t device_control_servo(uint8_t servo_id, uint16_t angle);
 
+/**
+ * @brief 舵机路点运动（追加到舵机的路点队列，立即返回，由定时器平滑执行）
+ * 
+ * @param points 路点（可以混合不同舵机，各舵机按各自顺序执行）
+ * @param count 路点数量
+ * @param profile 速度曲线（servo_profile_t）
+ * @return esp_err_t 
+ *   - ESP_OK: 已追加
+ *   - ESP_ERR_INVALID_ARG: 舵机ID无效
+ *   - ESP_ERR_INVALID_STATE: 板子没有舵机
+ *   - ESP_ERR_TIMEOUT: 路点队列已满
+ */
+esp_err_t device_control_servo_path(const device_control_waypoint_t *points, uint8_t count, uint8_t profile);
+
+/**
+ * @brief 多舵机同步运动（各舵机同时出发、同时到达）
+ * 
+ * @param points 每个舵机一个目标（只使用servo_id和angle）
+ * @param count 目标数量
+ * @param duration_ms 运动时长（0=按最远的舵机最快到达）
+ * @param profile 速度曲线（servo_profile_t）
+ * @return esp_err_t 同 device_control_servo_path()
+ */
+esp_err_t device_control_servo_sync(const device_control_waypoint_t *points, uint8_t count,
+                                    uint16_t duration_ms, uint8_t profile);
+
 /**
  * @brief 控制PWM输出
  * 
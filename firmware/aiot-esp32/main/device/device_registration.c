@@ -5,9 +5,8 @@
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_wifi.h"
-#include "esp_http_client.h"
+#include "http_session.h"  // 启动阶段的REST请求共用一个HTTP会话
 #include "cJSON.h"
-#include "nvs_flash.h"
 #include "nvs.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -15,67 +14,16 @@
 #include "esp_mac.h"
 #include "device_registration.h"
 #include "app_config.h"  // 产品配置（PRODUCT_ID, PRODUCT_VERSION等）
+#include "config_cache.h"  // 注册信息保存在device_reg命名空间，经配置缓存读写
 
 static const char *TAG = "DEVICE_REG";
 
-// NVS存储键名
-#define NVS_NAMESPACE "device_reg"
-#define NVS_KEY_DEVICE_ID "device_id"
-#define NVS_KEY_DEVICE_UUID "device_uuid"
-#define NVS_KEY_DEVICE_SECRET "device_secret"
-#define NVS_KEY_MAC_ADDRESS "mac_address"
-#define NVS_KEY_REGISTERED "registered"
-
-// HTTP响应缓冲区大小
-#define HTTP_RESPONSE_BUFFER_SIZE 2048
-
 // 设备注册模块状态
 static device_registration_state_t g_reg_state = DEVICE_REG_STATE_IDLE;
 static device_registration_config_t g_reg_config;
 static device_registration_info_t g_reg_info;
 static TaskHandle_t g_reg_task_handle = NULL;
 static bool g_reg_initialized = false;
-static char g_response_buffer[HTTP_RESPONSE_BUFFER_SIZE];
-
-// HTTP事件处理函数
-static esp_err_t http_event_handler(esp_http_client_event_t *evt)
-{
-    switch (evt->event_id) {
-        case HTTP_EVENT_ERROR:
-            ESP_LOGE(TAG, "HTTP_EVENT_ERROR");
-            break;
-        case HTTP_EVENT_ON_CONNECTED:
-            ESP_LOGI(TAG, "HTTP_EVENT_ON_CONNECTED");
-            break;
-        case HTTP_EVENT_HEADER_SENT:
-            ESP_LOGI(TAG, "HTTP_EVENT_HEADER_SENT");
-            break;
-        case HTTP_EVENT_ON_HEADER:
-            ESP_LOGI(TAG, "HTTP_EVENT_ON_HEADER, key=%s, value=%s", evt->header_key, evt->header_value);
-            break;
-        case HTTP_EVENT_ON_DATA:
-            if (!esp_http_client_is_chunked_response(evt->client)) {
-                // 将响应数据复制到缓冲区
-                int copy_len = evt->data_len;
-                if (copy_len >= HTTP_RESPONSE_BUFFER_SIZE) {
-                    copy_len = HTTP_RESPONSE_BUFFER_SIZE - 1;
-                }
-                memcpy(g_response_buffer, evt->data, copy_len);
-                g_response_buffer[copy_len] = '\0';
-                ESP_LOGI(TAG, "HTTP_EVENT_ON_DATA, len=%d", evt->data_len);
-            }
-            break;
-        case HTTP_EVENT_ON_FINISH:
-            ESP_LOGI(TAG, "HTTP_EVENT_ON_FINISH");
-            break;
-        case HTTP_EVENT_DISCONNECTED:
-            ESP_LOGI(TAG, "HTTP_EVENT_DISCONNECTED");
-            break;
-        default:
-            break;
-    }
-    return ESP_OK;
-}
 
 // 获取MAC地址
 static esp_err_t get_mac_address(char *mac_str, size_t mac_str_size)
@@ -93,39 +41,14 @@ static esp_err_t get_mac_address(char *mac_str, size_t mac_str_size)
     return ESP_OK;
 }
 
-// 解析JSON响应
-static esp_err_t parse_registration_response(const char *json_str, device_registration_info_t *info)
-{
-    cJSON *json = cJSON_Parse(json_str);
-    if (json == NULL) {
-        ESP_LOGE(TAG, "Failed to parse JSON response");
-        return ESP_FAIL;
-    }
-    
-    cJSON *device_id = cJSON_GetObjectItem(json, "device_id");
-    cJSON *device_uuid = cJSON_GetObjectItem(json, "device_uuid");
-    cJSON *device_secret = cJSON_GetObjectItem(json, "device_secret");
-    cJSON *mac_address = cJSON_GetObjectItem(json, "mac_address");
-    
-    if (cJSON_IsString(device_id) && device_id->valuestring != NULL) {
-        strncpy(info->device_id, device_id->valuestring, sizeof(info->device_id) - 1);
-    }
-    
-    if (cJSON_IsString(device_uuid) && device_uuid->valuestring != NULL) {
-        strncpy(info->device_uuid, device_uuid->valuestring, sizeof(info->device_uuid) - 1);
-    }
-    
-    if (cJSON_IsString(device_secret) && device_secret->valuestring != NULL) {
-        strncpy(info->device_secret, device_secret->valuestring, sizeof(info->device_secret) - 1);
-    }
-    
-    if (cJSON_IsString(mac_address) && mac_address->valuestring != NULL) {
-        strncpy(info->mac_address, mac_address->valuestring, sizeof(info->mac_address) - 1);
-    }
-    
-    cJSON_Delete(json);
-    return ESP_OK;
-}
+// MAC查询响应字段（流式解析到device_registration_info_t）
+static const json_field_t s_reg_fields[] = {
+    JSON_FIELD(JSON_FIELD_STRING, "device_id", device_registration_info_t, device_id),
+    JSON_FIELD(JSON_FIELD_STRING, "device_uuid", device_registration_info_t, device_uuid),
+    JSON_FIELD(JSON_FIELD_STRING, "device_secret", device_registration_info_t, device_secret),
+    JSON_FIELD(JSON_FIELD_STRING, "mac_address", device_registration_info_t, mac_address),
+    JSON_FIELD(JSON_FIELD_STRING, "message", device_registration_info_t, message),
+};
 
 // 步骤1: MAC地址查询 - 获取device_id, uuid, secret
 static esp_err_t perform_mac_lookup(const char *firmware_version, const char *hardware_version)
@@ -157,49 +80,41 @@ static esp_err_t perform_mac_lookup(const char *firmware_version, const char *ha
     ESP_LOGI(TAG, "📡 Step 1: MAC Lookup - Querying device credentials");
     ESP_LOGI(TAG, "   MAC: %s", mac_str);
     
-    // 配置HTTP客户端
-    esp_http_client_config_t config = {
-        .url = url,
-        .event_handler = http_event_handler,
-        .timeout_ms = g_reg_config.timeout_ms,
-        .method = HTTP_METHOD_POST,
-    };
-    
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (client == NULL) {
+    // 执行请求（响应边接收边解析到临时副本，200且完整解析后才更新g_reg_info，
+    // 错误响应或半截JSON不会覆盖已有的注册信息；副本较大，放堆上）
+    device_registration_info_t *info = malloc(sizeof(device_registration_info_t));
+    if (info == NULL) {
         free(json_string);
         cJSON_Delete(json);
-        return ESP_FAIL;
+        return ESP_ERR_NO_MEM;
     }
+    memcpy(info, &g_reg_info, sizeof(device_registration_info_t));
     
-    // 设置请求头
-    esp_http_client_set_header(client, "Content-Type", "application/json");
-    esp_http_client_set_post_field(client, json_string, strlen(json_string));
-    
-    // 执行请求
-    ret = esp_http_client_perform(client);
+    http_session_json_result_t result;
+    ret = http_session_request_json(HTTP_SESSION_POST, url, json_string, g_reg_config.timeout_ms, 0,
+                                    s_reg_fields, sizeof(s_reg_fields) / sizeof(s_reg_fields[0]),
+                                    info, &result);
     
     if (ret == ESP_OK) {
-        int status_code = esp_http_client_get_status_code(client);
-        if (status_code == 200) {
-            // 解析响应
-            ret = parse_registration_response(g_response_buffer, &g_reg_info);
-            if (ret == ESP_OK) {
-                ESP_LOGI(TAG, "✅ MAC Lookup successful");
-                ESP_LOGI(TAG, "   Device ID: %s", g_reg_info.device_id);
-                ESP_LOGI(TAG, "   UUID: %s", g_reg_info.device_uuid);
-                ESP_LOGI(TAG, "   Secret: %s", g_reg_info.device_secret);
-            }
+        if (result.status == 200 && result.parse_err == ESP_OK && !result.truncated) {
+            memcpy(&g_reg_info, info, sizeof(device_registration_info_t));
+            ESP_LOGI(TAG, "✅ MAC Lookup successful");
+            ESP_LOGI(TAG, "   Device ID: %s", g_reg_info.device_id);
+            ESP_LOGI(TAG, "   UUID: %s", g_reg_info.device_uuid);
+            ESP_LOGI(TAG, "   Secret: %s", g_reg_info.device_secret);
+        } else if (result.status == 200) {
+            ESP_LOGE(TAG, "❌ MAC Lookup response incomplete (%s%s)",
+                     esp_err_to_name(result.parse_err), result.truncated ? ", truncated" : "");
+            ret = ESP_FAIL;
         } else {
-            ESP_LOGE(TAG, "❌ MAC Lookup failed with status: %d", status_code);
-            ESP_LOGE(TAG, "   Response: %s", g_response_buffer);
+            ESP_LOGE(TAG, "❌ MAC Lookup failed with status: %d", result.status);
             ret = ESP_FAIL;
         }
     } else {
         ESP_LOGE(TAG, "❌ HTTP request failed: %s", esp_err_to_name(ret));
     }
     
-    esp_http_client_cleanup(client);
+    free(info);
     free(json_string);
     cJSON_Delete(json);
     
@@ -288,44 +203,26 @@ static esp_err_t perform_formal_registration(const char *firmware_version, const
     ESP_LOGI(TAG, "📡 Step 2: Formal Registration - Sending product information");
     ESP_LOGI(TAG, "   Product: %s v%s", product_code, product_version);
     
-    // 配置HTTP客户端
-    esp_http_client_config_t config = {
-        .url = url,
-        .event_handler = http_event_handler,
-        .timeout_ms = g_reg_config.timeout_ms,
-        .method = HTTP_METHOD_POST,
-    };
-    
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (client == NULL) {
-        free(json_string);
-        cJSON_Delete(json);
-        return ESP_FAIL;
-    }
-    
-    // 设置请求头
-    esp_http_client_set_header(client, "Content-Type", "application/json");
-    esp_http_client_set_post_field(client, json_string, strlen(json_string));
-    
-    // 执行请求
-    ret = esp_http_client_perform(client);
+    // 执行请求（与MAC查询同一服务器，复用连接）
+    http_session_response_t resp;
+    ret = http_session_request(HTTP_SESSION_POST, url, json_string, g_reg_config.timeout_ms, 0, &resp);
     
     if (ret == ESP_OK) {
-        int status_code = esp_http_client_get_status_code(client);
+        int status_code = resp.status;
         if (status_code == 200) {
             ESP_LOGI(TAG, "✅ Formal Registration successful");
-            ESP_LOGI(TAG, "   Response: %s", g_response_buffer);
+            ESP_LOGI(TAG, "   Response: %s", resp.body);
             ret = ESP_OK;
         } else {
             ESP_LOGE(TAG, "❌ Formal Registration failed with status: %d", status_code);
-            ESP_LOGE(TAG, "   Response: %s", g_response_buffer);
+            ESP_LOGE(TAG, "   Response: %s", resp.body);
             ret = ESP_FAIL;
         }
+        http_session_release();
     } else {
         ESP_LOGE(TAG, "❌ HTTP request failed: %s", esp_err_to_name(ret));
     }
     
-    esp_http_client_cleanup(client);
     free(json_string);
     cJSON_Delete(json);
     
@@ -415,6 +312,9 @@ static void device_registration_task(void *pvParameters)
         }
     }
     
+    // 注册流程结束，关闭共享HTTP会话
+    http_session_close();
+    
     // 清理任务句柄
     g_reg_task_handle = NULL;
     vTaskDelete(NULL);
@@ -525,19 +425,42 @@ bool device_registration_is_registered(void)
     return device_registration_load_from_nvs(&temp_info) == ESP_OK;
 }
 
+static uint32_t set_registration(config_snapshot_t *cfg, void *ctx)
+{
+    const device_registration_info_t *info = ctx;
+
+    if (!info) {
+        if (!cfg->registered) {
+            return 0;
+        }
+        cfg->registered = false;
+        cfg->device_id[0] = '\0';
+        cfg->device_uuid[0] = '\0';
+        cfg->device_secret[0] = '\0';
+        cfg->mac_address[0] = '\0';
+        return CONFIG_FIELD_DEVICE_REG;
+    }
+
+    cfg->registered = true;
+    memcpy(cfg->device_id, info->device_id, sizeof(cfg->device_id));
+    memcpy(cfg->device_uuid, info->device_uuid, sizeof(cfg->device_uuid));
+    memcpy(cfg->device_secret, info->device_secret, sizeof(cfg->device_secret));
+    memcpy(cfg->mac_address, info->mac_address, sizeof(cfg->mac_address));
+    cfg->device_id[sizeof(cfg->device_id) - 1] = '\0';
+    cfg->device_uuid[sizeof(cfg->device_uuid) - 1] = '\0';
+    cfg->device_secret[sizeof(cfg->device_secret) - 1] = '\0';
+    cfg->mac_address[sizeof(cfg->mac_address) - 1] = '\0';
+    return CONFIG_FIELD_DEVICE_REG;
+}
+
 // 清除注册信息
 esp_err_t device_registration_clear(void)
 {
-    nvs_handle_t nvs_handle;
-    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    esp_err_t ret = config_cache_update(set_registration, NULL);
     if (ret != ESP_OK) {
         return ret;
     }
     
-    nvs_erase_all(nvs_handle);
-    nvs_commit(nvs_handle);
-    nvs_close(nvs_handle);
-    
     memset(&g_reg_info, 0, sizeof(device_registration_info_t));
     g_reg_state = DEVICE_REG_STATE_IDLE;
     
@@ -545,67 +468,24 @@ esp_err_t device_registration_clear(void)
     return ESP_OK;
 }
 
-// 从NVS加载注册信息
+// 加载注册信息（从配置缓存读取）
 esp_err_t device_registration_load_from_nvs(device_registration_info_t *info)
 {
-    nvs_handle_t nvs_handle;
-    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
-    if (ret != ESP_OK) {
-        return ret;
+    config_snapshot_t cfg;
+    config_cache_get(&cfg);
+    if (!cfg.registered) {
+        return ESP_ERR_NVS_NOT_FOUND;
     }
     
-    size_t required_size;
-    
-    // 读取各个字段
-    required_size = sizeof(info->device_id);
-    ret = nvs_get_str(nvs_handle, NVS_KEY_DEVICE_ID, info->device_id, &required_size);
-    if (ret != ESP_OK) goto cleanup;
-    
-    required_size = sizeof(info->device_uuid);
-    ret = nvs_get_str(nvs_handle, NVS_KEY_DEVICE_UUID, info->device_uuid, &required_size);
-    if (ret != ESP_OK) goto cleanup;
-    
-    required_size = sizeof(info->device_secret);
-    ret = nvs_get_str(nvs_handle, NVS_KEY_DEVICE_SECRET, info->device_secret, &required_size);
-    if (ret != ESP_OK) goto cleanup;
-    
-    required_size = sizeof(info->mac_address);
-    ret = nvs_get_str(nvs_handle, NVS_KEY_MAC_ADDRESS, info->mac_address, &required_size);
-    if (ret != ESP_OK) goto cleanup;
-    
-cleanup:
-    nvs_close(nvs_handle);
-    return ret;
+    memcpy(info->device_id, cfg.device_id, sizeof(info->device_id));
+    memcpy(info->device_uuid, cfg.device_uuid, sizeof(info->device_uuid));
+    memcpy(info->device_secret, cfg.device_secret, sizeof(info->device_secret));
+    memcpy(info->mac_address, cfg.mac_address, sizeof(info->mac_address));
+    return ESP_OK;
 }
 
-// 保存注册信息到NVS
+// 保存注册信息（写入配置缓存，由缓存写入任务提交到NVS）
 esp_err_t device_registration_save_to_nvs(const device_registration_info_t *info)
 {
-    nvs_handle_t nvs_handle;
-    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
-    if (ret != ESP_OK) {
-        return ret;
-    }
-    
-    // 保存各个字段
-    ret = nvs_set_str(nvs_handle, NVS_KEY_DEVICE_ID, info->device_id);
-    if (ret != ESP_OK) goto cleanup;
-    
-    ret = nvs_set_str(nvs_handle, NVS_KEY_DEVICE_UUID, info->device_uuid);
-    if (ret != ESP_OK) goto cleanup;
-    
-    ret = nvs_set_str(nvs_handle, NVS_KEY_DEVICE_SECRET, info->device_secret);
-    if (ret != ESP_OK) goto cleanup;
-    
-    ret = nvs_set_str(nvs_handle, NVS_KEY_MAC_ADDRESS, info->mac_address);
-    if (ret != ESP_OK) goto cleanup;
-    
-    ret = nvs_set_u8(nvs_handle, NVS_KEY_REGISTERED, 1);
-    if (ret != ESP_OK) goto cleanup;
-    
-    ret = nvs_commit(nvs_handle);
-    
-cleanup:
-    nvs_close(nvs_handle);
-    return ret;
-}
\ No newline at end of file
+    return config_cache_update(set_registration, (void *)info);
+}
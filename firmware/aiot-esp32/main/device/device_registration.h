@@ -108,14 +108,14 @@ bool device_registration_is_registered(void);
 esp_err_t device_registration_clear(void);
 
 /**
- * @brief 从NVS加载注册信息
+ * @brief 加载注册信息（从配置缓存读取，开机时已从NVS加载）
  * @param info 输出参数，存储注册信息
  * @return ESP_OK 成功，其他值表示失败
  */
 esp_err_t device_registration_load_from_nvs(device_registration_info_t *info);
 
 /**
- * @brief 保存注册信息到NVS
+ * @brief 保存注册信息（更新配置缓存，由缓存写入任务提交到NVS）
  * @param info 要保存的注册信息
  * @return ESP_OK 成功，其他值表示失败
  */
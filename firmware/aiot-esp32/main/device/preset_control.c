@@ -8,6 +8,8 @@
 #include "preset_control.h"
 #include "device_control.h"
 #include "pwm_control.h"
+#include "servo_motion.h"
+#include "pwm_output.h"
 #include "esp_log.h"
 #include "cJSON.h"
 #ifdef ESP_PLATFORM
@@ -20,6 +22,39 @@
 static const char *TAG = "PRESET_CONTROL";
 static bool s_initialized = false;
 
+/**
+ * @brief 追加一个舵机路点（队列满时最多等待timeout_ms，让长序列边执行边追加）
+ */
+static esp_err_t queue_servo_waypoint(uint8_t servo_id, int angle, int duration_ms, int dwell_ms,
+                                      servo_profile_t profile, uint32_t timeout_ms)
+{
+    servo_waypoint_t wp = {
+        .angle = (float)angle,
+        .duration_ms = (uint16_t)(duration_ms < 0 ? 0 : (duration_ms > 65535 ? 65535 : duration_ms)),
+        .dwell_ms = (uint16_t)(dwell_ms < 0 ? 0 : (dwell_ms > 65535 ? 65535 : dwell_ms)),
+        .profile = profile,
+    };
+    return servo_motion_queue(servo_id - 1, &wp, 1, timeout_ms);
+}
+
+static inline uint16_t clamp_ms(int ms)
+{
+    return (uint16_t)(ms < 0 ? 0 : (ms > 65535 ? 65535 : ms));
+}
+
+static inline bool duty_valid(float duty)
+{
+    return duty >= 0.0f && duty <= 100.0f;
+}
+
+/**
+ * @brief 百分比占空比转换为灯光效果的千分比
+ */
+static inline uint16_t duty_to_permille(float duty)
+{
+    return (uint16_t)(duty * 10.0f + 0.5f);
+}
+
 /**
  * @brief 初始化预设控制模块
  */
@@ -300,9 +335,15 @@ esp_err_t preset_control_execute(const preset_control_command_t *command, preset
             cJSON *actions_item = cJSON_GetObjectItem(command->parameters, "actions");
             if (actions_item && cJSON_IsArray(actions_item)) {
                 int array_size = cJSON_GetArraySize(actions_item);
+                // delay_ms为0的连续动作写到同一个PWM输出帧里，在下一个等待前一起锁存
+                bool frame_open = false;
                 for (int i = 0; i < array_size; i++) {
                     cJSON *action_item = cJSON_GetArrayItem(actions_item, i);
                     if (action_item && cJSON_IsObject(action_item)) {
+                        if (!frame_open) {
+                            frame_open = pwm_output_frame_begin() == ESP_OK;
+                        }
+
                         // 解析单个动作并执行
                         char *action_json = cJSON_Print(action_item);
                         if (action_json) {
@@ -320,9 +361,18 @@ esp_err_t preset_control_execute(const preset_control_command_t *command, preset
                         if (delay_item && cJSON_IsNumber(delay_item)) {
                             delay_ms = (int)cJSON_GetNumberValue(delay_item);
                         }
-                        vTaskDelay(pdMS_TO_TICKS(delay_ms));
+                        if (delay_ms > 0) {
+                            if (frame_open) {
+                                pwm_output_frame_commit();
+                                frame_open = false;
+                            }
+                            vTaskDelay(pdMS_TO_TICKS(delay_ms));
+                        }
                     }
                 }
+                if (frame_open) {
+                    pwm_output_frame_commit();
+                }
                 
                 result->success = true;
                 ESP_LOGI(TAG, "✅ Sequence preset executed: %d actions", array_size);
@@ -370,26 +420,31 @@ esp_err_t preset_control_execute(const preset_control_command_t *command, preset
             ESP_LOGI(TAG, "舵机%d 摆动预设: 中心=%d°, 幅度=±%d°, 速度=%dms, 次数=%d", 
                      servo_id, center_angle, swing_angle, speed_ms, cycles);
             
-            // 先移动到中心位置
-            device_control_servo(servo_id, center_angle);
-            vTaskDelay(pdMS_TO_TICKS(300));
-            
-            // 执行摆动
-            for (int cycle = 0; cycle < cycles; cycle++) {
+            // 整段摆动排进舵机路点队列，由运动控制定时器按S曲线平滑执行，不占用当前任务；
+            // 次数多于队列长度时边执行边追加（最多等一个路点的时间）
+            uint32_t timeout_ms = (uint32_t)speed_ms + 1000;
+            esp_err_t ret = queue_servo_waypoint(servo_id, center_angle, 300, 0, SERVO_PROFILE_SCURVE, timeout_ms);
+            for (int cycle = 0; cycle < cycles && ret == ESP_OK; cycle++) {
                 // 向左摆
-                device_control_servo(servo_id, left_angle);
-                vTaskDelay(pdMS_TO_TICKS(speed_ms));
-                
-                // 向右摆
-                device_control_servo(servo_id, right_angle);
-                vTaskDelay(pdMS_TO_TICKS(speed_ms));
+                ret = queue_servo_waypoint(servo_id, left_angle, speed_ms, 0, SERVO_PROFILE_SCURVE, timeout_ms);
+                if (ret == ESP_OK) {
+                    // 向右摆
+                    ret = queue_servo_waypoint(servo_id, right_angle, speed_ms, 0, SERVO_PROFILE_SCURVE, timeout_ms);
+                }
+            }
+            if (ret == ESP_OK) {
+                // 回到中心位置
+                ret = queue_servo_waypoint(servo_id, center_angle, speed_ms / 2, 0, SERVO_PROFILE_SCURVE, timeout_ms);
+            }
+            if (ret != ESP_OK) {
+                result->success = false;
+                result->error_msg = "Servo motion queue failed";
+                ESP_LOGE(TAG, "❌ Servo swing preset failed: %s", esp_err_to_name(ret));
+                return ret;
             }
-            
-            // 回到中心位置
-            device_control_servo(servo_id, center_angle);
             
             result->success = true;
-            ESP_LOGI(TAG, "✅ Servo swing preset executed: servo_id=%d, center=%d°, swing=±%d°, speed=%dms, cycles=%d", 
+            ESP_LOGI(TAG, "✅ Servo swing preset queued: servo_id=%d, center=%d°, swing=±%d°, speed=%dms, cycles=%d", 
                      servo_id, center_angle, swing_angle, speed_ms, cycles);
             return ESP_OK;
         }
@@ -429,29 +484,33 @@ esp_err_t preset_control_execute(const preset_control_command_t *command, preset
             uint16_t reverse_angle = 45;   // 反转角度（0-89之间）
             uint16_t stop_angle = 90;      // 停止角度
             
-            // 执行循环正反转
-            for (int cycle = 0; cycle < cycles; cycle++) {
-                // 正转
-                ESP_LOGI(TAG, "舵机%d 正转 (%dms)", servo_id, forward_duration_ms);
-                device_control_servo(servo_id, forward_angle);
-                vTaskDelay(pdMS_TO_TICKS(forward_duration_ms));
-                
-                // 停止
-                device_control_servo(servo_id, stop_angle);
-                vTaskDelay(pdMS_TO_TICKS(pause_time_ms));
-                
-                // 反转
-                ESP_LOGI(TAG, "舵机%d 反转 (%dms)", servo_id, reverse_duration_ms);
-                device_control_servo(servo_id, reverse_angle);
-                vTaskDelay(pdMS_TO_TICKS(reverse_duration_ms));
-                
-                // 停止
-                device_control_servo(servo_id, stop_angle);
-                vTaskDelay(pdMS_TO_TICKS(pause_time_ms));
+            // 连续旋转舵机的"角度"就是转速：速度切换按梯形曲线在加速度上限内过渡，
+            // 避免正反转瞬间换向；转动/暂停时长作为路点停留时间，整段排进队列后立即返回
+            int longest_ms = forward_duration_ms > reverse_duration_ms ? forward_duration_ms : reverse_duration_ms;
+            uint32_t timeout_ms = (uint32_t)(longest_ms > pause_time_ms ? longest_ms : pause_time_ms) + 1000;
+            esp_err_t ret = ESP_OK;
+            for (int cycle = 0; cycle < cycles && ret == ESP_OK; cycle++) {
+                // 正转 -> 停止 -> 反转 -> 停止
+                ret = queue_servo_waypoint(servo_id, forward_angle, 0, forward_duration_ms, SERVO_PROFILE_TRAPEZOID, timeout_ms);
+                if (ret == ESP_OK) {
+                    ret = queue_servo_waypoint(servo_id, stop_angle, 0, pause_time_ms, SERVO_PROFILE_TRAPEZOID, timeout_ms);
+                }
+                if (ret == ESP_OK) {
+                    ret = queue_servo_waypoint(servo_id, reverse_angle, 0, reverse_duration_ms, SERVO_PROFILE_TRAPEZOID, timeout_ms);
+                }
+                if (ret == ESP_OK) {
+                    ret = queue_servo_waypoint(servo_id, stop_angle, 0, pause_time_ms, SERVO_PROFILE_TRAPEZOID, timeout_ms);
+                }
+            }
+            if (ret != ESP_OK) {
+                result->success = false;
+                result->error_msg = "Servo motion queue failed";
+                ESP_LOGE(TAG, "❌ Servo rotate preset failed: %s", esp_err_to_name(ret));
+                return ret;
             }
             
             result->success = true;
-            ESP_LOGI(TAG, "✅ Servo rotate preset executed: servo_id=%d, cycles=%d, forward=%dms, reverse=%dms, pause=%dms", 
+            ESP_LOGI(TAG, "✅ Servo rotate preset queued: servo_id=%d, cycles=%d, forward=%dms, reverse=%dms, pause=%dms", 
                      servo_id, cycles, forward_duration_ms, reverse_duration_ms, pause_time_ms);
             return ESP_OK;
         }
@@ -494,14 +553,14 @@ esp_err_t preset_control_execute(const preset_control_command_t *command, preset
             return ESP_OK;
         }
     } else if (strcmp(command->preset_type, "fade") == 0) {
-        // PWM渐变预设
+        // PWM渐变预设（LEDC硬件渐变，立即返回）
         if (command->device_type == PRESET_DEVICE_TYPE_PWM) {
             // 获取参数
             uint32_t frequency = 5000;
             float start_duty = 0.0;
             float end_duty = 100.0;
             int duration_ms = 2000;
-            int step_interval_ms = 50;
+            bool gamma = true;
             
             if (command->parameters) {
                 cJSON *freq_item = cJSON_GetObjectItem(command->parameters, "frequency");
@@ -520,38 +579,46 @@ esp_err_t preset_control_execute(const preset_control_command_t *command, preset
                 if (duration_item && cJSON_IsNumber(duration_item)) {
                     duration_ms = (int)cJSON_GetNumberValue(duration_item);
                 }
-                cJSON *step_item = cJSON_GetObjectItem(command->parameters, "step_interval");
-                if (step_item && cJSON_IsNumber(step_item)) {
-                    step_interval_ms = (int)cJSON_GetNumberValue(step_item);
+                // step_interval 不再使用：渐变由硬件逐周期推进
+                cJSON *gamma_item = cJSON_GetObjectItem(command->parameters, "gamma");
+                if (gamma_item && cJSON_IsBool(gamma_item)) {
+                    gamma = cJSON_IsTrue(gamma_item);
                 }
             }
             
             uint8_t channel = command->device_id > 0 ? command->device_id : 2;  // 默认通道2(M2)
             
-            ESP_LOGI(TAG, "PWM渐变: 通道=%d, 频率=%lu Hz, %.1f%% -> %.1f%%, 时长=%dms",
-                     channel, frequency, start_duty, end_duty, duration_ms);
+            ESP_LOGI(TAG, "PWM渐变: 通道=%d, 频率=%lu Hz, %.1f%% -> %.1f%%, 时长=%dms, gamma=%s",
+                     channel, frequency, start_duty, end_duty, duration_ms, gamma ? "on" : "off");
             
-            // 计算步数
-            int steps = duration_ms / step_interval_ms;
-            if (steps < 1) steps = 1;
-            float duty_step = (end_duty - start_duty) / steps;
+            if (!duty_valid(start_duty) || !duty_valid(end_duty)) {
+                result->success = false;
+                result->error_msg = "Duty cycle must be 0-100";
+                return ESP_ERR_INVALID_ARG;
+            }
             
-            // 执行渐变
-            for (int i = 0; i <= steps; i++) {
-                float current_duty = start_duty + (duty_step * i);
-                pwm_control_set(channel, frequency, current_duty);
-                if (i < steps) {
-                    vTaskDelay(pdMS_TO_TICKS(step_interval_ms));
-                }
+            led_effect_t effect = {
+                .type = LED_EFFECT_FADE,
+                .from = duty_to_permille(start_duty),
+                .to = duty_to_permille(end_duty),
+                .rise_ms = clamp_ms(duration_ms),
+                .gamma = gamma,
+            };
+            esp_err_t ret = pwm_control_effect(channel, frequency, &effect);
+            if (ret != ESP_OK) {
+                result->success = false;
+                result->error_msg = "PWM effect start failed";
+                ESP_LOGE(TAG, "❌ PWM fade preset failed: %s", esp_err_to_name(ret));
+                return ret;
             }
             
             result->success = true;
-            ESP_LOGI(TAG, "✅ PWM fade preset executed: channel=%d, %.1f%% -> %.1f%%", 
+            ESP_LOGI(TAG, "✅ PWM fade preset started: channel=%d, %.1f%% -> %.1f%%", 
                      channel, start_duty, end_duty);
             return ESP_OK;
         }
     } else if (strcmp(command->preset_type, "breathe") == 0) {
-        // PWM呼吸灯预设
+        // PWM呼吸灯预设（LEDC硬件渐变，立即返回）
         if (command->device_type == PRESET_DEVICE_TYPE_PWM) {
             // 获取参数
             uint32_t frequency = 5000;
@@ -561,6 +628,7 @@ esp_err_t preset_control_execute(const preset_control_command_t *command, preset
             int fade_out_time = 1500;
             int hold_time = 500;
             int cycles = 5;
+            bool gamma = true;
             
             if (command->parameters) {
                 cJSON *freq_item = cJSON_GetObjectItem(command->parameters, "frequency");
@@ -591,51 +659,46 @@ esp_err_t preset_control_execute(const preset_control_command_t *command, preset
                 if (cycles_item && cJSON_IsNumber(cycles_item)) {
                     cycles = (int)cJSON_GetNumberValue(cycles_item);
                 }
+                cJSON *gamma_item = cJSON_GetObjectItem(command->parameters, "gamma");
+                if (gamma_item && cJSON_IsBool(gamma_item)) {
+                    gamma = cJSON_IsTrue(gamma_item);
+                }
             }
             
             uint8_t channel = command->device_id > 0 ? command->device_id : 2;
             
-            ESP_LOGI(TAG, "PWM呼吸灯: 通道=%d, %.1f%%-%.1f%%, 循环=%d次",
-                     channel, min_duty, max_duty, cycles);
+            ESP_LOGI(TAG, "PWM呼吸灯: 通道=%d, %.1f%%-%.1f%%, 循环=%d次%s",
+                     channel, min_duty, max_duty, cycles, cycles == 0 ? "（持续）" : "");
             
-            const int step_ms = 50;  // 固定步进间隔50ms
+            // cycles为0时一直呼吸，直到该通道下一次设置占空比或启动其他效果
+            if (!duty_valid(min_duty) || !duty_valid(max_duty) || cycles < 0 || cycles > 65535 ||
+                (cycles == 0 && fade_in_time <= 0 && fade_out_time <= 0 && hold_time <= 0)) {
+                result->success = false;
+                result->error_msg = "Invalid breathe parameters";
+                return ESP_ERR_INVALID_ARG;
+            }
             
-            for (int cycle = 0; cycle < cycles; cycle++) {
-                // 渐亮（从min到max）
-                int fade_in_steps = fade_in_time / step_ms;
-                float fade_in_step = (max_duty - min_duty) / fade_in_steps;
-                for (int i = 0; i <= fade_in_steps; i++) {
-                    float duty = min_duty + (fade_in_step * i);
-                    pwm_control_set(channel, frequency, duty);
-                    if (i < fade_in_steps) {
-                        vTaskDelay(pdMS_TO_TICKS(step_ms));
-                    }
-                }
-                
-                // 保持最大亮度
-                if (hold_time > 0) {
-                    vTaskDelay(pdMS_TO_TICKS(hold_time));
-                }
-                
-                // 渐暗（从max到min）
-                int fade_out_steps = fade_out_time / step_ms;
-                float fade_out_step = (max_duty - min_duty) / fade_out_steps;
-                for (int i = 0; i <= fade_out_steps; i++) {
-                    float duty = max_duty - (fade_out_step * i);
-                    pwm_control_set(channel, frequency, duty);
-                    if (i < fade_out_steps) {
-                        vTaskDelay(pdMS_TO_TICKS(step_ms));
-                    }
-                }
-                
-                // 保持最小亮度
-                if (hold_time > 0 && cycle < cycles - 1) {
-                    vTaskDelay(pdMS_TO_TICKS(hold_time));
-                }
+            led_effect_t effect = {
+                .type = LED_EFFECT_BREATHE,
+                .from = duty_to_permille(min_duty),
+                .to = duty_to_permille(max_duty),
+                .rise_ms = clamp_ms(fade_in_time),
+                .fall_ms = clamp_ms(fade_out_time),
+                .hold_high_ms = clamp_ms(hold_time),
+                .hold_low_ms = clamp_ms(hold_time),
+                .cycles = (uint16_t)cycles,
+                .gamma = gamma,
+            };
+            esp_err_t ret = pwm_control_effect(channel, frequency, &effect);
+            if (ret != ESP_OK) {
+                result->success = false;
+                result->error_msg = "PWM effect start failed";
+                ESP_LOGE(TAG, "❌ PWM breathe preset failed: %s", esp_err_to_name(ret));
+                return ret;
             }
             
             result->success = true;
-            ESP_LOGI(TAG, "✅ PWM breathe preset executed: channel=%d, %d cycles", channel, cycles);
+            ESP_LOGI(TAG, "✅ PWM breathe preset started: channel=%d, %d cycles", channel, cycles);
             return ESP_OK;
         }
     } else if (strcmp(command->preset_type, "step") == 0) {
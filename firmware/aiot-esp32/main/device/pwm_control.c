@@ -5,6 +5,7 @@
 
 #include "pwm_control.h"
 #include "driver/ledc.h"
+#include "pwm_output.h"
 #include "esp_log.h"
 
 static const char *TAG = "PWM_CONTROL";
@@ -110,6 +111,16 @@ esp_err_t pwm_control_init(void)
     s_pwm_configs[1].duty_cycle = 0.0;
     s_pwm_configs[1].enabled = false;
 
+    // M1/M2登记为灯光效果输出0/1（渐变/呼吸由硬件渐变执行）
+    ret = led_effects_attach(0, PWM_MODE, PWM_M1_CHANNEL, PWM_DUTY_RESOLUTION);
+    if (ret == ESP_OK) {
+        ret = led_effects_attach(1, PWM_MODE, PWM_M2_CHANNEL, PWM_DUTY_RESOLUTION);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to attach LED effects: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
     s_initialized = true;
     ESP_LOGI(TAG, "✅ PWM control module initialized (M1 on GPIO%d, M2 on GPIO%d)", 
              PWM_M1_GPIO, PWM_M2_GPIO);
@@ -148,7 +159,8 @@ esp_err_t pwm_control_set(uint8_t channel, uint32_t frequency, float duty_cycle)
     ledc_timer_t ledc_timer = (channel == 1) ? PWM_TIMER_M1 : PWM_TIMER_M2;
     const char* port_name = (channel == 1) ? "M1" : "M2";
 
-    ESP_LOGI(TAG, "Setting PWM %s: freq=%lu Hz, duty=%.2f%%", port_name, frequency, duty_cycle);
+    // 直接设置占空比时停止正在运行的灯光效果
+    led_effects_stop(config_index);
 
     // 更新频率（如果改变）
     if (s_pwm_configs[config_index].frequency != frequency) {
@@ -160,32 +172,71 @@ esp_err_t pwm_control_set(uint8_t channel, uint32_t frequency, float duty_cycle)
         s_pwm_configs[config_index].frequency = frequency;
     }
 
-    // 计算占空比（13位分辨率）
-    uint32_t duty = (uint32_t)((duty_cycle / 100.0) * ((1 << PWM_DUTY_RESOLUTION) - 1));
+    // 计算占空比（13位分辨率，万分比整数换算）
+    uint32_t duty = pwm_output_duty_permyriad(pwm_output_percent_to_permyriad(duty_cycle), PWM_DUTY_RESOLUTION);
     
-    // 设置占空比
-    esp_err_t ret = ledc_set_duty(PWM_MODE, ledc_channel, duty);
+    // 设置占空比（调用方打开了PWM输出帧时与同帧的其他通道一起锁存）
+    esp_err_t ret = pwm_output_write(PWM_MODE, ledc_channel, duty);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to set duty cycle: %s", esp_err_to_name(ret));
         return ret;
     }
 
-    // 更新占空比
-    ret = ledc_update_duty(PWM_MODE, ledc_channel);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to update duty cycle: %s", esp_err_to_name(ret));
-        return ret;
-    }
-
     s_pwm_configs[config_index].duty_cycle = duty_cycle;
     s_pwm_configs[config_index].enabled = (duty_cycle > 0.0);
 
-    ESP_LOGI(TAG, "✅ PWM %s set: %lu Hz, %.2f%% (duty value: %lu)", 
+    ESP_LOGD(TAG, "PWM %s set: %lu Hz, %.2f%% (duty value: %lu)", 
              port_name, frequency, duty_cycle, duty);
     
     return ESP_OK;
 }
 
+/**
+ * @brief 在PWM通道上启动灯光效果
+ */
+esp_err_t pwm_control_effect(uint8_t channel, uint32_t frequency, const led_effect_t *effect)
+{
+    if (!s_initialized) {
+        ESP_LOGE(TAG, "PWM control not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (channel != 1 && channel != 2) {
+        ESP_LOGE(TAG, "Unsupported PWM channel: %d (supported: 1=M1, 2=M2)", channel);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (frequency < 1 || frequency > 40000 || !effect) {
+        ESP_LOGE(TAG, "Invalid effect parameters (frequency: %lu Hz)", frequency);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t config_index = (channel == 1) ? 0 : 1;
+    ledc_timer_t ledc_timer = (channel == 1) ? PWM_TIMER_M1 : PWM_TIMER_M2;
+
+    // 先停止旧效果再改频率，避免旧渐变在新频率下继续推进
+    led_effects_stop(config_index);
+    if (s_pwm_configs[config_index].frequency != frequency) {
+        esp_err_t ret = ledc_set_freq(PWM_MODE, ledc_timer, frequency);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to set frequency: %s", esp_err_to_name(ret));
+            return ret;
+        }
+        s_pwm_configs[config_index].frequency = frequency;
+    }
+
+    esp_err_t ret = led_effects_start(config_index, effect);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start LED effect: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    // 记录效果结束时的占空比（渐变停在to，呼吸回到from）
+    uint16_t final = (effect->type == LED_EFFECT_FADE) ? effect->to : effect->from;
+    s_pwm_configs[config_index].duty_cycle = final / 10.0f;
+    s_pwm_configs[config_index].enabled = (final > 0);
+    return ESP_OK;
+}
+
 /**
  * @brief 启用/禁用PWM输出
  */
@@ -13,6 +13,7 @@
 #define PWM_CONTROL_H
 
 #include "esp_err.h"
+#include "led_effects.h"
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -47,6 +48,18 @@ esp_err_t pwm_control_init(void);
  */
 esp_err_t pwm_control_set(uint8_t channel, uint32_t frequency, float duty_cycle);
 
+/**
+ * @brief 在PWM通道上启动灯光效果（渐变/呼吸），由LEDC硬件渐变执行，立即返回
+ *
+ * 效果运行期间调用 pwm_control_set() 会先停止效果。
+ *
+ * @param channel PWM通道ID (1=M1, 2=M2)
+ * @param frequency 频率 (Hz, 1-40000)
+ * @param effect 效果参数（占空比为千分比）
+ * @return esp_err_t 
+ */
+esp_err_t pwm_control_effect(uint8_t channel, uint32_t frequency, const led_effect_t *effect);
+
 /**
  * @brief 启用/禁用PWM输出
  * 
@@ -59,20 +59,25 @@
 #include "button/button_handler.h"
 #include "device/device_registration.h"
 #include "server/server_config.h"  // 统一服务器配置
+#include "provisioning/provisioning_client.h"  // 配网时获取设备的MQTT broker
 #include "startup/startup_manager.h"  // 统一启动管理器
 #include "system/module_init.h"  // 模块初始化管理（旧，保留兼容）
 #include "device/device_control.h"  // 设备控制模块
 #include "device/preset_control.h"  // 预设控制模块
+#include "storage/sample_store.h"  // 传感器历史数据存储
+#include "binlog.h"                 // 二进制日志（热路径）
+#include "metrics.h"                // 运行时指标
+#include "system/task_profiler.h"  // 任务CPU/栈分析
+#include "system/config_cache.h"   // 统一配置缓存
+#include "hil_trace.h"              // 硬件在环采集
+#include "alarm.h"                  // 设备端告警规则
+#include "report_filter.h"          // 按变化上报
+#include "sensor_filter.h"          // 传感器校准和滤波
+#include "live_provision.h"         // 不重启配网
+#include "sensor/sensor_hub.h"      // 传感器框架（驱动注册表、批量采集）
 
 // 驱动层头文件
 #include "lcd_st7789.h"    // 显示驱动
-#include "dht11.h"         // 传感器驱动
-#if !defined(CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_RAIN) && !defined(CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_LITE)
-#include "ds18b20.h"       // 传感器驱动（仅标准板子）
-#endif
-#ifdef CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_RAIN
-#include "rain_sensor.h"   // 雨水传感器驱动（仅Rain板子）
-#endif
 
 // 组件层头文件
 #include "lvgl_display.h"  // 显示组件
@@ -92,12 +97,12 @@ static const char *TAG = "AIOT_MAIN";
 static char g_device_id[128] = {0};  // 增加到128字符以支持长Device ID（用于client_id）
 static char g_device_uuid[128] = {0};  // 设备UUID（用于MQTT主题，与device_uuid_info_t中的长度一致）
 
-// 服务器地址缓存（避免在事件处理器中读取NVS导致栈溢出）
-static char g_server_address[64] = {0};  // 服务器地址缓存
 static char g_mqtt_command_topic[256] = {0};  // 相应增加MQTT主题长度
 static char g_mqtt_sensor_topic[256] = {0};
 static char g_mqtt_status_topic[256] = {0};
 static char g_mqtt_heartbeat_topic[256] = {0};
+static char g_mqtt_metrics_topic[256] = {0};
+static char g_mqtt_alarm_topic[256] = {0};
 
 // WiFi连接状态定义
 #define WIFI_CONNECTED_BIT BIT0
@@ -122,6 +127,8 @@ static void update_device_id_and_topics(const char *device_uuid)
         snprintf(g_mqtt_sensor_topic, sizeof(g_mqtt_sensor_topic), "devices/%s/data", g_device_uuid);
         snprintf(g_mqtt_status_topic, sizeof(g_mqtt_status_topic), "devices/%s/status", g_device_uuid);
         snprintf(g_mqtt_heartbeat_topic, sizeof(g_mqtt_heartbeat_topic), "devices/%s/heartbeat", g_device_uuid);
+        snprintf(g_mqtt_metrics_topic, sizeof(g_mqtt_metrics_topic), "devices/%s/metrics", g_device_uuid);
+        snprintf(g_mqtt_alarm_topic, sizeof(g_mqtt_alarm_topic), "devices/%s/alarm", g_device_uuid);
         
         ESP_LOGI(TAG, "Device UUID: %s", g_device_uuid);
         ESP_LOGI(TAG, "MQTT主题已构建: control=%s, data=%s, heartbeat=%s", 
@@ -131,25 +138,10 @@ static void update_device_id_and_topics(const char *device_uuid)
 
 // 全局状态变量（需要在函数之前定义）
 static bool g_wifi_connected = false;
+static bool s_runtime_started = false;  // 传感器已初始化（start_runtime只初始化一次）
 static bool g_mqtt_connected = false;
 static bool g_ble_connected = false;
 
-// DHT11传感器相关
-static bool g_dht11_initialized = false;
-static dht11_data_t g_sensor_data = {0};
-
-// DS18B20传感器相关（仅标准板子）
-#if !defined(CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_RAIN) && !defined(CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_LITE)
-static bool g_ds18b20_initialized = false;
-static ds18b20_data_t g_ds18b20_data = {0};
-#endif
-
-// 雨水传感器相关（仅Rain板子）
-#ifdef CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_RAIN
-static bool g_rain_sensor_initialized = false;
-static rain_sensor_data_t g_rain_sensor_data = {0};
-#endif
-
 // 系统运行时间
 static uint32_t g_system_start_time = 0;
 
@@ -251,47 +243,43 @@ static void __attribute__((unused)) device_registration_event_callback(device_re
     }
 }
 
+static void show_provisioning_ui(void);
+static void start_runtime(void);
+static void wifi_config_event_handler(wifi_config_event_t event, void *data);
+
 /**
- * @brief 配网重启任务（避免在定时器上下文中执行复杂操作导致栈溢出）
+ * @brief 进入配网任务（避免在定时器上下文中执行复杂操作导致栈溢出）
+ *
+ * 不再重启：停止MQTT，注销启动流程的WiFi重连处理，直接打开配网热点。
+ * 新凭据由 live_provision 在AP+STA下验证后接回运行中的系统。
  */
-static void provision_restart_task(void *pvParameters) {
-    ESP_LOGI(TAG, "⏳ 准备进入配网模式...");
+static void provision_enter_task(void *pvParameters) {
+    ESP_LOGI(TAG, "⏳ 进入配网模式...");
     
-    // 设置强制配网标志（NVS写入操作）
+    // 设置强制配网标志：配网过程中断电，重启后仍进入配网
     wifi_config_set_force_flag();
+    config_cache_flush();
     ESP_LOGI(TAG, "✅ 配网标志已设置");
     
-    // 停止按钮处理，避免冲突
-    button_handler_deinit();
-    ESP_LOGI(TAG, "✅ 按钮处理已停止");
-    
-    // ⚠️ 重要：在重启前停止WiFi和MQTT，避免在重启过程中触发事件导致崩溃
     ESP_LOGI(TAG, "🛑 停止MQTT客户端...");
     if (g_mqtt_connected) {
         mqtt_client_disconnect();
-        vTaskDelay(pdMS_TO_TICKS(200));  // 等待断开完成
     }
+    startup_manager_release_wifi();
+    g_wifi_connected = false;
     
-    ESP_LOGI(TAG, "🛑 停止WiFi连接...");
-    esp_wifi_disconnect();
-    vTaskDelay(pdMS_TO_TICKS(200));  // 等待WiFi断开事件处理完成
-    
-    ESP_LOGI(TAG, "🛑 停止WiFi驱动...");
-    esp_wifi_stop();
-    vTaskDelay(pdMS_TO_TICKS(200));  // 等待WiFi完全停止
-    
-    ESP_LOGI(TAG, "✅ 所有服务已停止");
-    
-    // 延迟1秒，确保日志输出完成和事件处理完成
-    vTaskDelay(pdMS_TO_TICKS(500));
-    
-    ESP_LOGI(TAG, "🔄 设备重启中...");
-    vTaskDelay(pdMS_TO_TICKS(100));
-    
-    // 重启设备
-    esp_restart();
+    esp_err_t ret = wifi_config_init(wifi_config_event_handler);
+    if (ret == ESP_OK) {
+        ret = wifi_config_start();
+    }
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "✅ WiFi AP配网模式已启动");
+        show_provisioning_ui();
+    } else {
+        ESP_LOGE(TAG, "❌ WiFi AP配网模式启动失败: %s，重启进入配网", esp_err_to_name(ret));
+        esp_restart();
+    }
     
-    // 永远不会执行到这里
     vTaskDelete(NULL);
 }
 
@@ -308,18 +296,23 @@ static void button_event_handler(button_event_t event) {
         case BUTTON_EVENT_LONG_PRESS:
             ESP_LOGI(TAG, "🔔 Boot按键长按检测 - 启动配网流程");
             
-            // 创建一个独立任务来处理重启操作，避免在定时器上下文中执行复杂操作导致栈溢出
+            if (live_provision_is_active() || wifi_config_get_state() != WIFI_CONFIG_STATE_IDLE) {
+                ESP_LOGI(TAG, "ℹ️ 已在配网模式中");
+                break;
+            }
+            
+            // 创建一个独立任务来处理，避免在按键输入任务中执行复杂操作导致栈溢出
             BaseType_t ret = xTaskCreate(
-                provision_restart_task,
-                "provision_restart",
-                4096,  // 4KB栈空间，足够执行NVS操作和重启
+                provision_enter_task,
+                "provision_enter",
+                4096,  // 4KB栈空间，足够执行NVS操作和启动热点
                 NULL,
                 5,     // 优先级
                 NULL
             );
             
             if (ret != pdPASS) {
-                ESP_LOGE(TAG, "❌ 创建配网重启任务失败");
+                ESP_LOGE(TAG, "❌ 创建配网任务失败");
             }
             break;
             
@@ -344,7 +337,7 @@ static void __attribute__((unused)) wifi_config_event_handler(wifi_config_event_
             break;
             
         case WIFI_CONFIG_EVENT_CONFIG_RECEIVED:
-            ESP_LOGI(TAG, "收到WiFi配置，设备即将重启");
+            ESP_LOGI(TAG, "收到WiFi配置，开始连接验证");
             break;
             
         case WIFI_CONFIG_EVENT_WIFI_CONNECTED:
@@ -475,8 +468,11 @@ void wifi_event_handler(void* arg, esp_event_base_t event_base,
             // 更新WiFi状态（合并显示）
             simple_display_update_wifi_status(g_simple_display, (char*)wifi_config.sta.ssid, "Connected");
             
-            // 使用缓存的服务器地址（避免在事件处理器中读取NVS导致栈溢出）
-            const char *server_addr = (strlen(g_server_address) > 0) ? g_server_address : "Loading...";
+            // 服务器地址从配置缓存读取（不访问NVS，可在事件处理器中调用）
+            char server_addr[64];
+            if (!config_cache_get_server_address(server_addr, sizeof(server_addr))) {
+                strcpy(server_addr, "Loading...");
+            }
             
             // 显示详细信息（使用配置的产品ID）
             simple_display_show_detailed_info(g_simple_display,
@@ -527,8 +523,11 @@ static void mqtt_event_callback(const mqtt_event_data_t *event_data)
                 wifi_config_t wifi_config;
                 esp_wifi_get_config(WIFI_IF_STA, &wifi_config);
                 
-                // 使用缓存的服务器地址（避免在事件处理器中读取NVS导致栈溢出）
-                const char *server_addr = (strlen(g_server_address) > 0) ? g_server_address : "Loading...";
+                // 服务器地址从配置缓存读取（不访问NVS，可在事件处理器中调用）
+                char server_addr[64];
+                if (!config_cache_get_server_address(server_addr, sizeof(server_addr))) {
+                    strcpy(server_addr, "Loading...");
+                }
                 
                 // 显示详细信息（使用配置的产品ID）
                 simple_display_show_detailed_info(g_simple_display,
@@ -744,6 +743,250 @@ static void bt_provision_event_callback(bt_provision_state_t state, bt_provision
 // 已移除未使用的函数: init_all_modules (已由 startup_manager_run() 替代)
 
 
+// === 运行时指标 ===
+METRIC_HISTOGRAM_DEFINE(s_m_sensor_read_ms, "sensor_read_ms", 5, 10, 20, 50, 100, 200, 500, 1000);
+METRIC_COUNTER_DEFINE(s_m_sensor_read_ok, "sensor_read_ok");
+METRIC_COUNTER_DEFINE(s_m_sensor_read_fail, "sensor_read_fail");
+METRIC_GAUGE_DEFINE(s_m_heap_free, "heap_free");
+METRIC_GAUGE_DEFINE(s_m_heap_min_free, "heap_min_free");
+METRIC_GAUGE_DEFINE(s_m_wifi_rssi, "wifi_rssi");
+METRIC_COUNTER_DEFINE(s_m_alarm_events, "alarm_events");
+METRIC_COUNTER_DEFINE(s_m_reports_suppressed, "reports_suppressed");
+METRIC_COUNTER_DEFINE(s_m_sensor_rejected, "sensor_rejected");
+METRIC_COUNTER_DEFINE(s_m_sensor_outliers, "sensor_outliers");
+
+/**
+ * @brief 告警产生/解除时立即以QoS1发布到 devices/<uuid>/alarm
+ */
+static void alarm_event_handler(const alarm_event_t *event, void *ctx)
+{
+    metric_inc(&s_m_alarm_events);
+
+    if (!g_mqtt_connected || strlen(g_mqtt_alarm_topic) == 0) {
+        ESP_LOGW(TAG, "⚠️ MQTT not connected, alarm not sent");
+        return;
+    }
+
+    char alarm_json[192];
+    size_t len = alarm_event_json(event, alarm_json, sizeof(alarm_json));
+    if (len > 0 && mqtt_client_publish(g_mqtt_alarm_topic, alarm_json, len, MQTT_QOS_1, false) == ESP_OK) {
+        // binlog延迟格式化，不能引用栈上的 alarm_json；只记录数值和常量字符串
+        BINLOG_I(TAG, "✅ Alarm published: sensor=%u ch=%u %s %s value=%.2f", event->sensor, event->channel,
+                 alarm_kind_name(event->kind), event->active ? "active" : "cleared", event->value);
+    } else {
+        ESP_LOGE(TAG, "❌ Alarm publish failed");
+    }
+}
+
+/**
+ * @brief 记录一次有效采样：写入历史数据存储并判断告警
+ */
+static void record_sample(sample_sensor_id_t sensor, uint8_t channel, float value)
+{
+    if (sample_store_is_ready()) {
+        sample_store_append_now(sensor, channel, value);
+    }
+    alarm_feed(sensor, channel, value, (uint32_t)(esp_timer_get_time() / 1000));
+}
+
+/**
+ * @brief 对一次有效读数做校准和滤波，values原地替换为处理后的值
+ *
+ * @return false 有通道超出合理范围，本次读数丢弃（不显示、不记录、不上报）
+ */
+static bool condition_sample(sample_sensor_id_t sensor, float *values, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        sensor_filter_result_t result = sensor_filter_apply(sensor, (uint8_t)i, values[i], &values[i]);
+        if (result == SENSOR_FILTER_REJECTED) {
+            metric_inc(&s_m_sensor_rejected);
+            return false;
+        }
+        if (result == SENSOR_FILTER_REPLACED) {
+            metric_inc(&s_m_sensor_outliers);
+            ESP_LOGW(TAG, "⚠️ 传感器%d 通道%u 离群值已替换为 %.2f", sensor, (unsigned)i, values[i]);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 按上报策略判断本次采样是否需要发布到MQTT
+ */
+static bool sensor_report_due(sample_sensor_id_t sensor, const float *values, size_t count)
+{
+    report_reason_t reason = report_filter_check(sensor, values, count, (uint32_t)(esp_timer_get_time() / 1000));
+    if (reason == REPORT_SKIP) {
+        metric_inc(&s_m_reports_suppressed);
+        ESP_LOGD(TAG, "📉 传感器%d 数值在死区内，本次不上报", sensor);
+        return false;
+    }
+    ESP_LOGD(TAG, "📤 传感器%d 上报原因: %s", sensor, report_filter_reason_name(reason));
+    return true;
+}
+
+/**
+ * @brief 发布成功后记录上报值，作为下次判断死区的基准
+ */
+static void sensor_report_done(sample_sensor_id_t sensor, const float *values, size_t count)
+{
+    report_filter_commit(sensor, values, count, (uint32_t)(esp_timer_get_time() / 1000));
+    live_provision_mark(LIVE_PROVISION_MARK_TELEMETRY);
+}
+
+/**
+ * @brief 加载传感器校准和滤波配置：先设置默认值，再用配置缓存中保存的配置覆盖
+ */
+static void load_sensor_filters(const config_snapshot_t *cfg)
+{
+    // 合理范围取传感器规格；Hampel窗口5、3倍MAD，最小偏差避免整数读数时MAD为0误判
+    static const sensor_filter_config_t defaults[] = {
+        { .sensor = SAMPLE_SENSOR_DHT11, .channel = 0, .hampel_n = 5, .hampel_k_x10 = 30,
+          .hampel_floor = 2000, .min = 0, .max = 50000 },
+        { .sensor = SAMPLE_SENSOR_DHT11, .channel = 1, .hampel_n = 5, .hampel_k_x10 = 30,
+          .hampel_floor = 5000, .min = 0, .max = 100000 },
+        { .sensor = SAMPLE_SENSOR_DS18B20, .channel = 0, .hampel_n = 5, .hampel_k_x10 = 30,
+          .hampel_floor = 1000, .min = -55000, .max = 125000 },
+        { .sensor = SAMPLE_SENSOR_RAIN, .channel = 0, .min = 0, .max = 1000 },
+    };
+    for (size_t i = 0; i < sizeof(defaults) / sizeof(defaults[0]); i++) {
+        sensor_filter_configure(&defaults[i]);
+    }
+    for (size_t i = 0; i < cfg->sensor_filter_count; i++) {
+        if (sensor_filter_configure(&cfg->sensor_filters[i]) != ESP_OK) {
+            ESP_LOGW(TAG, "⚠️ 忽略无效的滤波配置: 传感器%u 通道%u",
+                     cfg->sensor_filters[i].sensor, cfg->sensor_filters[i].channel);
+        }
+    }
+}
+
+/**
+ * @brief 加载上报策略：先设置各传感器默认值，再用配置缓存中保存的策略覆盖
+ */
+static void load_report_policies(const config_snapshot_t *cfg)
+{
+    // 默认死区：温度0.5°C（DHT11湿度同样按0.5判断）、雨水电平任何变化（湿润程度按0.5%判断）
+    static const report_policy_t defaults[] = {
+        { .sensor = SAMPLE_SENSOR_DHT11, .deadband_abs = 0.5f,
+          .min_interval_sec = CONFIG_REPORT_FILTER_DEFAULT_MIN_INTERVAL_SEC,
+          .max_interval_sec = CONFIG_REPORT_FILTER_DEFAULT_MAX_INTERVAL_SEC },
+        { .sensor = SAMPLE_SENSOR_DS18B20, .deadband_abs = 0.25f,
+          .min_interval_sec = CONFIG_REPORT_FILTER_DEFAULT_MIN_INTERVAL_SEC,
+          .max_interval_sec = CONFIG_REPORT_FILTER_DEFAULT_MAX_INTERVAL_SEC },
+        { .sensor = SAMPLE_SENSOR_RAIN, .deadband_abs = 0.5f,
+          .min_interval_sec = 1,  // 电平抖动时最多每秒上报一次
+          .max_interval_sec = CONFIG_REPORT_FILTER_DEFAULT_MAX_INTERVAL_SEC },
+    };
+    for (size_t i = 0; i < sizeof(defaults) / sizeof(defaults[0]); i++) {
+        report_filter_set_policy(&defaults[i]);
+    }
+    for (size_t i = 0; i < cfg->report_policy_count; i++) {
+        if (report_filter_set_policy(&cfg->report_policies[i]) != ESP_OK) {
+            ESP_LOGW(TAG, "⚠️ 忽略无效的上报策略: 传感器%u", cfg->report_policies[i].sensor);
+        }
+    }
+    report_filter_set_enabled(cfg->report_by_exception);
+}
+
+/**
+ * @brief 采样仪表类指标并发布指标快照到 devices/<uuid>/metrics
+ */
+static void publish_metrics_snapshot(void)
+{
+    metric_set(&s_m_heap_free, (int32_t)esp_get_free_heap_size());
+    metric_set(&s_m_heap_min_free, (int32_t)esp_get_minimum_free_heap_size());
+
+    wifi_ap_record_t ap_info;
+    if (g_wifi_connected && esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
+        metric_set(&s_m_wifi_rssi, ap_info.rssi);
+    }
+
+    if (!g_mqtt_connected || strlen(g_mqtt_metrics_topic) == 0) {
+        return;
+    }
+
+    char *json = malloc(CONFIG_METRICS_SNAPSHOT_BUF_SIZE);
+    if (!json) {
+        ESP_LOGW(TAG, "⚠️ 内存不足，跳过本次指标上报");
+        return;
+    }
+
+    size_t len = 0;
+    if (metrics_snapshot_json(json, CONFIG_METRICS_SNAPSHOT_BUF_SIZE, &len) == ESP_OK) {
+        ESP_LOGD(TAG, "📦 Metrics: %s", json);
+        if (mqtt_client_publish(g_mqtt_metrics_topic, json, len, MQTT_QOS_0, false) == ESP_OK) {
+            BINLOG_I(TAG, "✅ Metrics published (%u bytes)", (unsigned)len);
+        } else {
+            ESP_LOGW(TAG, "⚠️ Metrics publish failed");
+        }
+    }
+    free(json);
+}
+
+/**
+ * @brief 处理一次采集结果：校准滤波、显示、写入历史、按上报策略发布（周期采集和数据变化通知共用）
+ *
+ * @return true 读数有效
+ */
+static bool process_sensor_reading(sensor_hub_reading_t *reading, uint32_t uptime)
+{
+    sensor_hub_sensor_t info;
+    if (sensor_hub_get(reading->index, &info) != ESP_OK) {
+        return false;
+    }
+    const char *name = info.driver->report_name ? info.driver->report_name : info.driver->name;
+    sample_sensor_id_t id = reading->id;
+
+    metric_observe(&s_m_sensor_read_ms, reading->read_us / 1000);
+    bool ok = reading->err == ESP_OK;
+    metric_add(&s_m_sensor_read_fail, reading->attempts - (ok ? 1 : 0));
+    if (!ok) {
+        ESP_LOGW(TAG, "⚠️ %s读取失败: %s", name, esp_err_to_name(reading->err));
+        return false;
+    }
+    metric_inc(&s_m_sensor_read_ok);
+
+    // 配置了滤波时以滤波后的值为准
+    if (!condition_sample(id, reading->values, reading->count)) {
+        return false;
+    }
+
+    char text[48];
+    sensor_hub_format_display(reading->index, reading->values, text, sizeof(text));
+    ESP_LOGI(TAG, "🌡️ %s数据 - %s (尝试次数: %d)", name, text, reading->attempts);
+
+    // 更新动态传感器UI（显示顺序与注册表一致）
+    if (g_simple_display) {
+        simple_display_update_sensor_value(g_simple_display, reading->index, text);
+    }
+
+    // 写入历史数据存储并判断告警
+    for (uint8_t ch = 0; ch < reading->count; ch++) {
+        record_sample(id, ch, reading->values[ch]);
+    }
+
+    // 上传传感器数据到MQTT（按上报策略）
+    if (g_mqtt_connected && sensor_report_due(id, reading->values, reading->count)) {
+        char sensor_json[SENSOR_HUB_JSON_MAX];
+        size_t len = sensor_hub_format_json(reading->index, g_device_id, reading->values, uptime,
+                                            sensor_json, sizeof(sensor_json));
+        ESP_LOGD(TAG, "📦 Payload: %s", sensor_json);
+
+        // 只有真正交给MQTT客户端的读数才计入上报策略，失败的读数重连后按原值补报
+        esp_err_t ret = len > 0 ? mqtt_client_publish(g_mqtt_sensor_topic, sensor_json, len, MQTT_QOS_1, false)
+                                : ESP_ERR_INVALID_SIZE;
+        if (ret == ESP_OK) {
+            BINLOG_I(TAG, "✅ %s data published", name);
+            sensor_report_done(id, reading->values, reading->count);
+        } else {
+            ESP_LOGE(TAG, "❌ %s data publish failed: %s", name, esp_err_to_name(ret));
+        }
+    } else if (!g_mqtt_connected) {
+        ESP_LOGW(TAG, "⚠️ MQTT not connected, %s data not sent", name);
+    }
+    return true;
+}
+
 /**
  * @brief 系统状态监控任务
  */
@@ -754,16 +997,24 @@ static void system_monitor_task(void *pvParameters)
     static uint32_t last_heartbeat_time = 0;
     static uint32_t last_sensor_report_time = 0;
     static uint32_t last_status_report_time = 0;
+    static uint32_t last_metrics_report_time = 0;
     
     // 心跳间隔已移到心跳发送代码中，使用CONFIG_MQTT_HEARTBEAT_INTERVAL_MS（默认30秒）
     const uint32_t SENSOR_REPORT_INTERVAL = 10;  // 传感器数据上报间隔：10秒
     const uint32_t STATUS_REPORT_INTERVAL = 30;  // 系统状态上报间隔：30秒
     
+    // 支持通知的传感器（雨水传感器电平变化）通过任务通知唤醒本任务立即上报，不依赖10秒轮询
+    sensor_hub_enable_notify(xTaskGetCurrentTaskHandle());
+    static sensor_hub_reading_t readings[CONFIG_SENSOR_HUB_MAX_SENSORS];
+    
     while (1) {
         // 获取系统信息
         uint32_t free_heap = esp_get_free_heap_size();
         uint32_t uptime = (esp_timer_get_time() / 1000000) - g_system_start_time;
         
+        // 任务分析窗口 = 本循环间隔（5秒）
+        task_profiler_sample();
+        
         // 更新Simple Display运行时间和连接状态
         if (g_simple_display) {
             simple_display_update_uptime(g_simple_display, uptime);
@@ -812,8 +1063,7 @@ static void system_monitor_task(void *pvParameters)
                     heartbeat_sequence, timestamp_ms, status);
                 
                 // 显示心跳数据包
-                ESP_LOGI(TAG, "📤 Publishing heartbeat to topic: %s", g_mqtt_heartbeat_topic);
-                ESP_LOGI(TAG, "📦 Payload: %s", heartbeat_json);
+                ESP_LOGD(TAG, "📦 Payload: %s", heartbeat_json);
                 
                 // 发布心跳（QoS=1，符合文档要求）
                 esp_err_t pub_ret = mqtt_client_publish(g_mqtt_heartbeat_topic, heartbeat_json, 
@@ -821,6 +1071,7 @@ static void system_monitor_task(void *pvParameters)
                 if (pub_ret == ESP_OK) {
                     ESP_LOGI(TAG, "💓 Heartbeat #%lu sent successfully (status=%d, timestamp=%llu ms)", 
                              heartbeat_sequence, status, timestamp_ms);
+                    live_provision_mark(LIVE_PROVISION_MARK_TELEMETRY);
                 } else {
                     ESP_LOGW(TAG, "Heartbeat publish failed: %s", esp_err_to_name(pub_ret));
                 }
@@ -832,163 +1083,13 @@ static void system_monitor_task(void *pvParameters)
         if (uptime - last_sensor_report_time >= SENSOR_REPORT_INTERVAL) {
             bool sensor_data_updated = false;
             
-            // 读取DHT11传感器数据（带重试：最多尝试3次）
-            if (g_dht11_initialized) {
-                esp_err_t dht11_ret = ESP_FAIL;
-                int dht11_retry_count = 0;
-                const int dht11_max_retries = 3;
-                
-                // 重试读取（最多3次）
-                while (dht11_retry_count < dht11_max_retries) {
-                    dht11_ret = dht11_read_adapter(&g_sensor_data);
-                    if (dht11_ret == ESP_OK && g_sensor_data.valid) {
-                        // 读取成功
-                        break;
-                    }
-                    dht11_retry_count++;
-                    if (dht11_retry_count < dht11_max_retries) {
-                        ESP_LOGW(TAG, "DHT11读取失败，重试 %d/%d...", dht11_retry_count, dht11_max_retries - 1);
-                        vTaskDelay(pdMS_TO_TICKS(100));  // 重试前延迟100ms
-                    }
-                }
-                
-                if (g_sensor_data.valid) {
-                    ESP_LOGI(TAG, "🌡️ DHT11数据 - 温度: %.1f°C, 湿度: %.1f%% (尝试次数: %d)", 
-                             g_sensor_data.temperature, g_sensor_data.humidity, dht11_retry_count + 1);
-                    
-                    // 更新动态传感器UI - DHT11（传感器索引0）
-                    if (g_simple_display) {
-                        char dht11_value[32];
-                        snprintf(dht11_value, sizeof(dht11_value), "%.1fC / %.1f%%", 
-                                g_sensor_data.temperature, g_sensor_data.humidity);
-                        simple_display_update_sensor_value(g_simple_display, 0, dht11_value);
-                    }
-                    
-                    // 上传DHT11传感器数据到MQTT
-                    if (g_mqtt_connected) {
-                        char sensor_json[256];
-                        snprintf(sensor_json, sizeof(sensor_json),
-                            "{\"device_id\":\"%s\",\"sensor\":\"DHT11\",\"temperature\":%.1f,\"humidity\":%.1f,\"timestamp\":%lu}",
-                            g_device_id, g_sensor_data.temperature, g_sensor_data.humidity, uptime);
-                        
-                        ESP_LOGI(TAG, "📤 Publishing DHT11 data to topic: %s", g_mqtt_sensor_topic);
-                        ESP_LOGI(TAG, "📦 Payload: %s", sensor_json);
-                        
-                        int msg_id = mqtt_client_publish(g_mqtt_sensor_topic, sensor_json, strlen(sensor_json), MQTT_QOS_1, false);
-                        if (msg_id >= 0) {
-                            ESP_LOGI(TAG, "✅ DHT11 data published successfully (msg_id=%d)", msg_id);
-                        } else {
-                            ESP_LOGE(TAG, "❌ DHT11 data publish failed (msg_id=%d)", msg_id);
-                        }
-                    } else {
-                        ESP_LOGW(TAG, "⚠️ MQTT not connected, DHT11 data not sent");
-                    }
-                    sensor_data_updated = true;
-                } else {
-                    ESP_LOGW(TAG, "DHT11读取失败（已重试%d次）", dht11_max_retries);
-                }
-            }
-            
-            // 读取DS18B20传感器数据（仅标准板子，Rain和Lite板子不使用DS18B20）
-#if !defined(CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_RAIN) && !defined(CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_LITE)
-            if (g_ds18b20_initialized) {
-                esp_err_t ds18b20_ret = ESP_FAIL;
-                int ds18b20_retry_count = 0;
-                const int ds18b20_max_retries = 3;
-                
-                // 重试读取（最多3次）
-                while (ds18b20_retry_count < ds18b20_max_retries) {
-                    ds18b20_ret = ds18b20_read(&g_ds18b20_data);
-                    if (ds18b20_ret == ESP_OK && g_ds18b20_data.valid) {
-                        // 读取成功
-                        break;
-                    }
-                    ds18b20_retry_count++;
-                    if (ds18b20_retry_count < ds18b20_max_retries) {
-                        ESP_LOGW(TAG, "DS18B20读取失败，重试 %d/%d...", ds18b20_retry_count, ds18b20_max_retries - 1);
-                        vTaskDelay(pdMS_TO_TICKS(100));  // 重试前延迟100ms
-                    }
-                }
-                
-                if (g_ds18b20_data.valid) {
-                    ESP_LOGI(TAG, "🌡️ DS18B20数据 - 温度: %.1f°C (尝试次数: %d)", 
-                             g_ds18b20_data.temperature, ds18b20_retry_count + 1);
-                    
-                    // 更新动态传感器UI - DS18B20（传感器索引1，仅标准板）
-                        if (g_simple_display) {
-                        char ds18b20_value[32];
-                        snprintf(ds18b20_value, sizeof(ds18b20_value), "%.1fC", g_ds18b20_data.temperature);
-                        simple_display_update_sensor_value(g_simple_display, 1, ds18b20_value);
-                    }
-                    
-                    // 上传DS18B20传感器数据到MQTT
-                    if (g_mqtt_connected) {
-                        char sensor_json[256];
-                        snprintf(sensor_json, sizeof(sensor_json),
-                            "{\"device_id\":\"%s\",\"sensor\":\"DS18B20\",\"temperature\":%.1f,\"timestamp\":%lu}",
-                            g_device_id, g_ds18b20_data.temperature, uptime);
-                        
-                        ESP_LOGI(TAG, "📤 Publishing DS18B20 data to topic: %s", g_mqtt_sensor_topic);
-                        ESP_LOGI(TAG, "📦 Payload: %s", sensor_json);
-                        
-                        int msg_id = mqtt_client_publish(g_mqtt_sensor_topic, sensor_json, strlen(sensor_json), MQTT_QOS_1, false);
-                        if (msg_id >= 0) {
-                            ESP_LOGI(TAG, "✅ DS18B20 data published successfully (msg_id=%d)", msg_id);
-                        } else {
-                            ESP_LOGE(TAG, "❌ DS18B20 data publish failed (msg_id=%d)", msg_id);
-                        }
-                    } else {
-                        ESP_LOGW(TAG, "⚠️ MQTT not connected, DS18B20 data not sent");
-                    }
+            // 先启动所有传感器的转换再依次采集，转换时间互相重叠
+            size_t n = sensor_hub_read_all(readings, CONFIG_SENSOR_HUB_MAX_SENSORS);
+            for (size_t i = 0; i < n; i++) {
+                if (process_sensor_reading(&readings[i], uptime)) {
                     sensor_data_updated = true;
-                } else {
-                    ESP_LOGW(TAG, "DS18B20读取失败（已重试%d次）", ds18b20_max_retries);
                 }
             }
-#endif  // CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_RAIN
-            
-            // 读取雨水传感器数据（仅Rain板子）
-#ifdef CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_RAIN
-            if (g_rain_sensor_initialized) {
-                esp_err_t rain_ret = rain_sensor_read(&g_rain_sensor_data);
-                if (rain_ret == ESP_OK && g_rain_sensor_data.valid) {
-                    ESP_LOGI(TAG, "🌧️ 雨水传感器数据 - 是否下雨: %s, 电平: %d", 
-                             g_rain_sensor_data.is_raining ? "是" : "否", g_rain_sensor_data.level);
-                    
-                    // 更新动态传感器UI - 雨水传感器（传感器索引1，仅Rain板）
-                    if (g_simple_display) {
-                        const char *rain_status = g_rain_sensor_data.is_raining ? "Raining" : "Dry";
-                        simple_display_update_sensor_value(g_simple_display, 1, rain_status);
-                    }
-                    
-                    // 上传雨水传感器数据到MQTT
-                    if (g_mqtt_connected) {
-                        char sensor_json[256];
-                        snprintf(sensor_json, sizeof(sensor_json),
-                            "{\"device_id\":\"%s\",\"sensor\":\"RAIN_SENSOR\",\"is_raining\":%s,\"level\":%d,\"timestamp\":%lu}",
-                            g_device_id, 
-                            g_rain_sensor_data.is_raining ? "true" : "false",
-                            g_rain_sensor_data.level,
-                            uptime);
-                        
-                        ESP_LOGI(TAG, "📤 Publishing RAIN_SENSOR data to topic: %s", g_mqtt_sensor_topic);
-                        ESP_LOGI(TAG, "📦 Payload: %s", sensor_json);
-                        
-                        int msg_id = mqtt_client_publish(g_mqtt_sensor_topic, sensor_json, strlen(sensor_json), MQTT_QOS_1, false);
-                        if (msg_id >= 0) {
-                            ESP_LOGI(TAG, "✅ RAIN_SENSOR data published successfully (msg_id=%d)", msg_id);
-                        } else {
-                            ESP_LOGE(TAG, "❌ RAIN_SENSOR data publish failed (msg_id=%d)", msg_id);
-                        }
-                    } else {
-                        ESP_LOGW(TAG, "⚠️ MQTT not connected, RAIN_SENSOR data not sent");
-                    }
-                    sensor_data_updated = true;
-                } else {
-                    ESP_LOGW(TAG, "⚠️ 雨水传感器读取失败: %s", esp_err_to_name(rain_ret));
-                }
-            }
-#endif
             
             if (sensor_data_updated) {
                 ESP_LOGI(TAG, "📊 传感器数据已上报");
@@ -1047,14 +1148,13 @@ static void system_monitor_task(void *pvParameters)
                     g_ble_connected ? "true" : "false",
                     uptime);
                 
-                ESP_LOGI(TAG, "📤 Publishing status to topic: %s", g_mqtt_status_topic);
-                ESP_LOGI(TAG, "📦 Payload: %s", status_json);
+                ESP_LOGD(TAG, "📦 Payload: %s", status_json);
                 
-                int msg_id = mqtt_client_publish(g_mqtt_status_topic, status_json, strlen(status_json), MQTT_QOS_1, false);
-                if (msg_id >= 0) {
-                    ESP_LOGI(TAG, "✅ System status published successfully (msg_id=%d)", msg_id);
+                esp_err_t ret = mqtt_client_publish(g_mqtt_status_topic, status_json, strlen(status_json), MQTT_QOS_1, false);
+                if (ret == ESP_OK) {
+                    BINLOG_I(TAG, "✅ System status published");
                 } else {
-                    ESP_LOGE(TAG, "❌ System status publish failed (msg_id=%d)", msg_id);
+                    ESP_LOGE(TAG, "❌ System status publish failed: %s", esp_err_to_name(ret));
                 }
             } else {
                 ESP_LOGW(TAG, "⚠️ MQTT not connected, system status not sent");
@@ -1062,6 +1162,13 @@ static void system_monitor_task(void *pvParameters)
             last_status_report_time = uptime;
         }
         
+        // === 运行时指标上报（CONFIG_METRICS_PUBLISH_INTERVAL_SEC，0表示关闭） ===
+        if (CONFIG_METRICS_PUBLISH_INTERVAL_SEC > 0 &&
+            uptime - last_metrics_report_time >= CONFIG_METRICS_PUBLISH_INTERVAL_SEC) {
+            publish_metrics_snapshot();
+            last_metrics_report_time = uptime;
+        }
+        
         // 简化的MQTT连接管理 - 依赖ESP-IDF自动重连，但需要设备先注册
         static bool mqtt_start_attempted = false;
         if (g_wifi_connected && !g_mqtt_connected && !mqtt_start_attempted && g_device_registered) {
@@ -1095,13 +1202,214 @@ static void system_monitor_task(void *pvParameters)
             }
         }
         
-        vTaskDelay(pdMS_TO_TICKS(5000)); // 5秒检查一次，提高响应性
+        // 5秒检查一次，提高响应性；等待期间传感器数据变化（雨水电平）会提前唤醒，
+        // 处理完后继续等待剩余时间，不影响其他周期任务的节奏
+        TickType_t wait_start = xTaskGetTickCount();
+        const TickType_t wait_ticks = pdMS_TO_TICKS(5000);
+        TickType_t waited;
+        while ((waited = xTaskGetTickCount() - wait_start) < wait_ticks) {
+            if (ulTaskNotifyTake(pdTRUE, wait_ticks - waited) == 0) {
+                break;
+            }
+            uint32_t now_uptime = (esp_timer_get_time() / 1000000) - g_system_start_time;
+            size_t n = sensor_hub_read_notified(readings, CONFIG_SENSOR_HUB_MAX_SENSORS);
+            for (size_t i = 0; i < n; i++) {
+                process_sensor_reading(&readings[i], now_uptime);
+            }
+        }
     }
 #endif
 }
 
 
 
+/**
+ * @brief 在LCD上显示配网引导信息
+ */
+static void show_provisioning_ui(void)
+{
+    if (g_simple_display) {
+        const char *ap_ssid = wifi_config_get_ap_ssid();
+        const char *web_url = wifi_config_get_web_url();
+        ESP_LOGI(TAG, "📺 正在LCD上显示配网引导信息...");
+        simple_display_show_provisioning_info(g_simple_display, ap_ssid, web_url);
+        ESP_LOGI(TAG, "✅ LCD配网引导信息已显示");
+    }
+}
+
+/**
+ * @brief 不重启配网：向配置服务器获取设备的MQTT broker（与启动流程连接的是同一个地址）
+ *
+ * 结果同时作为本次开机的引导结果，交接后的启动流程不再重复请求
+ */
+static esp_err_t live_provision_resolve_broker(const live_provision_request_t *req, char *host, size_t host_size,
+                                               uint16_t *port, void *ctx)
+{
+    provisioning_config_t *config = malloc(sizeof(provisioning_config_t));
+    if (!config) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t ret = provisioning_client_get_config(req->server_address, PRODUCT_ID, FIRMWARE_VERSION, config);
+    if (ret == ESP_OK && !config->has_mqtt_config) {
+        ESP_LOGE(TAG, "❌ 设备配置中没有MQTT配置");
+        ret = ESP_ERR_INVALID_RESPONSE;
+    }
+    if (ret == ESP_OK) {
+        ret = live_provision_parse_host(config->mqtt_broker, host, host_size);
+        *port = config->mqtt_port > 0 && config->mqtt_port <= 65535 ?
+                (uint16_t)config->mqtt_port : LIVE_PROVISION_DEFAULT_MQTT_PORT;
+        ESP_LOGI(TAG, "📡 设备MQTT broker: %s:%u", host, *port);
+    }
+    free(config);
+    return ret;
+}
+
+/**
+ * @brief 不重启配网：配置服务器和broker验证通过后保存配置
+ */
+static esp_err_t live_provision_persist(const live_provision_request_t *req, void *ctx)
+{
+    wifi_config_data_t data = {0};
+    strncpy(data.ssid, req->ssid, sizeof(data.ssid) - 1);
+    strncpy(data.password, req->password, sizeof(data.password) - 1);
+    data.configured = true;
+    return wifi_config_commit(&data, req->server_address);
+}
+
+/**
+ * @brief 不重启配网：继续WiFi之后的启动流程并进入运行状态
+ */
+static esp_err_t live_provision_handoff(void *ctx)
+{
+    esp_err_t ret = startup_manager_resume();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "❌ 配网后启动失败: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    start_runtime();
+    return ESP_OK;
+}
+
+/**
+ * @brief 不重启配网：上线并上报耗时后关闭配网热点
+ */
+static void live_provision_finish(void *ctx)
+{
+    wifi_config_finish();
+}
+
+/**
+ * @brief 启动成功后进入运行状态：同步设备ID/主题、初始化传感器、切换LCD运行界面
+ *
+ * 正常启动和不重启配网上线后都调用
+ */
+static void start_runtime(void)
+{
+    // ✅ 关键修复：从startup_manager获取device UUID并更新MQTT主题
+    const char *device_uuid = startup_manager_get_device_uuid();
+    const char *device_id = startup_manager_get_device_id();
+    
+    if (device_uuid && strlen(device_uuid) > 0) {
+        // 更新device UUID和MQTT主题
+        update_device_id_and_topics(device_uuid);
+        ESP_LOGI(TAG, "✅ 已从startup_manager设置Device UUID和MQTT主题");
+    } else {
+        ESP_LOGW(TAG, "⚠️ 未能从startup_manager获取Device UUID");
+    }
+    
+    if (device_id && strlen(device_id) > 0) {
+        strncpy(g_device_id, device_id, sizeof(g_device_id) - 1);
+        g_device_id[sizeof(g_device_id) - 1] = '\0';
+        ESP_LOGI(TAG, "✅ 已设置Device ID: %s", g_device_id);
+    }
+    
+    // ✅ WiFi已在startup_manager中连接，更新状态
+    g_wifi_connected = true;
+    ESP_LOGI(TAG, "✅ WiFi状态已同步");
+    
+    // 传感器和历史存储只初始化一次（运行中重新配网后再次进入时跳过）
+    if (!s_runtime_started) {
+        s_runtime_started = true;
+        
+        // 挂载历史数据存储（userdata分区，分区不存在时仅告警）
+        if (sample_store_init() != ESP_OK) {
+            ESP_LOGW(TAG, "⚠️ 历史数据存储不可用，传感器数据将只实时上报");
+        }
+        
+        // ✅ 初始化传感器（在系统启动成功后）
+        // 按板级传感器表（board_config.h BOARD_SENSOR_TABLE）注册，每个传感器独立初始化，互不影响
+        ESP_LOGI(TAG, "📊 初始化传感器...");
+        hal_err_t sensor_ret = bsp_sensor_init();
+        if (sensor_ret != HAL_OK) {
+            ESP_LOGW(TAG, "⚠️ 传感器初始化失败: %d - 系统将继续运行，但传感器数据不可用", sensor_ret);
+        }
+    }
+    
+    // ✅ 启动完成后，切换LCD到运行时主界面
+    if (g_simple_display) {
+        ESP_LOGI(TAG, "📺 切换LCD到运行时主界面...");
+        
+        // 准备显示数据
+        const char *product_str = PRODUCT_ID;
+        const char *wifi_status_str = g_wifi_connected ? "Connected" : "Disconnected";
+        const char *mqtt_status_str = g_mqtt_connected ? "Connected" : "Connecting...";
+        const char *uuid_str = (device_uuid && strlen(device_uuid) > 0) ? device_uuid : "Loading...";
+        
+        // 初始温湿度显示为占位符（传感器数据会在后续更新）
+        float init_temp = 0.0f;
+        float init_hum = 0.0f;
+        uint32_t init_uptime = 0;
+        
+        // 1️⃣ 先显示运行时主界面（这会清空屏幕）
+        simple_display_show_runtime_main(g_simple_display,
+                                       product_str,
+                                       wifi_status_str,
+                                       mqtt_status_str,
+                                       uuid_str,
+                                       init_temp,
+                                       init_hum,
+                                       init_uptime);
+        
+        ESP_LOGI(TAG, "✅ LCD运行时主界面已显示");
+        ESP_LOGI(TAG, "   Product: %s", product_str);
+        ESP_LOGI(TAG, "   WiFi: %s", wifi_status_str);
+        ESP_LOGI(TAG, "   MQTT: %s", mqtt_status_str);
+        ESP_LOGI(TAG, "   UUID: %s", uuid_str);
+        
+        // 2️⃣ 然后初始化传感器动态UI（在主界面基础上添加传感器显示）
+        ESP_LOGI(TAG, "🎨 初始化传感器动态UI...");
+        static sensor_display_info_t sensor_list[CONFIG_SENSOR_HUB_MAX_SENSORS];
+        board_sensor_config_t sensor_config = { .sensor_list = sensor_list, .sensor_count = 0 };
+        sensor_hub_sensor_t info;
+        for (size_t i = 0; i < sensor_hub_count() && sensor_hub_get(i, &info) == ESP_OK; i++) {
+            sensor_list[i] = (sensor_display_info_t){
+                .name = info.label,
+                .unit = info.driver->unit ? info.driver->unit : "",
+                .gpio_pin = info.entry->pin,
+            };
+            sensor_config.sensor_count++;
+        }
+        if (sensor_config.sensor_count > 0) {
+            // 初始化传感器UI（在主界面下方显示）
+            simple_display_init_sensor_ui(g_simple_display, &sensor_config);
+            
+            const bsp_board_info_t *board_info = bsp_get_board_info();
+            ESP_LOGI(TAG, "✅ 传感器动态UI初始化完成");
+            ESP_LOGI(TAG, "   板子: %s", board_info ? board_info->board_name : "unknown");
+            ESP_LOGI(TAG, "   传感器数量: %d", sensor_config.sensor_count);
+            for (int i = 0; i < sensor_config.sensor_count; i++) {
+                ESP_LOGI(TAG, "   传感器%d: %s (GPIO%d) %s", 
+                         i + 1,
+                         sensor_config.sensor_list[i].name,
+                         sensor_config.sensor_list[i].gpio_pin,
+                         sensor_config.sensor_list[i].unit);
+            }
+        } else {
+            ESP_LOGW(TAG, "⚠️ 未找到传感器配置信息，跳过传感器UI初始化");
+        }
+    }
+}
+
 /**
  * @brief ESP32应用程序入口
  */
@@ -1125,18 +1433,49 @@ void app_main(void)
     ESP_ERROR_CHECK(ret);
     ESP_LOGI(TAG, "NVS initialized");
     
+    // 配置缓存：WiFi/服务器/注册信息一次性读入RAM，之后各模块不再直接读NVS
+    ESP_ERROR_CHECK(config_cache_init());
+    
+    // 不重启配网：AP网页/BLE提交的凭据在线验证后直接接回启动流程
+    static const live_provision_hooks_t live_hooks = {
+        .resolve_broker = live_provision_resolve_broker,
+        .persist = live_provision_persist,
+        .handoff = live_provision_handoff,
+        .finish = live_provision_finish,
+    };
+    live_provision_set_hooks(&live_hooks);
+    
+    // 二进制日志：热路径日志写入logs分区（分区不存在时只输出到串口）
+    binlog_init();
+    
+    // 任务CPU/栈分析：由system_monitor_task每个循环采样一次，get_status命令读取报告
+    task_profiler_init(NULL);
+    
+    // 告警规则：从配置缓存加载，每次采样后在本地判断，告警立即上报
+    config_snapshot_t *cfg = malloc(sizeof(config_snapshot_t));
+    if (cfg) {
+        config_cache_get(cfg);
+        if (alarm_init(alarm_event_handler, NULL) == ESP_OK) {
+            size_t rules = alarm_load_rules(cfg->alarm_rules, cfg->alarm_rule_count);
+            ESP_LOGI(TAG, "🔔 已加载 %u 条告警规则", (unsigned)rules);
+        }
+        if (report_filter_init() == ESP_OK) {
+            load_report_policies(cfg);
+        }
+        if (sensor_filter_init() == ESP_OK) {
+            load_sensor_filters(cfg);
+        }
+        free(cfg);
+    }
+    
     // =====================================
-    // 🔘 配置Boot按键GPIO（准备后续检测）
+    // 🔘 按键输入（中断驱动），同时开始Boot按键启动窗口
     // =====================================
-    gpio_config_t boot_io_conf = {
-        .intr_type = GPIO_INTR_DISABLE,
-        .mode = GPIO_MODE_INPUT,
-        .pin_bit_mask = (1ULL << BOOT_BUTTON_GPIO),
-        .pull_down_en = GPIO_PULLDOWN_DISABLE,
-        .pull_up_en = GPIO_PULLUP_ENABLE,
-    };
-    gpio_config(&boot_io_conf);
-    ESP_LOGI(TAG, "Boot按键GPIO配置完成");
+    // 启动窗口在后台计时，与BSP/LCD初始化和启动画面并行；
+    // 结果由启动流程在连接WiFi之前读取（startup_manager 步骤2.6）
+    if (button_handler_init(button_event_handler) != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ 按键输入初始化失败，启动时按住Boot进入配网不可用");
+    }
 #endif
     
     // 初始化BSP（根据Kconfig配置选择板子）
@@ -1212,67 +1551,6 @@ void app_main(void)
         }
     }
     
-    // =====================================
-    // 🔘 启动Boot按键检测窗口（带倒计时提示）
-    // =====================================
-    ESP_LOGI(TAG, "🔘 启动Boot按键检测窗口...");
-    bool boot_key_detected = false;
-    const int detection_window_ms = 3000;  // 3秒检测窗口
-    const int sample_interval_ms = 100;    // 100ms采样一次
-    const int samples_needed = 3;          // 需要连续3次检测到按下才确认
-    int pressed_count = 0;
-    
-    for (int elapsed_ms = 0; elapsed_ms < detection_window_ms; elapsed_ms += sample_interval_ms) {
-        // 计算剩余时间（秒）
-        int remaining_sec = (detection_window_ms - elapsed_ms) / 1000 + 1;
-        
-        // 在LCD上显示倒计时提示
-        if (g_simple_display) {
-            char countdown_msg[64];
-            snprintf(countdown_msg, sizeof(countdown_msg), "Boot key -> Config (%ds)", remaining_sec);
-            simple_display_show_startup_step(g_simple_display, "Detect", countdown_msg);
-        }
-        
-        // 读取Boot按键状态
-        int boot_level = gpio_get_level(BOOT_BUTTON_GPIO);
-        if (boot_level == 0) {
-            // 检测到按键按下
-            pressed_count++;
-            ESP_LOGI(TAG, "🔘 Boot按键按下检测 (%d/%d)", pressed_count, samples_needed);
-            
-            if (pressed_count >= samples_needed) {
-                // 连续多次检测到按下，确认按键有效
-                boot_key_detected = true;
-                ESP_LOGW(TAG, "✅ Boot按键长按确认！将进入配网模式");
-                
-                // 在LCD上显示确认信息
-                if (g_simple_display) {
-                    simple_display_show_startup_step(g_simple_display, "Boot Key", "Enter Config Mode!");
-                    vTaskDelay(pdMS_TO_TICKS(1000));  // 显示1秒
-                }
-                break;
-            }
-        } else {
-            // 按键未按下，重置计数
-            pressed_count = 0;
-        }
-        
-        vTaskDelay(pdMS_TO_TICKS(sample_interval_ms));
-    }
-    
-    // 如果检测到Boot按键，设置配网标志
-    if (boot_key_detected) {
-        ESP_LOGW(TAG, "🔘 设置强制配网标志（启动时检测到Boot按键）");
-        wifi_config_set_force_flag();
-        ESP_LOGW(TAG, "✅ 配网标志已设置，系统将进入配网模式");
-    } else {
-        ESP_LOGI(TAG, "🔘 Boot按键未检测到，正常启动");
-        // 清除检测提示，准备显示正常启动流程
-        if (g_simple_display) {
-            simple_display_clear_for_startup(g_simple_display);
-        }
-    }
-    
     // =====================================
     // 使用统一启动管理器初始化所有功能模块
     // =====================================
@@ -1282,174 +1560,7 @@ void app_main(void)
     if (init_ret == ESP_OK) {
         ESP_LOGI(TAG, "✅ 系统启动完成");
         
-        // ✅ 关键修复：从startup_manager获取device UUID并更新MQTT主题
-        const char *device_uuid = startup_manager_get_device_uuid();
-        const char *device_id = startup_manager_get_device_id();
-        
-        if (device_uuid && strlen(device_uuid) > 0) {
-            // 更新device UUID和MQTT主题
-            update_device_id_and_topics(device_uuid);
-            ESP_LOGI(TAG, "✅ 已从startup_manager设置Device UUID和MQTT主题");
-        } else {
-            ESP_LOGW(TAG, "⚠️ 未能从startup_manager获取Device UUID");
-        }
-        
-        if (device_id && strlen(device_id) > 0) {
-            strncpy(g_device_id, device_id, sizeof(g_device_id) - 1);
-            g_device_id[sizeof(g_device_id) - 1] = '\0';
-            ESP_LOGI(TAG, "✅ 已设置Device ID: %s", g_device_id);
-        }
-        
-        // ✅ WiFi已在startup_manager中连接，更新状态
-        g_wifi_connected = true;
-        ESP_LOGI(TAG, "✅ WiFi状态已同步");
-        
-        // ✅ 初始化传感器（在系统启动成功后）
-        // 每个传感器独立初始化，互不影响
-        ESP_LOGI(TAG, "📊 初始化传感器...");
-        
-        // 初始化DHT11传感器（独立初始化）
-        dht11_config_t dht11_config = {
-            .data_pin = DHT11_GPIO_PIN
-        };
-        esp_err_t dht11_ret = dht11_init_adapter(&dht11_config);
-        if (dht11_ret == ESP_OK) {
-            g_dht11_initialized = true;
-            ESP_LOGI(TAG, "✅ DHT11传感器初始化成功 - GPIO%d已就绪", DHT11_GPIO_PIN);
-        } else {
-            g_dht11_initialized = false;
-            ESP_LOGW(TAG, "⚠️ DHT11传感器初始化失败: %s - 将继续运行，DHT11数据不可用", esp_err_to_name(dht11_ret));
-        }
-        
-        // 初始化DS18B20传感器（仅标准板子，Rain和Lite板子不使用DS18B20）
-#if !defined(CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_RAIN) && !defined(CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_LITE)
-        ds18b20_config_t ds18b20_config = {
-            .data_pin = DS18B20_GPIO_PIN
-        };
-        esp_err_t ds18b20_ret = ds18b20_init(&ds18b20_config);
-        if (ds18b20_ret == ESP_OK) {
-            g_ds18b20_initialized = true;
-            ESP_LOGI(TAG, "✅ DS18B20传感器初始化成功 - GPIO%d已就绪", DS18B20_GPIO_PIN);
-        } else {
-            g_ds18b20_initialized = false;
-            ESP_LOGW(TAG, "⚠️ DS18B20传感器初始化失败: %s - 将继续运行，DS18B20数据不可用", esp_err_to_name(ds18b20_ret));
-        }
-#else
-        // Rain和Lite板子不使用DS18B20
-        // g_ds18b20_initialized 在Rain和Lite板子时未定义，不需要设置
-#if defined(CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_RAIN)
-        ESP_LOGI(TAG, "ℹ️ Rain板子：DS18B20已禁用，GPIO39用于雨水传感器");
-#elif defined(CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_LITE)
-        ESP_LOGI(TAG, "ℹ️ Lite板子：DS18B20已禁用，仅支持DHT11传感器");
-#endif
-#endif
-        
-        // ✅ 初始化雨水传感器（仅Rain板子，独立初始化，不影响其他传感器）
-#ifdef CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_RAIN
-        ESP_LOGI(TAG, "🌧️ 初始化雨水传感器...");
-        rain_sensor_config_t rain_config = {
-            .data_pin = RAIN_SENSOR_GPIO_PIN,  // GPIO39（原DS18B20管脚）
-            .pull_up_enable = true,  // 启用内部上拉
-            .debounce_ms = 50         // 50ms防抖
-        };
-        esp_err_t rain_ret = rain_sensor_init(&rain_config);
-        if (rain_ret == ESP_OK) {
-            g_rain_sensor_initialized = true;
-            ESP_LOGI(TAG, "✅ 雨水传感器初始化成功 - GPIO%d已就绪", RAIN_SENSOR_GPIO_PIN);
-        } else {
-            g_rain_sensor_initialized = false;  // 明确设置为false，确保读取逻辑不会尝试读取
-            ESP_LOGW(TAG, "⚠️ 雨水传感器初始化失败: %s - 将继续运行，雨水传感器数据不可用（不影响其他传感器）", esp_err_to_name(rain_ret));
-        }
-#endif
-        
-        // 总结所有传感器初始化结果
-#ifdef CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_RAIN
-        // Rain板子：DHT11 + 雨水传感器（GPIO39）
-        if (g_dht11_initialized || g_rain_sensor_initialized) {
-            ESP_LOGI(TAG, "📊 所有传感器初始化完成 - DHT11: %s, 雨水传感器(GPIO39): %s", 
-                     g_dht11_initialized ? "✅" : "❌",
-                     g_rain_sensor_initialized ? "✅" : "❌");
-        } else {
-            ESP_LOGW(TAG, "⚠️ 所有传感器初始化失败 - 系统将继续运行，但传感器数据不可用");
-        }
-#else
-        // 标准板子：DHT11 + DS18B20
-#if !defined(CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_RAIN) && !defined(CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_LITE)
-        if (g_dht11_initialized || g_ds18b20_initialized) {
-            ESP_LOGI(TAG, "📊 传感器初始化完成 - DHT11: %s, DS18B20: %s", 
-                     g_dht11_initialized ? "✅" : "❌",
-                     g_ds18b20_initialized ? "✅" : "❌");
-        } else {
-            ESP_LOGW(TAG, "⚠️ DHT11和DS18B20传感器初始化失败 - 系统将继续运行，但这两个传感器数据不可用");
-        }
-#elif defined(CONFIG_AIOT_BOARD_ESP32_S3_DEVKIT_LITE)
-        // Lite板子：仅DHT11
-        if (g_dht11_initialized) {
-            ESP_LOGI(TAG, "📊 传感器初始化完成 - DHT11: ✅");
-        } else {
-            ESP_LOGW(TAG, "⚠️ DHT11传感器初始化失败 - 系统将继续运行，但传感器数据不可用");
-        }
-#endif
-#endif
-        
-        // ✅ 启动完成后，切换LCD到运行时主界面
-        if (g_simple_display) {
-            ESP_LOGI(TAG, "📺 切换LCD到运行时主界面...");
-            
-            // 准备显示数据
-            const char *product_str = PRODUCT_ID;
-            const char *wifi_status_str = g_wifi_connected ? "Connected" : "Disconnected";
-            const char *mqtt_status_str = g_mqtt_connected ? "Connected" : "Connecting...";
-            const char *uuid_str = (device_uuid && strlen(device_uuid) > 0) ? device_uuid : "Loading...";
-            
-            // 初始温湿度显示为占位符（传感器数据会在后续更新）
-            float init_temp = 0.0f;
-            float init_hum = 0.0f;
-            uint32_t init_uptime = 0;
-            
-            // 1️⃣ 先显示运行时主界面（这会清空屏幕）
-            simple_display_show_runtime_main(g_simple_display,
-                                           product_str,
-                                           wifi_status_str,
-                                           mqtt_status_str,
-                                           uuid_str,
-                                           init_temp,
-                                           init_hum,
-                                           init_uptime);
-            
-            ESP_LOGI(TAG, "✅ LCD运行时主界面已显示");
-            ESP_LOGI(TAG, "   Product: %s", product_str);
-            ESP_LOGI(TAG, "   WiFi: %s", wifi_status_str);
-            ESP_LOGI(TAG, "   MQTT: %s", mqtt_status_str);
-            ESP_LOGI(TAG, "   UUID: %s", uuid_str);
-            
-            // 2️⃣ 然后初始化传感器动态UI（在主界面基础上添加传感器显示）
-            ESP_LOGI(TAG, "🎨 初始化传感器动态UI...");
-            const bsp_board_info_t *board_info = bsp_get_board_info();
-            if (board_info && board_info->sensor_display_count > 0) {
-                // 构建传感器配置（需要类型转换，因为结构体布局相同）
-                board_sensor_config_t sensor_config = {
-                    .sensor_list = (const sensor_display_info_t *)board_info->sensor_display_list,
-                    .sensor_count = board_info->sensor_display_count
-                };
-                
-                // 初始化传感器UI（在主界面下方显示）
-                simple_display_init_sensor_ui(g_simple_display, &sensor_config);
-                
-                ESP_LOGI(TAG, "✅ 传感器动态UI初始化完成");
-                ESP_LOGI(TAG, "   板子: %s", board_info->board_name);
-                ESP_LOGI(TAG, "   传感器数量: %d", sensor_config.sensor_count);
-                for (int i = 0; i < sensor_config.sensor_count; i++) {
-                    ESP_LOGI(TAG, "   传感器%d: %s (GPIO%d) %s", 
-                             i + 1,
-                             sensor_config.sensor_list[i].name,
-                             sensor_config.sensor_list[i].gpio_pin,
-                             sensor_config.sensor_list[i].unit);
-                }
-            } else {
-                ESP_LOGW(TAG, "⚠️ 未找到传感器配置信息，跳过传感器UI初始化");
-            }
-        }
+        start_runtime();
         
     } else {
         ESP_LOGE(TAG, "❌ 系统启动失败: %s", esp_err_to_name(init_ret));
@@ -1502,13 +1613,7 @@ void app_main(void)
                     ESP_LOGI(TAG, "🌐 打开浏览器访问: %s", wifi_config_get_web_url());
                     
                     // 📺 在LCD上显示配网信息
-                    if (g_simple_display) {
-                        const char *ap_ssid = wifi_config_get_ap_ssid();
-                        const char *web_url = wifi_config_get_web_url();
-                        ESP_LOGI(TAG, "📺 正在LCD上显示配网引导信息...");
-                        simple_display_show_provisioning_info(g_simple_display, ap_ssid, web_url);
-                        ESP_LOGI(TAG, "✅ LCD配网引导信息已显示");
-                    }
+                    show_provisioning_ui();
                 } else {
                     ESP_LOGE(TAG, "❌ WiFi AP配网模式启动失败: %s", esp_err_to_name(config_ret));
                 }
@@ -5,6 +5,9 @@
 
 #include "aiot_mqtt_client.h"
 #include "esp_log.h"
+#include "binlog.h"
+#include "metrics.h"
+#include "hil_trace.h"
 #include "esp_system.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -30,10 +33,53 @@ static bool g_auto_reconnect = true;
 static uint32_t g_reconnect_interval = 5000;
 // 移除未使用的重连变量，依赖ESP-IDF自动重连
 static esp_mqtt_client_handle_t g_mqtt_client = NULL;
+static int64_t g_connected_since_us = 0;
+
+// 运行时指标
+METRIC_HISTOGRAM_DEFINE(s_m_puback_ms, "mqtt_puback_ms", 20, 50, 100, 200, 500, 1000, 2000, 5000);
+METRIC_COUNTER_DEFINE(s_m_publish_fail, "mqtt_publish_fail");
+METRIC_COUNTER_DEFINE(s_m_reconnects, "mqtt_reconnects");
+METRIC_COUNTER_DEFINE(s_m_rx_messages, "mqtt_rx");
+
+// QoS>0消息的发布时间，用于统计 发布->PUBACK 延迟（槽位按msg_id取模，冲突时覆盖旧记录）
+#define PUBACK_TRACK_SLOTS 16
+typedef struct {
+    int msg_id;
+    int64_t sent_us;
+} puback_slot_t;
+static puback_slot_t g_puback_slots[PUBACK_TRACK_SLOTS];
+static portMUX_TYPE g_puback_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void puback_track_sent(int msg_id)
+{
+    puback_slot_t *slot = &g_puback_slots[(unsigned)msg_id % PUBACK_TRACK_SLOTS];
+    portENTER_CRITICAL(&g_puback_lock);
+    slot->msg_id = msg_id;
+    slot->sent_us = esp_timer_get_time();
+    portEXIT_CRITICAL(&g_puback_lock);
+}
+
+static void puback_track_acked(int msg_id)
+{
+    int64_t sent_us = 0;
+    puback_slot_t *slot = &g_puback_slots[(unsigned)msg_id % PUBACK_TRACK_SLOTS];
+    portENTER_CRITICAL(&g_puback_lock);
+    if (slot->msg_id == msg_id && slot->sent_us != 0) {
+        sent_us = slot->sent_us;
+        slot->sent_us = 0;
+    }
+    portEXIT_CRITICAL(&g_puback_lock);
+
+    if (sent_us != 0) {
+        metric_observe_since_ms(&s_m_puback_ms, sent_us);
+    }
+}
 
 // ESP-IDF MQTT事件处理函数
 static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data)
 {
+    (void)handler_args;
+    (void)base;
     esp_mqtt_event_handle_t event = event_data;
     mqtt_event_data_t callback_data = {0};
     
@@ -44,6 +90,7 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
             
             g_mqtt_state = MQTT_STATE_CONNECTED;
             g_mqtt_stats.state = g_mqtt_state;
+            g_connected_since_us = esp_timer_get_time();
             
             callback_data.event = MQTT_EVENT_CONNECTED;
             callback_data.state = g_mqtt_state;
@@ -59,6 +106,8 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
             g_mqtt_state = MQTT_STATE_DISCONNECTED;
             g_mqtt_stats.state = g_mqtt_state;
             g_mqtt_stats.reconnect_count++;
+            g_connected_since_us = 0;
+            metric_inc(&s_m_reconnects);
             
             ESP_LOGI(TAG, "🔄 ESP-IDF will handle automatic reconnection");
             
@@ -79,8 +128,9 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
             break;
             
         case MQTT_EVENT_PUBLISHED:
-            ESP_LOGI(TAG, "MQTT_EVENT_PUBLISHED, msg_id=%d", event->msg_id);
+            BINLOG_I(TAG, "MQTT_EVENT_PUBLISHED, msg_id=%d", event->msg_id);
             g_mqtt_stats.messages_sent++;
+            puback_track_acked(event->msg_id);
             callback_data.event = AIOT_MQTT_EVENT_MESSAGE_SENT;
             callback_data.state = g_mqtt_state;
             callback_data.error_code = ESP_OK;
@@ -90,11 +140,16 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
             break;
             
         case MQTT_EVENT_DATA:
-            ESP_LOGI(TAG, "MQTT_EVENT_DATA");
-            ESP_LOGI(TAG, "TOPIC=%.*s", event->topic_len, event->topic);
-            ESP_LOGI(TAG, "DATA=%.*s", event->data_len, event->data);
+            // 热路径：只记录长度，完整内容仅在DEBUG级别输出
+            BINLOG_I(TAG, "MQTT_EVENT_DATA, msg_id=%d, topic_len=%d, data_len=%d",
+                     event->msg_id, event->topic_len, event->data_len);
+            ESP_LOGD(TAG, "TOPIC=%.*s", event->topic_len, event->topic);
+            ESP_LOGD(TAG, "DATA=%.*s", event->data_len, event->data);
             
             g_mqtt_stats.messages_received++;
+            metric_inc(&s_m_rx_messages);
+            hil_trace_mqtt(HIL_TRACE_MQTT_RX, event->topic, event->topic_len,
+                           event->data, event->data_len, event->qos);
             
             // 构造消息数据
             mqtt_message_t message = {0};
@@ -107,17 +162,12 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base, int32_
             message.payload_len = data_len;
             message.timestamp = esp_timer_get_time() / 1000;
             
-            ESP_LOGI(TAG, "🔔 准备调用回调函数 (g_mqtt_callback=%p, event=AIOT_MQTT_EVENT_MESSAGE_RECEIVED)", g_mqtt_callback);
-            ESP_LOGI(TAG, "🔔 消息内容: topic=%s, payload_len=%d", message.topic, message.payload_len);
-            
             callback_data.event = AIOT_MQTT_EVENT_MESSAGE_RECEIVED;
             callback_data.state = g_mqtt_state;
             callback_data.message = &message;
             callback_data.error_code = ESP_OK;
             if (g_mqtt_callback) {
-                ESP_LOGI(TAG, "🔔 正在调用回调函数...");
                 g_mqtt_callback(&callback_data);
-                ESP_LOGI(TAG, "🔔 回调函数调用完成");
             } else {
                 ESP_LOGE(TAG, "❌ 回调函数为NULL，无法处理MQTT消息！");
             }
@@ -377,18 +427,20 @@ esp_err_t mqtt_client_publish(const char *topic, const void *payload, size_t pay
         return ESP_ERR_INVALID_ARG;
     }
     
-    ESP_LOGI(TAG, "Publishing to topic: %s", topic);
-    ESP_LOGI(TAG, "Payload length: %d bytes", payload_len);
-    
     // 使用ESP-IDF MQTT客户端发布消息
     int msg_id = esp_mqtt_client_publish(g_mqtt_client, topic, (const char*)payload, payload_len, qos, retain ? 1 : 0);
     if (msg_id < 0) {
         ESP_LOGE(TAG, "Failed to publish message");
         g_mqtt_stats.messages_failed++;
+        metric_inc(&s_m_publish_fail);
         return ESP_FAIL;
     }
+    if (qos != MQTT_QOS_0) {
+        puback_track_sent(msg_id);
+    }
+    hil_trace_mqtt(HIL_TRACE_MQTT_TX, topic, strlen(topic), payload, payload_len, qos);
     
-    ESP_LOGI(TAG, "Message published with msg_id: %d", msg_id);
+    BINLOG_I(TAG, "Message published: msg_id=%d, len=%u", msg_id, (unsigned)payload_len);
     return ESP_OK;
 }
 
@@ -463,6 +515,8 @@ esp_err_t mqtt_client_get_statistics(mqtt_statistics_t *stats)
     }
     
     memcpy(stats, &g_mqtt_stats, sizeof(mqtt_statistics_t));
+    // 本次连接已持续的时间（未连接时为0）
+    stats->uptime_seconds = g_connected_since_us ? (uint32_t)((esp_timer_get_time() - g_connected_since_us) / 1000000) : 0;
     return ESP_OK;
 }
 
@@ -476,6 +530,11 @@ esp_err_t mqtt_client_reset_statistics(void)
 esp_err_t mqtt_client_set_will(const char *topic, const void *payload, size_t payload_len,
                                mqtt_qos_level_t qos, bool retain)
 {
+    (void)topic;
+    (void)payload;
+    (void)payload_len;
+    (void)qos;
+    (void)retain;
     if (!g_mqtt_initialized) {
         ESP_LOGE(TAG, "MQTT client not initialized");
         return ESP_ERR_INVALID_STATE;
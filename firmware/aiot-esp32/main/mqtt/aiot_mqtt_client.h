@@ -80,7 +80,7 @@ typedef struct {
     uint32_t messages_failed;
     uint32_t reconnect_count;
     uint32_t last_error_code;
-    uint32_t uptime_seconds;
+    uint32_t uptime_seconds;       // 当前连接已持续时间（秒），未连接为0
     mqtt_connection_state_t state;
 } mqtt_statistics_t;
 
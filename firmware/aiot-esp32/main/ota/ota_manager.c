@@ -7,43 +7,32 @@
  */
 
 #include "ota_manager.h"
+#include "http_session.h"
+#include "provisioning_client.h"
 #include "esp_log.h"
 #include "esp_http_client.h"
 #include "esp_ota_ops.h"
 #include "esp_app_format.h"
 #include "esp_partition.h"
 #include "esp_timer.h"
-#include "cJSON.h"
+#include "json_stream.h"
 #include <string.h>
 #include <stdlib.h>
 
 #define TAG "OTA_MANAGER"
 #define OTA_BUFFER_SIZE 1024
-#define MAX_HTTP_RECV_BUFFER 4096
 
-static char http_response_buffer[MAX_HTTP_RECV_BUFFER];
-static int http_response_len = 0;
 static ota_progress_callback_t s_progress_callback = NULL;
 
-/**
- * @brief HTTP事件处理器（用于响应接收）
- */
-static esp_err_t http_event_handler(esp_http_client_event_t *evt) {
-    switch (evt->event_id) {
-        case HTTP_EVENT_ON_DATA:
-            if (http_response_len + evt->data_len < MAX_HTTP_RECV_BUFFER) {
-                memcpy(http_response_buffer + http_response_len, evt->data, evt->data_len);
-                http_response_len += evt->data_len;
-                http_response_buffer[http_response_len] = '\0';
-            } else {
-                ESP_LOGW(TAG, "HTTP响应缓冲区已满");
-            }
-            break;
-        default:
-            break;
-    }
-    return ESP_OK;
-}
+// /device/info 响应中的固件更新字段（流式解析，直接写入firmware_info_t）
+static const json_field_t s_fw_fields[] = {
+    JSON_FIELD(JSON_FIELD_BOOL, "firmware_update.available", firmware_info_t, available),
+    JSON_FIELD(JSON_FIELD_STRING, "firmware_update.version", firmware_info_t, version),
+    JSON_FIELD(JSON_FIELD_STRING, "firmware_update.download_url", firmware_info_t, download_url),
+    JSON_FIELD(JSON_FIELD_UINT32, "firmware_update.file_size", firmware_info_t, file_size),
+    JSON_FIELD(JSON_FIELD_STRING, "firmware_update.checksum", firmware_info_t, checksum),
+    JSON_FIELD(JSON_FIELD_STRING, "firmware_update.changelog", firmware_info_t, changelog),
+};
 
 esp_err_t ota_manager_init(void) {
     ESP_LOGI(TAG, "OTA管理器初始化");
@@ -106,6 +95,23 @@ esp_err_t ota_manager_check_version(
     
     memset(fw_info, 0, sizeof(firmware_info_t));
     
+    // 本次开机的引导请求（/device/info）已带回固件更新信息时直接使用，不再请求
+    provisioning_config_t *boot = malloc(sizeof(provisioning_config_t));
+    if (boot && provisioning_client_get_bootstrap(provision_server, current_version, boot) == ESP_OK) {
+        fw_info->available = boot->has_firmware_update;
+        if (boot->has_firmware_update) {
+            strncpy(fw_info->version, boot->firmware_version, sizeof(fw_info->version) - 1);
+            strncpy(fw_info->download_url, boot->firmware_url, sizeof(fw_info->download_url) - 1);
+            fw_info->file_size = boot->firmware_size;
+            strncpy(fw_info->checksum, boot->firmware_checksum, sizeof(fw_info->checksum) - 1);
+            strncpy(fw_info->changelog, boot->firmware_changelog, sizeof(fw_info->changelog) - 1);
+        }
+        free(boot);
+        ESP_LOGI(TAG, "✅ 使用启动引导结果: %s", fw_info->available ? fw_info->version : "已是最新版本");
+        return ESP_OK;
+    }
+    free(boot);
+    
     // 构建URL（使用GET请求）
     char url[512];
     snprintf(url, sizeof(url), "%s/device/info?mac=%s&firmware_version=%s",
@@ -113,97 +119,42 @@ esp_err_t ota_manager_check_version(
     
     ESP_LOGI(TAG, "🔍 检查固件版本: %s", url);
     
-    // 重置响应缓冲区
-    http_response_len = 0;
-    memset(http_response_buffer, 0, sizeof(http_response_buffer));
-    
-    // 配置HTTP客户端
-    esp_http_client_config_t config = {
-        .url = url,
-        .method = HTTP_METHOD_GET,
-        .event_handler = http_event_handler,
-        .timeout_ms = 10000,
-        .buffer_size = MAX_HTTP_RECV_BUFFER,
-    };
-    
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (!client) {
-        ESP_LOGE(TAG, "HTTP客户端初始化失败");
-        return ESP_FAIL;
-    }
-    
-    // 发送请求
-    esp_err_t err = esp_http_client_perform(client);
+    // 发送请求（共享会话，响应边接收边解析到fw_info）
+    http_session_json_result_t result;
+    esp_err_t err = http_session_request_json(HTTP_SESSION_GET, url, NULL, 10000, 0,
+                                              s_fw_fields, sizeof(s_fw_fields) / sizeof(s_fw_fields[0]),
+                                              fw_info, &result);
     
     if (err == ESP_OK) {
-        int status_code = esp_http_client_get_status_code(client);
+        int status_code = result.status;
         ESP_LOGI(TAG, "HTTP状态码: %d", status_code);
         
-        if (status_code == 200) {
-            // 解析JSON响应（参考xiaozhi的CheckVersion）
-            cJSON *root = cJSON_Parse(http_response_buffer);
-            if (root) {
-                cJSON *firmware_update = cJSON_GetObjectItem(root, "firmware_update");
-                if (firmware_update && !cJSON_IsNull(firmware_update)) {
-                    cJSON *available = cJSON_GetObjectItem(firmware_update, "available");
-                    cJSON *version = cJSON_GetObjectItem(firmware_update, "version");
-                    cJSON *url = cJSON_GetObjectItem(firmware_update, "download_url");
-                    cJSON *size = cJSON_GetObjectItem(firmware_update, "file_size");
-                    cJSON *checksum = cJSON_GetObjectItem(firmware_update, "checksum");
-                    cJSON *changelog = cJSON_GetObjectItem(firmware_update, "changelog");
-                    
-                    // 提取固件信息
-                    if (available && cJSON_IsTrue(available)) {
-                        fw_info->available = true;
-                        
-                        if (version && cJSON_IsString(version)) {
-                            strncpy(fw_info->version, version->valuestring, sizeof(fw_info->version) - 1);
-                        }
-                        if (url && cJSON_IsString(url)) {
-                            strncpy(fw_info->download_url, url->valuestring, sizeof(fw_info->download_url) - 1);
-                        }
-                        if (size && cJSON_IsNumber(size)) {
-                            fw_info->file_size = size->valueint;
-                        }
-                        if (checksum && cJSON_IsString(checksum)) {
-                            strncpy(fw_info->checksum, checksum->valuestring, sizeof(fw_info->checksum) - 1);
-                        }
-                        if (changelog && cJSON_IsString(changelog)) {
-                            strncpy(fw_info->changelog, changelog->valuestring, sizeof(fw_info->changelog) - 1);
-                        }
-                        
-                        ESP_LOGI(TAG, "⚠️ 发现固件更新:");
-                        ESP_LOGI(TAG, "   版本: %s", fw_info->version);
-                        ESP_LOGI(TAG, "   大小: %lu 字节", (unsigned long)fw_info->file_size);
-                        ESP_LOGI(TAG, "   URL: %s", fw_info->download_url);
-                        ESP_LOGI(TAG, "   更新日志: %s", fw_info->changelog);
-                        
-                        err = ESP_OK;
-                    } else {
-                        ESP_LOGI(TAG, "✅ 已是最新版本");
-                        fw_info->available = false;
-                        err = ESP_OK;
-                    }
-                } else {
-                    ESP_LOGI(TAG, "✅ 响应中无固件更新信息");
-                    fw_info->available = false;
-                    err = ESP_OK;
-                }
-                
-                cJSON_Delete(root);
+        if (status_code == 200 && result.parse_err == ESP_OK) {
+            if (fw_info->available) {
+                ESP_LOGI(TAG, "⚠️ 发现固件更新:");
+                ESP_LOGI(TAG, "   版本: %s", fw_info->version);
+                ESP_LOGI(TAG, "   大小: %lu 字节", (unsigned long)fw_info->file_size);
+                ESP_LOGI(TAG, "   URL: %s", fw_info->download_url);
+                ESP_LOGI(TAG, "   更新日志: %s", fw_info->changelog);
             } else {
-                ESP_LOGE(TAG, "❌ JSON解析失败");
-                err = ESP_FAIL;
+                // 固件信息只在available为true时有效
+                memset(fw_info, 0, sizeof(firmware_info_t));
+                ESP_LOGI(TAG, "✅ 已是最新版本");
             }
+            err = ESP_OK;
+        } else if (status_code == 200) {
+            ESP_LOGE(TAG, "❌ JSON解析失败");
+            memset(fw_info, 0, sizeof(firmware_info_t));
+            err = ESP_FAIL;
         } else {
             ESP_LOGE(TAG, "❌ HTTP请求失败: %d", status_code);
+            memset(fw_info, 0, sizeof(firmware_info_t));
             err = ESP_FAIL;
         }
     } else {
         ESP_LOGE(TAG, "❌ HTTP请求失败: %s", esp_err_to_name(err));
     }
     
-    esp_http_client_cleanup(client);
     return err;
 }
 
@@ -3,40 +3,50 @@
  * @brief 配置服务客户端实现（GET请求方式）
  * 
  * 调用新的配置服务GET接口获取设备配置
+ * 请求经共享HTTP会话（http_session）发送，与后续启动请求复用连接；响应体
+ * 边接收边按字段表解析（json_stream），不缓存整个响应，也不构建cJSON树。
+ * 成功的响应保存为本次开机的引导结果，供固件版本检查、UUID查询直接使用
  */
 
 #include "provisioning_client.h"
+#include "http_session.h"
 #include "esp_log.h"
-#include "esp_http_client.h"
 #include "esp_mac.h"
-#include "cJSON.h"
+#include "json_stream.h"
 #include <string.h>
 
 #define TAG "PROVISION_CLIENT"
-#define MAX_HTTP_RECV_BUFFER 8192
 
-static char http_response_buffer[MAX_HTTP_RECV_BUFFER];
-static int http_response_len = 0;
+// 本次开机的引导结果（/device/info一次返回设备信息、MQTT配置和固件更新信息）
+static provisioning_config_t s_bootstrap;
+static char s_bootstrap_server[128];
+static char s_bootstrap_fw_version[32];
+static bool s_bootstrap_valid = false;
 
-/**
- * @brief HTTP事件处理器
- */
-static esp_err_t http_event_handler(esp_http_client_event_t *evt) {
-    switch (evt->event_id) {
-        case HTTP_EVENT_ON_DATA:
-            if (http_response_len + evt->data_len < MAX_HTTP_RECV_BUFFER) {
-                memcpy(http_response_buffer + http_response_len, evt->data, evt->data_len);
-                http_response_len += evt->data_len;
-                http_response_buffer[http_response_len] = '\0';
-            } else {
-                ESP_LOGW(TAG, "响应缓冲区已满");
-            }
-            break;
-        default:
-            break;
-    }
-    return ESP_OK;
-}
+// /device/info 响应字段（流式解析，直接写入provisioning_config_t）
+static const json_field_t s_config_fields[] = {
+    JSON_FIELD(JSON_FIELD_STRING, "device_id", provisioning_config_t, device_id),
+    JSON_FIELD(JSON_FIELD_STRING, "device_uuid", provisioning_config_t, device_uuid),
+    JSON_FIELD(JSON_FIELD_STRING, "device_secret", provisioning_config_t, device_secret),
+    JSON_FIELD(JSON_FIELD_STRING, "mac_address", provisioning_config_t, mac_address),
+    JSON_FIELD(JSON_FIELD_STRING, "product_id", provisioning_config_t, product_id),
+    JSON_FIELD(JSON_FIELD_PRESENT, "mqtt_config", provisioning_config_t, has_mqtt_config),
+    JSON_FIELD(JSON_FIELD_STRING, "mqtt_config.broker", provisioning_config_t, mqtt_broker),
+    JSON_FIELD(JSON_FIELD_INT, "mqtt_config.port", provisioning_config_t, mqtt_port),
+    JSON_FIELD(JSON_FIELD_STRING, "mqtt_config.username", provisioning_config_t, mqtt_username),
+    JSON_FIELD(JSON_FIELD_STRING, "mqtt_config.password", provisioning_config_t, mqtt_password),
+    JSON_FIELD(JSON_FIELD_BOOL, "mqtt_config.use_ssl", provisioning_config_t, mqtt_use_ssl),
+    JSON_FIELD(JSON_FIELD_STRING, "mqtt_config.topics.data", provisioning_config_t, mqtt_topic_data),
+    JSON_FIELD(JSON_FIELD_STRING, "mqtt_config.topics.control", provisioning_config_t, mqtt_topic_control),
+    JSON_FIELD(JSON_FIELD_STRING, "mqtt_config.topics.status", provisioning_config_t, mqtt_topic_status),
+    JSON_FIELD(JSON_FIELD_STRING, "mqtt_config.topics.heartbeat", provisioning_config_t, mqtt_topic_heartbeat),
+    JSON_FIELD(JSON_FIELD_BOOL, "firmware_update.available", provisioning_config_t, has_firmware_update),
+    JSON_FIELD(JSON_FIELD_STRING, "firmware_update.version", provisioning_config_t, firmware_version),
+    JSON_FIELD(JSON_FIELD_STRING, "firmware_update.download_url", provisioning_config_t, firmware_url),
+    JSON_FIELD(JSON_FIELD_UINT32, "firmware_update.file_size", provisioning_config_t, firmware_size),
+    JSON_FIELD(JSON_FIELD_STRING, "firmware_update.checksum", provisioning_config_t, firmware_checksum),
+    JSON_FIELD(JSON_FIELD_STRING, "firmware_update.changelog", provisioning_config_t, firmware_changelog),
+};
 
 esp_err_t provisioning_client_get_config(
     const char *server_address,
@@ -76,158 +86,51 @@ esp_err_t provisioning_client_get_config(
     
     ESP_LOGI(TAG, "🌐 请求设备配置: %s", url);
     
-    // 重置响应缓冲区
-    http_response_len = 0;
-    memset(http_response_buffer, 0, sizeof(http_response_buffer));
-    
-    // 配置HTTP客户端（支持HTTP和HTTPS）
-    esp_http_client_config_t http_config = {
-        .url = url,
-        .method = HTTP_METHOD_GET,
-        .event_handler = http_event_handler,
-        .timeout_ms = 15000,
-        .buffer_size = MAX_HTTP_RECV_BUFFER,
-        .buffer_size_tx = 1024,
-        // HTTPS配置：跳过证书验证（开发测试用）
-        .transport_type = HTTP_TRANSPORT_UNKNOWN,  // 自动检测HTTP/HTTPS
-        .skip_cert_common_name_check = true,
-        .use_global_ca_store = false,
-        .crt_bundle_attach = NULL,  // 不使用证书包
-        .keep_alive_enable = true,
-    };
-    
-    esp_http_client_handle_t client = esp_http_client_init(&http_config);
-    if (!client) {
-        ESP_LOGE(TAG, "❌ HTTP客户端初始化失败");
-        return ESP_FAIL;
-    }
-    
-    // 发送请求
-    ret = esp_http_client_perform(client);
+    // 发送请求（共享会话，支持HTTP和HTTPS；响应边接收边解析到config）
+    // 配网服务器在开发环境使用的证书CN与地址不符，只有这里不校验CN
+    http_session_json_result_t result;
+    ret = http_session_request_json(HTTP_SESSION_GET, url, NULL, 15000, HTTP_SESSION_FLAG_SKIP_CN_CHECK,
+                                    s_config_fields, sizeof(s_config_fields) / sizeof(s_config_fields[0]),
+                                    config, &result);
     
     if (ret == ESP_OK) {
-        int status_code = esp_http_client_get_status_code(client);
-        ESP_LOGI(TAG, "HTTP状态码: %d", status_code);
+        int status_code = result.status;
+        ESP_LOGI(TAG, "HTTP状态码: %d (%u字节)", status_code, (unsigned)result.len);
         
-        if (status_code == 200) {
-            // 解析JSON响应
-            cJSON *root = cJSON_Parse(http_response_buffer);
-            if (root) {
-                // 提取设备信息
-                cJSON *device_id = cJSON_GetObjectItem(root, "device_id");
-                cJSON *device_uuid = cJSON_GetObjectItem(root, "device_uuid");
-                cJSON *mac_address = cJSON_GetObjectItem(root, "mac_address");
-                cJSON *product_id = cJSON_GetObjectItem(root, "product_id");
-                
-                if (device_id && cJSON_IsString(device_id)) {
-                    strncpy(config->device_id, device_id->valuestring, sizeof(config->device_id) - 1);
-                }
-                if (device_uuid && cJSON_IsString(device_uuid)) {
-                    strncpy(config->device_uuid, device_uuid->valuestring, sizeof(config->device_uuid) - 1);
-                }
-                if (mac_address && cJSON_IsString(mac_address)) {
-                    strncpy(config->mac_address, mac_address->valuestring, sizeof(config->mac_address) - 1);
-                }
-                if (product_id && cJSON_IsString(product_id)) {
-                    strncpy(config->product_id, product_id->valuestring, sizeof(config->product_id) - 1);
-                }
-                
-                // 提取MQTT配置
-                cJSON *mqtt_config = cJSON_GetObjectItem(root, "mqtt_config");
-                if (mqtt_config && cJSON_IsObject(mqtt_config)) {
-                    cJSON *broker = cJSON_GetObjectItem(mqtt_config, "broker");
-                    cJSON *port = cJSON_GetObjectItem(mqtt_config, "port");
-                    cJSON *username = cJSON_GetObjectItem(mqtt_config, "username");
-                    cJSON *password = cJSON_GetObjectItem(mqtt_config, "password");
-                    cJSON *use_ssl = cJSON_GetObjectItem(mqtt_config, "use_ssl");
-                    
-                    if (broker && cJSON_IsString(broker)) {
-                        strncpy(config->mqtt_broker, broker->valuestring, sizeof(config->mqtt_broker) - 1);
-                    }
-                    if (port && cJSON_IsNumber(port)) {
-                        config->mqtt_port = port->valueint;
-                    }
-                    if (username && cJSON_IsString(username)) {
-                        strncpy(config->mqtt_username, username->valuestring, sizeof(config->mqtt_username) - 1);
-                    }
-                    if (password && cJSON_IsString(password)) {
-                        strncpy(config->mqtt_password, password->valuestring, sizeof(config->mqtt_password) - 1);
-                    }
-                    if (use_ssl && cJSON_IsBool(use_ssl)) {
-                        config->mqtt_use_ssl = cJSON_IsTrue(use_ssl);
-                    }
-                    
-                    // 提取MQTT主题
-                    cJSON *topics = cJSON_GetObjectItem(mqtt_config, "topics");
-                    if (topics && cJSON_IsObject(topics)) {
-                        cJSON *data_topic = cJSON_GetObjectItem(topics, "data");
-                        cJSON *control_topic = cJSON_GetObjectItem(topics, "control");
-                        cJSON *status_topic = cJSON_GetObjectItem(topics, "status");
-                        cJSON *heartbeat_topic = cJSON_GetObjectItem(topics, "heartbeat");
-                        
-                        if (data_topic && cJSON_IsString(data_topic)) {
-                            strncpy(config->mqtt_topic_data, data_topic->valuestring, sizeof(config->mqtt_topic_data) - 1);
-                        }
-                        if (control_topic && cJSON_IsString(control_topic)) {
-                            strncpy(config->mqtt_topic_control, control_topic->valuestring, sizeof(config->mqtt_topic_control) - 1);
-                        }
-                        if (status_topic && cJSON_IsString(status_topic)) {
-                            strncpy(config->mqtt_topic_status, status_topic->valuestring, sizeof(config->mqtt_topic_status) - 1);
-                        }
-                        if (heartbeat_topic && cJSON_IsString(heartbeat_topic)) {
-                            strncpy(config->mqtt_topic_heartbeat, heartbeat_topic->valuestring, sizeof(config->mqtt_topic_heartbeat) - 1);
-                        }
-                    }
-                    
-                    config->has_mqtt_config = true;
-                }
-                
-                // 提取固件更新信息
-                cJSON *firmware_update = cJSON_GetObjectItem(root, "firmware_update");
-                if (firmware_update && !cJSON_IsNull(firmware_update)) {
-                    cJSON *available = cJSON_GetObjectItem(firmware_update, "available");
-                    cJSON *version = cJSON_GetObjectItem(firmware_update, "version");
-                    cJSON *url_obj = cJSON_GetObjectItem(firmware_update, "download_url");
-                    cJSON *size = cJSON_GetObjectItem(firmware_update, "file_size");
-                    cJSON *checksum = cJSON_GetObjectItem(firmware_update, "checksum");
-                    cJSON *changelog = cJSON_GetObjectItem(firmware_update, "changelog");
-                    
-                    if (available && cJSON_IsTrue(available)) {
-                        config->has_firmware_update = true;
-                        
-                        if (version && cJSON_IsString(version)) {
-                            strncpy(config->firmware_version, version->valuestring, sizeof(config->firmware_version) - 1);
-                        }
-                        if (url_obj && cJSON_IsString(url_obj)) {
-                            strncpy(config->firmware_url, url_obj->valuestring, sizeof(config->firmware_url) - 1);
-                        }
-                        if (size && cJSON_IsNumber(size)) {
-                            config->firmware_size = size->valueint;
-                        }
-                        if (checksum && cJSON_IsString(checksum)) {
-                            strncpy(config->firmware_checksum, checksum->valuestring, sizeof(config->firmware_checksum) - 1);
-                        }
-                        if (changelog && cJSON_IsString(changelog)) {
-                            strncpy(config->firmware_changelog, changelog->valuestring, sizeof(config->firmware_changelog) - 1);
-                        }
-                        
-                        ESP_LOGI(TAG, "⚠️ 发现固件更新: %s", config->firmware_version);
-                    }
-                }
-                
-                cJSON_Delete(root);
-                
-                ESP_LOGI(TAG, "✅ 配置获取成功:");
-                ESP_LOGI(TAG, "   Device ID: %s", config->device_id);
-                ESP_LOGI(TAG, "   Device UUID: %s", config->device_uuid);
-                ESP_LOGI(TAG, "   MQTT Broker: %s:%d", config->mqtt_broker, config->mqtt_port);
-                ESP_LOGI(TAG, "   固件更新: %s", config->has_firmware_update ? "有" : "无");
-                
-                ret = ESP_OK;
+        if (status_code == 200 && result.parse_err == ESP_OK) {
+            // 固件信息只在available为true时有效
+            if (!config->has_firmware_update) {
+                memset(config->firmware_version, 0, sizeof(config->firmware_version));
+                memset(config->firmware_url, 0, sizeof(config->firmware_url));
+                config->firmware_size = 0;
+                memset(config->firmware_checksum, 0, sizeof(config->firmware_checksum));
+                memset(config->firmware_changelog, 0, sizeof(config->firmware_changelog));
             } else {
-                ESP_LOGE(TAG, "❌ JSON解析失败");
-                ret = ESP_FAIL;
+                ESP_LOGI(TAG, "⚠️ 发现固件更新: %s", config->firmware_version);
+            }
+            if (result.truncated) {
+                ESP_LOGW(TAG, "⚠️ 响应中有超长字段已截断");
             }
+            
+            ESP_LOGI(TAG, "✅ 配置获取成功:");
+            ESP_LOGI(TAG, "   Device ID: %s", config->device_id);
+            ESP_LOGI(TAG, "   Device UUID: %s", config->device_uuid);
+            ESP_LOGI(TAG, "   MQTT Broker: %s:%d", config->mqtt_broker, config->mqtt_port);
+            ESP_LOGI(TAG, "   固件更新: %s", config->has_firmware_update ? "有" : "无");
+            
+            s_bootstrap = *config;
+            strncpy(s_bootstrap_server, server_address, sizeof(s_bootstrap_server) - 1);
+            s_bootstrap_server[sizeof(s_bootstrap_server) - 1] = '\0';
+            strncpy(s_bootstrap_fw_version, firmware_version ? firmware_version : "",
+                    sizeof(s_bootstrap_fw_version) - 1);
+            s_bootstrap_fw_version[sizeof(s_bootstrap_fw_version) - 1] = '\0';
+            s_bootstrap_valid = true;
+            
+            ret = ESP_OK;
+        } else if (status_code == 200) {
+            ESP_LOGE(TAG, "❌ JSON解析失败");
+            memset(config, 0, sizeof(provisioning_config_t));
+            ret = ESP_FAIL;
         } else if (status_code == 404) {
             ESP_LOGE(TAG, "❌ 设备未注册（404）");
             ret = ESP_ERR_NOT_FOUND;
@@ -239,6 +142,25 @@ esp_err_t provisioning_client_get_config(
         ESP_LOGE(TAG, "❌ HTTP请求失败: %s", esp_err_to_name(ret));
     }
     
-    esp_http_client_cleanup(client);
     return ret;
 }
+
+esp_err_t provisioning_client_get_bootstrap(
+    const char *server_address,
+    const char *firmware_version,
+    provisioning_config_t *config)
+{
+    if (!config) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_bootstrap_valid) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    // 不同服务器或不同的当前版本（固件更新判断依赖它）时结果不可用
+    if ((server_address && strcmp(server_address, s_bootstrap_server) != 0) ||
+        (firmware_version && strcmp(firmware_version, s_bootstrap_fw_version) != 0)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *config = s_bootstrap;
+    return ESP_OK;
+}
@@ -21,6 +21,7 @@ typedef struct {
     // 设备信息
     char device_id[128];           ///< 设备ID
     char device_uuid[128];         ///< 设备UUID
+    char device_secret[128];       ///< 设备密钥（服务器支持时返回，否则为空）
     char mac_address[18];          ///< MAC地址
     char product_id[64];           ///< 产品标识符
     
@@ -67,6 +68,26 @@ esp_err_t provisioning_client_get_config(
     provisioning_config_t *config
 );
 
+/**
+ * @brief 获取本次开机的引导结果（最近一次成功的 provisioning_client_get_config() 响应）
+ * 
+ * /device/info 一次返回设备信息、MQTT配置和固件更新信息，启动流程中后续的
+ * 固件版本检查、UUID查询优先使用该结果，不再单独请求服务器。
+ * 
+ * @param server_address 服务器地址（NULL不比较）
+ * @param firmware_version 当前固件版本（NULL不比较）
+ * @param config 输出参数，配置信息
+ * 
+ * @return 
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_NOT_FOUND: 本次开机未成功获取过，或服务器地址/固件版本不同
+ */
+esp_err_t provisioning_client_get_bootstrap(
+    const char *server_address,
+    const char *firmware_version,
+    provisioning_config_t *config
+);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,371 @@
+/**
+ * @file sensor_drivers.c
+ * @brief 内置传感器驱动描述符：DHT11、DS18B20、雨水传感器、MPU6050振动、MQ2气体、HC-SR04测距
+ *
+ * 底层驱动都只支持一个实例（引脚保存在驱动的全局变量中），板级表中每种最多一项。
+ * 上报字段和显示格式与原 main.c 中写死的格式一致。
+ *
+ * MPU6050由 imu_stream 组件在后台以1kHz连续采集，每次采集取上次以来振动最强的
+ * 窗口特征上报，不上报原始样本。
+ *
+ * 模拟量（MQ2、雨水传感器AO）由 adc_stream 组件以DMA连续采样并过采样平均，
+ * 采集时只取最近的平均值，不在采集任务中做单次转换。
+ *
+ * HC-SR04由 ultrasonic 组件用MCPWM硬件触发、捕获回波并连续测距，采集时取中值滤波后的距离，
+ * 声速按同板DHT22/DHT11最近一次的温度补偿。
+ */
+
+#include "sensor_hub.h"
+#include <stdio.h>
+#include <math.h>
+#include "dht11.h"
+#include "ds18b20.h"
+#include "rain_sensor.h"
+#include "imu_stream.h"
+#include "adc_stream.h"
+#include "ultrasonic.h"
+#include "esp_timer.h"
+
+/* ==================== DHT11 ==================== */
+
+static esp_err_t dht11_hub_init(const sensor_hub_board_entry_t *entry)
+{
+    dht11_config_t config = { .data_pin = entry->pin };
+    return dht11_init_adapter(&config);
+}
+
+static esp_err_t dht11_hub_collect(const sensor_hub_board_entry_t *entry, float *values)
+{
+    (void)entry;
+    dht11_data_t data = { 0 };
+    esp_err_t ret = dht11_read_adapter(&data);
+    if (ret == ESP_OK && !data.valid) {
+        ret = ESP_ERR_INVALID_RESPONSE;
+    }
+    values[0] = data.temperature;
+    values[1] = data.humidity;
+    return ret;
+}
+
+static const sensor_driver_t s_dht11_driver = {
+    .name = "DHT11",
+    .unit = "C / %",
+    .channel_count = 2,
+    .channels = {
+        { .key = "temperature", .type = HAL_SENSOR_TYPE_TEMPERATURE, .decimals = 1, .suffix = "C" },
+        { .key = "humidity", .type = HAL_SENSOR_TYPE_HUMIDITY, .decimals = 1, .suffix = "%" },
+    },
+    .min_period_ms = 2000,      // 驱动限制的最短读取间隔
+    .attempts = 3,
+    .retry_delay_ms = 100,
+    .trace_edges = true,
+    .init = dht11_hub_init,
+    .collect = dht11_hub_collect,
+};
+
+/* ==================== DS18B20 ==================== */
+
+static esp_err_t ds18b20_hub_init(const sensor_hub_board_entry_t *entry)
+{
+    ds18b20_config_t config = { .data_pin = entry->pin };
+    return ds18b20_init(&config);
+}
+
+static esp_err_t ds18b20_hub_start(const sensor_hub_board_entry_t *entry)
+{
+    (void)entry;
+    return ds18b20_start_conversion();
+}
+
+static esp_err_t ds18b20_hub_collect(const sensor_hub_board_entry_t *entry, float *values)
+{
+    (void)entry;
+    ds18b20_data_t data = { 0 };
+    esp_err_t ret = ds18b20_read_converted(&data);
+    if (ret == ESP_OK && !data.valid) {
+        ret = ESP_ERR_INVALID_RESPONSE;
+    }
+    values[0] = data.temperature;
+    return ret;
+}
+
+static const sensor_driver_t s_ds18b20_driver = {
+    .name = "DS18B20",
+    .unit = "C",
+    .channel_count = 1,
+    .channels = {
+        { .key = "temperature", .type = HAL_SENSOR_TYPE_TEMPERATURE, .decimals = 1, .suffix = "C" },
+    },
+    .conversion_ms = DS18B20_CONVERSION_MS,
+    .attempts = 3,
+    .retry_delay_ms = 100,
+    .trace_edges = true,
+    .init = ds18b20_hub_init,
+    .start = ds18b20_hub_start,
+    .collect = ds18b20_hub_collect,
+};
+
+/* ==================== 雨水传感器 ==================== */
+
+// pin2 接模拟输出AO时同时上报湿润程度
+static esp_err_t rain_hub_init(const sensor_hub_board_entry_t *entry)
+{
+    rain_sensor_config_t config = {
+        .data_pin = entry->pin,
+        .pull_up_enable = true,     // 启用内部上拉
+        .debounce_ms = 50,          // 50ms防抖
+        .analog_enable = entry->pin2 != GPIO_NUM_NC,
+        .analog_pin = entry->pin2,
+    };
+    return rain_sensor_init(&config);
+}
+
+static esp_err_t rain_hub_collect(const sensor_hub_board_entry_t *entry, float *values)
+{
+    (void)entry;
+    rain_sensor_data_t data = { 0 };
+    esp_err_t ret = rain_sensor_read(&data);
+    if (ret == ESP_OK && !data.valid) {
+        ret = ESP_ERR_INVALID_RESPONSE;
+    }
+    values[0] = data.is_raining ? 1.0f : 0.0f;
+    values[1] = data.wetness;
+    return ret;
+}
+
+static esp_err_t rain_hub_enable_notify(const sensor_hub_board_entry_t *entry, TaskHandle_t task)
+{
+    (void)entry;
+    return rain_sensor_enable_edge_notify(task);
+}
+
+// 配置了中值滤波时以滤波后的值为准：>=0.5 视为下雨，电平 0=有雨 1=无雨；湿润程度<0表示没有AO
+static int rain_hub_format_fields(const float *values, char *buf, size_t len)
+{
+    bool raining = values[0] >= 0.5f;
+    if (values[1] < 0.0f) {
+        return snprintf(buf, len, "\"is_raining\":%s,\"level\":%d", raining ? "true" : "false", raining ? 0 : 1);
+    }
+    return snprintf(buf, len, "\"is_raining\":%s,\"level\":%d,\"wetness\":%.0f",
+                    raining ? "true" : "false", raining ? 0 : 1, values[1]);
+}
+
+static int rain_hub_format_display(const float *values, char *buf, size_t len)
+{
+    const char *state = values[0] >= 0.5f ? "Raining" : "Dry";
+    if (values[1] < 0.0f) {
+        return snprintf(buf, len, "%s", state);
+    }
+    return snprintf(buf, len, "%s %.0f%%", state, values[1]);
+}
+
+static const sensor_driver_t s_rain_driver = {
+    .name = "RAIN",
+    .report_name = "RAIN_SENSOR",
+    .unit = "",
+    .channel_count = 2,
+    .channels = {
+        { .key = "is_raining", .type = HAL_SENSOR_TYPE_CUSTOM, .decimals = 0, .suffix = "" },
+        { .key = "wetness", .type = HAL_SENSOR_TYPE_HUMIDITY, .decimals = 0, .suffix = "%" },
+    },
+    .attempts = 1,
+    .init = rain_hub_init,
+    .collect = rain_hub_collect,
+    .enable_notify = rain_hub_enable_notify,
+    .format_fields = rain_hub_format_fields,
+    .format_display = rain_hub_format_display,
+};
+
+/* ==================== MPU6050 振动 ==================== */
+
+static imu_features_t s_imu_last;      // 最近一次采集的窗口，format_fields 用于输出频带
+
+static esp_err_t mpu6050_hub_init(const sensor_hub_board_entry_t *entry)
+{
+    imu_stream_config_t config = {
+        .sda = entry->pin,
+        .scl = entry->pin2,
+        .int_pin = SENSOR_HUB_PARAM_INT_PIN(entry->param),
+        .addr = SENSOR_HUB_PARAM_I2C_ADDR(entry->param),
+    };
+    return imu_stream_start(&config);
+}
+
+static esp_err_t mpu6050_hub_collect(const sensor_hub_board_entry_t *entry, float *values)
+{
+    (void)entry;
+    esp_err_t ret = imu_stream_take_summary(&s_imu_last, true);
+    if (ret != ESP_OK) {
+        return ret;                 // 上次采集以来还没有完成的窗口
+    }
+    values[0] = s_imu_last.vector_rms;
+    values[1] = s_imu_last.vector_peak;
+    values[2] = s_imu_last.crest;
+    values[3] = s_imu_last.dominant_hz;
+    return ESP_OK;
+}
+
+// 频带按三轴能量之和开方，单位g
+static int mpu6050_hub_format_fields(const float *values, char *buf, size_t len)
+{
+    int pos = snprintf(buf, len, "\"vib_rms\":%.3f,\"vib_peak\":%.3f,\"crest\":%.2f,\"dom_hz\":%.1f,"
+                       "\"band_hz\":%.2f,\"bands\":[",
+                       values[0], values[1], values[2], values[3], s_imu_last.band_hz);
+    for (int b = 0; b < CONFIG_IMU_STREAM_BANDS && pos > 0 && (size_t)pos < len; b++) {
+        float energy = 0.0f;
+        for (int a = 0; a < IMU_AXES; a++) {
+            energy += s_imu_last.axis[a].bands[b];
+        }
+        pos += snprintf(buf + pos, len - pos, "%s%.4f", b ? "," : "", sqrtf(energy));
+    }
+    if (pos > 0 && (size_t)pos < len) {
+        pos += snprintf(buf + pos, len - pos, "]");
+    }
+    return pos;
+}
+
+static const sensor_driver_t s_mpu6050_driver = {
+    .name = "MPU6050",
+    .unit = "g / g / - / Hz",
+    .channel_count = 4,
+    .channels = {
+        { .key = "vib_rms", .type = HAL_SENSOR_TYPE_MOTION, .decimals = 3, .suffix = "g" },
+        { .key = "vib_peak", .type = HAL_SENSOR_TYPE_MOTION, .decimals = 3, .suffix = "g" },
+        { .key = "crest", .type = HAL_SENSOR_TYPE_CUSTOM, .decimals = 2, .suffix = "" },
+        { .key = "dom_hz", .type = HAL_SENSOR_TYPE_CUSTOM, .decimals = 1, .suffix = "Hz" },
+    },
+    .attempts = 1,
+    .init = mpu6050_hub_init,
+    .collect = mpu6050_hub_collect,
+    .format_fields = mpu6050_hub_format_fields,
+};
+
+/* ==================== MQ2 气体 ==================== */
+
+#define MQ2_WARMUP_US           (20 * 1000000LL)    // 加热丝预热期间读数无意义
+
+// 模块加热5V，负载电阻RL=5kΩ，AO经2:3分压接ADC；R0按洁净空气中 Rs/R0=9.8 取10kΩ。
+// 数据手册LPG曲线 Rs/R0 = 1.6 × (ppm/200)^-0.455 换算到ADC引脚电压：
+static const adc_stream_curve_t s_mq2_curve = {
+    .count = 7,
+    .points = {
+        { .mv = 162.0f,  .value = 0.0f },       // 洁净空气
+        { .mv = 794.0f,  .value = 200.0f },
+        { .mv = 1072.0f, .value = 500.0f },
+        { .mv = 1313.0f, .value = 1000.0f },
+        { .mv = 1570.0f, .value = 2000.0f },
+        { .mv = 1915.0f, .value = 5000.0f },
+        { .mv = 2164.0f, .value = 10000.0f },
+    },
+};
+
+static int s_mq2_index = -1;
+static int64_t s_mq2_start_us;
+
+static esp_err_t mq2_hub_init(const sensor_hub_board_entry_t *entry)
+{
+    adc_stream_channel_config_t config = {
+        .gpio = entry->pin,
+        .atten_db = 12,
+        .curve = &s_mq2_curve,
+        .name = "MQ2",
+    };
+    esp_err_t ret = adc_stream_add_channel(&config, &s_mq2_index);
+    if (ret == ESP_OK) {
+        s_mq2_start_us = esp_timer_get_time();
+    }
+    return ret;
+}
+
+static esp_err_t mq2_hub_collect(const sensor_hub_board_entry_t *entry, float *values)
+{
+    (void)entry;
+    if (esp_timer_get_time() - s_mq2_start_us < MQ2_WARMUP_US) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    adc_stream_value_t value;
+    esp_err_t ret = adc_stream_read(s_mq2_index, &value);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    values[0] = value.value;
+    values[1] = value.mv;
+    return ESP_OK;
+}
+
+static const sensor_driver_t s_mq2_driver = {
+    .name = "MQ2",
+    .unit = "ppm / mV",
+    .channel_count = 2,
+    .channels = {
+        { .key = "gas_ppm", .type = HAL_SENSOR_TYPE_GAS, .decimals = 0, .suffix = "ppm" },
+        { .key = "gas_mv", .type = HAL_SENSOR_TYPE_CUSTOM, .decimals = 0, .suffix = "mV" },
+    },
+    .attempts = 1,
+    .init = mq2_hub_init,
+    .collect = mq2_hub_collect,
+};
+
+/* ==================== HC-SR04 超声波 ==================== */
+
+static esp_err_t hcsr04_hub_init(const sensor_hub_board_entry_t *entry)
+{
+    ultrasonic_config_t config = {
+        .trig = entry->pin,
+        .echo = entry->pin2,
+    };
+    return ultrasonic_start(&config);
+}
+
+static esp_err_t hcsr04_hub_collect(const sensor_hub_board_entry_t *entry, float *values)
+{
+    (void)entry;
+    // 声速随气温约0.6m/s/°C，用同板温湿度传感器的最近读数补偿（没有时保持上次或默认20°C）
+    static const sample_sensor_id_t temp_sources[] = { SAMPLE_SENSOR_DHT22, SAMPLE_SENSOR_DHT11 };
+    for (size_t i = 0; i < sizeof(temp_sources) / sizeof(temp_sources[0]); i++) {
+        float temp_c;
+        if (sensor_hub_get_latest(temp_sources[i], 0, &temp_c) == ESP_OK) {
+            ultrasonic_set_temperature(temp_c);
+            break;
+        }
+    }
+
+    ultrasonic_reading_t reading;
+    esp_err_t ret = ultrasonic_read(&reading);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    values[0] = reading.distance_cm;
+    return ESP_OK;
+}
+
+static const sensor_driver_t s_hcsr04_driver = {
+    .name = "HCSR04",
+    .unit = "cm",
+    .channel_count = 1,
+    .channels = {
+        { .key = "distance", .type = HAL_SENSOR_TYPE_DISTANCE, .decimals = 1, .suffix = "cm" },
+    },
+    .attempts = 1,
+    .init = hcsr04_hub_init,
+    .collect = hcsr04_hub_collect,
+};
+
+esp_err_t sensor_hub_register_builtin_drivers(void)
+{
+    static const sensor_driver_t *const builtin[] = {
+        &s_dht11_driver,
+        &s_ds18b20_driver,
+        &s_rain_driver,
+        &s_mpu6050_driver,
+        &s_mq2_driver,
+        &s_hcsr04_driver,
+    };
+    for (size_t i = 0; i < sizeof(builtin) / sizeof(builtin[0]); i++) {
+        esp_err_t ret = sensor_hub_register_driver(builtin[i]);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,412 @@
+/**
+ * @file sensor_hub.c
+ * @brief 传感器框架实现：驱动注册表、板级传感器表、启动-采集两阶段批量读取
+ */
+
+#include "sensor_hub.h"
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "json_writer.h"
+#include "freertos/semphr.h"
+#include "hil_trace.h"
+
+static const char *TAG = "sensor_hub";
+
+#define LOCK()      xSemaphoreTake(s_mutex, portMAX_DELAY)
+#define UNLOCK()    xSemaphoreGive(s_mutex)
+
+typedef struct {
+    const sensor_driver_t *driver;
+    const sensor_hub_board_entry_t *entry;
+    bool ready;
+    bool notify;                                ///< 已启用数据变化通知
+    bool has_value;
+    int64_t last_read_us;                       ///< 上次采集时间（0表示从未采集）
+    float last[SENSOR_HUB_MAX_CHANNELS];        ///< 最近一次成功读数
+} hub_sensor_t;
+
+/**
+ * @brief 一轮采集中已启动转换、等待采集的传感器
+ */
+typedef struct {
+    uint8_t index;
+    esp_err_t start_err;
+    int64_t ready_us;                           ///< 转换完成时间
+    uint32_t bus_us;                            ///< start占用总线的时间
+} pending_t;
+
+static const sensor_driver_t *s_drivers[CONFIG_SENSOR_HUB_MAX_DRIVERS];
+static size_t s_driver_count = 0;
+static hub_sensor_t s_sensors[CONFIG_SENSOR_HUB_MAX_SENSORS];
+static size_t s_sensor_count = 0;
+static SemaphoreHandle_t s_mutex = NULL;        ///< 保护最新读数（bsp_sensor_read可能在其他任务调用）
+
+static const sensor_driver_t *find_driver(const char *name)
+{
+    for (size_t i = 0; i < s_driver_count; i++) {
+        if (strcmp(s_drivers[i]->name, name) == 0) {
+            return s_drivers[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t sensor_hub_register_driver(const sensor_driver_t *driver)
+{
+    if (!driver || !driver->name || !driver->collect || driver->channel_count == 0 ||
+        driver->channel_count > SENSOR_HUB_MAX_CHANNELS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < s_driver_count; i++) {
+        if (strcmp(s_drivers[i]->name, driver->name) == 0) {
+            s_drivers[i] = driver;
+            return ESP_OK;
+        }
+    }
+    if (s_driver_count >= CONFIG_SENSOR_HUB_MAX_DRIVERS) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_drivers[s_driver_count++] = driver;
+    return ESP_OK;
+}
+
+esp_err_t sensor_hub_add_board(const sensor_hub_board_entry_t *entries, size_t count)
+{
+    if (!entries && count > 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    size_t added = 0;
+    size_t ready = 0;
+    for (size_t i = 0; i < count; i++) {
+        const sensor_hub_board_entry_t *entry = &entries[i];
+        const sensor_driver_t *driver = find_driver(entry->driver);
+        if (!driver) {
+            ESP_LOGW(TAG, "⚠️ 传感器驱动 %s 未注册，跳过（GPIO%d）", entry->driver, entry->pin);
+            continue;
+        }
+        if (s_sensor_count >= CONFIG_SENSOR_HUB_MAX_SENSORS) {
+            ESP_LOGW(TAG, "⚠️ 传感器数已达上限 %d，%s 未添加", CONFIG_SENSOR_HUB_MAX_SENSORS, entry->driver);
+            return ESP_ERR_NO_MEM;
+        }
+
+        hub_sensor_t *s = &s_sensors[s_sensor_count++];
+        *s = (hub_sensor_t){ .driver = driver, .entry = entry };
+        esp_err_t ret = driver->init ? driver->init(entry) : ESP_OK;
+        s->ready = (ret == ESP_OK);
+        added++;
+        if (s->ready) {
+            ready++;
+            ESP_LOGI(TAG, "✅ %s传感器初始化成功 - GPIO%d已就绪", driver->name, entry->pin);
+        } else {
+            ESP_LOGW(TAG, "⚠️ %s传感器初始化失败: %s - 将继续运行，%s数据不可用",
+                     driver->name, esp_err_to_name(ret), driver->name);
+        }
+    }
+
+    if (added == 0) {
+        ESP_LOGW(TAG, "⚠️ 板级传感器表中没有可用的驱动");
+        return ESP_ERR_NOT_FOUND;
+    }
+    ESP_LOGI(TAG, "📊 传感器初始化完成 - %u/%u 就绪", (unsigned)ready, (unsigned)added);
+    return ESP_OK;
+}
+
+void sensor_hub_reset(void)
+{
+    for (size_t i = 0; i < s_sensor_count; i++) {
+        hub_sensor_t *s = &s_sensors[i];
+        if (s->notify && s->driver->enable_notify) {
+            s->driver->enable_notify(s->entry, NULL);
+        }
+    }
+    s_sensor_count = 0;
+}
+
+size_t sensor_hub_count(void)
+{
+    return s_sensor_count;
+}
+
+esp_err_t sensor_hub_get(size_t index, sensor_hub_sensor_t *info)
+{
+    if (index >= s_sensor_count || !info) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const hub_sensor_t *s = &s_sensors[index];
+    info->driver = s->driver;
+    info->entry = s->entry;
+    info->label = s->entry->label ? s->entry->label : s->driver->name;
+    info->ready = s->ready;
+    return ESP_OK;
+}
+
+int sensor_hub_find(sample_sensor_id_t id)
+{
+    for (size_t i = 0; i < s_sensor_count; i++) {
+        if (s_sensors[i].entry->id == id) {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+/* ==================== 批量采集 ==================== */
+
+static void wait_until(int64_t t_us)
+{
+    int64_t now = esp_timer_get_time();
+    if (t_us > now) {
+        uint32_t ms = (uint32_t)((t_us - now + 999) / 1000);
+        vTaskDelay((ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS);
+    }
+}
+
+/**
+ * @brief 调用 start/collect 回调，记录总线占用时间和（按需）数据线波形
+ */
+static esp_err_t run_phase(const hub_sensor_t *s, bool start, float *values, uint32_t *bus_us)
+{
+    const sensor_driver_t *drv = s->driver;
+    if (start && !drv->start) {
+        return ESP_OK;
+    }
+    if (drv->trace_edges) {
+        hil_trace_edges_begin(s->entry->pin);
+    }
+    int64_t t0 = esp_timer_get_time();
+    esp_err_t ret = start ? drv->start(s->entry) : drv->collect(s->entry, values);
+    *bus_us += (uint32_t)(esp_timer_get_time() - t0);
+    if (drv->trace_edges) {
+        hil_trace_edges_end(s->entry->pin);
+    }
+    return ret;
+}
+
+static void begin(uint8_t index, pending_t *p)
+{
+    const hub_sensor_t *s = &s_sensors[index];
+    p->index = index;
+    p->bus_us = 0;
+    p->start_err = run_phase(s, true, NULL, &p->bus_us);
+    p->ready_us = esp_timer_get_time() + (int64_t)s->driver->conversion_ms * 1000;
+}
+
+/**
+ * @brief 等待转换完成并采集，失败时按描述符重试
+ */
+static void finish(pending_t *p, sensor_hub_reading_t *r)
+{
+    hub_sensor_t *s = &s_sensors[p->index];
+    const sensor_driver_t *drv = s->driver;
+    uint8_t max_attempts = drv->attempts ? drv->attempts : 1;
+
+    memset(r, 0, sizeof(*r));
+    r->index = p->index;
+    r->id = s->entry->id;
+    r->count = drv->channel_count;
+
+    for (;;) {
+        esp_err_t err = p->start_err;
+        if (err == ESP_OK) {
+            wait_until(p->ready_us);
+            err = run_phase(s, false, r->values, &p->bus_us);
+        }
+        r->attempts++;
+        r->err = err;
+        r->read_us = p->bus_us;
+        hil_trace_sensor(r->id, err, r->values, r->count);
+        if (err == ESP_OK || r->attempts >= max_attempts) {
+            break;
+        }
+        ESP_LOGW(TAG, "%s读取失败，重试 %u/%u...", drv->name, r->attempts, max_attempts - 1);
+        vTaskDelay(pdMS_TO_TICKS(drv->retry_delay_ms));
+        begin(p->index, p);
+    }
+
+    s->last_read_us = esp_timer_get_time();
+    if (r->err == ESP_OK) {
+        LOCK();
+        memcpy(s->last, r->values, sizeof(s->last));
+        s->has_value = true;
+        UNLOCK();
+    } else if (max_attempts > 1) {
+        ESP_LOGW(TAG, "%s读取失败（已重试%u次）", drv->name, max_attempts);
+    }
+}
+
+static size_t read_sensors(sensor_hub_reading_t *readings, size_t max, bool notified_only)
+{
+    pending_t pending[CONFIG_SENSOR_HUB_MAX_SENSORS];
+    size_t n = 0;
+    int64_t now = esp_timer_get_time();
+
+    // 先启动所有到期传感器的转换
+    for (size_t i = 0; i < s_sensor_count && n < max; i++) {
+        const hub_sensor_t *s = &s_sensors[i];
+        if (!s->ready || (notified_only && !s->notify)) {
+            continue;
+        }
+        if (!notified_only && s->last_read_us != 0 &&
+            now - s->last_read_us < (int64_t)s->driver->min_period_ms * 1000) {
+            continue;
+        }
+        begin((uint8_t)i, &pending[n++]);
+    }
+
+    // 按转换完成时间排序（插入排序，相同时间保持注册表顺序）
+    for (size_t i = 1; i < n; i++) {
+        pending_t key = pending[i];
+        size_t j = i;
+        while (j > 0 && pending[j - 1].ready_us > key.ready_us) {
+            pending[j] = pending[j - 1];
+            j--;
+        }
+        pending[j] = key;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        finish(&pending[i], &readings[i]);
+    }
+    return n;
+}
+
+size_t sensor_hub_read_all(sensor_hub_reading_t *readings, size_t max)
+{
+    if (!readings) {
+        return 0;
+    }
+    return read_sensors(readings, max, false);
+}
+
+size_t sensor_hub_read_notified(sensor_hub_reading_t *readings, size_t max)
+{
+    if (!readings) {
+        return 0;
+    }
+    return read_sensors(readings, max, true);
+}
+
+size_t sensor_hub_enable_notify(TaskHandle_t task)
+{
+    size_t enabled = 0;
+    for (size_t i = 0; i < s_sensor_count; i++) {
+        hub_sensor_t *s = &s_sensors[i];
+        if (!s->ready || !s->driver->enable_notify) {
+            continue;
+        }
+        esp_err_t ret = s->driver->enable_notify(s->entry, task);
+        s->notify = (ret == ESP_OK && task != NULL);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "⚠️ %s中断启用失败: %s，仅按周期采样", s->driver->name, esp_err_to_name(ret));
+        } else if (s->notify) {
+            enabled++;
+        }
+    }
+    return enabled;
+}
+
+esp_err_t sensor_hub_get_value(uint8_t channel, float *value)
+{
+    if (!value) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < s_sensor_count; i++) {
+        hub_sensor_t *s = &s_sensors[i];
+        if (channel >= s->driver->channel_count) {
+            channel -= s->driver->channel_count;
+            continue;
+        }
+        if (!s_mutex) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        LOCK();
+        bool has_value = s->has_value;
+        *value = s->last[channel];
+        UNLOCK();
+        return has_value ? ESP_OK : ESP_ERR_INVALID_STATE;
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t sensor_hub_get_latest(sample_sensor_id_t id, uint8_t channel, float *value)
+{
+    if (!value) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int index = sensor_hub_find(id);
+    if (index < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    hub_sensor_t *s = &s_sensors[index];
+    if (channel >= s->driver->channel_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_mutex) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    LOCK();
+    bool has_value = s->has_value;
+    *value = s->last[channel];
+    UNLOCK();
+    return has_value ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+/* ==================== 格式化 ==================== */
+
+size_t sensor_hub_format_json(size_t index, const char *device_id, const float *values,
+                              unsigned long timestamp, char *buf, size_t len)
+{
+    if (index >= s_sensor_count || !buf || !values) {
+        return 0;
+    }
+    const sensor_driver_t *drv = s_sensors[index].driver;
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    if (!json_writer_printf(&w, "{\"device_id\":\"%s\",\"sensor\":\"%s\",",
+                            device_id, drv->report_name ? drv->report_name : drv->name)) {
+        return 0;
+    }
+    if (drv->format_fields) {
+        json_writer_commit(&w, drv->format_fields(values, buf + w.len, len - w.len));
+    } else {
+        for (uint8_t ch = 0; ch < drv->channel_count; ch++) {
+            const sensor_channel_desc_t *c = &drv->channels[ch];
+            json_writer_printf(&w, "%s\"%s\":%.*f", ch ? "," : "", c->key, c->decimals, values[ch]);
+        }
+    }
+    json_writer_printf(&w, ",\"timestamp\":%lu}", timestamp);
+
+    size_t out_len = 0;
+    return json_writer_finish(&w, &out_len) == ESP_OK ? out_len : 0;
+}
+
+size_t sensor_hub_format_display(size_t index, const float *values, char *buf, size_t len)
+{
+    if (index >= s_sensor_count || !buf || !values || len == 0) {
+        return 0;
+    }
+    const sensor_driver_t *drv = s_sensors[index].driver;
+    if (drv->format_display) {
+        int n = drv->format_display(values, buf, len);
+        return (n < 0 || (size_t)n >= len) ? 0 : (size_t)n;
+    }
+    json_writer_t w;
+    json_writer_init(&w, buf, len);
+    for (uint8_t ch = 0; ch < drv->channel_count; ch++) {
+        const sensor_channel_desc_t *c = &drv->channels[ch];
+        json_writer_printf(&w, "%s%.*f%s", ch ? " / " : "", c->decimals, values[ch],
+                           c->suffix ? c->suffix : "");
+    }
+
+    size_t out_len = 0;
+    return json_writer_finish(&w, &out_len) == ESP_OK ? out_len : 0;
+}
@@ -0,0 +1,247 @@
+/**
+ * @file sensor_hub.h
+ * @brief 传感器框架：驱动描述符注册、板级传感器表、批量采集
+ *
+ * 原来每种传感器的初始化、重试、显示、上报JSON都写死在 main.c 里，按板子用 #if 区分，
+ * bsp_sensor_read() 只是占位。本模块把传感器拆成两层：
+ *
+ * - 驱动（sensor_driver_t）：名字、通道（类型/JSON字段/显示单位）、转换时间、最短采样间隔、
+ *   重试次数，以及 init/start/collect 回调。需要转换时间的传感器（DS18B20）实现 start，
+ *   启动转换后立即返回，collect 再读结果；
+ * - 板级传感器表（board_config.h 的 BOARD_SENSOR_TABLE）：驱动名 + 上报ID + 引脚。
+ *   新增传感器只需在表里加一行，驱动不存在时启动日志告警并跳过。
+ *
+ * sensor_hub_read_all() 先启动所有到期传感器的转换，再按就绪时间依次采集，
+ * 几个传感器的转换时间重叠，一轮采集的耗时约等于最长的一个而不是总和。
+ * 上报JSON、显示字符串、bsp_sensor_read() 都按注册表生成，main.c 不再区分传感器种类。
+ */
+
+#ifndef SENSOR_HUB_H
+#define SENSOR_HUB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "hal_common.h"
+#include "sample_store.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_SENSOR_HUB_MAX_SENSORS
+#define CONFIG_SENSOR_HUB_MAX_SENSORS   8
+#endif
+
+#ifndef CONFIG_SENSOR_HUB_MAX_DRIVERS
+#define CONFIG_SENSOR_HUB_MAX_DRIVERS   12
+#endif
+
+#define SENSOR_HUB_MAX_CHANNELS     4       ///< 单个传感器最多通道数（与 HIL_TRACE_MAX_SENSOR_VALUES 一致）
+#define SENSOR_HUB_JSON_MAX         256     ///< 单条上报JSON最大长度
+
+/**
+ * @brief I2C传感器表项的 param：低8位为7位地址，8~15位为中断引脚号+1（0表示不接中断）
+ *
+ * 只写地址（如 .param = 0x23）等价于 SENSOR_HUB_I2C_PARAM(0x23, GPIO_NUM_NC)。
+ */
+#define SENSOR_HUB_I2C_PARAM(addr, int_pin)     ((uint32_t)(addr) | ((uint32_t)((int)(int_pin) + 1) << 8))
+#define SENSOR_HUB_PARAM_I2C_ADDR(param)        ((uint16_t)((param) & 0x7F))
+#define SENSOR_HUB_PARAM_INT_PIN(param)         ((gpio_num_t)((int)(((param) >> 8) & 0xFF) - 1))
+
+/**
+ * @brief 通道描述
+ */
+typedef struct {
+    const char *key;                ///< 上报JSON字段名，如 "temperature"
+    hal_sensor_type_t type;         ///< 通道类型
+    uint8_t decimals;               ///< 上报和显示的小数位
+    const char *suffix;             ///< 显示后缀，如 "C"、"%"
+} sensor_channel_desc_t;
+
+/**
+ * @brief 板级传感器表的一项
+ */
+typedef struct {
+    const char *driver;             ///< 驱动名（sensor_driver_t.name）
+    sample_sensor_id_t id;          ///< 上报、历史存储、告警使用的传感器ID
+    gpio_num_t pin;                 ///< 主引脚（单总线数据线 / I2C SDA / 模拟输入 / TRIG）
+    gpio_num_t pin2;                ///< 辅助引脚（I2C SCL / ECHO / 中断），不用时 GPIO_NUM_NC
+    uint32_t param;                 ///< 驱动自定义参数（如I2C地址），不用时0
+    const char *label;              ///< 显示名称，NULL时使用驱动名
+} sensor_hub_board_entry_t;
+
+/**
+ * @brief 传感器驱动描述符
+ *
+ * 回调的 entry 参数是板级表中对应的一项，同一驱动可以挂多个实例（引脚不同）。
+ */
+typedef struct {
+    const char *name;               ///< 驱动名，板级表按名字引用
+    const char *report_name;        ///< 上报JSON的 "sensor" 字段，NULL时使用 name
+    const char *unit;               ///< 显示单位说明，如 "C / %"
+    uint8_t channel_count;          ///< 通道数（<= SENSOR_HUB_MAX_CHANNELS）
+    sensor_channel_desc_t channels[SENSOR_HUB_MAX_CHANNELS];
+    uint32_t conversion_ms;         ///< start 之后到可以 collect 的最短时间
+    uint32_t min_period_ms;         ///< 两次采集的最短间隔（未到期的传感器本轮跳过）
+    uint8_t attempts;               ///< 每轮最多尝试次数（0按1次）
+    uint16_t retry_delay_ms;        ///< 两次尝试之间的等待
+    bool trace_edges;               ///< 采集时用 hil_trace 记录数据线电平跳变
+
+    esp_err_t (*init)(const sensor_hub_board_entry_t *entry);
+    esp_err_t (*start)(const sensor_hub_board_entry_t *entry);                      ///< 可选：启动转换
+    esp_err_t (*collect)(const sensor_hub_board_entry_t *entry, float *values);     ///< 读取结果
+    esp_err_t (*enable_notify)(const sensor_hub_board_entry_t *entry, TaskHandle_t task); ///< 可选：数据变化时通知任务
+    /** 可选：生成上报JSON中 "sensor" 与 "timestamp" 之间的字段，返回写入长度，默认按通道 "key":value */
+    int (*format_fields)(const float *values, char *buf, size_t len);
+    /** 可选：生成显示字符串，默认按通道 "值+后缀" 以 " / " 连接 */
+    int (*format_display)(const float *values, char *buf, size_t len);
+} sensor_driver_t;
+
+/**
+ * @brief 一次采集结果
+ */
+typedef struct {
+    uint8_t index;                  ///< 注册表下标（显示、sensor_hub_get() 使用）
+    sample_sensor_id_t id;          ///< 传感器ID
+    esp_err_t err;                  ///< 最后一次尝试的结果
+    uint8_t attempts;               ///< 本轮尝试次数
+    uint8_t count;                  ///< 通道数
+    float values[SENSOR_HUB_MAX_CHANNELS];
+    uint32_t read_us;               ///< 最后一次尝试的总线占用时间（start + collect，不含转换等待）
+} sensor_hub_reading_t;
+
+/**
+ * @brief 已注册传感器的信息
+ */
+typedef struct {
+    const sensor_driver_t *driver;
+    const sensor_hub_board_entry_t *entry;
+    const char *label;              ///< 显示名称
+    bool ready;                     ///< 初始化成功
+} sensor_hub_sensor_t;
+
+/**
+ * @brief 注册驱动（重复注册同名驱动时替换）
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 描述符缺少名字/collect或通道数超限
+ *   - ESP_ERR_NO_MEM: 驱动数已达 CONFIG_SENSOR_HUB_MAX_DRIVERS
+ */
+esp_err_t sensor_hub_register_driver(const sensor_driver_t *driver);
+
+/**
+ * @brief 注册内置驱动（DHT11、DS18B20、雨水传感器、MPU6050、MQ2、HC-SR04），见 sensor_drivers.c
+ */
+esp_err_t sensor_hub_register_builtin_drivers(void);
+
+/**
+ * @brief 按板级传感器表添加并初始化传感器
+ *
+ * 表项引用的驱动未注册时告警并跳过；初始化失败的传感器保留在注册表中（显示为未就绪），
+ * 不参与采集。表项指针需在程序运行期间有效（一般是BSP中的静态表）。
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 至少添加了一个传感器（包括初始化失败的）
+ *   - ESP_ERR_NOT_FOUND: 表中没有可用的驱动
+ *   - ESP_ERR_NO_MEM: 传感器数已达 CONFIG_SENSOR_HUB_MAX_SENSORS（已添加的保留）
+ */
+esp_err_t sensor_hub_add_board(const sensor_hub_board_entry_t *entries, size_t count);
+
+/**
+ * @brief 清空注册表（驱动保留），用于重新初始化和主机测试
+ */
+void sensor_hub_reset(void);
+
+/**
+ * @brief 注册表中的传感器数
+ */
+size_t sensor_hub_count(void);
+
+/**
+ * @brief 获取注册表中第 index 个传感器
+ *
+ * @return ESP_OK，或 ESP_ERR_INVALID_ARG（下标越界）
+ */
+esp_err_t sensor_hub_get(size_t index, sensor_hub_sensor_t *info);
+
+/**
+ * @brief 按传感器ID查找注册表下标
+ *
+ * @return 下标，未找到返回-1
+ */
+int sensor_hub_find(sample_sensor_id_t id);
+
+/**
+ * @brief 批量采集：启动所有到期传感器的转换，再按就绪时间依次采集
+ *
+ * 每次尝试都调用 hil_trace_sensor()；trace_edges 的驱动在 start/collect 期间记录引脚跳变。
+ * 失败的传感器按描述符的 attempts/retry_delay_ms 重试，成功的读数成为 sensor_hub_get_value() 的最新值。
+ *
+ * @param readings 输出，每个参与采集的传感器一项（包括失败的）
+ * @param max readings 容量
+ * @return 写入的项数
+ */
+size_t sensor_hub_read_all(sensor_hub_reading_t *readings, size_t max);
+
+/**
+ * @brief 只采集支持通知的传感器（收到任务通知后调用，不受 min_period_ms 限制）
+ *
+ * @return 写入的项数
+ */
+size_t sensor_hub_read_notified(sensor_hub_reading_t *readings, size_t max);
+
+/**
+ * @brief 让支持通知的传感器在数据变化时通知任务
+ *
+ * @return 启用通知的传感器数
+ */
+size_t sensor_hub_enable_notify(TaskHandle_t task);
+
+/**
+ * @brief 按展开后的通道序号读取最新值（注册表顺序，每个传感器占 channel_count 个序号）
+ *
+ * bsp_sensor_read() 的实现：不触发采集，返回最近一次 sensor_hub_read_all() 的结果。
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_ARG: 序号越界
+ *   - ESP_ERR_INVALID_STATE: 该传感器还没有成功读数
+ */
+esp_err_t sensor_hub_get_value(uint8_t channel, float *value);
+
+/**
+ * @brief 按传感器ID和通道读取最新值（驱动之间引用读数用，如超声波按气温补偿声速）
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_NOT_FOUND: 没有该ID的传感器
+ *   - ESP_ERR_INVALID_ARG: 通道越界
+ *   - ESP_ERR_INVALID_STATE: 该传感器还没有成功读数
+ */
+esp_err_t sensor_hub_get_latest(sample_sensor_id_t id, uint8_t channel, float *value);
+
+/**
+ * @brief 生成上报JSON：{"device_id":..,"sensor":..,<通道字段>,"timestamp":..}
+ *
+ * @return 写入长度，缓冲区不足或下标无效返回0
+ */
+size_t sensor_hub_format_json(size_t index, const char *device_id, const float *values,
+                              unsigned long timestamp, char *buf, size_t len);
+
+/**
+ * @brief 生成显示字符串（如 "23.4C / 56.0%"）
+ *
+ * @return 写入长度，下标无效返回0
+ */
+size_t sensor_hub_format_display(size_t index, const float *values, char *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SENSOR_HUB_H
@@ -0,0 +1,336 @@
+/**
+ * @file http_session.c
+ * @brief 共享HTTP(S)会话实现
+ *
+ * 一个客户端句柄 + 一块静态响应缓冲区，由同一把锁保护：
+ * 缓冲区方式请求开始时加锁，调用方用完响应后 http_session_release() 解锁；
+ * 流式方式在请求结束时解锁，响应体在事件回调中直接送入解析器。
+ */
+
+#include "http_session.h"
+#include "esp_log.h"
+#include "esp_http_client.h"
+#include "metrics.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "HTTP_SESSION";
+
+#define ORIGIN_MAX_LEN  96
+
+static char s_arena[HTTP_SESSION_ARENA_SIZE];
+static size_t s_arena_len = 0;
+static bool s_arena_truncated = false;
+
+static esp_http_client_handle_t s_client = NULL;
+static char s_origin[ORIGIN_MAX_LEN];      ///< 当前句柄对应的源（协议://主机:端口）
+static uint32_t s_flags = 0;               ///< 当前句柄创建时的请求选项
+static bool s_connected = false;           ///< 连接是否保持（服务器返回Connection: close时为false）
+static bool s_connect_event = false;       ///< 本次请求是否新建了连接
+static http_session_stats_t s_stats;
+
+/**
+ * @brief 流式请求的解析器（请求期间从堆分配）
+ */
+typedef struct {
+    json_stream_t js;
+    json_stream_bind_t bind;
+    const json_field_t *fields;
+    size_t count;
+    void *out;
+    size_t len;
+} stream_ctx_t;
+
+static stream_ctx_t *s_stream = NULL;      ///< 非NULL时响应体送入解析器而不是缓冲区
+static SemaphoreHandle_t s_mutex = NULL;
+
+METRIC_COUNTER_DEFINE(s_m_http_connects, "http_connects");
+METRIC_COUNTER_DEFINE(s_m_http_reused, "http_reused");
+
+static esp_err_t http_event_handler(esp_http_client_event_t *evt)
+{
+    switch (evt->event_id) {
+        case HTTP_EVENT_ON_CONNECTED:
+            s_connect_event = true;
+            s_connected = true;
+            break;
+        case HTTP_EVENT_ON_DATA: {
+            // perform内部已解码chunked，这里拿到的都是响应体数据
+            if (s_stream) {
+                // 解析出错后继续接收（丢弃），结果在请求结束时由json_stream_finish()给出
+                json_stream_feed(&s_stream->js, evt->data, evt->data_len);
+                s_stream->len += evt->data_len;
+                break;
+            }
+            size_t room = sizeof(s_arena) - 1 - s_arena_len;
+            size_t n = (size_t)evt->data_len;
+            if (n > room) {
+                n = room;
+                s_arena_truncated = true;
+            }
+            memcpy(s_arena + s_arena_len, evt->data, n);
+            s_arena_len += n;
+            s_arena[s_arena_len] = '\0';
+            break;
+        }
+        case HTTP_EVENT_DISCONNECTED:
+            s_connected = false;
+            break;
+        default:
+            break;
+    }
+    return ESP_OK;
+}
+
+esp_err_t http_session_init(void)
+{
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 提取URL的源（"https://host:port"），用于判断能否复用连接
+ */
+static void url_origin(const char *url, char *out, size_t out_size)
+{
+    const char *p = strstr(url, "://");
+    p = p ? p + 3 : url;
+    size_t n = strcspn(p, "/?#") + (size_t)(p - url);
+    if (n >= out_size) {
+        n = out_size - 1;
+    }
+    memcpy(out, url, n);
+    out[n] = '\0';
+}
+
+static void destroy_client(void)
+{
+    if (s_client) {
+        esp_http_client_cleanup(s_client);
+        s_client = NULL;
+    }
+    s_origin[0] = '\0';
+    s_connected = false;
+}
+
+/**
+ * @brief 准备句柄：同源且选项相同时复用，否则重建
+ */
+static esp_err_t prepare_client(const char *url, int timeout_ms, uint32_t flags)
+{
+    char origin[ORIGIN_MAX_LEN];
+    url_origin(url, origin, sizeof(origin));
+
+    if (s_client && strcmp(origin, s_origin) == 0 && flags == s_flags) {
+        esp_http_client_set_url(s_client, url);
+        esp_http_client_set_timeout_ms(s_client, timeout_ms);
+        return ESP_OK;
+    }
+
+    destroy_client();
+    esp_http_client_config_t config = {
+        .url = url,
+        .event_handler = http_event_handler,
+        .timeout_ms = timeout_ms,
+        .keep_alive_enable = true,
+        .skip_cert_common_name_check = (flags & HTTP_SESSION_FLAG_SKIP_CN_CHECK) != 0,
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+        .save_client_session = true,
+#endif
+    };
+    s_client = esp_http_client_init(&config);
+    if (!s_client) {
+        ESP_LOGE(TAG, "❌ HTTP客户端初始化失败");
+        return ESP_ERR_NO_MEM;
+    }
+    strncpy(s_origin, origin, sizeof(s_origin) - 1);
+    s_origin[sizeof(s_origin) - 1] = '\0';
+    s_flags = flags;
+    return ESP_OK;
+}
+
+static esp_err_t perform_once(void)
+{
+    if (s_stream) {
+        // 重连重试时从头解析
+        json_stream_init_bind(&s_stream->js, &s_stream->bind, s_stream->fields, s_stream->count, s_stream->out);
+        s_stream->len = 0;
+    }
+    s_arena_len = 0;
+    s_arena[0] = '\0';
+    s_arena_truncated = false;
+    s_connect_event = false;
+    esp_err_t err = esp_http_client_perform(s_client);
+    if (s_connect_event) {
+        s_stats.connects++;
+        metric_inc(&s_m_http_connects);
+    }
+    return err;
+}
+
+/**
+ * @brief 发送请求（调用方已加锁）
+ */
+static esp_err_t request_locked(http_session_method_t method, const char *url,
+                                const char *json_body, int timeout_ms, uint32_t flags)
+{
+    esp_err_t err = prepare_client(url, timeout_ms > 0 ? timeout_ms : CONFIG_HTTP_SESSION_TIMEOUT_MS, flags);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    if (method == HTTP_SESSION_POST) {
+        esp_http_client_set_method(s_client, HTTP_METHOD_POST);
+        esp_http_client_set_header(s_client, "Content-Type", "application/json");
+        esp_http_client_set_post_field(s_client, json_body, json_body ? (int)strlen(json_body) : 0);
+    } else {
+        esp_http_client_set_method(s_client, HTTP_METHOD_GET);
+        esp_http_client_delete_header(s_client, "Content-Type");
+        esp_http_client_set_post_field(s_client, NULL, 0);
+    }
+
+    s_stats.requests++;
+    bool was_connected = s_connected;
+    err = perform_once();
+    if (err != ESP_OK && was_connected) {
+        // 服务器可能已关闭空闲连接，重连重试一次
+        ESP_LOGW(TAG, "⚠️ 复用连接失败(%s)，重新连接", esp_err_to_name(err));
+        s_stats.retries++;
+        esp_http_client_close(s_client);
+        err = perform_once();
+    }
+
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "❌ HTTP请求失败: %s", esp_err_to_name(err));
+        // 句柄状态不确定，下次请求重建
+        destroy_client();
+        return err;
+    }
+
+    if (!s_connect_event) {
+        s_stats.reused++;
+        metric_inc(&s_m_http_reused);
+    }
+    ESP_LOGD(TAG, "%s %s -> %d%s", method == HTTP_SESSION_POST ? "POST" : "GET",
+             url, esp_http_client_get_status_code(s_client), s_connect_event ? "" : "（复用连接）");
+    return ESP_OK;
+}
+
+esp_err_t http_session_request(http_session_method_t method, const char *url,
+                               const char *json_body, int timeout_ms, uint32_t flags,
+                               http_session_response_t *resp)
+{
+    if (!url || !resp) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (http_session_init() != ESP_OK) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    memset(resp, 0, sizeof(*resp));
+
+    esp_err_t err = request_locked(method, url, json_body, timeout_ms, flags);
+    if (err != ESP_OK) {
+        xSemaphoreGive(s_mutex);
+        return err;
+    }
+
+    resp->status = esp_http_client_get_status_code(s_client);
+    resp->body = s_arena;
+    resp->len = s_arena_len;
+    resp->truncated = s_arena_truncated;
+    resp->reused = !s_connect_event;
+    if (s_arena_truncated) {
+        s_stats.truncated++;
+        ESP_LOGW(TAG, "⚠️ 响应超过%d字节，已截断", HTTP_SESSION_ARENA_SIZE - 1);
+    }
+    return ESP_OK;
+}
+
+esp_err_t http_session_request_json(http_session_method_t method, const char *url,
+                                    const char *json_body, int timeout_ms, uint32_t flags,
+                                    const json_field_t *fields, size_t count, void *out,
+                                    http_session_json_result_t *result)
+{
+    if (!url || !fields || count > 32 || !out || !result) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (http_session_init() != ESP_OK) {
+        return ESP_ERR_NO_MEM;
+    }
+    memset(result, 0, sizeof(*result));
+
+    stream_ctx_t *ctx = calloc(1, sizeof(stream_ctx_t));
+    if (!ctx) {
+        return ESP_ERR_NO_MEM;
+    }
+    ctx->fields = fields;
+    ctx->count = count;
+    ctx->out = out;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_stream = ctx;
+    esp_err_t err = request_locked(method, url, json_body, timeout_ms, flags);
+    s_stream = NULL;
+    if (err == ESP_OK) {
+        result->status = esp_http_client_get_status_code(s_client);
+    }
+    xSemaphoreGive(s_mutex);
+
+    if (err == ESP_OK) {
+        result->parse_err = json_stream_finish(&ctx->js);
+        result->matched = ctx->bind.matched;
+        result->len = ctx->len;
+        result->truncated = json_stream_truncated(&ctx->js);
+        if (result->parse_err != ESP_OK) {
+            ESP_LOGW(TAG, "⚠️ JSON解析失败(%s)，位置%lu/%u", esp_err_to_name(result->parse_err),
+                     (unsigned long)json_stream_error_offset(&ctx->js), (unsigned)ctx->len);
+        }
+    }
+    free(ctx);
+    return err;
+}
+
+void http_session_release(void)
+{
+    if (s_mutex) {
+        xSemaphoreGive(s_mutex);
+    }
+}
+
+void http_session_close(void)
+{
+    if (!s_mutex) {
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (s_client) {
+        ESP_LOGI(TAG, "🔌 关闭HTTP会话: 请求%lu次，新建连接%lu次，复用%lu次",
+                 (unsigned long)s_stats.requests, (unsigned long)s_stats.connects,
+                 (unsigned long)s_stats.reused);
+    }
+    destroy_client();
+    xSemaphoreGive(s_mutex);
+}
+
+void http_session_get_stats(http_session_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    if (s_mutex) {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+    }
+    *stats = s_stats;
+    if (s_mutex) {
+        xSemaphoreGive(s_mutex);
+    }
+}
@@ -0,0 +1,170 @@
+/**
+ * @file http_session.h
+ * @brief 共享HTTP(S)会话：启动阶段REST调用复用同一连接，JSON响应流式解析
+ *
+ * 启动时的配置获取、UUID查询、设备注册、固件版本检查都访问同一台服务器
+ * （unified_server_config_t），原来每次调用各自创建/销毁 esp_http_client，
+ * 每次都要重新TCP握手（HTTPS还要完整TLS握手），各模块还各有一块静态响应缓冲区。
+ *
+ * 本模块只保留一个客户端句柄：
+ * - 与上一次请求同源（协议+主机+端口）且请求选项相同时复用句柄，服务器未关闭连接则不重新握手（HTTP/1.1 keep-alive）
+ * - 源不同时重建句柄；开启 CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS 时保存TLS会话票据，
+ *   重连同一服务器时用票据恢复会话（简化握手）
+ * - 复用的连接已被服务器关闭时（请求失败），自动重连重试一次
+ *
+ * 响应体的两种接收方式（chunked响应都支持）：
+ * - JSON响应：http_session_request_json() 边接收边用 json_stream 解析，按字段表直接填充结构体，
+ *   内存占用固定（一个解析器，约700字节，请求期间从堆分配），与响应大小无关，不会截断
+ * - 其他短响应：http_session_request() 写入唯一的静态缓冲区（HTTP_SESSION_ARENA_SIZE），
+ *   成功后持有缓冲区锁，调用方用完 resp.body 后必须调用 http_session_release()；
+ *   请求失败时不持有锁
+ *
+ * 启动流程结束后调用 http_session_close() 关闭连接、释放句柄。
+ */
+
+#ifndef HTTP_SESSION_H
+#define HTTP_SESSION_H
+
+#include "esp_err.h"
+#include "json_stream.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CONFIG_HTTP_SESSION_ARENA_SIZE
+#define CONFIG_HTTP_SESSION_ARENA_SIZE      1024    ///< JSON响应走流式解析，缓冲区只用于短响应
+#endif
+
+#ifndef CONFIG_HTTP_SESSION_TIMEOUT_MS
+#define CONFIG_HTTP_SESSION_TIMEOUT_MS      15000
+#endif
+
+#define HTTP_SESSION_ARENA_SIZE     CONFIG_HTTP_SESSION_ARENA_SIZE  ///< 响应缓冲区大小（含结尾'\0'）
+
+/**
+ * @brief 请求方法
+ */
+typedef enum {
+    HTTP_SESSION_GET = 0,
+    HTTP_SESSION_POST,
+} http_session_method_t;
+
+/**
+ * @brief 请求选项（按位或，传给 flags 参数）
+ */
+#define HTTP_SESSION_FLAG_SKIP_CN_CHECK     (1u << 0)   ///< 不校验服务器证书CN（仅配网服务器：开发环境证书CN与地址不符）
+
+/**
+ * @brief 响应（body指向共享缓冲区，http_session_release()之后失效）
+ */
+typedef struct {
+    int status;                    ///< HTTP状态码
+    const char *body;              ///< 响应体（以'\0'结尾）
+    size_t len;                    ///< 响应体长度
+    bool truncated;                ///< 响应体超过缓冲区，已截断
+    bool reused;                   ///< 本次请求复用了已建立的连接
+} http_session_response_t;
+
+/**
+ * @brief JSON请求结果
+ */
+typedef struct {
+    int status;                    ///< HTTP状态码
+    esp_err_t parse_err;           ///< 解析结果（ESP_OK为完整的JSON，见 json_stream_finish()）
+    uint32_t matched;              ///< 已填充的字段位图（第i位对应fields[i]）
+    size_t len;                    ///< 响应体长度
+    bool truncated;                ///< 有字符串值超过JSON_STREAM_MAX_VALUE被截断
+} http_session_json_result_t;
+
+/**
+ * @brief 统计信息
+ */
+typedef struct {
+    uint32_t requests;             ///< 请求次数
+    uint32_t connects;             ///< 新建连接次数（含重连）
+    uint32_t reused;               ///< 复用已有连接的请求次数
+    uint32_t retries;              ///< 复用连接失败后重连重试次数
+    uint32_t truncated;            ///< 响应被截断次数
+} http_session_stats_t;
+
+/**
+ * @brief 初始化（创建缓冲区锁，可重复调用）
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_NO_MEM: 创建锁失败
+ */
+esp_err_t http_session_init(void);
+
+/**
+ * @brief 发送请求并把响应体读入共享缓冲区
+ *
+ * 返回ESP_OK时（无论状态码）持有缓冲区锁，调用方用完resp后必须调用 http_session_release()。
+ *
+ * @param method 请求方法
+ * @param url 完整URL（http://或https://）
+ * @param json_body POST请求体（JSON，GET时为NULL）
+ * @param timeout_ms 超时（0使用CONFIG_HTTP_SESSION_TIMEOUT_MS）
+ * @param flags 请求选项（HTTP_SESSION_FLAG_*，默认0）
+ * @param resp 输出响应
+ * @return esp_err_t
+ *   - ESP_OK: 收到响应（状态码见resp->status）
+ *   - ESP_ERR_INVALID_ARG: 参数错误
+ *   - ESP_ERR_NO_MEM: 客户端创建失败
+ *   - 其他: esp_http_client_perform的错误
+ */
+esp_err_t http_session_request(http_session_method_t method, const char *url,
+                               const char *json_body, int timeout_ms, uint32_t flags,
+                               http_session_response_t *resp);
+
+/**
+ * @brief 发送请求，响应体按字段表流式解析到结构体
+ *
+ * 不持有缓冲区锁，返回后无需调用 http_session_release()。
+ * 目标结构体不会被清空，未出现在响应中的字段保持原值；非200响应同样会被解析
+ * （通常是错误说明，字段不匹配），调用方需同时检查status和parse_err。
+ *
+ * @param method 请求方法
+ * @param url 完整URL
+ * @param json_body POST请求体（GET时为NULL）
+ * @param timeout_ms 超时（0使用CONFIG_HTTP_SESSION_TIMEOUT_MS）
+ * @param flags 请求选项（HTTP_SESSION_FLAG_*，默认0）
+ * @param fields 字段表
+ * @param count 字段数（不超过32）
+ * @param out 目标结构体
+ * @param result 输出结果
+ * @return esp_err_t
+ *   - ESP_OK: 收到响应（状态码和解析结果见result）
+ *   - ESP_ERR_INVALID_ARG: 参数错误
+ *   - ESP_ERR_NO_MEM: 内存不足
+ *   - 其他: esp_http_client_perform的错误
+ */
+esp_err_t http_session_request_json(http_session_method_t method, const char *url,
+                                    const char *json_body, int timeout_ms, uint32_t flags,
+                                    const json_field_t *fields, size_t count, void *out,
+                                    http_session_json_result_t *result);
+
+/**
+ * @brief 释放共享缓冲区（与成功的 http_session_request() 配对）
+ */
+void http_session_release(void);
+
+/**
+ * @brief 关闭连接并销毁客户端句柄（启动流程结束后调用，之后的请求会重新建立连接）
+ */
+void http_session_close(void);
+
+/**
+ * @brief 获取统计信息
+ */
+void http_session_get_stats(http_session_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HTTP_SESSION_H
@@ -5,114 +5,31 @@
 
 #include "server_config.h"
 #include "esp_log.h"
-#include "nvs_flash.h"
-#include "nvs.h"
+#include "config_cache.h"
 #include <string.h>
 
 static const char *TAG = "SERVER_CONFIG";
 
 /**
- * @brief 从NVS加载服务器配置
+ * @brief 加载服务器配置（从配置缓存读取，不再访问NVS）
+ *
+ * 地址格式（协议前缀、结尾不含/）已在配置缓存加载时规范化
  */
 esp_err_t server_config_load_from_nvs(unified_server_config_t *config)
 {
     if (!config) {
-        ESP_LOGE(TAG, "[NVS DEBUG] server_config_load_from_nvs: 参数错误，config为NULL");
         return ESP_ERR_INVALID_ARG;
     }
 
-    ESP_LOGI(TAG, "[NVS DEBUG] ========== 开始从Flash读取服务器配置 ==========");
-    ESP_LOGI(TAG, "[NVS DEBUG] 命名空间: %s", SERVER_CONFIG_NAMESPACE);
-
     memset(config, 0, sizeof(unified_server_config_t));
-
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open(SERVER_CONFIG_NAMESPACE, NVS_READONLY, &nvs_handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "[NVS DEBUG] ❌ 打开NVS命名空间失败: %s (错误码: %d)", 
-                 esp_err_to_name(err), err);
-        ESP_LOGE(TAG, "[NVS DEBUG] 可能原因：NVS未初始化或命名空间不存在");
-        return err;
-    }
-    ESP_LOGI(TAG, "[NVS DEBUG] ✅ NVS命名空间打开成功");
-
-    // 读取服务器基础地址
-    ESP_LOGI(TAG, "[NVS DEBUG] --- 读取服务器基础地址 (键名: %s) ---", NVS_KEY_BASE_ADDRESS);
-    size_t required_size = sizeof(config->base_address);
-    err = nvs_get_str(nvs_handle, NVS_KEY_BASE_ADDRESS, config->base_address, &required_size);
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGW(TAG, "[NVS DEBUG] ⚠️ 服务器基础地址未找到 (键名不存在)");
-        ESP_LOGW(TAG, "[NVS DEBUG] 键名: %s, 命名空间: %s", NVS_KEY_BASE_ADDRESS, SERVER_CONFIG_NAMESPACE);
-        nvs_close(nvs_handle);
+    if (!config_cache_get_server_address(config->base_address, sizeof(config->base_address))) {
         return ESP_ERR_NOT_FOUND;
-    } else if (err != ESP_OK) {
-        ESP_LOGE(TAG, "[NVS DEBUG] ❌ 读取服务器基础地址失败: %s (错误码: %d)", 
-                 esp_err_to_name(err), err);
-        nvs_close(nvs_handle);
-        return err;
-    }
-
-    ESP_LOGI(TAG, "[NVS DEBUG] ✅ 服务器基础地址读取成功: '%s' (长度: %zu)", 
-             config->base_address, required_size);
-
-    nvs_close(nvs_handle);
-    ESP_LOGI(TAG, "[NVS DEBUG] NVS句柄已关闭");
-
-    // 验证base_address格式：应该包含http://或https://前缀
-    // 如果缺少协议前缀，自动添加http://（兼容旧数据）
-    // 先验证字符串是否有效（以'\0'结尾）
-    if (required_size > 0 && required_size <= sizeof(config->base_address) && 
-        config->base_address[required_size - 1] == '\0') {
-        // 使用required_size而不是strlen，避免在中断上下文中访问无效内存
-        size_t addr_len = required_size - 1;  // 减去'\0'
-        if (addr_len > 0) {
-            if (strncmp(config->base_address, "http://", 7) != 0 && 
-                strncmp(config->base_address, "https://", 8) != 0) {
-                ESP_LOGW(TAG, "[NVS DEBUG] ⚠️ 服务器地址缺少协议前缀，自动添加http://（兼容旧数据）");
-                // 检查长度，确保添加"http://"后不会溢出
-                if (addr_len + 7 < sizeof(config->base_address)) {
-                    char temp_address[128] = {0};  // 增大缓冲区避免截断警告
-                    int snprintf_ret = snprintf(temp_address, sizeof(temp_address), "http://%s", config->base_address);
-                    if (snprintf_ret > 0 && snprintf_ret < sizeof(temp_address)) {
-                        strncpy(config->base_address, temp_address, sizeof(config->base_address) - 1);
-                        config->base_address[sizeof(config->base_address) - 1] = '\0';
-                        addr_len = snprintf_ret;  // 使用snprintf返回值更新长度，避免调用strlen
-                        ESP_LOGI(TAG, "[NVS DEBUG]    修正后地址: '%s'", config->base_address);
-                    } else {
-                        ESP_LOGE(TAG, "[NVS DEBUG] ❌ 构建修正后地址失败");
-                        return ESP_ERR_INVALID_SIZE;
-                    }
-                } else {
-                    ESP_LOGE(TAG, "[NVS DEBUG] ❌ 服务器地址过长，无法添加协议前缀");
-                    return ESP_ERR_INVALID_SIZE;
-                }
-            }
-            
-            // 确保结尾不包含斜杠（使用已知长度，避免再次调用strlen）
-            if (addr_len > 0 && config->base_address[addr_len - 1] == '/') {
-                config->base_address[addr_len - 1] = '\0';
-                ESP_LOGW(TAG, "[NVS DEBUG] ⚠️ 检测到服务器地址结尾包含/，已自动去除");
-                ESP_LOGI(TAG, "[NVS DEBUG]    修正后地址: '%s'", config->base_address);
-            }
-        }
-    } else {
-        ESP_LOGE(TAG, "[NVS DEBUG] ❌ 服务器地址格式无效（required_size=%zu）", required_size);
-        return ESP_ERR_INVALID_ARG;
     }
 
     // 设置默认端口（不从NVS读取）
     config->http_port = DEFAULT_HTTP_PORT;
     config->mqtt_port = DEFAULT_MQTT_PORT;
 
-    ESP_LOGI(TAG, "[NVS DEBUG] ========== 服务器配置读取完成 ==========");
-    ESP_LOGI(TAG, "[NVS DEBUG] 📋 完整配置信息:");
-    ESP_LOGI(TAG, "[NVS DEBUG]    服务器地址: '%s'", config->base_address);
-    ESP_LOGI(TAG, "[NVS DEBUG]    HTTP端口: %d (默认值，不从NVS读取)", config->http_port);
-    ESP_LOGI(TAG, "[NVS DEBUG]    MQTT端口: %d (默认值，不从NVS读取)", config->mqtt_port);
-    ESP_LOGI(TAG, "[NVS DEBUG]    配置有效性: %s", 
-             strlen(config->base_address) > 0 ? "✅ 有效" : "❌ 无效 (地址为空)");
-    ESP_LOGI(TAG, "[NVS DEBUG] ========================================");
-
     return ESP_OK;
 }
 
@@ -137,8 +54,19 @@ esp_err_t server_config_get_default(unified_server_config_t *config)
     return ESP_OK;
 }
 
+static uint32_t set_base_address(config_snapshot_t *cfg, void *ctx)
+{
+    const char *address = ctx;
+    if (strcmp(cfg->server_base_address, address) == 0) {
+        return 0;
+    }
+    strncpy(cfg->server_base_address, address, sizeof(cfg->server_base_address) - 1);
+    cfg->server_base_address[sizeof(cfg->server_base_address) - 1] = '\0';
+    return CONFIG_FIELD_SERVER;
+}
+
 /**
- * @brief 保存服务器配置到NVS
+ * @brief 保存服务器配置（写入配置缓存，由缓存写入任务提交到NVS）
  */
 esp_err_t server_config_save_to_nvs(const unified_server_config_t *config)
 {
@@ -146,32 +74,13 @@ esp_err_t server_config_save_to_nvs(const unified_server_config_t *config)
         return ESP_ERR_INVALID_ARG;
     }
 
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open(SERVER_CONFIG_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    esp_err_t err = config_cache_update(set_base_address, (void *)config->base_address);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to open NVS namespace '%s': %s", 
-                 SERVER_CONFIG_NAMESPACE, esp_err_to_name(err));
+        ESP_LOGE(TAG, "Failed to save server config: %s", esp_err_to_name(err));
         return err;
     }
 
-    // 保存服务器基础地址
-    err = nvs_set_str(nvs_handle, NVS_KEY_BASE_ADDRESS, config->base_address);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to save base_address to NVS: %s", esp_err_to_name(err));
-        nvs_close(nvs_handle);
-        return err;
-    }
-
-    err = nvs_commit(nvs_handle);
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to commit NVS: %s", esp_err_to_name(err));
-        nvs_close(nvs_handle);
-        return err;
-    }
-
-    nvs_close(nvs_handle);
-
-    ESP_LOGI(TAG, "Server config saved to NVS: base_address=%s", config->base_address);
+    ESP_LOGI(TAG, "Server config saved: base_address=%s", config->base_address);
 
     return ESP_OK;
 }
@@ -2,7 +2,7 @@
  * @file server_config.h
  * @brief 统一服务器配置模块
  * 
- * 从NVS读取服务器基础地址，提供动态URL构建功能
+ * 从NVS读取服务器基础地址（经配置缓存 config_cache），提供动态URL构建功能
  * 重要约束：服务器地址必须从NVS读取并动态构建URL，禁止硬编码
  */
 
@@ -40,7 +40,9 @@ typedef struct {
 } unified_server_config_t;
 
 /**
- * @brief 从NVS加载服务器配置
+ * @brief 加载服务器配置
+ * 
+ * 从配置缓存读取（开机时已从NVS加载），不访问flash
  * 
  * @param config 输出参数，加载的配置
  * @return esp_err_t 
@@ -59,7 +61,9 @@ esp_err_t server_config_load_from_nvs(unified_server_config_t *config);
 esp_err_t server_config_get_default(unified_server_config_t *config);
 
 /**
- * @brief 保存服务器配置到NVS
+ * @brief 保存服务器配置
+ * 
+ * 立即更新配置缓存，由缓存写入任务延后提交到NVS；重启前需调用 config_cache_flush()
  * 
  * @param config 要保存的配置
  * @return esp_err_t 
@@ -10,12 +10,14 @@
 #include "ota/ota_manager.h"
 #include "wifi_config/wifi_config.h"
 #include "server/server_config.h"
+#include "server/http_session.h"  // 启动阶段REST请求共用的HTTP会话
 #include "simple_display.h"
 #include "mqtt/aiot_mqtt_client.h"
 #include "device/device_control.h"  // 设备控制模块
 #include "device/preset_control.h"  // 预设控制模块
 #include "device/pwm_control.h"     // PWM控制模块
 #include "button/button_handler.h"  // 按钮处理模块
+#include "button_input.h"  // 启动窗口时长
 #include "app_config.h"  // 包含产品ID等配置
 #include "esp_log.h"
 #include "esp_system.h"
@@ -27,8 +29,22 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
+#include "esp_timer.h"
 #include "cJSON.h"  // JSON解析
+#include "binlog.h"  // 二进制日志
+#include "metrics.h"  // 运行时指标
+#include "system/task_profiler.h"  // 任务CPU/栈分析
+#include "system/config_cache.h"  // 统一配置缓存
+#include "hil_trace.h"  // 硬件在环采集
+#include "alarm.h"  // 设备端告警规则
+#include "report_filter.h"  // 按变化上报
+#include "sensor_filter.h"  // 传感器校准和滤波
+#include "json_writer.h"  // 有界JSON输出
+#include "storage/sample_store.h"  // 传感器ID
+#include "live_provision.h"  // 不重启配网（MQTT连接里程碑）
+#include "mbedtls/base64.h"
 #include <string.h>
+#include <strings.h>
 
 #define TAG "STARTUP_MGR"
 // FIRMWARE_VERSION 已在 DEVICE_CONFIG.h 中定义，此处不再重复定义
@@ -48,11 +64,20 @@ static void *s_display = NULL;
 static bool s_mqtt_connected = false;
 static button_event_cb_t s_button_event_callback = NULL;
 static bool s_device_not_registered = false;  // 标记设备未注册（WiFi已连接但设备未注册）
+static esp_event_handler_instance_t s_wifi_handler = NULL;
+static esp_event_handler_instance_t s_ip_handler = NULL;
+static bool s_modules_ready = false;         // 设备/预设/PWM控制模块已初始化（再次配网时不重复初始化）
+static bool s_live_resume = false;           // 配网后继续启动：跳过阶段提示的显示停留
 
 // 配置缓存
 static provisioning_config_t s_config = {0};
 static unified_server_config_t s_server_config = {0};
 
+// 运行时指标：控制命令执行耗时与结果
+METRIC_HISTOGRAM_DEFINE(s_m_cmd_exec_ms, "cmd_exec_ms", 1, 5, 10, 50, 100, 500, 1000, 5000);
+METRIC_COUNTER_DEFINE(s_m_cmd_ok, "cmd_ok");
+METRIC_COUNTER_DEFINE(s_m_cmd_fail, "cmd_fail");
+
 /**
  * @brief 更新启动阶段并显示到LCD
  */
@@ -72,6 +97,15 @@ static void update_stage(startup_stage_t stage, const char *message) {
     ESP_LOGI(TAG, "🔄 [%s] %s", startup_manager_get_stage_string(stage), message);
 }
 
+/**
+ * @brief 阶段提示的显示停留（配网后继续启动时跳过，缩短从提交凭据到上线的时间）
+ */
+static void ui_pause(uint32_t ms) {
+    if (!s_live_resume) {
+        vTaskDelay(pdMS_TO_TICKS(ms));
+    }
+}
+
 /**
  * @brief WiFi事件处理
  */
@@ -107,6 +141,472 @@ static void wifi_event_handler(void* arg, esp_event_base_t event_base,
     }
 }
 
+/**
+ * @brief 处理读取日志命令（MQTT_CMD_GET_LOG）
+ *
+ * 命令: {"cmd":"get_log","cursor":0,"max_bytes":512}
+ * 响应发布到状态主题: {"type":"log","cursor":..,"next":..,"len":..,"elf_id":"..","data":"<base64>"}
+ * data为原始二进制记录，用 tools/binlog_decode.py --json 解码；len为0表示已读完。
+ */
+static void handle_get_log_command(const cJSON *json) {
+    const size_t max_chunk = 768;
+    uint64_t cursor = 0;           // 64位游标，JSON数值在2^53以内精确
+    size_t max_bytes = 512;
+
+    cJSON *cursor_item = cJSON_GetObjectItem(json, "cursor");
+    if (cJSON_IsNumber(cursor_item) && cursor_item->valuedouble >= 0) {
+        cursor = (uint64_t)cursor_item->valuedouble;
+    }
+    cJSON *max_item = cJSON_GetObjectItem(json, "max_bytes");
+    if (cJSON_IsNumber(max_item) && max_item->valueint > 0) {
+        max_bytes = max_item->valueint < (int)max_chunk ? (size_t)max_item->valueint : max_chunk;
+    }
+
+    if (strlen(s_config.mqtt_topic_status) == 0) {
+        ESP_LOGW(TAG, "⚠️ 状态主题为空，无法返回日志");
+        return;
+    }
+
+    uint8_t *raw = malloc(max_bytes);
+    size_t b64_size = ((max_bytes + 2) / 3) * 4 + 1;
+    char *b64 = malloc(b64_size);
+    char *response = malloc(b64_size + 160);
+    if (!raw || !b64 || !response) {
+        ESP_LOGE(TAG, "❌ 内存不足，无法读取日志");
+        free(raw);
+        free(b64);
+        free(response);
+        return;
+    }
+
+    size_t raw_len = 0;
+    size_t b64_len = 0;
+    uint64_t next = cursor;
+    binlog_flush();
+    esp_err_t ret = binlog_read(cursor, raw, max_bytes, &raw_len, &next);
+    if (ret == ESP_OK) {
+        mbedtls_base64_encode((unsigned char *)b64, b64_size, &b64_len, raw, raw_len);
+    }
+    b64[b64_len] = '\0';
+
+    uint8_t elf_id[8];
+    binlog_get_elf_id(elf_id);
+    int len = snprintf(response, b64_size + 160,
+        "{\"type\":\"log\",\"result\":\"%s\",\"cursor\":%llu,\"next\":%llu,\"len\":%u,"
+        "\"elf_id\":\"%02x%02x%02x%02x%02x%02x%02x%02x\",\"data\":\"%s\"}",
+        ret == ESP_OK ? "ok" : esp_err_to_name(ret), (unsigned long long)cursor, (unsigned long long)next,
+        (unsigned)raw_len, elf_id[0], elf_id[1], elf_id[2], elf_id[3],
+        elf_id[4], elf_id[5], elf_id[6], elf_id[7], b64);
+    mqtt_client_publish(s_config.mqtt_topic_status, response, len, MQTT_QOS_1, false);
+    ESP_LOGI(TAG, "📜 日志已返回: cursor=%llu, next=%llu, %u 字节",
+             (unsigned long long)cursor, (unsigned long long)next, (unsigned)raw_len);
+
+    free(raw);
+    free(b64);
+    free(response);
+}
+
+/**
+ * @brief 处理读取运行状态命令（MQTT_CMD_GET_STATUS）
+ *
+ * 命令: {"cmd":"get_status"}
+ * 响应发布到状态主题: {"type":"task_status","result":"ok","uptime":..,"profile":{...}}
+ * profile为最近一个采样窗口的任务CPU占用、栈剩余和堆碎片（格式见task_profiler.h）。
+ * 报告和JSON缓冲区都在堆上分配，避免占用MQTT任务的栈。
+ */
+static void handle_get_status_command(void) {
+    const size_t response_size = 2560;
+
+    if (strlen(s_config.mqtt_topic_status) == 0) {
+        ESP_LOGW(TAG, "⚠️ 状态主题为空，无法返回运行状态");
+        return;
+    }
+
+    task_profiler_report_t *report = malloc(sizeof(task_profiler_report_t));
+    char *response = malloc(response_size);
+    if (!report || !response) {
+        ESP_LOGE(TAG, "❌ 内存不足，无法生成运行状态");
+        free(report);
+        free(response);
+        return;
+    }
+
+    esp_err_t ret = task_profiler_get_report(report);
+    int len = snprintf(response, response_size,
+                       "{\"type\":\"task_status\",\"result\":\"%s\",\"uptime\":%lu,\"profile\":",
+                       ret == ESP_OK ? "ok" : esp_err_to_name(ret),
+                       (unsigned long)(esp_timer_get_time() / 1000000));
+    size_t profile_len = 0;
+    if (ret == ESP_OK) {
+        ret = task_profiler_report_json(report, response + len, response_size - len - 1, &profile_len);
+    }
+    if (ret != ESP_OK) {
+        profile_len = snprintf(response + len, response_size - len - 1, "null");
+    }
+    len += profile_len;
+    response[len++] = '}';
+    response[len] = '\0';
+
+    mqtt_client_publish(s_config.mqtt_topic_status, response, len, MQTT_QOS_1, false);
+    ESP_LOGI(TAG, "📊 运行状态已返回: %d 字节", len);
+
+    free(report);
+    free(response);
+}
+
+/**
+ * @brief 处理HIL采集命令（trace_start / trace_stop / get_trace）
+ *
+ * 命令: {"cmd":"trace_start"}、{"cmd":"trace_stop"}、
+ *       {"cmd":"get_trace","cursor":0,"max_bytes":512}
+ * 响应发布到状态主题:
+ *   {"type":"trace","result":"ok","active":true,"records":..,"bytes":..,"truncated":false}
+ *   get_trace另带 "cursor","next","len","data"(base64)，len为0表示已读完。
+ * get_trace会先停止采集，避免读出的响应本身又被记录进trace。
+ * 用 tools/hil_trace_dump.py 把响应拼成.hilt文件。
+ */
+static void handle_trace_command(const char *cmd_str, const cJSON *json) {
+    const size_t max_chunk = 768;
+    uint32_t cursor = 0;
+    size_t max_bytes = 0;
+    esp_err_t ret = ESP_OK;
+
+    if (strcmp(cmd_str, "trace_start") == 0) {
+        ret = hil_trace_start();
+    } else if (strcmp(cmd_str, "trace_stop") == 0) {
+        hil_trace_stop();
+    } else {
+        hil_trace_stop();
+        max_bytes = 512;
+        cJSON *cursor_item = cJSON_GetObjectItem(json, "cursor");
+        if (cJSON_IsNumber(cursor_item) && cursor_item->valuedouble >= 0) {
+            cursor = (uint32_t)cursor_item->valuedouble;
+        }
+        cJSON *max_item = cJSON_GetObjectItem(json, "max_bytes");
+        if (cJSON_IsNumber(max_item) && max_item->valueint > 0) {
+            max_bytes = max_item->valueint < (int)max_chunk ? (size_t)max_item->valueint : max_chunk;
+        }
+    }
+
+    if (strlen(s_config.mqtt_topic_status) == 0) {
+        ESP_LOGW(TAG, "⚠️ 状态主题为空，无法返回采集状态");
+        return;
+    }
+
+    size_t b64_size = ((max_bytes + 2) / 3) * 4 + 1;
+    uint8_t *raw = max_bytes ? malloc(max_bytes) : NULL;
+    char *b64 = malloc(b64_size);
+    char *response = malloc(b64_size + 200);
+    if ((max_bytes && !raw) || !b64 || !response) {
+        ESP_LOGE(TAG, "❌ 内存不足，无法返回采集数据");
+        free(raw);
+        free(b64);
+        free(response);
+        return;
+    }
+
+    size_t raw_len = 0;
+    size_t b64_len = 0;
+    uint32_t next = cursor;
+    if (max_bytes) {
+        ret = hil_trace_read(cursor, raw, max_bytes, &raw_len, &next);
+        if (ret == ESP_OK) {
+            mbedtls_base64_encode((unsigned char *)b64, b64_size, &b64_len, raw, raw_len);
+        }
+    }
+    b64[b64_len] = '\0';
+
+    hil_trace_stats_t stats;
+    hil_trace_get_stats(&stats);
+    int len = snprintf(response, b64_size + 200,
+        "{\"type\":\"trace\",\"result\":\"%s\",\"active\":%s,\"records\":%lu,\"bytes\":%lu,"
+        "\"truncated\":%s",
+        ret == ESP_OK ? "ok" : esp_err_to_name(ret), stats.active ? "true" : "false",
+        (unsigned long)stats.records, (unsigned long)stats.bytes, stats.truncated ? "true" : "false");
+    if (max_bytes) {
+        len += snprintf(response + len, b64_size + 200 - len,
+            ",\"cursor\":%lu,\"next\":%lu,\"len\":%u,\"data\":\"%s\"",
+            (unsigned long)cursor, (unsigned long)next, (unsigned)raw_len, b64);
+    }
+    len += snprintf(response + len, b64_size + 200 - len, "}");
+    mqtt_client_publish(s_config.mqtt_topic_status, response, len, MQTT_QOS_1, false);
+    ESP_LOGI(TAG, "⏺️ 采集命令 %s: %s, %lu 条记录", cmd_str,
+             ret == ESP_OK ? "ok" : esp_err_to_name(ret), (unsigned long)stats.records);
+
+    free(raw);
+    free(b64);
+    free(response);
+}
+
+/**
+ * @brief 解析命令中的传感器：数字ID或名称（"dht11"/"ds18b20"/"rain"）
+ *
+ * @return 传感器ID，无效时返回0
+ */
+static uint8_t parse_sensor_id(const cJSON *item) {
+    if (cJSON_IsNumber(item) && item->valueint > 0 && item->valueint < 256) {
+        return (uint8_t)item->valueint;
+    }
+    if (cJSON_IsString(item)) {
+        if (strcasecmp(item->valuestring, "dht11") == 0) return SAMPLE_SENSOR_DHT11;
+        if (strcasecmp(item->valuestring, "ds18b20") == 0) return SAMPLE_SENSOR_DS18B20;
+        if (strcasecmp(item->valuestring, "rain") == 0) return SAMPLE_SENSOR_RAIN;
+    }
+    return 0;
+}
+
+/**
+ * @brief 在状态主题上返回配置命令的结果：{"type":<type>,"result":..,<状态对象的成员>}
+ *
+ * 状态JSON生成失败（如缓冲区不足）时以 "<null_key>":null 代替。
+ */
+static void publish_status_response(const char *type, esp_err_t result, json_writer_object_fn_t status_json,
+                                    const char *null_key, size_t response_size) {
+    if (strlen(s_config.mqtt_topic_status) == 0) {
+        ESP_LOGW(TAG, "⚠️ 状态主题为空，无法返回 %s", type);
+        return;
+    }
+
+    char *response = malloc(response_size);
+    if (!response) {
+        ESP_LOGE(TAG, "❌ 内存不足，无法返回 %s", type);
+        return;
+    }
+
+    json_writer_t w;
+    json_writer_init(&w, response, response_size);
+    json_writer_printf(&w, "{\"type\":\"%s\",\"result\":\"%s\",",
+                       type, result == ESP_OK ? "ok" : esp_err_to_name(result));
+    if (json_writer_splice_object(&w, status_json) != ESP_OK) {
+        json_writer_printf(&w, "\"%s\":null}", null_key);
+    }
+    size_t len = 0;
+    if (json_writer_finish(&w, &len) == ESP_OK) {
+        mqtt_client_publish(s_config.mqtt_topic_status, response, len, MQTT_QOS_1, false);
+    } else {
+        ESP_LOGW(TAG, "⚠️ %s 响应超出缓冲区(%u字节)", type, (unsigned)response_size);
+    }
+    free(response);
+}
+
+static uint32_t store_alarm_rules(config_snapshot_t *cfg, void *ctx) {
+    cfg->alarm_rule_count = (uint8_t)alarm_get_rules(cfg->alarm_rules);
+    return CONFIG_FIELD_ALARM;
+}
+
+/**
+ * @brief 处理告警规则命令（MQTT_CMD_SET_ALARM_THRESHOLD / MQTT_CMD_CLEAR_ALARM）
+ *
+ * 命令:
+ *   {"cmd":"set_alarm_threshold","sensor":"dht11","channel":0,"min":5,"max":35,
+ *    "hysteresis":0.5,"rate":2,"stuck_sec":600,"stuck_epsilon":0.05,"debounce":2}
+ *     min/max/rate/stuck_sec 至少给出一项，未给出的判断不启用；同一传感器通道的规则被替换
+ *   {"cmd":"clear_alarm","sensor":"dht11","channel":0}  删除规则，不带sensor时删除全部
+ *   {"cmd":"get_alarms"}
+ * 规则保存到配置缓存（NVS alarm/rules），响应发布到状态主题:
+ *   {"type":"alarm_rules","result":"ok","rules":[...]}（格式见alarm.h）
+ */
+static void handle_alarm_command(const char *cmd_str, const cJSON *json) {
+    const size_t response_size = 1536;
+    esp_err_t ret = ESP_OK;
+
+    if (strcmp(cmd_str, "set_alarm_threshold") == 0) {
+        alarm_rule_t rule = {0};
+        const cJSON *item;
+
+        rule.sensor = parse_sensor_id(cJSON_GetObjectItem(json, "sensor"));
+        item = cJSON_GetObjectItem(json, "channel");
+        rule.channel = cJSON_IsNumber(item) ? (uint8_t)item->valueint : 0;
+        item = cJSON_GetObjectItem(json, "debounce");
+        rule.debounce = cJSON_IsNumber(item) && item->valueint > 0 ? (uint8_t)item->valueint : 1;
+        item = cJSON_GetObjectItem(json, "min");
+        if (cJSON_IsNumber(item)) {
+            rule.checks |= ALARM_CHECK_MIN;
+            rule.min = (float)item->valuedouble;
+        }
+        item = cJSON_GetObjectItem(json, "max");
+        if (cJSON_IsNumber(item)) {
+            rule.checks |= ALARM_CHECK_MAX;
+            rule.max = (float)item->valuedouble;
+        }
+        item = cJSON_GetObjectItem(json, "hysteresis");
+        rule.hysteresis = cJSON_IsNumber(item) ? (float)item->valuedouble : 0.0f;
+        item = cJSON_GetObjectItem(json, "rate");
+        if (cJSON_IsNumber(item)) {
+            rule.checks |= ALARM_CHECK_RATE;
+            rule.rate = (float)item->valuedouble;
+        }
+        item = cJSON_GetObjectItem(json, "stuck_sec");
+        if (cJSON_IsNumber(item)) {
+            rule.checks |= ALARM_CHECK_STUCK;
+            rule.stuck_sec = item->valuedouble > 0 ? (uint32_t)item->valuedouble : 0;
+        }
+        item = cJSON_GetObjectItem(json, "stuck_epsilon");
+        rule.stuck_epsilon = cJSON_IsNumber(item) ? (float)item->valuedouble : 0.0f;
+
+        ret = rule.sensor ? alarm_set_rule(&rule) : ESP_ERR_INVALID_ARG;
+    } else if (strcmp(cmd_str, "clear_alarm") == 0) {
+        const cJSON *sensor_item = cJSON_GetObjectItem(json, "sensor");
+        if (!sensor_item) {
+            alarm_load_rules(NULL, 0);
+        } else {
+            const cJSON *channel_item = cJSON_GetObjectItem(json, "channel");
+            uint8_t channel = cJSON_IsNumber(channel_item) ? (uint8_t)channel_item->valueint : 0;
+            ret = alarm_remove_rule(parse_sensor_id(sensor_item), channel);
+        }
+    }
+
+    if (ret == ESP_OK && strcmp(cmd_str, "get_alarms") != 0) {
+        config_cache_update(store_alarm_rules, NULL);
+    }
+
+    publish_status_response("alarm_rules", ret, alarm_status_json, "rules", response_size);
+    ESP_LOGI(TAG, "🔔 告警命令 %s: %s", cmd_str, ret == ESP_OK ? "ok" : esp_err_to_name(ret));
+}
+
+static uint32_t store_report_policies(config_snapshot_t *cfg, void *ctx) {
+    cfg->report_by_exception = report_filter_is_enabled();
+    cfg->report_policy_count = (uint8_t)report_filter_get_policies(cfg->report_policies);
+    return CONFIG_FIELD_REPORT;
+}
+
+/**
+ * @brief 处理上报策略命令
+ *
+ * 命令:
+ *   {"cmd":"set_report_policy","sensor":"dht11","deadband":0.5,"deadband_pct":0,
+ *    "min_interval":10,"max_interval":300}
+ *     未给出的字段保持原值；只带"enabled"（不带sensor）时仅切换按变化上报
+ *   {"cmd":"set_report_policy","enabled":false}  关闭按变化上报（每次采样都上报）
+ *   {"cmd":"get_report_policy"}
+ * 策略保存到配置缓存（NVS report/enabled、report/policies），响应发布到状态主题:
+ *   {"type":"report_policy","result":"ok","enabled":true,"policies":[...]}（格式见report_filter.h）
+ */
+static void handle_report_command(const char *cmd_str, const cJSON *json) {
+    const size_t response_size = 768;
+    esp_err_t ret = ESP_OK;
+
+    if (strcmp(cmd_str, "set_report_policy") == 0) {
+        const cJSON *sensor_item = cJSON_GetObjectItem(json, "sensor");
+        const cJSON *enabled_item = cJSON_GetObjectItem(json, "enabled");
+
+        if (sensor_item) {
+            report_policy_t policy = {0};
+            const cJSON *item;
+            uint8_t sensor = parse_sensor_id(sensor_item);
+
+            if (sensor == 0) {
+                ret = ESP_ERR_INVALID_ARG;
+            } else if (report_filter_get_policy(sensor, &policy) != ESP_OK) {
+                policy.sensor = sensor;
+                policy.min_interval_sec = CONFIG_REPORT_FILTER_DEFAULT_MIN_INTERVAL_SEC;
+                policy.max_interval_sec = CONFIG_REPORT_FILTER_DEFAULT_MAX_INTERVAL_SEC;
+            }
+            if (ret == ESP_OK) {
+                item = cJSON_GetObjectItem(json, "deadband");
+                if (cJSON_IsNumber(item)) policy.deadband_abs = (float)item->valuedouble;
+                item = cJSON_GetObjectItem(json, "deadband_pct");
+                if (cJSON_IsNumber(item)) policy.deadband_pct = (float)item->valuedouble;
+                item = cJSON_GetObjectItem(json, "min_interval");
+                if (cJSON_IsNumber(item)) policy.min_interval_sec = item->valuedouble > 0 ? (uint32_t)item->valuedouble : 0;
+                item = cJSON_GetObjectItem(json, "max_interval");
+                if (cJSON_IsNumber(item)) policy.max_interval_sec = item->valuedouble > 0 ? (uint32_t)item->valuedouble : 0;
+                ret = report_filter_set_policy(&policy);
+            }
+        } else if (!cJSON_IsBool(enabled_item)) {
+            ret = ESP_ERR_INVALID_ARG;
+        }
+
+        if (ret == ESP_OK && cJSON_IsBool(enabled_item)) {
+            report_filter_set_enabled(cJSON_IsTrue(enabled_item));
+        }
+        if (ret == ESP_OK) {
+            config_cache_update(store_report_policies, NULL);
+        }
+    }
+
+    publish_status_response("report_policy", ret, report_filter_status_json, "policies", response_size);
+    ESP_LOGI(TAG, "📉 上报策略命令 %s: %s", cmd_str, ret == ESP_OK ? "ok" : esp_err_to_name(ret));
+}
+
+static uint32_t store_sensor_filters(config_snapshot_t *cfg, void *ctx) {
+    cfg->sensor_filter_count = (uint8_t)sensor_filter_get_configs(cfg->sensor_filters);
+    return CONFIG_FIELD_SENSOR_FILTER;
+}
+
+/**
+ * @brief 处理传感器校准和滤波命令（MQTT_CMD_CALIBRATE_SENSOR）
+ *
+ * 命令:
+ *   {"cmd":"calibrate_sensor","sensor":"dht11","channel":0,"offset":-0.8,"scale":1.0}
+ *     输出 = 原始值*scale + offset，未给出的字段保持原值
+ *   {"cmd":"set_sensor_filter","sensor":"ds18b20","channel":0,"median":3,"hampel":5,
+ *    "hampel_k":3.0,"hampel_floor":1.0,"ema_alpha":0.3,"min":-55,"max":125}
+ *     median/hampel为窗口大小（奇数，0不启用），ema_alpha为0~1（1不平滑）
+ *   {"cmd":"get_sensor_filter"}
+ * 配置保存到配置缓存（NVS sensor_filter/channels），响应发布到状态主题:
+ *   {"type":"sensor_filter","result":"ok","channels":[...]}（格式见sensor_filter.h）
+ */
+static void handle_sensor_filter_command(const char *cmd_str, const cJSON *json) {
+    const size_t response_size = 2048;
+    esp_err_t ret = ESP_OK;
+
+    if (strcmp(cmd_str, "get_sensor_filter") != 0) {
+        sensor_filter_config_t cfg = {0};
+        const cJSON *item;
+        uint8_t sensor = parse_sensor_id(cJSON_GetObjectItem(json, "sensor"));
+        item = cJSON_GetObjectItem(json, "channel");
+        uint8_t channel = cJSON_IsNumber(item) ? (uint8_t)item->valueint : 0;
+
+        if (sensor == 0) {
+            ret = ESP_ERR_INVALID_ARG;
+        } else if (sensor_filter_get_config(sensor, channel, &cfg) != ESP_OK) {
+            // 新通道：不限范围、不滤波
+            cfg.sensor = sensor;
+            cfg.channel = channel;
+            cfg.min = INT32_MIN;
+            cfg.max = INT32_MAX;
+        }
+
+        if (ret == ESP_OK && strcmp(cmd_str, "calibrate_sensor") == 0) {
+            item = cJSON_GetObjectItem(json, "offset");
+            if (cJSON_IsNumber(item)) cfg.offset = sensor_filter_to_milli((float)item->valuedouble);
+            item = cJSON_GetObjectItem(json, "scale");
+            if (cJSON_IsNumber(item)) {
+                cfg.scale = item->valuedouble > 0 ? (int32_t)(item->valuedouble * SENSOR_FILTER_SCALE_ONE + 0.5) : -1;
+            }
+        } else if (ret == ESP_OK) {
+            item = cJSON_GetObjectItem(json, "median");
+            if (cJSON_IsNumber(item)) cfg.median_n = item->valueint > 0 ? (uint8_t)item->valueint : 0;
+            item = cJSON_GetObjectItem(json, "hampel");
+            if (cJSON_IsNumber(item)) cfg.hampel_n = item->valueint > 0 ? (uint8_t)item->valueint : 0;
+            item = cJSON_GetObjectItem(json, "hampel_k");
+            if (cJSON_IsNumber(item)) cfg.hampel_k_x10 = item->valuedouble > 0 ? (uint16_t)(item->valuedouble * 10 + 0.5) : 0;
+            item = cJSON_GetObjectItem(json, "hampel_floor");
+            if (cJSON_IsNumber(item)) cfg.hampel_floor = sensor_filter_to_milli((float)item->valuedouble);
+            item = cJSON_GetObjectItem(json, "ema_alpha");
+            if (cJSON_IsNumber(item)) {
+                cfg.ema_alpha = item->valuedouble >= 0 && item->valuedouble <= 1
+                    ? (uint16_t)(item->valuedouble * SENSOR_FILTER_EMA_ONE + 0.5) : UINT16_MAX;
+            }
+            item = cJSON_GetObjectItem(json, "min");
+            if (cJSON_IsNumber(item)) cfg.min = sensor_filter_to_milli((float)item->valuedouble);
+            item = cJSON_GetObjectItem(json, "max");
+            if (cJSON_IsNumber(item)) cfg.max = sensor_filter_to_milli((float)item->valuedouble);
+        }
+
+        if (ret == ESP_OK) {
+            ret = sensor_filter_configure(&cfg);
+        }
+        if (ret == ESP_OK) {
+            config_cache_update(store_sensor_filters, NULL);
+        }
+    }
+
+    publish_status_response("sensor_filter", ret, sensor_filter_status_json, "channels", response_size);
+    ESP_LOGI(TAG, "🎚️ 滤波命令 %s: %s", cmd_str, ret == ESP_OK ? "ok" : esp_err_to_name(ret));
+}
+
 /**
  * @brief MQTT事件处理
  */
@@ -146,8 +646,59 @@ static void mqtt_event_callback(const mqtt_event_data_t *event_data) {
                         ESP_LOGI(TAG, "📝 命令类型: '%s'", cmd_str);
                     }
                     
+                    if (cmd_str && strcmp(cmd_str, "get_log") == 0) {
+                        handle_get_log_command(json);
+                        cJSON_Delete(json);
+                        free(payload);
+                        return;
+                    }
+                    
+                    if (cmd_str && strcmp(cmd_str, "get_status") == 0) {
+                        cJSON_Delete(json);
+                        free(payload);
+                        handle_get_status_command();
+                        return;
+                    }
+                    
+                    if (cmd_str && (strcmp(cmd_str, "trace_start") == 0 ||
+                                    strcmp(cmd_str, "trace_stop") == 0 ||
+                                    strcmp(cmd_str, "get_trace") == 0)) {
+                        handle_trace_command(cmd_str, json);
+                        cJSON_Delete(json);
+                        free(payload);
+                        return;
+                    }
+                    
+                    if (cmd_str && (strcmp(cmd_str, "set_alarm_threshold") == 0 ||
+                                    strcmp(cmd_str, "clear_alarm") == 0 ||
+                                    strcmp(cmd_str, "get_alarms") == 0)) {
+                        handle_alarm_command(cmd_str, json);
+                        cJSON_Delete(json);
+                        free(payload);
+                        return;
+                    }
+                    
+                    if (cmd_str && (strcmp(cmd_str, "set_report_policy") == 0 ||
+                                    strcmp(cmd_str, "get_report_policy") == 0)) {
+                        handle_report_command(cmd_str, json);
+                        cJSON_Delete(json);
+                        free(payload);
+                        return;
+                    }
+                    
+                    if (cmd_str && (strcmp(cmd_str, "calibrate_sensor") == 0 ||
+                                    strcmp(cmd_str, "set_sensor_filter") == 0 ||
+                                    strcmp(cmd_str, "get_sensor_filter") == 0)) {
+                        handle_sensor_filter_command(cmd_str, json);
+                        cJSON_Delete(json);
+                        free(payload);
+                        return;
+                    }
+                    
                     bool is_preset = (cmd_str && strcmp(cmd_str, "preset") == 0);
                     cJSON_Delete(json);
+                    int64_t exec_start = metrics_now_us();
+                    bool exec_ok = false;
                     
                     if (is_preset) {
                         // 预设命令处理
@@ -156,7 +707,8 @@ static void mqtt_event_callback(const mqtt_event_data_t *event_data) {
                         if (ret == ESP_OK) {
                             preset_control_result_t preset_result;
                             ret = preset_control_execute(&preset_cmd, &preset_result);
-                            if (ret == ESP_OK && preset_result.success) {
+                            exec_ok = (ret == ESP_OK && preset_result.success);
+                            if (exec_ok) {
                                 ESP_LOGI(TAG, "✅ 预设命令执行成功");
                             } else {
                                 ESP_LOGE(TAG, "❌ 预设命令执行失败: %s", 
@@ -171,7 +723,8 @@ static void mqtt_event_callback(const mqtt_event_data_t *event_data) {
                         if (ret == ESP_OK) {
                             device_control_result_t device_result;
                             ret = device_control_execute(&device_cmd, &device_result);
-                            if (ret == ESP_OK && device_result.success) {
+                            exec_ok = (ret == ESP_OK && device_result.success);
+                            if (exec_ok) {
                                 ESP_LOGI(TAG, "✅ 设备控制命令执行成功");
                             } else {
                                 ESP_LOGE(TAG, "❌ 设备控制命令执行失败: %s", 
@@ -181,6 +734,9 @@ static void mqtt_event_callback(const mqtt_event_data_t *event_data) {
                             ESP_LOGE(TAG, "❌ 命令解析失败: %s", esp_err_to_name(ret));
                         }
                     }
+                    
+                    metric_observe_since_ms(&s_m_cmd_exec_ms, exec_start);
+                    metric_inc(exec_ok ? &s_m_cmd_ok : &s_m_cmd_fail);
                 } else {
                     ESP_LOGE(TAG, "❌ JSON解析失败");
                 }
@@ -196,6 +752,7 @@ static void mqtt_event_callback(const mqtt_event_data_t *event_data) {
         case MQTT_EVENT_CONNECTED:
             ESP_LOGI(TAG, "✅ MQTT已连接");
             s_mqtt_connected = true;
+            live_provision_mark(LIVE_PROVISION_MARK_MQTT);
             update_stage(STARTUP_STAGE_MQTT_CONNECT, "Connected OK");
             
             // 连接成功后订阅控制主题（用于接收服务器命令）
@@ -263,6 +820,33 @@ static esp_err_t init_nvs(void) {
     return ret;
 }
 
+/**
+ * @brief 注册WiFi/IP事件处理（启动和配网后继续启动共用，只注册一次）
+ */
+static esp_err_t register_wifi_handlers(void) {
+    if (s_wifi_handler) {
+        return ESP_OK;
+    }
+    if (!s_wifi_event_group) {
+        s_wifi_event_group = xEventGroupCreate();
+        if (!s_wifi_event_group) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    esp_err_t ret = esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID,
+                                                        &wifi_event_handler, NULL, &s_wifi_handler);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
+                                              &wifi_event_handler, NULL, &s_ip_handler);
+    if (ret != ESP_OK) {
+        esp_event_handler_instance_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, s_wifi_handler);
+        s_wifi_handler = NULL;
+    }
+    return ret;
+}
+
 /**
  * @brief 检查并连接WiFi
  */
@@ -298,7 +882,6 @@ static esp_err_t connect_wifi(void) {
     snprintf(wifi_msg, sizeof(wifi_msg), "Connect to: %s", wifi_cfg.ssid);
     update_stage(STARTUP_STAGE_WIFI_CONNECT, wifi_msg);
     
-    s_wifi_event_group = xEventGroupCreate();
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
     esp_netif_create_default_wifi_sta();
@@ -307,16 +890,7 @@ static esp_err_t connect_wifi(void) {
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
     
     // 注册WiFi事件
-    ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT,
-                                                         ESP_EVENT_ANY_ID,
-                                                         &wifi_event_handler,
-                                                         NULL,
-                                                         NULL));
-    ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT,
-                                                         IP_EVENT_STA_GOT_IP,
-                                                         &wifi_event_handler,
-                                                         NULL,
-                                                         NULL));
+    ESP_ERROR_CHECK(register_wifi_handlers());
     
     // 配置并启动WiFi
     wifi_config_t wifi_config = {
@@ -393,7 +967,7 @@ static esp_err_t get_device_config(void) {
     }
     snprintf(server_msg, sizeof(server_msg), "Server: %.40s", server_display);
     update_stage(STARTUP_STAGE_GET_CONFIG, server_msg);
-    vTaskDelay(pdMS_TO_TICKS(1500)); // Display for 1.5s
+    ui_pause(1500); // Display for 1.5s
     
     // 获取设备配置
     update_stage(STARTUP_STAGE_GET_CONFIG, "Fetching Info...");
@@ -414,7 +988,7 @@ static esp_err_t get_device_config(void) {
         char uuid_msg[64];
         snprintf(uuid_msg, sizeof(uuid_msg), "UUID: %.50s", s_config.device_uuid);
         update_stage(STARTUP_STAGE_GET_CONFIG, uuid_msg);
-        vTaskDelay(pdMS_TO_TICKS(1500)); // Display success for 1.5s
+        ui_pause(1500); // Display success for 1.5s
         s_device_not_registered = false;  // 清除标记
         return ESP_OK;
     } else if (ret == ESP_ERR_NOT_FOUND) {
@@ -461,7 +1035,7 @@ static esp_err_t check_and_update_ota(void) {
     if (!s_config.has_firmware_update) {
         ESP_LOGI(TAG, "✅ 固件已是最新版本");
         update_stage(STARTUP_STAGE_CHECK_OTA, "Already Latest");
-        vTaskDelay(pdMS_TO_TICKS(1500)); // Display for 1.5s
+        ui_pause(1500); // Display for 1.5s
         return ESP_OK;
     }
     
@@ -494,6 +1068,7 @@ static esp_err_t check_and_update_ota(void) {
         vTaskDelay(pdMS_TO_TICKS(2000));
         
         // 重启
+        config_cache_flush();
         esp_restart();
     } else {
         ESP_LOGE(TAG, "❌ OTA更新失败");
@@ -512,7 +1087,7 @@ static esp_err_t connect_mqtt(void) {
     if (!s_config.has_mqtt_config) {
         ESP_LOGW(TAG, "⚠️ 无MQTT配置");
         update_stage(STARTUP_STAGE_MQTT_CONNECT, "No MQTT Config");
-        vTaskDelay(pdMS_TO_TICKS(1500)); // Display warning for 1.5s
+        ui_pause(1500); // Display warning for 1.5s
         return ESP_OK; // 不是致命错误
     }
     
@@ -520,7 +1095,7 @@ static esp_err_t connect_mqtt(void) {
     char mqtt_msg[64];
     snprintf(mqtt_msg, sizeof(mqtt_msg), "MQTT: %.40s", s_config.mqtt_broker);
     update_stage(STARTUP_STAGE_MQTT_CONNECT, mqtt_msg);
-    vTaskDelay(pdMS_TO_TICKS(1500)); // Display for 1.5s
+    ui_pause(1500); // Display for 1.5s
     
     // 初始化MQTT客户端
     mqtt_config_t mqtt_config = {0};
@@ -559,7 +1134,7 @@ static esp_err_t connect_mqtt(void) {
     for (int i = 0; i < 20; i++) {
         if (s_mqtt_connected) {
             ESP_LOGI(TAG, "✅ MQTT连接成功");
-            vTaskDelay(pdMS_TO_TICKS(1000));
+            ui_pause(1000);
             return ESP_OK;
         }
         vTaskDelay(pdMS_TO_TICKS(500));
@@ -567,7 +1142,7 @@ static esp_err_t connect_mqtt(void) {
     
     ESP_LOGW(TAG, "⚠️ MQTT连接超时（后台继续尝试）");
     update_stage(STARTUP_STAGE_MQTT_CONNECT, "Connecting...");
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    ui_pause(1000);
     
     return ESP_OK; // 不阻塞启动流程
 }
@@ -579,10 +1154,101 @@ static esp_err_t init_sensors(void) {
     update_stage(STARTUP_STAGE_SENSORS_INIT, "Initializing...");
     
     // TODO: 初始化DHT11, DS18B20等传感器
-    vTaskDelay(pdMS_TO_TICKS(800));
+    ui_pause(800);
     
     update_stage(STARTUP_STAGE_SENSORS_INIT, "Init Complete");
-    vTaskDelay(pdMS_TO_TICKS(1500)); // Display success for 1.5s
+    ui_pause(1500); // Display success for 1.5s
+    
+    return ESP_OK;
+}
+
+/**
+ * @brief WiFi连接之后的启动阶段（获取配置、OTA、MQTT、功能模块、传感器）
+ */
+static esp_err_t run_online_stages(void) {
+    esp_err_t ret;
+    
+    // 3.5. WiFi连接成功后重新初始化按钮（WiFi初始化后需要重新配置GPIO以确保按钮中断正常工作）
+    if (s_button_event_callback != NULL) {
+        ESP_LOGI(TAG, "📋 WiFi初始化后重新启用按键中断...");
+        ret = button_handler_reinit_after_wifi();
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "⚠️ 按钮重新初始化失败: %s", esp_err_to_name(ret));
+        } else {
+            ESP_LOGI(TAG, "✅ 按键中断重新启用成功");
+        }
+    }
+    
+    // 4. 获取设备配置
+    ret = get_device_config();
+    if (ret != ESP_OK) {
+        http_session_close();
+        return ret;
+    }
+    
+    // 5. 检查并执行OTA更新
+    update_stage(STARTUP_STAGE_CHECK_OTA, "Checking Updates...");
+    ret = check_and_update_ota();
+    if (ret != ESP_OK && ret != ESP_ERR_NOT_FOUND) {
+        // OTA失败不是致命错误，继续运行
+        ESP_LOGW(TAG, "⚠️ OTA更新跳过");
+    }
+    
+    // 5.5. 启动阶段的REST请求已结束，关闭共享HTTP会话（释放连接和TLS上下文）
+    http_session_close();
+    
+    // 6. 连接MQTT
+    ret = connect_mqtt();
+    if (ret != ESP_OK) {
+        // MQTT失败不是致命错误
+        ESP_LOGW(TAG, "⚠️ MQTT连接跳过");
+    }
+    
+    // 6.5. 初始化设备控制模块和预设控制模块
+    if (!s_modules_ready) {
+        ESP_LOGI(TAG, "📋 初始化设备控制模块...");
+        ret = device_control_init();
+        if (ret == ESP_OK) {
+            ESP_LOGI(TAG, "✅ 设备控制模块初始化成功");
+        } else {
+            ESP_LOGE(TAG, "❌ 设备控制模块初始化失败: %s", esp_err_to_name(ret));
+        }
+    
+        ESP_LOGI(TAG, "📋 初始化预设控制模块...");
+        ret = preset_control_init();
+        if (ret == ESP_OK) {
+            ESP_LOGI(TAG, "✅ 预设控制模块初始化成功");
+        } else {
+            ESP_LOGE(TAG, "❌ 预设控制模块初始化失败: %s", esp_err_to_name(ret));
+        }
+    
+        ESP_LOGI(TAG, "📋 初始化PWM控制模块...");
+        ret = pwm_control_init();
+        if (ret == ESP_OK) {
+            ESP_LOGI(TAG, "✅ PWM控制模块初始化成功");
+        } else {
+            ESP_LOGE(TAG, "❌ PWM控制模块初始化失败: %s", esp_err_to_name(ret));
+        }
+    
+        s_modules_ready = true;
+    }
+    
+    // 7. 初始化传感器
+    ret = init_sensors();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "⚠️ 传感器初始化失败");
+    }
+    
+    // 8. 启动完成
+    update_stage(STARTUP_STAGE_COMPLETED, "Startup Complete");
+    ui_pause(2000); // Display completion for 2s before switching to detailed info
+    
+    ESP_LOGI(TAG, "========================================");
+    ESP_LOGI(TAG, "  ✅ 设备启动完成");
+    ESP_LOGI(TAG, "  Device ID: %s", s_config.device_id);
+    ESP_LOGI(TAG, "  Device UUID: %s", s_config.device_uuid);
+    ESP_LOGI(TAG, "  MQTT: %s", s_mqtt_connected ? "已连接" : "未连接");
+    ESP_LOGI(TAG, "========================================");
     
     return ESP_OK;
 }
@@ -632,6 +1298,7 @@ esp_err_t startup_manager_run(void *display, startup_status_callback_t status_ca
     }
     
     // 2.5. 在启动早期初始化按钮处理模块（NVS初始化后即可初始化，支持启动时随时长按Boot进入配网）
+    //      app_main已提前初始化（开始启动窗口）时这里只更新回调
     if (s_button_event_callback != NULL) {
         ESP_LOGI(TAG, "📋 初始化按钮处理模块（早期初始化，支持启动时随时长按Boot进入配网）...");
         ret = button_handler_init(s_button_event_callback);
@@ -644,87 +1311,74 @@ esp_err_t startup_manager_run(void *display, startup_status_callback_t status_ca
         ESP_LOGI(TAG, "ℹ️ 未提供按钮回调，跳过按钮初始化");
     }
     
-    // 3. 连接WiFi
-    ret = connect_wifi();
-    if (ret != ESP_OK) {
-        return ret;
+    // 2.6. 启动窗口结果：按键输入初始化时开始计时，通常在LCD初始化期间已过去大半；
+    //      窗口未结束时按秒等待并在LCD上显示剩余时间，不额外延长启动
+    bool boot_held = false;
+    int64_t boot_deadline_us = esp_timer_get_time() +
+        (int64_t)(CONFIG_BUTTON_INPUT_BOOT_WINDOW_MS + CONFIG_BUTTON_INPUT_BOOT_HOLD_MS) * 1000;
+    while ((ret = button_handler_boot_held(&boot_held)) == ESP_ERR_NOT_FINISHED &&
+           esp_timer_get_time() < boot_deadline_us) {
+        uint32_t remaining_ms = button_handler_boot_remaining_ms();
+        if (s_display) {
+            char countdown_msg[32];
+            snprintf(countdown_msg, sizeof(countdown_msg), "Boot key -> Config (%us)",
+                     (unsigned)((remaining_ms + 999) / 1000));
+            simple_display_show_startup_step(s_display, "Detect", countdown_msg);
+        }
+        uint32_t slice_ms = remaining_ms % 1000;
+        button_handler_wait_boot(&boot_held, slice_ms ? slice_ms : 1000);
     }
-    
-    // 3.5. WiFi连接成功后重新初始化按钮（WiFi初始化后需要重新配置GPIO以确保按钮中断正常工作）
-    if (s_button_event_callback != NULL) {
-        ESP_LOGI(TAG, "📋 WiFi初始化后重新启用按键中断...");
-        ret = button_handler_reinit_after_wifi();
-        if (ret != ESP_OK) {
-            ESP_LOGW(TAG, "⚠️ 按钮重新初始化失败: %s", esp_err_to_name(ret));
-        } else {
-            ESP_LOGI(TAG, "✅ 按键中断重新启用成功");
+    if (ret == ESP_OK && boot_held) {
+        ESP_LOGW(TAG, "🔘 启动时按住Boot按键，设置强制配网标志");
+        wifi_config_set_force_flag();
+        if (s_display) {
+            simple_display_show_startup_step(s_display, "Boot Key", "Enter Config Mode!");
         }
+        if (s_status_callback) {
+            s_status_callback(STARTUP_STAGE_INIT, "Boot key: Config mode");
+        }
+    } else if (ret == ESP_ERR_NOT_FINISHED) {
+        ESP_LOGW(TAG, "⚠️ Boot按键启动窗口未结束，按正常启动处理");
     }
     
-    // 4. 获取设备配置
-    ret = get_device_config();
+    // 3. 连接WiFi
+    ret = connect_wifi();
     if (ret != ESP_OK) {
         return ret;
     }
     
-    // 5. 检查并执行OTA更新
-    update_stage(STARTUP_STAGE_CHECK_OTA, "Checking Updates...");
-    ret = check_and_update_ota();
-    if (ret != ESP_OK && ret != ESP_ERR_NOT_FOUND) {
-        // OTA失败不是致命错误，继续运行
-        ESP_LOGW(TAG, "⚠️ OTA更新跳过");
-    }
+    return run_online_stages();
+}
+
+esp_err_t startup_manager_resume(void) {
+    ESP_LOGI(TAG, "========================================");
+    ESP_LOGI(TAG, "  配网完成，继续启动（不重启）");
+    ESP_LOGI(TAG, "========================================");
     
-    // 6. 连接MQTT
-    ret = connect_mqtt();
+    s_live_resume = true;
+    s_retry_num = 0;
+    s_device_not_registered = false;
+    esp_err_t ret = register_wifi_handlers();
     if (ret != ESP_OK) {
-        // MQTT失败不是致命错误
-        ESP_LOGW(TAG, "⚠️ MQTT连接跳过");
-    }
-    
-    // 6.5. 初始化设备控制模块和预设控制模块
-    ESP_LOGI(TAG, "📋 初始化设备控制模块...");
-    ret = device_control_init();
-    if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "✅ 设备控制模块初始化成功");
-    } else {
-        ESP_LOGE(TAG, "❌ 设备控制模块初始化失败: %s", esp_err_to_name(ret));
-    }
-    
-    ESP_LOGI(TAG, "📋 初始化预设控制模块...");
-    ret = preset_control_init();
-    if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "✅ 预设控制模块初始化成功");
-    } else {
-        ESP_LOGE(TAG, "❌ 预设控制模块初始化失败: %s", esp_err_to_name(ret));
+        s_live_resume = false;
+        return ret;
     }
+    update_stage(STARTUP_STAGE_WIFI_CONNECT, "Connected");
     
-    ESP_LOGI(TAG, "📋 初始化PWM控制模块...");
-    ret = pwm_control_init();
-    if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "✅ PWM控制模块初始化成功");
-    } else {
-        ESP_LOGE(TAG, "❌ PWM控制模块初始化失败: %s", esp_err_to_name(ret));
+    ret = run_online_stages();
+    s_live_resume = false;
+    return ret;
+}
+
+void startup_manager_release_wifi(void) {
+    if (s_ip_handler) {
+        esp_event_handler_instance_unregister(IP_EVENT, IP_EVENT_STA_GOT_IP, s_ip_handler);
+        s_ip_handler = NULL;
     }
-    
-    // 7. 初始化传感器
-    ret = init_sensors();
-    if (ret != ESP_OK) {
-        ESP_LOGW(TAG, "⚠️ 传感器初始化失败");
+    if (s_wifi_handler) {
+        esp_event_handler_instance_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, s_wifi_handler);
+        s_wifi_handler = NULL;
     }
-    
-    // 8. 启动完成
-    update_stage(STARTUP_STAGE_COMPLETED, "Startup Complete");
-    vTaskDelay(pdMS_TO_TICKS(2000)); // Display completion for 2s before switching to detailed info
-    
-    ESP_LOGI(TAG, "========================================");
-    ESP_LOGI(TAG, "  ✅ 设备启动完成");
-    ESP_LOGI(TAG, "  Device ID: %s", s_config.device_id);
-    ESP_LOGI(TAG, "  Device UUID: %s", s_config.device_uuid);
-    ESP_LOGI(TAG, "  MQTT: %s", s_mqtt_connected ? "已连接" : "未连接");
-    ESP_LOGI(TAG, "========================================");
-    
-    return ESP_OK;
 }
 
 startup_stage_t startup_manager_get_stage(void) {
@@ -48,6 +48,27 @@ typedef void (*startup_status_callback_t)(startup_stage_t stage, const char *mes
  */
 esp_err_t startup_manager_run(void *display, startup_status_callback_t status_callback, button_event_cb_t button_callback);
 
+/**
+ * @brief 配网后不重启，继续执行WiFi之后的启动阶段
+ *
+ * 由不重启配网（live_provision）在STA已获取IP、配置已保存后调用：
+ * 获取设备配置、OTA检查、连接MQTT、初始化功能模块。跳过各阶段的显示停留。
+ * 需先调用过 startup_manager_run()（提供显示句柄和回调）。
+ *
+ * @return
+ *   - ESP_OK: 启动成功
+ *   - 其他: 获取设备配置失败等
+ */
+esp_err_t startup_manager_resume(void);
+
+/**
+ * @brief 注销启动流程的WiFi事件处理（运行中重新配网前调用）
+ *
+ * 启动流程的处理器在STA启动/断开时会自动重连旧网络，会和配网任务的连接抢占。
+ * 配网成功后 startup_manager_resume() 重新注册。
+ */
+void startup_manager_release_wifi(void);
+
 /**
  * @brief 获取当前启动阶段
  * 
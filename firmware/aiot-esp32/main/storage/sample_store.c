@@ -0,0 +1,715 @@
+/**
+ * @file sample_store.c
+ * @brief 传感器历史数据存储实现（userdata分区，日志结构）
+ *
+ * Flash布局（每个4KB扇区）：
+ *   [扇区头 32B][记录0 16B][记录1 16B] ... [记录253 16B]
+ *
+ * - 扇区头在擦除后立即写入，seq为0表示空闲扇区，seq>=1为日志扇区
+ * - 日志扇区在物理上连续（循环），seq连续递增；seq最大者为写入扇区
+ * - 未写入的记录槽全为0xFF，写入扇区中的写位置通过二分查找恢复
+ * - 写断的记录CRC校验失败，读取时跳过
+ */
+
+#include "sample_store.h"
+#include <string.h>
+#include <stdlib.h>
+#include "esp_log.h"
+
+#ifdef ESP_PLATFORM
+#include "esp_partition.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#else
+#include <time.h>
+#endif
+
+static const char *TAG = "SAMPLE_STORE";
+
+#define SECTOR_MAGIC            0x52545353  // "SSTR"
+#define SECTOR_VERSION          1
+#define NO_TIMESTAMP            0xFFFFFFFF
+#define QUERY_CHUNK_RECORDS     16          // 查询时每次读取的记录数（256字节）
+
+// 扇区头（32字节）
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t seq;                  // 日志序号，0=空闲扇区
+    uint32_t erase_count;          // 本扇区擦除次数
+    uint16_t version;
+    uint16_t record_size;
+    uint8_t reserved[14];          // 保持0xFF
+    uint16_t crc;                  // 前30字节的CRC16
+} sector_header_t;
+
+// 记录（16字节）
+typedef struct __attribute__((packed)) {
+    uint32_t timestamp;
+    float value;
+    uint8_t sensor_id;
+    uint8_t channel;
+    uint16_t flags;
+    uint16_t reserved;             // 保持0xFFFF
+    uint16_t crc;                  // 前14字节的CRC16
+} flash_record_t;
+
+_Static_assert(sizeof(sector_header_t) == SAMPLE_STORE_HEADER_SIZE, "sector header size");
+_Static_assert(sizeof(flash_record_t) == SAMPLE_STORE_RECORD_SIZE, "record size");
+
+// 存储状态
+static struct {
+    bool mounted;
+    sample_store_flash_t flash;
+    uint32_t sector_count;
+    uint32_t tail;                 // 最旧日志扇区（物理序号）
+    uint32_t head;                 // 写入扇区（物理序号）
+    uint32_t used;                 // 日志扇区数
+    uint32_t head_seq;
+    uint32_t head_slot;            // 写入扇区中下一个空记录槽
+    uint32_t max_erase_count;
+    uint32_t record_count;
+    uint32_t last_timestamp;       // 最新记录时间戳
+    uint32_t time_offset;          // 挂载时的存储时间
+    uint32_t corrupt_records;
+    uint32_t *first_ts;            // 稀疏时间索引：每个物理扇区首条记录时间戳
+} s_store;
+
+#ifdef ESP_PLATFORM
+static SemaphoreHandle_t s_mutex = NULL;
+#define STORE_LOCK()    do { if (s_mutex) xSemaphoreTake(s_mutex, portMAX_DELAY); } while (0)
+#define STORE_UNLOCK()  do { if (s_mutex) xSemaphoreGive(s_mutex); } while (0)
+#else
+#define STORE_LOCK()    do { } while (0)
+#define STORE_UNLOCK()  do { } while (0)
+#endif
+
+/* ==================== 工具函数 ==================== */
+
+// CRC-16/CCITT-FALSE（半字节查表，表仅32字节）
+static uint16_t crc16(const void *data, size_t len)
+{
+    static const uint16_t table[16] = {
+        0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+        0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    };
+    const uint8_t *p = (const uint8_t *)data;
+    uint16_t crc = 0xFFFF;
+
+    while (len--) {
+        crc = (uint16_t)((crc << 4) ^ table[((crc >> 12) ^ (*p >> 4)) & 0x0F]);
+        crc = (uint16_t)((crc << 4) ^ table[((crc >> 12) ^ (*p & 0x0F)) & 0x0F]);
+        p++;
+    }
+    return crc;
+}
+
+static uint32_t uptime_seconds(void)
+{
+#ifdef ESP_PLATFORM
+    return (uint32_t)(esp_timer_get_time() / 1000000);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)ts.tv_sec;
+#endif
+}
+
+static inline uint32_t sector_offset(uint32_t sector)
+{
+    return sector * SAMPLE_STORE_SECTOR_SIZE;
+}
+
+static inline uint32_t record_offset(uint32_t sector, uint32_t slot)
+{
+    return sector_offset(sector) + SAMPLE_STORE_HEADER_SIZE + slot * SAMPLE_STORE_RECORD_SIZE;
+}
+
+// 逻辑序号（0=最旧）转物理扇区
+static inline uint32_t logical_to_sector(uint32_t logical)
+{
+    return (s_store.tail + logical) % s_store.sector_count;
+}
+
+// 扇区中已写入的记录槽数
+static inline uint32_t sector_slots(uint32_t sector)
+{
+    return sector == s_store.head ? s_store.head_slot : SAMPLE_STORE_RECORDS_PER_SECTOR;
+}
+
+static bool header_valid(const sector_header_t *hdr)
+{
+    return hdr->magic == SECTOR_MAGIC &&
+           hdr->version == SECTOR_VERSION &&
+           hdr->record_size == SAMPLE_STORE_RECORD_SIZE &&
+           hdr->crc == crc16(hdr, offsetof(sector_header_t, crc));
+}
+
+static bool slot_erased(const flash_record_t *rec)
+{
+    const uint8_t *p = (const uint8_t *)rec;
+    for (size_t i = 0; i < sizeof(*rec); i++) {
+        if (p[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool record_valid(const flash_record_t *rec)
+{
+    return rec->crc == crc16(rec, offsetof(flash_record_t, crc));
+}
+
+static esp_err_t read_record(uint32_t sector, uint32_t slot, flash_record_t *rec)
+{
+    return s_store.flash.read(s_store.flash.ctx, record_offset(sector, slot), rec, sizeof(*rec));
+}
+
+// 格式化扇区：擦除并写入扇区头
+static esp_err_t format_sector(uint32_t sector, uint32_t seq, uint32_t erase_count)
+{
+    sector_header_t hdr;
+    memset(&hdr, 0xFF, sizeof(hdr));
+    hdr.magic = SECTOR_MAGIC;
+    hdr.seq = seq;
+    hdr.erase_count = erase_count;
+    hdr.version = SECTOR_VERSION;
+    hdr.record_size = SAMPLE_STORE_RECORD_SIZE;
+    hdr.crc = crc16(&hdr, offsetof(sector_header_t, crc));
+
+    esp_err_t ret = s_store.flash.erase_sector(s_store.flash.ctx, sector_offset(sector));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (erase_count > s_store.max_erase_count) {
+        s_store.max_erase_count = erase_count;
+    }
+    return s_store.flash.write(s_store.flash.ctx, sector_offset(sector), &hdr, sizeof(hdr));
+}
+
+// 读取扇区当前擦除次数（从未格式化为0，扇区头损坏时按已知最大值估计）
+static uint32_t sector_erase_count(uint32_t sector)
+{
+    sector_header_t hdr;
+    if (s_store.flash.read(s_store.flash.ctx, sector_offset(sector), &hdr, sizeof(hdr)) != ESP_OK) {
+        return s_store.max_erase_count;
+    }
+    if (header_valid(&hdr)) {
+        return hdr.erase_count;
+    }
+    return hdr.magic == 0xFFFFFFFF ? 0 : s_store.max_erase_count;
+}
+
+// 扇区首条有效记录的时间戳（首条记录写断时向后查找）
+static uint32_t scan_first_timestamp(uint32_t sector)
+{
+    flash_record_t rec;
+    for (uint32_t slot = 0; slot < SAMPLE_STORE_RECORDS_PER_SECTOR; slot++) {
+        if (read_record(sector, slot, &rec) != ESP_OK || slot_erased(&rec)) {
+            break;
+        }
+        if (record_valid(&rec)) {
+            return rec.timestamp;
+        }
+    }
+    return NO_TIMESTAMP;
+}
+
+// 二分查找扇区中第一个空记录槽（已写入槽总在前，空槽在后）
+static uint32_t find_write_slot(uint32_t sector)
+{
+    uint32_t lo = 0;
+    uint32_t hi = SAMPLE_STORE_RECORDS_PER_SECTOR;
+    flash_record_t rec;
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (read_record(sector, mid, &rec) != ESP_OK || !slot_erased(&rec)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// 从最新记录往前找最后一条有效记录的时间戳
+static uint32_t find_last_timestamp(void)
+{
+    flash_record_t rec;
+
+    for (uint32_t l = s_store.used; l-- > 0;) {
+        uint32_t sector = logical_to_sector(l);
+        for (uint32_t slot = sector_slots(sector); slot-- > 0;) {
+            if (read_record(sector, slot, &rec) == ESP_OK && record_valid(&rec)) {
+                return rec.timestamp;
+            }
+        }
+    }
+    return 0;
+}
+
+/* ==================== 挂载 ==================== */
+
+esp_err_t sample_store_mount(const sample_store_flash_t *flash)
+{
+    if (flash == NULL || flash->read == NULL || flash->write == NULL || flash->erase_sector == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_store.mounted) {
+        return ESP_OK;
+    }
+
+    uint32_t sector_count = flash->size / SAMPLE_STORE_SECTOR_SIZE;
+    if (sector_count < 2) {
+        ESP_LOGE(TAG, "❌ 存储区太小: %lu 字节", (unsigned long)flash->size);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (sector_count > SAMPLE_STORE_MAX_SECTORS) {
+        sector_count = SAMPLE_STORE_MAX_SECTORS;
+    }
+
+    memset(&s_store, 0, sizeof(s_store));
+    s_store.flash = *flash;
+    s_store.sector_count = sector_count;
+
+    s_store.first_ts = malloc(sector_count * sizeof(uint32_t));
+    uint32_t *seqs = malloc(sector_count * sizeof(uint32_t));
+    if (s_store.first_ts == NULL || seqs == NULL) {
+        free(s_store.first_ts);
+        free(seqs);
+        s_store.first_ts = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 1. 扫描扇区头（连同首条记录一起读，每扇区一次Flash读取）
+    uint32_t head = 0;
+    uint32_t head_seq = 0;
+    struct __attribute__((packed)) {
+        sector_header_t hdr;
+        flash_record_t first;
+    } probe;
+
+    for (uint32_t i = 0; i < sector_count; i++) {
+        seqs[i] = 0;
+        s_store.first_ts[i] = NO_TIMESTAMP;
+
+        esp_err_t ret = flash->read(flash->ctx, sector_offset(i), &probe, sizeof(probe));
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "❌ 读取扇区 %lu 失败: %s", (unsigned long)i, esp_err_to_name(ret));
+            free(seqs);
+            free(s_store.first_ts);
+            s_store.first_ts = NULL;
+            return ret;
+        }
+        if (!header_valid(&probe.hdr)) {
+            continue;
+        }
+
+        seqs[i] = probe.hdr.seq;
+        if (probe.hdr.erase_count > s_store.max_erase_count) {
+            s_store.max_erase_count = probe.hdr.erase_count;
+        }
+        if (record_valid(&probe.first)) {
+            s_store.first_ts[i] = probe.first.timestamp;
+        } else if (!slot_erased(&probe.first)) {
+            s_store.first_ts[i] = scan_first_timestamp(i);
+        }
+        if (probe.hdr.seq > head_seq) {
+            head_seq = probe.hdr.seq;
+            head = i;
+        }
+    }
+
+    // 2. 从写入扇区往回走，seq连续的扇区组成日志
+    if (head_seq > 0) {
+        uint32_t used = 1;
+        while (used < sector_count) {
+            uint32_t prev = (head + sector_count - used) % sector_count;
+            if (seqs[prev] != head_seq - used) {
+                break;
+            }
+            used++;
+        }
+        s_store.head = head;
+        s_store.head_seq = head_seq;
+        s_store.used = used;
+        s_store.tail = (head + sector_count - (used - 1)) % sector_count;
+        s_store.head_slot = find_write_slot(head);
+
+        // 掉电写断的记录只可能出现在写入位置前一条
+        if (s_store.head_slot > 0) {
+            flash_record_t rec;
+            if (read_record(head, s_store.head_slot - 1, &rec) == ESP_OK && !record_valid(&rec)) {
+                s_store.corrupt_records++;
+            }
+        }
+
+        s_store.record_count = (used - 1) * SAMPLE_STORE_RECORDS_PER_SECTOR + s_store.head_slot;
+        s_store.last_timestamp = find_last_timestamp();
+    }
+    free(seqs);
+
+    s_store.time_offset = s_store.last_timestamp;
+    s_store.time_offset -= uptime_seconds() < s_store.time_offset ? uptime_seconds() : s_store.time_offset;
+
+#ifdef ESP_PLATFORM
+    if (s_mutex == NULL) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (s_mutex == NULL) {
+            free(s_store.first_ts);
+            s_store.first_ts = NULL;
+            return ESP_ERR_NO_MEM;
+        }
+    }
+#endif
+
+    s_store.mounted = true;
+    ESP_LOGI(TAG, "✅ 样本存储已挂载: %lu 扇区, 日志 %lu 扇区, %lu 条记录, 最新时间戳 %lu",
+             (unsigned long)sector_count, (unsigned long)s_store.used,
+             (unsigned long)s_store.record_count, (unsigned long)s_store.last_timestamp);
+    if (s_store.corrupt_records > 0) {
+        ESP_LOGW(TAG, "⚠️ 发现 %lu 条写断的记录（已跳过）", (unsigned long)s_store.corrupt_records);
+    }
+    return ESP_OK;
+}
+
+#ifdef ESP_PLATFORM
+static esp_err_t partition_read(void *ctx, uint32_t offset, void *buf, size_t len)
+{
+    return esp_partition_read((const esp_partition_t *)ctx, offset, buf, len);
+}
+
+static esp_err_t partition_write(void *ctx, uint32_t offset, const void *buf, size_t len)
+{
+    return esp_partition_write((const esp_partition_t *)ctx, offset, buf, len);
+}
+
+static esp_err_t partition_erase_sector(void *ctx, uint32_t offset)
+{
+    return esp_partition_erase_range((const esp_partition_t *)ctx, offset, SAMPLE_STORE_SECTOR_SIZE);
+}
+
+esp_err_t sample_store_init(void)
+{
+    const esp_partition_t *partition = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, SAMPLE_STORE_PARTITION_SUBTYPE, SAMPLE_STORE_PARTITION_LABEL);
+    if (partition == NULL) {
+        ESP_LOGW(TAG, "⚠️ 未找到 %s 分区，历史数据存储不可用", SAMPLE_STORE_PARTITION_LABEL);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    ESP_LOGI(TAG, "📦 %s 分区: 0x%lx, 大小 %lu KB", partition->label,
+             (unsigned long)partition->address, (unsigned long)(partition->size / 1024));
+
+    sample_store_flash_t flash = {
+        .read = partition_read,
+        .write = partition_write,
+        .erase_sector = partition_erase_sector,
+        .size = partition->size,
+        .ctx = (void *)partition,
+    };
+    return sample_store_mount(&flash);
+}
+#else
+esp_err_t sample_store_init(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+#endif
+
+esp_err_t sample_store_deinit(void)
+{
+    STORE_LOCK();
+    free(s_store.first_ts);
+    s_store.first_ts = NULL;
+    s_store.mounted = false;
+    STORE_UNLOCK();
+    return ESP_OK;
+}
+
+bool sample_store_is_ready(void)
+{
+    return s_store.mounted;
+}
+
+uint32_t sample_store_now(void)
+{
+    return s_store.time_offset + uptime_seconds();
+}
+
+/* ==================== 写入 ==================== */
+
+// 打开下一个扇区作为写入扇区，日志已满时淘汰最旧扇区
+static esp_err_t open_next_sector(void)
+{
+    uint32_t next = s_store.used == 0 ? s_store.head : (s_store.head + 1) % s_store.sector_count;
+
+    if (s_store.used == s_store.sector_count) {
+        s_store.record_count -= SAMPLE_STORE_RECORDS_PER_SECTOR;
+        s_store.tail = (s_store.tail + 1) % s_store.sector_count;
+        s_store.used--;
+    }
+
+    esp_err_t ret = format_sector(next, s_store.head_seq + 1, sector_erase_count(next) + 1);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "❌ 格式化扇区 %lu 失败: %s", (unsigned long)next, esp_err_to_name(ret));
+        return ret;
+    }
+
+    if (s_store.used == 0) {
+        s_store.tail = next;
+    }
+    s_store.head = next;
+    s_store.head_seq++;
+    s_store.head_slot = 0;
+    s_store.used++;
+    s_store.first_ts[next] = NO_TIMESTAMP;
+    return ESP_OK;
+}
+
+esp_err_t sample_store_append(const sample_store_record_t *record)
+{
+    if (record == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_store.mounted) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    STORE_LOCK();
+
+    esp_err_t ret = ESP_OK;
+    if (s_store.used == 0 || s_store.head_slot >= SAMPLE_STORE_RECORDS_PER_SECTOR) {
+        ret = open_next_sector();
+        if (ret != ESP_OK) {
+            STORE_UNLOCK();
+            return ret;
+        }
+    }
+
+    flash_record_t rec = {
+        .timestamp = record->timestamp < s_store.last_timestamp ? s_store.last_timestamp : record->timestamp,
+        .value = record->value,
+        .sensor_id = record->sensor_id,
+        .channel = record->channel,
+        .flags = record->flags,
+        .reserved = 0xFFFF,
+    };
+    rec.crc = crc16(&rec, offsetof(flash_record_t, crc));
+
+    // 写失败时记录槽可能已被部分写入，同样跳过，下次写下一个槽
+    uint32_t slot = s_store.head_slot++;
+    ret = s_store.flash.write(s_store.flash.ctx, record_offset(s_store.head, slot), &rec, sizeof(rec));
+    if (ret == ESP_OK) {
+        if (slot == 0 || s_store.first_ts[s_store.head] == NO_TIMESTAMP) {
+            s_store.first_ts[s_store.head] = rec.timestamp;
+        }
+        s_store.last_timestamp = rec.timestamp;
+        s_store.record_count++;
+    } else {
+        ESP_LOGE(TAG, "❌ 写入记录失败: %s", esp_err_to_name(ret));
+    }
+
+    STORE_UNLOCK();
+    return ret;
+}
+
+esp_err_t sample_store_append_now(uint8_t sensor_id, uint8_t channel, float value)
+{
+    sample_store_record_t record = {
+        .timestamp = sample_store_now(),
+        .value = value,
+        .sensor_id = sensor_id,
+        .channel = channel,
+        .flags = 0,
+    };
+    return sample_store_append(&record);
+}
+
+/* ==================== 查询 ==================== */
+
+// 在稀疏索引中二分查找：最后一个首条时间戳 < t_start 的逻辑扇区
+static uint32_t index_lower_bound(uint32_t t_start)
+{
+    uint32_t lo = 0;
+    uint32_t hi = s_store.used;
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (s_store.first_ts[logical_to_sector(mid)] < t_start) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo > 0 ? lo - 1 : 0;
+}
+
+// 扇区内二分查找第一条时间戳 >= t_start 的记录槽（损坏记录向后取最近有效记录）
+static uint32_t sector_lower_bound(uint32_t sector, uint32_t t_start)
+{
+    uint32_t lo = 0;
+    uint32_t hi = sector_slots(sector);
+    flash_record_t rec;
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint32_t probe = mid;
+        while (probe < hi && (read_record(sector, probe, &rec) != ESP_OK || !record_valid(&rec))) {
+            probe++;
+        }
+        if (probe == hi) {
+            hi = mid;
+        } else if (rec.timestamp < t_start) {
+            lo = probe + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+esp_err_t sample_store_query(uint32_t t_start, uint32_t t_end, uint8_t sensor_id,
+                             sample_store_query_cb_t callback, void *user_ctx,
+                             uint32_t *out_count)
+{
+    if (callback == NULL || t_start > t_end) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_store.mounted) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    STORE_LOCK();
+
+    uint32_t count = 0;
+    esp_err_t ret = ESP_OK;
+    bool done = s_store.used == 0;
+    uint32_t logical = done ? 0 : index_lower_bound(t_start);
+    uint32_t slot = done ? 0 : sector_lower_bound(logical_to_sector(logical), t_start);
+    flash_record_t chunk[QUERY_CHUNK_RECORDS];
+
+    while (!done && logical < s_store.used) {
+        uint32_t sector = logical_to_sector(logical);
+        uint32_t slots = sector_slots(sector);
+
+        while (!done && slot < slots) {
+            uint32_t n = slots - slot;
+            if (n > QUERY_CHUNK_RECORDS) {
+                n = QUERY_CHUNK_RECORDS;
+            }
+            ret = s_store.flash.read(s_store.flash.ctx, record_offset(sector, slot),
+                                     chunk, n * sizeof(flash_record_t));
+            if (ret != ESP_OK) {
+                done = true;
+                break;
+            }
+
+            for (uint32_t i = 0; i < n; i++) {
+                const flash_record_t *rec = &chunk[i];
+                if (!record_valid(rec) || rec->timestamp < t_start) {
+                    continue;
+                }
+                if (rec->timestamp > t_end) {
+                    done = true;
+                    break;
+                }
+                if (sensor_id != SAMPLE_STORE_ANY_SENSOR && rec->sensor_id != sensor_id) {
+                    continue;
+                }
+
+                sample_store_record_t out = {
+                    .timestamp = rec->timestamp,
+                    .value = rec->value,
+                    .sensor_id = rec->sensor_id,
+                    .channel = rec->channel,
+                    .flags = rec->flags,
+                };
+                count++;
+                if (!callback(&out, user_ctx)) {
+                    done = true;
+                    break;
+                }
+            }
+            slot += n;
+        }
+
+        logical++;
+        slot = 0;
+    }
+
+    STORE_UNLOCK();
+
+    if (out_count) {
+        *out_count = count;
+    }
+    return ret;
+}
+
+/* ==================== 状态与维护 ==================== */
+
+esp_err_t sample_store_get_stats(sample_store_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_store.mounted) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    STORE_LOCK();
+    memset(stats, 0, sizeof(*stats));
+    stats->sector_count = s_store.sector_count;
+    stats->sectors_used = s_store.used;
+    stats->record_count = s_store.record_count;
+    stats->newest_timestamp = s_store.last_timestamp;
+    stats->head_sector = s_store.head;
+    stats->head_seq = s_store.head_seq;
+    stats->max_erase_count = s_store.max_erase_count;
+    stats->corrupt_records = s_store.corrupt_records;
+    for (uint32_t l = 0; l < s_store.used; l++) {
+        uint32_t ts = s_store.first_ts[logical_to_sector(l)];
+        if (ts != NO_TIMESTAMP) {
+            stats->oldest_timestamp = ts;
+            break;
+        }
+    }
+    STORE_UNLOCK();
+    return ESP_OK;
+}
+
+esp_err_t sample_store_erase_all(void)
+{
+    if (!s_store.mounted) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    STORE_LOCK();
+
+    // 写入seq=0的空闲扇区头，保留擦除次数
+    esp_err_t ret = ESP_OK;
+    for (uint32_t i = 0; i < s_store.sector_count && ret == ESP_OK; i++) {
+        ret = format_sector(i, 0, sector_erase_count(i) + 1);
+        s_store.first_ts[i] = NO_TIMESTAMP;
+    }
+
+    // 下一次写入从当前写入扇区之后开始，避免总是先磨损0号扇区；
+    // seq继续递增，清空中途掉电时残留的旧扇区不会被误认为写入扇区
+    s_store.head = (s_store.head + 1) % s_store.sector_count;
+    s_store.tail = s_store.head;
+    s_store.used = 0;
+    s_store.head_slot = 0;
+    s_store.record_count = 0;
+    s_store.corrupt_records = 0;
+
+    STORE_UNLOCK();
+
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "🗑️ 历史数据已清空");
+    } else {
+        ESP_LOGE(TAG, "❌ 清空历史数据失败: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
@@ -0,0 +1,198 @@
+/**
+ * @file sample_store.h
+ * @brief 传感器历史数据存储（userdata分区，日志结构）
+ *
+ * 在partitions.csv预留的userdata分区（data, 0x40）上实现只追加的时序数据存储：
+ * - 每个扇区（4KB）= 32字节扇区头 + 254条16字节定长记录，记录不跨扇区
+ * - 扇区头带单调递增序号，上电时扫描扇区头即可恢复写位置（掉电安全）
+ * - 扇区按物理顺序循环使用，写满后擦除最旧扇区（天然轮转磨损均衡）
+ * - RAM中保存每个扇区的首条时间戳（稀疏时间索引），区间查询无需全盘扫描
+ *
+ * 存储只依赖 sample_store_flash_t 描述的读/写/擦除操作：
+ * 设备上使用 esp_partition，主机上可以换成文件模拟的Flash。
+ */
+
+#ifndef SAMPLE_STORE_H
+#define SAMPLE_STORE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// userdata分区（partitions.csv: userdata, data, 0x40）
+#define SAMPLE_STORE_PARTITION_LABEL    "userdata"
+#define SAMPLE_STORE_PARTITION_SUBTYPE  0x40
+
+#define SAMPLE_STORE_SECTOR_SIZE        4096    ///< Flash擦除单位
+#define SAMPLE_STORE_HEADER_SIZE        32      ///< 扇区头大小
+#define SAMPLE_STORE_RECORD_SIZE        16      ///< 单条记录大小（满足Flash加密16字节对齐）
+#define SAMPLE_STORE_RECORDS_PER_SECTOR \
+    ((SAMPLE_STORE_SECTOR_SIZE - SAMPLE_STORE_HEADER_SIZE) / SAMPLE_STORE_RECORD_SIZE)
+
+#define SAMPLE_STORE_MAX_SECTORS        1024    ///< 最多管理4MB分区（时间索引占4KB RAM）
+#define SAMPLE_STORE_ANY_SENSOR         0xFF    ///< 查询时匹配所有传感器
+
+/**
+ * @brief 传感器ID（写入记录的sensor_id字段）
+ */
+typedef enum {
+    SAMPLE_SENSOR_DHT11 = 1,       ///< DHT11（通道0=温度，通道1=湿度）
+    SAMPLE_SENSOR_DS18B20 = 2,     ///< DS18B20（通道0=温度）
+    SAMPLE_SENSOR_RAIN = 3,        ///< 雨水传感器（通道0=是否下雨）
+    SAMPLE_SENSOR_DHT22 = 4,       ///< DHT22（通道0=温度，通道1=湿度）
+    SAMPLE_SENSOR_BH1750 = 5,      ///< BH1750（通道0=照度lx）
+    SAMPLE_SENSOR_BMP280 = 6,      ///< BMP280（通道0=温度，通道1=气压hPa）
+    SAMPLE_SENSOR_MPU6050 = 7,     ///< MPU6050（通道见驱动描述符）
+    SAMPLE_SENSOR_MQ2 = 8,         ///< MQ2气体传感器（通道0=浓度）
+    SAMPLE_SENSOR_HCSR04 = 9,      ///< HC-SR04超声波测距（通道0=距离cm）
+} sample_sensor_id_t;
+
+/**
+ * @brief 一条历史样本
+ */
+typedef struct {
+    uint32_t timestamp;            ///< 时间戳（秒，见 sample_store_now()）
+    float value;                   ///< 数值
+    uint8_t sensor_id;             ///< 传感器ID（sample_sensor_id_t）
+    uint8_t channel;               ///< 传感器通道
+    uint16_t flags;                ///< 附加标志（应用自定义）
+} sample_store_record_t;
+
+/**
+ * @brief Flash访问接口（偏移量均相对于存储区起点）
+ */
+typedef struct {
+    esp_err_t (*read)(void *ctx, uint32_t offset, void *buf, size_t len);
+    esp_err_t (*write)(void *ctx, uint32_t offset, const void *buf, size_t len);
+    esp_err_t (*erase_sector)(void *ctx, uint32_t offset);
+    uint32_t size;                 ///< 存储区大小（字节，按扇区向下取整使用）
+    void *ctx;                     ///< 传给上述函数的上下文
+} sample_store_flash_t;
+
+/**
+ * @brief 存储状态统计
+ */
+typedef struct {
+    uint32_t sector_count;         ///< 存储区扇区总数
+    uint32_t sectors_used;         ///< 已有数据的扇区数
+    uint32_t record_count;         ///< 当前可查询的记录数
+    uint32_t oldest_timestamp;     ///< 最早记录时间戳
+    uint32_t newest_timestamp;     ///< 最新记录时间戳
+    uint32_t head_sector;          ///< 当前写入扇区（物理序号）
+    uint32_t head_seq;             ///< 当前写入扇区序号
+    uint32_t max_erase_count;      ///< 已知最大擦除次数
+    uint32_t corrupt_records;      ///< 挂载时发现的损坏记录（掉电写断）
+} sample_store_stats_t;
+
+/**
+ * @brief 查询回调，返回false提前结束查询
+ */
+typedef bool (*sample_store_query_cb_t)(const sample_store_record_t *record, void *user_ctx);
+
+/**
+ * @brief 挂载userdata分区上的样本存储
+ *
+ * 扫描所有扇区头恢复写位置和时间索引，首次使用时不需要格式化。
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_NOT_FOUND: 分区表中没有userdata分区
+ *   - 其他: Flash读取错误
+ */
+esp_err_t sample_store_init(void);
+
+/**
+ * @brief 在指定Flash接口上挂载样本存储（主机模拟和测试使用）
+ *
+ * @param flash Flash访问接口，调用期间及卸载前必须保持有效
+ * @return esp_err_t
+ */
+esp_err_t sample_store_mount(const sample_store_flash_t *flash);
+
+/**
+ * @brief 卸载样本存储
+ *
+ * @return esp_err_t
+ */
+esp_err_t sample_store_deinit(void);
+
+/**
+ * @brief 存储是否已挂载
+ */
+bool sample_store_is_ready(void);
+
+/**
+ * @brief 获取存储时间（秒）
+ *
+ * 设备没有RTC，时间以"上次掉电前最后一条记录的时间戳 + 本次运行时间"延续，
+ * 保证跨重启单调递增，查询和写入都应使用这个时间轴。
+ *
+ * @return uint32_t 当前存储时间
+ */
+uint32_t sample_store_now(void);
+
+/**
+ * @brief 追加一条样本
+ *
+ * 时间戳小于上一条记录时按上一条记录时间戳写入，保证时间索引有序。
+ *
+ * @param record 样本
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_STATE: 未挂载
+ */
+esp_err_t sample_store_append(const sample_store_record_t *record);
+
+/**
+ * @brief 追加一条样本（使用 sample_store_now() 作为时间戳）
+ *
+ * @param sensor_id 传感器ID
+ * @param channel 通道
+ * @param value 数值
+ * @return esp_err_t
+ */
+esp_err_t sample_store_append_now(uint8_t sensor_id, uint8_t channel, float value);
+
+/**
+ * @brief 查询时间区间 [t_start, t_end] 内的样本（按时间顺序回调）
+ *
+ * 先用稀疏索引二分定位起始扇区，再在扇区内二分定位起始记录，
+ * 之后顺序读取直到超出t_end。
+ *
+ * @param t_start 起始时间（含）
+ * @param t_end 结束时间（含）
+ * @param sensor_id 传感器ID过滤，SAMPLE_STORE_ANY_SENSOR表示不过滤
+ * @param callback 每条匹配记录的回调
+ * @param user_ctx 回调上下文
+ * @param out_count 输出匹配记录数（可为NULL）
+ * @return esp_err_t
+ */
+esp_err_t sample_store_query(uint32_t t_start, uint32_t t_end, uint8_t sensor_id,
+                             sample_store_query_cb_t callback, void *user_ctx,
+                             uint32_t *out_count);
+
+/**
+ * @brief 获取存储状态
+ *
+ * @param stats 输出统计信息
+ * @return esp_err_t
+ */
+esp_err_t sample_store_get_stats(sample_store_stats_t *stats);
+
+/**
+ * @brief 擦除全部历史数据
+ *
+ * @return esp_err_t
+ */
+esp_err_t sample_store_erase_all(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SAMPLE_STORE_H
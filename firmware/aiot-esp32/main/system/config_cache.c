@@ -0,0 +1,855 @@
+/**
+ * @file config_cache.c
+ * @brief 统一配置缓存实现
+ *
+ * 读写分离：
+ * - 两个快照缓冲区轮流使用，s_active指向当前对读者可见的那个。修改时把当前
+ *   快照拷贝到另一个缓冲区上修改，完成后切换s_active，正在被读的缓冲区不会被写。
+ * - 每个缓冲区带一个序号，写入前后各加1（写入期间为奇数）。读者拷贝前后序号
+ *   不变才算读到完整快照，否则重读。写入任务连续两次修改时才可能和读者撞上，
+ *   中断中读取时同核的写入者被挂起，当前缓冲区不会变化，不会死循环。
+ * - 修改只在任务上下文进行，由s_mutex串行化；NVS写入由s_commit_mutex串行化，
+ *   写flash期间不阻塞新的修改。
+ */
+
+#include "config_cache.h"
+#include <string.h>
+#include "esp_log.h"
+#include "nvs_flash.h"
+#include "nvs.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "CONFIG_CACHE";
+
+// NVS命名空间和键名（与旧版本保持一致）
+#define NS_WIFI                 "wifi_config"
+#define KEY_FORCE_CONFIG        "force_config"
+#define KEY_WIFI_SSID           "wifi_ssid"
+#define KEY_WIFI_PASS           "wifi_pass"
+#define KEY_CONFIGURED          "configured"
+
+#define NS_SERVER               "server_config"
+#define KEY_BASE_ADDRESS        "base_address"
+
+#define NS_DEVICE_REG           "device_reg"
+#define KEY_DEVICE_ID           "device_id"
+#define KEY_DEVICE_UUID         "device_uuid"
+#define KEY_DEVICE_SECRET       "device_secret"
+#define KEY_MAC_ADDRESS         "mac_address"
+#define KEY_REGISTERED          "registered"
+
+#define NS_ALARM                "alarm"
+#define KEY_ALARM_RULES         "rules"
+
+#define NS_REPORT               "report"
+#define KEY_REPORT_ENABLED      "enabled"
+#define KEY_REPORT_POLICIES     "policies"
+
+#define NS_SENSOR_FILTER        "sensor_filter"
+#define KEY_FILTER_CHANNELS     "channels"
+
+#define NS_META                 "cfg_meta"
+#define KEY_SCHEMA              "schema"
+
+#define WRITER_TASK_STACK       3072
+#define WRITER_TASK_PRIORITY    2
+
+typedef struct {
+    uint32_t mask;
+    config_cache_listener_t fn;
+    void *ctx;
+} listener_t;
+
+// 双缓冲快照
+static config_snapshot_t s_buf[2];
+static uint32_t s_seq[2];
+static uint32_t s_active = 0;
+static bool s_ready = false;
+
+static SemaphoreHandle_t s_mutex = NULL;         // 修改、订阅者、dirty/notify掩码
+static SemaphoreHandle_t s_commit_mutex = NULL;  // NVS写入
+static TaskHandle_t s_writer_task = NULL;
+
+static uint32_t s_dirty = 0;       // 尚未写入NVS的字段
+static uint32_t s_notify = 0;      // 尚未通知订阅者的字段
+static listener_t s_listeners[CONFIG_CACHE_MAX_LISTENERS];
+static size_t s_listener_count = 0;
+static config_cache_stats_t s_stats;
+
+/* ==================== 快照读写 ==================== */
+
+/**
+ * @brief 按序号校验读取快照：copy 从当前快照拷出需要的部分，期间快照被改写则重读
+ *
+ * 写者只改写非活动的那一份，读者最多因刚好切换而重读一次。
+ */
+static void snapshot_read_with(void (*copy)(const config_snapshot_t *src, void *ctx), void *ctx)
+{
+    for (;;) {
+        uint32_t idx = __atomic_load_n(&s_active, __ATOMIC_ACQUIRE);
+        uint32_t seq = __atomic_load_n(&s_seq[idx], __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            continue;
+        }
+        copy(&s_buf[idx], ctx);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&s_seq[idx], __ATOMIC_RELAXED) == seq) {
+            return;
+        }
+    }
+}
+
+static void copy_snapshot(const config_snapshot_t *src, void *ctx)
+{
+    memcpy(ctx, src, sizeof(*src));
+}
+
+static void snapshot_read(config_snapshot_t *out)
+{
+    snapshot_read_with(copy_snapshot, out);
+}
+
+/**
+ * @brief 发布新快照（调用者持有s_mutex）
+ */
+static void snapshot_publish(const config_snapshot_t *cfg)
+{
+    uint32_t next = __atomic_load_n(&s_active, __ATOMIC_RELAXED) ^ 1;
+
+    __atomic_fetch_add(&s_seq[next], 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&s_buf[next], cfg, sizeof(*cfg));
+    __atomic_fetch_add(&s_seq[next], 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&s_active, next, __ATOMIC_RELEASE);
+}
+
+/* ==================== NVS加载 ==================== */
+
+static void nvs_read_str(nvs_handle_t h, const char *key, char *buf, size_t size)
+{
+    size_t len = size;
+    if (nvs_get_str(h, key, buf, &len) != ESP_OK) {
+        buf[0] = '\0';
+    }
+}
+
+static void load_wifi(config_snapshot_t *cfg)
+{
+    nvs_handle_t h;
+    if (nvs_open(NS_WIFI, NVS_READONLY, &h) != ESP_OK) {
+        return;
+    }
+
+    nvs_read_str(h, KEY_WIFI_SSID, cfg->wifi_ssid, sizeof(cfg->wifi_ssid));
+    nvs_read_str(h, KEY_WIFI_PASS, cfg->wifi_password, sizeof(cfg->wifi_password));
+
+    uint8_t flag = 0;
+    size_t len = sizeof(flag);
+    if (nvs_get_blob(h, KEY_CONFIGURED, &flag, &len) == ESP_OK) {
+        cfg->wifi_configured = (flag == 1);
+    }
+    flag = 0;
+    len = sizeof(flag);
+    if (nvs_get_blob(h, KEY_FORCE_CONFIG, &flag, &len) == ESP_OK) {
+        cfg->force_provision = (flag == 1);
+    }
+
+    nvs_close(h);
+}
+
+static void load_server(config_snapshot_t *cfg)
+{
+    nvs_handle_t h;
+    if (nvs_open(NS_SERVER, NVS_READONLY, &h) != ESP_OK) {
+        return;
+    }
+    nvs_read_str(h, KEY_BASE_ADDRESS, cfg->server_base_address, sizeof(cfg->server_base_address));
+    nvs_close(h);
+}
+
+static void load_device_reg(config_snapshot_t *cfg)
+{
+    nvs_handle_t h;
+    if (nvs_open(NS_DEVICE_REG, NVS_READONLY, &h) != ESP_OK) {
+        return;
+    }
+
+    // 与旧版本一致：四个字段都存在才算已注册
+    size_t len;
+    esp_err_t err;
+    len = sizeof(cfg->device_id);
+    err = nvs_get_str(h, KEY_DEVICE_ID, cfg->device_id, &len);
+    if (err == ESP_OK) {
+        len = sizeof(cfg->device_uuid);
+        err = nvs_get_str(h, KEY_DEVICE_UUID, cfg->device_uuid, &len);
+    }
+    if (err == ESP_OK) {
+        len = sizeof(cfg->device_secret);
+        err = nvs_get_str(h, KEY_DEVICE_SECRET, cfg->device_secret, &len);
+    }
+    if (err == ESP_OK) {
+        len = sizeof(cfg->mac_address);
+        err = nvs_get_str(h, KEY_MAC_ADDRESS, cfg->mac_address, &len);
+    }
+    cfg->registered = (err == ESP_OK);
+
+    nvs_close(h);
+}
+
+static void load_alarm(config_snapshot_t *cfg)
+{
+    nvs_handle_t h;
+    if (nvs_open(NS_ALARM, NVS_READONLY, &h) != ESP_OK) {
+        return;
+    }
+
+    size_t len = sizeof(cfg->alarm_rules);
+    if (nvs_get_blob(h, KEY_ALARM_RULES, cfg->alarm_rules, &len) == ESP_OK) {
+        if (len % sizeof(alarm_rule_t) == 0) {
+            cfg->alarm_rule_count = len / sizeof(alarm_rule_t);
+        } else {
+            ESP_LOGW(TAG, "⚠️ 告警规则长度不符(%u字节)，已忽略", (unsigned)len);
+        }
+    }
+    nvs_close(h);
+}
+
+static void load_report(config_snapshot_t *cfg)
+{
+    nvs_handle_t h;
+    cfg->report_by_exception = REPORT_FILTER_DEFAULT_ENABLED;
+    if (nvs_open(NS_REPORT, NVS_READONLY, &h) != ESP_OK) {
+        return;
+    }
+
+    uint8_t enabled;
+    if (nvs_get_u8(h, KEY_REPORT_ENABLED, &enabled) == ESP_OK) {
+        cfg->report_by_exception = (enabled != 0);
+    }
+    size_t len = sizeof(cfg->report_policies);
+    if (nvs_get_blob(h, KEY_REPORT_POLICIES, cfg->report_policies, &len) == ESP_OK) {
+        if (len % sizeof(report_policy_t) == 0) {
+            cfg->report_policy_count = len / sizeof(report_policy_t);
+        } else {
+            ESP_LOGW(TAG, "⚠️ 上报策略长度不符(%u字节)，已忽略", (unsigned)len);
+        }
+    }
+    nvs_close(h);
+}
+
+static void load_sensor_filter(config_snapshot_t *cfg)
+{
+    nvs_handle_t h;
+    if (nvs_open(NS_SENSOR_FILTER, NVS_READONLY, &h) != ESP_OK) {
+        return;
+    }
+
+    size_t len = sizeof(cfg->sensor_filters);
+    if (nvs_get_blob(h, KEY_FILTER_CHANNELS, cfg->sensor_filters, &len) == ESP_OK) {
+        if (len % sizeof(sensor_filter_config_t) == 0) {
+            cfg->sensor_filter_count = len / sizeof(sensor_filter_config_t);
+        } else {
+            ESP_LOGW(TAG, "⚠️ 传感器滤波配置长度不符(%u字节)，已忽略", (unsigned)len);
+        }
+    }
+    nvs_close(h);
+}
+
+static uint16_t load_schema(void)
+{
+    nvs_handle_t h;
+    uint16_t schema = 0;
+    if (nvs_open(NS_META, NVS_READONLY, &h) == ESP_OK) {
+        nvs_get_u16(h, KEY_SCHEMA, &schema);
+        nvs_close(h);
+    }
+    return schema;
+}
+
+static esp_err_t save_schema(uint16_t schema)
+{
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(NS_META, NVS_READWRITE, &h);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = nvs_set_u16(h, KEY_SCHEMA, schema);
+    if (err == ESP_OK) {
+        err = nvs_commit(h);
+    }
+    nvs_close(h);
+    return err;
+}
+
+/* ==================== 格式迁移 ==================== */
+
+/**
+ * @brief v0 -> v1：服务器地址统一为"协议://主机"格式
+ *
+ * v0固件保存的是用户原样输入的地址，每次读取时再补http://、去掉结尾的'/'。
+ * v1在NVS中只保存规范化后的地址。
+ */
+static uint32_t migrate_v0_to_v1(config_snapshot_t *cfg)
+{
+    char *addr = cfg->server_base_address;
+    size_t len = strlen(addr);
+    uint32_t changed = 0;
+
+    if (len == 0) {
+        return 0;
+    }
+
+    if (strncmp(addr, "http://", 7) != 0 && strncmp(addr, "https://", 8) != 0) {
+        if (len + 7 >= sizeof(cfg->server_base_address)) {
+            ESP_LOGE(TAG, "❌ 服务器地址过长，无法添加协议前缀: %s", addr);
+            return 0;
+        }
+        memmove(addr + 7, addr, len + 1);
+        memcpy(addr, "http://", 7);
+        len += 7;
+        changed = CONFIG_FIELD_SERVER;
+    }
+    if (addr[len - 1] == '/') {
+        addr[len - 1] = '\0';
+        changed = CONFIG_FIELD_SERVER;
+    }
+    if (changed) {
+        ESP_LOGW(TAG, "⚠️ 服务器地址已规范化: %s", addr);
+    }
+    return changed;
+}
+
+typedef uint32_t (*migration_fn_t)(config_snapshot_t *cfg);
+
+// s_migrations[n] 把版本n迁移到n+1
+static const migration_fn_t s_migrations[CONFIG_CACHE_SCHEMA_VERSION] = {
+    migrate_v0_to_v1,
+};
+
+/* ==================== NVS提交 ==================== */
+
+static esp_err_t commit_wifi(const config_snapshot_t *cfg, uint32_t fields)
+{
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(NS_WIFI, NVS_READWRITE, &h);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    do {
+        if (fields & CONFIG_FIELD_WIFI) {
+            uint8_t configured = cfg->wifi_configured ? 1 : 0;
+            err = nvs_set_str(h, KEY_WIFI_SSID, cfg->wifi_ssid);
+            if (err != ESP_OK) break;
+            err = nvs_set_str(h, KEY_WIFI_PASS, cfg->wifi_password);
+            if (err != ESP_OK) break;
+            err = nvs_set_blob(h, KEY_CONFIGURED, &configured, sizeof(configured));
+            if (err != ESP_OK) break;
+        }
+        if (fields & CONFIG_FIELD_FORCE_PROVISION) {
+            if (cfg->force_provision) {
+                uint8_t force = 1;
+                err = nvs_set_blob(h, KEY_FORCE_CONFIG, &force, sizeof(force));
+            } else {
+                err = nvs_erase_key(h, KEY_FORCE_CONFIG);
+                if (err == ESP_ERR_NVS_NOT_FOUND) {
+                    err = ESP_OK;
+                }
+            }
+            if (err != ESP_OK) break;
+        }
+        err = nvs_commit(h);
+    } while (0);
+
+    nvs_close(h);
+    return err;
+}
+
+static esp_err_t commit_server(const config_snapshot_t *cfg)
+{
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(NS_SERVER, NVS_READWRITE, &h);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    if (cfg->server_base_address[0] != '\0') {
+        err = nvs_set_str(h, KEY_BASE_ADDRESS, cfg->server_base_address);
+    } else {
+        err = nvs_erase_key(h, KEY_BASE_ADDRESS);
+        if (err == ESP_ERR_NVS_NOT_FOUND) {
+            err = ESP_OK;
+        }
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(h);
+    }
+
+    nvs_close(h);
+    return err;
+}
+
+static esp_err_t commit_device_reg(const config_snapshot_t *cfg)
+{
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(NS_DEVICE_REG, NVS_READWRITE, &h);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    do {
+        if (!cfg->registered) {
+            err = nvs_erase_all(h);
+        } else {
+            err = nvs_set_str(h, KEY_DEVICE_ID, cfg->device_id);
+            if (err != ESP_OK) break;
+            err = nvs_set_str(h, KEY_DEVICE_UUID, cfg->device_uuid);
+            if (err != ESP_OK) break;
+            err = nvs_set_str(h, KEY_DEVICE_SECRET, cfg->device_secret);
+            if (err != ESP_OK) break;
+            err = nvs_set_str(h, KEY_MAC_ADDRESS, cfg->mac_address);
+            if (err != ESP_OK) break;
+            err = nvs_set_u8(h, KEY_REGISTERED, 1);
+        }
+        if (err != ESP_OK) break;
+        err = nvs_commit(h);
+    } while (0);
+
+    nvs_close(h);
+    return err;
+}
+
+static esp_err_t commit_alarm(const config_snapshot_t *cfg)
+{
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(NS_ALARM, NVS_READWRITE, &h);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    if (cfg->alarm_rule_count > 0) {
+        err = nvs_set_blob(h, KEY_ALARM_RULES, cfg->alarm_rules,
+                           cfg->alarm_rule_count * sizeof(alarm_rule_t));
+    } else {
+        err = nvs_erase_key(h, KEY_ALARM_RULES);
+        if (err == ESP_ERR_NVS_NOT_FOUND) {
+            err = ESP_OK;
+        }
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(h);
+    }
+
+    nvs_close(h);
+    return err;
+}
+
+static esp_err_t commit_report(const config_snapshot_t *cfg)
+{
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(NS_REPORT, NVS_READWRITE, &h);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    err = nvs_set_u8(h, KEY_REPORT_ENABLED, cfg->report_by_exception ? 1 : 0);
+    if (err == ESP_OK) {
+        if (cfg->report_policy_count > 0) {
+            err = nvs_set_blob(h, KEY_REPORT_POLICIES, cfg->report_policies,
+                               cfg->report_policy_count * sizeof(report_policy_t));
+        } else {
+            err = nvs_erase_key(h, KEY_REPORT_POLICIES);
+            if (err == ESP_ERR_NVS_NOT_FOUND) {
+                err = ESP_OK;
+            }
+        }
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(h);
+    }
+
+    nvs_close(h);
+    return err;
+}
+
+static esp_err_t commit_sensor_filter(const config_snapshot_t *cfg)
+{
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(NS_SENSOR_FILTER, NVS_READWRITE, &h);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    if (cfg->sensor_filter_count > 0) {
+        err = nvs_set_blob(h, KEY_FILTER_CHANNELS, cfg->sensor_filters,
+                           cfg->sensor_filter_count * sizeof(sensor_filter_config_t));
+    } else {
+        err = nvs_erase_key(h, KEY_FILTER_CHANNELS);
+        if (err == ESP_ERR_NVS_NOT_FOUND) {
+            err = ESP_OK;
+        }
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(h);
+    }
+
+    nvs_close(h);
+    return err;
+}
+
+/**
+ * @brief 把dirty字段写入NVS，写入失败的字段留到下一次
+ */
+static esp_err_t commit_dirty(void)
+{
+    static config_snapshot_t cfg;  // 只在持有s_commit_mutex时使用
+    esp_err_t result = ESP_OK;
+
+    xSemaphoreTake(s_commit_mutex, portMAX_DELAY);
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    uint32_t dirty = s_dirty;
+    s_dirty = 0;
+    snapshot_read(&cfg);
+    xSemaphoreGive(s_mutex);
+
+    if (dirty) {
+        uint32_t failed = 0;
+        esp_err_t err;
+
+        if (dirty & (CONFIG_FIELD_WIFI | CONFIG_FIELD_FORCE_PROVISION)) {
+            err = commit_wifi(&cfg, dirty);
+            if (err != ESP_OK) {
+                failed |= dirty & (CONFIG_FIELD_WIFI | CONFIG_FIELD_FORCE_PROVISION);
+                result = err;
+            }
+        }
+        if (dirty & CONFIG_FIELD_SERVER) {
+            err = commit_server(&cfg);
+            if (err != ESP_OK) {
+                failed |= CONFIG_FIELD_SERVER;
+                result = err;
+            }
+        }
+        if (dirty & CONFIG_FIELD_DEVICE_REG) {
+            err = commit_device_reg(&cfg);
+            if (err != ESP_OK) {
+                failed |= CONFIG_FIELD_DEVICE_REG;
+                result = err;
+            }
+        }
+
+        if (dirty & CONFIG_FIELD_ALARM) {
+            err = commit_alarm(&cfg);
+            if (err != ESP_OK) {
+                failed |= CONFIG_FIELD_ALARM;
+                result = err;
+            }
+        }
+        if (dirty & CONFIG_FIELD_REPORT) {
+            err = commit_report(&cfg);
+            if (err != ESP_OK) {
+                failed |= CONFIG_FIELD_REPORT;
+                result = err;
+            }
+        }
+        if (dirty & CONFIG_FIELD_SENSOR_FILTER) {
+            err = commit_sensor_filter(&cfg);
+            if (err != ESP_OK) {
+                failed |= CONFIG_FIELD_SENSOR_FILTER;
+                result = err;
+            }
+        }
+
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        s_dirty |= failed;
+        s_stats.commits++;
+        if (failed) {
+            s_stats.commit_errors++;
+        }
+        xSemaphoreGive(s_mutex);
+
+        if (failed) {
+            ESP_LOGE(TAG, "❌ 配置写入NVS失败: %s (字段0x%02lx)", esp_err_to_name(result), (unsigned long)failed);
+        } else {
+            ESP_LOGI(TAG, "💾 配置已写入NVS (字段0x%02lx, 版本%lu)",
+                     (unsigned long)dirty, (unsigned long)cfg.generation);
+        }
+    }
+
+    xSemaphoreGive(s_commit_mutex);
+    return result;
+}
+
+/* ==================== 写入任务 ==================== */
+
+static void notify_listeners(void)
+{
+    static config_snapshot_t cfg;  // 只在写入任务中使用
+    listener_t listeners[CONFIG_CACHE_MAX_LISTENERS];
+    size_t count;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    uint32_t changed = s_notify;
+    s_notify = 0;
+    count = s_listener_count;
+    memcpy(listeners, s_listeners, count * sizeof(listener_t));
+    snapshot_read(&cfg);
+    xSemaphoreGive(s_mutex);
+
+    if (!changed) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (listeners[i].mask & changed) {
+            listeners[i].fn(changed & listeners[i].mask, &cfg, listeners[i].ctx);
+        }
+    }
+}
+
+static void config_writer_task(void *arg)
+{
+    (void)arg;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        notify_listeners();
+
+        // 等待一段时间，把紧接着的修改（如配网时先存WiFi再存服务器地址）合并成一批
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_CONFIG_CACHE_COMMIT_DELAY_MS));
+        while (ulTaskNotifyTake(pdTRUE, 0) > 0) {
+            notify_listeners();
+        }
+        commit_dirty();
+    }
+}
+
+/* ==================== 公共接口 ==================== */
+
+esp_err_t config_cache_init(void)
+{
+    static config_snapshot_t cfg;
+
+    if (s_ready) {
+        return ESP_OK;
+    }
+
+    s_mutex = xSemaphoreCreateMutex();
+    s_commit_mutex = xSemaphoreCreateMutex();
+    if (!s_mutex || !s_commit_mutex) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    memset(&cfg, 0, sizeof(cfg));
+    load_wifi(&cfg);
+    load_server(&cfg);
+    load_device_reg(&cfg);
+    load_alarm(&cfg);
+    load_report(&cfg);
+    load_sensor_filter(&cfg);
+
+    uint16_t schema = load_schema();
+    s_stats.schema = schema;
+    if (schema > CONFIG_CACHE_SCHEMA_VERSION) {
+        ESP_LOGW(TAG, "⚠️ NVS配置版本(%u)高于固件支持的版本(%u)，按当前版本读取",
+                 schema, CONFIG_CACHE_SCHEMA_VERSION);
+    }
+    for (uint16_t v = schema; v < CONFIG_CACHE_SCHEMA_VERSION; v++) {
+        s_dirty |= s_migrations[v](&cfg);
+    }
+
+    snapshot_publish(&cfg);
+    s_ready = true;
+
+    // 迁移结果和版本号在写入任务启动前同步写入，避免迁移到一半时掉电
+    if (schema < CONFIG_CACHE_SCHEMA_VERSION) {
+        if (commit_dirty() == ESP_OK && save_schema(CONFIG_CACHE_SCHEMA_VERSION) == ESP_OK) {
+            ESP_LOGI(TAG, "🔄 配置格式已从v%u迁移到v%u", schema, CONFIG_CACHE_SCHEMA_VERSION);
+        }
+    }
+
+    if (xTaskCreate(config_writer_task, "config_writer", WRITER_TASK_STACK, NULL,
+                    WRITER_TASK_PRIORITY, &s_writer_task) != pdPASS) {
+        ESP_LOGE(TAG, "❌ 创建配置写入任务失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "✅ 配置已加载: WiFi=%s 服务器=%s 注册=%s 强制配网=%d",
+             cfg.wifi_configured ? cfg.wifi_ssid : "(未配置)",
+             cfg.server_base_address[0] ? cfg.server_base_address : "(未配置)",
+             cfg.registered ? cfg.device_id : "(未注册)",
+             cfg.force_provision);
+    return ESP_OK;
+}
+
+bool config_cache_is_ready(void)
+{
+    return __atomic_load_n(&s_ready, __ATOMIC_ACQUIRE);
+}
+
+void config_cache_get(config_snapshot_t *out)
+{
+    if (!out) {
+        return;
+    }
+    if (!config_cache_is_ready()) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    snapshot_read(out);
+}
+
+/**
+ * @brief 字段读取的输出（缓冲区为NULL的字段不拷贝）
+ */
+typedef struct {
+    char *str;
+    size_t str_size;
+    char *str2;
+    size_t str2_size;
+    bool flag;
+} field_out_t;
+
+static void copy_str(char *dst, size_t size, const char *src)
+{
+    if (dst) {
+        strncpy(dst, src, size - 1);
+        dst[size - 1] = '\0';
+    }
+}
+
+static void copy_server_address(const config_snapshot_t *src, void *ctx)
+{
+    field_out_t *o = ctx;
+    copy_str(o->str, o->str_size, src->server_base_address);
+}
+
+static void copy_wifi(const config_snapshot_t *src, void *ctx)
+{
+    field_out_t *o = ctx;
+    copy_str(o->str, o->str_size, src->wifi_ssid);
+    copy_str(o->str2, o->str2_size, src->wifi_password);
+    o->flag = src->wifi_configured;
+}
+
+static void copy_force_provision(const config_snapshot_t *src, void *ctx)
+{
+    ((field_out_t *)ctx)->flag = src->force_provision;
+}
+
+bool config_cache_get_server_address(char *buf, size_t size)
+{
+    if (!buf || size == 0) {
+        return false;
+    }
+    buf[0] = '\0';
+    if (!config_cache_is_ready()) {
+        return false;
+    }
+
+    field_out_t o = { .str = buf, .str_size = size };
+    snapshot_read_with(copy_server_address, &o);
+    return buf[0] != '\0';
+}
+
+bool config_cache_get_wifi(char *ssid, size_t ssid_size, char *password, size_t password_size)
+{
+    field_out_t o = {
+        .str = ssid_size ? ssid : NULL,
+        .str_size = ssid_size,
+        .str2 = password_size ? password : NULL,
+        .str2_size = password_size,
+    };
+    if (o.str) {
+        o.str[0] = '\0';
+    }
+    if (o.str2) {
+        o.str2[0] = '\0';
+    }
+    if (!config_cache_is_ready()) {
+        return false;
+    }
+    snapshot_read_with(copy_wifi, &o);
+    return o.flag;
+}
+
+bool config_cache_get_force_provision(void)
+{
+    if (!config_cache_is_ready()) {
+        return false;
+    }
+    field_out_t o = { 0 };
+    snapshot_read_with(copy_force_provision, &o);
+    return o.flag;
+}
+
+esp_err_t config_cache_update(config_cache_mutator_t mutator, void *ctx)
+{
+    static config_snapshot_t cfg;  // 只在持有s_mutex时使用
+
+    if (!mutator) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!config_cache_is_ready()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    memcpy(&cfg, &s_buf[s_active], sizeof(cfg));
+    uint32_t changed = mutator(&cfg, ctx) & CONFIG_FIELD_ALL;
+    if (changed) {
+        cfg.generation++;
+        snapshot_publish(&cfg);
+        s_dirty |= changed;
+        s_notify |= changed;
+        s_stats.updates++;
+    }
+    xSemaphoreGive(s_mutex);
+
+    if (changed && s_writer_task) {
+        xTaskNotifyGive(s_writer_task);
+    }
+    return ESP_OK;
+}
+
+esp_err_t config_cache_flush(void)
+{
+    if (!config_cache_is_ready()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return commit_dirty();
+}
+
+esp_err_t config_cache_subscribe(uint32_t mask, config_cache_listener_t listener, void *ctx)
+{
+    if (!listener || !s_mutex) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = ESP_ERR_NO_MEM;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (s_listener_count < CONFIG_CACHE_MAX_LISTENERS) {
+        s_listeners[s_listener_count++] = (listener_t){ .mask = mask, .fn = listener, .ctx = ctx };
+        err = ESP_OK;
+    }
+    xSemaphoreGive(s_mutex);
+    return err;
+}
+
+void config_cache_get_stats(config_cache_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    if (!s_mutex) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *stats = s_stats;
+    stats->generation = s_buf[s_active].generation;
+    stats->dirty = s_dirty;
+    xSemaphoreGive(s_mutex);
+}
@@ -0,0 +1,216 @@
+/**
+ * @file config_cache.h
+ * @brief 统一配置缓存：开机一次性从NVS加载，运行时从RAM读取
+ *
+ * 原先WiFi、服务器地址、设备注册信息分别由各模块在需要时 nvs_open 读取，
+ * 每次都要走一遍flash查找。现在开机时把这几个命名空间一次性读入一个类型化的
+ * 快照（config_snapshot_t），之后：
+ * - 读取：config_cache_get() 在任务上下文拷贝整个快照（几百字节）；只需要一两个字段时
+ *   用 config_cache_get_server_address() 等字段读取函数，只拷贝该字段，中断中也可调用
+ * - 修改：config_cache_update() 在快照副本上修改后原子切换（写时复制），
+ *   由后台写入任务合并一段时间内的修改后按命名空间批量提交到NVS
+ * - 通知：config_cache_subscribe() 订阅字段变化，由写入任务回调
+ * - 重启前调用 config_cache_flush() 同步提交未写入的修改
+ *
+ * NVS中的命名空间和键名保持不变（wifi_config / server_config / device_reg），
+ * 告警规则保存在 alarm/rules（alarm_rule_t数组），上报策略保存在
+ * report/enabled、report/policies（report_policy_t数组），传感器校准和滤波配置保存在
+ * sensor_filter/channels（sensor_filter_config_t数组），
+ * 旧固件写入的数据可以直接读取；配置格式版本记录在 cfg_meta/schema，
+ * 开机加载时按版本号逐级迁移。
+ */
+
+#ifndef CONFIG_CACHE_H
+#define CONFIG_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "alarm.h"
+#include "report_filter.h"
+#include "sensor_filter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CONFIG_CACHE_SCHEMA_VERSION     1       ///< 当前配置格式版本
+#define CONFIG_CACHE_MAX_LISTENERS      8       ///< 最多订阅者数量
+
+#ifndef CONFIG_CONFIG_CACHE_COMMIT_DELAY_MS
+#define CONFIG_CONFIG_CACHE_COMMIT_DELAY_MS 500 ///< 修改后等待合并的时间，期间的修改一起提交
+#endif
+
+/**
+ * @brief 配置字段分组（按NVS命名空间划分，用于变化通知）
+ */
+typedef enum {
+    CONFIG_FIELD_WIFI            = 1 << 0,  ///< WiFi SSID/密码/已配置标志
+    CONFIG_FIELD_FORCE_PROVISION = 1 << 1,  ///< 强制配网标志
+    CONFIG_FIELD_SERVER          = 1 << 2,  ///< 服务器基础地址
+    CONFIG_FIELD_DEVICE_REG      = 1 << 3,  ///< 设备注册信息
+    CONFIG_FIELD_ALARM           = 1 << 4,  ///< 告警规则
+    CONFIG_FIELD_REPORT          = 1 << 5,  ///< 上报策略
+    CONFIG_FIELD_SENSOR_FILTER   = 1 << 6,  ///< 传感器校准和滤波
+    CONFIG_FIELD_ALL             = 0x7F,
+} config_field_t;
+
+/**
+ * @brief 配置快照
+ */
+typedef struct {
+    uint32_t generation;            ///< 每次修改加1，开机加载后为0
+
+    // wifi_config 命名空间
+    char wifi_ssid[32];
+    char wifi_password[64];
+    bool wifi_configured;
+    bool force_provision;           ///< 下次启动进入配网模式
+
+    // server_config 命名空间
+    char server_base_address[64];   ///< 含协议前缀，结尾不含'/'，未配置时为空串
+
+    // device_reg 命名空间
+    bool registered;
+    char device_id[64];
+    char device_uuid[128];
+    char device_secret[128];
+    char mac_address[18];
+
+    // alarm 命名空间
+    uint8_t alarm_rule_count;
+    alarm_rule_t alarm_rules[ALARM_MAX_RULES];
+
+    // report 命名空间
+    bool report_by_exception;       ///< 按变化上报（未保存时为Kconfig默认值）
+    uint8_t report_policy_count;    ///< 覆盖默认值的策略数
+    report_policy_t report_policies[REPORT_FILTER_MAX_POLICIES];
+
+    // sensor_filter 命名空间
+    uint8_t sensor_filter_count;    ///< 覆盖默认值的通道配置数
+    sensor_filter_config_t sensor_filters[SENSOR_FILTER_MAX_CHANNELS];
+} config_snapshot_t;
+
+/**
+ * @brief 修改函数，在快照副本上修改
+ *
+ * @param cfg 可写副本（已包含当前值）
+ * @param ctx 用户参数
+ * @return 修改了的字段（config_field_t按位或），返回0表示放弃本次修改
+ */
+typedef uint32_t (*config_cache_mutator_t)(config_snapshot_t *cfg, void *ctx);
+
+/**
+ * @brief 变化通知回调（在写入任务中调用，不要阻塞）
+ *
+ * @param changed 变化的字段（config_field_t按位或）
+ * @param cfg 修改后的快照
+ * @param ctx 订阅时的用户参数
+ */
+typedef void (*config_cache_listener_t)(uint32_t changed, const config_snapshot_t *cfg, void *ctx);
+
+/**
+ * @brief 统计信息
+ */
+typedef struct {
+    uint32_t generation;            ///< 当前快照版本
+    uint32_t updates;               ///< 修改次数
+    uint32_t commits;               ///< 写入NVS的批次数
+    uint32_t commit_errors;         ///< 写入失败次数
+    uint32_t dirty;                 ///< 尚未写入NVS的字段
+    uint16_t schema;                ///< 开机时NVS中的配置格式版本
+} config_cache_stats_t;
+
+/**
+ * @brief 从NVS加载配置并启动写入任务
+ *
+ * 需在 nvs_flash_init() 之后、其他模块读取配置之前调用。
+ * 某个命名空间不存在时对应字段为空值，不视为错误。
+ *
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_NO_MEM: 创建任务失败
+ */
+esp_err_t config_cache_init(void);
+
+/**
+ * @brief 是否已完成加载
+ */
+bool config_cache_is_ready(void);
+
+/**
+ * @brief 读取当前配置快照（无锁，任务上下文）
+ *
+ * 快照有几百字节，不要在中断中调用，也不要只为一两个字段放到小栈上；
+ * 这种情况用下面的字段读取函数。
+ *
+ * @param out 输出快照，未初始化时填0
+ */
+void config_cache_get(config_snapshot_t *out);
+
+/**
+ * @brief 读取服务器基础地址（无锁，可在中断中调用）
+ *
+ * @param buf 输出缓冲区
+ * @param size 缓冲区大小
+ * @return true 已配置；false 未配置（buf为空串）
+ */
+bool config_cache_get_server_address(char *buf, size_t size);
+
+/**
+ * @brief 读取WiFi配置（无锁，可在中断中调用）
+ *
+ * @param ssid 输出SSID，可为NULL（ssid_size为0）
+ * @param password 输出密码，可为NULL（password_size为0）
+ * @return WiFi是否已配置
+ */
+bool config_cache_get_wifi(char *ssid, size_t ssid_size, char *password, size_t password_size);
+
+/**
+ * @brief 读取强制配网标志（无锁，可在中断中调用）
+ */
+bool config_cache_get_force_provision(void);
+
+/**
+ * @brief 修改配置（任务上下文）
+ *
+ * 修改立即对读者可见，写入NVS由写入任务延后批量完成。
+ *
+ * @param mutator 修改函数
+ * @param ctx 传给修改函数的参数
+ * @return esp_err_t
+ *   - ESP_OK: 成功（包括mutator返回0未修改）
+ *   - ESP_ERR_INVALID_STATE: 未初始化
+ */
+esp_err_t config_cache_update(config_cache_mutator_t mutator, void *ctx);
+
+/**
+ * @brief 立即把未写入的修改提交到NVS（重启前调用）
+ *
+ * @return esp_err_t 最后一次NVS写入的结果
+ */
+esp_err_t config_cache_flush(void);
+
+/**
+ * @brief 订阅配置变化
+ *
+ * @param mask 关心的字段（config_field_t按位或）
+ * @param listener 回调
+ * @param ctx 用户参数
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_NO_MEM: 订阅者已满
+ */
+esp_err_t config_cache_subscribe(uint32_t mask, config_cache_listener_t listener, void *ctx);
+
+/**
+ * @brief 获取统计信息
+ */
+void config_cache_get_stats(config_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CONFIG_CACHE_H
@@ -8,13 +8,15 @@
 #include "module_init.h"
 #include "server/server_config.h"
 #include "wifi_config/wifi_config.h"
+#include "server/http_session.h"
+#include "provisioning/provisioning_client.h"
 #include "esp_log.h"
 #include "esp_err.h"
 #include "esp_mac.h"
 #include "esp_wifi.h"
-#include "esp_http_client.h"
 #include "esp_netif.h"
 #include "esp_event.h"
+#include "json_stream.h"
 #include "cJSON.h"
 #include <string.h>
 #include <stdlib.h>
@@ -24,6 +26,14 @@ static const char *TAG = "MODULE_INIT";
 // 外部声明的WiFi事件处理器（在main.c中定义）
 extern void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data);
 
+// /api/devices/mac/lookup 响应字段（流式解析，直接写入device_uuid_info_t）
+static const json_field_t s_uuid_fields[] = {
+    JSON_FIELD(JSON_FIELD_STRING, "device_id", device_uuid_info_t, device_id),
+    JSON_FIELD(JSON_FIELD_STRING, "device_uuid", device_uuid_info_t, device_uuid),
+    JSON_FIELD(JSON_FIELD_STRING, "device_secret", device_uuid_info_t, device_secret),
+    JSON_FIELD(JSON_FIELD_STRING, "mac_address", device_uuid_info_t, mac_address),
+};
+
 /**
  * @brief 初始化设备ID和MQTT主题（临时值）
  * 
@@ -97,6 +107,21 @@ esp_err_t fetch_uuid_by_mac(
     snprintf(mac_str, sizeof(mac_str), "%02x:%02x:%02x:%02x:%02x:%02x",
              mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
 
+    // 本次开机的引导请求已带回UUID和密钥（服务器支持时）则直接使用
+    provisioning_config_t *boot = malloc(sizeof(provisioning_config_t));
+    if (boot && provisioning_client_get_bootstrap(config->base_address, NULL, boot) == ESP_OK &&
+        strlen(boot->device_uuid) > 0 && strlen(boot->device_secret) > 0) {
+        memset(uuid_info, 0, sizeof(*uuid_info));
+        strncpy(uuid_info->device_id, boot->device_id, sizeof(uuid_info->device_id) - 1);
+        strncpy(uuid_info->device_uuid, boot->device_uuid, sizeof(uuid_info->device_uuid) - 1);
+        strncpy(uuid_info->device_secret, boot->device_secret, sizeof(uuid_info->device_secret) - 1);
+        strncpy(uuid_info->mac_address, mac_str, sizeof(uuid_info->mac_address) - 1);
+        free(boot);
+        ESP_LOGI(TAG, "✅ UUID taken from boot-time bootstrap response: %s", uuid_info->device_uuid);
+        return ESP_OK;
+    }
+    free(boot);
+
     // 动态构建URL
     char url[256];
     ret = server_config_build_http_url(config, "/api/devices/mac/lookup", url, sizeof(url));
@@ -125,30 +150,6 @@ esp_err_t fetch_uuid_by_mac(
         return ESP_ERR_NO_MEM;
     }
     
-    // HTTP事件处理
-    static char response_buffer[2048];
-    static size_t response_len = 0;
-    response_len = 0;
-
-    esp_err_t http_event_handler(esp_http_client_event_t *evt) {
-        switch (evt->event_id) {
-            case HTTP_EVENT_ON_DATA:
-                if (!esp_http_client_is_chunked_response(evt->client)) {
-                    int copy_len = evt->data_len;
-                    if (response_len + copy_len >= sizeof(response_buffer)) {
-                        copy_len = sizeof(response_buffer) - response_len - 1;
-                    }
-                    memcpy(response_buffer + response_len, evt->data, copy_len);
-                    response_len += copy_len;
-                    response_buffer[response_len] = '\0';
-                }
-                break;
-            default:
-                break;
-        }
-        return ESP_OK;
-    }
-
     // 重试循环
     int retry_count = 0;
     while (retry_count <= max_retries) {
@@ -157,84 +158,36 @@ esp_err_t fetch_uuid_by_mac(
             vTaskDelay(pdMS_TO_TICKS(2000)); // 等待2秒后重试
         }
     
-    // 配置HTTP客户端
-        esp_http_client_config_t http_config = {
-            .url = url,
-            .event_handler = http_event_handler,
-            .timeout_ms = 10000,
-        .method = HTTP_METHOD_POST,
-    };
-    
-        esp_http_client_handle_t client = esp_http_client_init(&http_config);
-    if (!client) {
-        ESP_LOGE(TAG, "Failed to initialize HTTP client");
-            free(json_string);
-            cJSON_Delete(json);
-            return ESP_ERR_NO_MEM;
-    }
-    
-    esp_http_client_set_header(client, "Content-Type", "application/json");
-    esp_http_client_set_post_field(client, json_string, strlen(json_string));
-    
-        // 执行请求
-        ret = esp_http_client_perform(client);
+        // 执行请求（共享会话，同一服务器的后续请求复用连接；响应边接收边解析到uuid_info）
+        http_session_json_result_t result;
+        ret = http_session_request_json(HTTP_SESSION_POST, url, json_string, 10000, 0,
+                                        s_uuid_fields, sizeof(s_uuid_fields) / sizeof(s_uuid_fields[0]),
+                                        uuid_info, &result);
         if (ret == ESP_OK) {
-            int status_code = esp_http_client_get_status_code(client);
-            if (status_code == 200) {
-                // 解析响应
-                cJSON *response_json = cJSON_Parse(response_buffer);
-                if (response_json) {
-                    cJSON *device_id = cJSON_GetObjectItem(response_json, "device_id");
-                    cJSON *device_uuid = cJSON_GetObjectItem(response_json, "device_uuid");
-                    cJSON *device_secret = cJSON_GetObjectItem(response_json, "device_secret");
-                    cJSON *mac_address = cJSON_GetObjectItem(response_json, "mac_address");
-
-                    if (cJSON_IsString(device_id) && device_id->valuestring) {
-                        strncpy(uuid_info->device_id, device_id->valuestring, sizeof(uuid_info->device_id) - 1);
-                        uuid_info->device_id[sizeof(uuid_info->device_id) - 1] = '\0';
-                    }
-                    if (cJSON_IsString(device_uuid) && device_uuid->valuestring) {
-                        strncpy(uuid_info->device_uuid, device_uuid->valuestring, sizeof(uuid_info->device_uuid) - 1);
-                        uuid_info->device_uuid[sizeof(uuid_info->device_uuid) - 1] = '\0';
-                    }
-                    if (cJSON_IsString(device_secret) && device_secret->valuestring) {
-                        strncpy(uuid_info->device_secret, device_secret->valuestring, sizeof(uuid_info->device_secret) - 1);
-                        uuid_info->device_secret[sizeof(uuid_info->device_secret) - 1] = '\0';
-                    }
-                    if (cJSON_IsString(mac_address) && mac_address->valuestring) {
-                        strncpy(uuid_info->mac_address, mac_address->valuestring, sizeof(uuid_info->mac_address) - 1);
-                        uuid_info->mac_address[sizeof(uuid_info->mac_address) - 1] = '\0';
-                    }
-
-                    cJSON_Delete(response_json);
-
-                    ESP_LOGI(TAG, "✅ UUID fetch successful");
-                    ESP_LOGI(TAG, "   Device ID: %s", uuid_info->device_id);
-                    ESP_LOGI(TAG, "   Device UUID: %s", uuid_info->device_uuid);
-                    ESP_LOGI(TAG, "   MAC Address: %s", uuid_info->mac_address);
-
-                    esp_http_client_cleanup(client);
-                    free(json_string);
-                    cJSON_Delete(json);
-                    return ESP_OK;
-                } else {
-                    ESP_LOGE(TAG, "Failed to parse JSON response: %s", response_buffer);
-                }
+            int status_code = result.status;
+            if (status_code == 200 && result.parse_err == ESP_OK) {
+                ESP_LOGI(TAG, "✅ UUID fetch successful");
+                ESP_LOGI(TAG, "   Device ID: %s", uuid_info->device_id);
+                ESP_LOGI(TAG, "   Device UUID: %s", uuid_info->device_uuid);
+                ESP_LOGI(TAG, "   MAC Address: %s", uuid_info->mac_address);
+
+                free(json_string);
+                cJSON_Delete(json);
+                return ESP_OK;
+            } else if (status_code == 200) {
+                ESP_LOGE(TAG, "Failed to parse JSON response (%u bytes)", (unsigned)result.len);
             } else if (status_code == 404) {
                 ESP_LOGE(TAG, "Device not registered (404). Please register device in backend first.");
-                esp_http_client_cleanup(client);
                 free(json_string);
                 cJSON_Delete(json);
                 return ESP_ERR_NOT_FOUND;
             } else {
                 ESP_LOGE(TAG, "HTTP request failed with status: %d", status_code);
-                ESP_LOGE(TAG, "Response: %s", response_buffer);
             }
         } else {
             ESP_LOGE(TAG, "HTTP request failed: %s", esp_err_to_name(ret));
         }
 
-        esp_http_client_cleanup(client);
         retry_count++;
     }
 
@@ -0,0 +1,309 @@
+/**
+ * @file task_profiler.c
+ * @brief 任务CPU占用与栈水位分析实现
+ *
+ * 窗口计算只依赖 task_profiler_source_t，不直接调用FreeRTOS，
+ * 同一份代码在设备和主机模拟中运行。
+ */
+
+#include "task_profiler.h"
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "json_writer.h"
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#endif
+
+static const char *TAG = "TASK_PROF";
+
+static task_profiler_source_t s_source;
+static bool s_initialized = false;
+
+// 上一次采样（窗口起点）
+static task_profiler_task_t s_prev[TASK_PROFILER_MAX_TASKS];
+static size_t s_prev_count = 0;
+static uint32_t s_prev_ms = 0;
+static bool s_has_baseline = false;
+
+// 本次采样缓冲区和已发布的报告
+static task_profiler_task_t s_cur[TASK_PROFILER_MAX_TASKS];
+static task_profiler_report_t s_report;
+
+// 已告警过栈余量不足的任务编号，避免每个窗口重复告警
+static uint32_t s_stack_warned[TASK_PROFILER_MAX_TASKS];
+static size_t s_stack_warned_count = 0;
+
+#ifdef ESP_PLATFORM
+static SemaphoreHandle_t s_report_mutex = NULL;
+#define REPORT_LOCK()   xSemaphoreTake(s_report_mutex, portMAX_DELAY)
+#define REPORT_UNLOCK() xSemaphoreGive(s_report_mutex)
+#else
+#define REPORT_LOCK()
+#define REPORT_UNLOCK()
+#endif
+
+/* ==================== FreeRTOS采样来源 ==================== */
+
+#ifdef ESP_PLATFORM
+#if configUSE_TRACE_FACILITY
+static size_t freertos_sample_tasks(task_profiler_task_t *out, size_t max)
+{
+    static TaskStatus_t status[TASK_PROFILER_MAX_TASKS];
+
+    UBaseType_t n = uxTaskGetSystemState(status, TASK_PROFILER_MAX_TASKS, NULL);
+    if (n == 0 && uxTaskGetNumberOfTasks() > TASK_PROFILER_MAX_TASKS) {
+        ESP_LOGW(TAG, "⚠️ 任务数超过 %d，无法采样", TASK_PROFILER_MAX_TASKS);
+    }
+
+    size_t count = 0;
+    for (UBaseType_t i = 0; i < n && count < max; i++) {
+        task_profiler_task_t *t = &out[count++];
+        strncpy(t->name, status[i].pcTaskName, sizeof(t->name) - 1);
+        t->name[sizeof(t->name) - 1] = '\0';
+        t->task_number = status[i].xTaskNumber;
+#if configGENERATE_RUN_TIME_STATS
+        t->runtime = (uint32_t)status[i].ulRunTimeCounter;
+#else
+        t->runtime = 0;
+#endif
+        // ESP-IDF中栈以字节为单位，高水位也是字节
+        t->stack_hwm = status[i].usStackHighWaterMark;
+        t->priority = (uint8_t)status[i].uxCurrentPriority;
+#if configTASKLIST_INCLUDE_COREID
+        t->core = (status[i].xCoreID == tskNO_AFFINITY) ? -1 : (int8_t)status[i].xCoreID;
+#else
+        t->core = -1;
+#endif
+    }
+    return count;
+}
+
+static void freertos_sample_heap(task_profiler_heap_t *out)
+{
+    out->total_free = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    out->largest_free_block = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    out->min_free = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+}
+
+static uint32_t freertos_now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+#endif // configUSE_TRACE_FACILITY
+#endif // ESP_PLATFORM
+
+/* ==================== 窗口计算 ==================== */
+
+static const task_profiler_task_t *find_prev(uint32_t task_number)
+{
+    for (size_t i = 0; i < s_prev_count; i++) {
+        if (s_prev[i].task_number == task_number) {
+            return &s_prev[i];
+        }
+    }
+    return NULL;
+}
+
+static void warn_low_stack(const task_profiler_task_t *t)
+{
+    if (t->stack_hwm >= CONFIG_TASK_PROFILER_STACK_WARN_BYTES) {
+        return;
+    }
+    for (size_t i = 0; i < s_stack_warned_count; i++) {
+        if (s_stack_warned[i] == t->task_number) {
+            return;
+        }
+    }
+    if (s_stack_warned_count < TASK_PROFILER_MAX_TASKS) {
+        s_stack_warned[s_stack_warned_count++] = t->task_number;
+    }
+    ESP_LOGW(TAG, "⚠️ 任务 %s 栈剩余仅 %lu 字节，存在溢出风险",
+             t->name, (unsigned long)t->stack_hwm);
+}
+
+static void build_report(task_profiler_report_t *report, size_t count, uint32_t now_ms)
+{
+    memset(report, 0, sizeof(*report));
+    report->timestamp_ms = now_ms;
+    report->window_ms = now_ms - s_prev_ms;
+    report->task_count = count;
+    report->min_stack_hwm = UINT32_MAX;
+
+    // 所有任务（含IDLE）运行时间增量之和即窗口内全部核的可用时间
+    uint64_t total_delta = 0;
+    uint32_t deltas[TASK_PROFILER_MAX_TASKS];
+    for (size_t i = 0; i < count; i++) {
+        const task_profiler_task_t *prev = find_prev(s_cur[i].task_number);
+        // 窗口内新建的任务从0开始计
+        deltas[i] = s_cur[i].runtime - (prev ? prev->runtime : 0);
+        total_delta += deltas[i];
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        task_profiler_entry_t *e = &report->tasks[i];
+        e->task = s_cur[i];
+        if (s_source.runtime_stats && total_delta > 0) {
+            e->cpu_permille = (int16_t)((deltas[i] * 1000ULL + total_delta / 2) / total_delta);
+        } else {
+            e->cpu_permille = -1;
+        }
+
+        if (s_cur[i].stack_hwm < report->min_stack_hwm) {
+            report->min_stack_hwm = s_cur[i].stack_hwm;
+            memcpy(report->min_stack_task, s_cur[i].name, sizeof(report->min_stack_task));
+        }
+        warn_low_stack(&s_cur[i]);
+    }
+
+    // 按CPU占用降序（任务数很少，插入排序即可）
+    for (size_t i = 1; i < count; i++) {
+        task_profiler_entry_t tmp = report->tasks[i];
+        size_t j = i;
+        while (j > 0 && report->tasks[j - 1].cpu_permille < tmp.cpu_permille) {
+            report->tasks[j] = report->tasks[j - 1];
+            j--;
+        }
+        report->tasks[j] = tmp;
+    }
+
+    s_source.sample_heap(&report->heap);
+    if (report->heap.total_free > 0) {
+        report->heap_frag_pct = (uint8_t)(100 - (uint64_t)report->heap.largest_free_block * 100 /
+                                               report->heap.total_free);
+    }
+    if (count == 0) {
+        report->min_stack_hwm = 0;
+    }
+}
+
+/* ==================== 对外接口 ==================== */
+
+esp_err_t task_profiler_init(const task_profiler_source_t *source)
+{
+    if (s_initialized) {
+        return ESP_OK;
+    }
+
+    if (source) {
+        s_source = *source;
+    } else {
+#if defined(ESP_PLATFORM) && configUSE_TRACE_FACILITY
+        s_source.sample_tasks = freertos_sample_tasks;
+        s_source.sample_heap = freertos_sample_heap;
+        s_source.now_ms = freertos_now_ms;
+        s_source.runtime_stats = configGENERATE_RUN_TIME_STATS;
+#else
+        ESP_LOGW(TAG, "⚠️ 未开启FreeRTOS trace facility，任务分析不可用");
+        return ESP_ERR_NOT_SUPPORTED;
+#endif
+    }
+
+    if (!s_source.sample_tasks || !s_source.sample_heap || !s_source.now_ms) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+#ifdef ESP_PLATFORM
+    s_report_mutex = xSemaphoreCreateMutex();
+    if (!s_report_mutex) {
+        return ESP_ERR_NO_MEM;
+    }
+#endif
+
+    if (!s_source.runtime_stats) {
+        ESP_LOGW(TAG, "⚠️ 未开启运行时统计，报告中不含CPU占用");
+    }
+
+    s_has_baseline = false;
+    s_stack_warned_count = 0;
+    s_initialized = true;
+    ESP_LOGI(TAG, "✅ 任务分析器初始化完成");
+    return ESP_OK;
+}
+
+esp_err_t task_profiler_sample(void)
+{
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    size_t count = s_source.sample_tasks(s_cur, TASK_PROFILER_MAX_TASKS);
+    uint32_t now_ms = s_source.now_ms();
+
+    if (s_has_baseline) {
+        // 先在局部构建，持锁时间只有一次拷贝
+        static task_profiler_report_t next;
+        build_report(&next, count, now_ms);
+        REPORT_LOCK();
+        s_report = next;
+        REPORT_UNLOCK();
+    }
+
+    memcpy(s_prev, s_cur, count * sizeof(task_profiler_task_t));
+    s_prev_count = count;
+    s_prev_ms = now_ms;
+    s_has_baseline = true;
+    return ESP_OK;
+}
+
+esp_err_t task_profiler_get_report(task_profiler_report_t *report)
+{
+    if (!report) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    REPORT_LOCK();
+    *report = s_report;
+    REPORT_UNLOCK();
+    return report->window_ms > 0 ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+/* ==================== JSON输出 ==================== */
+
+esp_err_t task_profiler_report_json(const task_profiler_report_t *report,
+                                    char *buf, size_t buf_size, size_t *out_len)
+{
+    if (!report || !buf || buf_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    json_writer_t w;
+    json_writer_init(&w, buf, buf_size);
+    json_writer_printf(&w, "{\"window_ms\":%lu,\"heap\":{\"free\":%lu,\"largest\":%lu,\"min\":%lu,\"frag\":%u},",
+              (unsigned long)report->window_ms,
+              (unsigned long)report->heap.total_free,
+              (unsigned long)report->heap.largest_free_block,
+              (unsigned long)report->heap.min_free,
+              (unsigned)report->heap_frag_pct);
+    json_writer_printf(&w, "\"stack_min\":{\"task\":\"%s\",\"free\":%lu},\"tasks\":[",
+              report->min_stack_task, (unsigned long)report->min_stack_hwm);
+
+    for (size_t i = 0; i < report->task_count; i++) {
+        const task_profiler_entry_t *e = &report->tasks[i];
+        json_writer_printf(&w, "%s{\"n\":\"%s\",\"cpu\":", i ? "," : "", e->task.name);
+        if (e->cpu_permille >= 0) {
+            json_writer_printf(&w, "%d.%d", e->cpu_permille / 10, e->cpu_permille % 10);
+        } else {
+            json_writer_printf(&w, "-1");
+        }
+        json_writer_printf(&w, ",\"stack\":%lu,\"prio\":%u,\"core\":%d}",
+                  (unsigned long)e->task.stack_hwm, (unsigned)e->task.priority, (int)e->task.core);
+    }
+    json_writer_printf(&w, "]}");
+
+    if (w.overflow) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    if (out_len) {
+        *out_len = w.len;
+    }
+    return ESP_OK;
+}
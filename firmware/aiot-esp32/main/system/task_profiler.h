@@ -0,0 +1,147 @@
+/**
+ * @file task_profiler.h
+ * @brief 任务CPU占用与栈水位分析
+ *
+ * 周期性采样FreeRTOS运行时统计（uxTaskGetSystemState），按相邻两次采样的
+ * 差值计算每个任务的CPU占用率，同时记录栈历史最小剩余和堆碎片率。
+ * 最近一个窗口的报告可通过MQTT命令 {"cmd":"get_status"} 获取。
+ *
+ * 采样数据来源通过 task_profiler_source_t 抽象：设备上读取FreeRTOS，
+ * 主机模拟（tools/host/task_profile_sim.c）提供模拟任务表，报告格式完全相同。
+ *
+ * 设备端需要在sdkconfig中开启：
+ *   CONFIG_FREERTOS_USE_TRACE_FACILITY=y
+ *   CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS=y
+ * 未开启运行时统计时报告中只有栈和堆数据（cpu字段为-1）。
+ */
+
+#ifndef TASK_PROFILER_H
+#define TASK_PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TASK_PROFILER_MAX_TASKS         32      ///< 最多统计的任务数
+#define TASK_PROFILER_NAME_LEN          16      ///< 任务名长度（同configMAX_TASK_NAME_LEN）
+
+#ifndef CONFIG_TASK_PROFILER_STACK_WARN_BYTES
+#define CONFIG_TASK_PROFILER_STACK_WARN_BYTES 512  ///< 栈剩余低于该值时告警
+#endif
+
+/**
+ * @brief 单个任务的一次采样
+ */
+typedef struct {
+    char name[TASK_PROFILER_NAME_LEN]; ///< 任务名
+    uint32_t task_number;          ///< FreeRTOS任务编号（跨采样匹配任务）
+    uint32_t runtime;              ///< 累计运行时间（运行时统计时钟，ESP-IDF为微秒）
+    uint32_t stack_hwm;            ///< 栈历史最小剩余（字节）
+    uint8_t priority;              ///< 当前优先级
+    int8_t core;                   ///< 绑定的核，-1表示不绑定
+} task_profiler_task_t;
+
+/**
+ * @brief 堆状态（内部8位可访问内存）
+ */
+typedef struct {
+    uint32_t total_free;           ///< 当前空闲总量
+    uint32_t largest_free_block;   ///< 最大连续空闲块
+    uint32_t min_free;             ///< 开机以来最小空闲量
+} task_profiler_heap_t;
+
+/**
+ * @brief 采样数据来源
+ */
+typedef struct {
+    /**
+     * @brief 采样所有任务
+     * @param out 输出数组
+     * @param max 数组容量
+     * @return size_t 实际任务数
+     */
+    size_t (*sample_tasks)(task_profiler_task_t *out, size_t max);
+    void (*sample_heap)(task_profiler_heap_t *out);   ///< 采样堆状态
+    uint32_t (*now_ms)(void);                         ///< 当前时间（毫秒）
+    bool runtime_stats;                               ///< runtime字段是否有效
+} task_profiler_source_t;
+
+/**
+ * @brief 报告中的单个任务
+ */
+typedef struct {
+    task_profiler_task_t task;     ///< 窗口结束时的采样
+    int16_t cpu_permille;          ///< 窗口内CPU占用（千分比，所有核合计为1000），-1表示不可用
+} task_profiler_entry_t;
+
+/**
+ * @brief 一个采样窗口的报告
+ */
+typedef struct {
+    uint32_t timestamp_ms;         ///< 窗口结束时间
+    uint32_t window_ms;            ///< 窗口长度（0表示尚未完成第一个窗口）
+    size_t task_count;             ///< 任务数
+    task_profiler_entry_t tasks[TASK_PROFILER_MAX_TASKS]; ///< 按CPU占用降序
+    task_profiler_heap_t heap;     ///< 堆状态
+    uint8_t heap_frag_pct;         ///< 堆碎片率：100 - 最大空闲块 * 100 / 空闲总量
+    uint32_t min_stack_hwm;        ///< 所有任务中最小的栈剩余
+    char min_stack_task[TASK_PROFILER_NAME_LEN]; ///< 栈剩余最小的任务
+} task_profiler_report_t;
+
+/**
+ * @brief 初始化分析器
+ *
+ * @param source 采样来源，NULL表示使用FreeRTOS（仅设备端可用）
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_NOT_SUPPORTED: 主机构建未提供来源，或FreeRTOS未开启trace facility
+ */
+esp_err_t task_profiler_init(const task_profiler_source_t *source);
+
+/**
+ * @brief 采样一次并生成上一次采样以来的窗口报告
+ *
+ * 由周期任务调用（system_monitor_task每5秒一次），第一次调用只建立基线。
+ *
+ * @return esp_err_t
+ */
+esp_err_t task_profiler_sample(void);
+
+/**
+ * @brief 获取最近一个窗口的报告
+ *
+ * @param report 输出报告
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_STATE: 尚未完成第一个窗口
+ */
+esp_err_t task_profiler_get_report(task_profiler_report_t *report);
+
+/**
+ * @brief 把报告格式化为JSON
+ *
+ * 格式：{"window_ms":5000,"heap":{"free":..,"largest":..,"min":..,"frag":12},
+ *        "stack_min":{"task":"..","free":..},
+ *        "tasks":[{"n":"mqtt_task","cpu":12.5,"stack":1820,"prio":5,"core":-1},...]}
+ *
+ * @param report 报告
+ * @param buf 输出缓冲区
+ * @param buf_size 缓冲区大小
+ * @param out_len 输出长度（可为NULL）
+ * @return esp_err_t
+ *   - ESP_OK: 成功
+ *   - ESP_ERR_INVALID_SIZE: 缓冲区不足
+ */
+esp_err_t task_profiler_report_json(const task_profiler_report_t *report,
+                                    char *buf, size_t buf_size, size_t *out_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TASK_PROFILER_H
@@ -53,6 +53,12 @@ esp_err_t wechat_ble_cmd_process(const uint8_t *data, uint16_t len)
     
     ESP_LOGI(TAG, "Processing command: 0x%02X, seq: %d, len: %d", packet->cmd, packet->seq, packet->len);
 
+    // 传输层交付的是完整消息，数据长度与包头不符说明客户端组包错误
+    if (packet->len > len - sizeof(wechat_ble_cmd_packet_t)) {
+        ESP_LOGW(TAG, "Truncated command: header len %d, payload %d", packet->len, (int)(len - sizeof(wechat_ble_cmd_packet_t)));
+        return wechat_ble_cmd_send_response(packet->cmd, packet->seq, WECHAT_BLE_STATUS_INVALID_PARAM, NULL, 0);
+    }
+
     switch (packet->cmd) {
         case WECHAT_BLE_CMD_GET_DEVICE_INFO:
             return wechat_ble_cmd_handle_get_device_info(packet->seq);
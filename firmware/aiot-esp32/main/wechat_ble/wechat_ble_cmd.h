@@ -60,6 +60,8 @@ esp_err_t wechat_ble_cmd_deinit(void);
 /**
  * @brief 处理接收到的命令
  * 
+ * 传输层（ble_frag）已把分片或长写重组为完整的命令包。
+ * 
  * @param data 命令数据
  * @param len 数据长度
  * @return esp_err_t 
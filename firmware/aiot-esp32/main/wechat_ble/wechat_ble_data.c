@@ -6,6 +6,7 @@
  */
 
 #include "wechat_ble_data.h"
+#include "wechat_ble_gatt.h"
 #include "esp_log.h"
 #include "esp_system.h"
 #include "esp_wifi.h"
@@ -264,11 +265,7 @@ bool wechat_ble_data_has_mqtt_config(void)
 // 私有函数实现
 static esp_err_t wechat_ble_data_send_internal(const uint8_t *data, uint16_t len)
 {
-    // 这里应该通过GATT特征值发送数据
-    // 暂时只打印日志
-    ESP_LOGI(TAG, "Sending data: %d bytes", len);
-    ESP_LOG_BUFFER_HEX(TAG, data, len);
-    
-    // 实际实现需要调用GATT发送函数
-    return ESP_OK;
+    // 响应包第一个字节是命令类型；分片和流控由GATT层的ble_frag完成
+    ESP_LOGD(TAG, "Sending data: %d bytes", len);
+    return wechat_ble_gatt_send_response((wechat_ble_cmd_t)data[0], data, len);
 }
\ No newline at end of file
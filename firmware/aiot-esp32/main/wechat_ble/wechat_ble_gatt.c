@@ -1,6 +1,10 @@
 /**
  * @file wechat_ble_gatt.c
  * @brief 微信小程序蓝牙GATT服务实现
+ *
+ * 特征值的读写和通知走 ble_frag 分片传输：命令包可以分片写入或长写，
+ * 响应包按协商的MTU分片通知（小程序连接后调用 wx.setBLEMTU 提高MTU）。
+ * 小程序写版本特征值（0x2346）后才使用分片格式，老版本小程序保持兼容模式。
  * @version 1.0
  * @date 2024-01-20
  */
@@ -12,6 +16,7 @@
 #include "esp_gap_ble_api.h"
 #include "esp_gatts_api.h"
 #include "esp_bt_main.h"
+#include "ble_frag_gatts.h"
 #include <string.h>
 
 static const char* TAG = "WECHAT_BLE_GATT";
@@ -22,6 +27,7 @@ static esp_gatt_if_t g_gatts_if = ESP_GATT_IF_NONE;
 static uint16_t g_conn_id = 0;
 static uint16_t g_service_handle = 0;
 static uint16_t g_char_handle = 0;
+static ble_frag_handle_t s_frag = NULL;
 
 // 外部状态管理函数声明
 extern void wechat_ble_set_connection_state(bool connected, uint16_t conn_id);
@@ -30,6 +36,7 @@ extern void wechat_ble_trigger_event_callback(wechat_ble_event_type_t event_type
 // 服务UUID (16位)
 static const uint16_t wechat_ble_service_uuid = 0x1234;
 static const uint16_t wechat_ble_char_uuid = 0x2345;
+static const uint16_t wechat_ble_frag_version_uuid = 0x2346;
 
 // GATT UUID定义
 static const uint16_t primary_service_uuid = ESP_GATT_UUID_PRI_SERVICE;
@@ -38,6 +45,7 @@ static const uint16_t character_client_config_uuid = ESP_GATT_UUID_CHAR_CLIENT_C
 
 // 特征值属性
 static const uint8_t char_prop_read_write_notify = ESP_GATT_CHAR_PROP_BIT_READ | ESP_GATT_CHAR_PROP_BIT_WRITE | ESP_GATT_CHAR_PROP_BIT_NOTIFY;
+static const uint8_t char_prop_read_write = ESP_GATT_CHAR_PROP_BIT_READ | ESP_GATT_CHAR_PROP_BIT_WRITE;
 static uint16_t char_config_ccc = 0x0000;
 
 // 常量定义
@@ -91,7 +99,7 @@ esp_ble_adv_data_t wechat_ble_scan_rsp_data = {
 };
 
 // GATT属性表
-static const esp_gatts_attr_db_t gatt_db[4] = {
+static const esp_gatts_attr_db_t gatt_db[6] = {
     // 主服务声明
     [0] = {
         {ESP_GATT_AUTO_RSP},
@@ -119,10 +127,25 @@ static const esp_gatts_attr_db_t gatt_db[4] = {
         {ESP_UUID_LEN_16, (uint8_t *)&character_client_config_uuid, ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE,
          sizeof(uint16_t), sizeof(uint16_t), (uint8_t *)&char_config_ccc}
     },
+
+    // 分片版本特征值声明
+    [4] = {
+        {ESP_GATT_AUTO_RSP},
+        {ESP_UUID_LEN_16, (uint8_t *)&character_declaration_uuid, ESP_GATT_PERM_READ,
+         CHAR_DECLARATION_SIZE, CHAR_DECLARATION_SIZE, (uint8_t *)&char_prop_read_write}
+    },
+
+    // 分片版本特征值（由ble_frag应答：读返回版本，写入开启分片格式）
+    [5] = {
+        {ESP_GATT_RSP_BY_APP},
+        {ESP_UUID_LEN_16, (uint8_t *)&wechat_ble_frag_version_uuid, ESP_GATT_PERM_READ | ESP_GATT_PERM_WRITE,
+         sizeof(uint8_t), 0, NULL}
+    },
 };
 
 // 私有函数声明
 static void wechat_ble_gatt_create_service(void);
+static void wechat_ble_gatt_on_message(const uint8_t *data, size_t len, void *ctx);
 
 esp_err_t wechat_ble_gatt_init(void)
 {
@@ -162,6 +185,8 @@ esp_err_t wechat_ble_gatt_deinit(void)
         esp_ble_gatts_app_unregister(g_gatts_if);
         g_gatts_if = ESP_GATT_IF_NONE;
     }
+    ble_frag_close(s_frag);
+    s_frag = NULL;
 
     g_gatt_initialized = false;
     return ESP_OK;
@@ -169,16 +194,37 @@ esp_err_t wechat_ble_gatt_deinit(void)
 
 void wechat_ble_gatt_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param)
 {
+    // 特征值上的写入/长写、通知确认和拥塞由分片传输处理
+    if (ble_frag_gatts_event(s_frag, event, gatts_if, param)) {
+        return;
+    }
+
     switch (event) {
         case ESP_GATTS_REG_EVT:
             ESP_LOGI(TAG, "GATT app registered, app_id: %d", param->reg.app_id);
             g_gatts_if = gatts_if;
+            ble_frag_set_local_mtu();
+            if (!s_frag) {
+                ble_frag_config_t frag_config = BLE_FRAG_DEFAULT_CONFIG();
+                frag_config.name = "wechat";
+                frag_config.on_message = wechat_ble_gatt_on_message;
+                if (ble_frag_open(&frag_config, &s_frag) != ESP_OK) {
+                    ESP_LOGE(TAG, "Failed to create ble_frag channel");
+                }
+            }
             wechat_ble_gatt_create_service();
             break;
 
-        case ESP_GATTS_CREATE_EVT:
-            ESP_LOGI(TAG, "Service created, service_handle: %d", param->create.service_handle);
-            g_service_handle = param->create.service_handle;
+        case ESP_GATTS_CREAT_ATTR_TAB_EVT:
+            if (param->add_attr_tab.status != ESP_GATT_OK || param->add_attr_tab.num_handle != sizeof(gatt_db) / sizeof(gatt_db[0])) {
+                ESP_LOGE(TAG, "Create attribute table failed, status: 0x%x", param->add_attr_tab.status);
+                break;
+            }
+            g_service_handle = param->add_attr_tab.handles[0];
+            g_char_handle = param->add_attr_tab.handles[2];
+            ESP_LOGI(TAG, "Service created, service_handle: %d", g_service_handle);
+            ble_frag_bind(s_frag, gatts_if, g_char_handle, g_char_handle);
+            ble_frag_bind_version(s_frag, param->add_attr_tab.handles[5]);
             esp_ble_gatts_start_service(g_service_handle);
             break;
 
@@ -206,15 +252,8 @@ void wechat_ble_gatt_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gat
             break;
 
         case ESP_GATTS_WRITE_EVT:
-            ESP_LOGI(TAG, "Data received, len: %d", param->write.len);
-            ESP_LOG_BUFFER_HEX(TAG, param->write.value, param->write.len);
-            
-            // 处理接收到的命令
-            wechat_ble_cmd_process(param->write.value, param->write.len);
-            
-            if (param->write.need_rsp) {
-                esp_ble_gatts_send_response(gatts_if, param->write.conn_id, param->write.trans_id, ESP_GATT_OK, NULL);
-            }
+            // 命令特征值已由ble_frag处理，这里只剩CCCD（自动应答）
+            ESP_LOGD(TAG, "Descriptor write, handle: %d, len: %d", param->write.handle, param->write.len);
             break;
 
         case ESP_GATTS_READ_EVT:
@@ -234,21 +273,18 @@ void wechat_ble_gatt_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gat
 
 esp_err_t wechat_ble_gatt_send_response(wechat_ble_cmd_t cmd, const uint8_t *data, uint16_t len)
 {
-    if (!g_gatt_initialized || g_gatts_if == ESP_GATT_IF_NONE || g_conn_id == 0) {
+    if (!g_gatt_initialized || g_gatts_if == ESP_GATT_IF_NONE) {
         return ESP_ERR_INVALID_STATE;
     }
 
-    if (len > WECHAT_BLE_MAX_DATA_LEN) {
-        return ESP_ERR_INVALID_SIZE;
-    }
-
-    esp_err_t ret = esp_ble_gatts_send_indicate(g_gatts_if, g_conn_id, g_char_handle, len, (uint8_t*)data, false);
+    // 入队后按MTU分片通知，连接状态由ble_frag跟踪（conn_id 0 是有效连接）
+    esp_err_t ret = ble_frag_send(s_frag, data, len);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to send indication: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "Failed to send response 0x%02X: %s", cmd, esp_err_to_name(ret));
         return ret;
     }
 
-    ESP_LOGI(TAG, "Response sent successfully, len: %d", len);
+    ESP_LOGI(TAG, "Response queued, len: %d, MTU: %d", len, ble_frag_get_mtu(s_frag));
     return ESP_OK;
 }
 
@@ -273,4 +309,11 @@ esp_err_t wechat_ble_gatt_disconnect_all(void)
 static void wechat_ble_gatt_create_service(void)
 {
     esp_ble_gatts_create_attr_tab(gatt_db, g_gatts_if, sizeof(gatt_db) / sizeof(gatt_db[0]), 0);
-}
\ No newline at end of file
+}
+
+static void wechat_ble_gatt_on_message(const uint8_t *data, size_t len, void *ctx)
+{
+    (void)ctx;
+    ESP_LOGI(TAG, "Command received, len: %d", (int)len);
+    wechat_ble_cmd_process(data, (uint16_t)len);
+}
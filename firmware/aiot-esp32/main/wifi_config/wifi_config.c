@@ -10,11 +10,14 @@
 #include "esp_netif.h"
 #include "esp_http_server.h"
 #include "esp_log.h"
-#include "nvs_flash.h"
-#include "nvs.h"
+#include "config_cache.h"
+#include "json_writer.h"  // 有界JSON输出
+#include "live_provision.h"  // 不重启配网
+#include "esp_rom_crc.h"
 #include "cJSON.h"
 #include <string.h>
 #include <ctype.h>
+#include <inttypes.h>
 
 static const char *TAG = "wifi_config";
 
@@ -31,17 +34,16 @@ static esp_netif_t *s_ap_netif = NULL;
 #define CONFIG_AP_MAX_CONNECTIONS 4
 #define CONFIG_WEB_PORT 80
 
-// NVS存储键
-#define NVS_NAMESPACE "wifi_config"
-#define NVS_KEY_FORCE_CONFIG "force_config"
-#define NVS_KEY_WIFI_SSID "wifi_ssid"
-#define NVS_KEY_WIFI_PASS "wifi_pass"
-#define NVS_KEY_CONFIGURED "configured"
+// WiFi配置保存在NVS的wifi_config命名空间，读写经由配置缓存（system/config_cache）
 // 注意：服务器地址统一使用server_config命名空间中的base_address，不再单独存储
 
 // 全局配置数据
 static char s_ap_ssid[32] = {0};
 
+// 配网页面（web/config.html，构建时gzip压缩后嵌入固件，见main/CMakeLists.txt）
+extern const uint8_t config_html_gz_start[] asm("_binary_config_html_gz_start");
+extern const uint8_t config_html_gz_end[]   asm("_binary_config_html_gz_end");
+
 /**
  * @brief HTML属性值转义函数（转义引号、&等特殊字符）
  */
@@ -99,6 +101,7 @@ static void html_escape_attribute(const char *input, char *output, size_t output
 static esp_err_t config_get_handler(httpd_req_t *req);
 static esp_err_t config_post_handler(httpd_req_t *req);
 static esp_err_t config_current_handler(httpd_req_t *req);
+static esp_err_t config_status_handler(httpd_req_t *req);
 static void wifi_event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data);
 
 /**
@@ -273,6 +276,13 @@ static const httpd_uri_t config_current = {
     .user_ctx  = NULL
 };
 
+static const httpd_uri_t config_status = {
+    .uri       = "/config/status",
+    .method    = HTTP_GET,
+    .handler   = config_status_handler,
+    .user_ctx  = NULL
+};
+
 /**
  * @brief 生成AP模式SSID
  * 
@@ -365,6 +375,7 @@ static esp_err_t start_webserver(void) {
         httpd_register_uri_handler(s_server, &config_get);
         httpd_register_uri_handler(s_server, &config_post);
         httpd_register_uri_handler(s_server, &config_current);
+        httpd_register_uri_handler(s_server, &config_status);
         
         // 注册Captive Portal处理器（必须在配网处理器之后，学习xiaozhi-esp32架构）
         esp_err_t ret = captive_portal_register_handlers(s_server);
@@ -394,20 +405,59 @@ static void stop_webserver(void) {
 }
 
 /**
- * @brief 获取当前配置（简化版，返回空值）
+ * @brief 获取当前配置（配网页面加载后读取，用于自动填充）
+ *
+ * 从配置缓存读取，不访问NVS；WiFi密码不返回。
  */
 static esp_err_t config_current_handler(httpd_req_t *req) {
-    // 简化版，不读取NVS配置，直接返回空值
-    // 这样可以避免在HTTP请求处理中访问NVS导致的内存访问问题
-    const char *json_response = "{\"ssid\":\"\",\"password\":\"\",\"server_address\":\"\"}";
-    
+    char ssid[32];                     // 与 config_snapshot_t 字段大小一致
+    char server_address[64];
+    config_cache_get_wifi(ssid, sizeof(ssid), NULL, 0);
+    config_cache_get_server_address(server_address, sizeof(server_address));
+
+    // 字段全是引号/反斜杠时也放得下；控制字符按\u00XX转义更长，放不下时返回500
+    char json_response[64 + (sizeof(ssid) + sizeof(server_address)) * 2];
+    json_writer_t w;
+    json_writer_init(&w, json_response, sizeof(json_response));
+    json_writer_printf(&w, "{\"ssid\":");
+    json_writer_string(&w, ssid);
+    json_writer_printf(&w, ",\"password\":\"\",\"server_address\":");
+    json_writer_string(&w, server_address);
+    json_writer_printf(&w, "}");
+
+    size_t len = 0;
+    if (json_writer_finish(&w, &len) != ESP_OK) {
+        ESP_LOGE(TAG, "❌ 当前配置JSON超出缓冲区");
+        httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Config too long");
+        return ESP_FAIL;
+    }
+
     httpd_resp_set_type(req, "application/json");
-    httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    httpd_resp_send(req, json_response, len);
     return ESP_OK;
 }
 
 /**
- * @brief 配置页面GET处理器（简化版，不读取NVS配置）
+ * @brief 配网页面的ETag（gzip数据的CRC32，首次请求时计算）
+ *
+ * 页面随固件一起变化，ETag不需要持久化；固件升级后内容变了，ETag随之变化。
+ */
+static const char *config_page_etag(void) {
+    static char etag[12];
+    if (etag[0] == '\0') {
+        uint32_t crc = esp_rom_crc32_le(0, config_html_gz_start, config_html_gz_end - config_html_gz_start);
+        snprintf(etag, sizeof(etag), "\"%08" PRIx32 "\"", crc);
+    }
+    return etag;
+}
+
+/**
+ * @brief 配置页面GET处理器
+ *
+ * 页面是构建时gzip压缩、嵌入固件的静态资源（web/config.html），直接从flash发送，
+ * 不分配内存；已保存的配置由页面脚本从 /config/current 读取。
+ * 浏览器带If-None-Match且ETag一致时返回304，不重发页面。
  */
 static esp_err_t config_get_handler(httpd_req_t *req) {
     ESP_LOGI(TAG, "📱 收到配网页面请求: %s", req->uri);
@@ -429,157 +479,24 @@ static esp_err_t config_get_handler(httpd_req_t *req) {
         }
     }
     
-    ESP_LOGI(TAG, "   ✅ 显示配网页面");
-    
-    // 尝试读取已保存的服务器地址（如果存在则自动填充，否则使用默认值）
-    char saved_server_address[128] = "";  // 默认配网服务器地址（用户需在配网时输入）
-    unified_server_config_t srv_config = {0};
-    if (server_config_load_from_nvs(&srv_config) == ESP_OK && strlen(srv_config.base_address) > 0) {
-        strncpy(saved_server_address, srv_config.base_address, sizeof(saved_server_address) - 1);
-        ESP_LOGI(TAG, "   📋 读取到已保存的服务器地址: %s", saved_server_address);
-    } else {
-        ESP_LOGI(TAG, "   ℹ️  未找到已保存的服务器地址，使用默认值: %s", saved_server_address);
-    }
-    
-    // HTML页面模板（将在后面动态插入服务器地址）
-    const char *html_template =
-        "<!DOCTYPE html>"
-        "<html><head>"
-        "<meta charset='UTF-8'>"
-        "<meta name='viewport' content='width=device-width, initial-scale=1.0'>"
-        "<title>AIOT设备配网</title>"
-        "<style>"
-        "body{font-family:Arial,sans-serif;margin:0;padding:20px;background:#f5f5f5}"
-        ".container{max-width:500px;margin:0 auto;background:white;padding:30px;border-radius:10px;box-shadow:0 2px 10px rgba(0,0,0,0.1)}"
-        "h1{text-align:center;color:#333;margin-bottom:30px}"
-        ".form-group{margin-bottom:20px}"
-        "label{display:block;margin-bottom:5px;color:#555;font-weight:bold}"
-        "input[type=text],input[type=password]{width:100%%;padding:10px;border:1px solid #ddd;border-radius:5px;font-size:16px;box-sizing:border-box}"
-        "input[type=text]:focus,input[type=password]:focus{border-color:#007bff;outline:none}"
-        "button{width:100%%;padding:12px;background:#007bff;color:white;border:none;border-radius:5px;font-size:16px;cursor:pointer}"
-        "button:hover{background:#0056b3}"
-        ".status{margin-top:20px;padding:10px;border-radius:5px;text-align:center}"
-        ".success{background:#d4edda;color:#155724;border:1px solid #c3e6cb}"
-        ".error{background:#f8d7da;color:#721c24;border:1px solid #f5c6cb}"
-        ".info{background:#d1ecf1;color:#0c5460;border:1px solid #bee5eb}"
-        "</style>"
-        "</head><body>"
-        "<div class='container'>"
-        "<h1>AIOT Device Configuration</h1>"
-        "<form id='configForm' method='POST' action='/config'>"
-        "<div class='form-group'>"
-        "<label for='ssid'>WiFi Name (SSID):</label>"
-        "<input type='text' id='ssid' name='ssid' required placeholder='Enter WiFi name'>"
-        "</div>"
-        "<div class='form-group'>"
-        "<label for='password'>WiFi Password:</label>"
-        "<input type='password' id='password' name='password' placeholder='Enter WiFi password (optional)'>"
-        "</div>"
-        "<div class='form-group'>"
-        "<label for='server_address'>Server Address:</label>"
-        "<input type='text' id='server_address' name='server_address' value='%s' placeholder='http://192.168.1.100 or https://demo.aiot.com' required>"
-        "</div>"
-        "<button type='submit'>Save Configuration</button>"
-        "</form>"
-        "<div id='status'></div>"
-        "</div>"
-        "<script>"
-        "console.log('🔧 配网页面JavaScript开始执行');"
-        ""
-        "// 页面加载完成后执行"
-        "window.addEventListener('DOMContentLoaded', function() {"
-        "console.log('📄 DOM加载完成');"
-        ""
-        "// 自动填充已保存的服务器地址"
-        "var savedServerAddress = '%s';"
-        "console.log('📋 准备填充服务器地址:', savedServerAddress);"
-        "var serverInput = document.getElementById('server_address');"
-        "if (serverInput && savedServerAddress && savedServerAddress.length > 0) {"
-        "serverInput.value = savedServerAddress;"
-        "console.log('✅ 服务器地址已自动填充');"
-        "} else {"
-        "console.log('⚠️ 服务器地址为空或输入框未找到');"
-        "}"
-        ""
-        "// 绑定表单提交事件"
-        "var form = document.getElementById('configForm');"
-        "if (!form) {"
-        "console.error('❌ 表单元素未找到！');"
-        "return;"
-        "}"
-        "console.log('✅ 表单元素已找到，绑定提交事件');"
-        ""
-        "form.addEventListener('submit', function(e) {"
-        "console.log('📝 表单提交事件触发');"
-        "e.preventDefault();"
-        "console.log('✅ 已阻止默认提交行为');"
-        ""
-        "var formData = new FormData(e.target);"
-        "var data = {};"
-        "formData.forEach(function(value, key) {"
-        "data[key] = value;"
-        "console.log('  - ' + key + ':', value);"
-        "});"
-        ""
-        "document.getElementById('status').innerHTML = '<div class=\"info\">Saving configuration...</div>';"
-        "console.log('📤 发送POST请求到 /config');"
-        ""
-        "fetch('/config', {"
-        "method: 'POST',"
-        "headers: {'Content-Type': 'application/json'},"
-        "body: JSON.stringify(data)"
-        "})"
-        ".then(function(response) {"
-        "console.log('📥 收到响应，状态:', response.status);"
-        "return response.json();"
-        "})"
-        ".then(function(data) {"
-        "console.log('📦 响应数据:', data);"
-        "if(data.success) {"
-        "console.log('✅ 配置保存成功');"
-        "document.getElementById('status').innerHTML = '<div class=\"success\">Configuration saved! Device will restart and connect to WiFi...</div>';"
-        "} else {"
-        "console.error('❌ 配置保存失败:', data.message);"
-        "document.getElementById('status').innerHTML = '<div class=\"error\">Failed to save: ' + (data.message || 'Unknown error') + '</div>';"
-        "}"
-        "})"
-        ".catch(function(error) {"
-        "console.error('❌ 网络错误:', error);"
-        "document.getElementById('status').innerHTML = '<div class=\"error\">Network error: ' + error.message + '</div>';"
-        "});"
-        ""
-        "return false;"
-        "}, false);"
-        ""
-        "console.log('✅ 表单提交事件已绑定');"
-        "});"
-        ""
-        "console.log('🔧 配网页面JavaScript执行完成');"
-        "</script>"
-        "</body></html>";
-    
-    // 分配缓冲区并生成完整HTML（插入服务器地址）
-    // 注意：HTML模板中有2个%s占位符（HTML value属性和JavaScript变量）
-    size_t html_size = strlen(html_template) + strlen(saved_server_address) * 2 + 200;
-    char *html_response = malloc(html_size);
-    if (!html_response) {
-        ESP_LOGE(TAG, "分配HTML响应缓冲区失败");
-        httpd_resp_send_500(req);
-        return ESP_FAIL;
+    const char *etag = config_page_etag();
+    httpd_resp_set_hdr(req, "ETag", etag);
+    // 每次使用前向设备确认（命中时只有304头），固件升级后不会用到旧页面
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+
+    char if_none_match[sizeof("\"00000000\"") + 2] = {0};
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) == ESP_OK &&
+        strcmp(if_none_match, etag) == 0) {
+        ESP_LOGI(TAG, "   ✅ 配网页面未变化（304）");
+        httpd_resp_set_status(req, "304 Not Modified");
+        httpd_resp_send(req, NULL, 0);
+        return ESP_OK;
     }
-    
-    // 使用snprintf插入服务器地址（两个%s都替换成相同的地址）
-    int written = snprintf(html_response, html_size, html_template, 
-                          saved_server_address,  // 第1个%s: HTML value属性
-                          saved_server_address); // 第2个%s: JavaScript变量
-    
-    ESP_LOGI(TAG, "   📤 发送配网页面，已插入服务器地址: '%s' (写入%d字节)", 
-             saved_server_address, written);
-    
+
+    ESP_LOGI(TAG, "   ✅ 显示配网页面（gzip %d字节）", (int)(config_html_gz_end - config_html_gz_start));
     httpd_resp_set_type(req, "text/html");
-    httpd_resp_send(req, html_response, HTTPD_RESP_USE_STRLEN);
-    
-    free(html_response);
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    httpd_resp_send(req, (const char *)config_html_gz_start, config_html_gz_end - config_html_gz_start);
     return ESP_OK;
 }
 
@@ -702,87 +619,70 @@ static esp_err_t config_post_handler(httpd_req_t *req) {
     ESP_LOGI(TAG, "      密码: %s (长度: %zu字节)", strlen(password_str) > 0 ? "***" : "(空)", strlen(password_str));
     ESP_LOGI(TAG, "      服务器: '%s'", server_address_str);
     
-    // 保存WiFi配置
-    ESP_LOGI(TAG, "   正在保存WiFi配置...");
-    wifi_config_data_t config = {0};
-    safe_strncpy(config.ssid, ssid_str, sizeof(config.ssid));
-    
-    if (strlen(password_str) > 0) {
-        safe_strncpy(config.password, password_str, sizeof(config.password));
+    // 清理JSON对象（参数已复制）
+    if (json) {
+        cJSON_Delete(json);
     }
     
-    config.configured = true;
-    
-    esp_err_t err = wifi_config_save(&config);
-    if (err == ESP_OK) {
-        ESP_LOGI(TAG, "   ✅ WiFi配置保存成功");
+    // 处理用户输入的服务器地址
+    // 如果用户输入了http://或https://前缀，保留；如果没有，默认添加http://
+    // 确保结尾不包含斜杠
+    char cleaned_address[256] = {0};
+    if (strncmp(server_address_str, "http://", 7) == 0 || strncmp(server_address_str, "https://", 8) == 0) {
+        // 用户已输入协议前缀，直接使用
+        strncpy(cleaned_address, server_address_str, sizeof(cleaned_address) - 1);
+        ESP_LOGI(TAG, "检测到用户输入包含协议前缀，保留");
     } else {
-        ESP_LOGE(TAG, "   ❌ WiFi配置保存失败: %s", esp_err_to_name(err));
+        // 用户未输入协议前缀，默认添加http://
+        snprintf(cleaned_address, sizeof(cleaned_address), "http://%s", server_address_str);
+        ESP_LOGI(TAG, "用户输入未包含协议前缀，自动添加http://");
     }
-    
-    // 清理JSON对象（如果使用了JSON解析）
-    if (json) {
-        cJSON_Delete(json);
+    size_t len = strlen(cleaned_address);
+    if (len > 0 && cleaned_address[len - 1] == '/') {
+        cleaned_address[len - 1] = '\0';
+        ESP_LOGI(TAG, "去除服务器地址结尾的斜杠");
     }
     
-    // 保存服务器地址到server_config命名空间
-    if (err == ESP_OK) {
-        ESP_LOGI(TAG, "   正在保存服务器配置...");
-        unified_server_config_t srv_config = {0};
-        const char *server_addr = server_address_str;
-        char cleaned_address[256] = {0};
-        
-        // 处理用户输入的服务器地址
-        // 如果用户输入了http://或https://前缀，保留；如果没有，默认添加http://
-        // 确保结尾不包含斜杠
-        if (strncmp(server_addr, "http://", 7) == 0 || strncmp(server_addr, "https://", 8) == 0) {
-            // 用户已输入协议前缀，直接使用
-            strncpy(cleaned_address, server_addr, sizeof(cleaned_address) - 1);
-            cleaned_address[sizeof(cleaned_address) - 1] = '\0';
-            ESP_LOGI(TAG, "检测到用户输入包含协议前缀，保留");
-        } else {
-            // 用户未输入协议前缀，默认添加http://
-            snprintf(cleaned_address, sizeof(cleaned_address), "http://%s", server_addr);
-            ESP_LOGI(TAG, "用户输入未包含协议前缀，自动添加http://");
-        }
-        
-        // 去除结尾的斜杠（如果有）
-        size_t len = strlen(cleaned_address);
-        if (len > 0 && cleaned_address[len - 1] == '/') {
-            cleaned_address[len - 1] = '\0';
-            ESP_LOGI(TAG, "去除服务器地址结尾的斜杠");
-        }
-        
-        strncpy(srv_config.base_address, cleaned_address, sizeof(srv_config.base_address) - 1);
-        srv_config.base_address[sizeof(srv_config.base_address) - 1] = '\0';
-        srv_config.http_port = DEFAULT_HTTP_PORT;
-        srv_config.mqtt_port = DEFAULT_MQTT_PORT;
+    wifi_config_data_t config = {0};
+    safe_strncpy(config.ssid, ssid_str, sizeof(config.ssid));
+    safe_strncpy(config.password, password_str, sizeof(config.password));
+    config.configured = true;
+    
+    httpd_resp_set_type(req, "application/json");
+    
+    // 不重启配网：热点保持，先连接WiFi并探测配置服务器和它下发的MQTT broker，通过后才保存；
+    // 页面轮询 /config/status 获取进度和各阶段耗时
+    if (live_provision_is_ready()) {
+        live_provision_request_t live_req = {0};
+        safe_strncpy(live_req.ssid, ssid_str, sizeof(live_req.ssid));
+        safe_strncpy(live_req.password, password_str, sizeof(live_req.password));
+        safe_strncpy(live_req.server_address, cleaned_address, sizeof(live_req.server_address));
+        live_req.mqtt_port = DEFAULT_MQTT_PORT;
         
-        esp_err_t srv_err = server_config_save_to_nvs(&srv_config);
-        if (srv_err != ESP_OK) {
-            ESP_LOGE(TAG, "   ❌ 服务器地址保存失败: %s", esp_err_to_name(srv_err));
-            err = srv_err;
+        esp_err_t err = live_provision_start(&live_req, NULL, NULL);
+        if (err == ESP_OK) {
+            ESP_LOGI(TAG, "   📤 已开始连接验证（不重启）");
+            httpd_resp_sendstr(req, "{\"success\":true,\"live\":true,\"message\":\"Connecting\",\"status_url\":\"/config/status\"}");
+            trigger_event(WIFI_CONFIG_EVENT_CONFIG_RECEIVED, &config);
         } else {
-            ESP_LOGI(TAG, "   ✅ 服务器地址保存成功: %s (原始输入: %s)", 
-                     srv_config.base_address, server_address_str);
+            ESP_LOGE(TAG, "   ❌ 无法开始配网: %s", esp_err_to_name(err));
+            httpd_resp_sendstr(req, err == ESP_ERR_INVALID_STATE ?
+                               "{\"success\":false,\"message\":\"Provisioning already in progress\"}" :
+                               "{\"success\":false,\"message\":\"Invalid server address\"}");
         }
+        ESP_LOGI(TAG, "========================================");
+        return ESP_OK;
     }
     
-    // 发送响应
-    ESP_LOGI(TAG, "   正在发送HTTP响应...");
-    httpd_resp_set_type(req, "application/json");
+    // 未注册不重启配网时：保存后重启
+    esp_err_t err = wifi_config_commit(&config, cleaned_address);
     if (err == ESP_OK) {
         ESP_LOGI(TAG, "   📤 发送成功响应");
         httpd_resp_sendstr(req, "{\"success\":true,\"message\":\"Configuration saved successfully\"}");
         
         // 触发配置接收事件
-        ESP_LOGI(TAG, "   触发配置接收事件...");
         trigger_event(WIFI_CONFIG_EVENT_CONFIG_RECEIVED, &config);
         
-        // 清除强制配网标志（重要！避免重启后再次进入配网模式）
-        ESP_LOGI(TAG, "   清除强制配网标志...");
-        wifi_config_clear_force_flag();
-        
         // 延迟重启以便响应发送完成
         ESP_LOGI(TAG, "   等待1秒以确保响应发送完成...");
         vTaskDelay(pdMS_TO_TICKS(1000));
@@ -800,6 +700,22 @@ static esp_err_t config_post_handler(httpd_req_t *req) {
     return ESP_OK;
 }
 
+/**
+ * @brief 配网进度（页面提交后轮询）
+ */
+static esp_err_t config_status_handler(httpd_req_t *req) {
+    live_provision_status_t status;
+    live_provision_get_status(&status);
+    
+    char json_response[256];
+    size_t len = live_provision_format_status(&status, json_response, sizeof(json_response));
+    
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    httpd_resp_send(req, json_response, len);
+    return ESP_OK;
+}
+
 /**
  * @brief 初始化WiFi配网模块
  */
@@ -960,6 +876,25 @@ esp_err_t wifi_config_stop(void) {
     return ESP_OK;
 }
 
+/**
+ * @brief 配网完成：关闭热点、网页和DNS，保留STA连接
+ */
+esp_err_t wifi_config_finish(void) {
+    ESP_LOGI(TAG, "配网完成，关闭配网热点");
+    
+    stop_webserver();
+    esp_event_handler_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, &wifi_event_handler);
+    
+    wifi_mode_t mode = WIFI_MODE_NULL;
+    esp_err_t ret = esp_wifi_get_mode(&mode);
+    if (ret == ESP_OK && mode == WIFI_MODE_APSTA) {
+        ret = esp_wifi_set_mode(WIFI_MODE_STA);
+    }
+    
+    s_config_state = WIFI_CONFIG_STATE_IDLE;
+    return ret;
+}
+
 /**
  * @brief 获取当前配网状态
  */
@@ -971,89 +906,52 @@ wifi_config_state_t wifi_config_get_state(void) {
  * @brief 检查是否需要进入配网模式
  */
 bool wifi_config_should_start(void) {
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
-    if (err != ESP_OK) {
-        return false;
+    return config_cache_get_force_provision();
+}
+
+static uint32_t set_force_flag(config_snapshot_t *cfg, void *ctx) {
+    bool force = (ctx != NULL);
+    if (cfg->force_provision == force) {
+        return 0;
     }
-    
-    uint8_t force_config = 0;
-    size_t required_size = sizeof(force_config);
-    err = nvs_get_blob(nvs_handle, NVS_KEY_FORCE_CONFIG, &force_config, &required_size);
-    nvs_close(nvs_handle);
-    
-    return (err == ESP_OK && force_config == 1);
+    cfg->force_provision = force;
+    return CONFIG_FIELD_FORCE_PROVISION;
 }
 
 /**
  * @brief 设置强制配网标志
  */
 esp_err_t wifi_config_set_force_flag(void) {
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
-    if (err != ESP_OK) {
-        return err;
-    }
-    
-    uint8_t force_config = 1;
-    err = nvs_set_blob(nvs_handle, NVS_KEY_FORCE_CONFIG, &force_config, sizeof(force_config));
-    if (err == ESP_OK) {
-        err = nvs_commit(nvs_handle);
-    }
-    
-    nvs_close(nvs_handle);
-    return err;
+    return config_cache_update(set_force_flag, (void *)1);
 }
 
 /**
  * @brief 清除强制配网标志
  */
 esp_err_t wifi_config_clear_force_flag(void) {
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
-    if (err != ESP_OK) {
-        return err;
-    }
-    
-    err = nvs_erase_key(nvs_handle, NVS_KEY_FORCE_CONFIG);
-    if (err == ESP_OK) {
-        err = nvs_commit(nvs_handle);
-    }
-    
-    nvs_close(nvs_handle);
-    return err;
+    return config_cache_update(set_force_flag, NULL);
+}
+
+static uint32_t set_wifi(config_snapshot_t *cfg, void *ctx) {
+    const wifi_config_data_t *config = ctx;
+    strncpy(cfg->wifi_ssid, config->ssid, sizeof(cfg->wifi_ssid) - 1);
+    cfg->wifi_ssid[sizeof(cfg->wifi_ssid) - 1] = '\0';
+    strncpy(cfg->wifi_password, config->password, sizeof(cfg->wifi_password) - 1);
+    cfg->wifi_password[sizeof(cfg->wifi_password) - 1] = '\0';
+    cfg->wifi_configured = config->configured;
+    return CONFIG_FIELD_WIFI;
 }
 
 /**
- * @brief 保存WiFi配置到NVS
+ * @brief 保存WiFi配置（写入配置缓存，由缓存写入任务提交到NVS）
  */
 esp_err_t wifi_config_save(const wifi_config_data_t *config) {
     if (!config) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
-    if (err != ESP_OK) {
-        return err;
-    }
-    
-    do {
-        err = nvs_set_str(nvs_handle, NVS_KEY_WIFI_SSID, config->ssid);
-        if (err != ESP_OK) break;
-        
-        err = nvs_set_str(nvs_handle, NVS_KEY_WIFI_PASS, config->password);
-        if (err != ESP_OK) break;
-        
-        // 注意：服务器地址不再保存在wifi_config命名空间中，而是保存在server_config命名空间
-        uint8_t configured = config->configured ? 1 : 0;
-        err = nvs_set_blob(nvs_handle, NVS_KEY_CONFIGURED, &configured, sizeof(configured));
-        if (err != ESP_OK) break;
-        
-        err = nvs_commit(nvs_handle);
-    } while (0);
-    
-    nvs_close(nvs_handle);
+    // 注意：服务器地址不保存在wifi_config命名空间中，而是保存在server_config命名空间
+    esp_err_t err = config_cache_update(set_wifi, (void *)config);
     
     if (err == ESP_OK) {
         ESP_LOGI(TAG, "WiFi配置保存成功: SSID=%s", config->ssid);
@@ -1065,101 +963,53 @@ esp_err_t wifi_config_save(const wifi_config_data_t *config) {
 }
 
 /**
- * @brief 从NVS加载WiFi配置
+ * @brief 保存WiFi和服务器配置、清除强制配网标志并立即写入NVS
  */
-esp_err_t wifi_config_load(wifi_config_data_t *config) {
-    if (!config) {
-        ESP_LOGE(TAG, "[NVS DEBUG] wifi_config_load: 参数错误，config为NULL");
+esp_err_t wifi_config_commit(const wifi_config_data_t *config, const char *server_address) {
+    if (!config || !server_address) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    ESP_LOGI(TAG, "[NVS DEBUG] ========== 开始从Flash读取WiFi配置 ==========");
-    ESP_LOGI(TAG, "[NVS DEBUG] 命名空间: %s", NVS_NAMESPACE);
-    
-    memset(config, 0, sizeof(wifi_config_data_t));
-    
-    nvs_handle_t nvs_handle;
-    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle);
+    esp_err_t err = wifi_config_save(config);
     if (err != ESP_OK) {
-        ESP_LOGE(TAG, "[NVS DEBUG] 打开NVS命名空间失败: %s (错误码: %d)", esp_err_to_name(err), err);
-        ESP_LOGE(TAG, "[NVS DEBUG] 可能原因：NVS未初始化或命名空间不存在");
         return err;
     }
-    ESP_LOGI(TAG, "[NVS DEBUG] ✅ NVS命名空间打开成功");
-    
-    size_t required_size;
-    esp_err_t read_err;
-    
-    // 读取SSID
-    ESP_LOGI(TAG, "[NVS DEBUG] --- 读取WiFi SSID (键名: %s) ---", NVS_KEY_WIFI_SSID);
-    required_size = sizeof(config->ssid);
-    read_err = nvs_get_str(nvs_handle, NVS_KEY_WIFI_SSID, config->ssid, &required_size);
-    if (read_err == ESP_OK) {
-        ESP_LOGI(TAG, "[NVS DEBUG] ✅ SSID读取成功: '%s' (长度: %zu)", config->ssid, required_size);
-    } else if (read_err == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGW(TAG, "[NVS DEBUG] ⚠️ SSID未找到 (键名不存在)");
-        config->ssid[0] = '\0';
-    } else {
-        ESP_LOGE(TAG, "[NVS DEBUG] ❌ SSID读取失败: %s (错误码: %d)", esp_err_to_name(read_err), read_err);
-        config->ssid[0] = '\0';
-    }
     
-    // 读取密码
-    ESP_LOGI(TAG, "[NVS DEBUG] --- 读取WiFi密码 (键名: %s) ---", NVS_KEY_WIFI_PASS);
-    required_size = sizeof(config->password);
-    read_err = nvs_get_str(nvs_handle, NVS_KEY_WIFI_PASS, config->password, &required_size);
-    if (read_err == ESP_OK) {
-        // 为了安全，只显示密码长度和前几个字符
-        size_t pwd_len = strlen(config->password);
-        char pwd_preview[8] = {0};
-        if (pwd_len > 0) {
-            strncpy(pwd_preview, config->password, 3);
-            if (pwd_len > 3) {
-                strcat(pwd_preview, "...");
-            }
-        }
-        ESP_LOGI(TAG, "[NVS DEBUG] ✅ 密码读取成功: '%s' (长度: %zu, 预览: %s)", 
-                 pwd_len > 0 ? "***" : "(空)", required_size, pwd_preview);
-    } else if (read_err == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGW(TAG, "[NVS DEBUG] ⚠️ 密码未找到 (键名不存在)");
-        config->password[0] = '\0';
-    } else {
-        ESP_LOGE(TAG, "[NVS DEBUG] ❌ 密码读取失败: %s (错误码: %d)", esp_err_to_name(read_err), read_err);
-        config->password[0] = '\0';
+    unified_server_config_t srv_config = {0};
+    strncpy(srv_config.base_address, server_address, sizeof(srv_config.base_address) - 1);
+    srv_config.http_port = DEFAULT_HTTP_PORT;
+    srv_config.mqtt_port = DEFAULT_MQTT_PORT;
+    err = server_config_save_to_nvs(&srv_config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "服务器地址保存失败: %s", esp_err_to_name(err));
+        return err;
     }
+    ESP_LOGI(TAG, "服务器地址保存成功: %s", srv_config.base_address);
     
-    // 注意：服务器地址不再从wifi_config命名空间读取，而是从server_config命名空间读取
-    // 读取配置状态
-    ESP_LOGI(TAG, "[NVS DEBUG] --- 读取配置状态 (键名: %s) ---", NVS_KEY_CONFIGURED);
-    uint8_t configured = 0;
-    required_size = sizeof(configured);
-    read_err = nvs_get_blob(nvs_handle, NVS_KEY_CONFIGURED, &configured, &required_size);
-    if (read_err == ESP_OK) {
-        config->configured = (configured == 1);
-        ESP_LOGI(TAG, "[NVS DEBUG] ✅ 配置状态读取成功: configured=%d (原始值: %d, 大小: %zu)", 
-                 config->configured, configured, required_size);
-    } else if (read_err == ESP_ERR_NVS_NOT_FOUND) {
-        ESP_LOGW(TAG, "[NVS DEBUG] ⚠️ 配置状态未找到 (键名不存在)，使用默认值: false");
-        config->configured = false;
-    } else {
-        ESP_LOGE(TAG, "[NVS DEBUG] ❌ 配置状态读取失败: %s (错误码: %d)，使用默认值: false", 
-                 esp_err_to_name(read_err), read_err);
-        config->configured = false;
+    // 清除强制配网标志（重要！避免重启后再次进入配网模式）
+    wifi_config_clear_force_flag();
+    return config_cache_flush();
+}
+
+/**
+ * @brief 加载WiFi配置（从配置缓存读取）
+ */
+esp_err_t wifi_config_load(wifi_config_data_t *config) {
+    if (!config) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!config_cache_is_ready()) {
+        return ESP_ERR_INVALID_STATE;
     }
     
-    nvs_close(nvs_handle);
-    ESP_LOGI(TAG, "[NVS DEBUG] NVS句柄已关闭");
-    
-    // 打印完整的配置信息
-    ESP_LOGI(TAG, "[NVS DEBUG] ========== WiFi配置读取完成 ==========");
-    ESP_LOGI(TAG, "[NVS DEBUG] 📋 完整配置信息:");
-    ESP_LOGI(TAG, "[NVS DEBUG]    SSID: '%s'", strlen(config->ssid) > 0 ? config->ssid : "(空)");
-    ESP_LOGI(TAG, "[NVS DEBUG]    密码: %s", strlen(config->password) > 0 ? "*** (已设置)" : "(空)");
-    ESP_LOGI(TAG, "[NVS DEBUG]    注意: 服务器地址统一从server_config命名空间读取，不再单独存储");
-    ESP_LOGI(TAG, "[NVS DEBUG]    已配置标志: %s", config->configured ? "是 (true)" : "否 (false)");
-    ESP_LOGI(TAG, "[NVS DEBUG]    配置有效性: %s", 
-             (config->configured && strlen(config->ssid) > 0) ? "✅ 有效" : "❌ 无效");
-    ESP_LOGI(TAG, "[NVS DEBUG] ========================================");
+    memset(config, 0, sizeof(wifi_config_data_t));
+    config->configured = config_cache_get_wifi(config->ssid, sizeof(config->ssid),
+                                               config->password, sizeof(config->password));
+    
+    ESP_LOGI(TAG, "WiFi配置: SSID='%s' 密码=%s 已配置=%d",
+             config->ssid[0] ? config->ssid : "(空)",
+             config->password[0] ? "***" : "(空)",
+             config->configured);
     
     return ESP_OK;
 }
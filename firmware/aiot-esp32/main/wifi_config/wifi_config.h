@@ -78,6 +78,15 @@ esp_err_t wifi_config_start(void);
  */
 esp_err_t wifi_config_stop(void);
 
+/**
+ * @brief 配网完成，关闭热点和Web服务器
+ * 
+ * 与 wifi_config_stop() 不同，不停止WiFi：AP+STA切换为STA，已建立的STA连接保持
+ * 
+ * @return esp_err_t 
+ */
+esp_err_t wifi_config_finish(void);
+
 /**
  * @brief 获取当前配网状态
  * 
@@ -98,7 +107,7 @@ bool wifi_config_should_start(void);
 /**
  * @brief 设置强制配网标志
  * 
- * 设置后重启将进入配网模式
+ * 设置后重启将进入配网模式（重启前需调用 config_cache_flush() 确保已写入NVS）
  * 
  * @return esp_err_t 
  */
@@ -112,7 +121,9 @@ esp_err_t wifi_config_set_force_flag(void);
 esp_err_t wifi_config_clear_force_flag(void);
 
 /**
- * @brief 保存WiFi配置到NVS
+ * @brief 保存WiFi配置
+ * 
+ * 立即更新配置缓存，由缓存写入任务延后提交到NVS
  * 
  * @param config WiFi配置数据
  * @return esp_err_t 
@@ -120,7 +131,19 @@ esp_err_t wifi_config_clear_force_flag(void);
 esp_err_t wifi_config_save(const wifi_config_data_t *config);
 
 /**
- * @brief 从NVS加载WiFi配置
+ * @brief 保存配网结果
+ * 
+ * 保存WiFi配置和服务器地址（端口使用默认值），清除强制配网标志，
+ * 并立即写入NVS（之后掉电或重启都不会丢失）
+ * 
+ * @param config WiFi配置数据
+ * @param server_address 规范化后的服务器地址（含协议前缀，结尾无斜杠）
+ * @return esp_err_t 
+ */
+esp_err_t wifi_config_commit(const wifi_config_data_t *config, const char *server_address);
+
+/**
+ * @brief 加载WiFi配置（从配置缓存读取，不访问flash）
  * 
  * @param config 输出的WiFi配置数据
  * @return esp_err_t 
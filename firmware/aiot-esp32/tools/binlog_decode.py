@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+"""
+二进制日志解码工具
+
+把设备记录的二进制日志（components/binlog）还原为文本。记录中只保存了
+格式字符串和TAG的地址，解码时需要与设备固件完全一致的ELF文件。
+
+使用方法：
+    # 1. 解码整个logs分区（先用parttool读出分区）
+    parttool.py read_partition --partition-name logs --output logs.bin
+    python tools/binlog_decode.py build/aiot-esp32s3-firmware.elf logs.bin
+
+    # 2. 解码MQTT get_log 命令返回的JSON（每行一条响应消息）
+    python tools/binlog_decode.py build/aiot-esp32s3-firmware.elf responses.jsonl --json
+
+依赖：
+    pip install pyelftools    （ESP-IDF的Python环境已自带）
+"""
+
+import argparse
+import base64
+import hashlib
+import json
+import re
+import struct
+import sys
+
+try:
+    from elftools.elf.elffile import ELFFile
+except ImportError:
+    print("❌ 未找到 pyelftools，请先安装: pip install pyelftools")
+    sys.exit(1)
+
+SECTOR_SIZE = 4096
+SECTOR_HEADER_SIZE = 32
+SECTOR_MAGIC = 0x474F4C42  # "BLOG"
+RECORD_MAGIC = 0xB1
+RECORD_HEADER_WORDS = 4
+MAX_ARGS = 8
+LEVEL_CHARS = "NEWIDV"
+
+FORMAT_SPEC = re.compile(r"%([-+ #0]*)(\d*)(?:\.(\d+))?(hh|h|ll|l|z|j|t)?([diouxXcsfFeEgGp%])")
+
+
+class ElfStrings:
+    """从ELF中按运行地址读取常量字符串"""
+
+    def __init__(self, path):
+        self.segments = []
+        with open(path, "rb") as f:
+            elf = ELFFile(f)
+            for section in elf.iter_sections():
+                if section["sh_flags"] & 0x2 and section["sh_type"] == "SHT_PROGBITS":  # SHF_ALLOC
+                    self.segments.append((section["sh_addr"], section.data()))
+        with open(path, "rb") as f:
+            self.elf_sha256 = hashlib.sha256(f.read()).digest()
+
+    def string(self, addr):
+        for base, data in self.segments:
+            if base <= addr < base + len(data):
+                end = data.find(b"\0", addr - base)
+                if end < 0:
+                    end = len(data)
+                return data[addr - base:end].decode("utf-8", errors="replace")
+        return None
+
+
+def format_message(strings, fmt, args):
+    """按printf格式把32位参数还原为文本"""
+    out = []
+    pos = 0
+    arg_index = 0
+
+    for m in FORMAT_SPEC.finditer(fmt):
+        out.append(fmt[pos:m.start()])
+        pos = m.end()
+        flags, width, precision, _, conv = m.groups()
+        if conv == "%":
+            out.append("%")
+            continue
+        if arg_index >= len(args):
+            out.append(m.group(0))
+            continue
+
+        value = args[arg_index]
+        arg_index += 1
+        spec = "%" + flags + width + ("." + precision if precision is not None else "")
+
+        if conv in "di":
+            out.append((spec + "d") % struct.unpack("<i", struct.pack("<I", value))[0])
+        elif conv in "ouxX":
+            out.append((spec + ("d" if conv == "u" else conv)) % value)
+        elif conv in "fFeEgG":
+            out.append((spec + conv) % struct.unpack("<f", struct.pack("<I", value))[0])
+        elif conv == "c":
+            out.append(chr(value & 0xFF))
+        elif conv == "s":
+            s = strings.string(value)
+            out.append((spec + "s") % s if s is not None else "<str@0x%08x>" % value)
+        elif conv == "p":
+            out.append("0x%08x" % value)
+
+    out.append(fmt[pos:])
+    return "".join(out)
+
+
+def parse_records(data):
+    """解析连续的记录流，遇到空白或损坏数据时停止"""
+    off = 0
+    while off + RECORD_HEADER_WORDS * 4 <= len(data):
+        word0 = struct.unpack_from("<I", data, off)[0]
+        nargs = (word0 >> 16) & 0xFF
+        if (word0 & 0xFF) != RECORD_MAGIC or nargs > MAX_ARGS:
+            break
+        size = (RECORD_HEADER_WORDS + nargs) * 4
+        if off + size > len(data):
+            break
+        words = struct.unpack_from("<%dI" % (RECORD_HEADER_WORDS + nargs), data, off)
+        yield {
+            "level": (word0 >> 8) & 0x0F,
+            "core": (word0 >> 12) & 0x0F,
+            "timestamp": words[1],
+            "fmt": words[2],
+            "tag": words[3],
+            "args": list(words[RECORD_HEADER_WORDS:]),
+        }
+        off += size
+
+
+def parse_partition(data):
+    """解析logs分区镜像：按扇区序号排序后依次解析"""
+    sectors = []
+    for base in range(0, len(data) - SECTOR_SIZE + 1, SECTOR_SIZE):
+        magic, seq, seq_inv, version = struct.unpack_from("<IIIH", data, base)
+        if magic == SECTOR_MAGIC and seq_inv == (~seq & 0xFFFFFFFF) and version == 1:
+            elf_id = data[base + 16:base + 24]
+            sectors.append((seq, base, elf_id))
+
+    sectors.sort()
+    for seq, base, elf_id in sectors:
+        for record in parse_records(data[base + SECTOR_HEADER_SIZE:base + SECTOR_SIZE]):
+            record["elf_id"] = elf_id
+            yield record
+
+
+def parse_json_responses(lines):
+    """解析get_log命令的JSON响应（data字段为base64编码的记录流）"""
+    for line in lines:
+        line = line.strip()
+        if not line:
+            continue
+        msg = json.loads(line)
+        elf_id = bytes.fromhex(msg["elf_id"]) if "elf_id" in msg else None
+        for record in parse_records(base64.b64decode(msg.get("data", ""))):
+            record["elf_id"] = elf_id
+            yield record
+
+
+def main():
+    parser = argparse.ArgumentParser(description="二进制日志解码工具")
+    parser.add_argument("elf", help="与设备固件对应的ELF文件")
+    parser.add_argument("input", help="logs分区镜像，或get_log响应（--json）")
+    parser.add_argument("--json", action="store_true", help="输入为get_log的JSON响应，每行一条")
+    args = parser.parse_args()
+
+    strings = ElfStrings(args.elf)
+
+    if args.json:
+        with open(args.input, "r", encoding="utf-8") as f:
+            records = list(parse_json_responses(f))
+    else:
+        with open(args.input, "rb") as f:
+            records = list(parse_partition(f.read()))
+
+    warned = False
+    for record in records:
+        elf_id = record.get("elf_id")
+        if elf_id and elf_id != strings.elf_sha256[:8] and not warned:
+            print("⚠️ 日志来自其他固件版本 (elf %s)，解码结果可能不正确" % elf_id.hex(), file=sys.stderr)
+            warned = True
+
+        fmt = strings.string(record["fmt"])
+        tag = strings.string(record["tag"]) or "?"
+        if fmt is None:
+            text = "<fmt@0x%08x> %s" % (record["fmt"], " ".join("0x%08x" % a for a in record["args"]))
+        else:
+            text = format_message(strings, fmt, record["args"])
+
+        level = LEVEL_CHARS[record["level"]] if record["level"] < len(LEVEL_CHARS) else "?"
+        print("%s (%d) [core%d] %s: %s" % (level, record["timestamp"], record["core"], tag, text))
+
+    print("共 %d 条记录" % len(records), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""
+HIL采集数据工具
+
+把设备 get_trace 命令返回的JSON响应拼接成 .hilt 文件（components/hil_trace
+格式），并可列出其中的记录。.hilt 文件用主机回放工具 tools/host/hil_replay.c
+回放（make hil-replay TRACE=xxx.hilt）。
+
+使用方法：
+    # 1. 设备上采集：发送 {"cmd":"trace_start"}，运行一段时间后发送 {"cmd":"trace_stop"}
+    # 2. 逐块读取：{"cmd":"get_trace","cursor":0,"max_bytes":768}，按响应中的next继续，
+    #    直到len为0；把状态主题上的响应每行一条保存到responses.jsonl
+    python tools/hil_trace_dump.py responses.jsonl -o field.hilt
+
+    # 列出记录
+    python tools/hil_trace_dump.py field.hilt --list
+"""
+
+import argparse
+import base64
+import json
+import struct
+import sys
+
+MAGIC = 0x544C4948  # "HILT"
+VERSION = 1
+FILE_HEADER_SIZE = 16
+RECORD_HEADER_SIZE = 8
+EDGE_OVERFLOW = 0x01
+
+TYPE_NAMES = {1: "SENSOR", 2: "EDGES", 3: "MQTT_RX", 4: "MQTT_TX", 5: "MARK"}
+SENSOR_NAMES = {1: "DHT11", 2: "DS18B20", 3: "RAIN", 4: "DHT22", 5: "BH1750",
+                6: "BMP280", 7: "MPU6050", 8: "MQ2", 9: "HCSR04"}
+
+
+def assemble(lines):
+    """按cursor拼接get_trace响应中的数据块，检查是否连续"""
+    chunks = {}
+    for line in lines:
+        line = line.strip()
+        if not line:
+            continue
+        msg = json.loads(line)
+        if msg.get("type") != "trace" or "cursor" not in msg:
+            continue
+        if msg.get("result") != "ok":
+            raise ValueError("设备返回错误: %s" % msg.get("result"))
+        data = base64.b64decode(msg.get("data", ""))
+        if data:
+            chunks[msg["cursor"]] = data
+
+    out = bytearray()
+    for cursor in sorted(chunks):
+        if cursor > len(out):
+            raise ValueError("缺少 %d..%d 字节的数据块" % (len(out), cursor))
+        out[cursor:cursor + len(chunks[cursor])] = chunks[cursor]
+    return bytes(out)
+
+
+def parse(data):
+    """解析.hilt数据，返回(开始时开机毫秒数, 记录列表)"""
+    if len(data) < FILE_HEADER_SIZE:
+        raise ValueError("数据太短")
+    magic, version, header_size, start_ms = struct.unpack_from("<IHHI", data, 0)
+    if magic != MAGIC:
+        raise ValueError("不是HIL trace文件")
+    if version != VERSION or header_size != FILE_HEADER_SIZE:
+        raise ValueError("不支持的版本 %d" % version)
+
+    records = []
+    off = FILE_HEADER_SIZE
+    t = 0
+    while off + RECORD_HEADER_SIZE <= len(data):
+        rtype, arg, length, dt = struct.unpack_from("<BBHI", data, off)
+        if off + RECORD_HEADER_SIZE + length > len(data):
+            break
+        t += dt
+        records.append((t, rtype, arg, data[off + RECORD_HEADER_SIZE:off + RECORD_HEADER_SIZE + length]))
+        off += RECORD_HEADER_SIZE + length
+    return start_ms, records
+
+
+def describe(rtype, arg, payload):
+    if rtype == 1:
+        err, count = struct.unpack_from("<hB", payload, 0)
+        values = struct.unpack_from("<%df" % count, payload, 4)
+        name = SENSOR_NAMES.get(arg, "sensor%d" % arg)
+        if err:
+            return "%s err=0x%x" % (name, err)
+        return "%s %s" % (name, " ".join("%.2f" % v for v in values))
+    if rtype == 2:
+        level, flags, count = struct.unpack_from("<BBH", payload, 0)
+        durations = struct.unpack_from("<%dH" % count, payload, 4)
+        lows = [d for i, d in enumerate(durations) if (level + i) % 2 == 0]
+        return "GPIO%d %d段 起始电平%d 总长%dus 最短低电平%dus%s" % (
+            arg, count, level, sum(durations), min(lows) if lows else 0,
+            " (溢出)" if flags & EDGE_OVERFLOW else "")
+    if rtype in (3, 4):
+        topic_len = payload[0]
+        topic = payload[1:1 + topic_len].decode("utf-8", errors="replace")
+        body = payload[1 + topic_len:].decode("utf-8", errors="replace")
+        if len(body) > 80:
+            body = body[:77] + "..."
+        return "qos%d %s %s" % (arg, topic, body)
+    if rtype == 5:
+        return payload.decode("utf-8", errors="replace")
+    return "%d字节" % len(payload)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="HIL采集数据工具")
+    parser.add_argument("input", help="get_trace的JSON响应（每行一条），或.hilt文件")
+    parser.add_argument("-o", "--output", help="输出.hilt文件")
+    parser.add_argument("--list", action="store_true", help="列出记录")
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        raw = f.read()
+    if raw[:4] == struct.pack("<I", MAGIC):
+        data = raw
+    else:
+        data = assemble(raw.decode("utf-8").splitlines())
+
+    start_ms, records = parse(data)
+
+    if args.output:
+        with open(args.output, "wb") as f:
+            f.write(data)
+        print("✅ 已写入 %s (%d 字节)" % (args.output, len(data)), file=sys.stderr)
+
+    if args.list:
+        for t, rtype, arg, payload in records:
+            print("%10.3f ms  %-8s %s" % (t / 1000.0, TYPE_NAMES.get(rtype, "?%d" % rtype),
+                                         describe(rtype, arg, payload)))
+
+    duration = records[-1][0] / 1e6 if records else 0
+    print("共 %d 条记录，时长 %.1f 秒，采集开始于开机后 %.1f 秒" % (len(records), duration, start_ms / 1000.0),
+          file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
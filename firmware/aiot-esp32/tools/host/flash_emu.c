@@ -0,0 +1,126 @@
+/**
+ * @file flash_emu.c
+ * @brief 文件模拟的NOR Flash实现
+ */
+
+#include "flash_emu.h"
+#include <string.h>
+
+static int range_valid(const flash_emu_t *emu, uint32_t offset, size_t len)
+{
+    return offset <= emu->size && len <= emu->size - offset;
+}
+
+esp_err_t flash_emu_open(flash_emu_t *emu, const char *path, uint32_t size, int wipe)
+{
+    memset(emu, 0, sizeof(*emu));
+    emu->size = size;
+
+    emu->fp = wipe ? NULL : fopen(path, "r+b");
+    if (emu->fp == NULL) {
+        emu->fp = fopen(path, "w+b");
+        wipe = 1;
+    }
+    if (emu->fp == NULL) {
+        return ESP_FAIL;
+    }
+
+    if (wipe) {
+        uint8_t blank[FLASH_EMU_SECTOR_SIZE];
+        memset(blank, 0xFF, sizeof(blank));
+        for (uint32_t off = 0; off < size; off += sizeof(blank)) {
+            if (fwrite(blank, 1, sizeof(blank), emu->fp) != sizeof(blank)) {
+                return ESP_FAIL;
+            }
+        }
+        fflush(emu->fp);
+    }
+    return ESP_OK;
+}
+
+void flash_emu_close(flash_emu_t *emu)
+{
+    if (emu->fp) {
+        fclose(emu->fp);
+        emu->fp = NULL;
+    }
+}
+
+esp_err_t flash_emu_read(void *ctx, uint32_t offset, void *buf, size_t len)
+{
+    flash_emu_t *emu = (flash_emu_t *)ctx;
+    if (emu->powered_off) {
+        return ESP_FAIL;
+    }
+    if (!range_valid(emu, offset, len)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    emu->read_count++;
+    if (fseek(emu->fp, offset, SEEK_SET) != 0 || fread(buf, 1, len, emu->fp) != len) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t flash_emu_write(void *ctx, uint32_t offset, const void *buf, size_t len)
+{
+    flash_emu_t *emu = (flash_emu_t *)ctx;
+    uint8_t old[256];
+    const uint8_t *src = (const uint8_t *)buf;
+
+    if (emu->powered_off) {
+        return ESP_FAIL;
+    }
+    if (!range_valid(emu, offset, len)) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    emu->write_count++;
+
+    // 掉电：只写入前一半数据
+    int cut = emu->writes_until_cut != 0 && --emu->writes_until_cut == 0;
+    if (cut) {
+        len /= 2;
+    }
+
+    while (len > 0) {
+        size_t n = len < sizeof(old) ? len : sizeof(old);
+        if (fseek(emu->fp, offset, SEEK_SET) != 0 || fread(old, 1, n, emu->fp) != n) {
+            return ESP_FAIL;
+        }
+        for (size_t i = 0; i < n; i++) {
+            old[i] &= src[i];
+        }
+        if (fseek(emu->fp, offset, SEEK_SET) != 0 || fwrite(old, 1, n, emu->fp) != n) {
+            return ESP_FAIL;
+        }
+        offset += n;
+        src += n;
+        len -= n;
+    }
+
+    if (cut) {
+        fflush(emu->fp);
+        emu->powered_off = 1;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t flash_emu_erase_sector(void *ctx, uint32_t offset)
+{
+    flash_emu_t *emu = (flash_emu_t *)ctx;
+    uint8_t blank[FLASH_EMU_SECTOR_SIZE];
+
+    if (emu->powered_off) {
+        return ESP_FAIL;
+    }
+    if (offset % FLASH_EMU_SECTOR_SIZE != 0 || !range_valid(emu, offset, FLASH_EMU_SECTOR_SIZE)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    emu->erase_count++;
+    memset(blank, 0xFF, sizeof(blank));
+    if (fseek(emu->fp, offset, SEEK_SET) != 0 || fwrite(blank, 1, sizeof(blank), emu->fp) != sizeof(blank)) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
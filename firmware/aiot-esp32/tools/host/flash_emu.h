@@ -0,0 +1,46 @@
+/**
+ * @file flash_emu.h
+ * @brief 文件模拟的NOR Flash（主机工具使用）
+ *
+ * - 擦除以4KB扇区为单位，擦除后全为0xFF
+ * - 写入只能把1变成0（新数据与旧数据按位与），与真实NOR Flash一致
+ * - 可设置"掉电点"：第N次写入只写一半数据，之后所有操作都失败
+ */
+
+#ifndef FLASH_EMU_H
+#define FLASH_EMU_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "esp_err.h"
+
+#define FLASH_EMU_SECTOR_SIZE   4096
+
+typedef struct {
+    FILE *fp;
+    uint32_t size;
+    uint32_t writes_until_cut;     ///< 0=不掉电，否则第N次写入时掉电
+    int powered_off;
+    uint32_t read_count;
+    uint32_t write_count;
+    uint32_t erase_count;
+} flash_emu_t;
+
+/**
+ * @brief 打开（不存在时创建）模拟Flash文件
+ *
+ * @param emu 模拟器
+ * @param path 文件路径
+ * @param size Flash大小（字节，扇区对齐）
+ * @param wipe 是否先全部擦除
+ */
+esp_err_t flash_emu_open(flash_emu_t *emu, const char *path, uint32_t size, int wipe);
+
+void flash_emu_close(flash_emu_t *emu);
+
+esp_err_t flash_emu_read(void *ctx, uint32_t offset, void *buf, size_t len);
+esp_err_t flash_emu_write(void *ctx, uint32_t offset, const void *buf, size_t len);
+esp_err_t flash_emu_erase_sector(void *ctx, uint32_t offset);
+
+#endif // FLASH_EMU_H
@@ -0,0 +1,692 @@
+/**
+ * @file hil_replay.c
+ * @brief HIL采集数据的主机确定性回放（components/hil_trace 的 .hilt 文件）
+ *
+ * 按记录的时间顺序把现场数据送回真实固件模块（与host_bench相同的模拟构建）：
+ * - DHT11：EDGES记录还原成引脚波形模型，驱动按原样逐位解码，
+ *   解码结果与现场SENSOR记录比较（mismatch即驱动或时序问题）
+ * - DS18B20：按现场读数设置1-Wire模型，并统计现场波形的复位/存在脉冲/时隙时序
+ * - MQTT_RX：控制主题上的命令重新注入模拟broker，走完整的命令分发
+ * 每条传感器读数都经过与main.c传感器任务相同的流水线（读取→存储→序列化→发布），
+ * 按阶段统计真实CPU耗时；虚拟时钟跳过记录之间的空闲时间，回放远快于实时。
+ *
+ * main.c的传感器任务依赖WiFi、显示等整机环境，不能在主机编译，
+ * 这里按相同的顺序调用相同的模块。
+ *
+ * 使用方法：
+ *   make hil-replay TRACE=field.hilt
+ *   ./build/host/hil_replay --record out.hilt [--seconds N]   # 生成合成采集数据
+ *   ./build/host/hil_replay trace.hilt [--verbose]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "host_sim.h"
+#include "sim_device.h"
+#include "esp_log.h"
+#include "board_config.h"
+#include "aiot_mqtt_client.h"
+#include "dht11.h"
+#include "ds18b20.h"
+#include "sensor_hub.h"
+#include "sample_store.h"
+#include "hil_trace.h"
+
+#define REPLAY_DEFAULT_SECONDS      120
+#define REPLAY_SENSOR_INTERVAL_S    10      // 与main.c的SENSOR_REPORT_INTERVAL一致
+#define REPLAY_COMMAND_INTERVAL_S   7
+#define REPLAY_START_LOW_MIN_US     1000    // 主机起始信号（DHT11 >=18ms）的识别阈值
+#define REPLAY_VALUE_TOLERANCE      0.05f
+#define REPLAY_MAX_SEGMENTS         (CONFIG_HIL_TRACE_MAX_EDGES + 1)
+
+typedef enum {
+    STAGE_SENSOR_READ,
+    STAGE_STORE,
+    STAGE_SERIALIZE,
+    STAGE_PUBLISH,
+    STAGE_COMMAND,
+    STAGE_COUNT,
+} stage_t;
+
+static const char *s_stage_names[STAGE_COUNT] = {
+    "sensor_read", "store", "serialize", "publish", "command",
+};
+
+typedef struct {
+    double *ns;
+    size_t count;
+    size_t capacity;
+} stage_samples_t;
+
+// 回放DHT11波形：主机释放起始信号后，按记录的各段时长输出电平
+typedef struct {
+    uint16_t durations[REPLAY_MAX_SEGMENTS];
+    uint16_t count;
+    uint8_t initial_level;
+    uint16_t start;                // 起始信号之后第一段的下标
+    int64_t low_since_us;
+    int64_t release_us;            // -1表示还未对齐
+} waveform_model_t;
+
+// 一条待配对的EDGES记录（紧随其后的SENSOR记录使用）
+typedef struct {
+    bool valid;
+    uint8_t pin;
+    uint64_t time_us;
+    const uint8_t *payload;
+    uint16_t len;
+} pending_edges_t;
+
+typedef struct {
+    uint32_t readings;
+    uint32_t waveform_readings;
+    uint32_t mismatches;
+    uint32_t commands;
+    uint32_t other_rx;
+    uint32_t recorded_tx;
+    uint32_t marks;
+    // 现场1-Wire时序
+    uint32_t ow_captures;
+    uint32_t ow_resets;
+    uint32_t ow_slots;
+    uint32_t ow_reset_low_min;
+    uint32_t ow_presence_delay_max;
+    uint32_t ow_presence_width_min;
+    uint32_t ow_slot_low_max;
+} replay_stats_t;
+
+static stage_samples_t s_stages[STAGE_COUNT];
+static replay_stats_t s_stats;
+static waveform_model_t s_waveform;
+static FILE *s_out;                 // 报告输出（stdout被重定向到/dev/null）
+static bool s_verbose;
+
+/* ==================== 工具函数 ==================== */
+
+static double wall_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void stage_add(stage_t stage, double ns)
+{
+    stage_samples_t *s = &s_stages[stage];
+    if (s->count == s->capacity) {
+        size_t cap = s->capacity ? s->capacity * 2 : 256;
+        double *ns_buf = realloc(s->ns, cap * sizeof(double));
+        if (!ns_buf) {
+            return;
+        }
+        s->ns = ns_buf;
+        s->capacity = cap;
+    }
+    s->ns[s->count++] = ns;
+}
+
+static void advance_to(int64_t t_us)
+{
+    int64_t now = host_sim_now_us();
+    if (t_us > now) {
+        host_sim_advance_us(t_us - now);
+    }
+}
+
+static uint16_t rd16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/* ==================== DHT11波形模型 ==================== */
+
+static void waveform_on_drive(void *ctx, int64_t now_us, bool master_low)
+{
+    waveform_model_t *m = ctx;
+    if (master_low) {
+        m->low_since_us = now_us;
+        m->release_us = -1;
+    } else if (now_us - m->low_since_us >= REPLAY_START_LOW_MIN_US) {
+        m->release_us = now_us;
+    }
+}
+
+static int waveform_sample(void *ctx, int64_t now_us)
+{
+    waveform_model_t *m = ctx;
+    if (m->release_us < 0) {
+        return 1;
+    }
+    int64_t t = now_us - m->release_us;
+    for (uint16_t i = m->start; i < m->count; i++) {
+        if (t < m->durations[i]) {
+            return (m->initial_level ^ (i & 1)) & 1;
+        }
+        t -= m->durations[i];
+    }
+    // 采集在驱动最后一次采样时结束，之后保持最后一段的电平
+    return m->count ? (m->initial_level ^ ((m->count - 1) & 1)) & 1 : 1;
+}
+
+// 载入EDGES负载；找不到起始信号（驱动返回了缓存值，总线没有动作）时返回false
+static bool waveform_load(waveform_model_t *m, const pending_edges_t *edges)
+{
+    if (edges->len < 4) {
+        return false;
+    }
+    uint16_t count = rd16(edges->payload + 2);
+    if (count > REPLAY_MAX_SEGMENTS || edges->len < 4 + count * 2) {
+        return false;
+    }
+    memset(m, 0, sizeof(*m));
+    m->initial_level = edges->payload[0] & 1;
+    m->count = count;
+    for (uint16_t i = 0; i < count; i++) {
+        m->durations[i] = rd16(edges->payload + 4 + i * 2);
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        int level = (m->initial_level ^ (i & 1)) & 1;
+        if (level == 0 && m->durations[i] >= REPLAY_START_LOW_MIN_US) {
+            m->start = i + 1;
+            m->release_us = -1;
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t edges_total_us(const pending_edges_t *edges)
+{
+    if (!edges->valid || edges->len < 4) {
+        return 0;
+    }
+    uint16_t count = rd16(edges->payload + 2);
+    uint32_t total = 0;
+    for (uint16_t i = 0; i < count && 4 + i * 2 + 2 <= edges->len; i++) {
+        total += rd16(edges->payload + 4 + i * 2);
+    }
+    return total;
+}
+
+/* ==================== 1-Wire时序分析 ==================== */
+
+static void analyse_onewire(const pending_edges_t *edges)
+{
+    if (edges->len < 4) {
+        return;
+    }
+    uint8_t initial = edges->payload[0] & 1;
+    uint16_t count = rd16(edges->payload + 2);
+    if (edges->len < 4 + count * 2) {
+        return;
+    }
+    s_stats.ow_captures++;
+    for (uint16_t i = 0; i < count; i++) {
+        if (((initial ^ i) & 1) != 0) {
+            continue;
+        }
+        uint32_t low = rd16(edges->payload + 4 + i * 2);
+        if (low >= 480) {
+            // 复位脉冲，后面是等待（高）和存在脉冲（低）
+            s_stats.ow_resets++;
+            if (low < s_stats.ow_reset_low_min) {
+                s_stats.ow_reset_low_min = low;
+            }
+            if (i + 2 < count) {
+                uint32_t delay = rd16(edges->payload + 4 + (i + 1) * 2);
+                uint32_t width = rd16(edges->payload + 4 + (i + 2) * 2);
+                if (delay > s_stats.ow_presence_delay_max) {
+                    s_stats.ow_presence_delay_max = delay;
+                }
+                if (width < s_stats.ow_presence_width_min) {
+                    s_stats.ow_presence_width_min = width;
+                }
+                i += 2;
+            }
+        } else {
+            s_stats.ow_slots++;
+            if (low > s_stats.ow_slot_low_max) {
+                s_stats.ow_slot_low_max = low;
+            }
+        }
+    }
+}
+
+/* ==================== 传感器流水线 ==================== */
+
+static esp_err_t read_sensor(uint8_t sensor_id, float *values, uint8_t *count)
+{
+    esp_err_t ret = ESP_ERR_NOT_SUPPORTED;
+    double t0 = wall_ns();
+    if (sensor_id == SAMPLE_SENSOR_DHT11) {
+        dht11_data_t data = { 0 };
+        hil_trace_edges_begin(DHT11_GPIO_PIN);
+        ret = dht11_read_adapter(&data);
+        hil_trace_edges_end(DHT11_GPIO_PIN);
+        if (ret == ESP_OK && !data.valid) {
+            ret = ESP_ERR_INVALID_RESPONSE;
+        }
+        values[0] = data.temperature;
+        values[1] = data.humidity;
+        *count = 2;
+    } else if (sensor_id == SAMPLE_SENSOR_DS18B20) {
+        ds18b20_data_t data = { 0 };
+        hil_trace_edges_begin(DS18B20_GPIO_PIN);
+        ret = ds18b20_read(&data);
+        hil_trace_edges_end(DS18B20_GPIO_PIN);
+        if (ret == ESP_OK && !data.valid) {
+            ret = ESP_ERR_INVALID_RESPONSE;
+        }
+        values[0] = data.temperature;
+        *count = 1;
+    } else {
+        *count = 0;
+    }
+    stage_add(STAGE_SENSOR_READ, wall_ns() - t0);
+    hil_trace_sensor(sensor_id, ret, values, *count);
+    return ret;
+}
+
+// 读取成功后的处理，与main.c传感器任务相同：写历史存储、按注册表拼JSON、发布
+static void report_sensor(uint8_t sensor_id, const float *values, uint8_t count)
+{
+    double t0 = wall_ns();
+    for (uint8_t ch = 0; ch < count; ch++) {
+        sample_store_append_now(sensor_id, ch, values[ch]);
+    }
+    double t1 = wall_ns();
+    stage_add(STAGE_STORE, t1 - t0);
+
+    char sensor_json[SENSOR_HUB_JSON_MAX];
+    unsigned long uptime = (unsigned long)(host_sim_now_us() / 1000000);
+    int index = sensor_hub_find((sample_sensor_id_t)sensor_id);
+    size_t len = index < 0 ? 0 : sensor_hub_format_json((size_t)index, SIM_DEVICE_ID, values, uptime,
+                                                        sensor_json, sizeof(sensor_json));
+    double t2 = wall_ns();
+    stage_add(STAGE_SERIALIZE, t2 - t1);
+    if (len == 0) {
+        return;
+    }
+
+    mqtt_client_publish(SIM_TOPIC_SENSOR, sensor_json, len, MQTT_QOS_1, false);
+    host_mqtt_pump();
+    stage_add(STAGE_PUBLISH, wall_ns() - t2);
+}
+
+static void inject_command(const char *data, int len)
+{
+    double t0 = wall_ns();
+    host_mqtt_inject(SIM_TOPIC_CONTROL, data, len);
+    host_mqtt_pump();
+    stage_add(STAGE_COMMAND, wall_ns() - t0);
+}
+
+/* ==================== 录制合成数据 ==================== */
+
+static int write_trace(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return -1;
+    }
+    uint8_t chunk[4096];
+    uint32_t cursor = 0;
+    for (;;) {
+        size_t len = 0;
+        uint32_t next = 0;
+        if (hil_trace_read(cursor, chunk, sizeof(chunk), &len, &next) != ESP_OK) {
+            fclose(f);
+            return -1;
+        }
+        if (len == 0) {
+            break;
+        }
+        fwrite(chunk, 1, len, f);
+        cursor = next;
+    }
+    fclose(f);
+    return 0;
+}
+
+static int record_trace(const char *path, int seconds)
+{
+    static const char *commands[] = {
+        "{\"cmd\":\"led\",\"device_id\":1,\"action\":\"on\"}",
+        "{\"cmd\":\"led\",\"device_id\":1,\"action\":\"off\"}",
+        "{\"cmd\":\"servo\",\"device_id\":1,\"angle\":90}",
+        "{\"cmd\":\"relay\",\"device_id\":1,\"action\":\"on\"}",
+    };
+
+    // DHT11驱动限制2秒内只读一次，先越过开机后的第一个间隔
+    host_sim_advance_us(2000000);
+    if (hil_trace_start() != ESP_OK) {
+        fprintf(stderr, "trace start failed\n");
+        return -1;
+    }
+    hil_trace_mark("synthetic workload");
+
+    int64_t t0 = host_sim_now_us();
+    for (int s = 1; s <= seconds; s++) {
+        advance_to(t0 + (int64_t)s * 1000000);
+        if (s % REPLAY_SENSOR_INTERVAL_S == 0) {
+            // 缓慢变化的温湿度，覆盖小数位和进位
+            host_sensor_dht11_set((int16_t)(180 + (s * 7) % 120), (uint16_t)(400 + (s * 13) % 400));
+            host_sensor_ds18b20_set((int16_t)(20 * 16 + (s * 5) % 160));
+            float values[HIL_TRACE_MAX_SENSOR_VALUES];
+            uint8_t count;
+            if (read_sensor(SAMPLE_SENSOR_DHT11, values, &count) == ESP_OK) {
+                report_sensor(SAMPLE_SENSOR_DHT11, values, count);
+            }
+            if (read_sensor(SAMPLE_SENSOR_DS18B20, values, &count) == ESP_OK) {
+                report_sensor(SAMPLE_SENSOR_DS18B20, values, count);
+            }
+        }
+        if (s % REPLAY_COMMAND_INTERVAL_S == 0) {
+            inject_command(commands[(s / REPLAY_COMMAND_INTERVAL_S) % 4], -1);
+        }
+    }
+
+    hil_trace_stop();
+    hil_trace_stats_t stats;
+    hil_trace_get_stats(&stats);
+    if (write_trace(path) != 0) {
+        return -1;
+    }
+    fprintf(s_out, "recorded %s: %u records, %u bytes%s, %u edges dropped\n", path,
+            stats.records, stats.bytes, stats.truncated ? " (truncated)" : "", stats.edges_dropped);
+    return 0;
+}
+
+/* ==================== 回放 ==================== */
+
+static void replay_sensor(const hil_trace_record_t *rec, pending_edges_t *edges)
+{
+    if (rec->len < 4) {
+        return;
+    }
+    int16_t rec_err = (int16_t)rd16(rec->payload);
+    uint8_t rec_count = rec->payload[2];
+    if (rec_count > HIL_TRACE_MAX_SENSOR_VALUES || rec->len < 4 + rec_count * sizeof(float)) {
+        return;
+    }
+    float rec_values[HIL_TRACE_MAX_SENSOR_VALUES] = { 0 };
+    memcpy(rec_values, rec->payload + 4, rec_count * sizeof(float));
+
+    uint8_t pin = rec->arg == SAMPLE_SENSOR_DHT11 ? DHT11_GPIO_PIN : DS18B20_GPIO_PIN;
+    bool have_edges = edges->valid && edges->pin == pin;
+    bool waveform = false;
+
+    // 从现场读取开始的时刻回放（EDGES记录写在读取结束时）
+    advance_to((int64_t)(have_edges ? edges->time_us - edges_total_us(edges) : rec->time_us));
+
+    if (rec->arg == SAMPLE_SENSOR_DHT11) {
+        if (have_edges && waveform_load(&s_waveform, edges)) {
+            const host_sim_pin_model_t model = {
+                .on_drive = waveform_on_drive,
+                .sample = waveform_sample,
+                .ctx = &s_waveform,
+            };
+            host_sim_gpio_attach(DHT11_GPIO_PIN, &model);
+            waveform = true;
+        } else if (rec_err == ESP_OK) {
+            host_sensor_dht11_attach(DHT11_GPIO_PIN, (int16_t)(rec_values[0] * 10.0f + (rec_values[0] < 0 ? -0.5f : 0.5f)),
+                                     (uint16_t)(rec_values[1] * 10.0f + 0.5f));
+        }
+    } else if (rec->arg == SAMPLE_SENSOR_DS18B20) {
+        if (have_edges) {
+            analyse_onewire(edges);
+        }
+        if (rec_err == ESP_OK) {
+            host_sensor_ds18b20_set((int16_t)(rec_values[0] * 16.0f + (rec_values[0] < 0 ? -0.5f : 0.5f)));
+        }
+    } else {
+        // 雨水传感器只有读数，没有可回放的总线
+        edges->valid = false;
+        return;
+    }
+    edges->valid = false;
+
+    float values[HIL_TRACE_MAX_SENSOR_VALUES] = { 0 };
+    uint8_t count = 0;
+    esp_err_t ret = read_sensor(rec->arg, values, &count);
+    s_stats.readings++;
+    if (waveform) {
+        s_stats.waveform_readings++;
+        // 恢复数值模型，后面没有波形的读取（重试、缓存）用现场数值
+        host_sensor_dht11_attach(DHT11_GPIO_PIN, 0, 0);
+        if (rec_err == ESP_OK) {
+            host_sensor_dht11_set((int16_t)(rec_values[0] * 10.0f + (rec_values[0] < 0 ? -0.5f : 0.5f)),
+                                  (uint16_t)(rec_values[1] * 10.0f + 0.5f));
+        }
+    }
+
+    bool match = (ret == ESP_OK) == (rec_err == ESP_OK);
+    if (match && ret == ESP_OK) {
+        for (uint8_t i = 0; i < count && i < rec_count; i++) {
+            float d = values[i] - rec_values[i];
+            if (d > REPLAY_VALUE_TOLERANCE || d < -REPLAY_VALUE_TOLERANCE) {
+                match = false;
+            }
+        }
+    }
+    if (!match) {
+        s_stats.mismatches++;
+        fprintf(s_out, "MISMATCH %.3f s sensor %u%s: recorded err=0x%x %.2f %.2f, replayed err=0x%x %.2f %.2f\n",
+                rec->time_us / 1e6, rec->arg, waveform ? " (waveform)" : "", (unsigned)(uint16_t)rec_err,
+                rec_values[0], rec_values[1], (unsigned)ret, values[0], values[1]);
+    }
+    if (ret == ESP_OK) {
+        report_sensor(rec->arg, values, count);
+    }
+}
+
+static void replay_mqtt_rx(const hil_trace_record_t *rec)
+{
+    if (rec->len < 1 || rec->len < 1 + rec->payload[0]) {
+        return;
+    }
+    uint8_t topic_len = rec->payload[0];
+    const char *topic = (const char *)rec->payload + 1;
+    static const char suffix[] = "/control";
+    size_t suffix_len = sizeof(suffix) - 1;
+    advance_to((int64_t)rec->time_us);
+    // 现场设备的主题带真实UUID，统一改写为模拟设备的控制主题
+    if (topic_len < suffix_len || memcmp(topic + topic_len - suffix_len, suffix, suffix_len) != 0) {
+        s_stats.other_rx++;
+        return;
+    }
+    s_stats.commands++;
+    inject_command((const char *)rec->payload + 1 + topic_len, rec->len - 1 - topic_len);
+}
+
+static int replay_trace(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return -1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *data = size > 0 ? malloc(size) : NULL;
+    if (!data || fread(data, 1, size, f) != (size_t)size) {
+        fclose(f);
+        free(data);
+        fprintf(stderr, "cannot read %s\n", path);
+        return -1;
+    }
+    fclose(f);
+
+    uint32_t start_ms = 0;
+    if (hil_trace_parse_header(data, size, &start_ms) != ESP_OK) {
+        fprintf(stderr, "%s: not a HIL trace\n", path);
+        free(data);
+        return -1;
+    }
+
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.ow_reset_low_min = UINT32_MAX;
+    s_stats.ow_presence_width_min = UINT32_MAX;
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        s_stages[i].count = 0;
+    }
+    host_mqtt_stats_t mqtt_before, mqtt_after;
+    host_mqtt_get_stats(&mqtt_before);
+    sim_device_stats_t dev_before, dev_after;
+    sim_device_get_stats(&dev_before);
+
+    // 记录时间相对采集开始；留出DHT11驱动的2秒读取间隔
+    int64_t base_us = host_sim_now_us() + 2000000;
+    pending_edges_t edges = { 0 };
+    hil_trace_record_t rec = { 0 };
+    size_t offset = HIL_TRACE_FILE_HEADER_SIZE;
+    uint32_t records = 0;
+    uint64_t last_us = 0;
+    double t0 = wall_ns();
+
+    while (hil_trace_parse_next(data, size, &offset, &rec)) {
+        records++;
+        last_us = rec.time_us;
+        hil_trace_record_t abs = rec;
+        abs.time_us = rec.time_us + base_us;
+        switch (rec.type) {
+        case HIL_TRACE_EDGES:
+            edges.valid = true;
+            edges.pin = rec.arg;
+            edges.time_us = abs.time_us;
+            edges.payload = rec.payload;
+            edges.len = rec.len;
+            break;
+        case HIL_TRACE_SENSOR:
+            replay_sensor(&abs, &edges);
+            break;
+        case HIL_TRACE_MQTT_RX:
+            replay_mqtt_rx(&abs);
+            break;
+        case HIL_TRACE_MQTT_TX:
+            s_stats.recorded_tx++;
+            break;
+        case HIL_TRACE_MARK:
+            s_stats.marks++;
+            if (s_verbose) {
+                fprintf(s_out, "mark %.3f s: %.*s\n", rec.time_us / 1e6, rec.len, (const char *)rec.payload);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    double wall = wall_ns() - t0;
+    if (offset != (size_t)size) {
+        fprintf(s_out, "warning: %ld trailing bytes not parsed (truncated capture?)\n", size - (long)offset);
+    }
+    free(data);
+
+    host_mqtt_get_stats(&mqtt_after);
+    sim_device_get_stats(&dev_after);
+
+    fprintf(s_out, "trace %s: %u records, %.1f s captured (device uptime %.1f s at start)\n",
+            path, records, last_us / 1e6, start_ms / 1000.0);
+    fprintf(s_out, "%-12s %8s %10s %10s %10s %10s %12s\n",
+            "stage", "count", "mean us", "p50 us", "p99 us", "max us", "ops/s");
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        stage_samples_t *s = &s_stages[i];
+        if (s->count == 0) {
+            fprintf(s_out, "%-12s %8u %10s %10s %10s %10s %12s\n", s_stage_names[i], 0u, "-", "-", "-", "-", "-");
+            continue;
+        }
+        double sum = 0;
+        for (size_t k = 0; k < s->count; k++) {
+            sum += s->ns[k];
+        }
+        qsort(s->ns, s->count, sizeof(double), cmp_double);
+        double mean = sum / s->count;
+        fprintf(s_out, "%-12s %8zu %10.1f %10.1f %10.1f %10.1f %12.0f\n", s_stage_names[i], s->count,
+                mean / 1e3, s->ns[s->count / 2] / 1e3, s->ns[(s->count * 99) / 100] / 1e3,
+                s->ns[s->count - 1] / 1e3, mean > 0 ? 1e9 / mean : 0);
+    }
+    fprintf(s_out, "\nreplay: %.1f s of trace in %.1f ms wall (%.0fx realtime)\n",
+            last_us / 1e6, wall / 1e6, wall > 0 ? last_us * 1e3 / wall : 0);
+    fprintf(s_out, "sensors: %u readings replayed (%u from recorded waveforms), %u mismatches\n",
+            s_stats.readings, s_stats.waveform_readings, s_stats.mismatches);
+    fprintf(s_out, "mqtt: %u commands (%u ok, %u failed), %u other rx; tx recorded %u, replayed %u\n",
+            s_stats.commands, dev_after.commands_ok - dev_before.commands_ok,
+            dev_after.commands_fail - dev_before.commands_fail, s_stats.other_rx,
+            s_stats.recorded_tx, mqtt_after.published - mqtt_before.published);
+    if (s_stats.ow_captures > 0) {
+        fprintf(s_out, "1-wire: %u captures, %u resets (min low %u us), presence delay max %u us, "
+                "width min %u us, %u slots (max low %u us)\n",
+                s_stats.ow_captures, s_stats.ow_resets,
+                s_stats.ow_resets ? s_stats.ow_reset_low_min : 0, s_stats.ow_presence_delay_max,
+                s_stats.ow_resets ? s_stats.ow_presence_width_min : 0, s_stats.ow_slots, s_stats.ow_slot_low_max);
+    }
+    return s_stats.mismatches ? 1 : 0;
+}
+
+/* ==================== main ==================== */
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s trace.hilt [--verbose]\n"
+           "       %s --record out.hilt [--seconds n]\n", prog, prog);
+}
+
+int main(int argc, char **argv)
+{
+    const char *trace_path = NULL;
+    const char *record_path = NULL;
+    int seconds = REPLAY_DEFAULT_SECONDS;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            s_verbose = true;
+        } else if (argv[i][0] != '-' && !trace_path) {
+            trace_path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (!trace_path && !record_path) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // BSP在每次LED/继电器动作时printf，与host_bench一样不让终端输出影响计时
+    fflush(stdout);
+    s_out = fdopen(dup(STDOUT_FILENO), "w");
+    if (!s_out || !freopen("/dev/null", "w", stdout)) {
+        fprintf(stderr, "cannot redirect stdout\n");
+        return 1;
+    }
+    setvbuf(s_out, NULL, _IOLBF, 0);
+
+    host_log_level = ESP_LOG_WARN;
+    if (sim_device_init() != ESP_OK || sim_device_mount_sample_store() != ESP_OK) {
+        return 1;
+    }
+
+    if (record_path && record_trace(record_path, seconds) != 0) {
+        return 1;
+    }
+    if (trace_path) {
+        return replay_trace(trace_path) == 0 ? 0 : 1;
+    }
+    return 0;
+}
@@ -0,0 +1,2694 @@
+/**
+ * @file host_bench.c
+ * @brief 主机模拟微基准测试（真实固件模块 + 模拟HAL/FreeRTOS/MQTT broker）
+ *
+ * 编译的是固件源码本身（preset_control、device_control、pwm_control、
+ * 传感器驱动、aiot_mqtt_client、LCD驱动、metrics、binlog、sample_store、
+ * task_profiler、alarm、report_filter、sensor_filter、json_stream、captive_dns、ble_frag、live_provision、button_input、servo_motion、led_effects、pwm_output、sensor_hub、i2c_bus、imu_stream、adc_stream、ultrasonic），只把ESP-IDF替换为 tools/host/mock 下的模拟实现。
+ *
+ * 每项基准先预热，再重复测量若干轮，报告每轮ns/op的中位数和最小值；
+ * 与基线比较时只看中位数，超过阈值即返回非0，用于在烧录前发现性能回退。
+ * 每项都带结果校验（GPIO电平、LEDC占空比、传感器读数、帧缓冲区像素），
+ * 避免"跑得很快但结果是错的"。
+ *
+ * 使用方法：
+ *   make host-bench
+ *   make host-bench-check BASELINE=tools/host/bench_baseline.json
+ *   ./build/host/host_bench [--filter 子串] [--json 输出文件]
+ *                           [--baseline 基线文件] [--threshold 百分比] [--repeat N]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+#include "host_sim.h"
+#include "sim_device.h"
+#include "esp_log.h"
+#include "cJSON.h"
+#include "board_config.h"
+#include "device_control.h"
+#include "preset_control.h"
+#include "aiot_mqtt_client.h"
+#include "dht11.h"
+#include "ds18b20.h"
+#include "lcd_st7789.h"
+#include "metrics.h"
+#include "binlog.h"
+#include "sample_store.h"
+#include "task_profiler.h"
+#include "alarm.h"
+#include "report_filter.h"
+#include "sensor_filter.h"
+#include "json_stream.h"
+#include "captive_dns.h"
+#include "ble_frag.h"
+#include "live_provision.h"
+#include "button_input.h"
+#include "servo_motion.h"
+#include "led_effects.h"
+#include "pwm_output.h"
+#include "pwm_control.h"
+#include "sensor_hub.h"
+#include "i2c_bus.h"
+#include "imu_stream.h"
+#include "adc_stream.h"
+#include "rain_sensor.h"
+#include "ultrasonic.h"
+#include "driver/ledc.h"
+#include "lwip/sockets.h"
+
+#define BENCH_MAX               40
+#define BENCH_DEFAULT_REPEAT    15
+#define BENCH_WARMUP            3
+#define BENCH_TARGET_NS         20000000.0  // 每轮至少20ms，降低计时抖动
+#define BENCH_DEFAULT_THRESHOLD 25.0        // 中位数变慢超过25%视为回退（共享CI机器上中位数抖动约±15%）
+
+typedef struct {
+    const char *name;
+    void (*run)(void);             ///< 执行一次被测操作
+    bool (*check)(void);           ///< 结果校验（可为NULL）
+    const char *note;              ///< 附加说明（模拟时间等，可为NULL）
+} bench_t;
+
+typedef struct {
+    const char *name;
+    double median_ns;
+    double min_ns;
+    uint32_t iterations;
+} bench_result_t;
+
+static int s_check_failures;
+static uint32_t s_counter;
+static char s_buf[2048];
+static FILE *s_out;                 // 报告输出（stdout被重定向到/dev/null）
+
+/* ==================== 工具函数 ==================== */
+
+static double wall_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void check(bool cond, const char *what)
+{
+    if (!cond) {
+        fprintf(stderr, "CHECK FAILED: %s\n", what);
+        s_check_failures++;
+    }
+}
+
+/* ==================== 任务分析模拟来源 ==================== */
+
+static const char *s_sim_task_names[] = {
+    "IDLE0", "IDLE1", "main", "mqtt_task", "sensor_task", "lvgl_task",
+    "system_monitor", "wifi", "tiT", "esp_timer", "ipc0", "ipc1",
+};
+
+static size_t sim_sample_tasks(task_profiler_task_t *out, size_t max)
+{
+    size_t n = sizeof(s_sim_task_names) / sizeof(s_sim_task_names[0]);
+    if (n > max) {
+        n = max;
+    }
+    for (size_t i = 0; i < n; i++) {
+        memset(&out[i], 0, sizeof(out[i]));
+        strncpy(out[i].name, s_sim_task_names[i], TASK_PROFILER_NAME_LEN - 1);
+        out[i].task_number = i + 1;
+        out[i].runtime = s_counter * 5000u * (i + 1) / n;
+        out[i].stack_hwm = 1024 + i * 256;
+        out[i].priority = (uint8_t)(i % 6);
+        out[i].core = (int8_t)((int)(i % 3) - 1);
+    }
+    return n;
+}
+
+static void sim_sample_heap(task_profiler_heap_t *out)
+{
+    out->total_free = 180 * 1024;
+    out->largest_free_block = 110 * 1024;
+    out->min_free = 150 * 1024;
+}
+
+static uint32_t sim_now_ms(void)
+{
+    return s_counter * 5000u;
+}
+
+static const task_profiler_source_t s_profiler_source = {
+    .sample_tasks = sim_sample_tasks,
+    .sample_heap = sim_sample_heap,
+    .now_ms = sim_now_ms,
+    .runtime_stats = true,
+};
+
+/* ==================== 基准项：解析与分发 ==================== */
+
+static const char *s_led_on = "{\"cmd\":\"led\",\"device_id\":1,\"action\":\"on\"}";
+static const char *s_led_off = "{\"cmd\":\"led\",\"device_id\":1,\"action\":\"off\"}";
+static const char *s_servo_cmd = "{\"cmd\":\"servo\",\"device_id\":1,\"angle\":90}";
+static const char *s_preset_cmd =
+    "{\"cmd\":\"preset\",\"device_type\":\"led\",\"preset_type\":\"blink\",\"device_id\":1,"
+    "\"parameters\":{\"count\":2,\"on_time\":100,\"off_time\":100}}";
+
+static void bench_parse_device(void)
+{
+    device_control_command_t cmd;
+    device_control_parse_json_command(s_led_on, &cmd);
+}
+
+static bool check_parse_device(void)
+{
+    device_control_command_t cmd;
+    return device_control_parse_json_command(s_servo_cmd, &cmd) == ESP_OK &&
+           cmd.cmd_type == DEVICE_CONTROL_CMD_SERVO && cmd.device_id == 1 && cmd.value.angle == 90;
+}
+
+static void bench_dispatch_led(void)
+{
+    device_control_command_t cmd;
+    device_control_result_t result;
+    device_control_parse_json_command((s_counter++ & 1) ? s_led_off : s_led_on, &cmd);
+    device_control_execute(&cmd, &result);
+}
+
+static bool check_dispatch_led(void)
+{
+    device_control_command_t cmd;
+    device_control_result_t result;
+    device_control_parse_json_command(s_led_on, &cmd);
+    if (device_control_execute(&cmd, &result) != ESP_OK || !result.success) {
+        return false;
+    }
+    return host_sim_gpio_output(LED1_GPIO_PIN) == (LED1_ACTIVE_LEVEL ? 1 : 0);
+}
+
+static void bench_dispatch_servo(void)
+{
+    device_control_command_t cmd;
+    device_control_result_t result;
+    device_control_parse_json_command(s_servo_cmd, &cmd);
+    device_control_execute(&cmd, &result);
+}
+
+static bool check_dispatch_servo(void)
+{
+    bench_dispatch_servo();
+    // 90°对应1.5ms脉宽，占空比应为非0
+    for (int ch = 0; ch < 8; ch++) {
+        if (host_sim_ledc_freq(ch) == SERVO1_FREQUENCY && host_sim_ledc_duty(ch) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void bench_parse_preset(void)
+{
+    preset_control_command_t cmd;
+    if (preset_control_parse_json_command(s_preset_cmd, &cmd) == ESP_OK) {
+        preset_control_free_command(&cmd);
+    }
+}
+
+static void bench_dispatch_preset(void)
+{
+    preset_control_command_t cmd;
+    preset_control_result_t result;
+    if (preset_control_parse_json_command(s_preset_cmd, &cmd) == ESP_OK) {
+        preset_control_execute(&cmd, &result);
+        preset_control_free_command(&cmd);
+    }
+}
+
+static bool check_dispatch_preset(void)
+{
+    int64_t start = host_sim_now_us();
+    bench_dispatch_preset();
+    // blink 2次 x (100ms + 100ms)，延时全部走虚拟时钟
+    return host_sim_now_us() - start >= 400000;
+}
+
+static void bench_mqtt_dispatch(void)
+{
+    const char *payload = (s_counter++ & 1) ? s_led_off : s_led_on;
+    host_mqtt_inject(SIM_TOPIC_CONTROL, payload, -1);
+    host_mqtt_pump();
+}
+
+static bool check_mqtt_dispatch(void)
+{
+    sim_device_stats_t before, after;
+    sim_device_get_stats(&before);
+    host_mqtt_inject(SIM_TOPIC_CONTROL, s_led_on, -1);
+    host_mqtt_pump();
+    sim_device_get_stats(&after);
+    return after.commands_ok == before.commands_ok + 1 &&
+           host_sim_gpio_output(LED1_GPIO_PIN) == (LED1_ACTIVE_LEVEL ? 1 : 0);
+}
+
+/* ==================== 基准项：序列化 ==================== */
+
+static void bench_serialize_sensor(void)
+{
+    // 与main.c传感器任务上报格式相同
+    snprintf(s_buf, sizeof(s_buf),
+             "{\"device_id\":\"%s\",\"sensor\":\"DHT11\",\"temperature\":%.1f,\"humidity\":%.1f,\"timestamp\":%lu}",
+             "bench-device", 23.4f, 56.0f, (unsigned long)s_counter++);
+}
+
+static void bench_serialize_response(void)
+{
+    cJSON *resp = cJSON_CreateObject();
+    cJSON_AddStringToObject(resp, "status", "success");
+    cJSON_AddStringToObject(resp, "device_type", "led");
+    cJSON_AddNumberToObject(resp, "device_id", 1);
+    cJSON_AddBoolToObject(resp, "state", true);
+    cJSON_AddNumberToObject(resp, "timestamp", s_counter++);
+    char *json = cJSON_PrintUnformatted(resp);
+    free(json);
+    cJSON_Delete(resp);
+}
+
+static void bench_serialize_metrics(void)
+{
+    size_t len;
+    metrics_snapshot_json(s_buf, sizeof(s_buf), &len);
+}
+
+static bool check_serialize_metrics(void)
+{
+    size_t len = 0;
+    return metrics_snapshot_json(s_buf, sizeof(s_buf), &len) == ESP_OK && len > 2 && s_buf[0] == '{';
+}
+
+static task_profiler_report_t s_report;
+
+static void bench_serialize_task_report(void)
+{
+    size_t len;
+    task_profiler_report_json(&s_report, s_buf, sizeof(s_buf), &len);
+}
+
+static bool check_serialize_task_report(void)
+{
+    bench_serialize_task_report();
+    cJSON *root = cJSON_Parse(s_buf);
+    bool ok = root && cJSON_GetArraySize(cJSON_GetObjectItem(root, "tasks")) > 0;
+    cJSON_Delete(root);
+    return ok;
+}
+
+/* ==================== 基准项：CRC路径 ==================== */
+
+static void bench_sample_store_append(void)
+{
+    sample_store_record_t rec = {
+        .timestamp = 1700000000u + s_counter++,
+        .value = 23.5f,
+        .sensor_id = SAMPLE_SENSOR_DHT11,
+        .channel = 0,
+    };
+    sample_store_append(&rec);
+}
+
+static bool check_sample_store(void)
+{
+    bench_sample_store_append();
+    sample_store_stats_t stats;
+    return sample_store_get_stats(&stats) == ESP_OK && stats.record_count > 0;
+}
+
+static void bench_binlog_write(void)
+{
+    BINLOG_I("bench", "MQTT_EVENT_DATA, msg_id=%d, topic_len=%d, data_len=%d",
+             (int)s_counter++, 28, 44);
+}
+
+static void bench_ds18b20_read(void)
+{
+    ds18b20_data_t data;
+    ds18b20_read(&data);
+}
+
+static bool check_ds18b20(void)
+{
+    ds18b20_data_t data = {0};
+    host_sensor_ds18b20_set(25 * 16 + 8);      // 25.5°C
+    return ds18b20_read(&data) == ESP_OK && data.valid && data.temperature > 25.4f && data.temperature < 25.6f;
+}
+
+static void bench_dht11_read(void)
+{
+    dht11_data_t data;
+    host_sim_advance_us(2000000);              // 驱动限制最短2s读取间隔
+    dht11_read_adapter(&data);
+}
+
+static bool check_dht11(void)
+{
+    dht11_data_t data = {0};
+    host_sensor_dht11_set(231, 560);
+    host_sim_advance_us(2000000);
+    return dht11_read_adapter(&data) == ESP_OK && data.valid &&
+           data.temperature > 22.9f && data.temperature < 23.2f &&
+           data.humidity > 55.9f && data.humidity < 56.1f;
+}
+
+static sensor_hub_reading_t s_hub_readings[CONFIG_SENSOR_HUB_MAX_SENSORS];
+static char s_hub_note[64];
+
+static void bench_hub_read_all(void)
+{
+    host_sim_advance_us(2000000);              // DHT11最短2s读取间隔
+    sensor_hub_read_all(s_hub_readings, CONFIG_SENSOR_HUB_MAX_SENSORS);
+}
+
+static bool check_hub_read_all(void)
+{
+    host_sensor_dht11_set(231, 560);
+    host_sensor_ds18b20_set(25 * 16 + 8);      // 25.5°C
+
+    // 逐个读取（原main.c的做法）作为对照
+    dht11_data_t dht = {0};
+    ds18b20_data_t ds = {0};
+    host_sim_advance_us(2000000);
+    int64_t start = host_sim_now_us();
+    if (ds18b20_read(&ds) != ESP_OK || dht11_read_adapter(&dht) != ESP_OK) {
+        return false;
+    }
+    int64_t sequential_ms = (host_sim_now_us() - start) / 1000;
+
+    host_sim_advance_us(2000000);
+    start = host_sim_now_us();
+    size_t n = sensor_hub_read_all(s_hub_readings, CONFIG_SENSOR_HUB_MAX_SENSORS);
+    int64_t batched_ms = (host_sim_now_us() - start) / 1000;
+    // 转换时间重叠：一轮耗时不超过最长转换时间加少量总线时间
+    if (n != 2 || batched_ms >= sequential_ms || batched_ms > DS18B20_CONVERSION_MS + 50) {
+        return false;
+    }
+
+    int dht_index = sensor_hub_find(SAMPLE_SENSOR_DHT11);
+    int ds_index = sensor_hub_find(SAMPLE_SENSOR_DS18B20);
+    if (dht_index < 0 || ds_index < 0) {
+        return false;
+    }
+    for (size_t i = 0; i < n; i++) {
+        const sensor_hub_reading_t *r = &s_hub_readings[i];
+        if (r->err != ESP_OK || r->attempts != 1) {
+            return false;
+        }
+        if (r->index == dht_index &&
+            (r->values[0] < 22.9f || r->values[0] > 23.2f || r->values[1] < 55.9f || r->values[1] > 56.1f)) {
+            return false;
+        }
+        if (r->index == ds_index && (r->values[0] < 25.4f || r->values[0] > 25.6f)) {
+            return false;
+        }
+    }
+
+    // 上报JSON和显示字符串与原来写死的格式逐字节一致
+    char expect[SENSOR_HUB_JSON_MAX];
+    char json[SENSOR_HUB_JSON_MAX];
+    const float dht_values[] = { 23.4f, 56.0f };
+    snprintf(expect, sizeof(expect),
+             "{\"device_id\":\"%s\",\"sensor\":\"DHT11\",\"temperature\":%.1f,\"humidity\":%.1f,\"timestamp\":%lu}",
+             "bench-device", 23.4f, 56.0f, 42UL);
+    if (sensor_hub_format_json(dht_index, "bench-device", dht_values, 42, json, sizeof(json)) == 0 ||
+        strcmp(json, expect) != 0) {
+        return false;
+    }
+    const float ds_values[] = { 25.5f };
+    snprintf(expect, sizeof(expect),
+             "{\"device_id\":\"%s\",\"sensor\":\"DS18B20\",\"temperature\":%.1f,\"timestamp\":%lu}",
+             "bench-device", 25.5f, 42UL);
+    if (sensor_hub_format_json(ds_index, "bench-device", ds_values, 42, json, sizeof(json)) == 0 ||
+        strcmp(json, expect) != 0) {
+        return false;
+    }
+    if (sensor_hub_format_display(dht_index, dht_values, json, sizeof(json)) == 0 ||
+        strcmp(json, "23.4C / 56.0%") != 0) {
+        return false;
+    }
+
+    // bsp_sensor_read() 的展开通道：DHT11温度、湿度、DS18B20温度
+    float value = 0;
+    if (sensor_hub_get_value(2, &value) != ESP_OK || value < 25.4f || value > 25.6f ||
+        sensor_hub_get_value(3, &value) != ESP_ERR_INVALID_ARG) {
+        return false;
+    }
+
+    snprintf(s_hub_note, sizeof(s_hub_note), "2 sensors: %lld ms virtual vs %lld sequential",
+             (long long)batched_ms, (long long)sequential_ms);
+    return true;
+}
+
+/* ==================== 基准项：告警判断 ==================== */
+
+static alarm_event_t s_alarm_events[8];
+static size_t s_alarm_event_count;
+
+static void record_alarm_event(const alarm_event_t *event, void *ctx)
+{
+    (void)ctx;
+    if (s_alarm_event_count < sizeof(s_alarm_events) / sizeof(s_alarm_events[0])) {
+        s_alarm_events[s_alarm_event_count] = *event;
+    }
+    s_alarm_event_count++;
+}
+
+// 全部四种判断都启用，数值在阈值以内小幅波动（稳态路径，不产生事件）
+static const alarm_rule_t s_bench_rule = {
+    .sensor = SAMPLE_SENSOR_DHT11, .channel = 0,
+    .checks = ALARM_CHECK_MIN | ALARM_CHECK_MAX | ALARM_CHECK_RATE | ALARM_CHECK_STUCK,
+    .debounce = 2, .min = 5.0f, .max = 35.0f, .hysteresis = 0.5f,
+    .rate = 100.0f, .stuck_epsilon = 0.05f, .stuck_sec = 600,
+};
+
+static void bench_alarm_feed(void)
+{
+    s_counter++;
+    alarm_feed(SAMPLE_SENSOR_DHT11, 0, 23.0f + (float)(s_counter & 7) * 0.1f, s_counter * 1000);
+}
+
+static bool check_alarm_feed(void)
+{
+    alarm_rule_t rule = s_bench_rule;
+    rule.sensor = SAMPLE_SENSOR_DS18B20;
+    rule.rate = 10.0f;
+    rule.stuck_sec = 30;
+    if (alarm_set_rule(&rule) != ESP_OK) {
+        return false;
+    }
+
+    // 每10秒一次采样：36 -> 36 -> 34.8(回差内不解除) -> 34 -> 34 -> 34 -> 34
+    static const float values[] = { 36.0f, 36.0f, 34.8f, 34.0f, 34.0f, 34.0f, 34.0f };
+    s_alarm_event_count = 0;
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        alarm_feed(SAMPLE_SENSOR_DS18B20, 0, values[i], 100000 + i * 10000);
+    }
+    alarm_remove_rule(SAMPLE_SENSOR_DS18B20, 0);
+
+    // 期望：第2次采样high告警（去抖2次）、第5次采样high解除、
+    // 第7次采样（30秒未变化）stuck告警；最大变化率7.2/分钟，不触发rate告警
+    return s_alarm_event_count == 3 &&
+           s_alarm_events[0].kind == ALARM_KIND_HIGH && s_alarm_events[0].active &&
+           s_alarm_events[1].kind == ALARM_KIND_HIGH && !s_alarm_events[1].active &&
+           s_alarm_events[2].kind == ALARM_KIND_STUCK && s_alarm_events[2].active &&
+           alarm_active_count() == 0;
+}
+
+/* ==================== 基准项：按变化上报 ==================== */
+
+static void bench_report_check(void)
+{
+    s_counter++;
+    float values[2] = { 23.0f + (float)(s_counter & 3) * 0.1f, 55.0f };
+    report_filter_check(SAMPLE_SENSOR_DHT11, values, 2, s_counter * 10000);
+}
+
+static bool check_report_check(void)
+{
+    // 死区0.5、最短10秒、最长60秒；每10秒一次采样
+    const report_policy_t policy = {
+        .sensor = SAMPLE_SENSOR_DS18B20, .deadband_abs = 0.5f,
+        .min_interval_sec = 10, .max_interval_sec = 60,
+    };
+    static const float values[] = { 20.0f, 20.2f, 20.4f, 20.6f, 20.6f, 20.6f, 20.6f, 20.6f, 20.6f, 20.6f };
+    static const report_reason_t expect[] = {
+        REPORT_FIRST, REPORT_SKIP, REPORT_SKIP, REPORT_CHANGED, REPORT_SKIP,
+        REPORT_SKIP, REPORT_SKIP, REPORT_SKIP, REPORT_SKIP, REPORT_MAX_INTERVAL,
+    };
+
+    if (report_filter_set_policy(&policy) != ESP_OK) {
+        return false;
+    }
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        uint32_t now = 1000000 + i * 10000;
+        report_reason_t reason = report_filter_check(SAMPLE_SENSOR_DS18B20, &values[i], 1, now);
+        ok = ok && reason == expect[i];
+        if (reason != REPORT_SKIP) {
+            report_filter_commit(SAMPLE_SENSOR_DS18B20, &values[i], 1, now);
+        }
+    }
+
+    // 关闭后每次都上报
+    report_filter_set_enabled(false);
+    ok = ok && report_filter_check(SAMPLE_SENSOR_DS18B20, &values[0], 1, 2000000) == REPORT_ALWAYS;
+    report_filter_set_enabled(true);
+    return ok;
+}
+
+/* ==================== 基准项：传感器滤波 ==================== */
+
+static char s_filter_note[48];
+
+// 校准+范围+Hampel(5)+中值(5)+EMA全部启用，最坏情况的每次处理耗时
+static const sensor_filter_config_t s_bench_filter = {
+    .sensor = SAMPLE_SENSOR_DHT11, .channel = 0,
+    .median_n = 5, .hampel_n = 5, .hampel_k_x10 = 30, .hampel_floor = 2000,
+    .ema_alpha = 77, .min = 0, .max = 50000, .offset = -500, .scale = 66000,
+};
+
+static void bench_filter_apply(void)
+{
+    float out;
+    s_counter++;
+    sensor_filter_apply(SAMPLE_SENSOR_DHT11, 0, 23.0f + (float)(s_counter & 7) * 0.1f, &out);
+}
+
+static bool check_filter_apply(void)
+{
+    // DS18B20：上电复位值85°C被Hampel替换，超出范围的读数丢弃，校准偏移生效
+    const sensor_filter_config_t cfg = {
+        .sensor = SAMPLE_SENSOR_DS18B20, .channel = 0, .hampel_n = 5, .hampel_k_x10 = 30,
+        .hampel_floor = 1000, .min = -55000, .max = 125000, .offset = 500,
+    };
+    static const float raw[] = { 21.0f, 21.1f, 21.0f, 85.0f, 21.2f, 200.0f, 21.1f };
+    static const sensor_filter_result_t expect[] = {
+        SENSOR_FILTER_OK, SENSOR_FILTER_OK, SENSOR_FILTER_OK, SENSOR_FILTER_REPLACED,
+        SENSOR_FILTER_OK, SENSOR_FILTER_REJECTED, SENSOR_FILTER_OK,
+    };
+
+    if (sensor_filter_configure(&cfg) != ESP_OK) {
+        return false;
+    }
+    bool ok = true;
+    float out = 0.0f;
+    for (size_t i = 0; i < sizeof(raw) / sizeof(raw[0]); i++) {
+        ok = ok && sensor_filter_apply(SAMPLE_SENSOR_DS18B20, 0, raw[i], &out) == expect[i];
+        ok = ok && out > 21.45f && out < 21.75f;
+    }
+
+    // EMA：阶跃输入按alpha逼近
+    const sensor_filter_config_t ema = {
+        .sensor = SAMPLE_SENSOR_DS18B20, .channel = 1, .ema_alpha = 128, .min = -1000000, .max = 1000000,
+    };
+    sensor_filter_configure(&ema);
+    sensor_filter_apply(SAMPLE_SENSOR_DS18B20, 1, 0.0f, &out);
+    sensor_filter_apply(SAMPLE_SENSOR_DS18B20, 1, 10.0f, &out);
+    ok = ok && out == 5.0f;
+    sensor_filter_apply(SAMPLE_SENSOR_DS18B20, 1, 10.0f, &out);
+    return ok && out == 7.5f;
+}
+
+/* ==================== 基准项：流式JSON解析 ==================== */
+
+static char s_json_note[48];
+
+// /device/info 响应的主要字段（与provisioning_config_t同样的绑定方式）
+typedef struct {
+    char device_uuid[128];
+    char product_id[64];
+    bool has_mqtt_config;
+    char mqtt_broker[256];
+    int mqtt_port;
+    bool mqtt_use_ssl;
+    char mqtt_topic_data[256];
+    bool has_firmware_update;
+    char firmware_url[512];
+    uint32_t firmware_size;
+    char firmware_changelog[32];
+} bench_provision_t;
+
+static const json_field_t s_bench_fields[] = {
+    JSON_FIELD(JSON_FIELD_STRING, "device_uuid", bench_provision_t, device_uuid),
+    JSON_FIELD(JSON_FIELD_STRING, "product_id", bench_provision_t, product_id),
+    JSON_FIELD(JSON_FIELD_PRESENT, "mqtt_config", bench_provision_t, has_mqtt_config),
+    JSON_FIELD(JSON_FIELD_STRING, "mqtt_config.broker", bench_provision_t, mqtt_broker),
+    JSON_FIELD(JSON_FIELD_INT, "mqtt_config.port", bench_provision_t, mqtt_port),
+    JSON_FIELD(JSON_FIELD_BOOL, "mqtt_config.use_ssl", bench_provision_t, mqtt_use_ssl),
+    JSON_FIELD(JSON_FIELD_STRING, "mqtt_config.topics.data", bench_provision_t, mqtt_topic_data),
+    JSON_FIELD(JSON_FIELD_BOOL, "firmware_update.available", bench_provision_t, has_firmware_update),
+    JSON_FIELD(JSON_FIELD_STRING, "firmware_update.download_url", bench_provision_t, firmware_url),
+    JSON_FIELD(JSON_FIELD_UINT32, "firmware_update.file_size", bench_provision_t, firmware_size),
+    JSON_FIELD(JSON_FIELD_STRING, "firmware_update.changelog", bench_provision_t, firmware_changelog),
+};
+
+#define BENCH_FIELD_COUNT   (sizeof(s_bench_fields) / sizeof(s_bench_fields[0]))
+
+// 嵌套对象、数组、未知键、转义（\u4e2d、代理对、\n）、超长字符串截断
+static const char s_bench_json[] =
+    "{\"device_id\":\"AIOT-ESP32-0001\",\"device_uuid\":\"7f3c2a10-5b9e-4d2a-9c1e-0a1b2c3d4e5f\","
+    "\"product_id\":\"P\\u4e2d1\",\"tags\":[\"a\",{\"x\":[1,2,[]]},null,-1.5e3],"
+    " \"mqtt_config\" : {\"broker\":\"mqtt.example.com\",\"port\":8883,\"use_ssl\":true,"
+    "\"topics\":{\"data\":\"devices/7f3c/data\",\"control\":\"devices/7f3c/control\"}},"
+    "\"firmware_update\":{\"available\":true,\"version\":\"1.2.3\","
+    "\"download_url\":\"https://ota.example.com/firmware/esp32-s3/aiot-esp32-1.2.3-release-build-20260101.bin"
+    "?token=0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef\","
+    "\"file_size\":1048576,\"changelog\":\"\\ud83d\\ude80 fix\\nmore than thirty-one bytes here\"}}";
+
+static bench_provision_t s_bench_prov;
+
+static esp_err_t json_parse_chunked(const char *doc, size_t len, size_t chunk, bench_provision_t *out,
+                                    uint32_t *matched)
+{
+    json_stream_t js;
+    json_stream_bind_t bind;
+
+    memset(out, 0, sizeof(*out));
+    json_stream_init_bind(&js, &bind, s_bench_fields, BENCH_FIELD_COUNT, out);
+    for (size_t pos = 0; pos < len; pos += chunk) {
+        size_t n = len - pos < chunk ? len - pos : chunk;
+        esp_err_t err = json_stream_feed(&js, doc + pos, n);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    if (matched) {
+        *matched = bind.matched;
+    }
+    return json_stream_finish(&js);
+}
+
+static void bench_json_stream(void)
+{
+    // 按TCP分段的典型大小分块输入
+    json_parse_chunked(s_bench_json, sizeof(s_bench_json) - 1, 64, &s_bench_prov, NULL);
+}
+
+static bool json_expected(const bench_provision_t *p, uint32_t matched)
+{
+    return matched == (1UL << BENCH_FIELD_COUNT) - 1 &&
+           strcmp(p->device_uuid, "7f3c2a10-5b9e-4d2a-9c1e-0a1b2c3d4e5f") == 0 &&
+           strcmp(p->product_id, "P\xe4\xb8\xad" "1") == 0 &&
+           p->has_mqtt_config && strcmp(p->mqtt_broker, "mqtt.example.com") == 0 &&
+           p->mqtt_port == 8883 && p->mqtt_use_ssl &&
+           strcmp(p->mqtt_topic_data, "devices/7f3c/data") == 0 &&
+           p->has_firmware_update && strlen(p->firmware_url) == 156 &&
+           strcmp(p->firmware_url + 140, "0123456789abcdef") == 0 &&
+           p->firmware_size == 1048576 &&
+           strcmp(p->firmware_changelog, "\xf0\x9f\x9a\x80 fix\nmore than thirty-one b") == 0;
+}
+
+static bool check_json_stream(void)
+{
+    const size_t len = sizeof(s_bench_json) - 1;
+    bench_provision_t p;
+    uint32_t matched = 0;
+
+    // 任意分块大小结果一致（1字节分块覆盖在每个转义、数字、字面量中间断开）
+    for (size_t chunk = 1; chunk <= len; chunk++) {
+        if (json_parse_chunked(s_bench_json, len, chunk, &p, &matched) != ESP_OK || !json_expected(&p, matched)) {
+            return false;
+        }
+    }
+
+    // 两块：在每个位置断开一次
+    for (size_t split = 1; split < len; split++) {
+        json_stream_t js;
+        json_stream_bind_t bind;
+        memset(&p, 0, sizeof(p));
+        json_stream_init_bind(&js, &bind, s_bench_fields, BENCH_FIELD_COUNT, &p);
+        if (json_stream_feed(&js, s_bench_json, split) != ESP_OK ||
+            json_stream_feed(&js, s_bench_json + split, len - split) != ESP_OK ||
+            json_stream_finish(&js) != ESP_OK || !json_expected(&p, bind.matched)) {
+            return false;
+        }
+    }
+
+    // 响应被截断：文档不完整；语法错误：报告错误
+    static const char *bad[] = { "{\"a\":[1,2}", "{\"a\":tru}", "{\"a\":01x}", "{\"a\" 1}", "{\"a\":\"x\ty\"}", "[1,]" };
+    bool ok = json_parse_chunked(s_bench_json, len - 1, 7, &p, NULL) == ESP_ERR_INVALID_STATE;
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        ok = ok && json_parse_chunked(bad[i], strlen(bad[i]), 3, &p, NULL) == ESP_ERR_INVALID_RESPONSE;
+    }
+    return ok;
+}
+
+/* ==================== 基准项：强制门户DNS ==================== */
+
+static char s_dns_note[48];
+static int s_dns_client = -1;
+static captive_dns_template_t s_dns_tmpl;
+
+/**
+ * @brief 构造查询报文：每个问题为(域名, 类型)，类型为0时结束
+ */
+static size_t dns_build_query(uint8_t *buf, uint16_t id, const char *const *names, const uint16_t *types, size_t count)
+{
+    memset(buf, 0, 12);
+    buf[0] = (uint8_t)(id >> 8);
+    buf[1] = (uint8_t)id;
+    buf[2] = 0x01;                              // RD
+    buf[5] = (uint8_t)count;
+    size_t pos = 12;
+    for (size_t i = 0; i < count; i++) {
+        const char *p = names[i];
+        while (*p) {
+            const char *dot = strchr(p, '.');
+            size_t n = dot ? (size_t)(dot - p) : strlen(p);
+            buf[pos++] = (uint8_t)n;
+            memcpy(buf + pos, p, n);
+            pos += n;
+            p += n + (dot ? 1 : 0);
+        }
+        buf[pos++] = 0;
+        buf[pos++] = (uint8_t)(types[i] >> 8);
+        buf[pos++] = (uint8_t)types[i];
+        buf[pos++] = 0;
+        buf[pos++] = 1;                         // IN
+    }
+    return pos;
+}
+
+static uint8_t s_dns_query[128];
+static size_t s_dns_query_len;
+
+static void bench_dns_answer(void)
+{
+    uint8_t out[CAPTIVE_DNS_MAX_PACKET];
+    s_dns_query[1] = (uint8_t)s_counter++;
+    captive_dns_answer(&s_dns_tmpl, s_dns_query, s_dns_query_len, out, sizeof(out));
+}
+
+static bool check_dns_answer(void)
+{
+    uint8_t out[CAPTIVE_DNS_MAX_PACKET];
+    size_t n = captive_dns_answer(&s_dns_tmpl, s_dns_query, s_dns_query_len, out, sizeof(out));
+
+    // 2个问题（A + AAAA）：1条A记录指向第1个问题名，AAAA无记录
+    bool ok = n == s_dns_query_len + 16 && out[2] == 0x85 && out[3] == 0x80 &&
+              out[5] == 2 && out[7] == 1 && out[9] == 0 && out[11] == 0 &&
+              memcmp(out + 12, s_dns_query + 12, s_dns_query_len - 12) == 0 &&
+              out[s_dns_query_len] == 0xC0 && out[s_dns_query_len + 1] == 12 &&
+              memcmp(out + n - 4, "\xC0\xA8\x04\x01", 4) == 0 && out[n - 7] == 60;
+
+    // 格式错误：标签越界、响应报文、无问题、压缩指针、缓冲区不足
+    uint8_t bad[sizeof(s_dns_query)];
+    memcpy(bad, s_dns_query, s_dns_query_len);
+    bad[12] = 60;
+    ok = ok && captive_dns_answer(&s_dns_tmpl, bad, s_dns_query_len, out, sizeof(out)) == 0;
+    memcpy(bad, s_dns_query, s_dns_query_len);
+    bad[2] |= 0x80;
+    ok = ok && captive_dns_answer(&s_dns_tmpl, bad, s_dns_query_len, out, sizeof(out)) == 0;
+    bad[2] &= 0x7F;
+    bad[5] = 0;
+    ok = ok && captive_dns_answer(&s_dns_tmpl, bad, s_dns_query_len, out, sizeof(out)) == 0;
+    bad[5] = 2;
+    bad[12] = 0xC0;
+    ok = ok && captive_dns_answer(&s_dns_tmpl, bad, s_dns_query_len, out, sizeof(out)) == 0;
+    ok = ok && captive_dns_answer(&s_dns_tmpl, s_dns_query, s_dns_query_len, out, s_dns_query_len + 15) == 0;
+
+    // 限速：突发3次后按每秒2次补充；其他客户端不受影响；满表时替换最久未出现的客户端
+    captive_dns_limiter_t lim;
+    captive_dns_limiter_init(&lim, 2, 3);
+    for (int i = 0; i < 3; i++) {
+        ok = ok && captive_dns_limiter_allow(&lim, 0xC0A80402, 1000);
+    }
+    ok = ok && !captive_dns_limiter_allow(&lim, 0xC0A80402, 2000);
+    ok = ok && captive_dns_limiter_allow(&lim, 0xC0A80403, 2000);
+    ok = ok && !captive_dns_limiter_allow(&lim, 0xC0A80402, 400000);
+    ok = ok && captive_dns_limiter_allow(&lim, 0xC0A80402, 502000);
+    ok = ok && !captive_dns_limiter_allow(&lim, 0xC0A80402, 503000);
+    for (uint32_t i = 0; i < CAPTIVE_DNS_MAX_CLIENTS; i++) {
+        captive_dns_limiter_allow(&lim, 0x0A000001 + i, 600000 + i);
+    }
+    ok = ok && captive_dns_limiter_allow(&lim, 0xC0A80402, 700000);
+    return ok;
+}
+
+/**
+ * @brief 经本机UDP发送一次查询并等待应答
+ *
+ * @return 应答长度；超时或出错返回-1
+ */
+static int dns_roundtrip(const uint8_t *query, size_t len, uint8_t *resp, size_t resp_size)
+{
+    struct sockaddr_in to = {
+        .sin_family = AF_INET,
+        .sin_port = htons(captive_dns_get_port()),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    if (sendto(s_dns_client, query, len, 0, (struct sockaddr *)&to, sizeof(to)) < 0) {
+        return -1;
+    }
+    return (int)recv(s_dns_client, resp, resp_size, 0);
+}
+
+static void bench_dns_udp(void)
+{
+    uint8_t resp[CAPTIVE_DNS_MAX_PACKET];
+    s_dns_query[1] = (uint8_t)s_counter++;
+    dns_roundtrip(s_dns_query, s_dns_query_len, resp, sizeof(resp));
+}
+
+static double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool check_dns_udp(void)
+{
+    uint8_t resp[CAPTIVE_DNS_MAX_PACKET];
+    bool ok = true;
+
+    // 限速（虚拟时钟不走，令牌不补充）：突发3次之后的查询被丢弃（客户端超时）
+    captive_dns_stop();
+    captive_dns_config_t cfg = CAPTIVE_DNS_DEFAULT_CONFIG();
+    cfg.port = 0;
+    cfg.rate_per_s = 1;
+    cfg.burst = 3;
+    ok = ok && captive_dns_start(&cfg) == ESP_OK;
+    int answered = 0;
+    for (int i = 0; i < 5; i++) {
+        answered += dns_roundtrip(s_dns_query, s_dns_query_len, resp, sizeof(resp)) > 0;
+    }
+    captive_dns_stats_t stats;
+    captive_dns_get_stats(&stats);
+    ok = ok && answered == 3 && stats.queries == 5 && stats.rate_limited == 2;
+    // 停止等任务确认退出（任务自己关闭socket）后返回，之后可以马上重新启动
+    ok = ok && captive_dns_stop() == ESP_OK && !captive_dns_is_running();
+
+    // 不限速，测量本机回环上的查询速率和往返延迟
+    cfg.rate_per_s = 0;
+    ok = ok && captive_dns_start(&cfg) == ESP_OK;
+    const int rounds = 2000;
+    double worst = 0.0;
+    double t0 = now_sec();
+    for (int i = 0; i < rounds && ok; i++) {
+        s_dns_query[1] = (uint8_t)i;
+        double t = now_sec();
+        int n = dns_roundtrip(s_dns_query, s_dns_query_len, resp, sizeof(resp));
+        t = now_sec() - t;
+        worst = t > worst ? t : worst;
+        ok = n == (int)s_dns_query_len + 16 && resp[1] == (uint8_t)i && resp[7] == 1;
+    }
+    double elapsed = now_sec() - t0;
+    snprintf(s_dns_note, sizeof(s_dns_note), "%.0f qps, avg %.0f us, max %.0f us",
+             rounds / elapsed, elapsed / rounds * 1e6, worst * 1e6);
+    return ok;
+}
+
+/* ==================== 基准项：BLE分片传输 ==================== */
+
+static char s_ble_note[48];
+static uint8_t s_ble_msg[3000];             ///< 模拟带证书的配网JSON
+static uint8_t s_ble_txbuf[BLE_FRAG_TX_BUF_SIZE];
+static uint8_t s_ble_rxbuf[BLE_FRAG_MAX_MSG];
+
+/**
+ * @brief 一条消息按给定MTU分片发送并重组
+ *
+ * @return 分片数；重组结果与原消息不同或出错返回-1
+ */
+static int ble_frag_roundtrip(const uint8_t *msg, size_t len, uint16_t mtu)
+{
+    ble_frag_tx_t tx;
+    ble_frag_rx_t rx;
+    uint8_t frame[BLE_FRAG_ATTR_MAX];
+    size_t frame_max = (size_t)mtu - 3 < sizeof(frame) ? (size_t)mtu - 3 : sizeof(frame);
+    ble_frag_tx_init(&tx, s_ble_txbuf, sizeof(s_ble_txbuf));
+    ble_frag_rx_init(&rx, s_ble_rxbuf, sizeof(s_ble_rxbuf));
+    if (ble_frag_tx_push(&tx, msg, len) != ESP_OK) {
+        return -1;
+    }
+
+    int frags = 0;
+    const uint8_t *out = NULL;
+    size_t out_len = 0;
+    esp_err_t ret = ESP_ERR_NOT_FINISHED;
+    size_t n;
+    while ((n = ble_frag_tx_peek(&tx, frame_max, frame)) > 0) {
+        if (ret != ESP_ERR_NOT_FINISHED || n > frame_max) {
+            return -1;
+        }
+        ble_frag_tx_commit(&tx, n);
+        ret = ble_frag_rx_feed(&rx, frame, n, &out, &out_len);
+        frags++;
+    }
+    if (ret != ESP_OK || out_len != len || memcmp(out, msg, len) != 0 || ble_frag_tx_pending(&tx)) {
+        return -1;
+    }
+    return frags;
+}
+
+static void bench_ble_frag(void)
+{
+    s_ble_msg[0] = (uint8_t)s_counter++;
+    ble_frag_roundtrip(s_ble_msg, sizeof(s_ble_msg), 247);
+}
+
+static bool check_ble_frag(void)
+{
+    bool ok = true;
+
+    // 各种MTU和消息长度（含单片边界：分片上限减去3字节首片头）都能原样重组
+    static const uint16_t mtus[] = { 23, 24, 27, 185, 247, 512, 517 };
+    for (size_t i = 0; i < sizeof(mtus) / sizeof(mtus[0]) && ok; i++) {
+        size_t frame_max = mtus[i] - 3 < BLE_FRAG_ATTR_MAX ? (size_t)mtus[i] - 3 : BLE_FRAG_ATTR_MAX;
+        size_t single = frame_max - 3;
+        const size_t lens[] = { 1, single, single + 1, 1000, sizeof(s_ble_msg) };
+        for (size_t j = 0; j < sizeof(lens) / sizeof(lens[0]) && ok; j++) {
+            int frags = ble_frag_roundtrip(s_ble_msg, lens[j], mtus[i]);
+            ok = frags > 0 && (lens[j] > single || frags == 1) && (lens[j] != single + 1 || frags == 2);
+        }
+    }
+    int frags_247 = ble_frag_roundtrip(s_ble_msg, sizeof(s_ble_msg), 247);
+    int frags_23 = ble_frag_roundtrip(s_ble_msg, sizeof(s_ble_msg), 23);
+    ok = ok && frags_247 == 13 && frags_23 == 158;
+
+    // 队列：多条消息依次发出；满了返回NO_MEM，前面的消息发完后腾出空间
+    uint8_t small_buf[64];
+    uint8_t frame[32];
+    ble_frag_tx_t tx;
+    ble_frag_tx_init(&tx, small_buf, sizeof(small_buf));
+    ok = ok && ble_frag_tx_push(&tx, s_ble_msg, 30) == ESP_OK;
+    ok = ok && ble_frag_tx_push(&tx, s_ble_msg, 20) == ESP_OK;
+    ok = ok && ble_frag_tx_push(&tx, s_ble_msg, 20) == ESP_ERR_NO_MEM;
+    ok = ok && ble_frag_tx_push(&tx, s_ble_msg, 63) == ESP_ERR_INVALID_SIZE;
+    size_t n = ble_frag_tx_peek(&tx, sizeof(frame), frame);
+    ok = ok && n == 32 && frame[0] == BLE_FRAG_HDR_FIRST && frame[1] == 30 && frame[2] == 0;
+    ble_frag_tx_commit(&tx, n);
+    n = ble_frag_tx_peek(&tx, sizeof(frame), frame);
+    ok = ok && n == 2 && frame[0] == (BLE_FRAG_HDR_LAST | 1);
+    ble_frag_tx_commit(&tx, n);
+    ok = ok && ble_frag_tx_push(&tx, s_ble_msg, 20) == ESP_OK;
+    n = ble_frag_tx_peek(&tx, sizeof(frame), frame);
+    ok = ok && n == 23 && frame[0] == (BLE_FRAG_HDR_FIRST | BLE_FRAG_HDR_LAST);
+    ble_frag_tx_commit(&tx, n);
+    n = ble_frag_tx_peek(&tx, sizeof(frame), frame);
+    ble_frag_tx_commit(&tx, n);
+    ok = ok && n == 23 && !ble_frag_tx_pending(&tx);
+
+    // 兼容模式：不加分片头，按frame_max原样切片
+    ble_frag_tx_set_raw(&tx, true);
+    ok = ok && ble_frag_tx_push(&tx, s_ble_msg, 40) == ESP_OK;
+    n = ble_frag_tx_peek(&tx, sizeof(frame), frame);
+    ok = ok && n == 32 && memcmp(frame, s_ble_msg, 32) == 0;
+    ble_frag_tx_commit(&tx, n);
+    n = ble_frag_tx_peek(&tx, sizeof(frame), frame);
+    ok = ok && n == 8 && memcmp(frame, s_ble_msg + 32, 8) == 0;
+    ble_frag_tx_commit(&tx, n);
+    ok = ok && !ble_frag_tx_pending(&tx);
+
+    // 接收错误：无首片、序号跳变、超长、末片长度不符；新首片丢弃未完成的消息
+    ble_frag_rx_t rx;
+    const uint8_t *msg;
+    size_t msg_len;
+    ble_frag_rx_init(&rx, s_ble_rxbuf, 100);
+    const uint8_t orphan[] = { 0x01, 'x' };
+    const uint8_t first[] = { 0x80, 4, 0, 'a', 'b' };
+    const uint8_t skip[] = { 0x42, 'c', 'd' };
+    const uint8_t last[] = { 0x41, 'c', 'd' };
+    const uint8_t short_last[] = { 0x41, 'c' };
+    const uint8_t huge[] = { 0xC0, 101, 0, 'a' };
+    ok = ok && ble_frag_rx_feed(&rx, orphan, sizeof(orphan), &msg, &msg_len) == ESP_ERR_INVALID_STATE;
+    ok = ok && ble_frag_rx_feed(&rx, huge, sizeof(huge), &msg, &msg_len) == ESP_ERR_INVALID_SIZE;
+    ok = ok && ble_frag_rx_feed(&rx, first, sizeof(first), &msg, &msg_len) == ESP_ERR_NOT_FINISHED;
+    ok = ok && ble_frag_rx_feed(&rx, skip, sizeof(skip), &msg, &msg_len) == ESP_ERR_INVALID_STATE;
+    ok = ok && ble_frag_rx_feed(&rx, first, sizeof(first), &msg, &msg_len) == ESP_ERR_NOT_FINISHED;
+    ok = ok && ble_frag_rx_feed(&rx, short_last, sizeof(short_last), &msg, &msg_len) == ESP_ERR_INVALID_SIZE;
+    ok = ok && ble_frag_rx_feed(&rx, first, sizeof(first), &msg, &msg_len) == ESP_ERR_NOT_FINISHED;
+    ok = ok && ble_frag_rx_feed(&rx, first, sizeof(first), &msg, &msg_len) == ESP_ERR_NOT_FINISHED;
+    ok = ok && ble_frag_rx_feed(&rx, last, sizeof(last), &msg, &msg_len) == ESP_OK &&
+         msg_len == 4 && memcmp(msg, "abcd", 4) == 0;
+
+    snprintf(s_ble_note, sizeof(s_ble_note), "3000 B: %d notifies @247, %d @23", frags_247, frags_23);
+    return ok;
+}
+
+/* ==================== 基准项：配网状态 ==================== */
+
+static char s_prov_note[48];
+
+static const live_provision_status_t s_prov_status = {
+    .stage = LIVE_PROVISION_ONLINE, .message = "Online \"AP\"", .wifi_attempts = 2,
+    .wifi_ms = 2140, .server_ms = 2180, .broker_ms = 2950, .mqtt_ms = 3890, .telemetry_ms = 9020,
+};
+
+static void bench_prov_status(void)
+{
+    char buf[256];
+    live_provision_format_status(&s_prov_status, buf, sizeof(buf));
+}
+
+static bool check_prov_status(void)
+{
+    char buf[256];
+    char host[LIVE_PROVISION_HOST_MAX];
+    bool ok = true;
+
+    // 状态JSON：网页轮询和BLE通知共用，message转义；缓冲区不足时返回0
+    size_t n = live_provision_format_status(&s_prov_status, buf, sizeof(buf));
+    cJSON *json = n ? cJSON_Parse(buf) : NULL;
+    ok = ok && json &&
+         strcmp(cJSON_GetObjectItem(json, "stage")->valuestring, "online") == 0 &&
+         strcmp(cJSON_GetObjectItem(json, "message")->valuestring, "Online \"AP\"") == 0 &&
+         cJSON_GetObjectItem(json, "attempts")->valueint == 2 &&
+         cJSON_GetObjectItem(json, "server_ms")->valueint == 2180 &&
+         cJSON_GetObjectItem(json, "telemetry_ms")->valueint == 9020;
+    cJSON_Delete(json);
+    ok = ok && live_provision_format_status(&s_prov_status, buf, n) == 0;
+
+    // 反斜杠和控制字符按JSON规则转义，解析后还原
+    live_provision_status_t ctrl = s_prov_status;
+    strcpy(ctrl.message, "C:\\ap\tx\x01");
+    json = live_provision_format_status(&ctrl, buf, sizeof(buf)) ? cJSON_Parse(buf) : NULL;
+    ok = ok && json && strcmp(cJSON_GetObjectItem(json, "message")->valuestring, ctrl.message) == 0;
+    cJSON_Delete(json);
+
+    // 服务器地址 -> 主机名
+    ok = ok && live_provision_parse_host("http://192.168.1.10", host, sizeof(host)) == ESP_OK &&
+         strcmp(host, "192.168.1.10") == 0;
+    ok = ok && live_provision_parse_host("https://iot.example.com:8000/api?x=1", host, sizeof(host)) == ESP_OK &&
+         strcmp(host, "iot.example.com") == 0;
+    ok = ok && live_provision_parse_host(" broker.local/", host, sizeof(host)) == ESP_OK &&
+         strcmp(host, "broker.local") == 0;
+    ok = ok && live_provision_parse_host("http://:1883", host, sizeof(host)) == ESP_ERR_INVALID_ARG;
+    ok = ok && live_provision_parse_host("http://iot.example.com", host, 8) == ESP_ERR_INVALID_SIZE;
+    ok = ok && strcmp(live_provision_stage_name(LIVE_PROVISION_DEGRADED), "degraded") == 0;
+
+    // 服务器地址 -> 配置服务器端口（未写端口按协议取默认值）
+    ok = ok && live_provision_parse_port("http://192.168.1.10") == 80;
+    ok = ok && live_provision_parse_port("https://iot.example.com/api") == 443;
+    ok = ok && live_provision_parse_port("https://iot.example.com:8000/api?x=1") == 8000;
+    ok = ok && live_provision_parse_port(" broker.local:1883") == 1883;
+    ok = ok && live_provision_parse_port("http://host:0") == 0;
+    ok = ok && live_provision_parse_port("http://host:70000") == 0;
+    ok = ok && live_provision_parse_port("http://host:80x") == 0;
+
+    // broker探测：本机监听端口可达，关闭后连接被拒绝
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t addr_len = sizeof(addr);
+    ok = ok && listener >= 0 && bind(listener, (struct sockaddr *)&addr, sizeof(addr)) == 0 &&
+         listen(listener, 4) == 0 && getsockname(listener, (struct sockaddr *)&addr, &addr_len) == 0;
+    uint16_t port = ntohs(addr.sin_port);
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    ok = ok && live_provision_probe_tcp("127.0.0.1", port, 1000) == ESP_OK;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if (listener >= 0) {
+        close(listener);
+    }
+    ok = ok && live_provision_probe_tcp("127.0.0.1", port, 1000) == ESP_FAIL;
+    ok = ok && live_provision_probe_tcp("", port, 1000) == ESP_ERR_INVALID_ARG;
+
+    snprintf(s_prov_note, sizeof(s_prov_note), "loopback probe %ld us",
+             (long)((t1.tv_sec - t0.tv_sec) * 1000000L + (t1.tv_nsec - t0.tv_nsec) / 1000));
+    return ok;
+}
+
+/* ==================== 基准项：按键输入 ==================== */
+
+typedef struct {
+    uint32_t t_ms;
+    bool pressed;
+} input_edge_t;
+
+static const button_input_timing_t s_input_timing = {
+    .debounce_ms = 50, .double_click_ms = 300, .long_press_ms = 3000, .repeat_ms = 500,
+};
+
+static void input_collect(const button_input_event_t *events, size_t n, char *out, size_t size, size_t *len)
+{
+    static const char codes[] = { 'c', 'd', 'L', 'r' };
+    for (size_t i = 0; i < n && *len + 1 < size; i++) {
+        out[(*len)++] = codes[events[i]];
+    }
+    out[*len] = '\0';
+}
+
+/**
+ * @brief 按输入任务的方式回放边沿时间线：先醒在到期的截止时间，再送入边沿
+ *
+ * 事件记为字母（c单击 d双击 L长按 r连发），返回启动窗口判定。
+ */
+static button_input_boot_state_t input_replay(bool double_click, bool pressed_at_init, uint32_t base,
+                                              const input_edge_t *edges, size_t count, uint32_t end_ms,
+                                              char *out, size_t size)
+{
+    button_input_fsm_t fsm;
+    button_input_boot_t boot;
+    button_input_event_t events[BUTTON_INPUT_MAX_EVENTS];
+    size_t len = 0;
+    out[0] = '\0';
+
+    button_input_fsm_init(&fsm, double_click, pressed_at_init, base);
+    button_input_boot_init(&boot, base, 3000, 300);
+
+    for (size_t i = 0; i <= count; i++) {
+        uint32_t until = base + (i < count ? edges[i].t_ms : end_ms);
+        for (;;) {
+            uint32_t d1 = button_input_fsm_deadline(&fsm, &s_input_timing);
+            uint32_t d2 = button_input_boot_deadline(&boot, &fsm);
+            int32_t w1 = d1 == BUTTON_INPUT_NO_DEADLINE ? INT32_MAX : (int32_t)(d1 - until);
+            int32_t w2 = d2 == BUTTON_INPUT_NO_DEADLINE ? INT32_MAX : (int32_t)(d2 - until);
+            uint32_t wake = w1 < w2 ? d1 : d2;
+            if ((w1 < w2 ? w1 : w2) > 0) {
+                break;
+            }
+            size_t n = button_input_fsm_update(&fsm, &s_input_timing, wake, events, BUTTON_INPUT_MAX_EVENTS);
+            input_collect(events, n, out, size, &len);
+            if (boot.state == BUTTON_INPUT_BOOT_PENDING &&
+                button_input_boot_update(&boot, &fsm, wake) == BUTTON_INPUT_BOOT_HELD) {
+                button_input_fsm_consume(&fsm);
+            }
+        }
+        if (i < count) {
+            size_t n = button_input_fsm_edge(&fsm, &s_input_timing, edges[i].pressed, until,
+                                             events, BUTTON_INPUT_MAX_EVENTS);
+            input_collect(events, n, out, size, &len);
+            if (boot.state == BUTTON_INPUT_BOOT_PENDING &&
+                button_input_boot_update(&boot, &fsm, until) == BUTTON_INPUT_BOOT_HELD) {
+                button_input_fsm_consume(&fsm);
+            }
+        }
+    }
+    return boot.state;
+}
+
+#define INPUT_REPLAY(dc, init, base, edges, end, out) \
+    input_replay(dc, init, base, edges, sizeof(edges) / sizeof(edges[0]), end, out, sizeof(out))
+
+// 带抖动的双击（按下/松开各抖3次）
+static const input_edge_t s_input_bouncy_double[] = {
+    { 4000, true }, { 4002, false }, { 4004, true }, { 4006, false }, { 4008, true },
+    { 4100, false }, { 4103, true }, { 4105, false },
+    { 4250, true }, { 4252, false }, { 4254, true },
+    { 4350, false }, { 4351, true }, { 4353, false },
+};
+
+static void bench_input_replay(void)
+{
+    char out[16];
+    INPUT_REPLAY(true, false, s_counter++, s_input_bouncy_double, 5000, out);
+}
+
+static bool check_input_replay(void)
+{
+    char out[32];
+    bool ok = true;
+
+    // 带抖动的单击：按下时间取最后一个边沿，抖动不产生额外事件
+    static const input_edge_t click[] = {
+        { 100, true }, { 103, false }, { 105, true }, { 250, false }, { 252, true }, { 254, false },
+    };
+    ok = ok && INPUT_REPLAY(false, false, 0, click, 4000, out) == BUTTON_INPUT_BOOT_RELEASED && strcmp(out, "c") == 0;
+
+    // 短于消抖时间的毛刺被忽略
+    static const input_edge_t glitch[] = { { 500, true }, { 510, false } };
+    ok = ok && INPUT_REPLAY(false, false, 0, glitch, 4000, out) == BUTTON_INPUT_BOOT_RELEASED && out[0] == '\0';
+
+    // 双击（含抖动，时间回绕附近也一样）；两次慢单击分别确认
+    ok = ok && INPUT_REPLAY(true, false, 0, s_input_bouncy_double, 5000, out) == BUTTON_INPUT_BOOT_RELEASED &&
+         strcmp(out, "d") == 0;
+    ok = ok && INPUT_REPLAY(true, false, UINT32_MAX - 4100, s_input_bouncy_double, 5000, out) ==
+               BUTTON_INPUT_BOOT_RELEASED && strcmp(out, "d") == 0;
+    static const input_edge_t slow[] = { { 4000, true }, { 4100, false }, { 4600, true }, { 4700, false } };
+    ok = ok && INPUT_REPLAY(true, false, 0, slow, 6000, out) == BUTTON_INPUT_BOOT_RELEASED && strcmp(out, "cc") == 0;
+    // 未开启双击时不等待，两次都是单击
+    ok = ok && INPUT_REPLAY(false, false, 0, s_input_bouncy_double, 5000, out) == BUTTON_INPUT_BOOT_RELEASED &&
+         strcmp(out, "cc") == 0;
+
+    // 长按 + 连发，松开后没有单击；单击后又按住：先确认单击再长按
+    static const input_edge_t hold[] = { { 4000, true }, { 8200, false } };
+    ok = ok && INPUT_REPLAY(false, false, 0, hold, 9000, out) == BUTTON_INPUT_BOOT_RELEASED && strcmp(out, "Lrr") == 0;
+    static const input_edge_t click_hold[] = { { 4000, true }, { 4100, false }, { 4200, true }, { 7300, false } };
+    ok = ok && INPUT_REPLAY(true, false, 0, click_hold, 8000, out) == BUTTON_INPUT_BOOT_RELEASED && strcmp(out, "cL") == 0;
+
+    // 启动窗口：窗口内按住300ms判定按住，这次按下不再报单击/长按
+    static const input_edge_t boot_hold[] = { { 1000, true }, { 4500, false } };
+    ok = ok && INPUT_REPLAY(false, false, 0, boot_hold, 6000, out) == BUTTON_INPUT_BOOT_HELD && out[0] == '\0';
+    // 上电时已按下：按够时长判定按住；很快松开则不算，也不报单击
+    static const input_edge_t init_hold[] = { { 2000, false } };
+    ok = ok && INPUT_REPLAY(false, true, 0, init_hold, 4000, out) == BUTTON_INPUT_BOOT_HELD && out[0] == '\0';
+    static const input_edge_t init_tap[] = { { 100, false } };
+    ok = ok && INPUT_REPLAY(false, true, 0, init_tap, 4000, out) == BUTTON_INPUT_BOOT_RELEASED && out[0] == '\0';
+    // 窗口末尾开始的按下跨过窗口仍算；窗口之后开始的按下是普通单击
+    static const input_edge_t late[] = { { 2900, true }, { 3400, false } };
+    ok = ok && INPUT_REPLAY(false, false, 0, late, 4000, out) == BUTTON_INPUT_BOOT_HELD && out[0] == '\0';
+    static const input_edge_t after[] = { { 3100, true }, { 3200, false } };
+    ok = ok && INPUT_REPLAY(false, false, 0, after, 4000, out) == BUTTON_INPUT_BOOT_RELEASED && strcmp(out, "c") == 0;
+    return ok;
+}
+
+/* ==================== 基准项：舵机轨迹 ==================== */
+
+#define SERVO_V_MAX     360.0f
+#define SERVO_A_MAX     1800.0f
+
+static char s_servo_note[48];
+
+/**
+ * @brief 梯形速度曲线解析式：加速度a的匀加速 ta 秒、匀速、对称减速
+ */
+static float trapezoid_reference(float d, float t_total, float ta, float t)
+{
+    float v = SERVO_A_MAX * ta;
+    if (t < ta) {
+        return 0.5f * SERVO_A_MAX * t * t;
+    }
+    if (t <= t_total - ta) {
+        return 0.5f * SERVO_A_MAX * ta * ta + v * (t - ta);
+    }
+    float r = t_total - t;
+    return d - 0.5f * SERVO_A_MAX * r * r;
+}
+
+/**
+ * @brief 在20ms舵机帧上逐点比较规划器和解析式
+ */
+static bool trapezoid_matches(float d, uint32_t duration_ms, uint32_t expect_ms)
+{
+    servo_segment_t seg;
+    servo_motion_plan(&seg, 0.0f, d, 1000, duration_ms, SERVO_PROFILE_TRAPEZOID, SERVO_V_MAX, SERVO_A_MAX);
+    if (seg.duration_ms != expect_ms) {
+        return false;
+    }
+    float t_total = expect_ms / 1000.0f;
+    float ta = (t_total - sqrtf(t_total * t_total - 4.0f * d / SERVO_A_MAX)) / 2.0f;
+    for (uint32_t t = 0; t <= expect_ms; t += CONFIG_SERVO_MOTION_TICK_MS) {
+        float ref = trapezoid_reference(d, t_total, ta, t / 1000.0f);
+        if (fabsf(servo_motion_sample(&seg, 1000 + t) - ref) > 0.05f) {
+            return false;
+        }
+    }
+    // 终点精确，速度/加速度不超过上限（1ms差分）
+    if (servo_motion_sample(&seg, 1000 + expect_ms) != d) {
+        return false;
+    }
+    float prev_v = 0.0f;
+    for (uint32_t t = 1; t <= expect_ms; t++) {
+        float v = (servo_motion_sample(&seg, 1000 + t) - servo_motion_sample(&seg, 1000 + t - 1)) * 1000.0f;
+        if (v > SERVO_V_MAX * 1.01f || fabsf(v - prev_v) * 1000.0f > SERVO_A_MAX * 1.05f) {
+            return false;
+        }
+        prev_v = v;
+    }
+    return true;
+}
+
+static bool scurve_matches(float d, uint32_t duration_ms, uint32_t expect_ms)
+{
+    servo_segment_t seg;
+    servo_motion_plan(&seg, 30.0f, 30.0f + d, 0, duration_ms, SERVO_PROFILE_SCURVE, SERVO_V_MAX, SERVO_A_MAX);
+    if (seg.duration_ms != expect_ms) {
+        return false;
+    }
+    float t_total = expect_ms / 1000.0f;
+    float peak_v = 0.0f;
+    float peak_a = 0.0f;
+    for (uint32_t t = 0; t <= expect_ms; t += CONFIG_SERVO_MOTION_TICK_MS) {
+        // 最小加加速度曲线：p = D(10τ³ - 15τ⁴ + 6τ⁵)，v = 30D τ²(1-τ)²/T，a = 60D τ(1-τ)(1-2τ)/T²
+        double tau = t / 1000.0 / t_total;
+        double ref = 30.0 + d * (10 * pow(tau, 3) - 15 * pow(tau, 4) + 6 * pow(tau, 5));
+        double v = 30.0 * d * tau * tau * (1 - tau) * (1 - tau) / t_total;
+        double a = fabs(60.0 * d * tau * (1 - tau) * (1 - 2 * tau) / (t_total * t_total));
+        if (fabs(servo_motion_sample(&seg, t) - ref) > 0.05) {
+            return false;
+        }
+        peak_v = v > peak_v ? (float)v : peak_v;
+        peak_a = a > peak_a ? (float)a : peak_a;
+    }
+    // 起止速度为0（第一帧和最后一帧位移远小于匀速时的一帧），峰值不超过上限
+    float step = d * CONFIG_SERVO_MOTION_TICK_MS / (float)expect_ms;
+    return servo_motion_sample(&seg, CONFIG_SERVO_MOTION_TICK_MS) - 30.0f < step * 0.1f &&
+           30.0f + d - servo_motion_sample(&seg, expect_ms - CONFIG_SERVO_MOTION_TICK_MS) < step * 0.1f &&
+           servo_motion_sample(&seg, expect_ms) == 30.0f + d &&
+           peak_v <= SERVO_V_MAX * 1.01f && peak_a <= SERVO_A_MAX * 1.01f;
+}
+
+/**
+ * @brief 同步运动：舵机2要等舵机1走完前一段，两者同时出发、同时到达，时长取较慢者
+ */
+static bool sync_arrival_matches(void)
+{
+    static const float initial[2] = { 90.0f, 90.0f };
+    servo_planner_t planner;
+    servo_planner_init(&planner, 2, initial, SERVO_V_MAX, SERVO_A_MAX);
+
+    const servo_waypoint_t first = { .angle = 0.0f, .duration_ms = 600, .dwell_ms = 100 };
+    static const float targets[2] = { 180.0f, 45.0f };
+    if (servo_planner_push(&planner, 0, &first, 0) != ESP_OK ||
+        servo_planner_push_sync(&planner, 0x3, targets, 200, SERVO_PROFILE_SCURVE, 0) != ESP_OK) {
+        return false;
+    }
+
+    // 舵机1：600ms到0°，停留100ms，700ms起180°；S曲线180°最短 max(1.875·180/360, √(5.7735·180/1800)) = 938ms
+    uint32_t expect_t0 = 700;
+    uint32_t expect_end = expect_t0 + servo_motion_min_duration_ms(180.0f, SERVO_PROFILE_SCURVE, SERVO_V_MAX, SERVO_A_MAX);
+    uint32_t arrived[2] = { 0, 0 };
+    for (uint32_t now = 0; now <= 2000; now += CONFIG_SERVO_MOTION_TICK_MS) {
+        bool busy = servo_planner_tick(&planner, now);
+        if (now <= expect_t0 && planner.axis[1].position != 90.0f) {
+            return false;
+        }
+        for (int i = 0; i < 2; i++) {
+            if (!arrived[i] && planner.axis[i].position == targets[i]) {
+                arrived[i] = now;
+            }
+        }
+        if (!busy) {
+            break;
+        }
+    }
+    uint32_t frame_end = (expect_end + CONFIG_SERVO_MOTION_TICK_MS - 1) / CONFIG_SERVO_MOTION_TICK_MS *
+                         CONFIG_SERVO_MOTION_TICK_MS;
+    return planner.axis[0].seg.t0_ms == expect_t0 && planner.axis[1].seg.t0_ms == expect_t0 &&
+           planner.axis[1].seg.duration_ms == planner.axis[0].seg.duration_ms &&
+           arrived[0] == frame_end && arrived[1] == frame_end && servo_planner_idle(&planner, 1);
+}
+
+static uint32_t servo_duty_for(float angle)
+{
+    uint32_t pulse = SERVO1_MIN_PULSE_US +
+                     ((uint32_t)(angle * 100.0f + 0.5f) * (SERVO1_MAX_PULSE_US - SERVO1_MIN_PULSE_US) + 9000) / 18000;
+    return (pulse * 8191 + 10000) / 20000;
+}
+
+/**
+ * @brief 端到端：servo_path命令立即返回，esp_timer在虚拟时间里按轨迹更新LEDC占空比
+ */
+static bool servo_path_drives_ledc(void)
+{
+    device_control_command_t cmd;
+    device_control_result_t result;
+    static const char *reset_cmd = "{\"cmd\":\"servo\",\"device_id\":1,\"angle\":90}";
+    static const char *path_cmd =
+        "{\"cmd\":\"servo_path\",\"device_id\":1,\"profile\":\"scurve\","
+        "\"waypoints\":[{\"angle\":0,\"duration_ms\":1000},{\"angle\":180,\"dwell_ms\":100}]}";
+    if (device_control_parse_json_command(reset_cmd, &cmd) != ESP_OK ||
+        device_control_execute(&cmd, &result) != ESP_OK ||
+        device_control_parse_json_command(path_cmd, &cmd) != ESP_OK ||
+        cmd.cmd_type != DEVICE_CONTROL_CMD_SERVO_PATH || cmd.value.motion.count != 2) {
+        return false;
+    }
+
+    int64_t start = host_sim_now_us();
+    if (device_control_execute(&cmd, &result) != ESP_OK || host_sim_now_us() != start) {
+        return false;
+    }
+
+    // 半程：90° -> 0° 的S曲线中点为45°，允许1ms定时误差（约0.15°）
+    host_sim_advance_us(500 * 1000);
+    int32_t mid = (int32_t)host_sim_ledc_duty(0) - (int32_t)servo_duty_for(45.0f);
+    // 第一段结束时精确到达0°
+    host_sim_advance_us(500 * 1000);
+    uint32_t at_zero = host_sim_ledc_duty(0);
+    if (mid < -1 || mid > 1 || at_zero != servo_duty_for(0.0f) || servo_motion_is_idle(0)) {
+        return false;
+    }
+
+    // 第二段按速度/加速度上限最快到达180°，之后定时器停止
+    if (servo_motion_wait_idle(0, 3000) != ESP_OK || host_sim_ledc_duty(0) != servo_duty_for(180.0f)) {
+        return false;
+    }
+    int64_t total_ms = (host_sim_now_us() - start) / 1000;
+    snprintf(s_servo_note, sizeof(s_servo_note), "path 90>0>180 in %ld ms virtual", (long)total_ms);
+    return total_ms >= 1000 + 938 + 100;
+}
+
+static void bench_servo_trajectory(void)
+{
+    // 两舵机同步运动一整段，按20ms舵机帧推进（一次操作 = 整段轨迹）
+    static const float initial[2] = { 90.0f, 90.0f };
+    static const float targets[2] = { 0.0f, 180.0f };
+    servo_planner_t planner;
+    servo_planner_init(&planner, 2, initial, SERVO_V_MAX, SERVO_A_MAX);
+    servo_planner_push_sync(&planner, 0x3, targets, 0, (servo_profile_t)(s_counter++ % 3), 0);
+    for (uint32_t now = 0; servo_planner_tick(&planner, now); now += CONFIG_SERVO_MOTION_TICK_MS) {
+    }
+}
+
+static bool check_servo_trajectory(void)
+{
+    // 梯形：90°在最短时长内达到最大速度（0.2s加速 + 0.05s匀速 + 0.2s减速）；
+    // 30°达不到最大速度（三角形）；时长放宽时保持最大加速度、缩短加速段
+    return trapezoid_matches(90.0f, 0, 450) && trapezoid_matches(30.0f, 0, 259) &&
+           trapezoid_matches(90.0f, 1000, 1000) &&
+           scurve_matches(100.0f, 0, 567) && scurve_matches(60.0f, 1500, 1500) &&
+           sync_arrival_matches() && servo_path_drives_ledc();
+}
+
+/* ==================== 基准项：灯光效果 ==================== */
+
+#define FX_MAX_DUTY     8191        // pwm_control的13位分辨率
+
+static char s_fx_note[64];
+
+/**
+ * @brief 按段重建硬件渐变输出的占空比曲线（每毫秒一个点），返回段数
+ */
+static int fx_render(const led_effect_t *effect, uint32_t *curve, uint32_t max_ms, uint32_t *total_ms, int *holds)
+{
+    led_effect_state_t st;
+    led_fade_segment_t seg;
+    led_effect_begin(&st, effect, FX_MAX_DUTY);
+    uint32_t t = 0;
+    uint32_t duty = st.duty;
+    int fades = 0;
+    *holds = 0;
+    curve[0] = duty;
+    while (led_effect_next(&st, &seg)) {
+        if (seg.duty == duty) {
+            (*holds)++;
+        } else {
+            fades++;
+        }
+        for (uint32_t i = 1; i <= seg.time_ms && t + i <= max_ms; i++) {
+            curve[t + i] = duty + (int32_t)(seg.duty - duty) * (int32_t)i / (int32_t)seg.time_ms;
+        }
+        t += seg.time_ms;
+        duty = seg.duty;
+        if (t <= max_ms) {
+            curve[t] = duty;
+        }
+    }
+    *total_ms = t;
+    return fades;
+}
+
+static double fx_gamma_ref(double x)
+{
+    return FX_MAX_DUTY * pow(x, 2.2);
+}
+
+/**
+ * @brief 与 (t/T)^2.2 的允许偏差：查找表分段线性插值0.13%满量程，加上段末时刻取整到1ms
+ *        造成的错位（曲线最陡处每毫秒 2.2·满量程/T）
+ */
+static double fx_tolerance(uint32_t duration_ms)
+{
+    return FX_MAX_DUTY * 0.0015 + 2.2 * FX_MAX_DUTY / duration_ms;
+}
+
+/**
+ * @brief 0 -> 100% gamma渐变：硬件直线段连起来贴合 (t/T)^2.2，每个查表点一段，单调，终点精确
+ */
+static bool gamma_fade_matches(uint16_t duration_ms)
+{
+    static uint32_t curve[2001];
+    const led_effect_t fx = { .type = LED_EFFECT_FADE, .from = 0, .to = 1000, .rise_ms = duration_ms, .gamma = true };
+    uint32_t total = 0;
+    int holds = 0;
+    int fades = fx_render(&fx, curve, 2000, &total, &holds);
+    if (total != duration_ms || fades > LED_EFFECTS_GAMMA_KNOTS || holds != 0 || curve[total] != FX_MAX_DUTY) {
+        return false;
+    }
+    for (uint32_t t = 1; t <= total; t++) {
+        if (curve[t] < curve[t - 1] || fabs(curve[t] - fx_gamma_ref((double)t / total)) > fx_tolerance(total)) {
+            return false;
+        }
+    }
+    // 关闭gamma时占空比线性变化，一段完成
+    const led_effect_t linear = { .type = LED_EFFECT_FADE, .from = 200, .to = 700, .rise_ms = 1000 };
+    return fx_render(&linear, curve, 2000, &total, &holds) == 1 && total == 1000 &&
+           curve[500] == (1638 + 5734) / 2 && curve[1000] == 5734;
+}
+
+/**
+ * @brief 呼吸两次：总时长 = 2×(渐亮+保持+渐暗) + 一次低位保持（最后一次不保持），停在起点
+ */
+static bool breathe_plan_matches(void)
+{
+    static uint32_t curve[8001];
+    const led_effect_t fx = {
+        .type = LED_EFFECT_BREATHE, .from = 100, .to = 800,
+        .rise_ms = 1500, .fall_ms = 1500, .hold_high_ms = 500, .hold_low_ms = 500,
+        .cycles = 2, .gamma = true,
+    };
+    uint32_t total = 0;
+    int holds = 0;
+    int fades = fx_render(&fx, curve, 8000, &total, &holds);
+    if (total != 2 * (1500 + 500 + 1500) + 500 || holds != 3 || fades < 4 || fades > 4 * LED_EFFECTS_GAMMA_KNOTS) {
+        return false;
+    }
+    // 峰值保持在to，结束在from
+    if (curve[1500] != 6553 || curve[2000] != 6553 || curve[total] != 819) {
+        return false;
+    }
+    // 无限循环但周期为0的效果没有任何段
+    led_effect_state_t st;
+    led_fade_segment_t seg;
+    const led_effect_t empty = { .type = LED_EFFECT_BREATHE, .from = 500, .to = 500 };
+    led_effect_begin(&st, &empty, FX_MAX_DUTY);
+    return !led_effect_next(&st, &seg);
+}
+
+/**
+ * @brief 端到端：breathe预设立即返回，硬件渐变在虚拟时间里走完gamma曲线；
+ *        pwm_control_set 打断效果；四路输出同时运行、各自按时到达
+ */
+static bool breathe_preset_drives_ledc(void)
+{
+    // pwm_control与舵机共用LEDC定时器0/1，放在舵机项之后初始化
+    if (pwm_control_init() != ESP_OK) {
+        return false;
+    }
+
+    preset_control_command_t cmd = {
+        .device_type = PRESET_DEVICE_TYPE_PWM,
+        .preset_type = "breathe",
+        .device_id = 2,
+        .parameters = cJSON_Parse("{\"frequency\":1000,\"fade_in_time\":1000,\"fade_out_time\":1000,"
+                                  "\"hold_time\":200,\"cycles\":1}"),
+    };
+    preset_control_result_t result;
+    led_effects_stats_t before;
+    led_effects_get_stats(1, &before);
+    uint32_t hw_before = host_sim_ledc_fade_count(2);
+    int64_t start = host_sim_now_us();
+    esp_err_t ret = preset_control_execute(&cmd, &result);
+    cJSON_Delete(cmd.parameters);
+    if (ret != ESP_OK || host_sim_now_us() != start || !led_effects_is_running(1)) {
+        return false;
+    }
+
+    // 渐亮段逐10ms与 (t/T)^2.2 比较
+    for (int t = 10; t <= 1000; t += 10) {
+        host_sim_advance_us(10 * 1000);
+        if (fabs(host_sim_ledc_duty(2) - fx_gamma_ref(t / 1000.0)) > fx_tolerance(1000)) {
+            return false;
+        }
+    }
+    if (led_effects_wait_idle(1, 3000) != ESP_OK || host_sim_ledc_duty(2) != 0) {
+        return false;
+    }
+    int64_t total_ms = (host_sim_now_us() - start) / 1000;
+    led_effects_stats_t after;
+    led_effects_get_stats(1, &after);
+    uint32_t fades = after.fades - before.fades;
+    if (total_ms < 2200 || total_ms > 2200 + 10 || fades != host_sim_ledc_fade_count(2) - hw_before ||
+        fades > 2 * LED_EFFECTS_GAMMA_KNOTS || after.holds - before.holds != 1) {
+        return false;
+    }
+    // 原实现：渐亮/渐暗各 1000/50+1 次 pwm_control_set
+    snprintf(s_fx_note, sizeof(s_fx_note), "breathe 2200 ms: %u hw fades vs 42 sets", (unsigned)fades);
+
+    // 运行中直接设置占空比会停止效果
+    const led_effect_t fade = { .type = LED_EFFECT_FADE, .from = 0, .to = 1000, .rise_ms = 1000 };
+    if (pwm_control_effect(2, 1000, &fade) != ESP_OK) {
+        return false;
+    }
+    host_sim_advance_us(300 * 1000);
+    pwm_control_set(2, 1000, 50.0f);
+    host_sim_advance_us(1000 * 1000);
+    if (led_effects_is_running(1) || host_sim_ledc_duty(2) != 4096) {      // 8191 * 50% 四舍五入
+        return false;
+    }
+
+    // 四路同时：M1/M2 + 另外两个LEDC通道，各自时长不同，互不影响
+    const ledc_timer_config_t timer = {
+        .speed_mode = LEDC_LOW_SPEED_MODE, .timer_num = LEDC_TIMER_3,
+        .duty_resolution = LEDC_TIMER_13_BIT, .freq_hz = 1000,
+    };
+    ledc_timer_config(&timer);
+    for (int i = 0; i < 2; i++) {
+        const ledc_channel_config_t ch = {
+            .gpio_num = 4 + i, .speed_mode = LEDC_LOW_SPEED_MODE,
+            .channel = (ledc_channel_t)(LEDC_CHANNEL_4 + i), .timer_sel = LEDC_TIMER_3,
+        };
+        if (ledc_channel_config(&ch) != ESP_OK ||
+            led_effects_attach(2 + i, LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_4 + i, 13) != ESP_OK) {
+            return false;
+        }
+    }
+    static const int channels[4] = { 0, 2, 4, 5 };
+    for (int i = 0; i < 4; i++) {
+        const led_effect_t fx = { .type = LED_EFFECT_FADE, .from = 0, .to = 1000,
+                                  .rise_ms = (uint16_t)(400 * (i + 1)), .gamma = true };
+        if (led_effects_start(i, &fx) != ESP_OK) {
+            return false;
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        // 第i路在 400(i+1) ms 到达满量程，后面几路仍在渐变
+        host_sim_advance_us(400 * 1000);
+        for (int j = 0; j < 4; j++) {
+            bool done = j <= i;
+            if (led_effects_is_running(j) == done || (done && host_sim_ledc_duty(channels[j]) != FX_MAX_DUTY) ||
+                (!done && host_sim_ledc_duty(channels[j]) >= FX_MAX_DUTY)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void bench_fx_plan(void)
+{
+    // 编排一次gamma呼吸（一次操作 = 取完全部段）
+    static const led_effect_t fx = {
+        .type = LED_EFFECT_BREATHE, .from = 0, .to = 1000,
+        .rise_ms = 1500, .fall_ms = 1500, .hold_high_ms = 500, .cycles = 1, .gamma = true,
+    };
+    led_effect_state_t st;
+    led_fade_segment_t seg;
+    led_effect_begin(&st, &fx, FX_MAX_DUTY - (s_counter++ & 1));
+    while (led_effect_next(&st, &seg)) {
+    }
+}
+
+static bool check_fx_plan(void)
+{
+    return gamma_fade_matches(2000) && gamma_fade_matches(300) && breathe_plan_matches() &&
+           breathe_preset_drives_ledc();
+}
+
+/* ==================== 基准项：PWM输出 ==================== */
+
+static pwm_servo_table_t s_duty_table;
+static char s_duty_note[96];
+static volatile uint32_t s_duty_sink;
+
+// 原实现每次从 s_servo_configs 读参数，除数不是编译期常量
+static volatile uint32_t s_legacy_min_us = SERVO1_MIN_PULSE_US;
+static volatile uint32_t s_legacy_max_us = SERVO1_MAX_PULSE_US;
+static volatile uint32_t s_legacy_max_angle = SERVO1_MAX_ANGLE;
+static volatile uint32_t s_legacy_freq = SERVO1_FREQUENCY;
+
+/**
+ * @brief 原实现：先按0.01度算脉宽（微秒），再按周期换算占空比，三次除法
+ */
+static uint32_t legacy_servo_duty(uint32_t centideg)
+{
+    uint32_t min_us = s_legacy_min_us;
+    uint32_t max_centideg = s_legacy_max_angle * 100;
+    uint32_t pulse = min_us + (centideg * (s_legacy_max_us - min_us) + max_centideg / 2) / max_centideg;
+    uint32_t period_us = 1000000 / s_legacy_freq;
+    return (pulse * 8191 + period_us / 2) / period_us;
+}
+
+/**
+ * @brief 原实现：pwm_control 的双精度换算（截断）
+ */
+static uint32_t legacy_pwm_duty(float duty_cycle)
+{
+    return (uint32_t)((duty_cycle / 100.0) * 8191);
+}
+
+static void bench_duty_update(void)
+{
+    // 一次操作 = 两路舵机查表 + 两路电机万分比换算
+    uint32_t c = (s_counter++ * 37) % 18001;
+    s_duty_sink = pwm_servo_table_duty(&s_duty_table, c) + pwm_servo_table_duty(&s_duty_table, 18000 - c) +
+                  pwm_output_duty_permyriad(c % 10001, 13) + pwm_output_duty_permyriad(10000 - c % 10001, 13);
+}
+
+/**
+ * @brief 每次更新（4路）的耗时：x86上按TSC计周期，其他平台按ns
+ */
+static double duty_update_cost(bool legacy)
+{
+    enum { N = 200000 };
+    uint32_t sink = 0;
+#if defined(__x86_64__)
+    uint64_t t0 = __rdtsc();
+#else
+    double t0 = wall_ns();
+#endif
+    for (uint32_t i = 0; i < N; i++) {
+        uint32_t c = (i * 37) % 18001;
+        if (legacy) {
+            sink += legacy_servo_duty(c) + legacy_servo_duty(18000 - c) +
+                    legacy_pwm_duty((c % 10001) / 100.0f) + legacy_pwm_duty((10000 - c % 10001) / 100.0f);
+        } else {
+            sink += pwm_servo_table_duty(&s_duty_table, c) + pwm_servo_table_duty(&s_duty_table, 18000 - c) +
+                    pwm_output_duty_permyriad(c % 10001, 13) + pwm_output_duty_permyriad(10000 - c % 10001, 13);
+        }
+    }
+    s_duty_sink = sink;
+#if defined(__x86_64__)
+    return (double)(__rdtsc() - t0) / N;
+#else
+    return (wall_ns() - t0) / N;
+#endif
+}
+
+/**
+ * @brief 查找表与双精度参考（脉宽不取整）比较：全程±1 LSB，端点精确
+ */
+static bool duty_table_matches(void)
+{
+    pwm_servo_table_t bad;
+    if (pwm_servo_table_init(&bad, 500, 2500, 180, 50, 14) != ESP_ERR_INVALID_ARG ||
+        pwm_servo_table_init(&bad, 500, 2500, 0, 50, 13) != ESP_ERR_INVALID_ARG ||
+        pwm_servo_table_init(&bad, 500, 2500, CONFIG_PWM_OUTPUT_SERVO_MAX_ANGLE + 1, 50, 13) != ESP_ERR_INVALID_ARG ||
+        pwm_servo_table_init(&s_duty_table, SERVO1_MIN_PULSE_US, SERVO1_MAX_PULSE_US, SERVO1_MAX_ANGLE,
+                             SERVO1_FREQUENCY, 13) != ESP_OK) {
+        return false;
+    }
+    for (uint32_t c = 0; c <= 18000; c++) {
+        double pulse = SERVO1_MIN_PULSE_US + (SERVO1_MAX_PULSE_US - SERVO1_MIN_PULSE_US) * (c / 18000.0);
+        long ref = lround(pulse * 8191 / 20000);
+        long diff = (long)pwm_servo_table_duty(&s_duty_table, c) - ref;
+        if (diff < -1 || diff > 1 || ((c == 0 || c == 18000) && diff != 0)) {
+            return false;
+        }
+    }
+    if (pwm_servo_table_duty(&s_duty_table, 18050) != pwm_servo_table_duty(&s_duty_table, 18000)) {
+        return false;
+    }
+    for (uint32_t p = 0; p <= PWM_OUTPUT_PERMYRIAD_MAX; p++) {
+        if (pwm_output_duty_permyriad(p, 13) != (uint32_t)lround(p * 8191.0 / 10000)) {
+            return false;
+        }
+    }
+    return pwm_output_duty_permyriad(20000, 13) == 8191 && pwm_output_percent_to_permyriad(37.5f) == 3750;
+}
+
+/**
+ * @brief 帧：提交前寄存器不变，提交后所有通道一起生效；序列预设的零间隔动作同帧锁存
+ */
+static bool frame_latches_together(void)
+{
+    pwm_output_stats_t before, after;
+    if (pwm_output_get_stats(&before) != ESP_OK) {
+        return false;
+    }
+    uint32_t d0 = host_sim_ledc_duty(0);
+    uint32_t d1 = host_sim_ledc_duty(1);
+    uint32_t t0 = d0 == 300 ? 400 : 300;
+    uint32_t t1 = d1 == 900 ? 1000 : 900;
+
+    if (pwm_output_frame_begin() != ESP_OK || pwm_output_frame_begin() != ESP_OK) {
+        return false;
+    }
+    pwm_output_write(LEDC_LOW_SPEED_MODE, 0, 1);            // 同一通道多次写入只保留最后一次
+    pwm_output_write(LEDC_LOW_SPEED_MODE, 0, t0);
+    pwm_output_write(LEDC_LOW_SPEED_MODE, 1, t1);
+    if (pwm_output_frame_commit() != ESP_OK ||               // 内层提交不锁存
+        host_sim_ledc_duty(0) != d0 || host_sim_ledc_duty(1) != d1) {
+        return false;
+    }
+    if (pwm_output_frame_commit() != ESP_OK || host_sim_ledc_duty(0) != t0 || host_sim_ledc_duty(1) != t1 ||
+        pwm_output_frame_commit() != ESP_ERR_INVALID_STATE) {
+        return false;
+    }
+    pwm_output_get_stats(&after);
+    if (after.commits != before.commits + 1 || after.staged != before.staged + 3 || after.max_frame_channels < 2) {
+        return false;
+    }
+
+    // 序列预设：两个舵机动作间隔为0，同一帧提交
+    preset_control_command_t cmd = {
+        .device_type = PRESET_DEVICE_TYPE_SERVO,
+        .preset_type = "sequence",
+        .parameters = cJSON_Parse("{\"actions\":["
+                                  "{\"cmd\":\"servo\",\"device_id\":1,\"angle\":30,\"delay_ms\":0},"
+                                  "{\"cmd\":\"servo\",\"device_id\":2,\"angle\":150,\"delay_ms\":20}]}"),
+    };
+    preset_control_result_t result;
+    pwm_output_get_stats(&before);
+    esp_err_t ret = preset_control_execute(&cmd, &result);
+    cJSON_Delete(cmd.parameters);
+    pwm_output_get_stats(&after);
+    return ret == ESP_OK && after.commits == before.commits + 1 && after.staged == before.staged + 2 &&
+           after.writes == before.writes && host_sim_ledc_duty(0) == pwm_servo_table_duty(&s_duty_table, 3000) &&
+           host_sim_ledc_duty(1) == pwm_servo_table_duty(&s_duty_table, 15000);
+}
+
+static bool check_duty_update(void)
+{
+    if (!duty_table_matches() || !frame_latches_together()) {
+        return false;
+    }
+    double fixed = duty_update_cost(false);
+    double legacy = duty_update_cost(true);
+#if defined(__x86_64__)
+    snprintf(s_duty_note, sizeof(s_duty_note), "4 ch: %.1f cyc/update vs %.1f float/div", fixed, legacy);
+#else
+    snprintf(s_duty_note, sizeof(s_duty_note), "4 ch: %.1f ns/update vs %.1f float/div", fixed, legacy);
+#endif
+    return true;
+}
+
+/* ==================== 基准项：I2C总线 ==================== */
+
+#define I2C_ADDR_MPU6050    0x68
+#define I2C_ADDR_BMP280     0x76
+#define I2C_ADDR_OLED       0x3C
+
+static i2c_bus_handle_t s_i2c_bus;
+static i2c_bus_device_handle_t s_i2c_mpu;
+static i2c_bus_device_handle_t s_i2c_bmp;
+static i2c_bus_device_handle_t s_i2c_oled;
+static uint8_t s_i2c_accel[6];
+static uint8_t s_i2c_temp[2];
+static uint8_t s_i2c_gyro[6];
+static uint8_t s_i2c_press[6];
+static uint8_t s_i2c_page[129];            // SSD1306一页：数据控制字节 + 128列
+static char s_i2c_order[8];
+static uint8_t s_i2c_done;
+static int64_t s_i2c_sensor_done_us;        // 最后一个传感器请求完成的时刻
+static char s_i2c_note[80];
+
+static void i2c_bench_done(esp_err_t err, void *arg)
+{
+    char tag = *(const char *)arg;
+    if (s_i2c_done < sizeof(s_i2c_order) - 1) {
+        s_i2c_order[s_i2c_done] = err == ESP_OK ? tag : 'x';
+    }
+    if (tag != 'D') {
+        s_i2c_sensor_done_us = host_sim_now_us();
+    }
+    s_i2c_done++;
+}
+
+// 手动执行队列的总线，调度顺序和虚拟时间都可复现
+static bool i2c_bench_setup(void)
+{
+    if (s_i2c_bus) {
+        return true;
+    }
+    const i2c_bus_config_t bus_config = {
+        .port = -1, .sda = I2C_SDA_PIN, .scl = I2C_SCL_PIN, .manual_service = true,
+    };
+    const i2c_bus_device_config_t mpu = { .addr = I2C_ADDR_MPU6050, .scl_hz = 400000, .name = "MPU6050", .burst_read = true };
+    const i2c_bus_device_config_t bmp = { .addr = I2C_ADDR_BMP280, .scl_hz = 400000, .name = "BMP280", .burst_read = true };
+    const i2c_bus_device_config_t oled = { .addr = I2C_ADDR_OLED, .scl_hz = 400000, .name = "SSD1306" };
+    if (i2c_bus_open(&bus_config, &s_i2c_bus) != ESP_OK ||
+        i2c_bus_add_device(s_i2c_bus, &mpu, &s_i2c_mpu) != ESP_OK ||
+        i2c_bus_add_device(s_i2c_bus, &bmp, &s_i2c_bmp) != ESP_OK ||
+        i2c_bus_add_device(s_i2c_bus, &oled, &s_i2c_oled) != ESP_OK) {
+        return false;
+    }
+    host_i2c_attach(0, I2C_ADDR_MPU6050);
+    host_i2c_attach(0, I2C_ADDR_BMP280);
+    host_i2c_attach(0, I2C_ADDR_OLED);
+
+    uint8_t regs[32];
+    for (int i = 0; i < 32; i++) {
+        regs[i] = (uint8_t)(0xA0 + i);
+    }
+    host_i2c_set_regs(0, I2C_ADDR_MPU6050, 0x3B, regs, 14);    // ACCEL_XOUT_H .. GYRO_ZOUT_L
+    host_i2c_set_regs(0, I2C_ADDR_BMP280, 0xF7, regs + 16, 6); // press_msb .. temp_xlsb
+    s_i2c_page[0] = 0x40;
+    for (int i = 1; i < (int)sizeof(s_i2c_page); i++) {
+        s_i2c_page[i] = (uint8_t)i;
+    }
+    return true;
+}
+
+// 一轮：显示刷新先提交，随后MPU6050三组寄存器和BMP280测量值
+static void i2c_bench_submit_round(void)
+{
+    static const char tag_oled = 'D', tag_accel = 'A', tag_temp = 'T', tag_gyro = 'G', tag_press = 'P';
+    const i2c_bus_txn_t page = { .type = I2C_BUS_TXN_WRITE, .wbuf = s_i2c_page, .wlen = sizeof(s_i2c_page) };
+    const i2c_bus_txn_t accel = { .type = I2C_BUS_TXN_READ_REG, .reg = 0x3B, .rbuf = s_i2c_accel, .rlen = 6 };
+    const i2c_bus_txn_t temp = { .type = I2C_BUS_TXN_READ_REG, .reg = 0x41, .rbuf = s_i2c_temp, .rlen = 2 };
+    const i2c_bus_txn_t gyro = { .type = I2C_BUS_TXN_READ_REG, .reg = 0x43, .rbuf = s_i2c_gyro, .rlen = 6 };
+    const i2c_bus_txn_t press = { .type = I2C_BUS_TXN_READ_REG, .reg = 0xF7, .rbuf = s_i2c_press, .rlen = 6 };
+
+    s_i2c_done = 0;
+    memset(s_i2c_order, 0, sizeof(s_i2c_order));
+    i2c_bus_submit(s_i2c_oled, &page, I2C_BUS_PRIO_DISPLAY, i2c_bench_done, (void *)&tag_oled);
+    i2c_bus_submit(s_i2c_mpu, &accel, I2C_BUS_PRIO_SENSOR, i2c_bench_done, (void *)&tag_accel);
+    i2c_bus_submit(s_i2c_mpu, &temp, I2C_BUS_PRIO_SENSOR, i2c_bench_done, (void *)&tag_temp);
+    i2c_bus_submit(s_i2c_mpu, &gyro, I2C_BUS_PRIO_SENSOR, i2c_bench_done, (void *)&tag_gyro);
+    i2c_bus_submit(s_i2c_bmp, &press, I2C_BUS_PRIO_SENSOR, i2c_bench_done, (void *)&tag_press);
+}
+
+static void bench_i2c_round(void)
+{
+    i2c_bench_submit_round();
+    i2c_bus_service(s_i2c_bus);
+}
+
+// 不合并、不排序时同样五个请求的总线时间
+static uint32_t i2c_naive_time_us(void)
+{
+    const struct { i2c_bus_txn_type_t type; size_t len; } reqs[] = {
+        { I2C_BUS_TXN_WRITE, sizeof(s_i2c_page) }, { I2C_BUS_TXN_READ_REG, 6 }, { I2C_BUS_TXN_READ_REG, 2 },
+        { I2C_BUS_TXN_READ_REG, 6 }, { I2C_BUS_TXN_READ_REG, 6 },
+    };
+    uint32_t total = 0;
+    for (size_t i = 0; i < sizeof(reqs) / sizeof(reqs[0]); i++) {
+        i2c_bus_batch_t batch = { .type = reqs[i].type, .len = reqs[i].len, .count = 1 };
+        total += i2c_bus_xfer_time_us(&batch, 400000);
+    }
+    return total;
+}
+
+static bool check_i2c_round(void)
+{
+    if (!i2c_bench_setup()) {
+        return false;
+    }
+
+    // 一轮：传感器读取排在先提交的显示刷新前面，MPU6050三组寄存器合并为一次14字节突发读
+    host_i2c_stats_t before, after;
+    i2c_bus_stats_t bus_stats;
+    host_i2c_get_stats(&before);
+    i2c_bus_get_stats(s_i2c_bus, &bus_stats, true);
+    int64_t start = host_sim_now_us();
+    bench_i2c_round();
+    uint32_t bus_us = (uint32_t)(host_sim_now_us() - start);
+    uint32_t sensors_us = (uint32_t)(s_i2c_sensor_done_us - start);
+    host_i2c_get_stats(&after);
+    if (strcmp(s_i2c_order, "ATGPD") != 0 || after.transactions - before.transactions != 3) {
+        return false;
+    }
+    uint8_t expect[14];
+    host_i2c_get_regs(0, I2C_ADDR_MPU6050, 0x3B, expect, sizeof(expect));
+    if (memcmp(s_i2c_accel, expect, 6) != 0 || memcmp(s_i2c_temp, expect + 6, 2) != 0 ||
+        memcmp(s_i2c_gyro, expect + 8, 6) != 0) {
+        return false;
+    }
+    host_i2c_get_regs(0, I2C_ADDR_BMP280, 0xF7, expect, 6);
+    uint8_t page[128];
+    host_i2c_get_regs(0, I2C_ADDR_OLED, 0x40, page, sizeof(page));
+    if (memcmp(s_i2c_press, expect, 6) != 0 || memcmp(page, s_i2c_page + 1, sizeof(page)) != 0) {
+        return false;
+    }
+    i2c_bus_get_stats(s_i2c_bus, &bus_stats, false);
+    if (bus_stats.transfers < 3 || bus_stats.merged < 2 || bus_stats.busy_us != bus_us) {
+        return false;
+    }
+
+    // 同一设备保持提交顺序：写配置之后的读不越过写入，也不与写入之前的读合并
+    static const char tag_r1 = '1', tag_w = 'W', tag_r2 = '2';
+    uint8_t r1[2], r2[2];
+    const i2c_bus_txn_t read1 = { .type = I2C_BUS_TXN_READ_REG, .reg = 0x3B, .rbuf = r1, .rlen = 2 };
+    const uint8_t config[] = { 0x1C, 0x08 };
+    const i2c_bus_txn_t write = { .type = I2C_BUS_TXN_WRITE, .wbuf = config, .wlen = sizeof(config) };
+    const i2c_bus_txn_t read2 = { .type = I2C_BUS_TXN_READ_REG, .reg = 0x1C, .rbuf = r2, .rlen = 1 };
+    s_i2c_done = 0;
+    memset(s_i2c_order, 0, sizeof(s_i2c_order));
+    i2c_bus_submit(s_i2c_mpu, &read1, I2C_BUS_PRIO_DISPLAY, i2c_bench_done, (void *)&tag_r1);
+    i2c_bus_submit(s_i2c_mpu, &write, I2C_BUS_PRIO_NORMAL, i2c_bench_done, (void *)&tag_w);
+    i2c_bus_submit(s_i2c_mpu, &read2, I2C_BUS_PRIO_SENSOR, i2c_bench_done, (void *)&tag_r2);
+    i2c_bus_service(s_i2c_bus);
+    if (strcmp(s_i2c_order, "1W2") != 0 || r2[0] != 0x08) {
+        return false;
+    }
+
+    // 老化：排队超过 CONFIG_I2C_BUS_AGING_MS 的显示刷新先于新到的传感器读取
+    static const char tag_oled = 'D', tag_press = 'P';
+    const i2c_bus_txn_t page_txn = { .type = I2C_BUS_TXN_WRITE, .wbuf = s_i2c_page, .wlen = sizeof(s_i2c_page) };
+    const i2c_bus_txn_t press = { .type = I2C_BUS_TXN_READ_REG, .reg = 0xF7, .rbuf = s_i2c_press, .rlen = 6 };
+    s_i2c_done = 0;
+    memset(s_i2c_order, 0, sizeof(s_i2c_order));
+    i2c_bus_submit(s_i2c_oled, &page_txn, I2C_BUS_PRIO_DISPLAY, i2c_bench_done, (void *)&tag_oled);
+    host_sim_advance_us((CONFIG_I2C_BUS_AGING_MS + 1) * 1000);
+    i2c_bus_submit(s_i2c_bmp, &press, I2C_BUS_PRIO_SENSOR, i2c_bench_done, (void *)&tag_press);
+    i2c_bus_service(s_i2c_bus);
+    if (strcmp(s_i2c_order, "DP") != 0) {
+        return false;
+    }
+
+    // 同步接口（manual_service 总线在调用者上下文中执行）；无应答的地址返回错误并计入统计
+    uint8_t who = 0;
+    host_i2c_set_regs(0, I2C_ADDR_MPU6050, 0x75, (const uint8_t[]){ I2C_ADDR_MPU6050 }, 1);
+    if (i2c_bus_read_reg(s_i2c_mpu, 0x75, &who, 1, I2C_BUS_PRIO_SENSOR) != ESP_OK || who != I2C_ADDR_MPU6050) {
+        return false;
+    }
+    i2c_bus_device_handle_t missing;
+    const i2c_bus_device_config_t missing_config = { .addr = 0x23, .scl_hz = 100000, .name = "BH1750" };
+    i2c_bus_device_stats_t dev_stats;
+    if (i2c_bus_add_device(s_i2c_bus, &missing_config, &missing) != ESP_OK ||
+        i2c_bus_write(missing, (const uint8_t[]){ 0x10 }, 1, I2C_BUS_PRIO_NORMAL) == ESP_OK ||
+        i2c_bus_get_device_stats(missing, &dev_stats) != ESP_OK || dev_stats.errors != 1) {
+        return false;
+    }
+
+    // 按提交顺序逐个传输时，传感器读数要等显示刷新和全部五次传输结束
+    snprintf(s_i2c_note, sizeof(s_i2c_note), "5 req in 3 xfers %lu us; sensors ready %lu us vs %lu fifo",
+             (unsigned long)bus_us, (unsigned long)sensors_us, (unsigned long)i2c_naive_time_us());
+    return true;
+}
+
+/* ==================== 基准项：加速度计特征 ==================== */
+
+#define IMU_BENCH_RAW       1024                // 1kHz下1.024 s，抽取后正好一个256点窗口
+#define IMU_BENCH_FREQ_HZ   40.0f
+#define IMU_BENCH_AMP_G     0.5f
+
+static imu_pipeline_t s_imu_pipeline;
+static imu_sample_t s_imu_raw[IMU_BENCH_RAW];
+static imu_features_t s_imu_features;
+static char s_imu_note[96];
+
+// X轴40Hz/0.5g正弦，Z轴1g重力，offset为起始样本序号（连续生成多个窗口时相位连续）
+static void imu_bench_generate(uint32_t offset)
+{
+    const float lsb_per_g = 32768.0f / CONFIG_IMU_STREAM_ACCEL_RANGE_G;
+    for (int i = 0; i < IMU_BENCH_RAW; i++) {
+        float t = (float)(offset + i) / CONFIG_IMU_STREAM_RATE_HZ;
+        s_imu_raw[i].v[0] = (int16_t)lrintf(IMU_BENCH_AMP_G * sinf(2.0f * (float)M_PI * IMU_BENCH_FREQ_HZ * t) * lsb_per_g);
+        s_imu_raw[i].v[1] = 0;
+        s_imu_raw[i].v[2] = (int16_t)lrintf(lsb_per_g);
+    }
+}
+
+static bool imu_bench_init(void)
+{
+    imu_bench_generate(0);
+    return imu_pipeline_init(&s_imu_pipeline, CONFIG_IMU_STREAM_RATE_HZ, CONFIG_IMU_STREAM_DECIMATION,
+                             CONFIG_IMU_STREAM_FFT_SIZE, 32768.0f / CONFIG_IMU_STREAM_ACCEL_RANGE_G) == ESP_OK;
+}
+
+// 一个窗口的原始样本：抽取 + 三轴FFT和特征
+static void bench_imu_window(void)
+{
+    for (int i = 0; i < IMU_BENCH_RAW; i++) {
+        imu_pipeline_push(&s_imu_pipeline, &s_imu_raw[i], &s_imu_features);
+    }
+}
+
+static bool near(float value, float expect, float tol)
+{
+    return fabsf(value - expect) <= tol;
+}
+
+// 40Hz正弦：RMS = A/√2，峰值因子 √2，能量集中在含40Hz的频带，Z轴均值1g
+static bool imu_features_ok(const imu_features_t *f)
+{
+    const imu_axis_features_t *x = &f->axis[0];
+    const float rms = IMU_BENCH_AMP_G / sqrtf(2.0f);
+    float total = 0.0f;
+    for (int b = 0; b < CONFIG_IMU_STREAM_BANDS; b++) {
+        total += x->bands[b];
+    }
+    int band = (int)(IMU_BENCH_FREQ_HZ / f->band_hz);
+    return near(x->rms, rms, rms * 0.05f) && near(x->crest, sqrtf(2.0f), 0.07f) &&
+           near(x->dominant_hz, IMU_BENCH_FREQ_HZ, f->rate_hz / f->samples) &&
+           x->bands[band] > 0.9f * total && near(total, x->rms * x->rms, x->rms * x->rms * 0.1f) &&
+           near(f->axis[2].mean, 1.0f, 0.01f) && f->axis[1].rms < 0.01f && f->axis[2].rms < 0.01f;
+}
+
+static bool check_imu_window(void)
+{
+    // 连续两个窗口：第一个包含抽取器的启动过渡，第二个是稳态
+    int windows = 0;
+    if (!imu_bench_init()) {
+        return false;
+    }
+    for (uint32_t offset = 0; offset < 3 * IMU_BENCH_RAW; offset += IMU_BENCH_RAW) {
+        imu_bench_generate(offset);
+        for (int i = 0; i < IMU_BENCH_RAW; i++) {
+            if (imu_pipeline_push(&s_imu_pipeline, &s_imu_raw[i], &s_imu_features)) {
+                windows++;
+                if (!imu_features_ok(&s_imu_features)) {
+                    return false;
+                }
+            }
+        }
+    }
+    if (windows != 2) {
+        return false;
+    }
+
+    // FIFO通路：MPU6050模型 -> 手动执行的I2C总线 -> 环形缓冲 -> 特征，每50ms读一次FIFO
+    host_sensor_mpu6050_attach(0, I2C_ADDR_MPU6050);
+    host_sensor_mpu6050_set_vibration(0, IMU_BENCH_FREQ_HZ, IMU_BENCH_AMP_G);
+    const imu_stream_config_t config = {
+        .sda = I2C_SDA_PIN, .scl = I2C_SCL_PIN, .int_pin = GPIO_NUM_NC,
+        .addr = I2C_ADDR_MPU6050, .manual_service = true,
+    };
+    if (imu_stream_start(&config) != ESP_OK) {
+        return false;
+    }
+    const uint32_t period_us = CONFIG_IMU_STREAM_WATERMARK * 1000000u / CONFIG_IMU_STREAM_RATE_HZ;
+    int64_t start = host_sim_now_us();
+    while (host_sim_now_us() - start < 2200000) {
+        host_sim_advance_us(period_us);
+        imu_stream_service();
+    }
+    imu_stream_stats_t stats;
+    imu_features_t summary;
+    imu_stream_get_stats(&stats);
+    bool ok = stats.fifo_overflows == 0 && stats.ring_dropped == 0 && stats.i2c_errors == 0 && stats.windows >= 2 &&
+              imu_stream_take_summary(&summary, true) == ESP_OK && imu_features_ok(&summary) &&
+              imu_stream_take_summary(&summary, true) == ESP_ERR_INVALID_STATE;
+    uint32_t samples = stats.samples;
+    uint32_t drains = stats.drains;
+
+    // 300ms不读，FIFO（170个样本）溢出：复位后继续采集
+    host_sim_advance_us(300000);
+    imu_stream_service();
+    imu_stream_get_stats(&stats);
+    ok = ok && stats.fifo_overflows == 1 && host_sensor_mpu6050_overflows() >= 1;
+    imu_stream_stop();
+    host_sensor_mpu6050_set_vibration(0, 0.0f, 0.0f);
+    if (!ok) {
+        return false;
+    }
+
+    snprintf(s_imu_note, sizeof(s_imu_note), "x rms %.3f g crest %.2f %.1f Hz; fifo %lu samples in %lu drains",
+             s_imu_features.axis[0].rms, s_imu_features.axis[0].crest, s_imu_features.axis[0].dominant_hz,
+             (unsigned long)samples, (unsigned long)drains);
+    return true;
+}
+
+/* ==================== 基准项：模拟量连续采样 ==================== */
+
+#define ADC_BENCH_FRAME     (CONFIG_ADC_STREAM_SAMPLE_RATE_HZ / CONFIG_ADC_STREAM_FRAMES_PER_S)
+#define ADC_BENCH_MQ2_GPIO  4                   // ESP32-S3 ADC1_CH3
+#define ADC_BENCH_RAIN_GPIO 5                   // ADC1_CH4
+
+typedef struct {
+    uint8_t unit;
+    uint8_t channel;
+    uint16_t raw;
+} adc_bench_sample_t;
+
+static adc_stream_reducer_t s_adc_reducer;
+static adc_bench_sample_t s_adc_frame[ADC_BENCH_FRAME];
+static char s_adc_note[96];
+
+// 两个通道交替：通道3每4个样本中有1个2048、其余2047，通道4恒为1000
+static void adc_bench_init(void)
+{
+    adc_stream_reducer_init(&s_adc_reducer, CONFIG_ADC_STREAM_OVERSAMPLE_BITS);
+    adc_stream_reducer_add(&s_adc_reducer, 0, 3);
+    adc_stream_reducer_add(&s_adc_reducer, 0, 4);
+    for (int i = 0; i < ADC_BENCH_FRAME; i++) {
+        bool first = (i & 1) == 0;
+        s_adc_frame[i].unit = 0;
+        s_adc_frame[i].channel = first ? 3 : 4;
+        s_adc_frame[i].raw = first ? ((i / 2) % 4 == 0 ? 2048 : 2047) : 1000;
+    }
+}
+
+// 一个DMA帧：逐样本查表累加，每个样本的工作量与采样率无关
+static void bench_adc_frame(void)
+{
+    for (int i = 0; i < ADC_BENCH_FRAME; i++) {
+        adc_stream_reducer_put(&s_adc_reducer, s_adc_frame[i].unit, s_adc_frame[i].channel, s_adc_frame[i].raw);
+    }
+}
+
+static bool check_adc_frame(void)
+{
+    // 归约：平均值保留小数位（2047.25），不属于已登记通道的样本单独计数
+    adc_bench_init();
+    for (int n = 0; n < 4; n++) {
+        bench_adc_frame();
+    }
+    adc_stream_reducer_put(&s_adc_reducer, 0, 7, 123);
+    uint32_t expect_outputs = 4 * (ADC_BENCH_FRAME / 2) / s_adc_reducer.block;
+    if (s_adc_reducer.acc[0].outputs != expect_outputs || adc_stream_reducer_raw(&s_adc_reducer, 0) != 2047.25f ||
+        adc_stream_reducer_raw(&s_adc_reducer, 1) != 1000.0f || s_adc_reducer.unknown != 1) {
+        return false;
+    }
+
+    // 标定曲线：点之间线性插值，范围外取端点
+    const adc_stream_curve_t curve = { .count = 2, .points = { { 500.0f, 100.0f }, { 3000.0f, 0.0f } } };
+    if (adc_stream_curve_eval(&curve, 1750.0f) != 50.0f || adc_stream_curve_eval(&curve, 100.0f) != 100.0f ||
+        adc_stream_curve_eval(&curve, 3300.0f) != 0.0f || adc_stream_curve_eval(NULL, 42.0f) != 42.0f) {
+        return false;
+    }
+
+    // 运行时：ADC模型 -> DMA帧 -> 过采样平均 -> 标定；±1.5 LSB的噪声起抖动作用，平均后分辨率高于1 LSB
+    const float mq2_mv = 1234.4f;
+    const float rain_mv = 1375.0f;                      // 干燥3000mV、湿润500mV之间的65%
+    host_adc_set_noise(1.5f);
+    host_adc_set_mv(ADC_BENCH_MQ2_GPIO, mq2_mv);
+    host_adc_set_mv(ADC_BENCH_RAIN_GPIO, rain_mv);
+    const adc_stream_config_t config = { .manual_service = true };
+    const rain_sensor_config_t rain_config = {
+        .data_pin = GPIO_NUM_NC,
+        .analog_enable = true,
+        .analog_pin = ADC_BENCH_RAIN_GPIO,
+    };
+    const adc_stream_channel_config_t mq2 = { .gpio = ADC_BENCH_MQ2_GPIO, .atten_db = 12, .name = "MQ2" };
+    const adc_stream_channel_config_t adc2 = { .gpio = GPIO_NUM_12, .atten_db = 12, .name = "ADC2" };
+    int mq2_index = -1;
+    int adc2_index = -1;
+    if (adc_stream_init(&config) != ESP_OK || rain_sensor_init(&rain_config) != ESP_OK ||
+        adc_stream_add_channel(&mq2, &mq2_index) != ESP_OK ||
+        adc_stream_add_channel(&adc2, &adc2_index) != ESP_ERR_NOT_SUPPORTED) {
+        return false;
+    }
+
+    adc_stream_value_t value;
+    rain_sensor_data_t rain = { 0 };
+    bool ok = adc_stream_read(mq2_index, &value) == ESP_ERR_INVALID_STATE;
+    const uint32_t frame_us = 1000000 / CONFIG_ADC_STREAM_FRAMES_PER_S;
+    for (int n = 0; n < CONFIG_ADC_STREAM_FRAMES_PER_S; n++) {
+        host_sim_advance_us(frame_us);
+        adc_stream_service();
+    }
+    adc_stream_stats_t stats;
+    adc_stream_get_stats(&stats);
+    ok = ok && stats.frames == CONFIG_ADC_STREAM_FRAMES_PER_S && stats.overflows == 0 && stats.unknown == 0 &&
+         adc_stream_read(mq2_index, &value) == ESP_OK && near(value.mv, mq2_mv, 0.6f) && value.value == value.mv &&
+         rain_sensor_read(&rain) == ESP_OK && rain.valid && rain.is_raining && near(rain.wetness, 65.0f, 0.1f);
+    float mv = value.mv;
+    uint32_t outputs = value.outputs;
+
+    // 200ms不处理，超出驱动缓冲池（3帧）：丢弃最旧的帧并计数，之后继续采集
+    host_sim_advance_us(200000);
+    adc_stream_service();
+    adc_stream_get_stats(&stats);
+    ok = ok && stats.overflows >= 1 && adc_stream_read(mq2_index, &value) == ESP_OK && value.outputs > outputs;
+    rain_sensor_deinit();
+    adc_stream_deinit();
+    host_adc_set_noise(0.0f);
+    if (!ok) {
+        return false;
+    }
+
+    snprintf(s_adc_note, sizeof(s_adc_note), "%d samples/frame, %d frames/s; %.2f mV (set %.1f), wet %.1f%%",
+             ADC_BENCH_FRAME, CONFIG_ADC_STREAM_FRAMES_PER_S, mv, mq2_mv, rain.wetness);
+    return true;
+}
+
+/* ==================== 基准项：超声波测距 ==================== */
+
+// 读取路径：取最近的回波 -> 剔除量程外 -> 中值 -> 按气温换算；回波由捕获中断写入，读取不等待
+#define US_BENCH_TRIG       GPIO_NUM_15
+#define US_BENCH_ECHO       GPIO_NUM_16
+
+static ultrasonic_ring_t s_us_ring;
+static volatile float s_us_sink;
+static char s_us_note[96];
+
+static void bench_us_filter(void)
+{
+    uint32_t echoes[CONFIG_ULTRASONIC_MEDIAN_WINDOW];
+    ultrasonic_filter_result_t result;
+    ultrasonic_ring_push(&s_us_ring, 7000 + (s_counter++ & 7));
+    size_t n = ultrasonic_ring_latest(&s_us_ring, echoes, CONFIG_ULTRASONIC_MEDIAN_WINDOW);
+    if (ultrasonic_filter(echoes, n, ultrasonic_cm_to_echo(ULTRASONIC_MIN_RANGE_CM, 25.0f),
+                          ultrasonic_cm_to_echo(CONFIG_ULTRASONIC_MAX_RANGE_CM, 25.0f), &result)) {
+        s_us_sink = ultrasonic_echo_to_cm(result.echo_us, 25.0f);
+    }
+}
+
+static bool check_us_filter(void)
+{
+    // 纯计算：声速、中值剔除单个杂散回波、多数回波超出量程时判为无目标
+    ultrasonic_filter_result_t result;
+    const uint32_t glitch[] = { 5800, 1900, 5810, 5790, 5805 };
+    const uint32_t far[] = { 38000, 5800, 38000, 38000 };
+    const uint32_t even[] = { 5800, 5802, 90, 5806, 5804 };
+    if (!near(ultrasonic_sound_speed(20.0f), 343.2f, 0.1f) ||
+        !ultrasonic_filter(glitch, 5, 100, 24000, &result) || result.echo_us != 5800 || result.valid != 5 ||
+        ultrasonic_filter(far, 4, 100, 24000, &result) || result.valid != 1 ||
+        !ultrasonic_filter(even, 5, 100, 24000, &result) || result.echo_us != 5803 || result.valid != 4) {
+        return false;
+    }
+    memset(&s_us_ring, 0, sizeof(s_us_ring));
+    uint32_t latest[4];
+    for (uint32_t i = 1; i <= ULTRASONIC_RING_SIZE + 3; i++) {
+        ultrasonic_ring_push(&s_us_ring, i);
+    }
+    if (ultrasonic_ring_latest(&s_us_ring, latest, 4) != 4 || latest[0] != ULTRASONIC_RING_SIZE + 3 ||
+        latest[3] != ULTRASONIC_RING_SIZE) {
+        return false;
+    }
+
+    // 运行时：MCPWM模型产生TRIG，HC-SR04模型在35°C空气中回波，每4个回波有一个杂散回波
+    const float target_cm = 123.4f;
+    host_sensor_hcsr04_attach(US_BENCH_TRIG, US_BENCH_ECHO);
+    host_sensor_hcsr04_set(target_cm, 35.0f);
+    host_sensor_hcsr04_set_glitch_every(4);
+    const ultrasonic_config_t config = { .trig = US_BENCH_TRIG, .echo = US_BENCH_ECHO };
+    ultrasonic_reading_t reading;
+    if (ultrasonic_read(&reading) != ESP_ERR_INVALID_STATE || ultrasonic_start(&config) != ESP_OK) {
+        return false;
+    }
+    bool ok = ultrasonic_read(&reading) == ESP_ERR_TIMEOUT;
+
+    ultrasonic_stats_t before, after;
+    ultrasonic_get_stats(&before);
+    ultrasonic_set_temperature(35.0f);
+    host_sim_advance_us(1000000);
+    ultrasonic_get_stats(&after);
+    uint32_t echoes_per_s = after.echoes - before.echoes;
+    ok = ok && ultrasonic_read(&reading) == ESP_OK && near(reading.distance_cm, target_cm, 0.5f) &&
+         reading.window == CONFIG_ULTRASONIC_MEDIAN_WINDOW;
+    float compensated = reading.distance_cm;
+
+    // 不补偿（按默认20°C换算）时偏短约2.5%
+    ultrasonic_set_temperature(20.0f);
+    ok = ok && ultrasonic_read(&reading) == ESP_OK && near(reading.distance_cm, 120.4f, 0.5f);
+    float uncompensated = reading.distance_cm;
+
+    // 前方没有目标：回波约38ms，全部超出量程
+    host_sensor_hcsr04_set(0.0f, 35.0f);
+    host_sim_advance_us(1000000);
+    ok = ok && ultrasonic_read(&reading) == ESP_ERR_NOT_FOUND && reading.valid == 0 &&
+         ultrasonic_start(&config) == ESP_ERR_INVALID_STATE;
+    ultrasonic_stop();
+    ok = ok && ultrasonic_read(&reading) == ESP_ERR_INVALID_STATE;
+    if (!ok || echoes_per_s < CONFIG_ULTRASONIC_RATE_HZ - 1) {
+        return false;
+    }
+
+    snprintf(s_us_note, sizeof(s_us_note), "%.2f cm @35C (uncomp %.2f), %u echoes/s, window %d",
+             compensated, uncompensated, (unsigned)echoes_per_s, CONFIG_ULTRASONIC_MEDIAN_WINDOW);
+    return true;
+}
+
+/* ==================== 基准项：显示 ==================== */
+
+static void bench_lcd_fill(void)
+{
+    lcd_fill_screen(sim_device_lcd(), (s_counter++ & 1) ? COLOR_BLUE : COLOR_BLACK);
+}
+
+static bool check_lcd_fill(void)
+{
+    lcd_fill_screen(sim_device_lcd(), COLOR_RED);
+    return host_lcd_pixel(10, 10) == COLOR_RED && host_lcd_pixel(LCD_WIDTH - 1, LCD_HEIGHT - 1) == COLOR_RED;
+}
+
+static void bench_lcd_rect(void)
+{
+    lcd_draw_rectangle(sim_device_lcd(), 20, 20, 64, 48, COLOR_GREEN);
+}
+
+static void bench_lcd_string(void)
+{
+    lcd_draw_string(sim_device_lcd(), 10, 10, "Temp 23.4C Hum 56%", COLOR_WHITE, COLOR_BLACK);
+}
+
+static bool check_lcd_string(void)
+{
+    lcd_fill_screen(sim_device_lcd(), COLOR_BLACK);
+    bench_lcd_string();
+    // 至少有一个前景色像素落在文本区域内（面板坐标，swap_xy）
+    for (int y = 0; y < LCD_HEIGHT; y++) {
+        for (int x = 0; x < LCD_WIDTH; x++) {
+            if (host_lcd_pixel(x, y) == COLOR_WHITE) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static const bench_t s_benches[] = {
+    { "parse.device_cmd",        bench_parse_device,          check_parse_device,          NULL },
+    { "dispatch.led",            bench_dispatch_led,          check_dispatch_led,          NULL },
+    { "dispatch.servo",          bench_dispatch_servo,        check_dispatch_servo,        NULL },
+    { "parse.preset",            bench_parse_preset,          NULL,                        NULL },
+    { "dispatch.preset_blink",   bench_dispatch_preset,       check_dispatch_preset,       "400ms virtual" },
+    { "mqtt.command_dispatch",   bench_mqtt_dispatch,         check_mqtt_dispatch,        NULL },
+    { "serialize.sensor_report", bench_serialize_sensor,      NULL,                        NULL },
+    { "serialize.cjson_response", bench_serialize_response,   NULL,                        NULL },
+    { "serialize.metrics",       bench_serialize_metrics,     check_serialize_metrics,     NULL },
+    { "serialize.task_report",   bench_serialize_task_report, check_serialize_task_report, NULL },
+    { "crc.sample_store_append", bench_sample_store_append,   check_sample_store,          NULL },
+    { "crc.binlog_write",        bench_binlog_write,          NULL,                        NULL },
+    { "sensor.ds18b20_read",     bench_ds18b20_read,          check_ds18b20,               NULL },
+    { "sensor.dht11_read",       bench_dht11_read,            check_dht11,                 NULL },
+    { "sensor.read_all",         bench_hub_read_all,          check_hub_read_all,          s_hub_note },
+    { "alarm.feed_4_checks",     bench_alarm_feed,            check_alarm_feed,            NULL },
+    { "report.check_deadband",   bench_report_check,          check_report_check,          NULL },
+    { "filter.apply_full_chain", bench_filter_apply,          check_filter_apply,          s_filter_note },
+    { "json.stream_chunked",     bench_json_stream,           check_json_stream,           s_json_note },
+    { "dns.answer_2q",           bench_dns_answer,            check_dns_answer,            NULL },
+    { "dns.udp_roundtrip",       bench_dns_udp,               check_dns_udp,               s_dns_note },
+    { "ble.frag_roundtrip",      bench_ble_frag,              check_ble_frag,              s_ble_note },
+    { "prov.status_json",        bench_prov_status,           check_prov_status,           s_prov_note },
+    { "input.edge_timeline",     bench_input_replay,          check_input_replay,          NULL },
+    { "servo.trajectory",        bench_servo_trajectory,      check_servo_trajectory,      s_servo_note },
+    { "led.fade_chain",          bench_fx_plan,               check_fx_plan,               s_fx_note },
+    { "pwm.duty_commit",         bench_duty_update,           check_duty_update,           s_duty_note },
+    { "i2c.sched_merge_round",   bench_i2c_round,             check_i2c_round,             s_i2c_note },
+    { "imu.window_features",     bench_imu_window,            check_imu_window,            s_imu_note },
+    { "adc.frame_reduce",        bench_adc_frame,             check_adc_frame,             s_adc_note },
+    { "ultrasonic.echo_median",  bench_us_filter,             check_us_filter,             s_us_note },
+    { "display.fill_screen",     bench_lcd_fill,              check_lcd_fill,              NULL },
+    { "display.rect_64x48",      bench_lcd_rect,              NULL,                        NULL },
+    { "display.string_18ch",     bench_lcd_string,            check_lcd_string,            NULL },
+};
+
+/* ==================== 初始化 ==================== */
+
+static int setup(void)
+{
+    host_log_level = ESP_LOG_WARN;             // 日志输出会淹没被测代码的耗时
+
+    if (sim_device_init() != ESP_OK) {
+        return -1;
+    }
+
+    if (sim_device_mount_sample_store() != ESP_OK) {
+        fprintf(stderr, "sample store mount failed\n");
+        return -1;
+    }
+
+    if (alarm_init(record_alarm_event, NULL) != ESP_OK || alarm_set_rule(&s_bench_rule) != ESP_OK) {
+        fprintf(stderr, "alarm init failed\n");
+        return -1;
+    }
+
+    const report_policy_t report_policy = {
+        .sensor = SAMPLE_SENSOR_DHT11, .deadband_abs = 0.5f,
+        .min_interval_sec = 10, .max_interval_sec = 300,
+    };
+    report_filter_set_enabled(true);
+    if (report_filter_init() != ESP_OK || report_filter_set_policy(&report_policy) != ESP_OK) {
+        fprintf(stderr, "report filter init failed\n");
+        return -1;
+    }
+
+    if (sensor_filter_init() != ESP_OK || sensor_filter_configure(&s_bench_filter) != ESP_OK) {
+        fprintf(stderr, "sensor filter init failed\n");
+        return -1;
+    }
+    snprintf(s_filter_note, sizeof(s_filter_note), "%u B/channel static",
+             (unsigned)sensor_filter_channel_footprint());
+    // DNS：预先生成查询（A + AAAA），服务器监听本机随机端口，客户端阻塞接收（超时100ms）
+    static const char *const dns_names[] = { "connectivitycheck.gstatic.com", "captive.apple.com" };
+    static const uint16_t dns_types[] = { 1, 28 };
+    s_dns_query_len = dns_build_query(s_dns_query, 0x1200, dns_names, dns_types, 2);
+    captive_dns_template_init(&s_dns_tmpl, 0xC0A80401, 60);
+    captive_dns_config_t dns_cfg = CAPTIVE_DNS_DEFAULT_CONFIG();
+    dns_cfg.port = 0;
+    dns_cfg.rate_per_s = 0;
+    s_dns_client = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    struct timeval dns_timeout = { .tv_sec = 0, .tv_usec = 100000 };
+    if (s_dns_client < 0 || setsockopt(s_dns_client, SOL_SOCKET, SO_RCVTIMEO, &dns_timeout, sizeof(dns_timeout)) < 0 ||
+        captive_dns_start(&dns_cfg) != ESP_OK) {
+        fprintf(stderr, "captive dns init failed\n");
+        return -1;
+    }
+
+    for (size_t i = 0; i < sizeof(s_ble_msg); i++) {
+        s_ble_msg[i] = (uint8_t)(' ' + i % 95);
+    }
+
+    snprintf(s_json_note, sizeof(s_json_note), "%u B doc, %u B parser",
+             (unsigned)(sizeof(s_bench_json) - 1), (unsigned)sizeof(json_stream_t));
+
+    // 两次采样形成一个完整窗口
+    task_profiler_init(&s_profiler_source);
+    s_counter = 1;
+    task_profiler_sample();
+    s_counter = 2;
+    task_profiler_sample();
+    if (task_profiler_get_report(&s_report) != ESP_OK) {
+        fprintf(stderr, "task profiler report failed\n");
+        return -1;
+    }
+    bench_serialize_task_report();
+    return 0;
+}
+
+/* ==================== 测量与基线比较 ==================== */
+
+static bench_result_t run_bench(const bench_t *b, int repeat)
+{
+    bench_result_t r = { .name = b->name };
+
+    for (int i = 0; i < BENCH_WARMUP; i++) {
+        b->run();
+    }
+
+    // 校准：找到单轮耗时超过BENCH_TARGET_NS的迭代次数
+    uint32_t iters = 1;
+    for (;;) {
+        double t0 = wall_ns();
+        for (uint32_t i = 0; i < iters; i++) {
+            b->run();
+        }
+        double dt = wall_ns() - t0;
+        if (dt >= BENCH_TARGET_NS / 4 || iters >= (1u << 24)) {
+            double scale = BENCH_TARGET_NS / (dt > 1 ? dt : 1);
+            iters = (uint32_t)(iters * (scale > 1 ? scale : 1));
+            break;
+        }
+        iters *= 4;
+    }
+    if (iters == 0) {
+        iters = 1;
+    }
+
+    double samples[64];
+    if (repeat > 64) {
+        repeat = 64;
+    }
+    for (int k = 0; k < repeat; k++) {
+        double t0 = wall_ns();
+        for (uint32_t i = 0; i < iters; i++) {
+            b->run();
+        }
+        samples[k] = (wall_ns() - t0) / iters;
+    }
+    qsort(samples, repeat, sizeof(double), cmp_double);
+    r.median_ns = samples[repeat / 2];
+    r.min_ns = samples[0];
+    r.iterations = iters;
+    return r;
+}
+
+static int load_baseline(const char *path, char names[][48], double *values, int max)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        return -1;
+    }
+    int n = 0;
+    char line[256];
+    while (n < max && fgets(line, sizeof(line), fp)) {
+        const char *p = strstr(line, "\"name\":\"");
+        const char *q = strstr(line, "\"median_ns\":");
+        if (!p || !q) {
+            continue;
+        }
+        if (sscanf(p + 8, "%47[^\"]", names[n]) == 1 && sscanf(q + 12, "%lf", &values[n]) == 1) {
+            n++;
+        }
+    }
+    fclose(fp);
+    return n;
+}
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s [--filter substr] [--json out.json] [--baseline in.json] "
+           "[--threshold pct] [--repeat n]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    const char *filter = NULL;
+    const char *json_path = NULL;
+    const char *baseline_path = NULL;
+    double threshold = BENCH_DEFAULT_THRESHOLD;
+    int repeat = BENCH_DEFAULT_REPEAT;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+            if (repeat < 1) {
+                repeat = 1;
+            }
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    // BSP在每次LED/继电器动作时printf，固件中同样走UART；
+    // 保留格式化开销，但不让终端输出速度影响测量结果
+    fflush(stdout);
+    s_out = fdopen(dup(STDOUT_FILENO), "w");
+    if (!s_out || !freopen("/dev/null", "w", stdout)) {
+        fprintf(stderr, "cannot redirect stdout\n");
+        return 1;
+    }
+    setvbuf(s_out, NULL, _IOLBF, 0);
+
+    if (setup() != 0) {
+        return 1;
+    }
+
+    bench_result_t results[BENCH_MAX];
+    int count = 0;
+
+    fprintf(s_out, "%-26s %12s %12s %10s  %s\n", "benchmark", "median ns/op", "min ns/op", "iters", "check");
+    for (size_t i = 0; i < sizeof(s_benches) / sizeof(s_benches[0]); i++) {
+        const bench_t *b = &s_benches[i];
+        if (filter && !strstr(b->name, filter)) {
+            continue;
+        }
+        const char *status = "-";
+        if (b->check) {
+            bool ok = b->check();
+            check(ok, b->name);
+            status = ok ? "ok" : "FAIL";
+        }
+        results[count] = run_bench(b, repeat);
+        fprintf(s_out, "%-26s %12.0f %12.0f %10u  %s%s%s\n", b->name, results[count].median_ns,
+               results[count].min_ns, results[count].iterations, status,
+               b->note ? "  " : "", b->note ? b->note : "");
+        count++;
+    }
+
+    host_lcd_stats_t lcd_stats;
+    host_lcd_get_stats(&lcd_stats);
+    host_mqtt_stats_t mqtt_stats;
+    host_mqtt_get_stats(&mqtt_stats);
+    fprintf(s_out, "\nmodel: lcd %u draws, %.1f MB over SPI (%.1f s bus time); mqtt %u published, %u delivered\n",
+           lcd_stats.draw_calls, lcd_stats.spi_bytes / 1e6, lcd_stats.spi_time_us / 1e6,
+           mqtt_stats.published, mqtt_stats.delivered);
+
+    if (json_path) {
+        FILE *fp = fopen(json_path, "w");
+        if (!fp) {
+            fprintf(stderr, "cannot write %s\n", json_path);
+            return 1;
+        }
+        fprintf(fp, "[\n");
+        for (int i = 0; i < count; i++) {
+            fprintf(fp, "  {\"name\":\"%s\",\"median_ns\":%.1f,\"min_ns\":%.1f}%s\n",
+                    results[i].name, results[i].median_ns, results[i].min_ns, i + 1 < count ? "," : "");
+        }
+        fprintf(fp, "]\n");
+        fclose(fp);
+        fprintf(s_out, "results written to %s\n", json_path);
+    }
+
+    int regressions = 0;
+    if (baseline_path) {
+        char names[BENCH_MAX][48];
+        double values[BENCH_MAX];
+        int n = load_baseline(baseline_path, names, values, BENCH_MAX);
+        if (n < 0) {
+            fprintf(stderr, "cannot read baseline %s\n", baseline_path);
+            return 1;
+        }
+        fprintf(s_out, "\ncompare with %s (threshold %.0f%%):\n", baseline_path, threshold);
+        for (int i = 0; i < count; i++) {
+            for (int j = 0; j < n; j++) {
+                if (strcmp(results[i].name, names[j]) != 0 || values[j] <= 0) {
+                    continue;
+                }
+                double delta = (results[i].median_ns - values[j]) * 100.0 / values[j];
+                bool regressed = delta > threshold;
+                regressions += regressed;
+                fprintf(s_out, "  %-26s %+7.1f%%%s\n", results[i].name, delta, regressed ? "  REGRESSION" : "");
+            }
+        }
+    }
+
+    if (s_check_failures) {
+        fprintf(stderr, "%d check(s) failed\n", s_check_failures);
+        return 1;
+    }
+    return regressions ? 3 : 0;
+}
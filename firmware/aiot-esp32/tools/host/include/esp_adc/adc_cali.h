@@ -0,0 +1,16 @@
+/**
+ * @file adc_cali.h
+ * @brief 主机模拟：ADC标定接口（见 mock/adc_model.c）
+ */
+
+#ifndef HOST_ESP_ADC_ADC_CALI_H
+#define HOST_ESP_ADC_ADC_CALI_H
+
+#include "esp_err.h"
+#include "hal/adc_types.h"
+
+typedef struct host_adc_cali *adc_cali_handle_t;
+
+esp_err_t adc_cali_raw_to_voltage(adc_cali_handle_t handle, int raw, int *voltage);
+
+#endif // HOST_ESP_ADC_ADC_CALI_H
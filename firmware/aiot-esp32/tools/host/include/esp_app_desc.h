@@ -0,0 +1,28 @@
+/**
+ * @file esp_app_desc.h
+ * @brief 主机模拟：应用描述（固定的版本号和全零ELF哈希）
+ */
+
+#ifndef HOST_ESP_APP_DESC_H
+#define HOST_ESP_APP_DESC_H
+
+#include <stdint.h>
+
+typedef struct {
+    char version[32];
+    char project_name[32];
+    char idf_ver[32];
+    uint8_t app_elf_sha256[32];
+} esp_app_desc_t;
+
+static inline const esp_app_desc_t *esp_app_get_description(void)
+{
+    static const esp_app_desc_t desc = {
+        .version = "host-sim",
+        .project_name = "aiot-esp32s3-firmware",
+        .idf_ver = "host",
+    };
+    return &desc;
+}
+
+#endif // HOST_ESP_APP_DESC_H
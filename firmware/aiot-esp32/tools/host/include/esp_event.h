@@ -0,0 +1,17 @@
+/**
+ * @file esp_event.h
+ * @brief 主机模拟：事件循环类型（事件由模拟broker直接回调，不经过事件循环）
+ */
+
+#ifndef HOST_ESP_EVENT_H
+#define HOST_ESP_EVENT_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef const char *esp_event_base_t;
+typedef void (*esp_event_handler_t)(void *handler_args, esp_event_base_t base, int32_t event_id, void *event_data);
+
+#define ESP_EVENT_ANY_ID    (-1)
+
+#endif // HOST_ESP_EVENT_H
@@ -0,0 +1,34 @@
+/**
+ * @file esp_lcd_panel_io.h
+ * @brief 主机模拟：LCD面板IO（见 mock/lcd_panel_model.c）
+ */
+
+#ifndef HOST_ESP_LCD_PANEL_IO_H
+#define HOST_ESP_LCD_PANEL_IO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/spi_common.h"
+
+typedef struct host_lcd_io *esp_lcd_panel_io_handle_t;
+typedef struct host_lcd_panel *esp_lcd_panel_handle_t;
+typedef intptr_t esp_lcd_spi_bus_handle_t;
+
+typedef struct {
+    int cs_gpio_num;
+    int dc_gpio_num;
+    int spi_mode;
+    unsigned int pclk_hz;
+    size_t trans_queue_depth;
+    void *on_color_trans_done;
+    void *user_ctx;
+    int lcd_cmd_bits;
+    int lcd_param_bits;
+} esp_lcd_panel_io_spi_config_t;
+
+esp_err_t esp_lcd_new_panel_io_spi(spi_host_device_t bus, const esp_lcd_panel_io_spi_config_t *io_config,
+                                   esp_lcd_panel_io_handle_t *ret_io);
+esp_err_t esp_lcd_panel_io_del(esp_lcd_panel_io_handle_t io);
+
+#endif // HOST_ESP_LCD_PANEL_IO_H
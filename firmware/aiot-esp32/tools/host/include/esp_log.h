@@ -0,0 +1,39 @@
+/**
+ * @file esp_log.h
+ * @brief 主机编译用的ESP_LOG宏（输出到stdout）
+ *
+ * 输出级别由 host_log_level 控制（默认INFO），基准测试时可调低以免日志影响计时。
+ */
+
+#ifndef HOST_ESP_LOG_H
+#define HOST_ESP_LOG_H
+
+#include <stdio.h>
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+// 弱定义：所有编译单元共享同一个变量，不需要额外链接mock库
+__attribute__((weak)) esp_log_level_t host_log_level = ESP_LOG_INFO;
+
+#define HOST_LOG(level, letter, tag, fmt, ...) do { \
+        if ((level) <= host_log_level) { \
+            printf(letter " (%s) " fmt "\n", tag, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define ESP_LOGE(tag, fmt, ...) HOST_LOG(ESP_LOG_ERROR, "E", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) HOST_LOG(ESP_LOG_WARN, "W", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) HOST_LOG(ESP_LOG_INFO, "I", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) HOST_LOG(ESP_LOG_DEBUG, "D", tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) HOST_LOG(ESP_LOG_VERBOSE, "V", tag, fmt, ##__VA_ARGS__)
+
+#define esp_log_level_set(tag, level) ((void)(tag), (void)(level))
+
+#endif // HOST_ESP_LOG_H
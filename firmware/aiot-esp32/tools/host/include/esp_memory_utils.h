@@ -0,0 +1,14 @@
+/**
+ * @file esp_memory_utils.h
+ * @brief 主机模拟：所有指针都视为常量区/内部RAM
+ */
+
+#ifndef HOST_ESP_MEMORY_UTILS_H
+#define HOST_ESP_MEMORY_UTILS_H
+
+#include <stdbool.h>
+
+static inline bool esp_ptr_in_drom(const void *p) { (void)p; return true; }
+static inline bool esp_ptr_in_dram(const void *p) { (void)p; return true; }
+
+#endif // HOST_ESP_MEMORY_UTILS_H
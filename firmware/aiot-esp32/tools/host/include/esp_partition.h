@@ -0,0 +1,55 @@
+/**
+ * @file esp_partition.h
+ * @brief 主机模拟：分区表为空（需要Flash的模块使用 flash_emu.h）
+ */
+
+#ifndef HOST_ESP_PARTITION_H
+#define HOST_ESP_PARTITION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum {
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01,
+} esp_partition_type_t;
+
+typedef int esp_partition_subtype_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    uint32_t erase_size;
+    char label[17];
+} esp_partition_t;
+
+static inline const esp_partition_t *esp_partition_find_first(esp_partition_type_t type,
+                                                              esp_partition_subtype_t subtype,
+                                                              const char *label)
+{
+    (void)type; (void)subtype; (void)label;
+    return NULL;
+}
+
+static inline esp_err_t esp_partition_read(const esp_partition_t *p, size_t off, void *dst, size_t size)
+{
+    (void)p; (void)off; (void)dst; (void)size;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+static inline esp_err_t esp_partition_write(const esp_partition_t *p, size_t off, const void *src, size_t size)
+{
+    (void)p; (void)off; (void)src; (void)size;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+static inline esp_err_t esp_partition_erase_range(const esp_partition_t *p, size_t off, size_t size)
+{
+    (void)p; (void)off; (void)size;
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif // HOST_ESP_PARTITION_H
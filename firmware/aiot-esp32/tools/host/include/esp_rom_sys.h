@@ -0,0 +1,11 @@
+/**
+ * @file esp_rom_sys.h
+ * @brief 主机模拟：见 rom/ets_sys.h
+ */
+
+#ifndef HOST_ESP_ROM_SYS_H
+#define HOST_ESP_ROM_SYS_H
+
+#include "rom/ets_sys.h"
+
+#endif // HOST_ESP_ROM_SYS_H
@@ -0,0 +1,16 @@
+/**
+ * @file esp_system.h
+ * @brief 主机模拟：堆统计与重启
+ */
+
+#ifndef HOST_ESP_SYSTEM_H
+#define HOST_ESP_SYSTEM_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+uint32_t esp_get_free_heap_size(void);
+uint32_t esp_get_minimum_free_heap_size(void);
+void esp_restart(void) __attribute__((noreturn));
+
+#endif // HOST_ESP_SYSTEM_H
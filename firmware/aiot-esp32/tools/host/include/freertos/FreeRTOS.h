@@ -0,0 +1,86 @@
+/**
+ * @file FreeRTOS.h
+ * @brief 主机模拟：FreeRTOS基础类型（POSIX线程实现，见 mock/freertos_posix.c）
+ *
+ * 时间相关接口（vTaskDelay、xTaskGetTickCount）使用虚拟时钟：
+ * 延时只推进虚拟时间不真正等待，保证模拟结果可复现、基准测试不受sleep影响。
+ */
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t StackType_t;
+
+#define pdTRUE                  1
+#define pdFALSE                 0
+#define pdPASS                  1
+#define pdFAIL                  0
+#define errQUEUE_FULL           0
+#define portMAX_DELAY           ((TickType_t)0xFFFFFFFFu)
+#define configTICK_RATE_HZ      1000
+#define portTICK_PERIOD_MS      (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define pdTICKS_TO_MS(t)        ((uint32_t)(((uint64_t)(t) * 1000) / configTICK_RATE_HZ))
+#define configMAX_PRIORITIES    25
+#define configMAX_TASK_NAME_LEN 16
+#define tskIDLE_PRIORITY        0
+#define tskNO_AFFINITY          0x7FFFFFFF
+#define portNUM_PROCESSORS      1
+
+#define configUSE_TRACE_FACILITY        0
+#define configGENERATE_RUN_TIME_STATS   0
+
+#ifndef BIT0
+#define BIT0    (1u << 0)
+#define BIT1    (1u << 1)
+#define BIT2    (1u << 2)
+#define BIT3    (1u << 3)
+#define BIT4    (1u << 4)
+#define BIT5    (1u << 5)
+#define BIT6    (1u << 6)
+#define BIT7    (1u << 7)
+#endif
+
+// 临界区：全局递归锁（模拟中不区分核）
+typedef struct {
+    int unused;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED    { 0 }
+
+void host_critical_enter(void);
+void host_critical_exit(void);
+
+#define portENTER_CRITICAL(mux)         ((void)(mux), host_critical_enter())
+#define portEXIT_CRITICAL(mux)          ((void)(mux), host_critical_exit())
+#define portENTER_CRITICAL_ISR(mux)     portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux)      portEXIT_CRITICAL(mux)
+#define portENTER_CRITICAL_SAFE(mux)    portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_SAFE(mux)     portEXIT_CRITICAL(mux)
+#define taskENTER_CRITICAL(mux)         portENTER_CRITICAL(mux)
+#define taskEXIT_CRITICAL(mux)          portEXIT_CRITICAL(mux)
+
+static inline UBaseType_t portSET_INTERRUPT_MASK_FROM_ISR(void)
+{
+    host_critical_enter();
+    return 0;
+}
+
+static inline void portCLEAR_INTERRUPT_MASK_FROM_ISR(UBaseType_t state)
+{
+    (void)state;
+    host_critical_exit();
+}
+
+#define portYIELD_FROM_ISR(...)     do { } while (0)
+#define xPortGetCoreID()            0
+#define xPortInIsrContext()         0
+
+#endif // HOST_FREERTOS_H
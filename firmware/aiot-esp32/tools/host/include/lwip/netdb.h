@@ -0,0 +1,11 @@
+/**
+ * @file netdb.h
+ * @brief 主机模拟：lwIP的getaddrinfo接口直接映射到主机解析器（探测测试走本机回环）
+ */
+
+#ifndef HOST_LWIP_NETDB_H
+#define HOST_LWIP_NETDB_H
+
+#include <netdb.h>
+
+#endif // HOST_LWIP_NETDB_H
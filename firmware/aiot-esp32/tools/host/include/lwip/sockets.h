@@ -0,0 +1,18 @@
+/**
+ * @file sockets.h
+ * @brief 主机模拟：lwIP的BSD socket接口直接映射到主机socket（UDP测试走本机回环）
+ */
+
+#ifndef HOST_LWIP_SOCKETS_H
+#define HOST_LWIP_SOCKETS_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#endif // HOST_LWIP_SOCKETS_H
@@ -0,0 +1,14 @@
+/**
+ * @file ets_sys.h
+ * @brief 主机模拟：微秒延时推进虚拟时钟，不真正等待
+ */
+
+#ifndef HOST_ETS_SYS_H
+#define HOST_ETS_SYS_H
+
+#include <stdint.h>
+
+void esp_rom_delay_us(uint32_t us);
+void ets_delay_us(uint32_t us);
+
+#endif // HOST_ETS_SYS_H
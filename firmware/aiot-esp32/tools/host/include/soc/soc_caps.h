@@ -0,0 +1,15 @@
+/**
+ * @file soc_caps.h
+ * @brief 主机模拟：芯片能力（只含用到的ADC项，按ESP32-S3）
+ */
+
+#ifndef HOST_SOC_SOC_CAPS_H
+#define HOST_SOC_SOC_CAPS_H
+
+#define SOC_ADC_DIGI_RESULT_BYTES           4
+#define SOC_ADC_DIGI_DATA_BYTES_PER_CONV    4
+#define SOC_ADC_DIGI_MAX_BITWIDTH           12
+#define SOC_ADC_SAMPLE_FREQ_THRES_HIGH      83333
+#define SOC_ADC_SAMPLE_FREQ_THRES_LOW       611
+
+#endif // HOST_SOC_SOC_CAPS_H
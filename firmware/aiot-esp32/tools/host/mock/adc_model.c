@@ -0,0 +1,253 @@
+/**
+ * @file adc_model.c
+ * @brief 主机模拟：ADC连续模式驱动（adc_continuous_* 接口）+ 曲线拟合标定
+ *
+ * 启动后按虚拟时间和采样率计算应当完成的转换数，读取时按转换序列逐个生成结果
+ * （TYPE2格式，电压取 host_adc_set_mv 设置的值，叠加可重复的均匀噪声），每次返回一帧。
+ * 未读取的转换超过驱动缓冲池容量时按 flush_pool 语义丢弃最旧的帧，
+ * 每丢一帧调用一次 on_pool_ovf。on_conv_done 不会被调用，运行时需用 manual_service。
+ *
+ * 标定按各衰减档的典型满量程线性换算，与运行时没有标定数据时的回退一致。
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_sim.h"
+#include "esp_adc/adc_continuous.h"
+#include "esp_adc/adc_cali_scheme.h"
+#include "soc/soc_caps.h"
+
+#define HOST_ADC_GPIOS      21
+#define HOST_ADC_RAW_MAX    4095
+#define HOST_ADC_PATTERN    10
+
+struct host_adc_continuous {
+    adc_continuous_handle_cfg_t cfg;
+    adc_digi_pattern_config_t pattern[HOST_ADC_PATTERN];
+    uint32_t pattern_num;
+    uint32_t freq_hz;
+    adc_continuous_evt_cbs_t cbs;
+    void *user_data;
+    bool running;
+    int64_t start_us;
+    uint64_t consumed;             ///< 已读出或丢弃的转换数
+};
+
+struct host_adc_cali {
+    adc_atten_t atten;
+};
+
+static float s_mv[HOST_ADC_GPIOS];
+static float s_noise_lsb;
+static uint32_t s_noise_state = 12345;
+
+void host_adc_set_mv(int gpio, float mv)
+{
+    if (gpio >= 0 && gpio < HOST_ADC_GPIOS) {
+        s_mv[gpio] = mv;
+    }
+}
+
+void host_adc_set_noise(float lsb)
+{
+    s_noise_lsb = lsb;
+}
+
+static float full_scale_mv(adc_atten_t atten)
+{
+    switch (atten) {
+    case ADC_ATTEN_DB_0:   return 950.0f;
+    case ADC_ATTEN_DB_2_5: return 1250.0f;
+    case ADC_ATTEN_DB_6:   return 1750.0f;
+    default:               return 3100.0f;
+    }
+}
+
+static float noise(void)
+{
+    s_noise_state = s_noise_state * 1664525u + 1013904223u;
+    float u = (float)(s_noise_state >> 8) / (float)(1u << 24);     // [0, 1)
+    return (2.0f * u - 1.0f) * s_noise_lsb;
+}
+
+static uint16_t convert(const adc_digi_pattern_config_t *p)
+{
+    int gpio = (p->unit == ADC_UNIT_1 ? 1 : 11) + p->channel;
+    float raw = s_mv[gpio] * HOST_ADC_RAW_MAX / full_scale_mv((adc_atten_t)p->atten) + noise();
+    long v = lroundf(raw);
+    if (v < 0) {
+        v = 0;
+    } else if (v > HOST_ADC_RAW_MAX) {
+        v = HOST_ADC_RAW_MAX;
+    }
+    return (uint16_t)v;
+}
+
+/* ==================== 连续模式驱动 ==================== */
+
+esp_err_t adc_continuous_new_handle(const adc_continuous_handle_cfg_t *hdl_config, adc_continuous_handle_t *ret_handle)
+{
+    if (!hdl_config || !ret_handle || hdl_config->conv_frame_size == 0 ||
+        hdl_config->conv_frame_size % SOC_ADC_DIGI_DATA_BYTES_PER_CONV != 0 ||
+        hdl_config->max_store_buf_size < hdl_config->conv_frame_size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct host_adc_continuous *h = calloc(1, sizeof(*h));
+    if (!h) {
+        return ESP_ERR_NO_MEM;
+    }
+    h->cfg = *hdl_config;
+    *ret_handle = h;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_config(adc_continuous_handle_t handle, const adc_continuous_config_t *config)
+{
+    if (!handle || !config || config->pattern_num == 0 || config->pattern_num > HOST_ADC_PATTERN ||
+        config->sample_freq_hz < SOC_ADC_SAMPLE_FREQ_THRES_LOW ||
+        config->sample_freq_hz > SOC_ADC_SAMPLE_FREQ_THRES_HIGH ||
+        config->format != ADC_DIGI_OUTPUT_FORMAT_TYPE2) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (handle->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    memcpy(handle->pattern, config->adc_pattern, config->pattern_num * sizeof(handle->pattern[0]));
+    handle->pattern_num = config->pattern_num;
+    handle->freq_hz = config->sample_freq_hz;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_register_event_callbacks(adc_continuous_handle_t handle, const adc_continuous_evt_cbs_t *cbs,
+                                                  void *user_data)
+{
+    if (!handle || !cbs) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    handle->cbs = *cbs;
+    handle->user_data = user_data;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_start(adc_continuous_handle_t handle)
+{
+    if (!handle || handle->pattern_num == 0 || handle->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    handle->running = true;
+    handle->start_us = host_sim_now_us();
+    handle->consumed = 0;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_read(adc_continuous_handle_t handle, uint8_t *buf, uint32_t length_max,
+                              uint32_t *out_length, uint32_t timeout_ms)
+{
+    (void)timeout_ms;
+    if (!handle || !buf || !out_length) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_length = 0;
+    if (!handle->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint64_t frame = handle->cfg.conv_frame_size / SOC_ADC_DIGI_RESULT_BYTES;
+    uint64_t pool = handle->cfg.max_store_buf_size / SOC_ADC_DIGI_RESULT_BYTES / frame * frame;
+    uint64_t due = (uint64_t)(host_sim_now_us() - handle->start_us) * handle->freq_hz / 1000000;
+    // 缓冲池满：丢弃最旧的整帧
+    while (due - handle->consumed > pool) {
+        handle->consumed += frame;
+        if (handle->cbs.on_pool_ovf) {
+            handle->cbs.on_pool_ovf(handle, NULL, handle->user_data);
+        }
+    }
+    if (due - handle->consumed < frame) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    uint32_t n = (uint32_t)frame;
+    if (n > length_max / SOC_ADC_DIGI_RESULT_BYTES) {
+        n = length_max / SOC_ADC_DIGI_RESULT_BYTES;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        const adc_digi_pattern_config_t *p = &handle->pattern[(handle->consumed + i) % handle->pattern_num];
+        adc_digi_output_data_t out = { .val = 0 };
+        out.type2.data = convert(p);
+        out.type2.channel = p->channel;
+        out.type2.unit = p->unit;
+        memcpy(&buf[i * SOC_ADC_DIGI_RESULT_BYTES], &out, SOC_ADC_DIGI_RESULT_BYTES);
+    }
+    handle->consumed += n;
+    *out_length = n * SOC_ADC_DIGI_RESULT_BYTES;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_stop(adc_continuous_handle_t handle)
+{
+    if (!handle || !handle->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    handle->running = false;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_deinit(adc_continuous_handle_t handle)
+{
+    if (!handle || handle->running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    free(handle);
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_io_to_channel(int io_num, adc_unit_t *unit_id, adc_channel_t *channel)
+{
+    if (!unit_id || !channel) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (io_num >= 1 && io_num <= 10) {
+        *unit_id = ADC_UNIT_1;
+        *channel = (adc_channel_t)(io_num - 1);
+        return ESP_OK;
+    }
+    if (io_num >= 11 && io_num <= 20) {
+        *unit_id = ADC_UNIT_2;
+        *channel = (adc_channel_t)(io_num - 11);
+        return ESP_OK;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+/* ==================== 标定 ==================== */
+
+esp_err_t adc_cali_create_scheme_curve_fitting(const adc_cali_curve_fitting_config_t *config,
+                                               adc_cali_handle_t *ret_handle)
+{
+    if (!config || !ret_handle) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct host_adc_cali *c = calloc(1, sizeof(*c));
+    if (!c) {
+        return ESP_ERR_NO_MEM;
+    }
+    c->atten = config->atten;
+    *ret_handle = c;
+    return ESP_OK;
+}
+
+esp_err_t adc_cali_delete_scheme_curve_fitting(adc_cali_handle_t handle)
+{
+    free(handle);
+    return ESP_OK;
+}
+
+esp_err_t adc_cali_raw_to_voltage(adc_cali_handle_t handle, int raw, int *voltage)
+{
+    if (!handle || !voltage || raw < 0 || raw > HOST_ADC_RAW_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *voltage = (int)lroundf(raw * full_scale_mv(handle->atten) / HOST_ADC_RAW_MAX);
+    return ESP_OK;
+}
@@ -0,0 +1,486 @@
+/**
+ * @file freertos_posix.c
+ * @brief 主机模拟：FreeRTOS接口的pthread实现
+ *
+ * - 任务：每个任务一个detached线程，优先级和绑核被忽略
+ * - 信号量/互斥锁/队列/事件组：pthread互斥锁+条件变量
+ * - 超时：按虚拟时钟计算，等待期间推进虚拟时钟（不真正睡眠），
+ *   单线程基准中带超时的等待会立即返回，结果可复现
+ * - 临界区：全局递归锁，所有portMUX共享
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_sim.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/event_groups.h"
+
+/* ==================== 临界区 ==================== */
+
+static pthread_mutex_t s_critical;
+static pthread_once_t s_critical_once = PTHREAD_ONCE_INIT;
+
+static void critical_init(void)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&s_critical, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+void host_critical_enter(void)
+{
+    pthread_once(&s_critical_once, critical_init);
+    pthread_mutex_lock(&s_critical);
+}
+
+void host_critical_exit(void)
+{
+    pthread_mutex_unlock(&s_critical);
+}
+
+/* ==================== 等待辅助 ==================== */
+
+// 条件不满足时的一步等待：先让出CPU给其他线程，再推进1个tick的虚拟时间。
+// 返回false表示已超时。
+static bool wait_step(pthread_mutex_t *lock, TickType_t ticks, TickType_t *waited)
+{
+    if (ticks != portMAX_DELAY && *waited >= ticks) {
+        return false;
+    }
+    pthread_mutex_unlock(lock);
+    sched_yield();
+    if (ticks != portMAX_DELAY) {
+        host_sim_advance_us(1000000 / configTICK_RATE_HZ);
+    }
+    (*waited)++;
+    pthread_mutex_lock(lock);
+    return true;
+}
+
+/* ==================== 任务 ==================== */
+
+struct host_task {
+    pthread_t thread;
+    TaskFunction_t fn;
+    void *arg;
+    char name[configMAX_TASK_NAME_LEN];
+    uint32_t stack_depth;
+    pthread_mutex_t lock;
+    uint32_t notify_count;
+};
+
+static __thread struct host_task *s_current_task = NULL;
+static struct host_task s_main_task = { .name = "main", .stack_depth = 12288,
+                                        .lock = PTHREAD_MUTEX_INITIALIZER };
+static volatile UBaseType_t s_task_count = 1;
+
+static void *task_entry(void *p)
+{
+    struct host_task *task = p;
+    s_current_task = task;
+    task->fn(task->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                                   void *arg, UBaseType_t priority, TaskHandle_t *out_handle,
+                                   BaseType_t core_id)
+{
+    (void)priority;
+    (void)core_id;
+    struct host_task *task = calloc(1, sizeof(*task));
+    if (!task) {
+        return pdFAIL;
+    }
+    task->fn = fn;
+    task->arg = arg;
+    task->stack_depth = stack_depth;
+    strncpy(task->name, name ? name : "", sizeof(task->name) - 1);
+    pthread_mutex_init(&task->lock, NULL);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int rc = pthread_create(&task->thread, &attr, task_entry, task);
+    pthread_attr_destroy(&attr);
+    if (rc != 0) {
+        free(task);
+        return pdFAIL;
+    }
+    __atomic_fetch_add(&s_task_count, 1, __ATOMIC_RELAXED);
+    if (out_handle) {
+        *out_handle = task;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *arg, UBaseType_t priority, TaskHandle_t *out_handle)
+{
+    return xTaskCreatePinnedToCore(fn, name, stack_depth, arg, priority, out_handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == NULL || task == s_current_task) {
+        __atomic_fetch_sub(&s_task_count, 1, __ATOMIC_RELAXED);
+        pthread_exit(NULL);
+    }
+    // 删除其他任务：模拟中只做计数，线程在自身循环结束时退出
+    __atomic_fetch_sub(&s_task_count, 1, __ATOMIC_RELAXED);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    host_sim_advance_us((int64_t)ticks * (1000000 / configTICK_RATE_HZ));
+    sched_yield();
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(host_sim_now_us() / (1000000 / configTICK_RATE_HZ));
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return s_current_task ? s_current_task : &s_main_task;
+}
+
+const char *pcTaskGetName(TaskHandle_t task)
+{
+    return (task ? task : xTaskGetCurrentTaskHandle())->name;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(void)
+{
+    return s_task_count;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    // 主机上无法测量任务栈，返回栈大小的一半作为占位
+    return (task ? task : xTaskGetCurrentTaskHandle())->stack_depth / 2;
+}
+
+void vTaskSuspendAll(void)
+{
+    host_critical_enter();
+}
+
+BaseType_t xTaskResumeAll(void)
+{
+    host_critical_exit();
+    return pdFALSE;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&task->lock);
+    task->notify_count++;
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken)
+{
+    xTaskNotifyGive(task);
+    if (woken) {
+        *woken = pdFALSE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    struct host_task *task = xTaskGetCurrentTaskHandle();
+    TickType_t waited = 0;
+    uint32_t value = 0;
+
+    pthread_mutex_lock(&task->lock);
+    while (task->notify_count == 0 && wait_step(&task->lock, ticks, &waited)) {
+    }
+    value = task->notify_count;
+    if (value) {
+        task->notify_count = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&task->lock);
+    return value;
+}
+
+/* ==================== 信号量 ==================== */
+
+struct host_semaphore {
+    pthread_mutex_t lock;
+    UBaseType_t count;
+    UBaseType_t max_count;
+    bool is_mutex;
+    pthread_t owner;
+    UBaseType_t recursion;
+};
+
+static SemaphoreHandle_t semaphore_create(UBaseType_t max_count, UBaseType_t initial, bool is_mutex)
+{
+    struct host_semaphore *sem = calloc(1, sizeof(*sem));
+    if (!sem) {
+        return NULL;
+    }
+    pthread_mutex_init(&sem->lock, NULL);
+    sem->count = initial;
+    sem->max_count = max_count;
+    sem->is_mutex = is_mutex;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return semaphore_create(1, 1, true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void)
+{
+    return semaphore_create(1, 1, true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return semaphore_create(1, 0, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial)
+{
+    return semaphore_create(max_count, initial, false);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    TickType_t waited = 0;
+    pthread_t self = pthread_self();
+
+    pthread_mutex_lock(&sem->lock);
+    // 互斥锁允许同一线程重入（同时覆盖recursive mutex的语义）
+    if (sem->is_mutex && sem->count == 0 && pthread_equal(sem->owner, self)) {
+        sem->recursion++;
+        pthread_mutex_unlock(&sem->lock);
+        return pdTRUE;
+    }
+    while (sem->count == 0) {
+        if (!wait_step(&sem->lock, ticks, &waited)) {
+            pthread_mutex_unlock(&sem->lock);
+            return pdFALSE;
+        }
+    }
+    sem->count--;
+    if (sem->is_mutex) {
+        sem->owner = self;
+        sem->recursion = 1;
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    BaseType_t ret = pdTRUE;
+    pthread_mutex_lock(&sem->lock);
+    if (sem->is_mutex && sem->recursion > 1) {
+        sem->recursion--;
+    } else if (sem->count < sem->max_count) {
+        sem->count++;
+        sem->recursion = 0;
+        memset(&sem->owner, 0, sizeof(sem->owner));
+    } else {
+        ret = pdFALSE;
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ret;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *woken)
+{
+    if (woken) {
+        *woken = pdFALSE;
+    }
+    return xSemaphoreGive(sem);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    if (sem) {
+        pthread_mutex_destroy(&sem->lock);
+        free(sem);
+    }
+}
+
+/* ==================== 队列 ==================== */
+
+struct host_queue {
+    pthread_mutex_t lock;
+    uint8_t *storage;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+    struct host_queue *q = calloc(1, sizeof(*q));
+    if (!q) {
+        return NULL;
+    }
+    q->storage = calloc(length, item_size);
+    if (!q->storage) {
+        free(q);
+        return NULL;
+    }
+    pthread_mutex_init(&q->lock, NULL);
+    q->length = length;
+    q->item_size = item_size;
+    return q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks)
+{
+    TickType_t waited = 0;
+    pthread_mutex_lock(&q->lock);
+    while (q->count == q->length) {
+        if (!wait_step(&q->lock, ticks, &waited)) {
+            pthread_mutex_unlock(&q->lock);
+            return errQUEUE_FULL;
+        }
+    }
+    UBaseType_t tail = (q->head + q->count) % q->length;
+    memcpy(q->storage + tail * q->item_size, item, q->item_size);
+    q->count++;
+    pthread_mutex_unlock(&q->lock);
+    return pdPASS;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t q, const void *item, BaseType_t *woken)
+{
+    if (woken) {
+        *woken = pdFALSE;
+    }
+    return xQueueSend(q, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks)
+{
+    TickType_t waited = 0;
+    pthread_mutex_lock(&q->lock);
+    while (q->count == 0) {
+        if (!wait_step(&q->lock, ticks, &waited)) {
+            pthread_mutex_unlock(&q->lock);
+            return pdFALSE;
+        }
+    }
+    memcpy(item, q->storage + q->head * q->item_size, q->item_size);
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    pthread_mutex_unlock(&q->lock);
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q)
+{
+    pthread_mutex_lock(&q->lock);
+    UBaseType_t n = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return n;
+}
+
+BaseType_t xQueueReset(QueueHandle_t q)
+{
+    pthread_mutex_lock(&q->lock);
+    q->head = 0;
+    q->count = 0;
+    pthread_mutex_unlock(&q->lock);
+    return pdPASS;
+}
+
+void vQueueDelete(QueueHandle_t q)
+{
+    if (q) {
+        pthread_mutex_destroy(&q->lock);
+        free(q->storage);
+        free(q);
+    }
+}
+
+/* ==================== 事件组 ==================== */
+
+struct host_event_group {
+    pthread_mutex_t lock;
+    EventBits_t bits;
+};
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    struct host_event_group *group = calloc(1, sizeof(*group));
+    if (group) {
+        pthread_mutex_init(&group->lock, NULL);
+    }
+    return group;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    pthread_mutex_lock(&group->lock);
+    group->bits |= bits;
+    EventBits_t ret = group->bits;
+    pthread_mutex_unlock(&group->lock);
+    return ret;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    pthread_mutex_lock(&group->lock);
+    EventBits_t ret = group->bits;
+    group->bits &= ~bits;
+    pthread_mutex_unlock(&group->lock);
+    return ret;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+{
+    pthread_mutex_lock(&group->lock);
+    EventBits_t ret = group->bits;
+    pthread_mutex_unlock(&group->lock);
+    return ret;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_all, TickType_t ticks)
+{
+    TickType_t waited = 0;
+    pthread_mutex_lock(&group->lock);
+    for (;;) {
+        EventBits_t match = group->bits & bits;
+        if (wait_all ? match == bits : match != 0) {
+            break;
+        }
+        if (!wait_step(&group->lock, ticks, &waited)) {
+            break;
+        }
+    }
+    EventBits_t ret = group->bits;
+    if (clear_on_exit && (wait_all ? (ret & bits) == bits : (ret & bits) != 0)) {
+        group->bits &= ~bits;
+    }
+    pthread_mutex_unlock(&group->lock);
+    return ret;
+}
+
+void vEventGroupDelete(EventGroupHandle_t group)
+{
+    if (group) {
+        pthread_mutex_destroy(&group->lock);
+        free(group);
+    }
+}
@@ -0,0 +1,859 @@
+/**
+ * @file host_sim.c
+ * @brief 主机模拟：虚拟时钟、esp_timer、GPIO、LEDC、SPI总线、WiFi、堆统计
+ */
+
+#include "host_sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "esp_wifi.h"
+#include "rom/ets_sys.h"
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "driver/spi_common.h"
+#include "freertos/FreeRTOS.h"
+
+#define SIM_TIMER_COUNT     16
+
+typedef struct {
+    gpio_mode_t mode;
+    int out_level;                 // gpio_set_level写入的电平
+    int in_level;                  // 外部输入电平（无模型时）
+    bool master_low;               // 开漏：主机当前是否拉低
+    host_sim_pin_model_t model;
+    bool has_model;
+    gpio_int_type_t intr_type;
+    bool intr_enabled;
+    gpio_isr_t isr;
+    void *isr_arg;
+    int last_level;                // 上次通知中断时的总线电平
+    bool in_isr;
+} sim_pin_t;
+
+typedef struct {
+    uint32_t duty;
+    uint32_t pending_duty;
+    int timer;
+    int gpio;
+    bool configured;
+    // 硬件渐变
+    uint32_t fade_from;
+    uint32_t fade_to;
+    int64_t fade_start_us;
+    int64_t fade_end_us;
+    bool fade_set;                 // ledc_set_fade_with_time之后、ledc_fade_start之前
+    bool fading;
+    uint32_t fade_count;           // 完成的渐变次数
+} sim_ledc_channel_t;
+
+static int64_t s_now_us = 0;
+static sim_pin_t s_pins[HOST_SIM_GPIO_COUNT];
+static uint32_t s_gpio_writes = 0;
+static sim_ledc_channel_t s_ledc[LEDC_CHANNEL_MAX];
+static uint32_t s_ledc_freq[LEDC_TIMER_MAX];
+// 渐变服务、渐变结束回调和渐变定时器在 host_sim_reset 后保留（与固件里只安装/登记一次一致）
+static bool s_ledc_fade_installed = false;
+static ledc_cb_t s_ledc_fade_cb[LEDC_CHANNEL_MAX];
+static void *s_ledc_fade_arg[LEDC_CHANNEL_MAX];
+static esp_timer_handle_t s_ledc_fade_timer[LEDC_CHANNEL_MAX];
+static bool s_spi_bus_used[3];
+static bool s_wifi_connected = true;
+static int8_t s_wifi_rssi = -55;
+static int s_edge_watch[4];         // 开了中断且挂有外设模型的引脚
+static int s_edge_watch_count = 0;
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    bool used;
+    bool active;
+    int64_t alarm_us;
+    int64_t period_us;              // 0为单次
+};
+
+static struct esp_timer s_timers[SIM_TIMER_COUNT];
+static pthread_mutex_t s_timer_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread bool s_in_timer_cb = false;
+
+static void pin_watch_update(int pin);
+static void pins_step_edges(void);
+
+/* ==================== 虚拟时钟 ==================== */
+
+int64_t host_sim_now_us(void)
+{
+    return __atomic_load_n(&s_now_us, __ATOMIC_RELAXED);
+}
+
+/** 推进到 target_us（有引脚在等边沿中断时逐微秒推进） */
+static void clock_advance_to(int64_t target_us)
+{
+    int64_t us = target_us - host_sim_now_us();
+    if (us <= 0) {
+        return;
+    }
+    if (s_edge_watch_count == 0) {
+        __atomic_fetch_add(&s_now_us, us, __ATOMIC_RELAXED);
+        return;
+    }
+    // 有引脚在等边沿中断时逐微秒推进，外设模型的电平变化按发生时刻触发中断
+    for (int64_t i = 0; i < us; i++) {
+        __atomic_fetch_add(&s_now_us, 1, __ATOMIC_RELAXED);
+        pins_step_edges();
+    }
+}
+
+static bool timers_fire_next(int64_t target_us);
+
+void host_sim_advance_us(int64_t us)
+{
+    if (us <= 0) {
+        return;
+    }
+    int64_t target = host_sim_now_us() + us;
+    // 到期的esp_timer按到期时刻依次触发，回调看到的是到期时的虚拟时间
+    while (timers_fire_next(target)) {
+    }
+    clock_advance_to(target);
+}
+
+void host_sim_reset(void)
+{
+    s_now_us = 0;
+    // 定时器句柄保留，只停止运行（持有句柄的模块下次需要时重新启动）
+    pthread_mutex_lock(&s_timer_lock);
+    for (int i = 0; i < SIM_TIMER_COUNT; i++) {
+        s_timers[i].active = false;
+    }
+    pthread_mutex_unlock(&s_timer_lock);
+    memset(s_pins, 0, sizeof(s_pins));
+    s_edge_watch_count = 0;
+    for (int i = 0; i < HOST_SIM_GPIO_COUNT; i++) {
+        s_pins[i].in_level = 1;
+    }
+    memset(s_ledc, 0, sizeof(s_ledc));
+    memset(s_ledc_freq, 0, sizeof(s_ledc_freq));
+    memset(s_spi_bus_used, 0, sizeof(s_spi_bus_used));
+    s_gpio_writes = 0;
+    s_wifi_connected = true;
+    s_wifi_rssi = -55;
+}
+
+// 输入引脚默认上拉为高
+static void __attribute__((constructor)) host_sim_boot(void)
+{
+    host_sim_reset();
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return host_sim_now_us();
+}
+
+/* ==================== esp_timer ==================== */
+
+/**
+ * @brief 触发一个在 target_us 之前到期的定时器（时钟先推进到到期时刻）
+ */
+static bool timers_fire_next(int64_t target_us)
+{
+    // 回调里再推进时钟（vTaskDelay等）时不嵌套触发
+    if (s_in_timer_cb) {
+        return false;
+    }
+
+    pthread_mutex_lock(&s_timer_lock);
+    struct esp_timer *next = NULL;
+    for (int i = 0; i < SIM_TIMER_COUNT; i++) {
+        struct esp_timer *t = &s_timers[i];
+        if (t->used && t->active && t->alarm_us <= target_us && (!next || t->alarm_us < next->alarm_us)) {
+            next = t;
+        }
+    }
+    if (!next) {
+        pthread_mutex_unlock(&s_timer_lock);
+        return false;
+    }
+    int64_t alarm = next->alarm_us;
+    if (next->period_us > 0) {
+        next->alarm_us += next->period_us;
+    } else {
+        next->active = false;
+    }
+    esp_timer_cb_t cb = next->callback;
+    void *arg = next->arg;
+    pthread_mutex_unlock(&s_timer_lock);
+
+    clock_advance_to(alarm);
+    s_in_timer_cb = true;
+    cb(arg);
+    s_in_timer_cb = false;
+    return true;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle)
+{
+    if (!create_args || !create_args->callback || !out_handle) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&s_timer_lock);
+    for (int i = 0; i < SIM_TIMER_COUNT; i++) {
+        if (!s_timers[i].used) {
+            s_timers[i] = (struct esp_timer){
+                .callback = create_args->callback,
+                .arg = create_args->arg,
+                .used = true,
+            };
+            *out_handle = &s_timers[i];
+            pthread_mutex_unlock(&s_timer_lock);
+            return ESP_OK;
+        }
+    }
+    pthread_mutex_unlock(&s_timer_lock);
+    return ESP_ERR_NO_MEM;
+}
+
+static esp_err_t timer_start(esp_timer_handle_t timer, uint64_t us, bool periodic)
+{
+    if (!timer || !timer->used || (periodic && us == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&s_timer_lock);
+    if (timer->active) {
+        pthread_mutex_unlock(&s_timer_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = true;
+    timer->alarm_us = host_sim_now_us() + (int64_t)us;
+    timer->period_us = periodic ? (int64_t)us : 0;
+    pthread_mutex_unlock(&s_timer_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    return timer_start(timer, timeout_us, false);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+    return timer_start(timer, period, true);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (!timer || !timer->used) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&s_timer_lock);
+    bool was_active = timer->active;
+    timer->active = false;
+    pthread_mutex_unlock(&s_timer_lock);
+    return was_active ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    if (!timer || !timer->used) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&s_timer_lock);
+    timer->used = false;
+    timer->active = false;
+    pthread_mutex_unlock(&s_timer_lock);
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer)
+{
+    return timer && timer->used && timer->active;
+}
+
+void esp_rom_delay_us(uint32_t us)
+{
+    host_sim_advance_us(us);
+}
+
+void ets_delay_us(uint32_t us)
+{
+    host_sim_advance_us(us);
+}
+
+/* ==================== GPIO ==================== */
+
+static sim_pin_t *pin_get(gpio_num_t gpio_num)
+{
+    if (gpio_num < 0 || gpio_num >= HOST_SIM_GPIO_COUNT) {
+        return NULL;
+    }
+    return &s_pins[gpio_num];
+}
+
+static bool mode_has_output(gpio_mode_t mode)
+{
+    return (mode & GPIO_MODE_OUTPUT) != 0;
+}
+
+static int pin_bus_level(sim_pin_t *p)
+{
+    if (p->master_low) {
+        return 0;
+    }
+    if (p->has_model && p->model.sample) {
+        return p->model.sample(p->model.ctx, host_sim_now_us());
+    }
+    if (p->mode == GPIO_MODE_OUTPUT || p->mode == GPIO_MODE_INPUT_OUTPUT) {
+        return p->out_level;
+    }
+    return p->in_level;
+}
+
+// 中断模拟：总线电平与上次不同即视为一个边沿。外设模型引起的变化
+// 只有在驱动读取电平时才能发现，驱动读位时是忙等轮询，误差在1us量级
+static void pin_check_edge(sim_pin_t *p)
+{
+    if (!p->isr || !p->intr_enabled || p->intr_type == GPIO_INTR_DISABLE || p->in_isr) {
+        return;
+    }
+    int level = pin_bus_level(p);
+    if (level == p->last_level) {
+        return;
+    }
+    p->last_level = level;
+    if (p->intr_type == GPIO_INTR_ANYEDGE ||
+        (p->intr_type == GPIO_INTR_POSEDGE && level) ||
+        (p->intr_type == GPIO_INTR_NEGEDGE && !level)) {
+        p->in_isr = true;
+        p->isr(p->isr_arg);
+        p->in_isr = false;
+    }
+}
+
+static void pin_watch_update(int pin)
+{
+    sim_pin_t *p = &s_pins[pin];
+    bool watch = p->isr && p->intr_enabled && p->has_model;
+    int idx = -1;
+    for (int i = 0; i < s_edge_watch_count; i++) {
+        if (s_edge_watch[i] == pin) {
+            idx = i;
+        }
+    }
+    if (watch && idx < 0 && s_edge_watch_count < (int)(sizeof(s_edge_watch) / sizeof(s_edge_watch[0]))) {
+        s_edge_watch[s_edge_watch_count++] = pin;
+    } else if (!watch && idx >= 0) {
+        s_edge_watch[idx] = s_edge_watch[--s_edge_watch_count];
+    }
+}
+
+static void pins_step_edges(void)
+{
+    for (int i = 0; i < s_edge_watch_count; i++) {
+        pin_check_edge(&s_pins[s_edge_watch[i]]);
+    }
+}
+
+// 开漏/输入引脚：主机输出低电平时拉低总线，状态变化时通知外设模型
+static void pin_update_drive(sim_pin_t *pin)
+{
+    bool low = mode_has_output(pin->mode) && pin->out_level == 0;
+    if (low != pin->master_low) {
+        pin->master_low = low;
+        if (pin->has_model && pin->model.on_drive) {
+            pin->model.on_drive(pin->model.ctx, host_sim_now_us(), low);
+        }
+    }
+    pin_check_edge(pin);
+}
+
+void host_sim_gpio_attach(int pin, const host_sim_pin_model_t *model)
+{
+    sim_pin_t *p = pin_get((gpio_num_t)pin);
+    if (!p) {
+        return;
+    }
+    if (model) {
+        p->model = *model;
+        p->has_model = true;
+    } else {
+        memset(&p->model, 0, sizeof(p->model));
+        p->has_model = false;
+    }
+    pin_watch_update(pin);
+}
+
+int host_sim_gpio_output(int pin)
+{
+    sim_pin_t *p = pin_get((gpio_num_t)pin);
+    return p ? p->out_level : 0;
+}
+
+void host_sim_gpio_set_input(int pin, int level)
+{
+    sim_pin_t *p = pin_get((gpio_num_t)pin);
+    if (p) {
+        p->in_level = level ? 1 : 0;
+        pin_check_edge(p);
+    }
+}
+
+uint32_t host_sim_gpio_write_count(void)
+{
+    return s_gpio_writes;
+}
+
+esp_err_t gpio_config(const gpio_config_t *config)
+{
+    if (!config || config->pin_bit_mask == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < HOST_SIM_GPIO_COUNT; i++) {
+        if (config->pin_bit_mask & (1ULL << i)) {
+            if (!GPIO_IS_VALID_GPIO(i)) {
+                return ESP_ERR_INVALID_ARG;
+            }
+            s_pins[i].mode = config->mode;
+            s_pins[i].intr_type = config->intr_type;
+            pin_update_drive(&s_pins[i]);
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num)
+{
+    sim_pin_t *p = pin_get(gpio_num);
+    if (!p) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    p->mode = GPIO_MODE_DISABLE;
+    p->out_level = 0;
+    pin_update_drive(p);
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode)
+{
+    sim_pin_t *p = pin_get(gpio_num);
+    if (!p) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    p->mode = mode;
+    pin_update_drive(p);
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    sim_pin_t *p = pin_get(gpio_num);
+    if (!p) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    p->out_level = level ? 1 : 0;
+    s_gpio_writes++;
+    pin_update_drive(p);
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+    sim_pin_t *p = pin_get(gpio_num);
+    if (!p) {
+        return 0;
+    }
+    pin_check_edge(p);
+    return pin_bus_level(p);
+}
+
+esp_err_t gpio_set_pull_mode(gpio_num_t gpio_num, gpio_pull_mode_t pull)
+{
+    (void)pull;
+    return pin_get(gpio_num) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type)
+{
+    sim_pin_t *p = pin_get(gpio_num);
+    if (!p) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    p->intr_type = intr_type;
+    return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service(int flags)
+{
+    (void)flags;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args)
+{
+    sim_pin_t *p = pin_get(gpio_num);
+    if (!p || !isr_handler) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    p->isr = isr_handler;
+    p->isr_arg = args;
+    p->last_level = pin_bus_level(p);
+    pin_watch_update(gpio_num);
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num)
+{
+    sim_pin_t *p = pin_get(gpio_num);
+    if (!p) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    p->isr = NULL;
+    p->isr_arg = NULL;
+    pin_watch_update(gpio_num);
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num)
+{
+    sim_pin_t *p = pin_get(gpio_num);
+    if (!p) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!p->intr_enabled) {
+        p->intr_enabled = true;
+        p->last_level = pin_bus_level(p);
+    }
+    pin_watch_update(gpio_num);
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num)
+{
+    sim_pin_t *p = pin_get(gpio_num);
+    if (!p) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    p->intr_enabled = false;
+    pin_watch_update(gpio_num);
+    return ESP_OK;
+}
+
+/* ==================== LEDC ==================== */
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *timer_conf)
+{
+    if (!timer_conf || timer_conf->timer_num >= LEDC_TIMER_MAX ||
+        timer_conf->duty_resolution == 0 || timer_conf->duty_resolution >= LEDC_TIMER_BIT_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // 与硬件一致：时钟源80MHz，频率*2^分辨率不能超过时钟
+    if ((uint64_t)timer_conf->freq_hz << timer_conf->duty_resolution > 80000000ULL) {
+        return ESP_FAIL;
+    }
+    s_ledc_freq[timer_conf->timer_num] = timer_conf->freq_hz;
+    return ESP_OK;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t *ledc_conf)
+{
+    if (!ledc_conf || ledc_conf->channel >= LEDC_CHANNEL_MAX || ledc_conf->timer_sel >= LEDC_TIMER_MAX ||
+        !GPIO_IS_VALID_OUTPUT_GPIO(ledc_conf->gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_ledc_channel_t *ch = &s_ledc[ledc_conf->channel];
+    ch->timer = ledc_conf->timer_sel;
+    ch->gpio = ledc_conf->gpio_num;
+    ch->duty = ledc_conf->duty;
+    ch->pending_duty = ledc_conf->duty;
+    ch->configured = true;
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t duty)
+{
+    if (speed_mode >= LEDC_SPEED_MODE_MAX || channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_ledc[channel].configured) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_ledc[channel].pending_duty = duty;
+    return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t speed_mode, ledc_channel_t channel)
+{
+    if (speed_mode >= LEDC_SPEED_MODE_MAX || channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_ledc[channel].configured) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_ledc[channel].duty = s_ledc[channel].pending_duty;
+    return ESP_OK;
+}
+
+/** 通道当前输出的占空比（渐变中按虚拟时间线性插值） */
+static uint32_t ledc_current_duty(const sim_ledc_channel_t *ch)
+{
+    if (!ch->fading) {
+        return ch->duty;
+    }
+    int64_t span = ch->fade_end_us - ch->fade_start_us;
+    int64_t t = host_sim_now_us() - ch->fade_start_us;
+    if (t >= span) {
+        return ch->fade_to;
+    }
+    int64_t delta = (int64_t)ch->fade_to - (int64_t)ch->fade_from;
+    return (uint32_t)((int64_t)ch->fade_from + delta * t / span);
+}
+
+uint32_t ledc_get_duty(ledc_mode_t speed_mode, ledc_channel_t channel)
+{
+    (void)speed_mode;
+    return channel < LEDC_CHANNEL_MAX ? ledc_current_duty(&s_ledc[channel]) : 0;
+}
+
+esp_err_t ledc_set_freq(ledc_mode_t speed_mode, ledc_timer_t timer_num, uint32_t freq_hz)
+{
+    if (speed_mode >= LEDC_SPEED_MODE_MAX || timer_num >= LEDC_TIMER_MAX || freq_hz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_ledc_freq[timer_num] = freq_hz;
+    return ESP_OK;
+}
+
+uint32_t ledc_get_freq(ledc_mode_t speed_mode, ledc_timer_t timer_num)
+{
+    (void)speed_mode;
+    return timer_num < LEDC_TIMER_MAX ? s_ledc_freq[timer_num] : 0;
+}
+
+esp_err_t ledc_stop(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t idle_level)
+{
+    (void)idle_level;
+    if (speed_mode >= LEDC_SPEED_MODE_MAX || channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_ledc[channel].duty = 0;
+    return ESP_OK;
+}
+
+/** 渐变到时：占空比落到目标值，调用渐变结束回调（固件里在中断上下文） */
+static void ledc_fade_done(void *arg)
+{
+    int channel = (int)(intptr_t)arg;
+    sim_ledc_channel_t *ch = &s_ledc[channel];
+    if (!ch->fading) {
+        return;
+    }
+    ch->fading = false;
+    ch->duty = ch->fade_to;
+    ch->pending_duty = ch->fade_to;
+    ch->fade_count++;
+    if (s_ledc_fade_cb[channel]) {
+        ledc_cb_param_t param = {
+            .event = LEDC_FADE_END_EVT,
+            .speed_mode = LEDC_LOW_SPEED_MODE,
+            .channel = (uint32_t)channel,
+            .duty = ch->duty,
+        };
+        s_ledc_fade_cb[channel](&param, s_ledc_fade_arg[channel]);
+    }
+}
+
+esp_err_t ledc_fade_func_install(int intr_alloc_flags)
+{
+    (void)intr_alloc_flags;
+    s_ledc_fade_installed = true;
+    return ESP_OK;
+}
+
+void ledc_fade_func_uninstall(void)
+{
+    s_ledc_fade_installed = false;
+}
+
+esp_err_t ledc_set_fade_with_time(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t target_duty, int max_fade_time_ms)
+{
+    if (speed_mode >= LEDC_SPEED_MODE_MAX || channel >= LEDC_CHANNEL_MAX || max_fade_time_ms < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_ledc_channel_t *ch = &s_ledc[channel];
+    if (!s_ledc_fade_installed || !ch->configured || ch->fading) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!s_ledc_fade_timer[channel]) {
+        const esp_timer_create_args_t args = {
+            .callback = ledc_fade_done,
+            .arg = (void *)(intptr_t)channel,
+            .name = "ledc_fade",
+        };
+        esp_err_t ret = esp_timer_create(&args, &s_ledc_fade_timer[channel]);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    ch->fade_from = ch->duty;
+    ch->fade_to = target_duty;
+    ch->fade_end_us = (int64_t)max_fade_time_ms * 1000;    // 先记时长，ledc_fade_start时换算为时刻
+    ch->fade_set = true;
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_start(ledc_mode_t speed_mode, ledc_channel_t channel, ledc_fade_mode_t fade_mode)
+{
+    if (speed_mode >= LEDC_SPEED_MODE_MAX || channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_ledc_channel_t *ch = &s_ledc[channel];
+    if (!ch->fade_set || ch->fading) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    int64_t span = ch->fade_end_us;
+    ch->fade_set = false;
+    ch->fading = true;
+    ch->fade_start_us = host_sim_now_us();
+    ch->fade_end_us = ch->fade_start_us + span;
+    esp_timer_start_once(s_ledc_fade_timer[channel], (uint64_t)span);
+    if (fade_mode == LEDC_FADE_WAIT_DONE) {
+        host_sim_advance_us(span);
+    }
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_stop(ledc_mode_t speed_mode, ledc_channel_t channel)
+{
+    if (speed_mode >= LEDC_SPEED_MODE_MAX || channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim_ledc_channel_t *ch = &s_ledc[channel];
+    if (ch->fading) {
+        // 停在当前值，不调用渐变结束回调
+        ch->duty = ledc_current_duty(ch);
+        ch->pending_duty = ch->duty;
+        ch->fading = false;
+        esp_timer_stop(s_ledc_fade_timer[channel]);
+    }
+    ch->fade_set = false;
+    return ESP_OK;
+}
+
+esp_err_t ledc_cb_register(ledc_mode_t speed_mode, ledc_channel_t channel, ledc_cbs_t *cbs, void *user_arg)
+{
+    if (speed_mode >= LEDC_SPEED_MODE_MAX || channel >= LEDC_CHANNEL_MAX || !cbs) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_ledc_fade_installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_ledc_fade_cb[channel] = cbs->fade_cb;
+    s_ledc_fade_arg[channel] = user_arg;
+    return ESP_OK;
+}
+
+uint32_t host_sim_ledc_duty(int channel)
+{
+    return (channel >= 0 && channel < LEDC_CHANNEL_MAX) ? ledc_current_duty(&s_ledc[channel]) : 0;
+}
+
+uint32_t host_sim_ledc_fade_count(int channel)
+{
+    return (channel >= 0 && channel < LEDC_CHANNEL_MAX) ? s_ledc[channel].fade_count : 0;
+}
+
+uint32_t host_sim_ledc_freq(int channel)
+{
+    if (channel < 0 || channel >= LEDC_CHANNEL_MAX || !s_ledc[channel].configured) {
+        return 0;
+    }
+    return s_ledc_freq[s_ledc[channel].timer];
+}
+
+/* ==================== SPI ==================== */
+
+esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t *config, spi_dma_chan_t dma)
+{
+    (void)dma;
+    if (!config || host > SPI3_HOST) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_spi_bus_used[host]) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_spi_bus_used[host] = true;
+    return ESP_OK;
+}
+
+esp_err_t spi_bus_free(spi_host_device_t host)
+{
+    if (host > SPI3_HOST || !s_spi_bus_used[host]) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_spi_bus_used[host] = false;
+    return ESP_OK;
+}
+
+/* ==================== WiFi ==================== */
+
+void host_sim_wifi_set(bool connected, int8_t rssi)
+{
+    s_wifi_connected = connected;
+    s_wifi_rssi = rssi;
+}
+
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *ap_info)
+{
+    if (!ap_info) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_wifi_connected) {
+        return ESP_ERR_WIFI_NOT_CONNECT;
+    }
+    memset(ap_info, 0, sizeof(*ap_info));
+    memcpy(ap_info->ssid, "host-sim", sizeof("host-sim"));
+    ap_info->primary = 6;
+    ap_info->rssi = s_wifi_rssi;
+    return ESP_OK;
+}
+
+/* ==================== 系统 ==================== */
+
+// 堆统计取ESP32-S3典型值（内部RAM），模拟中不跟踪真实分配
+uint32_t esp_get_free_heap_size(void)
+{
+    return 180 * 1024;
+}
+
+uint32_t esp_get_minimum_free_heap_size(void)
+{
+    return 150 * 1024;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    (void)caps;
+    return esp_get_free_heap_size();
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+    (void)caps;
+    return 110 * 1024;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps)
+{
+    (void)caps;
+    return esp_get_minimum_free_heap_size();
+}
+
+void esp_restart(void)
+{
+    fprintf(stderr, "esp_restart() called in host simulation\n");
+    exit(1);
+}
@@ -0,0 +1,341 @@
+/**
+ * @file host_sim.h
+ * @brief 主机模拟环境控制接口
+ *
+ * tools/host/include 下的ESP-IDF头文件只声明接口，实现都在本目录：
+ * - host_sim.c：虚拟时钟、GPIO电平与引脚模型、LEDC、WiFi状态、堆统计
+ * - freertos_posix.c：FreeRTOS任务/信号量/队列/事件组（pthread）
+ * - mqtt_broker.c：进程内MQTT broker，esp_mqtt_client_* 连接到这里
+ * - lcd_panel_model.c：ST7789面板模型（帧缓冲区 + SPI传输时间估算）
+ * - i2c_bus_model.c：I2C主机驱动 + 寄存器文件设备模型（按SCL频率推进虚拟时钟）
+ * - sensor_models.c：DHT11单总线、DS18B20 1-Wire时序模型，MPU6050 FIFO模型（挂在I2C模型上），
+ *   HC-SR04回波模型（挂在MCPWM模型上）
+ * - adc_model.c：ADC连续模式驱动 + 标定（按虚拟时间和采样率产生DMA帧）
+ * - mcpwm_model.c：MCPWM定时器/生成器（周期性TRIG脉冲）+ 捕获通道
+ *
+ * 虚拟时钟：esp_timer_get_time() 返回虚拟时间，vTaskDelay/esp_rom_delay_us
+ * 只推进虚拟时间不真正等待。因此传感器的位时序完全按协议走一遍，
+ * 但750ms的温度转换不会拖慢模拟；基准测试测量的是真实CPU时间。
+ * esp_timer 定时器在时钟推进经过到期时刻时，在推进时钟的线程中按到期顺序调用回调。
+ */
+
+#ifndef HOST_SIM_H
+#define HOST_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ==================== 虚拟时钟 ==================== */
+
+/**
+ * @brief 当前虚拟时间（微秒）
+ */
+int64_t host_sim_now_us(void);
+
+/**
+ * @brief 推进虚拟时间
+ */
+void host_sim_advance_us(int64_t us);
+
+/**
+ * @brief 复位模拟环境（时钟归零、GPIO/LEDC恢复默认、断开引脚模型）
+ */
+void host_sim_reset(void);
+
+/* ==================== GPIO ==================== */
+
+/*
+ * GPIO中断：gpio_isr_handler_add + gpio_intr_enable 后，引脚电平变化且符合
+ * intr_type时同步调用处理函数。主机侧写引脚、外部输入时立即检测；挂有外设
+ * 模型的引脚开中断期间，虚拟时钟逐微秒推进，模型的电平变化在发生时刻触发。
+ */
+#define HOST_SIM_GPIO_COUNT     49
+
+/**
+ * @brief 挂在引脚上的外设模型
+ *
+ * 总线为开漏+上拉：主机输出低电平时总线为低，否则由外设决定（released返回1）。
+ */
+typedef struct {
+    /**
+     * @brief 主机拉低/释放总线时调用
+     * @param ctx 模型上下文
+     * @param now_us 虚拟时间
+     * @param master_low true=主机拉低，false=主机释放
+     */
+    void (*on_drive)(void *ctx, int64_t now_us, bool master_low);
+    /**
+     * @brief 主机释放总线时外设输出的电平
+     * @return int 0=外设拉低，1=释放（上拉为高）
+     */
+    int (*sample)(void *ctx, int64_t now_us);
+    void *ctx;
+} host_sim_pin_model_t;
+
+/**
+ * @brief 在引脚上挂接外设模型（NULL表示断开）
+ */
+void host_sim_gpio_attach(int pin, const host_sim_pin_model_t *model);
+
+/**
+ * @brief 读取主机输出的电平（推挽输出引脚，如LED、继电器）
+ */
+int host_sim_gpio_output(int pin);
+
+/**
+ * @brief 外部驱动输入引脚电平（按键等），未挂模型时生效
+ */
+void host_sim_gpio_set_input(int pin, int level);
+
+/**
+ * @brief gpio_set_level 调用次数（所有引脚合计）
+ */
+uint32_t host_sim_gpio_write_count(void);
+
+/* ==================== LEDC ==================== */
+
+/**
+ * @brief 通道当前生效的占空比（ledc_update_duty之后；硬件渐变中按虚拟时间线性插值）
+ */
+uint32_t host_sim_ledc_duty(int channel);
+
+/**
+ * @brief 通道完成的硬件渐变次数（ledc_fade_start 到期一次计一次）
+ */
+uint32_t host_sim_ledc_fade_count(int channel);
+
+/**
+ * @brief 通道所用定时器的频率
+ */
+uint32_t host_sim_ledc_freq(int channel);
+
+/* ==================== WiFi ==================== */
+
+/**
+ * @brief 设置STA连接状态（默认已连接，RSSI=-55）
+ */
+void host_sim_wifi_set(bool connected, int8_t rssi);
+
+/* ==================== MQTT broker ==================== */
+
+/**
+ * @brief 设备发布消息时的旁路回调（用于检查设备响应）
+ */
+typedef void (*host_mqtt_tap_t)(const char *topic, const char *data, int len, int qos, void *ctx);
+
+/**
+ * @brief 设置broker往返延迟（虚拟时间，默认20ms）
+ */
+void host_mqtt_set_latency_us(int64_t latency_us);
+
+/**
+ * @brief 设置发布旁路回调
+ */
+void host_mqtt_set_tap(host_mqtt_tap_t tap, void *ctx);
+
+/**
+ * @brief 模拟云端向主题发布一条消息（投递给订阅了该主题的客户端）
+ */
+esp_err_t host_mqtt_inject(const char *topic, const char *data, int len);
+
+/**
+ * @brief 投递所有排队的事件（CONNECTED/SUBSCRIBED/PUBLISHED/DATA）
+ *
+ * 事件按到期时间投递，必要时推进虚拟时钟；事件回调中新产生的事件
+ * 也会在本次调用中投递。
+ *
+ * @return size_t 投递的事件数
+ */
+size_t host_mqtt_pump(void);
+
+/**
+ * @brief 模拟连接断开（随后自动重连）
+ */
+void host_mqtt_drop_connection(void);
+
+/**
+ * @brief broker统计
+ */
+typedef struct {
+    uint32_t published;            ///< 设备发布的消息数
+    uint32_t delivered;            ///< 投递给设备的消息数
+    uint32_t events;               ///< 投递的事件总数
+    uint64_t bytes_out;            ///< 设备发布的负载字节数
+} host_mqtt_stats_t;
+
+void host_mqtt_get_stats(host_mqtt_stats_t *stats);
+
+/* ==================== LCD ==================== */
+
+/**
+ * @brief 面板模型统计
+ */
+typedef struct {
+    uint32_t draw_calls;           ///< draw_bitmap调用次数
+    uint64_t pixels;               ///< 写入的像素数
+    uint64_t spi_bytes;            ///< SPI传输字节数（含命令和窗口设置）
+    uint64_t spi_time_us;          ///< 按配置的SPI时钟估算的传输时间
+} host_lcd_stats_t;
+
+void host_lcd_get_stats(host_lcd_stats_t *stats);
+void host_lcd_reset_stats(void);
+
+/**
+ * @brief 读取模拟帧缓冲区中的像素（RGB565，面板坐标）
+ */
+uint16_t host_lcd_pixel(int x, int y);
+
+/* ==================== I2C ==================== */
+
+/**
+ * @brief I2C总线模型统计
+ */
+typedef struct {
+    uint32_t transactions;         ///< i2c_master_* 传输次数
+    uint32_t nacks;                ///< 地址无应答次数
+    uint64_t bytes;                ///< 总线上的字节数（含地址字节）
+    uint64_t bus_time_us;          ///< 按设备SCL频率估算的总线时间
+} host_i2c_stats_t;
+
+/**
+ * @brief 在I2C端口上挂接寄存器文件设备（256字节，寄存器指针自动递增）
+ */
+esp_err_t host_i2c_attach(int port, uint16_t addr);
+void host_i2c_detach_all(void);
+
+/**
+ * @brief 读写设备寄存器（不经过总线，不计时）
+ */
+esp_err_t host_i2c_set_regs(int port, uint16_t addr, uint8_t reg, const uint8_t *data, size_t len);
+esp_err_t host_i2c_get_regs(int port, uint16_t addr, uint8_t reg, uint8_t *data, size_t len);
+
+/**
+ * @brief 有内部状态的设备模型的回调（在传输中调用，此时虚拟时钟已推进到传输结束）
+ */
+typedef struct {
+    /**
+     * @brief 从寄存器reg开始读len字节
+     * @return true=已填写buf，false=按寄存器文件读取
+     */
+    bool (*on_read)(void *ctx, uint8_t reg, uint8_t *buf, size_t len);
+    /**
+     * @brief 从寄存器reg开始写入了len字节（寄存器文件已更新）
+     */
+    void (*on_write)(void *ctx, uint8_t reg, const uint8_t *data, size_t len);
+    void *ctx;
+} host_i2c_hooks_t;
+
+/**
+ * @brief 设置设备回调（NULL表示取消）
+ */
+esp_err_t host_i2c_set_hooks(int port, uint16_t addr, const host_i2c_hooks_t *hooks);
+
+void host_i2c_get_stats(host_i2c_stats_t *stats);
+void host_i2c_reset_stats(void);
+
+/* ==================== ADC ==================== */
+
+/**
+ * @brief 设置引脚上的输入电压（默认0mV）
+ *
+ * 引脚与通道的对应按ESP32-S3：GPIO1~10 为 ADC1_CH0~9，GPIO11~20 为 ADC2_CH0~9。
+ */
+void host_adc_set_mv(int gpio, float mv);
+
+/**
+ * @brief 设置叠加在每个转换结果上的均匀噪声幅度（±lsb，默认0）
+ *
+ * 噪声由固定种子的伪随机序列产生，结果可重复。
+ */
+void host_adc_set_noise(float lsb);
+
+/* ==================== MCPWM ==================== */
+
+/**
+ * @brief 生成器输出脉冲的旁路回调（计数器归零拉高、比较事件拉低的生成器每周期一次）
+ *
+ * @param gpio 生成器引脚
+ * @param width_us 脉冲宽度
+ */
+typedef void (*host_mcpwm_pulse_hook_t)(void *ctx, int gpio, uint32_t width_us);
+
+void host_mcpwm_set_pulse_hook(host_mcpwm_pulse_hook_t hook, void *ctx);
+
+/**
+ * @brief 在引脚上产生一个边沿，同步调用该引脚上已使能捕获通道的 on_cap
+ *
+ * 捕获计数按80MHz取虚拟时间。
+ */
+void host_mcpwm_capture(int gpio, bool rising);
+
+/* ==================== 传感器模型 ==================== */
+
+/**
+ * @brief 在引脚上挂接DHT11模型
+ *
+ * @param pin 数据引脚
+ * @param temp_x10 温度（0.1°C）
+ * @param humi_x10 湿度（0.1%）
+ */
+void host_sensor_dht11_attach(int pin, int16_t temp_x10, uint16_t humi_x10);
+void host_sensor_dht11_set(int16_t temp_x10, uint16_t humi_x10);
+
+/**
+ * @brief 在引脚上挂接DS18B20模型
+ *
+ * @param pin 数据引脚
+ * @param temp_x16 温度（1/16°C，与DS18B20寄存器格式相同）
+ */
+void host_sensor_ds18b20_attach(int pin, int16_t temp_x16);
+void host_sensor_ds18b20_set(int16_t temp_x16);
+
+/**
+ * @brief 在I2C端口上挂接MPU6050模型（WHO_AM_I=0x68）
+ *
+ * 按 SMPLRT_DIV 配置的采样率随虚拟时间产生加速度样本，FIFO_EN 选中加速度计且
+ * USER_CTRL 使能FIFO后写入1024字节的FIFO；FIFO满后丢弃最旧的字节，FIFO_COUNT 读数为1024。
+ * 默认静止（Z轴1g）。
+ */
+esp_err_t host_sensor_mpu6050_attach(int port, uint16_t addr);
+
+/**
+ * @brief 在某一轴上叠加正弦振动（amp_g=0 取消）
+ *
+ * @param axis 0=X 1=Y 2=Z
+ */
+void host_sensor_mpu6050_set_vibration(int axis, float freq_hz, float amp_g);
+
+/**
+ * @brief FIFO溢出（满后继续写入）的次数
+ */
+uint32_t host_sensor_mpu6050_overflows(void);
+
+/**
+ * @brief 挂接HC-SR04模型（默认目标100cm、气温20°C）
+ *
+ * 收到TRIG引脚上不短于10us的MCPWM脉冲后，450us时ECHO上升沿，
+ * 再经过按气温声速计算的往返时间出现下降沿；回波期间的TRIG被忽略。
+ */
+void host_sensor_hcsr04_attach(int trig, int echo);
+
+/**
+ * @brief 设置目标距离和空气温度（distance_cm<=0 表示没有目标，回波约38ms）
+ */
+void host_sensor_hcsr04_set(float distance_cm, float air_temp_c);
+
+/**
+ * @brief 每n个回波注入一个宽度为1/3的杂散回波（0=不注入）
+ */
+void host_sensor_hcsr04_set_glitch_every(uint32_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SIM_H
@@ -0,0 +1,277 @@
+/**
+ * @file i2c_bus_model.c
+ * @brief 主机模拟：I2C主机驱动（i2c_master_* 接口）+ 寄存器文件设备模型
+ *
+ * 挂在总线上的设备是256字节的寄存器文件，寄存器指针自动递增（与BH1750之外的大多数
+ * 传感器和SSD1306的数据写入一致）：写传输的第一个字节设置指针，其余字节依次写入；
+ * 读传输从指针处依次读出。没有挂设备的地址不应答，传输返回 ESP_FAIL。
+ *
+ * 每次传输按设备的SCL频率估算总线时间（起始/停止 + 每字节9位，含地址字节），
+ * 并推进虚拟时钟，总线管理层测得的占用率与真实总线一致。
+ *
+ * 有内部状态的设备（如带FIFO的MPU6050）通过 host_i2c_set_hooks 接管部分寄存器的读取，
+ * 并在寄存器被写入时得到通知，其余寄存器仍按寄存器文件处理。
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "host_sim.h"
+#include "driver/i2c_master.h"
+
+#define HOST_I2C_PORTS          4
+#define HOST_I2C_MAX_DEVICES    16
+
+typedef struct {
+    bool used;
+    int port;
+    uint16_t addr;
+    uint8_t pointer;
+    uint8_t regs[256];
+    host_i2c_hooks_t hooks;
+} i2c_model_t;
+
+struct host_i2c_bus {
+    int port;
+};
+
+struct host_i2c_dev {
+    struct host_i2c_bus *bus;
+    uint16_t addr;
+    uint32_t scl_hz;
+};
+
+static struct host_i2c_bus *s_ports[HOST_I2C_PORTS];
+static i2c_model_t s_models[HOST_I2C_MAX_DEVICES];
+static host_i2c_stats_t s_stats;
+
+static i2c_model_t *find_model(int port, uint16_t addr)
+{
+    for (int i = 0; i < HOST_I2C_MAX_DEVICES; i++) {
+        if (s_models[i].used && s_models[i].port == port && s_models[i].addr == addr) {
+            return &s_models[i];
+        }
+    }
+    return NULL;
+}
+
+// 一个字节占9个SCL周期（8位 + 应答）；start/stop/重复起始各按1个周期
+static void bus_time(const struct host_i2c_dev *dev, uint32_t bits, size_t bytes)
+{
+    int64_t us = ((int64_t)bits * 1000000 + dev->scl_hz - 1) / dev->scl_hz;
+    s_stats.transactions++;
+    s_stats.bytes += bytes;
+    s_stats.bus_time_us += (uint64_t)us;
+    host_sim_advance_us(us);
+}
+
+static void model_write(i2c_model_t *m, const uint8_t *data, size_t len)
+{
+    m->pointer = data[0];
+    for (size_t i = 1; i < len; i++) {
+        m->regs[m->pointer++] = data[i];
+    }
+    if (m->hooks.on_write && len > 1) {
+        m->hooks.on_write(m->hooks.ctx, data[0], data + 1, len - 1);
+    }
+}
+
+static void model_read(i2c_model_t *m, uint8_t *buf, size_t len)
+{
+    if (m->hooks.on_read && m->hooks.on_read(m->hooks.ctx, m->pointer, buf, len)) {
+        return;
+    }
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = m->regs[m->pointer++];
+    }
+}
+
+/* ==================== 驱动接口 ==================== */
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t *bus_config, i2c_master_bus_handle_t *ret_bus_handle)
+{
+    if (!bus_config || !ret_bus_handle || bus_config->i2c_port < 0 || bus_config->i2c_port >= HOST_I2C_PORTS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_ports[bus_config->i2c_port]) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    struct host_i2c_bus *bus = calloc(1, sizeof(*bus));
+    if (!bus) {
+        return ESP_ERR_NO_MEM;
+    }
+    bus->port = bus_config->i2c_port;
+    s_ports[bus->port] = bus;
+    *ret_bus_handle = bus;
+    return ESP_OK;
+}
+
+esp_err_t i2c_del_master_bus(i2c_master_bus_handle_t bus_handle)
+{
+    if (!bus_handle) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    s_ports[bus_handle->port] = NULL;
+    free(bus_handle);
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus_handle, const i2c_device_config_t *dev_config,
+                                    i2c_master_dev_handle_t *ret_handle)
+{
+    if (!bus_handle || !dev_config || !ret_handle || dev_config->scl_speed_hz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct host_i2c_dev *dev = calloc(1, sizeof(*dev));
+    if (!dev) {
+        return ESP_ERR_NO_MEM;
+    }
+    dev->bus = bus_handle;
+    dev->addr = dev_config->device_address;
+    dev->scl_hz = dev_config->scl_speed_hz;
+    *ret_handle = dev;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_rm_device(i2c_master_dev_handle_t handle)
+{
+    free(handle);
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t i2c_dev, const uint8_t *write_buffer, size_t write_size,
+                              int xfer_timeout_ms)
+{
+    (void)xfer_timeout_ms;
+    if (!i2c_dev || !write_buffer || write_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    i2c_model_t *m = find_model(i2c_dev->bus->port, i2c_dev->addr);
+    if (!m) {
+        bus_time(i2c_dev, 1 + 9 + 1, 1);       // 地址字节无应答后停止
+        s_stats.nacks++;
+        return ESP_FAIL;
+    }
+    bus_time(i2c_dev, 1 + 9 * (1 + (uint32_t)write_size) + 1, 1 + write_size);
+    model_write(m, write_buffer, write_size);
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_transmit_receive(i2c_master_dev_handle_t i2c_dev, const uint8_t *write_buffer,
+                                      size_t write_size, uint8_t *read_buffer, size_t read_size,
+                                      int xfer_timeout_ms)
+{
+    (void)xfer_timeout_ms;
+    if (!i2c_dev || !write_buffer || write_size == 0 || !read_buffer || read_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    i2c_model_t *m = find_model(i2c_dev->bus->port, i2c_dev->addr);
+    if (!m) {
+        bus_time(i2c_dev, 1 + 9 + 1, 1);
+        s_stats.nacks++;
+        return ESP_FAIL;
+    }
+    bus_time(i2c_dev, 1 + 9 * (1 + (uint32_t)write_size) + 1 + 9 * (1 + (uint32_t)read_size) + 1,
+             2 + write_size + read_size);
+    model_write(m, write_buffer, write_size);
+    model_read(m, read_buffer, read_size);
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_receive(i2c_master_dev_handle_t i2c_dev, uint8_t *read_buffer, size_t read_size,
+                             int xfer_timeout_ms)
+{
+    (void)xfer_timeout_ms;
+    if (!i2c_dev || !read_buffer || read_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    i2c_model_t *m = find_model(i2c_dev->bus->port, i2c_dev->addr);
+    if (!m) {
+        bus_time(i2c_dev, 1 + 9 + 1, 1);
+        s_stats.nacks++;
+        return ESP_FAIL;
+    }
+    bus_time(i2c_dev, 1 + 9 * (1 + (uint32_t)read_size) + 1, 1 + read_size);
+    model_read(m, read_buffer, read_size);
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_probe(i2c_master_bus_handle_t bus_handle, uint16_t address, int xfer_timeout_ms)
+{
+    (void)xfer_timeout_ms;
+    if (!bus_handle) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return find_model(bus_handle->port, address) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+/* ==================== 模型控制 ==================== */
+
+esp_err_t host_i2c_attach(int port, uint16_t addr)
+{
+    if (find_model(port, addr)) {
+        return ESP_OK;
+    }
+    for (int i = 0; i < HOST_I2C_MAX_DEVICES; i++) {
+        if (!s_models[i].used) {
+            memset(&s_models[i], 0, sizeof(s_models[i]));
+            s_models[i].used = true;
+            s_models[i].port = port;
+            s_models[i].addr = addr;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+void host_i2c_detach_all(void)
+{
+    memset(s_models, 0, sizeof(s_models));
+}
+
+esp_err_t host_i2c_set_regs(int port, uint16_t addr, uint8_t reg, const uint8_t *data, size_t len)
+{
+    i2c_model_t *m = find_model(port, addr);
+    if (!m) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    for (size_t i = 0; i < len; i++) {
+        m->regs[(uint8_t)(reg + i)] = data[i];
+    }
+    return ESP_OK;
+}
+
+esp_err_t host_i2c_set_hooks(int port, uint16_t addr, const host_i2c_hooks_t *hooks)
+{
+    i2c_model_t *m = find_model(port, addr);
+    if (!m) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (hooks) {
+        m->hooks = *hooks;
+    } else {
+        memset(&m->hooks, 0, sizeof(m->hooks));
+    }
+    return ESP_OK;
+}
+
+esp_err_t host_i2c_get_regs(int port, uint16_t addr, uint8_t reg, uint8_t *data, size_t len)
+{
+    i2c_model_t *m = find_model(port, addr);
+    if (!m) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    for (size_t i = 0; i < len; i++) {
+        data[i] = m->regs[(uint8_t)(reg + i)];
+    }
+    return ESP_OK;
+}
+
+void host_i2c_get_stats(host_i2c_stats_t *stats)
+{
+    *stats = s_stats;
+}
+
+void host_i2c_reset_stats(void)
+{
+    memset(&s_stats, 0, sizeof(s_stats));
+}
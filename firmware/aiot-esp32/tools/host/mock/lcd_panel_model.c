@@ -0,0 +1,188 @@
+/**
+ * @file lcd_panel_model.c
+ * @brief 主机模拟：ST7789面板（esp_lcd_panel_* 接口）
+ *
+ * draw_bitmap把像素写入控制器GRAM模型（240x320），并按真实SPI传输统计字节数：
+ * 每次调用 = CASET(1+4) + RASET(1+4) + RAMWR(1) + 像素数据，
+ * 再按面板IO配置的pclk_hz估算总线时间（spi_time_us），作为显示刷新耗时的下限。
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "host_sim.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_lcd_panel_vendor.h"
+
+#define PANEL_WIDTH         240
+#define PANEL_HEIGHT        320     // ST7789控制器GRAM为240x320
+#define PANEL_CMD_BYTES     11      // CASET/RASET/RAMWR 命令及参数
+
+struct host_lcd_io {
+    unsigned int pclk_hz;
+};
+
+struct host_lcd_panel {
+    struct host_lcd_io *io;
+    int bits_per_pixel;
+    bool swap_xy;
+    bool mirror_x;
+    bool mirror_y;
+    bool on;
+};
+
+static uint16_t s_framebuffer[PANEL_WIDTH * PANEL_HEIGHT];
+static host_lcd_stats_t s_stats;
+
+esp_err_t esp_lcd_new_panel_io_spi(spi_host_device_t bus, const esp_lcd_panel_io_spi_config_t *io_config,
+                                   esp_lcd_panel_io_handle_t *ret_io)
+{
+    (void)bus;
+    if (!io_config || !ret_io || io_config->pclk_hz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct host_lcd_io *io = calloc(1, sizeof(*io));
+    if (!io) {
+        return ESP_ERR_NO_MEM;
+    }
+    io->pclk_hz = io_config->pclk_hz;
+    *ret_io = io;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_del(esp_lcd_panel_io_handle_t io)
+{
+    free(io);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_new_panel_st7789(esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *panel_dev_config,
+                                   esp_lcd_panel_handle_t *ret_panel)
+{
+    if (!io || !panel_dev_config || !ret_panel || panel_dev_config->bits_per_pixel != 16) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct host_lcd_panel *panel = calloc(1, sizeof(*panel));
+    if (!panel) {
+        return ESP_ERR_NO_MEM;
+    }
+    panel->io = io;
+    panel->bits_per_pixel = panel_dev_config->bits_per_pixel;
+    *ret_panel = panel;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_reset(esp_lcd_panel_handle_t panel)
+{
+    return panel ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_lcd_panel_init(esp_lcd_panel_handle_t panel)
+{
+    if (!panel) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(s_framebuffer, 0, sizeof(s_framebuffer));
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_del(esp_lcd_panel_handle_t panel)
+{
+    free(panel);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start,
+                                    int x_end, int y_end, const void *color_data)
+{
+    if (!panel || !color_data || x_start >= x_end || y_start >= y_end) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int max_x = panel->swap_xy ? PANEL_HEIGHT : PANEL_WIDTH;
+    int max_y = panel->swap_xy ? PANEL_WIDTH : PANEL_HEIGHT;
+    if (x_start < 0 || y_start < 0 || x_end > max_x || y_end > max_y) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    const uint16_t *src = color_data;
+    int w = x_end - x_start;
+    for (int y = y_start; y < y_end; y++) {
+        // 逻辑坐标按swap_xy映射到GRAM，镜像只影响扫描方向，不改变像素数量
+        for (int x = x_start; x < x_end; x++) {
+            int gx = panel->swap_xy ? y : x;
+            int gy = panel->swap_xy ? x : y;
+            if (gx < PANEL_WIDTH && gy < PANEL_HEIGHT) {
+                s_framebuffer[gy * PANEL_WIDTH + gx] = src[(y - y_start) * w + (x - x_start)];
+            }
+        }
+    }
+
+    uint64_t pixels = (uint64_t)w * (y_end - y_start);
+    uint64_t bytes = PANEL_CMD_BYTES + pixels * (panel->bits_per_pixel / 8);
+    s_stats.draw_calls++;
+    s_stats.pixels += pixels;
+    s_stats.spi_bytes += bytes;
+    s_stats.spi_time_us += bytes * 8 * 1000000ULL / panel->io->pclk_hz;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_mirror(esp_lcd_panel_handle_t panel, bool mirror_x, bool mirror_y)
+{
+    if (!panel) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    panel->mirror_x = mirror_x;
+    panel->mirror_y = mirror_y;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_swap_xy(esp_lcd_panel_handle_t panel, bool swap_axes)
+{
+    if (!panel) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    panel->swap_xy = swap_axes;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_set_gap(esp_lcd_panel_handle_t panel, int x_gap, int y_gap)
+{
+    (void)x_gap;
+    (void)y_gap;
+    return panel ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_lcd_panel_invert_color(esp_lcd_panel_handle_t panel, bool invert_color_data)
+{
+    (void)invert_color_data;
+    return panel ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_lcd_panel_disp_on_off(esp_lcd_panel_handle_t panel, bool on_off)
+{
+    if (!panel) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    panel->on = on_off;
+    return ESP_OK;
+}
+
+void host_lcd_get_stats(host_lcd_stats_t *stats)
+{
+    if (stats) {
+        *stats = s_stats;
+    }
+}
+
+void host_lcd_reset_stats(void)
+{
+    memset(&s_stats, 0, sizeof(s_stats));
+}
+
+uint16_t host_lcd_pixel(int x, int y)
+{
+    if (x < 0 || y < 0 || x >= PANEL_WIDTH || y >= PANEL_HEIGHT) {
+        return 0;
+    }
+    return s_framebuffer[y * PANEL_WIDTH + x];
+}
@@ -0,0 +1,434 @@
+/**
+ * @file mcpwm_model.c
+ * @brief 主机模拟：MCPWM驱动（mcpwm_* 接口）
+ *
+ * 只模拟测距用到的部分：
+ * - 定时器启动后用周期esp_timer表示计数器归零（TEZ）事件；生成器配置为
+ *   TEZ拉高、比较事件拉低时，每个周期向脉冲旁路（host_mcpwm_set_pulse_hook）
+ *   报告一次 引脚 + 脉宽，外设模型据此响应；
+ * - 捕获定时器按80MHz自由计数（虚拟时间 × 80，32位回绕），外设模型调用
+ *   host_mcpwm_capture 产生边沿时，同步调用对应捕获通道的 on_cap。
+ */
+
+#include <stdlib.h>
+#include "host_sim.h"
+#include "esp_timer.h"
+#include "driver/mcpwm_prelude.h"
+
+#define HOST_MCPWM_CAP_RESOLUTION_HZ    80000000
+#define HOST_MCPWM_CAP_CHANNELS         3
+
+struct host_mcpwm_timer {
+    mcpwm_timer_config_t cfg;
+    bool enabled;
+    esp_timer_handle_t tez_timer;
+    struct host_mcpwm_oper *oper;
+};
+
+struct host_mcpwm_oper {
+    struct host_mcpwm_timer *timer;
+    struct host_mcpwm_cmpr *cmpr;
+    struct host_mcpwm_gen *gen;
+};
+
+struct host_mcpwm_cmpr {
+    struct host_mcpwm_oper *oper;
+    uint32_t ticks;
+};
+
+struct host_mcpwm_gen {
+    struct host_mcpwm_oper *oper;
+    int gpio;
+    mcpwm_generator_action_t on_tez;
+    mcpwm_cmpr_handle_t low_cmpr;           ///< 比较事件拉低时对应的比较器
+};
+
+struct host_mcpwm_cap_timer {
+    bool enabled;
+    bool running;
+};
+
+struct host_mcpwm_cap_channel {
+    struct host_mcpwm_cap_timer *timer;
+    mcpwm_capture_channel_config_t cfg;
+    mcpwm_capture_event_callbacks_t cbs;
+    void *user_data;
+    bool enabled;
+};
+
+static struct host_mcpwm_cap_channel *s_cap_channels[HOST_MCPWM_CAP_CHANNELS];
+static host_mcpwm_pulse_hook_t s_pulse_hook;
+static void *s_pulse_ctx;
+
+void host_mcpwm_set_pulse_hook(host_mcpwm_pulse_hook_t hook, void *ctx)
+{
+    s_pulse_hook = hook;
+    s_pulse_ctx = ctx;
+}
+
+void host_mcpwm_capture(int gpio, bool rising)
+{
+    mcpwm_capture_event_data_t edata = {
+        .cap_value = (uint32_t)((uint64_t)host_sim_now_us() * (HOST_MCPWM_CAP_RESOLUTION_HZ / 1000000)),
+        .cap_edge = rising ? MCPWM_CAP_EDGE_POS : MCPWM_CAP_EDGE_NEG,
+    };
+    for (int i = 0; i < HOST_MCPWM_CAP_CHANNELS; i++) {
+        struct host_mcpwm_cap_channel *ch = s_cap_channels[i];
+        if (!ch || ch->cfg.gpio_num != gpio || !ch->enabled || !ch->timer->running || !ch->cbs.on_cap) {
+            continue;
+        }
+        if ((rising && !ch->cfg.flags.pos_edge) || (!rising && !ch->cfg.flags.neg_edge)) {
+            continue;
+        }
+        ch->cbs.on_cap(ch, &edata, ch->user_data);
+    }
+}
+
+/* ==================== 定时器/操作器/比较器/生成器 ==================== */
+
+static void tez_cb(void *arg)
+{
+    struct host_mcpwm_timer *timer = arg;
+    struct host_mcpwm_oper *oper = timer->oper;
+    if (!oper || !oper->gen || !s_pulse_hook) {
+        return;
+    }
+    struct host_mcpwm_gen *gen = oper->gen;
+    if (gen->on_tez != MCPWM_GEN_ACTION_HIGH || !gen->low_cmpr) {
+        return;
+    }
+    uint32_t width_us = (uint32_t)((uint64_t)gen->low_cmpr->ticks * 1000000 / timer->cfg.resolution_hz);
+    s_pulse_hook(s_pulse_ctx, gen->gpio, width_us);
+}
+
+esp_err_t mcpwm_new_timer(const mcpwm_timer_config_t *config, mcpwm_timer_handle_t *ret_timer)
+{
+    if (!config || !ret_timer || config->resolution_hz == 0 || config->period_ticks == 0 ||
+        config->period_ticks > 0xFFFF) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct host_mcpwm_timer *t = calloc(1, sizeof(*t));
+    if (!t) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_timer_create_args_t args = {
+        .callback = tez_cb,
+        .arg = t,
+        .name = "mcpwm_tez",
+    };
+    if (esp_timer_create(&args, &t->tez_timer) != ESP_OK) {
+        free(t);
+        return ESP_ERR_NOT_FOUND;
+    }
+    t->cfg = *config;
+    *ret_timer = t;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_timer_enable(mcpwm_timer_handle_t timer)
+{
+    if (!timer || timer->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_timer_disable(mcpwm_timer_handle_t timer)
+{
+    if (!timer || !timer->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_timer_stop(timer->tez_timer);
+    timer->enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_timer_start_stop(mcpwm_timer_handle_t timer, mcpwm_timer_start_stop_cmd_t command)
+{
+    if (!timer || !timer->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (command == MCPWM_TIMER_START_NO_STOP) {
+        uint64_t period_us = (uint64_t)timer->cfg.period_ticks * 1000000 / timer->cfg.resolution_hz;
+        esp_timer_stop(timer->tez_timer);
+        return esp_timer_start_periodic(timer->tez_timer, period_us);
+    }
+    esp_timer_stop(timer->tez_timer);
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_del_timer(mcpwm_timer_handle_t timer)
+{
+    if (!timer || timer->enabled || timer->oper) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_timer_delete(timer->tez_timer);
+    free(timer);
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_new_operator(const mcpwm_operator_config_t *config, mcpwm_oper_handle_t *ret_oper)
+{
+    if (!config || !ret_oper) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct host_mcpwm_oper *o = calloc(1, sizeof(*o));
+    if (!o) {
+        return ESP_ERR_NO_MEM;
+    }
+    *ret_oper = o;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_operator_connect_timer(mcpwm_oper_handle_t oper, mcpwm_timer_handle_t timer)
+{
+    if (!oper || !timer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    oper->timer = timer;
+    timer->oper = oper;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_del_operator(mcpwm_oper_handle_t oper)
+{
+    if (!oper || oper->cmpr || oper->gen) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (oper->timer) {
+        oper->timer->oper = NULL;
+    }
+    free(oper);
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_new_comparator(mcpwm_oper_handle_t oper, const mcpwm_comparator_config_t *config,
+                               mcpwm_cmpr_handle_t *ret_cmpr)
+{
+    if (!oper || !config || !ret_cmpr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (oper->cmpr) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    struct host_mcpwm_cmpr *c = calloc(1, sizeof(*c));
+    if (!c) {
+        return ESP_ERR_NO_MEM;
+    }
+    c->oper = oper;
+    oper->cmpr = c;
+    *ret_cmpr = c;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_comparator_set_compare_value(mcpwm_cmpr_handle_t cmpr, uint32_t cmp_ticks)
+{
+    if (!cmpr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (cmpr->oper->timer && cmp_ticks >= cmpr->oper->timer->cfg.period_ticks) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    cmpr->ticks = cmp_ticks;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_del_comparator(mcpwm_cmpr_handle_t cmpr)
+{
+    if (!cmpr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    cmpr->oper->cmpr = NULL;
+    free(cmpr);
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_new_generator(mcpwm_oper_handle_t oper, const mcpwm_generator_config_t *config,
+                              mcpwm_gen_handle_t *ret_gen)
+{
+    if (!oper || !config || !ret_gen || config->gen_gpio_num < 0 || config->gen_gpio_num >= HOST_SIM_GPIO_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (oper->gen) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    struct host_mcpwm_gen *g = calloc(1, sizeof(*g));
+    if (!g) {
+        return ESP_ERR_NO_MEM;
+    }
+    g->oper = oper;
+    g->gpio = config->gen_gpio_num;
+    oper->gen = g;
+    *ret_gen = g;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_generator_set_action_on_timer_event(mcpwm_gen_handle_t gen, mcpwm_gen_timer_event_action_t ev_act)
+{
+    if (!gen) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (ev_act.event == MCPWM_TIMER_EVENT_EMPTY) {
+        gen->on_tez = ev_act.action;
+    }
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_generator_set_action_on_compare_event(mcpwm_gen_handle_t gen, mcpwm_gen_compare_event_action_t ev_act)
+{
+    if (!gen || !ev_act.comparator || ev_act.comparator->oper != gen->oper) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    gen->low_cmpr = ev_act.action == MCPWM_GEN_ACTION_LOW ? ev_act.comparator : NULL;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_del_generator(mcpwm_gen_handle_t gen)
+{
+    if (!gen) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    gen->oper->gen = NULL;
+    free(gen);
+    return ESP_OK;
+}
+
+/* ==================== 捕获 ==================== */
+
+esp_err_t mcpwm_new_capture_timer(const mcpwm_capture_timer_config_t *config, mcpwm_cap_timer_handle_t *ret_cap_timer)
+{
+    if (!config || !ret_cap_timer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    struct host_mcpwm_cap_timer *t = calloc(1, sizeof(*t));
+    if (!t) {
+        return ESP_ERR_NO_MEM;
+    }
+    *ret_cap_timer = t;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_timer_enable(mcpwm_cap_timer_handle_t cap_timer)
+{
+    if (!cap_timer || cap_timer->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    cap_timer->enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_timer_disable(mcpwm_cap_timer_handle_t cap_timer)
+{
+    if (!cap_timer || !cap_timer->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    cap_timer->enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_timer_start(mcpwm_cap_timer_handle_t cap_timer)
+{
+    if (!cap_timer || !cap_timer->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    cap_timer->running = true;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_timer_stop(mcpwm_cap_timer_handle_t cap_timer)
+{
+    if (!cap_timer || !cap_timer->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    cap_timer->running = false;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_timer_get_resolution(mcpwm_cap_timer_handle_t cap_timer, uint32_t *out_resolution)
+{
+    if (!cap_timer || !out_resolution) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out_resolution = HOST_MCPWM_CAP_RESOLUTION_HZ;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_del_capture_timer(mcpwm_cap_timer_handle_t cap_timer)
+{
+    if (!cap_timer || cap_timer->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    free(cap_timer);
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_new_capture_channel(mcpwm_cap_timer_handle_t cap_timer, const mcpwm_capture_channel_config_t *config,
+                                    mcpwm_cap_channel_handle_t *ret_cap_channel)
+{
+    if (!cap_timer || !config || !ret_cap_channel || config->gpio_num < 0 ||
+        config->gpio_num >= HOST_SIM_GPIO_COUNT || config->prescale == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < HOST_MCPWM_CAP_CHANNELS; i++) {
+        if (s_cap_channels[i]) {
+            continue;
+        }
+        struct host_mcpwm_cap_channel *ch = calloc(1, sizeof(*ch));
+        if (!ch) {
+            return ESP_ERR_NO_MEM;
+        }
+        ch->timer = cap_timer;
+        ch->cfg = *config;
+        s_cap_channels[i] = ch;
+        *ret_cap_channel = ch;
+        return ESP_OK;
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t mcpwm_capture_channel_register_event_callbacks(mcpwm_cap_channel_handle_t cap_channel,
+                                                         const mcpwm_capture_event_callbacks_t *cbs, void *user_data)
+{
+    if (!cap_channel || !cbs) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (cap_channel->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    cap_channel->cbs = *cbs;
+    cap_channel->user_data = user_data;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_channel_enable(mcpwm_cap_channel_handle_t cap_channel)
+{
+    if (!cap_channel || cap_channel->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    cap_channel->enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_channel_disable(mcpwm_cap_channel_handle_t cap_channel)
+{
+    if (!cap_channel || !cap_channel->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    cap_channel->enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t mcpwm_del_capture_channel(mcpwm_cap_channel_handle_t cap_channel)
+{
+    if (!cap_channel || cap_channel->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (int i = 0; i < HOST_MCPWM_CAP_CHANNELS; i++) {
+        if (s_cap_channels[i] == cap_channel) {
+            s_cap_channels[i] = NULL;
+        }
+    }
+    free(cap_channel);
+    return ESP_OK;
+}
@@ -0,0 +1,412 @@
+/**
+ * @file mqtt_broker.c
+ * @brief 主机模拟：进程内MQTT broker + esp_mqtt_client_* 接口
+ *
+ * 设备侧代码（main/mqtt/aiot_mqtt_client.c）照常调用esp-mqtt接口，
+ * 所有连接、订阅、发布都进入这里的事件队列。队列中的事件带有到期时间
+ * （当前虚拟时间 + 往返延迟），由 host_mqtt_pump() 按顺序投递到客户端注册的
+ * 事件处理函数，与真实esp-mqtt在自身任务中回调的行为一致。
+ *
+ * 主题匹配支持 + 和 # 通配符。不模拟保留消息和QoS2的四次握手。
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_sim.h"
+#include "mqtt_client.h"
+
+#define BROKER_MAX_CLIENTS      4
+#define BROKER_MAX_SUBS         16
+#define BROKER_TOPIC_LEN        128
+
+typedef struct {
+    char topic[BROKER_TOPIC_LEN];
+    int qos;
+} broker_sub_t;
+
+struct esp_mqtt_client {
+    esp_event_handler_t handler;
+    void *handler_arg;
+    bool started;
+    bool connected;
+    int next_msg_id;
+    broker_sub_t subs[BROKER_MAX_SUBS];
+    size_t sub_count;
+    char client_id[64];
+};
+
+typedef struct broker_event {
+    struct broker_event *next;
+    int64_t due_us;
+    esp_mqtt_client_handle_t client;   // NULL表示按主题投递给所有订阅者
+    esp_mqtt_event_id_t id;
+    int msg_id;
+    char *topic;
+    char *data;
+    int data_len;
+} broker_event_t;
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static esp_mqtt_client_handle_t s_clients[BROKER_MAX_CLIENTS];
+static broker_event_t *s_head = NULL;
+static broker_event_t *s_tail = NULL;
+static int64_t s_latency_us = 20000;
+static host_mqtt_tap_t s_tap = NULL;
+static void *s_tap_ctx = NULL;
+static host_mqtt_stats_t s_stats;
+
+/* ==================== 事件队列 ==================== */
+
+static void enqueue(esp_mqtt_client_handle_t client, esp_mqtt_event_id_t id, int msg_id,
+                    const char *topic, const char *data, int data_len, int64_t delay_us)
+{
+    broker_event_t *ev = calloc(1, sizeof(*ev));
+    if (!ev) {
+        return;
+    }
+    ev->due_us = host_sim_now_us() + delay_us;
+    ev->client = client;
+    ev->id = id;
+    ev->msg_id = msg_id;
+    if (topic) {
+        ev->topic = strdup(topic);
+    }
+    if (data && data_len > 0) {
+        ev->data = malloc(data_len);
+        if (ev->data) {
+            memcpy(ev->data, data, data_len);
+            ev->data_len = data_len;
+        }
+    }
+
+    pthread_mutex_lock(&s_lock);
+    if (s_tail) {
+        s_tail->next = ev;
+    } else {
+        s_head = ev;
+    }
+    s_tail = ev;
+    pthread_mutex_unlock(&s_lock);
+}
+
+static broker_event_t *dequeue(void)
+{
+    pthread_mutex_lock(&s_lock);
+    broker_event_t *ev = s_head;
+    if (ev) {
+        s_head = ev->next;
+        if (!s_head) {
+            s_tail = NULL;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return ev;
+}
+
+static void event_free(broker_event_t *ev)
+{
+    free(ev->topic);
+    free(ev->data);
+    free(ev);
+}
+
+/* ==================== 主题匹配 ==================== */
+
+static bool topic_matches(const char *filter, const char *topic)
+{
+    while (*filter && *topic) {
+        if (*filter == '#') {
+            return true;
+        }
+        if (*filter == '+') {
+            while (*topic && *topic != '/') {
+                topic++;
+            }
+            filter++;
+            continue;
+        }
+        if (*filter != *topic) {
+            return false;
+        }
+        filter++;
+        topic++;
+    }
+    // "a/#" 也匹配 "a"
+    if (*topic == '\0' && filter[0] == '/' && filter[1] == '#') {
+        return true;
+    }
+    return *filter == '\0' && *topic == '\0';
+}
+
+static bool client_subscribed(esp_mqtt_client_handle_t client, const char *topic)
+{
+    for (size_t i = 0; i < client->sub_count; i++) {
+        if (topic_matches(client->subs[i].topic, topic)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ==================== 投递 ==================== */
+
+static void dispatch(esp_mqtt_client_handle_t client, broker_event_t *ev)
+{
+    if (!client->handler) {
+        return;
+    }
+    esp_mqtt_event_t event = {
+        .event_id = ev->id,
+        .client = client,
+        .data = ev->data,
+        .data_len = ev->data_len,
+        .total_data_len = ev->data_len,
+        .topic = ev->topic,
+        .topic_len = ev->topic ? (int)strlen(ev->topic) : 0,
+        .msg_id = ev->msg_id,
+    };
+    if (ev->id == MQTT_EVENT_CONNECTED) {
+        client->connected = true;
+    } else if (ev->id == MQTT_EVENT_DISCONNECTED) {
+        client->connected = false;
+    }
+    client->handler(client->handler_arg, "MQTT_EVENTS", ev->id, &event);
+    s_stats.events++;
+}
+
+size_t host_mqtt_pump(void)
+{
+    size_t delivered = 0;
+    broker_event_t *ev;
+
+    while ((ev = dequeue()) != NULL) {
+        int64_t now = host_sim_now_us();
+        if (ev->due_us > now) {
+            host_sim_advance_us(ev->due_us - now);
+        }
+
+        if (ev->client) {
+            if (ev->client->started) {
+                dispatch(ev->client, ev);
+                delivered++;
+            }
+        } else {
+            for (int i = 0; i < BROKER_MAX_CLIENTS; i++) {
+                esp_mqtt_client_handle_t c = s_clients[i];
+                if (c && c->connected && client_subscribed(c, ev->topic)) {
+                    dispatch(c, ev);
+                    s_stats.delivered++;
+                    delivered++;
+                }
+            }
+        }
+        event_free(ev);
+    }
+    return delivered;
+}
+
+esp_err_t host_mqtt_inject(const char *topic, const char *data, int len)
+{
+    if (!topic) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (len < 0) {
+        len = data ? (int)strlen(data) : 0;
+    }
+    // 云端->broker->设备只算单程
+    enqueue(NULL, MQTT_EVENT_DATA, 0, topic, data, len, s_latency_us / 2);
+    return ESP_OK;
+}
+
+void host_mqtt_set_latency_us(int64_t latency_us)
+{
+    s_latency_us = latency_us;
+}
+
+void host_mqtt_set_tap(host_mqtt_tap_t tap, void *ctx)
+{
+    s_tap = tap;
+    s_tap_ctx = ctx;
+}
+
+void host_mqtt_drop_connection(void)
+{
+    for (int i = 0; i < BROKER_MAX_CLIENTS; i++) {
+        esp_mqtt_client_handle_t c = s_clients[i];
+        if (c && c->started) {
+            enqueue(c, MQTT_EVENT_DISCONNECTED, 0, NULL, NULL, 0, 0);
+            // esp-mqtt默认10秒后自动重连
+            enqueue(c, MQTT_EVENT_CONNECTED, 0, NULL, NULL, 0, 10000000);
+        }
+    }
+}
+
+void host_mqtt_get_stats(host_mqtt_stats_t *stats)
+{
+    if (stats) {
+        *stats = s_stats;
+    }
+}
+
+/* ==================== esp-mqtt客户端接口 ==================== */
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t *config)
+{
+    if (!config || !config->broker.address.uri) {
+        return NULL;
+    }
+    esp_mqtt_client_handle_t client = calloc(1, sizeof(*client));
+    if (!client) {
+        return NULL;
+    }
+    if (config->credentials.client_id) {
+        strncpy(client->client_id, config->credentials.client_id, sizeof(client->client_id) - 1);
+    }
+    client->next_msg_id = 1;
+
+    pthread_mutex_lock(&s_lock);
+    for (int i = 0; i < BROKER_MAX_CLIENTS; i++) {
+        if (!s_clients[i]) {
+            s_clients[i] = client;
+            pthread_mutex_unlock(&s_lock);
+            return client;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    free(client);
+    return NULL;
+}
+
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client, esp_mqtt_event_id_t event,
+                                         esp_event_handler_t event_handler, void *event_handler_arg)
+{
+    (void)event;
+    if (!client || !event_handler) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    client->handler = event_handler;
+    client->handler_arg = event_handler_arg;
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client)
+{
+    if (!client) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (client->started) {
+        return ESP_FAIL;
+    }
+    client->started = true;
+    // TCP + CONNECT/CONNACK 大约两个往返
+    enqueue(client, MQTT_EVENT_CONNECTED, 0, NULL, NULL, 0, 2 * s_latency_us);
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t client)
+{
+    if (!client) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!client->started) {
+        return ESP_FAIL;
+    }
+    client->started = false;
+    client->connected = false;
+    client->sub_count = 0;
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_destroy(esp_mqtt_client_handle_t client)
+{
+    if (!client) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&s_lock);
+    for (int i = 0; i < BROKER_MAX_CLIENTS; i++) {
+        if (s_clients[i] == client) {
+            s_clients[i] = NULL;
+        }
+    }
+    // 丢弃还没投递的该客户端事件
+    broker_event_t **pp = &s_head;
+    s_tail = NULL;
+    while (*pp) {
+        if ((*pp)->client == client) {
+            broker_event_t *dead = *pp;
+            *pp = dead->next;
+            event_free(dead);
+        } else {
+            s_tail = *pp;
+            pp = &(*pp)->next;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    free(client);
+    return ESP_OK;
+}
+
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char *topic, const char *data,
+                            int len, int qos, int retain)
+{
+    (void)retain;
+    if (!client || !topic || !client->connected) {
+        return -1;
+    }
+    if (len == 0 && data) {
+        len = (int)strlen(data);
+    }
+
+    s_stats.published++;
+    s_stats.bytes_out += len;
+    if (s_tap) {
+        s_tap(topic, data, len, qos, s_tap_ctx);
+    }
+
+    int msg_id = 0;
+    if (qos > 0) {
+        msg_id = client->next_msg_id++;
+        if (client->next_msg_id > 0xFFFF) {
+            client->next_msg_id = 1;
+        }
+        enqueue(client, MQTT_EVENT_PUBLISHED, msg_id, NULL, NULL, 0, s_latency_us);
+    }
+    // 回环：设备订阅了自己发布的主题时也会收到
+    enqueue(NULL, MQTT_EVENT_DATA, 0, topic, data, len, s_latency_us);
+    return msg_id;
+}
+
+int esp_mqtt_client_subscribe(esp_mqtt_client_handle_t client, const char *topic, int qos)
+{
+    if (!client || !topic || !client->connected) {
+        return -1;
+    }
+    if (client->sub_count >= BROKER_MAX_SUBS) {
+        return -1;
+    }
+    broker_sub_t *sub = &client->subs[client->sub_count++];
+    strncpy(sub->topic, topic, sizeof(sub->topic) - 1);
+    sub->topic[sizeof(sub->topic) - 1] = '\0';
+    sub->qos = qos;
+
+    int msg_id = client->next_msg_id++;
+    enqueue(client, MQTT_EVENT_SUBSCRIBED, msg_id, NULL, NULL, 0, s_latency_us);
+    return msg_id;
+}
+
+int esp_mqtt_client_unsubscribe(esp_mqtt_client_handle_t client, const char *topic)
+{
+    if (!client || !topic || !client->connected) {
+        return -1;
+    }
+    for (size_t i = 0; i < client->sub_count; i++) {
+        if (strcmp(client->subs[i].topic, topic) == 0) {
+            client->subs[i] = client->subs[--client->sub_count];
+            break;
+        }
+    }
+    int msg_id = client->next_msg_id++;
+    enqueue(client, MQTT_EVENT_UNSUBSCRIBED, msg_id, NULL, NULL, 0, s_latency_us);
+    return msg_id;
+}
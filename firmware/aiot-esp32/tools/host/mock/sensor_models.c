@@ -0,0 +1,540 @@
+/**
+ * @file sensor_models.c
+ * @brief 主机模拟：DHT11与DS18B20的总线时序模型，MPU6050的FIFO模型，HC-SR04回波模型
+ *
+ * 模型只根据虚拟时钟和主机拉低/释放总线的时刻决定自己输出的电平，
+ * 驱动（drivers/sensors/）按原样逐位收发，超时、校验等路径都会真实执行。
+ * MPU6050挂在I2C寄存器文件模型上，FIFO和FIFO计数按虚拟时间生成。
+ * HC-SR04挂在MCPWM模型上：收到TRIG脉冲后用单次esp_timer在ECHO引脚上产生捕获边沿。
+ */
+
+#include <math.h>
+#include <string.h>
+#include "host_sim.h"
+#include "esp_timer.h"
+
+/* ==================== DHT11 ==================== */
+
+// 时序（微秒）：主机拉低>=18ms后释放，传感器20us后应答低80us、高80us，
+// 然后40位数据：每位50us低 + 26us(0)/70us(1)高，最后50us低后释放
+#define DHT11_START_LOW_MIN_US  18000
+#define DHT11_RESPONSE_DELAY_US 20
+#define DHT11_ACK_LOW_US        80
+#define DHT11_ACK_HIGH_US       80
+#define DHT11_BIT_LOW_US        50
+#define DHT11_BIT0_HIGH_US      26
+#define DHT11_BIT1_HIGH_US      70
+
+typedef struct {
+    int pin;
+    uint8_t frame[5];
+    int64_t low_since_us;
+    int64_t response_start_us;     // -1表示没有在应答
+    int16_t temp_x10;
+    uint16_t humi_x10;
+} dht11_model_t;
+
+static dht11_model_t s_dht11 = { .pin = -1, .response_start_us = -1 };
+
+static void dht11_build_frame(dht11_model_t *m)
+{
+    uint16_t t = (uint16_t)(m->temp_x10 < 0 ? -m->temp_x10 : m->temp_x10);
+    m->frame[0] = (uint8_t)(m->humi_x10 / 10);
+    m->frame[1] = (uint8_t)(m->humi_x10 % 10);
+    m->frame[2] = (uint8_t)(t / 10);
+    m->frame[3] = (uint8_t)((t % 10) | (m->temp_x10 < 0 ? 0x80 : 0));
+    m->frame[4] = (uint8_t)(m->frame[0] + m->frame[1] + m->frame[2] + m->frame[3]);
+}
+
+static void dht11_on_drive(void *ctx, int64_t now_us, bool master_low)
+{
+    dht11_model_t *m = ctx;
+    if (master_low) {
+        m->low_since_us = now_us;
+        m->response_start_us = -1;
+    } else if (now_us - m->low_since_us >= DHT11_START_LOW_MIN_US) {
+        dht11_build_frame(m);
+        m->response_start_us = now_us + DHT11_RESPONSE_DELAY_US;
+    }
+}
+
+static int dht11_sample(void *ctx, int64_t now_us)
+{
+    dht11_model_t *m = ctx;
+    if (m->response_start_us < 0 || now_us < m->response_start_us) {
+        return 1;
+    }
+    int64_t t = now_us - m->response_start_us;
+    if (t < DHT11_ACK_LOW_US) {
+        return 0;
+    }
+    t -= DHT11_ACK_LOW_US;
+    if (t < DHT11_ACK_HIGH_US) {
+        return 1;
+    }
+    t -= DHT11_ACK_HIGH_US;
+
+    for (int i = 0; i < 40; i++) {
+        int bit = (m->frame[i / 8] >> (7 - i % 8)) & 1;
+        int64_t high = bit ? DHT11_BIT1_HIGH_US : DHT11_BIT0_HIGH_US;
+        if (t < DHT11_BIT_LOW_US) {
+            return 0;
+        }
+        t -= DHT11_BIT_LOW_US;
+        if (t < high) {
+            return 1;
+        }
+        t -= high;
+    }
+    if (t < DHT11_BIT_LOW_US) {
+        return 0;
+    }
+    m->response_start_us = -1;
+    return 1;
+}
+
+void host_sensor_dht11_attach(int pin, int16_t temp_x10, uint16_t humi_x10)
+{
+    s_dht11.pin = pin;
+    s_dht11.response_start_us = -1;
+    host_sensor_dht11_set(temp_x10, humi_x10);
+    const host_sim_pin_model_t model = {
+        .on_drive = dht11_on_drive,
+        .sample = dht11_sample,
+        .ctx = &s_dht11,
+    };
+    host_sim_gpio_attach(pin, &model);
+}
+
+void host_sensor_dht11_set(int16_t temp_x10, uint16_t humi_x10)
+{
+    s_dht11.temp_x10 = temp_x10;
+    s_dht11.humi_x10 = humi_x10;
+}
+
+/* ==================== DS18B20 ==================== */
+
+// 时序（微秒）：复位脉冲>=480us；释放后15us开始存在脉冲，持续120us。
+// 写时隙：拉低<15us为1，否则为0。读时隙：主机拉低后，发送0时传感器保持低电平30us
+#define DS18B20_RESET_MIN_US        480
+#define DS18B20_PRESENCE_DELAY_US   15
+#define DS18B20_PRESENCE_US         120
+#define DS18B20_WRITE1_MAX_US       15
+#define DS18B20_READ0_HOLD_US       30
+
+typedef enum {
+    OW_IDLE = 0,                   // 等待复位
+    OW_ROM_CMD,                    // 接收ROM命令
+    OW_FUNC_CMD,                   // 接收功能命令
+    OW_READ_SCRATCHPAD,            // 发送暂存器
+} ow_state_t;
+
+typedef struct {
+    int pin;
+    ow_state_t state;
+    int64_t low_since_us;
+    int64_t presence_start_us;
+    int64_t read_hold_until_us;
+    uint8_t rx_byte;
+    uint8_t rx_bits;
+    uint8_t scratchpad[9];
+    uint16_t tx_bit;               // 已发送的位数
+    int16_t temp_x16;
+    int16_t converted_x16;         // 最近一次CONVERT_T的结果
+} ds18b20_model_t;
+
+static ds18b20_model_t s_ds18b20 = { .pin = -1, .presence_start_us = -1 };
+
+static uint8_t ow_crc8(const uint8_t *data, int len)
+{
+    uint8_t crc = 0;
+    for (int i = 0; i < len; i++) {
+        uint8_t in = data[i];
+        for (int j = 0; j < 8; j++) {
+            uint8_t mix = (crc ^ in) & 0x01;
+            crc >>= 1;
+            if (mix) {
+                crc ^= 0x8C;
+            }
+            in >>= 1;
+        }
+    }
+    return crc;
+}
+
+static void ds18b20_fill_scratchpad(ds18b20_model_t *m)
+{
+    m->scratchpad[0] = (uint8_t)(m->converted_x16 & 0xFF);
+    m->scratchpad[1] = (uint8_t)((uint16_t)m->converted_x16 >> 8);
+    m->scratchpad[2] = 0x4B;       // TH
+    m->scratchpad[3] = 0x46;       // TL
+    m->scratchpad[4] = 0x7F;       // 配置：12位
+    m->scratchpad[5] = 0xFF;
+    m->scratchpad[6] = 0x0C;
+    m->scratchpad[7] = 0x10;
+    m->scratchpad[8] = ow_crc8(m->scratchpad, 8);
+}
+
+static void ds18b20_on_byte(ds18b20_model_t *m, uint8_t byte)
+{
+    if (m->state == OW_ROM_CMD) {
+        // 只有一个器件，只支持SKIP ROM
+        m->state = byte == 0xCC ? OW_FUNC_CMD : OW_IDLE;
+        return;
+    }
+    if (m->state == OW_FUNC_CMD) {
+        if (byte == 0x44) {
+            m->converted_x16 = m->temp_x16;
+            m->state = OW_IDLE;
+        } else if (byte == 0xBE) {
+            ds18b20_fill_scratchpad(m);
+            m->tx_bit = 0;
+            m->state = OW_READ_SCRATCHPAD;
+        } else {
+            m->state = OW_IDLE;
+        }
+    }
+}
+
+static void ds18b20_on_drive(void *ctx, int64_t now_us, bool master_low)
+{
+    ds18b20_model_t *m = ctx;
+
+    if (master_low) {
+        m->low_since_us = now_us;
+        m->presence_start_us = -1;
+        // 读时隙从主机拉低开始，传感器在拉低时决定是否保持低电平
+        if (m->state == OW_READ_SCRATCHPAD && m->tx_bit < 72) {
+            int bit = (m->scratchpad[m->tx_bit / 8] >> (m->tx_bit % 8)) & 1;
+            m->read_hold_until_us = bit ? now_us : now_us + DS18B20_READ0_HOLD_US;
+            m->tx_bit++;
+        }
+        return;
+    }
+
+    int64_t low_us = now_us - m->low_since_us;
+    if (low_us >= DS18B20_RESET_MIN_US) {
+        m->state = OW_ROM_CMD;
+        m->rx_bits = 0;
+        m->rx_byte = 0;
+        m->presence_start_us = now_us + DS18B20_PRESENCE_DELAY_US;
+        return;
+    }
+    if (m->state == OW_ROM_CMD || m->state == OW_FUNC_CMD) {
+        int bit = low_us < DS18B20_WRITE1_MAX_US ? 1 : 0;
+        m->rx_byte |= (uint8_t)(bit << m->rx_bits);
+        if (++m->rx_bits == 8) {
+            uint8_t byte = m->rx_byte;
+            m->rx_bits = 0;
+            m->rx_byte = 0;
+            ds18b20_on_byte(m, byte);
+        }
+    }
+}
+
+static int ds18b20_sample(void *ctx, int64_t now_us)
+{
+    ds18b20_model_t *m = ctx;
+    if (m->presence_start_us >= 0 && now_us >= m->presence_start_us &&
+        now_us < m->presence_start_us + DS18B20_PRESENCE_US) {
+        return 0;
+    }
+    if (now_us < m->read_hold_until_us) {
+        return 0;
+    }
+    return 1;
+}
+
+void host_sensor_ds18b20_attach(int pin, int16_t temp_x16)
+{
+    memset(&s_ds18b20, 0, sizeof(s_ds18b20));
+    s_ds18b20.pin = pin;
+    s_ds18b20.presence_start_us = -1;
+    // 上电默认值85°C
+    s_ds18b20.converted_x16 = 85 * 16;
+    host_sensor_ds18b20_set(temp_x16);
+    const host_sim_pin_model_t model = {
+        .on_drive = ds18b20_on_drive,
+        .sample = ds18b20_sample,
+        .ctx = &s_ds18b20,
+    };
+    host_sim_gpio_attach(pin, &model);
+}
+
+void host_sensor_ds18b20_set(int16_t temp_x16)
+{
+    s_ds18b20.temp_x16 = temp_x16;
+}
+
+/* ==================== MPU6050 ==================== */
+
+#define MPU6050_REG_SMPLRT_DIV      0x19
+#define MPU6050_REG_CONFIG          0x1A
+#define MPU6050_REG_ACCEL_CONFIG    0x1C
+#define MPU6050_REG_FIFO_EN         0x23
+#define MPU6050_REG_USER_CTRL       0x6A
+#define MPU6050_REG_FIFO_COUNT_H    0x72
+#define MPU6050_REG_FIFO_R_W        0x74
+#define MPU6050_REG_WHO_AM_I        0x75
+#define MPU6050_FIFO_SIZE           1024
+
+typedef struct {
+    int port;
+    uint16_t addr;
+    uint8_t smplrt_div;
+    uint8_t dlpf;
+    uint8_t fs_sel;
+    bool accel_fifo;
+    bool fifo_enabled;
+    int64_t fifo_start_us;          // FIFO复位（开始采样）的时刻
+    uint64_t produced;              // 复位以来产生的样本数
+    uint8_t fifo[MPU6050_FIFO_SIZE];
+    size_t head;                    // 最旧字节
+    size_t count;
+    uint32_t overflows;
+    float freq_hz[3];
+    float amp_g[3];
+} mpu6050_model_t;
+
+static mpu6050_model_t s_mpu6050;
+
+static uint32_t mpu6050_rate_hz(const mpu6050_model_t *m)
+{
+    // DLPF关闭时陀螺仪输出8kHz，但加速度计最高1kHz，这里只按DLPF打开的1kHz计
+    return 1000u / (1u + m->smplrt_div);
+}
+
+// FIFO满时丢弃最旧的字节，返回true
+static bool mpu6050_fifo_put(mpu6050_model_t *m, uint8_t byte)
+{
+    bool lost = m->count == MPU6050_FIFO_SIZE;
+    if (lost) {
+        m->head = (m->head + 1) % MPU6050_FIFO_SIZE;
+        m->count--;
+    }
+    m->fifo[(m->head + m->count) % MPU6050_FIFO_SIZE] = byte;
+    m->count++;
+    return lost;
+}
+
+// 把FIFO补到当前虚拟时刻
+static void mpu6050_update(mpu6050_model_t *m)
+{
+    if (!m->fifo_enabled || !m->accel_fifo) {
+        return;
+    }
+    uint32_t rate = mpu6050_rate_hz(m);
+    int64_t elapsed = host_sim_now_us() - m->fifo_start_us;
+    uint64_t due = elapsed > 0 ? (uint64_t)elapsed * rate / 1000000 : 0;
+    // 长时间没读时只需要最后一满FIFO的样本
+    bool lost = false;
+    if (due > m->produced + MPU6050_FIFO_SIZE / 6 + 1) {
+        lost = true;
+        m->produced = due - (MPU6050_FIFO_SIZE / 6 + 1);
+    }
+    const float lsb_per_g = (float)(16384 >> m->fs_sel);
+    for (; m->produced < due; m->produced++) {
+        double t = (double)m->produced / rate;
+        for (int a = 0; a < 3; a++) {
+            float g = a == 2 ? 1.0f : 0.0f;
+            if (m->amp_g[a] != 0.0f) {
+                g += m->amp_g[a] * (float)sin(2.0 * M_PI * m->freq_hz[a] * t);
+            }
+            float lsb = g * lsb_per_g;
+            int16_t v = lsb > 32767.0f ? 32767 : lsb < -32768.0f ? -32768 : (int16_t)lrintf(lsb);
+            lost |= mpu6050_fifo_put(m, (uint8_t)((uint16_t)v >> 8));
+            lost |= mpu6050_fifo_put(m, (uint8_t)v);
+        }
+    }
+    if (lost) {
+        m->overflows++;
+    }
+}
+
+static void mpu6050_reset_fifo(mpu6050_model_t *m)
+{
+    m->head = 0;
+    m->count = 0;
+    m->produced = 0;
+    m->fifo_start_us = host_sim_now_us();
+}
+
+static bool mpu6050_on_read(void *ctx, uint8_t reg, uint8_t *buf, size_t len)
+{
+    mpu6050_model_t *m = ctx;
+    mpu6050_update(m);
+    if (reg == MPU6050_REG_FIFO_COUNT_H) {
+        uint8_t count[2] = { (uint8_t)(m->count >> 8), (uint8_t)m->count };
+        for (size_t i = 0; i < len; i++) {
+            buf[i] = i < 2 ? count[i] : 0;
+        }
+        return true;
+    }
+    if (reg == MPU6050_REG_FIFO_R_W) {
+        // FIFO端口地址不递增，读空后返回最后一个字节（这里按0）
+        for (size_t i = 0; i < len; i++) {
+            if (m->count > 0) {
+                buf[i] = m->fifo[m->head];
+                m->head = (m->head + 1) % MPU6050_FIFO_SIZE;
+                m->count--;
+            } else {
+                buf[i] = 0;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+static void mpu6050_on_write(void *ctx, uint8_t reg, const uint8_t *data, size_t len)
+{
+    mpu6050_model_t *m = ctx;
+    mpu6050_update(m);
+    for (size_t i = 0; i < len; i++) {
+        uint8_t r = (uint8_t)(reg + i);
+        switch (r) {
+        case MPU6050_REG_SMPLRT_DIV:
+            m->smplrt_div = data[i];
+            break;
+        case MPU6050_REG_CONFIG:
+            m->dlpf = data[i] & 0x07;
+            break;
+        case MPU6050_REG_ACCEL_CONFIG:
+            m->fs_sel = (data[i] >> 3) & 0x03;
+            break;
+        case MPU6050_REG_FIFO_EN:
+            m->accel_fifo = (data[i] & 0x08) != 0;
+            break;
+        case MPU6050_REG_USER_CTRL:
+            m->fifo_enabled = (data[i] & 0x40) != 0;
+            if (data[i] & 0x04) {
+                mpu6050_reset_fifo(m);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+esp_err_t host_sensor_mpu6050_attach(int port, uint16_t addr)
+{
+    esp_err_t ret = host_i2c_attach(port, addr);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    memset(&s_mpu6050, 0, sizeof(s_mpu6050));
+    s_mpu6050.port = port;
+    s_mpu6050.addr = addr;
+    const uint8_t who = 0x68;
+    host_i2c_set_regs(port, addr, MPU6050_REG_WHO_AM_I, &who, 1);
+    const host_i2c_hooks_t hooks = {
+        .on_read = mpu6050_on_read,
+        .on_write = mpu6050_on_write,
+        .ctx = &s_mpu6050,
+    };
+    return host_i2c_set_hooks(port, addr, &hooks);
+}
+
+void host_sensor_mpu6050_set_vibration(int axis, float freq_hz, float amp_g)
+{
+    if (axis < 0 || axis >= 3) {
+        return;
+    }
+    s_mpu6050.freq_hz[axis] = freq_hz;
+    s_mpu6050.amp_g[axis] = amp_g;
+}
+
+uint32_t host_sensor_mpu6050_overflows(void)
+{
+    return s_mpu6050.overflows;
+}
+
+/* ==================== HC-SR04 ==================== */
+
+// 时序（微秒）：TRIG高电平>=10us后模块发出8个40kHz脉冲，约450us后ECHO拉高，
+// 高电平宽度为声波往返时间；前方没有目标时约38ms后超时拉低
+#define HCSR04_TRIG_MIN_US      10
+#define HCSR04_BURST_US         450
+#define HCSR04_NO_ECHO_US       38000
+
+typedef struct {
+    int trig;
+    int echo;
+    float distance_cm;             // <=0 表示前方没有目标
+    float air_temp_c;
+    uint32_t glitch_every;         // 每N个回波有一个异常短回波（0=不注入）
+    uint32_t echo_count;
+    uint32_t width_us;             // 正在产生的回波宽度
+    bool busy;                     // 触发后到ECHO拉低前忽略新的TRIG
+    bool echo_high;
+    esp_timer_handle_t timer;
+} hcsr04_model_t;
+
+static hcsr04_model_t s_hcsr04 = { .trig = -1, .echo = -1 };
+
+static void hcsr04_timer_cb(void *arg)
+{
+    hcsr04_model_t *m = arg;
+    if (!m->echo_high) {
+        m->echo_high = true;
+        host_mcpwm_capture(m->echo, true);
+        esp_timer_start_once(m->timer, m->width_us);
+    } else {
+        m->echo_high = false;
+        m->busy = false;
+        host_mcpwm_capture(m->echo, false);
+    }
+}
+
+static void hcsr04_on_pulse(void *ctx, int gpio, uint32_t width_us)
+{
+    hcsr04_model_t *m = ctx;
+    if (gpio != m->trig || width_us < HCSR04_TRIG_MIN_US || m->busy) {
+        return;
+    }
+    if (m->distance_cm <= 0.0f) {
+        m->width_us = HCSR04_NO_ECHO_US;
+    } else {
+        float speed = 331.3f * sqrtf(1.0f + m->air_temp_c / 273.15f);
+        m->width_us = (uint32_t)lroundf(m->distance_cm * 20000.0f / speed);
+        m->echo_count++;
+        if (m->glitch_every && m->echo_count % m->glitch_every == 0) {
+            m->width_us /= 3;           // 近处物体的杂散反射
+        }
+    }
+    m->busy = true;
+    esp_timer_start_once(m->timer, HCSR04_BURST_US);
+}
+
+void host_sensor_hcsr04_attach(int trig, int echo)
+{
+    if (!s_hcsr04.timer) {
+        const esp_timer_create_args_t args = {
+            .callback = hcsr04_timer_cb,
+            .arg = &s_hcsr04,
+            .name = "hcsr04",
+        };
+        esp_timer_create(&args, &s_hcsr04.timer);
+    }
+    esp_timer_stop(s_hcsr04.timer);
+    s_hcsr04.trig = trig;
+    s_hcsr04.echo = echo;
+    s_hcsr04.busy = false;
+    s_hcsr04.echo_high = false;
+    s_hcsr04.echo_count = 0;
+    s_hcsr04.glitch_every = 0;
+    host_sensor_hcsr04_set(100.0f, 20.0f);
+    host_mcpwm_set_pulse_hook(hcsr04_on_pulse, &s_hcsr04);
+}
+
+void host_sensor_hcsr04_set(float distance_cm, float air_temp_c)
+{
+    s_hcsr04.distance_cm = distance_cm;
+    s_hcsr04.air_temp_c = air_temp_c;
+}
+
+void host_sensor_hcsr04_set_glitch_every(uint32_t n)
+{
+    s_hcsr04.glitch_every = n;
+}
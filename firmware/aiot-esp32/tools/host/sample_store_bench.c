@@ -0,0 +1,200 @@
+/**
+ * @file sample_store_bench.c
+ * @brief 样本存储主机基准测试（文件模拟Flash）
+ *
+ * 测量：追加速率、区间查询延迟、模拟掉电后的挂载恢复时间。
+ *
+ * 使用方法：
+ *   make sample-store-bench
+ *   ./build/host/sample_store_bench [模拟Flash文件] [大小KB]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sample_store.h"
+#include "flash_emu.h"
+
+#define DEFAULT_IMAGE       "build/host/userdata.bin"
+#define DEFAULT_SIZE_KB     3072    // partitions.csv中userdata分区大小
+#define SAMPLES_PER_SECOND  3       // 模拟DHT11温度/湿度 + DS18B20
+#define QUERY_COUNT         1000
+
+typedef struct {
+    uint32_t count;
+    uint32_t last_ts;
+    int out_of_order;
+} query_ctx_t;
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static bool count_cb(const sample_store_record_t *record, void *user_ctx)
+{
+    query_ctx_t *ctx = (query_ctx_t *)user_ctx;
+    if (record->timestamp < ctx->last_ts) {
+        ctx->out_of_order = 1;
+    }
+    ctx->last_ts = record->timestamp;
+    ctx->count++;
+    return true;
+}
+
+static sample_store_flash_t make_flash(flash_emu_t *emu)
+{
+    sample_store_flash_t flash = {
+        .read = flash_emu_read,
+        .write = flash_emu_write,
+        .erase_sector = flash_emu_erase_sector,
+        .size = emu->size,
+        .ctx = emu,
+    };
+    return flash;
+}
+
+static sample_store_record_t make_record(uint32_t i)
+{
+    sample_store_record_t record = {
+        .timestamp = i / SAMPLES_PER_SECOND,
+        .value = 20.0f + (float)(i % 100) / 10.0f,
+        .sensor_id = (uint8_t)(i % SAMPLES_PER_SECOND == 2 ? SAMPLE_SENSOR_DS18B20 : SAMPLE_SENSOR_DHT11),
+        .channel = (uint8_t)(i % SAMPLES_PER_SECOND == 1),
+        .flags = 0,
+    };
+    return record;
+}
+
+int main(int argc, char **argv)
+{
+    const char *image = argc > 1 ? argv[1] : DEFAULT_IMAGE;
+    uint32_t size = (uint32_t)(argc > 2 ? atoi(argv[2]) : DEFAULT_SIZE_KB) * 1024;
+    flash_emu_t emu;
+    sample_store_stats_t stats;
+    int failed = 0;
+
+    srand(12345);
+
+    if (flash_emu_open(&emu, image, size, 1) != ESP_OK) {
+        fprintf(stderr, "无法创建模拟Flash文件: %s\n", image);
+        return 1;
+    }
+    sample_store_flash_t flash = make_flash(&emu);
+    if (sample_store_mount(&flash) != ESP_OK) {
+        return 1;
+    }
+
+    // 1. 追加：写满后再写一半，覆盖轮转路径
+    uint32_t sectors = size / SAMPLE_STORE_SECTOR_SIZE;
+    uint32_t total = sectors * SAMPLE_STORE_RECORDS_PER_SECTOR * 3 / 2;
+    double t0 = now_us();
+    for (uint32_t i = 0; i < total; i++) {
+        sample_store_record_t record = make_record(i);
+        if (sample_store_append(&record) != ESP_OK) {
+            fprintf(stderr, "追加失败: %u\n", i);
+            return 1;
+        }
+    }
+    double append_us = now_us() - t0;
+    sample_store_get_stats(&stats);
+
+    printf("\n=== 追加 ===\n");
+    printf("记录数:       %u (%u 扇区, 轮转 %.1f 次)\n", total, sectors,
+           (double)total / (sectors * SAMPLE_STORE_RECORDS_PER_SECTOR));
+    printf("追加速率:     %.0f 条/秒 (%.2f us/条)\n", total / (append_us / 1e6), append_us / total);
+    printf("扇区擦除:     %u 次, 最大单扇区擦除 %u 次\n", emu.erase_count, stats.max_erase_count);
+    printf("可查询记录:   %u, 时间范围 %u ~ %u\n", stats.record_count,
+           stats.oldest_timestamp, stats.newest_timestamp);
+
+    // 2. 区间查询：随机窗口 1分钟 ~ 1小时
+    uint32_t span = stats.newest_timestamp - stats.oldest_timestamp;
+    double query_total_us = 0;
+    double query_max_us = 0;
+    uint32_t reads_before = emu.read_count;
+    uint64_t matched = 0;
+
+    for (int q = 0; q < QUERY_COUNT; q++) {
+        uint32_t window = 60 + (uint32_t)rand() % 3540;
+        // 避开最旧/最新一秒（可能只保留了部分记录）
+        uint32_t start = stats.oldest_timestamp + 1 + (uint32_t)rand() % (span - window - 1);
+        query_ctx_t ctx = {0};
+        uint32_t count = 0;
+
+        double qt = now_us();
+        sample_store_query(start, start + window, SAMPLE_STORE_ANY_SENSOR, count_cb, &ctx, &count);
+        qt = now_us() - qt;
+
+        query_total_us += qt;
+        if (qt > query_max_us) {
+            query_max_us = qt;
+        }
+        matched += count;
+        if (ctx.out_of_order || count != (window + 1) * SAMPLES_PER_SECOND) {
+            fprintf(stderr, "查询结果错误: [%u, %u] 返回 %u 条\n", start, start + window, count);
+            failed = 1;
+        }
+    }
+
+    printf("\n=== 区间查询（%d 次，窗口 1~60 分钟）===\n", QUERY_COUNT);
+    printf("平均延迟:     %.1f us, 最大 %.1f us\n", query_total_us / QUERY_COUNT, query_max_us);
+    printf("平均结果:     %.0f 条, Flash读取 %.1f 次/查询\n", (double)matched / QUERY_COUNT,
+           (double)(emu.read_count - reads_before) / QUERY_COUNT);
+
+    // 3. 模拟掉电：在随机写入处写断，然后重新挂载
+    emu.writes_until_cut = 1 + (uint32_t)rand() % 1000;
+    uint32_t appended = 0;
+    uint32_t last_ok_ts = stats.newest_timestamp;
+    for (uint32_t i = total;; i++) {
+        sample_store_record_t record = make_record(i);
+        if (sample_store_append(&record) != ESP_OK) {
+            break;
+        }
+        last_ok_ts = record.timestamp;
+        appended++;
+    }
+    sample_store_deinit();
+    flash_emu_close(&emu);
+
+    if (flash_emu_open(&emu, image, size, 0) != ESP_OK) {
+        return 1;
+    }
+    flash = make_flash(&emu);
+    t0 = now_us();
+    if (sample_store_mount(&flash) != ESP_OK) {
+        return 1;
+    }
+    double mount_us = now_us() - t0;
+    sample_store_get_stats(&stats);
+
+    printf("\n=== 掉电恢复 ===\n");
+    printf("掉电前追加:   %u 条\n", appended);
+    printf("恢复时间:     %.1f ms (%u 次Flash读取)\n", mount_us / 1000, emu.read_count);
+    printf("最新时间戳:   %u (掉电前最后成功写入 %u)\n", stats.newest_timestamp, last_ok_ts);
+    printf("写断记录:     %u\n", stats.corrupt_records);
+
+    if (stats.newest_timestamp != last_ok_ts) {
+        fprintf(stderr, "恢复后最新时间戳不一致\n");
+        failed = 1;
+    }
+
+    // 恢复后继续写入，新记录必须可查询
+    sample_store_record_t record = make_record((last_ok_ts + 10) * SAMPLES_PER_SECOND);
+    uint32_t count = 0;
+    query_ctx_t ctx = {0};
+    if (sample_store_append(&record) != ESP_OK ||
+        sample_store_query(record.timestamp, record.timestamp, SAMPLE_STORE_ANY_SENSOR,
+                           count_cb, &ctx, &count) != ESP_OK || count != 1) {
+        fprintf(stderr, "恢复后写入/查询失败\n");
+        failed = 1;
+    }
+
+    sample_store_deinit();
+    flash_emu_close(&emu);
+
+    printf("\n%s\n", failed ? "❌ 校验失败" : "✅ 校验通过");
+    return failed;
+}
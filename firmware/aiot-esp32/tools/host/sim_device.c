@@ -0,0 +1,181 @@
+/**
+ * @file sim_device.c
+ * @brief 主机模拟设备实现
+ */
+
+#include "sim_device.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host_sim.h"
+#include "cJSON.h"
+#include "bsp_interface.h"
+#include "bsp_esp32_s3_devkit.h"
+#include "board_config.h"
+#include "device_control.h"
+#include "preset_control.h"
+#include "aiot_mqtt_client.h"
+#include "sensor_hub.h"
+#include "sample_store.h"
+
+static lcd_handle_t s_lcd;
+static sim_device_stats_t s_stats;
+static uint8_t s_ram_flash[SIM_DEVICE_FLASH_SIZE];
+
+// 与startup_manager.c的控制命令分发一致
+static void handle_control_command(const mqtt_message_t *msg)
+{
+    char *payload = malloc(msg->payload_len + 1);
+    if (!payload) {
+        s_stats.commands_fail++;
+        return;
+    }
+    memcpy(payload, msg->payload, msg->payload_len);
+    payload[msg->payload_len] = '\0';
+
+    bool exec_ok = false;
+    cJSON *json = cJSON_Parse(payload);
+    if (json) {
+        cJSON *cmd_item = cJSON_GetObjectItem(json, "cmd");
+        bool is_preset = cJSON_IsString(cmd_item) && strcmp(cmd_item->valuestring, "preset") == 0;
+        cJSON_Delete(json);
+
+        if (is_preset) {
+            preset_control_command_t preset_cmd;
+            if (preset_control_parse_json_command(payload, &preset_cmd) == ESP_OK) {
+                preset_control_result_t preset_result;
+                esp_err_t ret = preset_control_execute(&preset_cmd, &preset_result);
+                exec_ok = (ret == ESP_OK && preset_result.success);
+                preset_control_free_command(&preset_cmd);
+            }
+        } else {
+            device_control_command_t device_cmd;
+            if (device_control_parse_json_command(payload, &device_cmd) == ESP_OK) {
+                device_control_result_t device_result;
+                esp_err_t ret = device_control_execute(&device_cmd, &device_result);
+                exec_ok = (ret == ESP_OK && device_result.success);
+            }
+        }
+    }
+    free(payload);
+
+    if (exec_ok) {
+        s_stats.commands_ok++;
+    } else {
+        s_stats.commands_fail++;
+    }
+}
+
+static void mqtt_event_cb(const mqtt_event_data_t *event_data)
+{
+    if (event_data->event != AIOT_MQTT_EVENT_MESSAGE_RECEIVED || !event_data->message) {
+        return;
+    }
+    if (strncmp(event_data->message->topic, SIM_TOPIC_CONTROL, strlen(SIM_TOPIC_CONTROL)) == 0) {
+        handle_control_command(event_data->message);
+    }
+}
+
+esp_err_t sim_device_init(void)
+{
+    if (bsp_esp32_s3_devkit_register() != HAL_OK || bsp_init() != HAL_OK) {
+        fprintf(stderr, "BSP init failed\n");
+        return ESP_FAIL;
+    }
+    // pwm_control与舵机共用GPIO48/40和LEDC定时器0/1，与main.c一样不在舵机模式下初始化
+    if (device_control_init() != ESP_OK || preset_control_init() != ESP_OK) {
+        fprintf(stderr, "device control init failed\n");
+        return ESP_FAIL;
+    }
+
+    host_sensor_dht11_attach(DHT11_GPIO_PIN, 234, 560);
+    host_sensor_ds18b20_attach(DS18B20_GPIO_PIN, 25 * 16);
+    // 与main.c一样按板级传感器表初始化
+    if (bsp_sensor_init() != HAL_OK || sensor_hub_count() == 0) {
+        fprintf(stderr, "sensor init failed\n");
+        return ESP_FAIL;
+    }
+    for (size_t i = 0; i < sensor_hub_count(); i++) {
+        sensor_hub_sensor_t info;
+        if (sensor_hub_get(i, &info) != ESP_OK || !info.ready) {
+            fprintf(stderr, "sensor %zu init failed\n", i);
+            return ESP_FAIL;
+        }
+    }
+
+    if (lcd_init(&s_lcd) != ESP_OK) {
+        fprintf(stderr, "LCD init failed\n");
+        return ESP_FAIL;
+    }
+
+    mqtt_config_t mqtt_cfg = {
+        .port = 1883,
+        .keepalive = MQTT_KEEPALIVE_SEC,
+        .reconnect_timeout = MQTT_RECONNECT_TIMEOUT,
+        .clean_session = true,
+    };
+    strcpy(mqtt_cfg.broker_url, "localhost");
+    strcpy(mqtt_cfg.client_id, SIM_DEVICE_ID);
+    if (mqtt_client_init(&mqtt_cfg, mqtt_event_cb) != ESP_OK || mqtt_client_connect() != ESP_OK) {
+        fprintf(stderr, "MQTT init failed\n");
+        return ESP_FAIL;
+    }
+    host_mqtt_pump();
+    if (!mqtt_client_is_connected() || mqtt_client_subscribe(SIM_TOPIC_CONTROL, MQTT_QOS_1) != ESP_OK) {
+        fprintf(stderr, "MQTT connect failed\n");
+        return ESP_FAIL;
+    }
+    host_mqtt_pump();
+    return ESP_OK;
+}
+
+/* ==================== RAM Flash（sample_store用） ==================== */
+
+static esp_err_t ram_flash_read(void *ctx, uint32_t offset, void *buf, size_t len)
+{
+    (void)ctx;
+    memcpy(buf, s_ram_flash + offset, len);
+    return ESP_OK;
+}
+
+static esp_err_t ram_flash_write(void *ctx, uint32_t offset, const void *buf, size_t len)
+{
+    (void)ctx;
+    // NOR Flash只能把1写成0
+    const uint8_t *src = buf;
+    for (size_t i = 0; i < len; i++) {
+        s_ram_flash[offset + i] &= src[i];
+    }
+    return ESP_OK;
+}
+
+static esp_err_t ram_flash_erase_sector(void *ctx, uint32_t offset)
+{
+    (void)ctx;
+    memset(s_ram_flash + offset, 0xFF, SAMPLE_STORE_SECTOR_SIZE);
+    return ESP_OK;
+}
+
+esp_err_t sim_device_mount_sample_store(void)
+{
+    memset(s_ram_flash, 0xFF, sizeof(s_ram_flash));
+    sample_store_flash_t flash = {
+        .read = ram_flash_read,
+        .write = ram_flash_write,
+        .erase_sector = ram_flash_erase_sector,
+        .size = SIM_DEVICE_FLASH_SIZE,
+    };
+    return sample_store_mount(&flash);
+}
+
+lcd_handle_t *sim_device_lcd(void)
+{
+    return &s_lcd;
+}
+
+void sim_device_get_stats(sim_device_stats_t *stats)
+{
+    if (stats) {
+        *stats = s_stats;
+    }
+}
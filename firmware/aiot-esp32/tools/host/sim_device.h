@@ -0,0 +1,65 @@
+/**
+ * @file sim_device.h
+ * @brief 主机模拟设备：按固件启动顺序初始化真实模块并连接模拟broker
+ *
+ * host_bench 和 hil_replay 共用。控制命令处理与 startup_manager.c 中
+ * mqtt_event_callback 的分发逻辑一致（preset 走 preset_control，其余走 device_control）。
+ */
+
+#ifndef SIM_DEVICE_H
+#define SIM_DEVICE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "lcd_st7789.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIM_DEVICE_ID           "sim-device"
+#define SIM_TOPIC_CONTROL       "devices/sim-device/control"
+#define SIM_TOPIC_SENSOR        "devices/sim-device/data"
+#define SIM_TOPIC_STATUS        "devices/sim-device/status"
+#define SIM_DEVICE_FLASH_SIZE   (64 * 1024)
+
+/**
+ * @brief 命令处理统计
+ */
+typedef struct {
+    uint32_t commands_ok;          ///< 执行成功的控制命令
+    uint32_t commands_fail;        ///< 解析或执行失败的控制命令
+} sim_device_stats_t;
+
+/**
+ * @brief 初始化BSP、设备控制、传感器（挂接DHT11/DS18B20模型）、LCD和MQTT
+ *
+ * 返回时MQTT已连接并订阅控制主题。
+ *
+ * @return esp_err_t
+ */
+esp_err_t sim_device_init(void);
+
+/**
+ * @brief 在RAM模拟的Flash上挂载sample_store（SIM_DEVICE_FLASH_SIZE字节，按NOR语义只能1写0）
+ *
+ * @return esp_err_t
+ */
+esp_err_t sim_device_mount_sample_store(void);
+
+/**
+ * @brief LCD句柄
+ */
+lcd_handle_t *sim_device_lcd(void);
+
+/**
+ * @brief 获取命令处理统计
+ */
+void sim_device_get_stats(sim_device_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_DEVICE_H
@@ -0,0 +1,218 @@
+/**
+ * @file task_profile_sim.c
+ * @brief 任务分析器主机模拟
+ *
+ * 用固件中实际创建的任务（名称、栈大小、优先级、绑定核）构造模拟任务表，
+ * 按每个任务的平均负载和抖动推进运行时间与栈使用峰值，
+ * 通过与设备相同的 task_profiler.c 生成报告并输出与get_status命令相同的JSON。
+ *
+ * 使用方法：
+ *   make task-profile-report
+ *   ./build/host/task_profile_sim [窗口数] [窗口毫秒]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "task_profiler.h"
+
+#define DEFAULT_WINDOWS     6
+#define DEFAULT_WINDOW_MS   5000    // 与system_monitor_task循环间隔一致
+#define NUM_CORES           2
+
+typedef struct {
+    const char *name;
+    uint32_t stack_size;           // 创建时的栈大小（字节）
+    uint8_t priority;
+    int8_t core;
+    uint16_t load_permille;        // 平均负载（占单核的千分比）
+    uint16_t jitter_permille;      // 负载抖动幅度
+    uint32_t stack_base_use;       // 常态栈使用
+    uint32_t stack_peak_use;       // 偶发峰值栈使用（如事件回调中的大局部变量）
+    uint16_t peak_chance;          // 每个窗口出现峰值的概率（千分比）
+} sim_task_def_t;
+
+// 与固件一致：main.c / button_handler.c / captive_portal.c / device_registration.c /
+// lvgl_display.h / binlog.c / ESP-IDF默认任务配置
+static const sim_task_def_t s_task_defs[] = {
+    { "main",           12288, 1,  0,  10,  5, 6100, 9800, 20 },
+    { "system_monitor", 4096,  5, -1,  35, 20, 2600, 3500, 80 },
+    { "button_task",    4096,  5, -1,   3,  2, 1400, 1900, 10 },
+    { "dns_server",     4096,  5, -1,   2,  2, 1800, 2400, 10 },
+    { "device_reg",     4096,  5, -1,   1,  1, 3300, 3900, 50 },
+    { "mqtt_task",      6144,  5, -1,  45, 30, 3900, 5700, 120 },
+    { "lvgl_timer",     4096,  4, -1,  90, 40, 2500, 3200, 30 },
+    { "binlog",         3072,  1, -1,   8,  4, 1500, 1700, 10 },
+    { "sys_evt",        4096, 20,  0,   4,  3, 2900, 3800, 40 },
+    { "tiT",            3072, 18, -1,  30, 15, 1900, 2300, 20 },
+    { "wifi",           3584, 23,  0,  60, 25, 2200, 2700, 20 },
+    { "esp_timer",      3584, 22,  0,   6,  3, 1300, 1600, 10 },
+    { "ipc0",           1024, 24,  0,   0,  0,  500,  560,  0 },
+    { "ipc1",           1024, 24,  1,   0,  0,  500,  560,  0 },
+};
+#define SIM_TASK_COUNT (sizeof(s_task_defs) / sizeof(s_task_defs[0]))
+
+typedef struct {
+    uint32_t runtime_us;
+    uint32_t stack_max_use;
+} sim_task_state_t;
+
+static sim_task_state_t s_state[SIM_TASK_COUNT];
+static uint32_t s_idle_runtime[NUM_CORES];
+static uint32_t s_now_ms = 0;
+static uint32_t s_heap_free = 180 * 1024;
+static uint32_t s_heap_largest = 110 * 1024;
+static uint32_t s_heap_min = 180 * 1024;
+static uint32_t s_rng = 0x12345678;
+
+// 固定种子的LCG，保证每次运行结果相同
+static uint32_t sim_rand(uint32_t range)
+{
+    s_rng = s_rng * 1664525u + 1013904223u;
+    return range ? (s_rng >> 8) % range : 0;
+}
+
+static void sim_advance(uint32_t window_ms)
+{
+    uint64_t busy_us[NUM_CORES] = {0};
+
+    for (size_t i = 0; i < SIM_TASK_COUNT; i++) {
+        const sim_task_def_t *d = &s_task_defs[i];
+        int32_t load = d->load_permille;
+        if (d->jitter_permille) {
+            load += (int32_t)sim_rand(2 * d->jitter_permille + 1) - d->jitter_permille;
+        }
+        if (load < 0) {
+            load = 0;
+        }
+        uint32_t run_us = (uint32_t)((uint64_t)window_ms * 1000 * load / 1000);
+        s_state[i].runtime_us += run_us;
+        // 不绑定核的任务平均分摊到两个核
+        if (d->core >= 0) {
+            busy_us[d->core] += run_us;
+        } else {
+            busy_us[0] += run_us / 2;
+            busy_us[1] += run_us - run_us / 2;
+        }
+
+        uint32_t use = d->stack_base_use + sim_rand(64);
+        if (sim_rand(1000) < d->peak_chance) {
+            use = d->stack_peak_use;
+        }
+        if (use > s_state[i].stack_max_use) {
+            s_state[i].stack_max_use = use;
+        }
+    }
+
+    uint64_t window_us = (uint64_t)window_ms * 1000;
+    for (int c = 0; c < NUM_CORES; c++) {
+        s_idle_runtime[c] += busy_us[c] < window_us ? (uint32_t)(window_us - busy_us[c]) : 0;
+    }
+
+    // 模拟堆：MQTT/HTTP缓冲区反复申请释放，最大连续块逐渐变小
+    s_heap_free = 180 * 1024 - sim_rand(24 * 1024);
+    if (s_heap_largest > 64 * 1024) {
+        s_heap_largest -= sim_rand(4 * 1024);
+    }
+    if (s_heap_free < s_heap_min) {
+        s_heap_min = s_heap_free;
+    }
+    s_now_ms += window_ms;
+}
+
+/* ==================== 模拟采样来源 ==================== */
+
+static size_t sim_sample_tasks(task_profiler_task_t *out, size_t max)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < SIM_TASK_COUNT && count < max; i++, count++) {
+        const sim_task_def_t *d = &s_task_defs[i];
+        task_profiler_task_t *t = &out[count];
+        memset(t, 0, sizeof(*t));
+        strncpy(t->name, d->name, sizeof(t->name) - 1);
+        t->task_number = (uint32_t)i + 1;
+        t->runtime = s_state[i].runtime_us;
+        t->stack_hwm = d->stack_size - s_state[i].stack_max_use;
+        t->priority = d->priority;
+        t->core = d->core;
+    }
+    for (int c = 0; c < NUM_CORES && count < max; c++, count++) {
+        task_profiler_task_t *t = &out[count];
+        memset(t, 0, sizeof(*t));
+        snprintf(t->name, sizeof(t->name), "IDLE%d", c);
+        t->task_number = 100 + c;
+        t->runtime = s_idle_runtime[c];
+        t->stack_hwm = 1536 - 620;
+        t->priority = 0;
+        t->core = c;
+    }
+    return count;
+}
+
+static void sim_sample_heap(task_profiler_heap_t *out)
+{
+    out->total_free = s_heap_free;
+    out->largest_free_block = s_heap_largest;
+    out->min_free = s_heap_min;
+}
+
+static uint32_t sim_now_ms(void)
+{
+    return s_now_ms;
+}
+
+static void print_table(const task_profiler_report_t *report)
+{
+    printf("\n%-16s %6s %8s %5s %5s\n", "TASK", "CPU%", "STACK", "PRIO", "CORE");
+    for (size_t i = 0; i < report->task_count; i++) {
+        const task_profiler_entry_t *e = &report->tasks[i];
+        printf("%-16s %4d.%d %8lu %5u %5d%s\n", e->task.name,
+               e->cpu_permille / 10, e->cpu_permille % 10,
+               (unsigned long)e->task.stack_hwm, (unsigned)e->task.priority, (int)e->task.core,
+               e->task.stack_hwm < CONFIG_TASK_PROFILER_STACK_WARN_BYTES ? "  <-- 栈余量不足" : "");
+    }
+    printf("heap: free=%lu largest=%lu min=%lu frag=%u%%\n",
+           (unsigned long)report->heap.total_free, (unsigned long)report->heap.largest_free_block,
+           (unsigned long)report->heap.min_free, (unsigned)report->heap_frag_pct);
+}
+
+int main(int argc, char **argv)
+{
+    int windows = argc > 1 ? atoi(argv[1]) : DEFAULT_WINDOWS;
+    uint32_t window_ms = argc > 2 ? (uint32_t)atoi(argv[2]) : DEFAULT_WINDOW_MS;
+    if (windows <= 0 || window_ms == 0) {
+        fprintf(stderr, "usage: %s [windows] [window_ms]\n", argv[0]);
+        return 1;
+    }
+
+    const task_profiler_source_t source = {
+        .sample_tasks = sim_sample_tasks,
+        .sample_heap = sim_sample_heap,
+        .now_ms = sim_now_ms,
+        .runtime_stats = true,
+    };
+    if (task_profiler_init(&source) != ESP_OK) {
+        return 1;
+    }
+
+    task_profiler_sample();  // 建立基线
+    task_profiler_report_t report;
+    char json[2560];
+
+    for (int w = 0; w < windows; w++) {
+        sim_advance(window_ms);
+        task_profiler_sample();
+        if (task_profiler_get_report(&report) != ESP_OK) {
+            return 1;
+        }
+        size_t len = 0;
+        if (task_profiler_report_json(&report, json, sizeof(json), &len) != ESP_OK) {
+            fprintf(stderr, "report JSON too large\n");
+            return 1;
+        }
+        printf("%s\n", json);
+    }
+
+    print_table(&report);
+    return 0;
+}
@@ -15,6 +15,7 @@
 #include <stdbool.h>
 #include <string.h>
 #include <ctype.h>
+#include <inttypes.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -29,6 +30,8 @@
 #include "nvs_flash.h"
 #include "esp_timer.h"
 #include "esp_http_server.h"
+#include "esp_rom_crc.h"
+#include "captive_dns.h"
 
 #include "mqtt_client.h"
 #include "driver/gpio.h"
@@ -42,13 +45,6 @@
 #include "device_config.h"
 #include "esp_random.h"
 
-// ==================== DNS服务器配置 ====================
-#define DNS_SERVER_PORT 53
-#define DNS_MAX_LEN 512
-
-// DNS服务器任务句柄
-static TaskHandle_t dns_server_task_handle = NULL;
-
 // ==================== 全局变量 ====================
 static const char *TAG = LOG_TAG_MAIN;
 
@@ -232,96 +228,13 @@ static void mqtt_event_handler(void *handler_args, esp_event_base_t base,
 // ==================== DNS服务器（Captive Portal支持）====================
 
 /**
- * @brief DNS服务器任务 - 将所有DNS查询重定向到ESP32
- * 
- * 这是Captive Portal的关键：拦截所有DNS查询并返回ESP32的IP
- * 这样手机访问任何网址都会跳转到配网页面
- */
-static void dns_server_task(void *pvParameters) {
-    struct sockaddr_in server_addr;
-    struct sockaddr_in client_addr;
-    socklen_t client_addr_len = sizeof(client_addr);
-    char rx_buffer[DNS_MAX_LEN];
-    char tx_buffer[DNS_MAX_LEN];
-    
-    // 创建UDP socket
-    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-    if (sock < 0) {
-        ESP_LOGE(TAG, "DNS服务器：创建socket失败");
-        vTaskDelete(NULL);
-        return;
-    }
-    
-    // 设置socket为非阻塞
-    int flags = fcntl(sock, F_GETFL, 0);
-    fcntl(sock, F_SETFL, flags | O_NONBLOCK);
-    
-    // 绑定到DNS端口53
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_addr.s_addr = INADDR_ANY;
-    server_addr.sin_port = htons(DNS_SERVER_PORT);
-    
-    if (bind(sock, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
-        ESP_LOGE(TAG, "DNS服务器：绑定端口53失败");
-        close(sock);
-        vTaskDelete(NULL);
-        return;
-    }
-    
-    ESP_LOGI(TAG, "✅ DNS服务器已启动（端口53）");
-    
-    while (1) {
-        // 接收DNS查询
-        int len = recvfrom(sock, rx_buffer, sizeof(rx_buffer) - 1, 0,
-                          (struct sockaddr *)&client_addr, &client_addr_len);
-        
-        if (len > 0) {
-            // 构建DNS响应 - 返回192.168.4.1
-            memcpy(tx_buffer, rx_buffer, len);
-            
-            // 修改DNS响应标志
-            tx_buffer[2] = 0x81;  // 标准查询响应
-            tx_buffer[3] = 0x80;  // 无错误
-            tx_buffer[7] = 0x01;  // 1个应答
-            
-            // 添加DNS应答（指向192.168.4.1）
-            int response_len = len;
-            tx_buffer[response_len++] = 0xC0;  // 指针到域名
-            tx_buffer[response_len++] = 0x0C;
-            tx_buffer[response_len++] = 0x00;  // 类型A
-            tx_buffer[response_len++] = 0x01;
-            tx_buffer[response_len++] = 0x00;  // 类IN
-            tx_buffer[response_len++] = 0x01;
-            tx_buffer[response_len++] = 0x00;  // TTL (4字节)
-            tx_buffer[response_len++] = 0x00;
-            tx_buffer[response_len++] = 0x00;
-            tx_buffer[response_len++] = 0x3C;  // 60秒
-            tx_buffer[response_len++] = 0x00;  // 数据长度
-            tx_buffer[response_len++] = 0x04;  // 4字节（IPv4）
-            tx_buffer[response_len++] = 192;   // IP: 192
-            tx_buffer[response_len++] = 168;   // IP: 168
-            tx_buffer[response_len++] = 4;     // IP: 4
-            tx_buffer[response_len++] = 1;     // IP: 1
-            
-            // 发送DNS响应
-            sendto(sock, tx_buffer, response_len, 0,
-                  (struct sockaddr *)&client_addr, client_addr_len);
-        }
-        
-        vTaskDelay(pdMS_TO_TICKS(10));  // 短暂延迟避免CPU占用过高
-    }
-    
-    close(sock);
-    vTaskDelete(NULL);
-}
-
-/**
- * @brief 启动DNS服务器
+ * @brief 启动DNS服务器（Captive Portal：所有域名都解析到192.168.4.1）
+ *
+ * 与S3固件共用 aiot-esp32/components/captive_dns：阻塞等待查询，按客户端限速
  */
 static void start_dns_server(void) {
-    if (dns_server_task_handle == NULL) {
-        xTaskCreate(dns_server_task, "dns_server", 4096, NULL, 5, &dns_server_task_handle);
-        ESP_LOGI(TAG, "DNS服务器任务已创建");
+    if (captive_dns_start(NULL) != ESP_OK) {
+        ESP_LOGE(TAG, "DNS服务器启动失败");
     }
 }
 
@@ -330,104 +243,14 @@ static void start_dns_server(void) {
  */
 __attribute__((unused))
 static void stop_dns_server(void) {
-    if (dns_server_task_handle != NULL) {
-        vTaskDelete(dns_server_task_handle);
-        dns_server_task_handle = NULL;
-        ESP_LOGI(TAG, "DNS服务器已停止");
-    }
+    captive_dns_stop();
 }
 
 // ==================== WiFi配网Web服务器 ====================
 
-// 现代化配网页面HTML
-static const char* config_page_html = 
-    "<!DOCTYPE html><html><head><meta charset='UTF-8'>"
-    "<meta name='viewport' content='width=device-width,initial-scale=1'>"
-    "<title>AIOT设备配网</title>"
-    "<style>"
-    "*{margin:0;padding:0;box-sizing:border-box}"
-    "body{font-family:-apple-system,BlinkMacSystemFont,'Segoe UI',Roboto,sans-serif;"
-    "background:linear-gradient(135deg,#667eea 0%,#764ba2 100%);min-height:100vh;padding:20px;"
-    "display:flex;align-items:center;justify-content:center}"
-    ".container{background:white;border-radius:16px;box-shadow:0 20px 60px rgba(0,0,0,0.3);"
-    "max-width:420px;width:100%;padding:32px;animation:slideIn 0.3s ease}"
-    "@keyframes slideIn{from{opacity:0;transform:translateY(-20px)}to{opacity:1;transform:translateY(0)}}"
-    ".header{text-align:center;margin-bottom:24px}"
-    ".header h1{font-size:24px;color:#333;margin-bottom:8px}"
-    ".header p{color:#666;font-size:14px}"
-    ".device-info{background:#f8f9fa;border-radius:8px;padding:12px;margin-bottom:20px;font-size:12px;color:#666}"
-    ".form-group{margin-bottom:20px}"
-    ".form-group label{display:block;margin-bottom:8px;color:#333;font-weight:500;font-size:14px}"
-    ".form-group select,.form-group input{width:100%;padding:12px;border:2px solid #e0e0e0;"
-    "border-radius:8px;font-size:14px;transition:all 0.3s}"
-    ".form-group select:focus,.form-group input:focus{outline:none;border-color:#667eea}"
-    ".btn-primary{width:100%;padding:14px;background:linear-gradient(135deg,#667eea,#764ba2);"
-    "color:white;border:none;border-radius:8px;font-size:16px;font-weight:600;"
-    "cursor:pointer;transition:transform 0.2s}"
-    ".btn-primary:hover{transform:translateY(-2px)}"
-    ".btn-secondary{width:100%;padding:12px;background:#f0f0f0;color:#333;border:none;"
-    "border-radius:8px;margin-top:10px;cursor:pointer;font-size:14px}"
-    ".loading{display:none;text-align:center;margin-top:16px;color:#666}"
-    ".spinner{border:3px solid #f3f3f3;border-top:3px solid #667eea;border-radius:50%;"
-    "width:32px;height:32px;animation:spin 1s linear infinite;margin:0 auto}"
-    "@keyframes spin{0%{transform:rotate(0deg)}100%{transform:rotate(360deg)}}"
-    "</style></head><body>"
-    "<div class='container'>"
-    "<div class='header'>"
-    "<h1>🔧 AIOT设备配网</h1>"
-    "<p>连接您的WiFi网络</p>"
-    "</div>"
-    "<div class='device-info' id='deviceInfo'>设备ID: <span id='devId'>加载中...</span></div>"
-    "<form id='configForm' action='/save' method='post'>"
-    "<div class='form-group'>"
-    "<label>📶 WiFi网络</label>"
-    "<select id='ssid' name='ssid' required>"
-    "<option value=''>正在扫描WiFi...</option>"
-    "</select>"
-    "</div>"
-    "<div class='form-group'>"
-    "<label>🔑 WiFi密码</label>"
-    "<input type='password' name='pass' placeholder='请输入WiFi密码' required>"
-    "</div>"
-    "<div class='form-group' style='margin-left:-16px;margin-right:-16px'>"
-    "<label style='margin-left:16px'>⚙️ 配置服务器</label>"
-    "<div style='position:relative;padding:0 16px'>"
-    "<div style='position:absolute;left:28px;top:50%;transform:translateY(-50%);color:#999;font-size:12px;pointer-events:none'>http://</div>"
-    "<input type='text' name='config_srv' value='conf.aiot.powertechhub.com:8001' required "
-    "style='padding-left:60px;padding-right:8px;width:100%;font-size:13px'>"
-    "</div>"
-    "<div style='font-size:11px;color:#999;margin-top:4px;margin-left:16px'>示例: conf.aiot.powertechhub.com:8001</div>"
-    "</div>"
-    "<button type='submit' class='btn-primary'>💾 保存配置</button>"
-    "<button type='button' class='btn-secondary' onclick='scanWifi()'>🔄 重新扫描</button>"
-    "</form>"
-    "<div class='loading' id='loading'>"
-    "<div class='spinner'></div>"
-    "<p style='margin-top:12px'>正在保存配置...</p>"
-    "</div>"
-    "</div>"
-    "<script>"
-    "function scanWifi(){"
-    "document.getElementById('ssid').innerHTML='<option>正在扫描...</option>';"
-    "fetch('/scan').then(r=>r.json()).then(d=>{"
-    "let html='<option value=\"\">请选择WiFi网络</option>';"
-    "d.forEach(w=>html+=`<option value=\"${w.ssid}\">${w.ssid} (${w.rssi}dBm)</option>`);"
-    "document.getElementById('ssid').innerHTML=html;"
-    "}).catch(()=>{"
-    "document.getElementById('ssid').innerHTML='<option>扫描失败，请手动输入</option>';"
-    "})}"
-    "function getDeviceId(){"
-    "fetch('/info').then(r=>r.json()).then(d=>{"
-    "document.getElementById('devId').textContent=d.device_id;"
-    "}).catch(()=>{"
-    "document.getElementById('devId').textContent='未知';"
-    "})}"
-    "document.getElementById('configForm').onsubmit=function(){"
-    "document.getElementById('loading').style.display='block';"
-    "document.getElementById('configForm').style.display='none';"
-    "};"
-    "window.onload=function(){scanWifi();getDeviceId()};"
-    "</script></body></html>";
+// 配网页面（web/config.html，构建时gzip压缩后嵌入固件，见main/CMakeLists.txt）
+extern const uint8_t config_html_gz_start[] asm("_binary_config_html_gz_start");
+extern const uint8_t config_html_gz_end[]   asm("_binary_config_html_gz_end");
 
 // WiFi扫描API
 static esp_err_t scan_handler(httpd_req_t *req) {
@@ -539,10 +362,27 @@ static esp_err_t info_handler(httpd_req_t *req) {
 }
 
 // 配网页面处理（主页面和Captive Portal）
+// gzip数据直接从flash发送；ETag为gzip数据的CRC32，浏览器缓存命中时返回304
 static esp_err_t config_page_handler(httpd_req_t *req) {
-    httpd_resp_set_type(req, "text/html");
+    static char etag[12];
+    size_t gz_len = config_html_gz_end - config_html_gz_start;
+    if (etag[0] == '\0') {
+        snprintf(etag, sizeof(etag), "\"%08" PRIx32 "\"", esp_rom_crc32_le(0, config_html_gz_start, gz_len));
+    }
+    httpd_resp_set_hdr(req, "ETag", etag);
     httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
-    httpd_resp_send(req, config_page_html, strlen(config_page_html));
+    
+    char if_none_match[16] = {0};
+    if (httpd_req_get_hdr_value_str(req, "If-None-Match", if_none_match, sizeof(if_none_match)) == ESP_OK &&
+        strcmp(if_none_match, etag) == 0) {
+        httpd_resp_set_status(req, "304 Not Modified");
+        httpd_resp_send(req, NULL, 0);
+        return ESP_OK;
+    }
+    
+    httpd_resp_set_type(req, "text/html");
+    httpd_resp_set_hdr(req, "Content-Encoding", "gzip");
+    httpd_resp_send(req, (const char *)config_html_gz_start, gz_len);
     return ESP_OK;
 }
 
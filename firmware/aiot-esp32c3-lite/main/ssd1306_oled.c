@@ -2,14 +2,15 @@
  * @file ssd1306_oled.c
  * @brief SSD1306 OLED显示屏驱动实现
  * 
- * 128x64单色OLED，I2C接口
+ * 128x64单色OLED，I2C接口。读写经共享I2C总线管理（components/i2c_bus）排队，
+ * 显示刷新按显示优先级调度，不挡同一总线上的传感器读取
  * 
  * @author AIOT Team
  * @date 2025-12-27
  */
 
 #include "ssd1306_oled.h"
-#include "driver/i2c.h"
+#include "i2c_bus.h"
 #include "esp_log.h"
 #include "esp_mac.h"
 #include "freertos/FreeRTOS.h"
@@ -22,6 +23,11 @@ static const char *TAG = "OLED";
 // 显示缓冲区 (128x64 / 8 = 1024字节)
 static uint8_t oled_buffer[OLED_WIDTH * OLED_HEIGHT / 8];
 
+// 一页数据的发送缓冲区（控制字节 + 128字节）
+static uint8_t oled_tx[OLED_WIDTH + 1];
+
+static i2c_bus_device_handle_t oled_dev = NULL;
+
 // 8x8 ASCII字体（简化版，0x20-0x7E）
 static const uint8_t font_8x8[][8] = {
     {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, // 空格
@@ -92,46 +98,46 @@ static const uint8_t font_8x8[][8] = {
 
 // I2C写命令
 static esp_err_t oled_write_cmd(uint8_t cmd) {
-    uint8_t data[2] = {0x00, cmd};  // 0x00表示写命令
-    return i2c_master_write_to_device(I2C_PORT, OLED_I2C_ADDRESS, 
-                                     data, 2, pdMS_TO_TICKS(100));
+    if (!oled_dev) return ESP_ERR_INVALID_STATE;
+    return i2c_bus_write_reg(oled_dev, 0x00, cmd, I2C_BUS_PRIO_DISPLAY);  // 0x00表示写命令
 }
 
 // I2C写数据
-static esp_err_t oled_write_data(uint8_t *data, size_t len) {
-    uint8_t *buffer = malloc(len + 1);
-    if (!buffer) return ESP_ERR_NO_MEM;
+static esp_err_t oled_write_data(const uint8_t *data, size_t len) {
+    if (!oled_dev) return ESP_ERR_INVALID_STATE;
+    if (len > OLED_WIDTH) return ESP_ERR_INVALID_SIZE;
     
-    buffer[0] = 0x40;  // 0x40表示写数据
-    memcpy(buffer + 1, data, len);
+    oled_tx[0] = 0x40;  // 0x40表示写数据
+    memcpy(oled_tx + 1, data, len);
     
-    esp_err_t ret = i2c_master_write_to_device(I2C_PORT, OLED_I2C_ADDRESS,
-                                               buffer, len + 1, pdMS_TO_TICKS(100));
-    free(buffer);
-    return ret;
+    // 同步写入，返回前 oled_tx 不会被复用
+    return i2c_bus_write(oled_dev, oled_tx, len + 1, I2C_BUS_PRIO_DISPLAY);
 }
 
 // OLED初始化
 esp_err_t oled_init(void) {
-    // 初始化I2C
-    i2c_config_t conf = {
-        .mode = I2C_MODE_MASTER,
-        .sda_io_num = I2C_SDA_PIN,
-        .scl_io_num = I2C_SCL_PIN,
-        .sda_pullup_en = GPIO_PULLUP_ENABLE,
-        .scl_pullup_en = GPIO_PULLUP_ENABLE,
-        .master.clk_speed = I2C_FREQUENCY,
+    // 打开I2C总线（相同引脚的总线已打开时共用）并添加OLED设备
+    i2c_bus_config_t bus_conf = {
+        .port = I2C_PORT,
+        .sda = I2C_SDA_PIN,
+        .scl = I2C_SCL_PIN,
+        .internal_pullup = true,
     };
-    
-    esp_err_t ret = i2c_param_config(I2C_PORT, &conf);
+    i2c_bus_handle_t bus = NULL;
+    esp_err_t ret = i2c_bus_open(&bus_conf, &bus);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "I2C参数配置失败: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "I2C总线打开失败: %s", esp_err_to_name(ret));
         return ret;
     }
     
-    ret = i2c_driver_install(I2C_PORT, conf.mode, 0, 0, 0);
+    i2c_bus_device_config_t dev_conf = {
+        .addr = OLED_I2C_ADDRESS,
+        .scl_hz = I2C_FREQUENCY,
+        .name = "ssd1306",
+    };
+    ret = i2c_bus_add_device(bus, &dev_conf, &oled_dev);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "I2C驱动安装失败: %s", esp_err_to_name(ret));
+        ESP_LOGE(TAG, "OLED设备添加失败: %s", esp_err_to_name(ret));
         return ret;
     }
     
@@ -185,7 +191,8 @@ esp_err_t oled_init(void) {
 // OLED反初始化
 void oled_deinit(void) {
     oled_display(false);
-    i2c_driver_delete(I2C_PORT);
+    // 总线可能还有其他设备，保持打开；之后的显示操作直接返回
+    oled_dev = NULL;
     ESP_LOGI(TAG, "OLED已关闭");
 }
 